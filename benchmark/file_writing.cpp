@@ -0,0 +1,132 @@
+// This file is part of the `Selene` library.
+// Copyright 2017-2019 Michael Hofmann (https://github.com/kmhofmann).
+// Distributed under MIT license. See accompanying LICENSE file in the top-level directory.
+
+#include <selene/selene_config.hpp>
+
+#include <selene/base/Assert.hpp>
+#include <selene/base/io/BufferedFileWriter.hpp>
+#include <selene/base/io/FileReader.hpp>
+#include <selene/base/io/FileWriter.hpp>
+
+#include <selene/img/dynamic/DynImage.hpp>
+
+#include <selene/img_io/IO.hpp>
+
+#include <test/utils/Utils.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+/* Compares writing to files via FileWriter and BufferedFileWriter (with and without direct I/O): once for raw writes of
+ * varying size, and once for encoding images, which typically results in many small writes. Throughput is reported in
+ * MB/s of data written (raw writes) or of uncompressed image data (encoding). */
+
+namespace {
+
+enum class SinkKind
+{
+  File,
+  Buffered,
+  BufferedDirect,
+};
+
+const std::string& output_path()
+{
+  static const auto path = (sln_test::get_tmp_path() / "benchmark_file_writing.bin").string();
+  return path;
+}
+
+template <typename Func>
+void with_sink(SinkKind kind, Func func)
+{
+  if (kind == SinkKind::File)
+  {
+    sln::FileWriter sink(output_path());
+    SELENE_FORCED_ASSERT(sink.is_open());
+    func(sink);
+  }
+  else
+  {
+    const auto options = sln::BufferedFileWriterOptions(1024 * 1024, kind == SinkKind::BufferedDirect);
+    sln::BufferedFileWriter sink(output_path(), sln::WriterMode::Write, options);
+    SELENE_FORCED_ASSERT(sink.is_open());
+    func(sink);
+    SELENE_FORCED_ASSERT(sink.close());
+  }
+}
+
+void raw_writes(benchmark::State& state, SinkKind kind)
+{
+  const auto write_size = static_cast<std::size_t>(state.range(0));
+  const std::size_t total_size = 32 * 1024 * 1024;
+  const std::vector<std::uint8_t> data(write_size, std::uint8_t{0x5A});
+
+  for (auto _ : state)
+  {
+    with_sink(kind, [&](auto& sink) {
+      for (std::size_t nr_bytes = 0; nr_bytes < total_size; nr_bytes += write_size)
+      {
+        sln::write(sink, data.data(), data.size());
+      }
+    });
+  }
+
+  state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * total_size));
+  std::remove(output_path().c_str());
+}
+
+const sln::DynImage<>& input_image()
+{
+  static const auto img = sln::read_image(sln::FileReader(sln_test::full_data_path("bike_duck.png").string()));
+  SELENE_FORCED_ASSERT(img.is_valid());
+  return img;
+}
+
+template <typename Options>
+void image_encoding(benchmark::State& state, sln::ImageFormat format, Options options, SinkKind kind)
+{
+  const auto& img = input_image();
+
+  for (auto _ : state)
+  {
+    with_sink(kind, [&](auto& sink) {
+      const auto res = sln::write_image(img, format, sink, nullptr, options);
+      SELENE_FORCED_ASSERT(res);
+    });
+  }
+
+  state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * img.total_bytes()));
+  std::remove(output_path().c_str());
+}
+
+}  // namespace _
+
+BENCHMARK_CAPTURE(raw_writes, file, SinkKind::File)->RangeMultiplier(16)->Range(4, 64 * 1024);
+BENCHMARK_CAPTURE(raw_writes, buffered, SinkKind::Buffered)->RangeMultiplier(16)->Range(4, 64 * 1024);
+BENCHMARK_CAPTURE(raw_writes, buffered_direct, SinkKind::BufferedDirect)->RangeMultiplier(16)->Range(4, 64 * 1024);
+
+#if defined(SELENE_WITH_LIBJPEG)
+BENCHMARK_CAPTURE(image_encoding, jpeg_file, sln::ImageFormat::JPEG, sln::JPEGCompressionOptions(), SinkKind::File);
+BENCHMARK_CAPTURE(image_encoding, jpeg_buffered, sln::ImageFormat::JPEG, sln::JPEGCompressionOptions(),
+                  SinkKind::Buffered);
+#endif  // defined(SELENE_WITH_LIBJPEG)
+
+#if defined(SELENE_WITH_LIBPNG)
+BENCHMARK_CAPTURE(image_encoding, png_fast_file, sln::ImageFormat::PNG, sln::PNGCompressionOptions::fast(),
+                  SinkKind::File);
+BENCHMARK_CAPTURE(image_encoding, png_fast_buffered, sln::ImageFormat::PNG, sln::PNGCompressionOptions::fast(),
+                  SinkKind::Buffered);
+#endif  // defined(SELENE_WITH_LIBPNG)
+
+#if defined(SELENE_WITH_LIBTIFF)
+BENCHMARK_CAPTURE(image_encoding, tiff_file, sln::ImageFormat::TIFF, sln::TIFFWriteOptions(), SinkKind::File);
+BENCHMARK_CAPTURE(image_encoding, tiff_buffered, sln::ImageFormat::TIFF, sln::TIFFWriteOptions(), SinkKind::Buffered);
+BENCHMARK_CAPTURE(image_encoding, tiff_buffered_direct, sln::ImageFormat::TIFF, sln::TIFFWriteOptions(),
+                  SinkKind::BufferedDirect);
+#endif  // defined(SELENE_WITH_LIBTIFF)
+
+BENCHMARK_MAIN();
@@ -0,0 +1,119 @@
+// This file is part of the `Selene` library.
+// Copyright 2017-2019 Michael Hofmann (https://github.com/kmhofmann).
+// Distributed under MIT license. See accompanying LICENSE file in the top-level directory.
+
+#include <selene/selene_config.hpp>
+
+#include <selene/base/Assert.hpp>
+#include <selene/base/io/FileUtils.hpp>
+#include <selene/base/io/MemoryReader.hpp>
+
+#include <selene/img/dynamic/DynImage.hpp>
+
+#include <selene/img_io/IO.hpp>
+#include <selene/img_io/ImageBatchDecoder.hpp>
+
+#include <test/utils/Utils.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+/* Measures batch image decoding throughput (in images/sec) depending on the number of worker threads, over all image
+ * files (of a supported format) in a directory tree.
+ * The directory can be set via the environment variable SELENE_BENCHMARK_IMAGE_PATH; by default, the data/ directory
+ * is used. All files are read into memory up-front, so that file I/O is not part of the measurement. */
+
+namespace {
+
+using FileContents = std::vector<std::uint8_t>;
+
+const std::vector<FileContents>& image_files()
+{
+  static const auto files = []() {
+    const auto env_var = std::getenv("SELENE_BENCHMARK_IMAGE_PATH");
+    const auto dir = env_var ? sln_fs::path(env_var) : sln_test::full_data_path("");
+
+    std::vector<FileContents> contents;
+    for (const auto& entry : sln_fs::recursive_directory_iterator(dir))
+    {
+      if (!sln_fs::is_regular_file(entry.path()))
+      {
+        continue;
+      }
+
+      auto data = sln::read_file_contents(entry.path().string());
+      SELENE_FORCED_ASSERT(data.has_value());
+
+      if (sln::detect_image_format(sln::MemoryReader({data->data(), data->size()})))
+      {
+        contents.push_back(std::move(data.value()));
+      }
+    }
+
+    SELENE_FORCED_ASSERT(!contents.empty());
+    return contents;
+  }();
+
+  return files;
+}
+
+const std::vector<sln::ImageBatchSource>& image_sources()
+{
+  static const auto sources = []() {
+    std::vector<sln::ImageBatchSource> srcs;
+    for (const auto& file : image_files())
+    {
+      srcs.emplace_back(sln::ConstantMemoryRegion{file.data(), file.size()});
+    }
+    return srcs;
+  }();
+
+  return sources;
+}
+
+void set_counters(benchmark::State& state, std::size_t nr_images_per_iteration)
+{
+  const auto nr_images = static_cast<double>(state.iterations() * nr_images_per_iteration);
+  state.counters["images_per_sec"] = benchmark::Counter(nr_images, benchmark::Counter::kIsRate);
+}
+
+}  // namespace _
+
+void image_decoding_sequential(benchmark::State& state)
+{
+  const auto& files = image_files();
+
+  for (auto _ : state)
+  {
+    for (const auto& file : files)
+    {
+      auto dyn_img = sln::read_image(sln::MemoryReader({file.data(), file.size()}));
+      benchmark::DoNotOptimize(dyn_img.byte_ptr());
+    }
+  }
+
+  set_counters(state, files.size());
+}
+
+void image_batch_decoding(benchmark::State& state)
+{
+  const auto& sources = image_sources();
+  sln::ImageBatchDecoder decoder(sln::ImageBatchDecoderOptions(static_cast<int>(state.range(0))));
+
+  for (auto _ : state)
+  {
+    decoder.decode(sources, [](std::size_t, sln::DynImage<> dyn_img, const sln::MessageLog&) {
+      benchmark::DoNotOptimize(dyn_img.byte_ptr());
+    });
+  }
+
+  set_counters(state, sources.size());
+}
+
+BENCHMARK(image_decoding_sequential)->UseRealTime();
+BENCHMARK(image_batch_decoding)->RangeMultiplier(2)->Range(1, 16)->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -0,0 +1,172 @@
+// This file is part of the `Selene` library.
+// Copyright 2017-2019 Michael Hofmann (https://github.com/kmhofmann).
+// Distributed under MIT license. See accompanying LICENSE file in the top-level directory.
+
+#include <selene/img/pixel/PixelTypeAliases.hpp>
+#include <selene/img/typed/Image.hpp>
+
+#include <selene/img_ops/Algorithms.hpp>
+#include <selene/img_ops/Histogram.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+/* Compares the histogram computation (privatized sub-histograms, parallel row ranges) with a naive for_each_pixel
+ * loop into a single histogram, for a camera-sized frame of 1920x1080 pixels of 8-bit and 16-bit elements. The frames
+ * contain smooth content, i.e. long runs of equal values. The thread count is given as benchmark argument (0 denoting
+ * the number of concurrent threads supported by the hardware). Small frames of 160x120 pixels (e.g. as used for
+ * per-frame exposure control) are included to show the per-call overhead. */
+
+using namespace sln::literals;
+
+namespace {
+
+constexpr auto frame_width = 1920_px;
+constexpr auto frame_height = 1080_px;
+
+constexpr auto small_frame_width = 160_px;
+constexpr auto small_frame_height = 120_px;
+
+template <typename PixelType>
+sln::Image<PixelType> make_frame(sln::PixelLength width = frame_width, sln::PixelLength height = frame_height)
+{
+  using T = typename sln::PixelTraits<PixelType>::Element;
+  constexpr auto nr_channels = static_cast<std::size_t>(sln::PixelTraits<PixelType>::nr_channels);
+
+  std::mt19937 rng(42);
+  std::uniform_int_distribution<int> noise(0, 3);
+
+  sln::Image<PixelType> img({width, height});
+  for (auto y = 0_idx; y < img.height(); ++y)
+  {
+    for (auto x = 0_idx; x < img.width(); ++x)
+    {
+      for (std::size_t c = 0; c < nr_channels; ++c)
+      {
+        const auto v = (sizeof(T) == 1) ? (x / 16 + y / 8 + noise(rng)) : (x * 8 + y * 16 + noise(rng));
+        img(x, y)[c] = static_cast<T>(v);
+      }
+    }
+  }
+  return img;
+}
+
+template <typename PixelType>
+void set_counters(benchmark::State& state, const sln::Image<PixelType>& img)
+{
+  state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations()) * img.total_bytes());
+}
+
+}  // namespace _
+
+template <typename PixelType>
+void histogram_naive(benchmark::State& state)
+{
+  using T = typename sln::PixelTraits<PixelType>::Element;
+  constexpr auto nr_channels = static_cast<std::size_t>(sln::PixelTraits<PixelType>::nr_channels);
+  constexpr auto nr_bins = std::size_t{1} << (8 * sizeof(T));
+
+  auto img = make_frame<PixelType>();
+
+  for (auto _ : state)
+  {
+    std::array<std::vector<std::uint64_t>, nr_channels> bins;
+    for (auto& b : bins)
+    {
+      b.assign(nr_bins, 0);
+    }
+
+    sln::for_each_pixel(img, [&bins](const PixelType& px) {
+      for (std::size_t c = 0; c < nr_channels; ++c)
+      {
+        ++bins[c][px[c]];
+      }
+    });
+    benchmark::DoNotOptimize(bins);
+  }
+
+  set_counters(state, img);
+}
+
+template <typename PixelType>
+void histogram(benchmark::State& state)
+{
+  const auto img = make_frame<PixelType>();
+  const auto nr_threads = static_cast<int>(state.range(0));
+
+  for (auto _ : state)
+  {
+    auto bins = sln::histogram(img, nr_threads);
+    benchmark::DoNotOptimize(bins);
+  }
+
+  set_counters(state, img);
+}
+
+template <typename PixelType>
+void histogram_small_frame(benchmark::State& state)
+{
+  const auto img = make_frame<PixelType>(small_frame_width, small_frame_height);
+  const auto nr_threads = static_cast<int>(state.range(0));
+
+  for (auto _ : state)
+  {
+    auto bins = sln::histogram(img, nr_threads);
+    benchmark::DoNotOptimize(bins);
+  }
+
+  set_counters(state, img);
+}
+
+template <typename PixelType>
+void equalize_histogram(benchmark::State& state)
+{
+  const auto img = make_frame<PixelType>();
+  const auto nr_threads = static_cast<int>(state.range(0));
+  sln::Image<PixelType> img_dst;
+
+  for (auto _ : state)
+  {
+    sln::equalize_histogram(img, img_dst, nr_threads);
+    benchmark::DoNotOptimize(img_dst.byte_ptr());
+  }
+
+  set_counters(state, img);
+}
+
+template <typename PixelType>
+void clahe(benchmark::State& state)
+{
+  const auto img = make_frame<PixelType>();
+  const auto nr_threads = static_cast<int>(state.range(0));
+  sln::Image<PixelType> img_dst;
+
+  for (auto _ : state)
+  {
+    sln::clahe(img, img_dst, 8, 8, 2.0, nr_threads);
+    benchmark::DoNotOptimize(img_dst.byte_ptr());
+  }
+
+  set_counters(state, img);
+}
+
+BENCHMARK_TEMPLATE(histogram_naive, sln::Pixel_8u1);
+BENCHMARK_TEMPLATE(histogram, sln::Pixel_8u1)->Arg(1)->Arg(0);
+BENCHMARK_TEMPLATE(histogram_naive, sln::Pixel_8u3);
+BENCHMARK_TEMPLATE(histogram, sln::Pixel_8u3)->Arg(1)->Arg(0);
+BENCHMARK_TEMPLATE(histogram_naive, sln::Pixel_16u1);
+BENCHMARK_TEMPLATE(histogram, sln::Pixel_16u1)->Arg(1)->Arg(0);
+BENCHMARK_TEMPLATE(histogram_small_frame, sln::Pixel_8u1)->Arg(1)->Arg(0);
+BENCHMARK_TEMPLATE(histogram_small_frame, sln::Pixel_16u1)->Arg(1)->Arg(0);
+
+BENCHMARK_TEMPLATE(equalize_histogram, sln::Pixel_8u1)->Arg(1)->Arg(0);
+BENCHMARK_TEMPLATE(equalize_histogram, sln::Pixel_16u1)->Arg(1)->Arg(0);
+
+BENCHMARK_TEMPLATE(clahe, sln::Pixel_8u1)->Arg(1)->Arg(0);
+BENCHMARK_TEMPLATE(clahe, sln::Pixel_16u1)->Arg(1)->Arg(0);
+
+BENCHMARK_MAIN();
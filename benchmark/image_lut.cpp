@@ -0,0 +1,158 @@
+// This file is part of the `Selene` library.
+// Copyright 2017-2019 Michael Hofmann (https://github.com/kmhofmann).
+// Distributed under MIT license. See accompanying LICENSE file in the top-level directory.
+
+#include <selene/img/pixel/PixelTypeAliases.hpp>
+#include <selene/img/typed/Image.hpp>
+
+#include <selene/img_ops/Algorithms.hpp>
+#include <selene/img_ops/Lut.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+/* Compares look-up table application with transform_pixels and a (gamma correction) lambda, for a camera-sized frame
+ * of 1920x1080 pixels of 8-bit and 16-bit elements; for one table, as well as for separate tables per channel. */
+
+using namespace sln::literals;
+
+namespace {
+
+constexpr auto frame_width = 1920_px;
+constexpr auto frame_height = 1080_px;
+
+template <typename PixelType>
+sln::Image<PixelType> make_frame()
+{
+  sln::Image<PixelType> img({frame_width, frame_height});
+  auto ptr = img.byte_ptr();
+  for (std::ptrdiff_t i = 0; i < img.total_bytes(); ++i)
+  {
+    ptr[i] = static_cast<std::uint8_t>(i * 7 + 3);
+  }
+  return img;
+}
+
+template <typename T>
+T gamma_correct(T value, float gamma)
+{
+  constexpr auto max_value = static_cast<float>(std::numeric_limits<T>::max());
+  return static_cast<T>(std::pow(static_cast<float>(value) / max_value, gamma) * max_value + 0.5f);
+}
+
+template <typename PixelType>
+void set_counters(benchmark::State& state, const sln::Image<PixelType>& img)
+{
+  state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations()) * img.total_bytes());
+}
+
+}  // namespace _
+
+template <typename PixelType>
+void gamma_transform_pixels(benchmark::State& state)
+{
+  using T = typename sln::PixelTraits<PixelType>::Element;
+  constexpr auto nr_channels = static_cast<std::size_t>(sln::PixelTraits<PixelType>::nr_channels);
+
+  const auto img = make_frame<PixelType>();
+  sln::Image<PixelType> img_dst;
+
+  for (auto _ : state)
+  {
+    sln::transform_pixels(img, img_dst, [](const PixelType& px) {
+      PixelType px_dst;
+      for (std::size_t c = 0; c < nr_channels; ++c)
+      {
+        px_dst[c] = gamma_correct<T>(px[c], 0.45f);
+      }
+      return px_dst;
+    });
+    benchmark::DoNotOptimize(img_dst.byte_ptr());
+  }
+
+  set_counters(state, img);
+}
+
+template <typename PixelType>
+void gamma_apply_lut(benchmark::State& state)
+{
+  using T = typename sln::PixelTraits<PixelType>::Element;
+
+  const auto img = make_frame<PixelType>();
+  sln::Image<PixelType> img_dst;
+  const auto lut = sln::make_lut<T>([](T v) { return gamma_correct<T>(v, 0.45f); });
+
+  for (auto _ : state)
+  {
+    sln::apply_lut(img, img_dst, lut);
+    benchmark::DoNotOptimize(img_dst.byte_ptr());
+  }
+
+  set_counters(state, img);
+}
+
+template <typename PixelType>
+void gamma_per_channel_transform_pixels(benchmark::State& state)
+{
+  using T = typename sln::PixelTraits<PixelType>::Element;
+  constexpr auto nr_channels = static_cast<std::size_t>(sln::PixelTraits<PixelType>::nr_channels);
+
+  const auto img = make_frame<PixelType>();
+  sln::Image<PixelType> img_dst;
+
+  for (auto _ : state)
+  {
+    sln::transform_pixels(img, img_dst, [](const PixelType& px) {
+      PixelType px_dst;
+      for (std::size_t c = 0; c < nr_channels; ++c)
+      {
+        px_dst[c] = gamma_correct<T>(px[c], 0.4f + 0.1f * static_cast<float>(c));
+      }
+      return px_dst;
+    });
+    benchmark::DoNotOptimize(img_dst.byte_ptr());
+  }
+
+  set_counters(state, img);
+}
+
+template <typename PixelType>
+void gamma_per_channel_apply_lut(benchmark::State& state)
+{
+  using T = typename sln::PixelTraits<PixelType>::Element;
+  constexpr auto nr_channels = static_cast<std::size_t>(sln::PixelTraits<PixelType>::nr_channels);
+
+  const auto img = make_frame<PixelType>();
+  sln::Image<PixelType> img_dst;
+  std::array<sln::Lut<T>, nr_channels> luts;
+  for (std::size_t c = 0; c < nr_channels; ++c)
+  {
+    luts[c] = sln::Lut<T>([c](T v) { return gamma_correct<T>(v, 0.4f + 0.1f * static_cast<float>(c)); });
+  }
+
+  for (auto _ : state)
+  {
+    sln::apply_lut(img, img_dst, luts);
+    benchmark::DoNotOptimize(img_dst.byte_ptr());
+  }
+
+  set_counters(state, img);
+}
+
+BENCHMARK_TEMPLATE(gamma_transform_pixels, sln::Pixel_8u1);
+BENCHMARK_TEMPLATE(gamma_apply_lut, sln::Pixel_8u1);
+BENCHMARK_TEMPLATE(gamma_transform_pixels, sln::Pixel_8u3);
+BENCHMARK_TEMPLATE(gamma_apply_lut, sln::Pixel_8u3);
+BENCHMARK_TEMPLATE(gamma_transform_pixels, sln::Pixel_16u1);
+BENCHMARK_TEMPLATE(gamma_apply_lut, sln::Pixel_16u1);
+
+BENCHMARK_TEMPLATE(gamma_per_channel_transform_pixels, sln::Pixel_8u3);
+BENCHMARK_TEMPLATE(gamma_per_channel_apply_lut, sln::Pixel_8u3);
+BENCHMARK_TEMPLATE(gamma_per_channel_transform_pixels, sln::Pixel_16u4);
+BENCHMARK_TEMPLATE(gamma_per_channel_apply_lut, sln::Pixel_16u4);
+
+BENCHMARK_MAIN();
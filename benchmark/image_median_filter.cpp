@@ -0,0 +1,120 @@
+// This file is part of the `Selene` library.
+// Copyright 2017-2019 Michael Hofmann (https://github.com/kmhofmann).
+// Distributed under MIT license. See accompanying LICENSE file in the top-level directory.
+
+#include <selene/img/pixel/PixelTypeAliases.hpp>
+#include <selene/img/typed/Image.hpp>
+#include <selene/img/typed/access/BorderAccessors.hpp>
+
+#include <selene/img_ops/Algorithms.hpp>
+#include <selene/img_ops/MedianFilter.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <random>
+
+/* Compares median filtering using a per-pixel lambda with bounds-checked access and nth_element with sln::median_filter,
+ * for an 8-bit frame of 1920x1080 pixels with salt-and-pepper noise, over different radii. The cost of sln::median_filter
+ * is expected to be independent of the radius, from a radius of 3 onwards. */
+
+using namespace sln::literals;
+
+namespace {
+
+constexpr auto frame_width = 1920_px;
+constexpr auto frame_height = 1080_px;
+
+template <typename PixelType>
+sln::Image<PixelType> make_noisy_frame()
+{
+  sln::Image<PixelType> img({frame_width, frame_height});
+  std::mt19937 rng(42);
+  std::uniform_int_distribution<int> die(0, 99);
+  auto ptr = img.byte_ptr();
+  for (std::ptrdiff_t i = 0; i < img.total_bytes(); ++i)
+  {
+    const auto noise = die(rng);
+    ptr[i] = (noise < 5) ? std::uint8_t{0} : (noise < 10) ? std::uint8_t{255} : static_cast<std::uint8_t>(i % 200);
+  }
+  return img;
+}
+
+template <typename PixelType>
+void set_counters(benchmark::State& state, const sln::Image<PixelType>& img)
+{
+  state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations()) * img.total_bytes());
+}
+
+}  // namespace _
+
+template <typename PixelType>
+void median_transform_pixels_with_position(benchmark::State& state)
+{
+  const auto img = make_noisy_frame<PixelType>();
+  sln::Image<PixelType> img_dst;
+  const auto radius = static_cast<std::int32_t>(state.range(0));
+
+  for (auto _ : state)
+  {
+    sln::transform_pixels_with_position(img, img_dst, [&img, radius](const PixelType&, auto x, auto y) {
+      std::array<std::uint8_t, 49> values = {};
+      std::size_t nr_values = 0;
+      for (std::int32_t dy = -radius; dy <= radius; ++dy)
+      {
+        for (std::int32_t dx = -radius; dx <= radius; ++dx)
+        {
+          values[nr_values++] = sln::ImageBorderAccessor<sln::BorderAccessMode::Replicated>::access(
+              img, sln::PixelIndex{x + dx}, sln::PixelIndex{y + dy})[0];
+        }
+      }
+      const auto mid = values.begin() + nr_values / 2;
+      std::nth_element(values.begin(), mid, values.begin() + nr_values);
+      return PixelType{*mid};
+    });
+    benchmark::DoNotOptimize(img_dst.byte_ptr());
+  }
+
+  set_counters(state, img);
+}
+
+template <typename PixelType>
+void median_filter(benchmark::State& state)
+{
+  const auto img = make_noisy_frame<PixelType>();
+  sln::Image<PixelType> img_dst;
+  const auto radius = static_cast<std::size_t>(state.range(0));
+
+  for (auto _ : state)
+  {
+    sln::median_filter(img, img_dst, radius, 1);
+    benchmark::DoNotOptimize(img_dst.byte_ptr());
+  }
+
+  set_counters(state, img);
+}
+
+template <typename PixelType>
+void median_filter_parallel(benchmark::State& state)
+{
+  const auto img = make_noisy_frame<PixelType>();
+  sln::Image<PixelType> img_dst;
+  const auto radius = static_cast<std::size_t>(state.range(0));
+
+  for (auto _ : state)
+  {
+    sln::median_filter(img, img_dst, radius);
+    benchmark::DoNotOptimize(img_dst.byte_ptr());
+  }
+
+  set_counters(state, img);
+}
+
+BENCHMARK_TEMPLATE(median_transform_pixels_with_position, sln::Pixel_8u1)->Arg(1)->Arg(2)->Arg(3);
+BENCHMARK_TEMPLATE(median_filter, sln::Pixel_8u1)->Arg(1)->Arg(2)->Arg(3)->Arg(5)->Arg(8)->Arg(11)->Arg(15)->Arg(31);
+BENCHMARK_TEMPLATE(median_filter_parallel, sln::Pixel_8u1)->Arg(1)->Arg(2)->Arg(3)->Arg(15)->UseRealTime();
+BENCHMARK_TEMPLATE(median_filter, sln::Pixel_8u3)->Arg(1)->Arg(2)->Arg(15);
+
+BENCHMARK_MAIN();
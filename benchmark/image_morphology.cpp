@@ -0,0 +1,99 @@
+// This file is part of the `Selene` library.
+// Copyright 2017-2019 Michael Hofmann (https://github.com/kmhofmann).
+// Distributed under MIT license. See accompanying LICENSE file in the top-level directory.
+
+#include <selene/img/pixel/PixelTypeAliases.hpp>
+#include <selene/img/typed/Image.hpp>
+#include <selene/img/typed/access/BorderAccessors.hpp>
+
+#include <selene/img_ops/Algorithms.hpp>
+#include <selene/img_ops/Morphology.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdint>
+
+/* Compares erosion using a per-pixel lambda with bounds-checked access (O(k^2) per pixel) with sln::erode, for a binary
+ * mask of 1920x1080 pixels, and (square) structuring elements of different sizes. */
+
+using namespace sln::literals;
+
+namespace {
+
+constexpr auto frame_width = 1920_px;
+constexpr auto frame_height = 1080_px;
+
+template <typename PixelType>
+sln::Image<PixelType> make_mask()
+{
+  sln::Image<PixelType> img({frame_width, frame_height});
+  auto ptr = img.byte_ptr();
+  for (std::ptrdiff_t i = 0; i < img.total_bytes(); ++i)
+  {
+    ptr[i] = ((i * 7) % 97 < 80) ? std::uint8_t{255} : std::uint8_t{0};
+  }
+  return img;
+}
+
+template <typename PixelType>
+void set_counters(benchmark::State& state, const sln::Image<PixelType>& img)
+{
+  state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations()) * img.total_bytes());
+}
+
+}  // namespace _
+
+template <typename PixelType>
+void erode_transform_pixels_with_position(benchmark::State& state)
+{
+  const auto img = make_mask<PixelType>();
+  sln::Image<PixelType> img_dst;
+  const auto k = static_cast<std::int32_t>(state.range(0));
+  const auto k_offset = (k - 1) / 2;
+
+  for (auto _ : state)
+  {
+    sln::transform_pixels_with_position(img, img_dst, [&img, k, k_offset](const PixelType& px, auto x, auto y) {
+      auto res = px;
+      for (std::int32_t dy = -k_offset; dy < k - k_offset; ++dy)
+      {
+        for (std::int32_t dx = -k_offset; dx < k - k_offset; ++dx)
+        {
+          const auto& px_nb = sln::ImageBorderAccessor<sln::BorderAccessMode::Replicated>::access(
+              img, sln::PixelIndex{x + dx}, sln::PixelIndex{y + dy});
+          res = std::min(res, px_nb);
+        }
+      }
+      return res;
+    });
+    benchmark::DoNotOptimize(img_dst.byte_ptr());
+  }
+
+  set_counters(state, img);
+}
+
+template <typename PixelType, sln::StructuringElementShape shape>
+void erode_morphology(benchmark::State& state)
+{
+  const auto img = make_mask<PixelType>();
+  sln::Image<PixelType> img_dst;
+  const auto k = sln::PixelLength{static_cast<std::int32_t>(state.range(0))};
+  const auto se = sln::StructuringElement(k, k, shape);
+
+  for (auto _ : state)
+  {
+    sln::erode(img, img_dst, se);
+    benchmark::DoNotOptimize(img_dst.byte_ptr());
+  }
+
+  set_counters(state, img);
+}
+
+BENCHMARK_TEMPLATE(erode_transform_pixels_with_position, sln::Pixel_8u1)->Arg(3)->Arg(5)->Arg(15);
+BENCHMARK_TEMPLATE(erode_morphology, sln::Pixel_8u1, sln::StructuringElementShape::Rectangle)
+    ->Arg(3)->Arg(5)->Arg(7)->Arg(9)->Arg(15)->Arg(31)->Arg(101);
+BENCHMARK_TEMPLATE(erode_morphology, sln::Pixel_8u1, sln::StructuringElementShape::Cross)->Arg(3)->Arg(5)->Arg(31);
+BENCHMARK_TEMPLATE(erode_morphology, sln::Pixel_8u3, sln::StructuringElementShape::Rectangle)->Arg(3)->Arg(15);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,207 @@
+// This file is part of the `Selene` library.
+// Copyright 2017-2019 Michael Hofmann (https://github.com/kmhofmann).
+// Distributed under MIT license. See accompanying LICENSE file in the top-level directory.
+
+#include <selene/base/Promote.hpp>
+
+#include <selene/img/pixel/PixelTypeAliases.hpp>
+#include <selene/img/typed/Image.hpp>
+
+#include <selene/img_ops/Algorithms.hpp>
+#include <selene/img_ops/Statistics.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <cstdint>
+
+/* Compares the image statistics functions (SIMD row kernels and parallel row-band reduction) with hand-written,
+ * naive for_each_pixel loops, for a camera-sized frame of 1920x1080 pixels. The thread count is given as benchmark
+ * argument (0 denoting the number of concurrent threads supported by the hardware). */
+
+using namespace sln::literals;
+
+namespace {
+
+constexpr auto frame_width = 1920_px;
+constexpr auto frame_height = 1080_px;
+
+template <typename PixelType>
+sln::Image<PixelType> make_frame()
+{
+  sln::Image<PixelType> img({frame_width, frame_height});
+  auto ptr = img.byte_ptr();
+  for (std::ptrdiff_t i = 0; i < img.total_bytes(); ++i)
+  {
+    ptr[i] = static_cast<std::uint8_t>(i * 7 + 3);
+  }
+  return img;
+}
+
+template <typename PixelType>
+void set_counters(benchmark::State& state, const sln::Image<PixelType>& img)
+{
+  state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations()) * img.total_bytes());
+}
+
+}  // namespace _
+
+template <typename PixelType>
+void sum_naive(benchmark::State& state)
+{
+  using T = typename sln::PixelTraits<PixelType>::Element;
+  constexpr auto nr_channels = static_cast<std::size_t>(sln::PixelTraits<PixelType>::nr_channels);
+  using Acc = sln::promote_t<sln::promote_t<sln::promote_t<T>>>;
+
+  auto img = make_frame<PixelType>();
+
+  for (auto _ : state)
+  {
+    std::array<Acc, nr_channels> sums{};
+    sln::for_each_pixel(img, [&sums](const PixelType& px) {
+      for (std::size_t c = 0; c < nr_channels; ++c)
+      {
+        sums[c] += px[c];
+      }
+    });
+    benchmark::DoNotOptimize(sums);
+  }
+
+  set_counters(state, img);
+}
+
+template <typename PixelType>
+void sum(benchmark::State& state)
+{
+  const auto img = make_frame<PixelType>();
+  const auto nr_threads = static_cast<int>(state.range(0));
+
+  for (auto _ : state)
+  {
+    auto sums = sln::sum(img, nr_threads);
+    benchmark::DoNotOptimize(sums);
+  }
+
+  set_counters(state, img);
+}
+
+template <typename PixelType>
+void variance_naive(benchmark::State& state)
+{
+  constexpr auto nr_channels = static_cast<std::size_t>(sln::PixelTraits<PixelType>::nr_channels);
+
+  auto img = make_frame<PixelType>();
+  const auto nr_px = static_cast<double>(img.width()) * static_cast<double>(img.height());
+
+  for (auto _ : state)
+  {
+    std::array<double, nr_channels> sums{};
+    std::array<double, nr_channels> sums_sq{};
+    sln::for_each_pixel(img, [&sums, &sums_sq](const PixelType& px) {
+      for (std::size_t c = 0; c < nr_channels; ++c)
+      {
+        const auto v = static_cast<double>(px[c]);
+        sums[c] += v;
+        sums_sq[c] += v * v;
+      }
+    });
+
+    std::array<double, nr_channels> vars{};
+    for (std::size_t c = 0; c < nr_channels; ++c)
+    {
+      const auto m = sums[c] / nr_px;
+      vars[c] = sums_sq[c] / nr_px - m * m;
+    }
+    benchmark::DoNotOptimize(vars);
+  }
+
+  set_counters(state, img);
+}
+
+template <typename PixelType>
+void variance(benchmark::State& state)
+{
+  const auto img = make_frame<PixelType>();
+  const auto nr_threads = static_cast<int>(state.range(0));
+
+  for (auto _ : state)
+  {
+    auto vars = sln::variance(img, nr_threads);
+    benchmark::DoNotOptimize(vars);
+  }
+
+  set_counters(state, img);
+}
+
+template <typename PixelType>
+void min_max_naive(benchmark::State& state)
+{
+  using T = typename sln::PixelTraits<PixelType>::Element;
+  constexpr auto nr_channels = static_cast<std::size_t>(sln::PixelTraits<PixelType>::nr_channels);
+
+  auto img = make_frame<PixelType>();
+
+  for (auto _ : state)
+  {
+    std::array<sln::ChannelMinMax<T>, nr_channels> result;
+    for (std::size_t c = 0; c < nr_channels; ++c)
+    {
+      result[c] = sln::ChannelMinMax<T>{img(0_idx, 0_idx)[c], img(0_idx, 0_idx)[c], 0_idx, 0_idx, 0_idx, 0_idx};
+    }
+
+    sln::for_each_pixel_with_position(img, [&result](const PixelType& px, sln::PixelIndex x, sln::PixelIndex y) {
+      for (std::size_t c = 0; c < nr_channels; ++c)
+      {
+        if (px[c] < result[c].min)
+        {
+          result[c].min = px[c];
+          result[c].min_x = x;
+          result[c].min_y = y;
+        }
+        if (result[c].max < px[c])
+        {
+          result[c].max = px[c];
+          result[c].max_x = x;
+          result[c].max_y = y;
+        }
+      }
+    });
+    benchmark::DoNotOptimize(result);
+  }
+
+  set_counters(state, img);
+}
+
+template <typename PixelType>
+void min_max(benchmark::State& state)
+{
+  const auto img = make_frame<PixelType>();
+  const auto nr_threads = static_cast<int>(state.range(0));
+
+  for (auto _ : state)
+  {
+    auto result = sln::min_max(img, nr_threads);
+    benchmark::DoNotOptimize(result);
+  }
+
+  set_counters(state, img);
+}
+
+BENCHMARK_TEMPLATE(sum_naive, sln::Pixel_8u1);
+BENCHMARK_TEMPLATE(sum, sln::Pixel_8u1)->Arg(1)->Arg(0);
+BENCHMARK_TEMPLATE(sum_naive, sln::Pixel_8u3);
+BENCHMARK_TEMPLATE(sum, sln::Pixel_8u3)->Arg(1)->Arg(0);
+BENCHMARK_TEMPLATE(sum_naive, sln::Pixel_16u1);
+BENCHMARK_TEMPLATE(sum, sln::Pixel_16u1)->Arg(1)->Arg(0);
+
+BENCHMARK_TEMPLATE(variance_naive, sln::Pixel_8u1);
+BENCHMARK_TEMPLATE(variance, sln::Pixel_8u1)->Arg(1)->Arg(0);
+BENCHMARK_TEMPLATE(variance_naive, sln::Pixel_8u3);
+BENCHMARK_TEMPLATE(variance, sln::Pixel_8u3)->Arg(1)->Arg(0);
+
+BENCHMARK_TEMPLATE(min_max_naive, sln::Pixel_8u1);
+BENCHMARK_TEMPLATE(min_max, sln::Pixel_8u1)->Arg(1)->Arg(0);
+BENCHMARK_TEMPLATE(min_max_naive, sln::Pixel_8u4);
+BENCHMARK_TEMPLATE(min_max, sln::Pixel_8u4)->Arg(1)->Arg(0);
+
+BENCHMARK_MAIN();
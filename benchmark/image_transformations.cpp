@@ -0,0 +1,301 @@
+// This file is part of the `Selene` library.
+// Copyright 2017-2019 Michael Hofmann (https://github.com/kmhofmann).
+// Distributed under MIT license. See accompanying LICENSE file in the top-level directory.
+
+#include <selene/base/Assert.hpp>
+
+#include <selene/img/pixel/PixelTypeAliases.hpp>
+#include <selene/img/typed/Image.hpp>
+
+#include <selene/img_ops/Allocate.hpp>
+#include <selene/img_ops/Transformations.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+
+/* Compares the tiled transpose/rotate and the vectorized flip implementations with the previous, naive implementations
+ * (pixel-wise copies in destination order, std::reverse_copy, and pixel-wise swaps), for a camera-sized frame of
+ * 1920x1080 pixels. */
+
+using namespace sln::literals;
+
+namespace {
+
+constexpr auto frame_width = 1920_px;
+constexpr auto frame_height = 1080_px;
+
+template <typename PixelType>
+sln::Image<PixelType> make_frame()
+{
+  sln::Image<PixelType> img({frame_width, frame_height});
+  auto ptr = img.byte_ptr();
+  for (std::ptrdiff_t i = 0; i < img.total_bytes(); ++i)
+  {
+    ptr[i] = static_cast<std::uint8_t>(i * 7 + 3);
+  }
+  return img;
+}
+
+template <bool flip_h, bool flip_v, typename PixelType>
+void transpose_naive(const sln::Image<PixelType>& img_src, sln::Image<PixelType>& img_dst)
+{
+  sln::allocate(img_dst, {img_src.height(), img_src.width()});
+
+  for (auto dst_y = 0_idx; dst_y < img_dst.height(); ++dst_y)
+  {
+    for (auto dst_x = 0_idx; dst_x < img_dst.width(); ++dst_x)
+    {
+      const auto src_x = flip_v ? sln::PixelIndex{img_src.width() - 1 - dst_y} : dst_y;
+      const auto src_y = flip_h ? sln::PixelIndex{img_src.height() - 1 - dst_x} : dst_x;
+      img_dst(dst_x, dst_y) = img_src(src_x, src_y);
+    }
+  }
+}
+
+template <typename PixelType>
+void flip_horizontally_naive(const sln::Image<PixelType>& img_src, sln::Image<PixelType>& img_dst)
+{
+  sln::allocate(img_dst, img_src.layout());
+
+  for (auto y = 0_idx; y < img_src.height(); ++y)
+  {
+    std::reverse_copy(img_src.data(y), img_src.data_row_end(y), img_dst.data(y));
+  }
+}
+
+template <typename PixelType>
+void flip_horizontally_in_place_naive(sln::Image<PixelType>& img)
+{
+  const auto half_width = img.width() / 2;
+
+  for (auto y = 0_idx; y < img.height(); ++y)
+  {
+    auto row_ptr = img.data(y);
+
+    for (auto x_left = 0_idx; x_left < half_width; ++x_left)
+    {
+      using std::swap;
+      const auto x_right = img.width() - x_left - 1;
+      swap(row_ptr[std::ptrdiff_t{x_left}], row_ptr[std::ptrdiff_t{x_right}]);
+    }
+  }
+}
+
+template <typename PixelType>
+void flip_vertically_in_place_naive(sln::Image<PixelType>& img)
+{
+  const auto half_height = img.height() / 2;
+
+  for (auto y_top = 0_idx; y_top < half_height; ++y_top)
+  {
+    const auto y_bottom = sln::PixelIndex{img.height() - y_top - 1};
+
+    const auto x_top_end = img.data_row_end(y_top);
+    auto x_top = img.data(y_top);
+    auto x_bottom = img.data(y_bottom);
+
+    for (; x_top != x_top_end; ++x_top, ++x_bottom)
+    {
+      using std::swap;
+      swap(*x_top, *x_bottom);
+    }
+  }
+}
+
+template <typename PixelType>
+void set_counters(benchmark::State& state, const sln::Image<PixelType>& img)
+{
+  state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations()) * img.total_bytes());
+}
+
+}  // namespace _
+
+template <typename PixelType>
+void transpose_naive(benchmark::State& state)
+{
+  const auto img = make_frame<PixelType>();
+  sln::Image<PixelType> img_dst;
+
+  for (auto _ : state)
+  {
+    transpose_naive<false, false>(img, img_dst);
+    benchmark::DoNotOptimize(img_dst.byte_ptr());
+  }
+
+  set_counters(state, img);
+}
+
+template <typename PixelType>
+void transpose_tiled(benchmark::State& state)
+{
+  const auto img = make_frame<PixelType>();
+  sln::Image<PixelType> img_dst;
+
+  for (auto _ : state)
+  {
+    sln::transpose<false, false>(img, img_dst);
+    benchmark::DoNotOptimize(img_dst.byte_ptr());
+  }
+
+  set_counters(state, img);
+}
+
+template <typename PixelType>
+void rotate_90_naive(benchmark::State& state)
+{
+  const auto img = make_frame<PixelType>();
+  sln::Image<PixelType> img_dst;
+
+  for (auto _ : state)
+  {
+    transpose_naive<true, false>(img, img_dst);
+    benchmark::DoNotOptimize(img_dst.byte_ptr());
+  }
+
+  set_counters(state, img);
+}
+
+template <typename PixelType>
+void rotate_90_tiled(benchmark::State& state)
+{
+  const auto img = make_frame<PixelType>();
+  sln::Image<PixelType> img_dst;
+
+  for (auto _ : state)
+  {
+    sln::rotate<sln::RotationDirection::Clockwise90>(img, img_dst);
+    benchmark::DoNotOptimize(img_dst.byte_ptr());
+  }
+
+  set_counters(state, img);
+}
+
+template <typename PixelType>
+void flip_horizontal_naive(benchmark::State& state)
+{
+  const auto img = make_frame<PixelType>();
+  sln::Image<PixelType> img_dst;
+
+  for (auto _ : state)
+  {
+    flip_horizontally_naive(img, img_dst);
+    benchmark::DoNotOptimize(img_dst.byte_ptr());
+  }
+
+  set_counters(state, img);
+}
+
+template <typename PixelType>
+void flip_horizontal(benchmark::State& state)
+{
+  const auto img = make_frame<PixelType>();
+  sln::Image<PixelType> img_dst;
+
+  for (auto _ : state)
+  {
+    sln::flip<sln::FlipDirection::Horizontal>(img, img_dst);
+    benchmark::DoNotOptimize(img_dst.byte_ptr());
+  }
+
+  set_counters(state, img);
+}
+
+template <typename PixelType>
+void flip_horizontal_in_place_naive(benchmark::State& state)
+{
+  auto img = make_frame<PixelType>();
+
+  for (auto _ : state)
+  {
+    flip_horizontally_in_place_naive(img);
+    benchmark::DoNotOptimize(img.byte_ptr());
+  }
+
+  set_counters(state, img);
+}
+
+template <typename PixelType>
+void flip_horizontal_in_place(benchmark::State& state)
+{
+  auto img = make_frame<PixelType>();
+
+  for (auto _ : state)
+  {
+    sln::flip_horizontally_in_place(img);
+    benchmark::DoNotOptimize(img.byte_ptr());
+  }
+
+  set_counters(state, img);
+}
+
+template <typename PixelType>
+void flip_vertical_in_place_naive(benchmark::State& state)
+{
+  auto img = make_frame<PixelType>();
+
+  for (auto _ : state)
+  {
+    flip_vertically_in_place_naive(img);
+    benchmark::DoNotOptimize(img.byte_ptr());
+  }
+
+  set_counters(state, img);
+}
+
+template <typename PixelType>
+void flip_vertical_in_place(benchmark::State& state)
+{
+  auto img = make_frame<PixelType>();
+
+  for (auto _ : state)
+  {
+    sln::flip_vertically_in_place(img);
+    benchmark::DoNotOptimize(img.byte_ptr());
+  }
+
+  set_counters(state, img);
+}
+
+BENCHMARK_TEMPLATE(transpose_naive, sln::Pixel_8u1);
+BENCHMARK_TEMPLATE(transpose_tiled, sln::Pixel_8u1);
+BENCHMARK_TEMPLATE(transpose_naive, sln::Pixel_16u1);
+BENCHMARK_TEMPLATE(transpose_tiled, sln::Pixel_16u1);
+BENCHMARK_TEMPLATE(transpose_naive, sln::Pixel_8u3);
+BENCHMARK_TEMPLATE(transpose_tiled, sln::Pixel_8u3);
+BENCHMARK_TEMPLATE(transpose_naive, sln::Pixel_8u4);
+BENCHMARK_TEMPLATE(transpose_tiled, sln::Pixel_8u4);
+
+BENCHMARK_TEMPLATE(rotate_90_naive, sln::Pixel_8u1);
+BENCHMARK_TEMPLATE(rotate_90_tiled, sln::Pixel_8u1);
+BENCHMARK_TEMPLATE(rotate_90_naive, sln::Pixel_8u3);
+BENCHMARK_TEMPLATE(rotate_90_tiled, sln::Pixel_8u3);
+BENCHMARK_TEMPLATE(rotate_90_naive, sln::Pixel_8u4);
+BENCHMARK_TEMPLATE(rotate_90_tiled, sln::Pixel_8u4);
+
+BENCHMARK_TEMPLATE(flip_horizontal_naive, sln::Pixel_8u1);
+BENCHMARK_TEMPLATE(flip_horizontal, sln::Pixel_8u1);
+BENCHMARK_TEMPLATE(flip_horizontal_naive, sln::Pixel_8u3);
+BENCHMARK_TEMPLATE(flip_horizontal, sln::Pixel_8u3);
+BENCHMARK_TEMPLATE(flip_horizontal_naive, sln::Pixel_8u4);
+BENCHMARK_TEMPLATE(flip_horizontal, sln::Pixel_8u4);
+BENCHMARK_TEMPLATE(flip_horizontal_naive, sln::Pixel_16u3);
+BENCHMARK_TEMPLATE(flip_horizontal, sln::Pixel_16u3);
+
+BENCHMARK_TEMPLATE(flip_horizontal_in_place_naive, sln::Pixel_8u1);
+BENCHMARK_TEMPLATE(flip_horizontal_in_place, sln::Pixel_8u1);
+BENCHMARK_TEMPLATE(flip_horizontal_in_place_naive, sln::Pixel_8u3);
+BENCHMARK_TEMPLATE(flip_horizontal_in_place, sln::Pixel_8u3);
+BENCHMARK_TEMPLATE(flip_horizontal_in_place_naive, sln::Pixel_8u4);
+BENCHMARK_TEMPLATE(flip_horizontal_in_place, sln::Pixel_8u4);
+BENCHMARK_TEMPLATE(flip_horizontal_in_place_naive, sln::Pixel_16u1);
+BENCHMARK_TEMPLATE(flip_horizontal_in_place, sln::Pixel_16u1);
+
+BENCHMARK_TEMPLATE(flip_vertical_in_place_naive, sln::Pixel_8u1);
+BENCHMARK_TEMPLATE(flip_vertical_in_place, sln::Pixel_8u1);
+BENCHMARK_TEMPLATE(flip_vertical_in_place_naive, sln::Pixel_8u3);
+BENCHMARK_TEMPLATE(flip_vertical_in_place, sln::Pixel_8u3);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,133 @@
+// This file is part of the `Selene` library.
+// Copyright 2017-2019 Michael Hofmann (https://github.com/kmhofmann).
+// Distributed under MIT license. See accompanying LICENSE file in the top-level directory.
+
+#include <selene/img/pixel/PixelTypeAliases.hpp>
+#include <selene/img/typed/Image.hpp>
+#include <selene/img/typed/access/Interpolators.hpp>
+
+#include <selene/img_ops/Algorithms.hpp>
+#include <selene/img_ops/Warp.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <cmath>
+#include <cstdint>
+
+/* Compares warping a 1920x1080 frame by a small rotation, scaling and translation (as in image stabilization), using a
+ * per-pixel lambda evaluating the full transformation and ImageInterpolator::interpolate, with sln::warp_affine and
+ * sln::warp_perspective. */
+
+using namespace sln::literals;
+
+namespace {
+
+constexpr auto frame_width = 1920_px;
+constexpr auto frame_height = 1080_px;
+
+template <typename PixelType>
+sln::Image<PixelType> make_frame()
+{
+  sln::Image<PixelType> img({frame_width, frame_height});
+  auto ptr = img.byte_ptr();
+  for (std::ptrdiff_t i = 0; i < img.total_bytes(); ++i)
+  {
+    ptr[i] = static_cast<std::uint8_t>((i * 7) % 251);
+  }
+  return img;
+}
+
+sln::PerspectiveTransform make_transform(bool perspective)
+{
+  const auto angle = 0.035;
+  const auto scale = 1.02;
+  const auto c = scale * std::cos(angle);
+  const auto s = scale * std::sin(angle);
+  const auto cx = 0.5 * static_cast<double>(frame_width);
+  const auto cy = 0.5 * static_cast<double>(frame_height);
+  return {{c, -s, cx - c * cx + s * cy + 5.3, s, c, cy - s * cx - c * cy - 3.7, perspective ? 1e-5 : 0.0,
+           perspective ? -2e-5 : 0.0, 1.0}};
+}
+
+template <typename PixelType>
+void set_counters(benchmark::State& state, const sln::Image<PixelType>& img)
+{
+  state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations()) * img.total_bytes());
+}
+
+}  // namespace _
+
+template <typename PixelType, sln::ImageInterpolationMode interpolation_mode, bool perspective>
+void warp_transform_pixels_with_position(benchmark::State& state)
+{
+  const auto img = make_frame<PixelType>();
+  sln::Image<PixelType> img_dst;
+  const auto m = make_transform(perspective);
+
+  for (auto _ : state)
+  {
+    sln::transform_pixels_with_position(img, img_dst, [&img, &m](const PixelType&, auto x, auto y) {
+      const auto dx = static_cast<double>(x);
+      const auto dy = static_cast<double>(y);
+      const auto w = m[6] * dx + m[7] * dy + m[8];
+      const auto xs = (m[0] * dx + m[1] * dy + m[2]) / w;
+      const auto ys = (m[3] * dx + m[4] * dy + m[5]) / w;
+      PixelType px;
+      px = sln::ImageInterpolator<interpolation_mode, sln::BorderAccessMode::ZeroPadding>::interpolate(img, xs, ys);
+      return px;
+    });
+    benchmark::DoNotOptimize(img_dst.byte_ptr());
+  }
+
+  set_counters(state, img);
+}
+
+template <typename PixelType, sln::ImageInterpolationMode interpolation_mode>
+void warp_affine(benchmark::State& state)
+{
+  const auto img = make_frame<PixelType>();
+  sln::Image<PixelType> img_dst;
+  const auto m = make_transform(false);
+  const auto m_affine = sln::AffineTransform{{m[0], m[1], m[2], m[3], m[4], m[5]}};
+  const auto nr_threads = static_cast<int>(state.range(0));
+
+  for (auto _ : state)
+  {
+    sln::warp_affine<interpolation_mode, sln::BorderAccessMode::ZeroPadding>(img, img_dst, m_affine, img.width(),
+                                                                              img.height(), nr_threads);
+    benchmark::DoNotOptimize(img_dst.byte_ptr());
+  }
+
+  set_counters(state, img);
+}
+
+template <typename PixelType, sln::ImageInterpolationMode interpolation_mode>
+void warp_perspective(benchmark::State& state)
+{
+  const auto img = make_frame<PixelType>();
+  sln::Image<PixelType> img_dst;
+  const auto m = make_transform(true);
+  const auto nr_threads = static_cast<int>(state.range(0));
+
+  for (auto _ : state)
+  {
+    sln::warp_perspective<interpolation_mode, sln::BorderAccessMode::ZeroPadding>(img, img_dst, m, img.width(),
+                                                                                   img.height(), nr_threads);
+    benchmark::DoNotOptimize(img_dst.byte_ptr());
+  }
+
+  set_counters(state, img);
+}
+
+using sln::ImageInterpolationMode;
+
+BENCHMARK_TEMPLATE(warp_transform_pixels_with_position, sln::Pixel_8u1, ImageInterpolationMode::NearestNeighbor, false);
+BENCHMARK_TEMPLATE(warp_transform_pixels_with_position, sln::Pixel_8u1, ImageInterpolationMode::Bilinear, false);
+BENCHMARK_TEMPLATE(warp_transform_pixels_with_position, sln::Pixel_8u3, ImageInterpolationMode::Bilinear, false);
+BENCHMARK_TEMPLATE(warp_transform_pixels_with_position, sln::Pixel_8u1, ImageInterpolationMode::Bilinear, true);
+BENCHMARK_TEMPLATE(warp_affine, sln::Pixel_8u1, ImageInterpolationMode::NearestNeighbor)->Arg(1);
+BENCHMARK_TEMPLATE(warp_affine, sln::Pixel_8u1, ImageInterpolationMode::Bilinear)->Arg(1)->Arg(0)->UseRealTime();
+BENCHMARK_TEMPLATE(warp_affine, sln::Pixel_8u3, ImageInterpolationMode::Bilinear)->Arg(1);
+BENCHMARK_TEMPLATE(warp_perspective, sln::Pixel_8u1, ImageInterpolationMode::Bilinear)->Arg(1)->Arg(0)->UseRealTime();
+
+BENCHMARK_MAIN();
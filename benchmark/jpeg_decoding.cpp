@@ -0,0 +1,166 @@
+// This file is part of the `Selene` library.
+// Copyright 2017-2019 Michael Hofmann (https://github.com/kmhofmann).
+// Distributed under MIT license. See accompanying LICENSE file in the top-level directory.
+
+#include <selene/selene_config.hpp>
+
+#include <selene/base/Assert.hpp>
+#include <selene/base/io/FileUtils.hpp>
+#include <selene/base/io/MemoryReader.hpp>
+
+#include <selene/img/dynamic/DynImage.hpp>
+#include <selene/img/dynamic/DynImageView.hpp>
+
+#include <selene/img_io/IO.hpp>
+#include <selene/img_io/jpeg/Read.hpp>
+
+#include <test/utils/Utils.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+/* Measures JPEG decoding throughput (in images/sec) over all JPEG files in a directory.
+ * The directory can be set via the environment variable SELENE_BENCHMARK_JPEG_PATH; by default, the JPEG files in the
+ * data/ directory are used. All files are read into memory up-front, so that file I/O is not part of the measurement. */
+
+#if defined(SELENE_WITH_LIBJPEG)
+
+namespace {
+
+using FileContents = std::vector<std::uint8_t>;
+
+bool has_jpeg_extension(const sln_fs::path& path)
+{
+  auto ext = path.extension().string();
+  std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+  return ext == ".jpg" || ext == ".jpeg";
+}
+
+const std::vector<FileContents>& jpeg_files()
+{
+  static const auto files = []() {
+    const auto env_var = std::getenv("SELENE_BENCHMARK_JPEG_PATH");
+    const auto dir = env_var ? sln_fs::path(env_var) : sln_test::full_data_path("");
+
+    std::vector<FileContents> contents;
+    for (const auto& entry : sln_fs::directory_iterator(dir))
+    {
+      if (!sln_fs::is_regular_file(entry.path()) || !has_jpeg_extension(entry.path()))
+      {
+        continue;
+      }
+
+      auto data = sln::read_file_contents(entry.path().string());
+      SELENE_FORCED_ASSERT(data.has_value());
+      contents.push_back(std::move(data.value()));
+    }
+
+    SELENE_FORCED_ASSERT(!contents.empty());
+    return contents;
+  }();
+
+  return files;
+}
+
+sln::MemoryReader make_reader(const FileContents& data)
+{
+  return sln::MemoryReader({data.data(), data.size()});
+}
+
+void set_counters(benchmark::State& state, std::size_t nr_images_per_iteration)
+{
+  const auto nr_images = static_cast<double>(state.iterations() * nr_images_per_iteration);
+  state.counters["images_per_sec"] = benchmark::Counter(nr_images, benchmark::Counter::kIsRate);
+}
+
+}  // namespace _
+
+void jpeg_decoding_read_image(benchmark::State& state)
+{
+  const auto& files = jpeg_files();
+
+  for (auto _ : state)
+  {
+    for (const auto& file : files)
+    {
+      auto dyn_img = sln::read_image(make_reader(file));
+      benchmark::DoNotOptimize(dyn_img.byte_ptr());
+    }
+  }
+
+  set_counters(state, files.size());
+}
+
+void jpeg_decoding_new_object(benchmark::State& state)
+{
+  const auto& files = jpeg_files();
+
+  for (auto _ : state)
+  {
+    for (const auto& file : files)
+    {
+      auto dyn_img = sln::read_jpeg(make_reader(file));
+      benchmark::DoNotOptimize(dyn_img.byte_ptr());
+    }
+  }
+
+  set_counters(state, files.size());
+}
+
+void jpeg_decoding_reused_object(benchmark::State& state)
+{
+  const auto& files = jpeg_files();
+  sln::JPEGDecompressionObject obj;
+
+  for (auto _ : state)
+  {
+    for (const auto& file : files)
+    {
+      auto dyn_img = sln::read_jpeg(obj, make_reader(file));
+      benchmark::DoNotOptimize(dyn_img.byte_ptr());
+    }
+  }
+
+  set_counters(state, files.size());
+}
+
+void jpeg_decoding_reused_object_view_pool(benchmark::State& state)
+{
+  const auto& files = jpeg_files();
+  sln::JPEGDecompressionObject obj;
+
+  // Pre-allocate one output view per file; in a real application, this would be a pool of suitably sized buffers.
+  std::vector<sln::DynImage<>> pool_memory;
+  std::vector<sln::MutableDynImageView> pool;
+  for (const auto& file : files)
+  {
+    pool_memory.emplace_back();
+    SELENE_FORCED_ASSERT(sln::read_jpeg(obj, make_reader(file), pool_memory.back()));
+    pool.push_back(pool_memory.back().view());
+  }
+
+  for (auto _ : state)
+  {
+    for (std::size_t i = 0; i < files.size(); ++i)
+    {
+      const auto res = sln::read_jpeg(obj, make_reader(files[i]), pool[i]);
+      benchmark::DoNotOptimize(res);
+    }
+  }
+
+  set_counters(state, files.size());
+}
+
+BENCHMARK(jpeg_decoding_read_image)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK(jpeg_decoding_new_object)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK(jpeg_decoding_reused_object)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK(jpeg_decoding_reused_object_view_pool)->ThreadRange(1, 8)->UseRealTime();
+
+#endif  // defined(SELENE_WITH_LIBJPEG)
+
+BENCHMARK_MAIN();
@@ -0,0 +1,109 @@
+// This file is part of the `Selene` library.
+// Copyright 2017-2019 Michael Hofmann (https://github.com/kmhofmann).
+// Distributed under MIT license. See accompanying LICENSE file in the top-level directory.
+
+#include <selene/selene_config.hpp>
+
+#include <selene/base/Assert.hpp>
+#include <selene/base/io/FileReader.hpp>
+#include <selene/base/io/VectorWriter.hpp>
+
+#include <selene/img/dynamic/DynImage.hpp>
+
+#include <selene/img_io/png/Read.hpp>
+#include <selene/img_io/png/Write.hpp>
+
+#include <test/utils/Utils.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <vector>
+
+/* Measures PNG encoding throughput (in MB/s of uncompressed data) for different compression options, and reports the
+ * resulting compression ratio (compressed size / uncompressed size) alongside. */
+
+#if defined(SELENE_WITH_LIBPNG)
+
+namespace {
+
+const sln::DynImage<>& input_image(const std::string& filename)
+{
+  static const auto img_duck = sln::read_png(sln::FileReader(sln_test::full_data_path("bike_duck.png").string()));
+  static const auto img_stickers = sln::read_png(sln::FileReader(sln_test::full_data_path("stickers.png").string()));
+  SELENE_FORCED_ASSERT(img_duck.is_valid() && img_stickers.is_valid());
+  return (filename == "bike_duck.png") ? img_duck : img_stickers;
+}
+
+void png_encoding(benchmark::State& state, const std::string& filename, sln::PNGCompressionOptions options)
+{
+  const auto& dyn_img = input_image(filename);
+  const auto nr_bytes = static_cast<std::size_t>(dyn_img.total_bytes());
+
+  sln::PNGCompressionObject obj;
+  std::vector<std::uint8_t> compressed_data;
+  compressed_data.reserve(nr_bytes);
+
+  for (auto _ : state)
+  {
+    compressed_data.clear();
+    const auto res = sln::write_png(dyn_img, obj, sln::VectorWriter(compressed_data), options);
+    SELENE_FORCED_ASSERT(res);
+    benchmark::DoNotOptimize(compressed_data.data());
+  }
+
+  state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * nr_bytes));
+  state.counters["ratio"] = static_cast<double>(compressed_data.size()) / static_cast<double>(nr_bytes);
+}
+
+sln::PNGCompressionOptions with_level(int level)
+{
+  return sln::PNGCompressionOptions(level);
+}
+
+sln::PNGCompressionOptions with_filters(int level, sln::PNGFilterSet filters)
+{
+  auto options = sln::PNGCompressionOptions(level);
+  options.filters = filters;
+  return options;
+}
+
+sln::PNGCompressionOptions with_strategy(int level, sln::PNGFilterSet filters, sln::PNGCompressionStrategy strategy)
+{
+  auto options = with_filters(level, filters);
+  options.strategy = strategy;
+  return options;
+}
+
+sln::PNGCompressionOptions with_threads(sln::PNGCompressionOptions options, int nr_threads)
+{
+  options.nr_threads = nr_threads;
+  return options;
+}
+
+}  // namespace _
+
+#define SELENE_PNG_ENCODING_BENCHMARKS(name, filename)                                                                 \
+  BENCHMARK_CAPTURE(png_encoding, name##_default, filename, sln::PNGCompressionOptions());                             \
+  BENCHMARK_CAPTURE(png_encoding, name##_level_1, filename, with_level(1));                                            \
+  BENCHMARK_CAPTURE(png_encoding, name##_level_9, filename, with_level(9));                                            \
+  BENCHMARK_CAPTURE(png_encoding, name##_filter_none, filename, with_filters(6, sln::PNGFilterSet::None));             \
+  BENCHMARK_CAPTURE(png_encoding, name##_filter_up, filename, with_filters(6, sln::PNGFilterSet::Up));                 \
+  BENCHMARK_CAPTURE(png_encoding, name##_filter_fast, filename, with_filters(6, sln::PNGFilterSet::Fast));             \
+  BENCHMARK_CAPTURE(png_encoding, name##_level_1_up_rle, filename,                                                     \
+                    with_strategy(1, sln::PNGFilterSet::Up, sln::PNGCompressionStrategy::RLE));                        \
+  BENCHMARK_CAPTURE(png_encoding, name##_level_1_sub_rle, filename,                                                    \
+                    with_strategy(1, sln::PNGFilterSet::Sub, sln::PNGCompressionStrategy::RLE));                       \
+  BENCHMARK_CAPTURE(png_encoding, name##_level_1_up_huffman, filename,                                                 \
+                    with_strategy(1, sln::PNGFilterSet::Up, sln::PNGCompressionStrategy::HuffmanOnly));                \
+  BENCHMARK_CAPTURE(png_encoding, name##_fast_preset, filename, sln::PNGCompressionOptions::fast());                 \
+  BENCHMARK_CAPTURE(png_encoding, name##_default_parallel, filename, with_threads(sln::PNGCompressionOptions(), 0));   \
+  BENCHMARK_CAPTURE(png_encoding, name##_fast_preset_parallel, filename,                                               \
+                    with_threads(sln::PNGCompressionOptions::fast(), 0));
+
+SELENE_PNG_ENCODING_BENCHMARKS(duck, "bike_duck.png")
+SELENE_PNG_ENCODING_BENCHMARKS(stickers, "stickers.png")
+
+#endif  // defined(SELENE_WITH_LIBPNG)
+
+BENCHMARK_MAIN();
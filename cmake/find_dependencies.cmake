@@ -16,6 +16,11 @@ macro(find_package_if PKG_NAME CONDITION NAME)
     endif()
 endmacro()
 
+# Threads (required; used for parallel image encoding/decoding)
+
+set(THREADS_PREFER_PTHREAD_FLAG ON)
+find_package(Threads REQUIRED)
+
 # libjpeg-turbo (or libjpeg)
 
 find_package_if(JPEG SELENE_USE_LIBJPEG "libjpeg")
@@ -82,6 +87,23 @@ if(TIFF_FOUND)
     endif()
 endif()
 
+# liburing (Linux only; there is no CMake package for it)
+
+if(SELENE_USE_LIBURING AND CMAKE_SYSTEM_NAME STREQUAL "Linux")
+    find_path(LIBURING_INCLUDE_DIR liburing.h)
+    find_library(LIBURING_LIBRARY uring)
+    if(LIBURING_INCLUDE_DIR AND LIBURING_LIBRARY)
+        set(LIBURING_FOUND ON)
+    endif()
+endif()
+
+if(LIBURING_FOUND)
+    message(STATUS "Building with liburing support (${LIBURING_LIBRARY}).")
+    set(SELENE_WITH_LIBURING ON)
+else()
+    message(STATUS "Building WITHOUT liburing support.")
+endif()
+
 # OpenCV
 
 find_package_if(OpenCV SELENE_USE_OPENCV "OpenCV")
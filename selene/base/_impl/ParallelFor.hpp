@@ -0,0 +1,138 @@
+// This file is part of the `Selene` library.
+// Copyright 2017-2019 Michael Hofmann (https://github.com/kmhofmann).
+// Distributed under MIT license. See accompanying LICENSE file in the top-level directory.
+
+#ifndef SELENE_BASE_IMPL_PARALLEL_FOR_HPP
+#define SELENE_BASE_IMPL_PARALLEL_FOR_HPP
+
+/// @file
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace sln::impl {
+
+/** \brief Returns the number of threads to use; a value <= 0 denotes the number of concurrent threads supported by the
+ * hardware.
+ */
+inline std::size_t get_nr_threads(int nr_threads)
+{
+  return (nr_threads > 0) ? static_cast<std::size_t>(nr_threads)
+                          : std::max(std::size_t{1}, static_cast<std::size_t>(std::thread::hardware_concurrency()));
+}
+
+/** \brief Returns the number of tasks to split `nr_items` units of work into, s.t. each task covers at least
+ * `min_task_size` units, and at most `nr_threads` tasks are used.
+ *
+ * Small workloads result in a single task, i.e. they are processed on the calling thread, without creating threads.
+ */
+inline std::size_t get_nr_tasks(std::size_t nr_items, std::size_t min_task_size, std::size_t nr_threads)
+{
+  return std::max(std::size_t{1}, std::min(nr_threads, nr_items / std::max(std::size_t{1}, min_task_size)));
+}
+
+/** \brief Joins all joinable threads of the given vector on destruction.
+ */
+class ThreadJoinGuard
+{
+public:
+  explicit ThreadJoinGuard(std::vector<std::thread>& threads) : threads_(threads) {}
+  ~ThreadJoinGuard()
+  {
+    for (auto& thread : threads_)
+    {
+      if (thread.joinable())
+      {
+        thread.join();
+      }
+    }
+  }
+
+  ThreadJoinGuard(const ThreadJoinGuard&) = delete;
+  ThreadJoinGuard& operator=(const ThreadJoinGuard&) = delete;
+
+private:
+  std::vector<std::thread>& threads_;
+};
+
+/** \brief Calls `func(i)` for each task index `i` in [0, `nr_tasks`), distributing the tasks over up to `nr_threads`
+ * threads (including the calling thread).
+ *
+ * Tasks are picked up dynamically, i.e. the assignment of tasks to threads is not deterministic. To obtain results that
+ * are independent of the number of threads, each task should write its result to a separate location.
+ *
+ * If a task throws, no further tasks are started, and the first exception caught is rethrown on the calling thread
+ * after all threads have been joined. If threads cannot be created, the remaining tasks are processed by the threads
+ * that could be started, and by the calling thread.
+ */
+template <typename Function>
+void parallel_for(std::size_t nr_tasks, std::size_t nr_threads, Function func)
+{
+  nr_threads = std::min(nr_threads, nr_tasks);
+
+  if (nr_threads <= 1)
+  {
+    for (std::size_t i = 0; i < nr_tasks; ++i)
+    {
+      func(i);
+    }
+    return;
+  }
+
+  std::atomic<std::size_t> next_task{0};
+  std::exception_ptr exception;
+  std::mutex exception_mutex;
+
+  auto worker = [&next_task, nr_tasks, &func, &exception, &exception_mutex]() {
+    for (auto i = next_task++; i < nr_tasks; i = next_task++)
+    {
+      try
+      {
+        func(i);
+      }
+      catch (...)
+      {
+        std::lock_guard<std::mutex> lock(exception_mutex);
+        if (!exception)
+        {
+          exception = std::current_exception();
+        }
+        next_task = nr_tasks;  // Let all threads run out of work
+      }
+    }
+  };
+
+  {
+    std::vector<std::thread> threads;
+    threads.reserve(nr_threads - 1);
+    const ThreadJoinGuard join_guard(threads);
+
+    for (std::size_t t = 0; t < nr_threads - 1; ++t)
+    {
+      try
+      {
+        threads.emplace_back(worker);
+      }
+      catch (...)
+      {
+        break;
+      }
+    }
+
+    worker();
+  }
+
+  if (exception)
+  {
+    std::rethrow_exception(exception);
+  }
+}
+
+}  // namespace sln::impl
+
+#endif  // SELENE_BASE_IMPL_PARALLEL_FOR_HPP
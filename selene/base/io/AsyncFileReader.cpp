@@ -0,0 +1,803 @@
+// This file is part of the `Selene` library.
+// Copyright 2017-2019 Michael Hofmann (https://github.com/kmhofmann).
+// Distributed under MIT license. See accompanying LICENSE file in the top-level directory.
+
+#include <selene/base/io/AsyncFileReader.hpp>
+
+#include <selene/selene_config.hpp>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(SELENE_WITH_LIBURING)
+#include <liburing.h>
+#endif
+
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace sln {
+
+namespace {
+
+#if defined(_WIN32)
+using NativeFile = HANDLE;
+#else
+using NativeFile = int;
+#endif
+
+/// A buffer for one block of the file, together with the state of the read request filling it.
+struct Block
+{
+  std::unique_ptr<std::uint8_t[]> data;
+  std::ptrdiff_t index = -1;  // the index of the file block held (or being read); -1 if none
+  std::size_t offset = 0;
+  std::size_t nr_bytes_requested = 0;
+  std::ptrdiff_t nr_bytes_read = 0;  // negative on failure
+  bool pending = false;
+};
+
+/// Reads up to `len` bytes at the given file offset; returns the number of bytes read, or -1 on failure.
+std::ptrdiff_t read_at(NativeFile file, std::uint8_t* dst, std::size_t len, std::size_t offset)
+{
+  std::size_t total = 0;
+
+  while (total < len)
+  {
+#if defined(_WIN32)
+    OVERLAPPED overlapped{};
+    const auto pos = static_cast<std::uint64_t>(offset + total);
+    overlapped.Offset = static_cast<DWORD>(pos & 0xFFFFFFFF);
+    overlapped.OffsetHigh = static_cast<DWORD>(pos >> 32);
+    const auto nr_bytes_to_read = static_cast<DWORD>(std::min(len - total, std::size_t{1} << 30));
+    DWORD nr_bytes = 0;
+
+    if (!::ReadFile(file, dst + total, nr_bytes_to_read, &nr_bytes, &overlapped))
+    {
+      return (::GetLastError() == ERROR_HANDLE_EOF) ? static_cast<std::ptrdiff_t>(total) : -1;
+    }
+#else
+    const auto nr_bytes = ::pread(file, dst + total, len - total, static_cast<off_t>(offset + total));
+
+    if (nr_bytes < 0)
+    {
+      if (errno == EINTR)
+      {
+        continue;
+      }
+
+      return -1;
+    }
+#endif
+
+    if (nr_bytes == 0)
+    {
+      break;
+    }
+
+    total += static_cast<std::size_t>(nr_bytes);
+  }
+
+  return static_cast<std::ptrdiff_t>(total);
+}
+
+class IOBackend
+{
+public:
+  virtual ~IOBackend() = default;
+
+  /// Starts reading into the block, as described by its members.
+  virtual void submit(Block& block) = 0;
+
+  /// Waits until the read into the block (if any) has completed.
+  virtual void wait(Block& block) = 0;
+
+  /// Returns whether a read into the block is still in progress; does not block.
+  virtual bool is_pending(Block& block) = 0;
+};
+
+/// Performs reads on background threads, in order of submission.
+class ThreadIOBackend : public IOBackend
+{
+public:
+  ThreadIOBackend(NativeFile file, int nr_threads) : file_(file)
+  {
+    threads_.reserve(static_cast<std::size_t>(nr_threads));
+
+    try
+    {
+      for (int i = 0; i < nr_threads; ++i)
+      {
+        threads_.emplace_back([this]() { run(); });
+      }
+    }
+    catch (...)
+    {
+      stop_and_join();
+      throw;
+    }
+  }
+
+  ~ThreadIOBackend() override
+  {
+    stop_and_join();
+  }
+
+  void submit(Block& block) override
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      queue_.push_back(&block);
+      block.pending = true;
+    }
+
+    cv_queue_.notify_one();
+  }
+
+  void wait(Block& block) override
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_done_.wait(lock, [&block]() { return !block.pending; });
+  }
+
+  bool is_pending(Block& block) override
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return block.pending;
+  }
+
+private:
+  NativeFile file_;
+  std::vector<std::thread> threads_;
+  std::deque<Block*> queue_;
+  std::mutex mutex_;
+  std::condition_variable cv_queue_;
+  std::condition_variable cv_done_;
+  bool stop_ = false;
+
+  void run()
+  {
+    for (;;)
+    {
+      Block* block = nullptr;
+
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_queue_.wait(lock, [this]() { return stop_ || !queue_.empty(); });
+
+        if (stop_)
+        {
+          return;
+        }
+
+        block = queue_.front();
+        queue_.pop_front();
+      }
+
+      const auto nr_bytes_read = read_at(file_, block->data.get(), block->nr_bytes_requested, block->offset);
+
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        block->nr_bytes_read = nr_bytes_read;
+        block->pending = false;
+      }
+
+      cv_done_.notify_all();
+    }
+  }
+
+  void stop_and_join()
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+
+    cv_queue_.notify_all();
+
+    for (auto& thread : threads_)
+    {
+      thread.join();
+    }
+
+    threads_.clear();
+  }
+};
+
+#if defined(SELENE_WITH_LIBURING)
+
+/// Performs reads via io_uring, submitting and reaping on the calling thread.
+class IoUringIOBackend : public IOBackend
+{
+public:
+  /// Returns nullptr if io_uring is not available, e.g. due to an old kernel or a restrictive seccomp policy.
+  static std::unique_ptr<IoUringIOBackend> create(int fd, unsigned nr_entries)
+  {
+    auto backend = std::unique_ptr<IoUringIOBackend>(new IoUringIOBackend(fd));
+
+    if (io_uring_queue_init(nr_entries, &backend->ring_, 0) < 0)
+    {
+      return nullptr;
+    }
+
+    backend->ring_initialized_ = true;
+    return backend;
+  }
+
+  ~IoUringIOBackend() override
+  {
+    if (!ring_initialized_)
+    {
+      return;
+    }
+
+    // The kernel may still write into the blocks; reap all outstanding reads before anything is released
+    while (nr_pending_ > 0)
+    {
+      reap(true);
+    }
+
+    io_uring_queue_exit(&ring_);
+  }
+
+  void submit(Block& block) override
+  {
+    auto sqe = io_uring_get_sqe(&ring_);
+
+    if (sqe == nullptr)
+    {
+      // Not expected, since there is at most one entry per block; read synchronously instead
+      block.nr_bytes_read = read_at(fd_, block.data.get(), block.nr_bytes_requested, block.offset);
+      block.pending = false;
+      return;
+    }
+
+    io_uring_prep_read(sqe, fd_, block.data.get(), static_cast<unsigned>(block.nr_bytes_requested), block.offset);
+    io_uring_sqe_set_data(sqe, &block);
+
+    // From here on, the entry is in the submission queue, and the block stays pending until its completion has been
+    // reaped. If submission fails now, it is retried by the next wait.
+    block.pending = true;
+    ++nr_pending_;
+    io_uring_submit(&ring_);
+  }
+
+  void wait(Block& block) override
+  {
+    while (block.pending)
+    {
+      reap(true);
+    }
+  }
+
+  bool is_pending(Block& block) override
+  {
+    reap(false);
+    return block.pending;
+  }
+
+private:
+  int fd_;
+  io_uring ring_{};
+  bool ring_initialized_ = false;
+  std::size_t nr_pending_ = 0;
+
+  explicit IoUringIOBackend(int fd) : fd_(fd)
+  { }
+
+  // Processes all available completions, optionally (submitting any queued entries and) waiting for at least one.
+  void reap(bool wait_for_completion)
+  {
+    if (wait_for_completion)
+    {
+      for (;;)
+      {
+        const auto rc = io_uring_submit_and_wait(&ring_, 1);
+
+        if (rc >= 0)
+        {
+          break;
+        }
+
+        // Any other failure would leave reads in flight that can no longer be reaped
+        SELENE_FORCED_ASSERT(rc == -EINTR || rc == -EAGAIN || rc == -EBUSY);
+      }
+    }
+
+    io_uring_cqe* cqe = nullptr;
+
+    while (io_uring_peek_cqe(&ring_, &cqe) == 0)
+    {
+      auto block = static_cast<Block*>(io_uring_cqe_get_data(cqe));
+      block->nr_bytes_read = cqe->res;  // negative error code on failure
+      block->pending = false;
+      --nr_pending_;
+      io_uring_cqe_seen(&ring_, cqe);
+    }
+  }
+};
+
+#endif  // defined(SELENE_WITH_LIBURING)
+
+}  // namespace
+
+struct AsyncFileReader::Impl
+{
+#if defined(_WIN32)
+  NativeFile file = INVALID_HANDLE_VALUE;
+#else
+  NativeFile file = -1;
+#endif
+  std::size_t file_size = 0;
+  std::size_t block_size = 0;
+  std::size_t nr_blocks_ahead = 0;
+  std::vector<Block> blocks;
+  std::unique_ptr<IOBackend> io_backend;  // declared after the blocks, so that it is destroyed first
+  AsyncIOBackend backend_type = AsyncIOBackend::Threads;
+
+  Impl() = default;
+  Impl(const Impl&) = delete;
+  Impl& operator=(const Impl&) = delete;
+
+  ~Impl()
+  {
+    io_backend.reset();  // waits for, or stops, all outstanding reads
+
+#if defined(_WIN32)
+    if (file != INVALID_HANDLE_VALUE)
+    {
+      ::CloseHandle(file);
+    }
+#else
+    if (file >= 0)
+    {
+      ::close(file);
+    }
+#endif
+  }
+
+  std::ptrdiff_t nr_file_blocks() const
+  {
+    return static_cast<std::ptrdiff_t>((file_size + block_size - 1) / block_size);
+  }
+
+  // The block must not be pending, i.e. any previous read into it must have completed.
+  void request(std::ptrdiff_t index, Block& block) noexcept
+  {
+    block.index = index;
+    block.offset = static_cast<std::size_t>(index) * block_size;
+    block.nr_bytes_requested = std::min(block_size, file_size - block.offset);
+    block.nr_bytes_read = 0;
+
+    try
+    {
+      io_backend->submit(block);
+    }
+    catch (...)
+    {
+      // Not submitted; mark the read as failed, so that load() completes it synchronously
+      block.nr_bytes_read = -1;
+      block.pending = false;
+    }
+  }
+
+  Block& load(std::ptrdiff_t index)
+  {
+    const auto nr_blocks = static_cast<std::ptrdiff_t>(blocks.size());
+    auto& block = blocks[static_cast<std::size_t>(index % nr_blocks)];
+
+    if (block.index != index)
+    {
+      io_backend->wait(block);  // a stale read may still be writing into the buffer
+      request(index, block);
+    }
+
+    // Keep the read-ahead window filled. Buffers still busy with stale reads (after seeking) are skipped instead of
+    // waited for; they will be requested again once the read position gets closer.
+    const auto last_index = std::min(index + static_cast<std::ptrdiff_t>(nr_blocks_ahead), nr_file_blocks() - 1);
+    for (auto i = index + 1; i <= last_index; ++i)
+    {
+      auto& next_block = blocks[static_cast<std::size_t>(i % nr_blocks)];
+
+      if (next_block.index != i && !io_backend->is_pending(next_block))
+      {
+        request(i, next_block);
+      }
+    }
+
+    io_backend->wait(block);
+
+    // Complete short or failed asynchronous reads synchronously
+    if (block.nr_bytes_read < static_cast<std::ptrdiff_t>(block.nr_bytes_requested))
+    {
+      const auto nr_done = static_cast<std::size_t>(std::max(block.nr_bytes_read, std::ptrdiff_t{0}));
+      const auto nr_rest = read_at(file, block.data.get() + nr_done, block.nr_bytes_requested - nr_done,
+                                   block.offset + nr_done);
+      block.nr_bytes_read = (nr_rest < 0) ? -1 : static_cast<std::ptrdiff_t>(nr_done) + nr_rest;
+    }
+
+    return block;
+  }
+};
+
+/** \brief Default constructor. No file is opened.
+ */
+AsyncFileReader::AsyncFileReader() = default;
+
+/** \brief Opens the specified file for reading, and starts reading its first blocks.
+ *
+ * If the file `filename` can not be opened, then is_open() will return false.
+ * See also AsyncFileReader::open.
+ *
+ * \param filename The name of the file to be opened for reading.
+ * \param options The reader options.
+ */
+AsyncFileReader::AsyncFileReader(const char* filename, const AsyncFileReaderOptions& options)
+{
+  open(filename, options);
+}
+
+/** \brief Opens the specified file for reading, and starts reading its first blocks.
+ *
+ * If the file `filename` can not be opened, then is_open() will return false.
+ * See also AsyncFileReader::open.
+ *
+ * \param filename The name of the file to be opened for reading.
+ * \param options The reader options.
+ */
+AsyncFileReader::AsyncFileReader(const std::string& filename, const AsyncFileReaderOptions& options)
+{
+  open(filename, options);
+}
+
+/** \brief Destructor; waits for outstanding reads, and closes the file.
+ */
+AsyncFileReader::~AsyncFileReader() = default;
+
+/** \brief Move constructor.
+ */
+AsyncFileReader::AsyncFileReader(AsyncFileReader&& other) noexcept
+    : impl_(std::move(other.impl_))
+    , buf_begin_(std::exchange(other.buf_begin_, nullptr))
+    , buf_ptr_(std::exchange(other.buf_ptr_, nullptr))
+    , buf_end_(std::exchange(other.buf_end_, nullptr))
+    , buf_offset_(std::exchange(other.buf_offset_, 0))
+{
+}
+
+/** \brief Move assignment operator.
+ */
+AsyncFileReader& AsyncFileReader::operator=(AsyncFileReader&& other) noexcept
+{
+  if (this != &other)
+  {
+    impl_ = std::move(other.impl_);
+    buf_begin_ = std::exchange(other.buf_begin_, nullptr);
+    buf_ptr_ = std::exchange(other.buf_ptr_, nullptr);
+    buf_end_ = std::exchange(other.buf_end_, nullptr);
+    buf_offset_ = std::exchange(other.buf_offset_, 0);
+  }
+
+  return *this;
+}
+
+/** \brief Opens the specified file for reading, and starts reading its first blocks.
+ *
+ * Any already open file will be closed.
+ * Opening can fail for various reasons, e.g. if the specified file does not exist, or is not a regular file.
+ *
+ * \param filename The name of the file to be opened for reading.
+ * \param options The reader options.
+ * \return True, if the file was successfully opened; false otherwise.
+ */
+bool AsyncFileReader::open(const char* filename, const AsyncFileReaderOptions& options) noexcept
+{
+  close();
+
+  if (options.block_size == 0)
+  {
+    return false;
+  }
+
+  try
+  {
+    auto impl = std::make_unique<Impl>();
+
+#if defined(_WIN32)
+    impl->file = ::CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                               FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    LARGE_INTEGER file_size;
+
+    if (impl->file == INVALID_HANDLE_VALUE || !::GetFileSizeEx(impl->file, &file_size))
+    {
+      return false;
+    }
+
+    impl->file_size = static_cast<std::size_t>(file_size.QuadPart);
+#else
+    impl->file = ::open(filename, O_RDONLY | O_CLOEXEC);
+    struct stat file_stat{};
+
+    if (impl->file < 0 || ::fstat(impl->file, &file_stat) != 0 || !S_ISREG(file_stat.st_mode))
+    {
+      return false;
+    }
+
+    impl->file_size = static_cast<std::size_t>(file_stat.st_size);
+#endif
+
+    // No more buffers (or larger ones) than needed to hold the whole file
+    impl->block_size = options.block_size;
+    const auto nr_blocks = static_cast<std::size_t>(
+        std::clamp(impl->nr_file_blocks(), std::ptrdiff_t{1}, static_cast<std::ptrdiff_t>(options.nr_blocks_ahead + 1)));
+    const auto buffer_size = std::max(std::min(options.block_size, impl->file_size), std::size_t{1});
+    impl->nr_blocks_ahead = nr_blocks - 1;
+    impl->blocks.resize(nr_blocks);
+
+    for (auto& block : impl->blocks)
+    {
+      block.data.reset(new std::uint8_t[buffer_size]);
+    }
+
+#if defined(SELENE_WITH_LIBURING)
+    if (options.backend != AsyncIOBackend::Threads)
+    {
+      impl->io_backend = IoUringIOBackend::create(impl->file, static_cast<unsigned>(nr_blocks));
+      impl->backend_type = AsyncIOBackend::IoUring;
+    }
+#endif
+
+    if (!impl->io_backend)
+    {
+      impl->io_backend = std::make_unique<ThreadIOBackend>(impl->file, std::max(options.nr_threads, 1));
+      impl->backend_type = AsyncIOBackend::Threads;
+    }
+
+    impl_ = std::move(impl);
+  }
+  catch (...)
+  {
+    return false;
+  }
+
+  reset_buffer(0);
+
+  // Start reading right away, overlapping with whatever the caller does until the first read
+  if (impl_->file_size > 0)
+  {
+    for (std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t>(impl_->blocks.size()); ++i)
+    {
+      impl_->request(i, impl_->blocks[static_cast<std::size_t>(i)]);
+    }
+  }
+
+  return true;
+}
+
+/** \brief Opens the specified file for reading, and starts reading its first blocks.
+ *
+ * Any already open file will be closed.
+ * Opening can fail for various reasons, e.g. if the specified file does not exist, or is not a regular file.
+ *
+ * \param filename The name of the file to be opened for reading.
+ * \param options The reader options.
+ * \return True, if the file was successfully opened; false otherwise.
+ */
+bool AsyncFileReader::open(const std::string& filename, const AsyncFileReaderOptions& options) noexcept
+{
+  return open(filename.c_str(), options);
+}
+
+/** \brief Closes an open file, after waiting for any outstanding reads.
+ *
+ * The function will have no effect, if no file is currently opened.
+ */
+void AsyncFileReader::close() noexcept
+{
+  impl_.reset();
+  reset_buffer(0);
+}
+
+/** \brief Returns whether a file is open.
+ *
+ * \return True, if a file is open; false otherwise.
+ */
+bool AsyncFileReader::is_open() const noexcept
+{
+  return impl_ != nullptr;
+}
+
+/** \brief Returns whether the end of the file has been reached.
+ *
+ * \return True, if the end of the file has been reached (or if no file is open); false otherwise.
+ */
+bool AsyncFileReader::is_eof() const noexcept
+{
+  return !is_open() || position() >= static_cast<std::ptrdiff_t>(impl_->file_size);
+}
+
+/** \brief Returns the current read position.
+ *
+ * \return The current read position, or -1 if no file is open.
+ */
+std::ptrdiff_t AsyncFileReader::position() const noexcept
+{
+  return is_open() ? buf_offset_ + (buf_ptr_ - buf_begin_) : std::ptrdiff_t(-1);
+}
+
+/** \brief Returns the size of the open file.
+ *
+ * \return The size of the open file in bytes, or 0 if no file is open.
+ */
+std::size_t AsyncFileReader::size() const noexcept
+{
+  return is_open() ? impl_->file_size : std::size_t{0};
+}
+
+/** \brief Returns the I/O backend in use.
+ *
+ * This can differ from the requested backend, if the requested one is not available on the running system.
+ *
+ * \return The I/O backend in use. If no file is open, returns AsyncIOBackend::Auto.
+ */
+AsyncIOBackend AsyncFileReader::backend() const noexcept
+{
+  return is_open() ? impl_->backend_type : AsyncIOBackend::Auto;
+}
+
+/** \brief Resets the read position to the beginning of the file.
+ *
+ * The function will have no effect if no file is open.
+ */
+void AsyncFileReader::rewind() noexcept
+{
+  seek_abs(0);
+}
+
+/** \brief Performs an absolute seek operation to the specified offset.
+ *
+ * Failure cases include no file being open, or the offset being outside the file.
+ *
+ * \param offset The absolute offset in bytes.
+ * \return True, if the seek operation was successful; false on failure.
+ */
+bool AsyncFileReader::seek_abs(std::ptrdiff_t offset) noexcept
+{
+  if (!is_open() || offset < 0 || offset > static_cast<std::ptrdiff_t>(impl_->file_size))
+  {
+    return false;
+  }
+
+  if (buf_begin_ != nullptr && offset >= buf_offset_ && offset <= buf_offset_ + (buf_end_ - buf_begin_))
+  {
+    buf_ptr_ = buf_begin_ + (offset - buf_offset_);
+  }
+  else
+  {
+    reset_buffer(offset);  // the respective block is loaded on the next read
+  }
+
+  return true;
+}
+
+/** \brief Performs a relative seek operation by the specified offset.
+ *
+ * Failure cases include no file being open, or the resulting position being outside the file.
+ *
+ * \param offset The relative offset in bytes.
+ * \return True, if the seek operation was successful; false on failure.
+ */
+bool AsyncFileReader::seek_rel(std::ptrdiff_t offset) noexcept
+{
+  return is_open() && seek_abs(position() + offset);
+}
+
+/** \brief Performs an absolute seek operation to the specified offset, relative to the end of the file.
+ *
+ * Failure cases include no file being open, or the resulting position being outside the file.
+ *
+ * \param offset The offset in bytes, relative to the end of the file.
+ * \return True, if the seek operation was successful; false on failure.
+ */
+bool AsyncFileReader::seek_end(std::ptrdiff_t offset) noexcept
+{
+  return is_open() && seek_abs(static_cast<std::ptrdiff_t>(impl_->file_size) + offset);
+}
+
+/** \brief Returns the data buffered at the current read position, without advancing the position.
+ *
+ * Waits for the block containing the current position to be read, if necessary. The returned region extends (at
+ * most) to the end of this block, and stays valid until the next read or seek operation.
+ * Consumers that can process data in place (e.g. decoder source managers) can use this to avoid a copy, advancing
+ * the position via `seek_rel()` afterwards.
+ *
+ * \return The buffered data at the current read position; empty at the end of the file, or on failure.
+ */
+ConstantMemoryRegion AsyncFileReader::peek() noexcept
+{
+  if (buf_ptr_ == buf_end_ && !load_current_block())
+  {
+    return ConstantMemoryRegion{};
+  }
+
+  return ConstantMemoryRegion{buf_ptr_, static_cast<std::size_t>(buf_end_ - buf_ptr_)};
+}
+
+std::size_t AsyncFileReader::read_bytes(std::uint8_t* dst, std::size_t nr_bytes) noexcept
+{
+  std::size_t total = 0;
+
+  while (total < nr_bytes)
+  {
+    if (buf_ptr_ == buf_end_ && !load_current_block())
+    {
+      break;
+    }
+
+    const auto nr_bytes_to_copy = std::min(nr_bytes - total, static_cast<std::size_t>(buf_end_ - buf_ptr_));
+    std::memcpy(dst + total, buf_ptr_, nr_bytes_to_copy);
+    buf_ptr_ += nr_bytes_to_copy;
+    total += nr_bytes_to_copy;
+  }
+
+  return total;
+}
+
+bool AsyncFileReader::load_current_block() noexcept
+{
+  const auto pos = position();
+
+  if (!is_open() || pos >= static_cast<std::ptrdiff_t>(impl_->file_size))
+  {
+    return false;
+  }
+
+  const Block* block = nullptr;
+
+  try
+  {
+    block = &impl_->load(pos / static_cast<std::ptrdiff_t>(impl_->block_size));
+  }
+  catch (...)
+  {
+    // Blocks are only re-used after waiting for their previous read, so one still pending here stays untouched
+    reset_buffer(pos);
+    return false;
+  }
+
+  if (block->nr_bytes_read <= pos - static_cast<std::ptrdiff_t>(block->offset))
+  {
+    reset_buffer(pos);  // read failure (or the file was truncated)
+    return false;
+  }
+
+  buf_begin_ = block->data.get();
+  buf_end_ = buf_begin_ + block->nr_bytes_read;
+  buf_offset_ = static_cast<std::ptrdiff_t>(block->offset);
+  buf_ptr_ = buf_begin_ + (pos - buf_offset_);
+  return true;
+}
+
+void AsyncFileReader::reset_buffer(std::ptrdiff_t offset) noexcept
+{
+  buf_begin_ = nullptr;
+  buf_ptr_ = nullptr;
+  buf_end_ = nullptr;
+  buf_offset_ = offset;
+}
+
+}  // namespace sln
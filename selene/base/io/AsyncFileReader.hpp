@@ -0,0 +1,228 @@
+// This file is part of the `Selene` library.
+// Copyright 2017-2019 Michael Hofmann (https://github.com/kmhofmann).
+// Distributed under MIT license. See accompanying LICENSE file in the top-level directory.
+
+#ifndef SELENE_IO_ASYNC_FILE_READER_HPP
+#define SELENE_IO_ASYNC_FILE_READER_HPP
+
+/// @file
+
+#include <selene/base/Assert.hpp>
+
+#include <selene/base/io/MemoryRegion.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <type_traits>
+
+namespace sln {
+
+/// \addtogroup group-base-io
+/// @{
+
+/** \brief The mechanism used by an AsyncFileReader to perform its reads.
+ */
+enum class AsyncIOBackend : unsigned char
+{
+  Auto,  ///< Use io_uring, if available (see IoUring); otherwise use background threads.
+  IoUring,  ///< Use io_uring (Linux; requires liburing at build time). Falls back to threads, if not available.
+  Threads,  ///< Use background threads performing positional reads.
+};
+
+/** \brief Options for the AsyncFileReader.
+ *
+ * The file is read in blocks of `block_size` bytes. In addition to the block containing the current read position, up
+ * to `nr_blocks_ahead` subsequent blocks are read ahead asynchronously. The read-ahead window hence bounds the memory
+ * used for buffering to `(nr_blocks_ahead + 1) * block_size` bytes.
+ */
+struct AsyncFileReaderOptions
+{
+  std::size_t block_size;  ///< The size of each block read, in bytes.
+  std::size_t nr_blocks_ahead;  ///< The number of blocks read ahead of the current read position.
+  AsyncIOBackend backend;  ///< The requested I/O backend.
+  int nr_threads;  ///< The number of background threads, if the thread backend is used.
+
+  /** \brief Constructor, setting the respective options.
+   *
+   * @param block_size_ The size of each block read, in bytes.
+   * @param nr_blocks_ahead_ The number of blocks read ahead of the current read position.
+   * @param backend_ The requested I/O backend.
+   * @param nr_threads_ The number of background threads, if the thread backend is used.
+   */
+  explicit AsyncFileReaderOptions(std::size_t block_size_ = 256 * 1024,
+                                  std::size_t nr_blocks_ahead_ = 4,
+                                  AsyncIOBackend backend_ = AsyncIOBackend::Auto,
+                                  int nr_threads_ = 1)
+      : block_size(block_size_), nr_blocks_ahead(nr_blocks_ahead_), backend(backend_), nr_threads(nr_threads_)
+  { }
+};
+
+/** \brief Class for reading binary data from files, reading ahead of the current position asynchronously.
+ *
+ * Whereas reading via FileReader blocks whenever the requested data is not yet in the page cache, an AsyncFileReader
+ * issues reads for the blocks following the current read position ahead of time, so that I/O overlaps with the
+ * processing (e.g. decoding) of the data already read.
+ *
+ * Provides the same interface as the FileReader and MemoryReader classes, and can be used as source for decoding
+ * images via `read_image()`, `read_jpeg()`, `read_png()` or `read_tiff()`.
+ *
+ * Random access is supported; seeking outside the read-ahead window simply restarts reading ahead from the new
+ * position. The file is assumed not to change in size while it is open.
+ */
+class AsyncFileReader
+{
+public:
+  AsyncFileReader();
+  explicit AsyncFileReader(const char* filename, const AsyncFileReaderOptions& options = AsyncFileReaderOptions());
+  explicit AsyncFileReader(const std::string& filename, const AsyncFileReaderOptions& options = AsyncFileReaderOptions());
+  ~AsyncFileReader();
+
+  AsyncFileReader(const AsyncFileReader&) = delete;
+  AsyncFileReader& operator=(const AsyncFileReader&) = delete;
+  AsyncFileReader(AsyncFileReader&&) noexcept;
+  AsyncFileReader& operator=(AsyncFileReader&&) noexcept;
+
+  bool open(const char* filename, const AsyncFileReaderOptions& options = AsyncFileReaderOptions()) noexcept;
+  bool open(const std::string& filename, const AsyncFileReaderOptions& options = AsyncFileReaderOptions()) noexcept;
+  void close() noexcept;
+
+  bool is_open() const noexcept;
+  bool is_eof() const noexcept;
+  std::ptrdiff_t position() const noexcept;
+  std::size_t size() const noexcept;
+  AsyncIOBackend backend() const noexcept;
+
+  void rewind() noexcept;
+  bool seek_abs(std::ptrdiff_t offset) noexcept;
+  bool seek_rel(std::ptrdiff_t offset) noexcept;
+  bool seek_end(std::ptrdiff_t offset) noexcept;
+
+  template <typename T, typename = std::enable_if_t<std::is_trivially_copyable_v<T>>>
+  bool read(T& value) noexcept;
+
+  template <typename T, typename = std::enable_if_t<std::is_trivially_copyable_v<T>>>
+  std::size_t read(T* values, std::size_t nr_values) noexcept;
+
+  ConstantMemoryRegion peek() noexcept;
+
+private:
+  struct Impl;
+  std::unique_ptr<Impl> impl_;
+
+  // The buffered contents of the block containing the current position; empty after seeking outside of it.
+  const std::uint8_t* buf_begin_ = nullptr;
+  const std::uint8_t* buf_ptr_ = nullptr;
+  const std::uint8_t* buf_end_ = nullptr;
+  std::ptrdiff_t buf_offset_ = 0;  // file offset corresponding to buf_begin_
+
+  std::size_t read_bytes(std::uint8_t* dst, std::size_t nr_bytes) noexcept;
+  bool load_current_block() noexcept;
+  void reset_buffer(std::ptrdiff_t offset) noexcept;
+};
+
+template <typename T, typename = std::enable_if_t<std::is_trivially_copyable_v<T>>>
+T read(AsyncFileReader& source);
+
+template <typename T, typename = std::enable_if_t<std::is_trivially_copyable_v<T>>>
+bool read(AsyncFileReader& source, T& value) noexcept;
+
+template <typename T, typename = std::enable_if_t<std::is_trivially_copyable_v<T>>>
+std::size_t read(AsyncFileReader& source, T* values, std::size_t nr_values) noexcept;
+
+/// @}
+
+// ----------
+// Implementation:
+
+/** \brief Reads an element of type T and writes the element to the output parameter `value`.
+ *
+ * In generic code, prefer using the corresponding non-member function.
+ *
+ * \tparam T The type of the data element to be read. Needs to be trivially copyable.
+ * \param[out] value An element of type T, if the read operation was successful.
+ * \return True, if read operation was successful, false otherwise.
+ */
+template <typename T, typename>
+inline bool AsyncFileReader::read(T& value) noexcept
+{
+  return read(&value, 1) == 1;
+}
+
+/** \brief Reads `nr_values` elements of type T and writes the elements to the output parameter `values`.
+ *
+ * In generic code, prefer using the corresponding non-member function.
+ *
+ * \tparam T The type of the data elements to be read. Needs to be trivially copyable.
+ * \param[out] values A pointer to a memory location where the read elements should be written to.
+ * \param nr_values The number of data elements to read.
+ * \return The number of data elements that were successfully read.
+ */
+template <typename T, typename>
+inline std::size_t AsyncFileReader::read(T* values, std::size_t nr_values) noexcept
+{
+  const auto nr_bytes = nr_values * sizeof(T);
+
+  // Fast path: the requested data is part of the current block
+  if (static_cast<std::size_t>(buf_end_ - buf_ptr_) >= nr_bytes)
+  {
+    std::memcpy(static_cast<void*>(values), buf_ptr_, nr_bytes);
+    buf_ptr_ += nr_bytes;
+    return nr_values;
+  }
+
+  return read_bytes(reinterpret_cast<std::uint8_t*>(values), nr_bytes) / sizeof(T);
+}
+
+// ----------
+
+/** \brief Reads an element of type T from `source` and returns the element.
+ *
+ * The function does not perform an explicit check (beyond a debug-mode assertion) whether the requested element was
+ * actually read. If the read operation failed, then the returned result is undefined.
+ *
+ * \tparam T The type of the data element to be read. Needs to be trivially copyable.
+ * \param source The source AsyncFileReader instance.
+ * \return An element of type T, if the read operation was successful.
+ */
+template <typename T, typename>
+T read(AsyncFileReader& source)
+{
+  T value{};
+  [[maybe_unused]] bool read = source.read(value);
+  SELENE_ASSERT(read);
+  return value;
+}
+
+/** \brief Reads an element of type T from `source` and writes the element to the output parameter `value`.
+ *
+ * \tparam T The type of the data element to be read. Needs to be trivially copyable.
+ * \param source The source AsyncFileReader instance.
+ * \param[out] value An element of type T, if the read operation was successful.
+ * \return True, if read operation was successful, false otherwise.
+ */
+template <typename T, typename>
+inline bool read(AsyncFileReader& source, T& value) noexcept
+{
+  return source.read(value);
+}
+
+/** \brief Reads `nr_values` elements of type T from `source` and writes the elements to the output parameter `values`.
+ *
+ * \tparam T The type of the data elements to be read. Needs to be trivially copyable.
+ * \param source The source AsyncFileReader instance.
+ * \param[out] values A pointer to a memory location where the read elements should be written to.
+ * \param nr_values The number of data elements to read.
+ * \return The number of data elements that were successfully read.
+ */
+template <typename T, typename>
+inline std::size_t read(AsyncFileReader& source, T* values, std::size_t nr_values) noexcept
+{
+  return source.read(values, nr_values);
+}
+
+}  // namespace sln
+
+#endif  // SELENE_IO_ASYNC_FILE_READER_HPP
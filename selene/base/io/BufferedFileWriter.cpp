@@ -0,0 +1,673 @@
+// This file is part of the `Selene` library.
+// Copyright 2017-2019 Michael Hofmann (https://github.com/kmhofmann).
+// Distributed under MIT license. See accompanying LICENSE file in the top-level directory.
+
+#include <selene/base/io/BufferedFileWriter.hpp>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <cerrno>
+#include <utility>
+
+namespace sln {
+
+namespace {
+
+// Alignment of file offsets, lengths and memory addresses for direct I/O; covers common logical block sizes.
+constexpr std::size_t direct_io_alignment = 4096;
+
+#if defined(_WIN32)
+using NativeFile = HANDLE;
+
+bool write_at(NativeFile file, const std::uint8_t* data, std::size_t len, std::ptrdiff_t offset)
+{
+  while (len > 0)
+  {
+    OVERLAPPED overlapped{};
+    const auto pos = static_cast<std::uint64_t>(offset);
+    overlapped.Offset = static_cast<DWORD>(pos & 0xFFFFFFFF);
+    overlapped.OffsetHigh = static_cast<DWORD>(pos >> 32);
+    const auto nr_bytes_to_write = static_cast<DWORD>(std::min(len, std::size_t{1} << 30));
+    DWORD nr_bytes = 0;
+
+    if (!::WriteFile(file, data, nr_bytes_to_write, &nr_bytes, &overlapped) || nr_bytes == 0)
+    {
+      return false;
+    }
+
+    data += nr_bytes;
+    len -= nr_bytes;
+    offset += static_cast<std::ptrdiff_t>(nr_bytes);
+  }
+
+  return true;
+}
+
+std::ptrdiff_t read_at(NativeFile file, std::uint8_t* dst, std::size_t len, std::ptrdiff_t offset)
+{
+  std::size_t total = 0;
+
+  while (total < len)
+  {
+    OVERLAPPED overlapped{};
+    const auto pos = static_cast<std::uint64_t>(offset) + total;
+    overlapped.Offset = static_cast<DWORD>(pos & 0xFFFFFFFF);
+    overlapped.OffsetHigh = static_cast<DWORD>(pos >> 32);
+    const auto nr_bytes_to_read = static_cast<DWORD>(std::min(len - total, std::size_t{1} << 30));
+    DWORD nr_bytes = 0;
+
+    if (!::ReadFile(file, dst + total, nr_bytes_to_read, &nr_bytes, &overlapped))
+    {
+      return (::GetLastError() == ERROR_HANDLE_EOF) ? static_cast<std::ptrdiff_t>(total) : -1;
+    }
+
+    if (nr_bytes == 0)
+    {
+      break;
+    }
+
+    total += nr_bytes;
+  }
+
+  return static_cast<std::ptrdiff_t>(total);
+}
+#else
+using NativeFile = int;
+
+bool write_at(NativeFile fd, const std::uint8_t* data, std::size_t len, std::ptrdiff_t offset)
+{
+  while (len > 0)
+  {
+    const auto nr_bytes = ::pwrite(fd, data, len, static_cast<off_t>(offset));
+
+    if (nr_bytes < 0 && errno == EINTR)
+    {
+      continue;
+    }
+
+    if (nr_bytes <= 0)
+    {
+      return false;
+    }
+
+    data += nr_bytes;
+    len -= static_cast<std::size_t>(nr_bytes);
+    offset += nr_bytes;
+  }
+
+  return true;
+}
+
+std::ptrdiff_t read_at(NativeFile fd, std::uint8_t* dst, std::size_t len, std::ptrdiff_t offset)
+{
+  std::size_t total = 0;
+
+  while (total < len)
+  {
+    const auto nr_bytes = ::pread(fd, dst + total, len - total, static_cast<off_t>(offset) + static_cast<off_t>(total));
+
+    if (nr_bytes < 0 && errno == EINTR)
+    {
+      continue;
+    }
+
+    if (nr_bytes < 0)
+    {
+      return -1;
+    }
+
+    if (nr_bytes == 0)
+    {
+      break;
+    }
+
+    total += static_cast<std::size_t>(nr_bytes);
+  }
+
+  return static_cast<std::ptrdiff_t>(total);
+}
+#endif
+
+/// Writes two consecutive pieces of data, in a single system call where possible.
+bool write_at(NativeFile file,
+              const std::uint8_t* data_0,
+              std::size_t len_0,
+              const std::uint8_t* data_1,
+              std::size_t len_1,
+              std::ptrdiff_t offset)
+{
+#if defined(__linux__)
+  iovec iov[2] = {{const_cast<std::uint8_t*>(data_0), len_0}, {const_cast<std::uint8_t*>(data_1), len_1}};
+  ssize_t nr_bytes = 0;
+
+  do
+  {
+    nr_bytes = ::pwritev(file, iov, 2, static_cast<off_t>(offset));
+  } while (nr_bytes < 0 && errno == EINTR);
+
+  if (nr_bytes < 0)
+  {
+    return false;
+  }
+
+  // Complete a partial write
+  const auto nr_written = static_cast<std::size_t>(nr_bytes);
+
+  if (nr_written < len_0)
+  {
+    return write_at(file, data_0 + nr_written, len_0 - nr_written, offset + static_cast<std::ptrdiff_t>(nr_written))
+           && write_at(file, data_1, len_1, offset + static_cast<std::ptrdiff_t>(len_0));
+  }
+
+  return write_at(file, data_1 + (nr_written - len_0), len_1 - (nr_written - len_0),
+                  offset + static_cast<std::ptrdiff_t>(nr_written));
+#else
+  return write_at(file, data_0, len_0, offset) && write_at(file, data_1, len_1, offset + static_cast<std::ptrdiff_t>(len_0));
+#endif
+}
+
+}  // namespace
+
+/** \brief Opens the specified file for writing.
+ *
+ * If the file `filename` can not be opened, then is_open() will return false.
+ * See also BufferedFileWriter::open.
+ *
+ * \param filename The name of the file to be opened for writing.
+ * \param mode The writing mode, WriterMode::Write or WriterMode::Append.
+ * \param options The writer options.
+ */
+BufferedFileWriter::BufferedFileWriter(const char* filename, WriterMode mode, const BufferedFileWriterOptions& options)
+{
+  open(filename, mode, options);
+}
+
+/** \brief Opens the specified file for writing.
+ *
+ * If the file `filename` can not be opened, then is_open() will return false.
+ * See also BufferedFileWriter::open.
+ *
+ * \param filename The name of the file to be opened for writing.
+ * \param mode The writing mode, WriterMode::Write or WriterMode::Append.
+ * \param options The writer options.
+ */
+BufferedFileWriter::BufferedFileWriter(const std::string& filename,
+                                       WriterMode mode,
+                                       const BufferedFileWriterOptions& options)
+{
+  open(filename, mode, options);
+}
+
+/** \brief Destructor; writes any buffered data, and closes the file.
+ */
+BufferedFileWriter::~BufferedFileWriter()
+{
+  close();
+}
+
+/** \brief Move constructor.
+ */
+BufferedFileWriter::BufferedFileWriter(BufferedFileWriter&& other) noexcept
+#if defined(_WIN32)
+    : file_(std::exchange(other.file_, nullptr))
+#else
+    : fd_(std::exchange(other.fd_, -1))
+    , direct_fd_(std::exchange(other.direct_fd_, -1))
+#endif
+    , storage_(std::move(other.storage_))
+    , buf_(std::exchange(other.buf_, nullptr))
+    , buf_capacity_(std::exchange(other.buf_capacity_, 0))
+    , buf_len_(std::exchange(other.buf_len_, 0))
+    , buf_offset_(std::exchange(other.buf_offset_, 0))
+    , file_size_(std::exchange(other.file_size_, 0))
+    , eof_(std::exchange(other.eof_, false))
+    , failed_(std::exchange(other.failed_, false))
+{
+}
+
+/** \brief Move assignment operator.
+ */
+BufferedFileWriter& BufferedFileWriter::operator=(BufferedFileWriter&& other) noexcept
+{
+  if (this != &other)
+  {
+    close();
+#if defined(_WIN32)
+    file_ = std::exchange(other.file_, nullptr);
+#else
+    fd_ = std::exchange(other.fd_, -1);
+    direct_fd_ = std::exchange(other.direct_fd_, -1);
+#endif
+    storage_ = std::move(other.storage_);
+    buf_ = std::exchange(other.buf_, nullptr);
+    buf_capacity_ = std::exchange(other.buf_capacity_, 0);
+    buf_len_ = std::exchange(other.buf_len_, 0);
+    buf_offset_ = std::exchange(other.buf_offset_, 0);
+    file_size_ = std::exchange(other.file_size_, 0);
+    eof_ = std::exchange(other.eof_, false);
+    failed_ = std::exchange(other.failed_, false);
+  }
+
+  return *this;
+}
+
+/** \brief Opens the specified file for writing.
+ *
+ * Any already open file will be closed.
+ * In WriterMode::Write mode, an existing file is truncated; in WriterMode::Append mode, the position is set to the end
+ * of an existing file. In both cases, the file is created if it does not exist yet.
+ * The file is not opened with `O_APPEND` (which would ignore the write offsets used after seeking), i.e. appending is
+ * not atomic with respect to other writers of the same file.
+ *
+ * \param filename The name of the file to be opened for writing.
+ * \param mode The writing mode, WriterMode::Write or WriterMode::Append.
+ * \param options The writer options.
+ * \return True, if the file was successfully opened; false otherwise.
+ */
+bool BufferedFileWriter::open(const char* filename, WriterMode mode, const BufferedFileWriterOptions& options) noexcept
+{
+  close();
+
+#if defined(_WIN32)
+  file_ = ::CreateFileA(filename, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr,
+                        (mode == WriterMode::Append) ? OPEN_ALWAYS : CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+  LARGE_INTEGER file_size;
+
+  if (file_ == INVALID_HANDLE_VALUE || !::GetFileSizeEx(file_, &file_size))
+  {
+    if (file_ != INVALID_HANDLE_VALUE)
+    {
+      ::CloseHandle(file_);
+    }
+
+    file_ = nullptr;
+    return false;
+  }
+
+  file_size_ = static_cast<std::ptrdiff_t>(file_size.QuadPart);
+  const bool direct = false;  // not supported on this platform
+#else
+  fd_ = ::open(filename, O_RDWR | O_CREAT | O_CLOEXEC | ((mode == WriterMode::Append) ? 0 : O_TRUNC), 0666);
+  struct stat file_stat{};
+
+  if (fd_ < 0 || ::fstat(fd_, &file_stat) != 0)
+  {
+    close();
+    return false;
+  }
+
+  file_size_ = static_cast<std::ptrdiff_t>(file_stat.st_size);
+
+#if defined(O_DIRECT)
+  if (options.direct_io)
+  {
+    direct_fd_ = ::open(filename, O_WRONLY | O_DIRECT | O_CLOEXEC);  // fails, if not supported by the file system
+  }
+#endif
+
+  const bool direct = (direct_fd_ >= 0);
+#endif
+
+  buf_capacity_ = std::max(options.buffer_size, std::size_t{1});
+  if (direct)
+  {
+    buf_capacity_ = (buf_capacity_ + direct_io_alignment - 1) / direct_io_alignment * direct_io_alignment;
+  }
+
+  try
+  {
+    storage_.resize(buf_capacity_ + (direct ? direct_io_alignment : 0));
+  }
+  catch (...)
+  {
+    close();
+    return false;
+  }
+
+  const auto misalignment = reinterpret_cast<std::uintptr_t>(storage_.data()) % direct_io_alignment;
+  buf_ = storage_.data() + ((direct && misalignment != 0) ? direct_io_alignment - misalignment : 0);
+  buf_len_ = 0;
+  buf_offset_ = (mode == WriterMode::Append) ? file_size_ : 0;
+  eof_ = false;
+  failed_ = false;
+  return true;
+}
+
+/** \brief Opens the specified file for writing.
+ *
+ * Any already open file will be closed.
+ * In WriterMode::Write mode, an existing file is truncated; in WriterMode::Append mode, the position is set to the end
+ * of an existing file. In both cases, the file is created if it does not exist yet.
+ * The file is not opened with `O_APPEND` (which would ignore the write offsets used after seeking), i.e. appending is
+ * not atomic with respect to other writers of the same file.
+ *
+ * \param filename The name of the file to be opened for writing.
+ * \param mode The writing mode, WriterMode::Write or WriterMode::Append.
+ * \param options The writer options.
+ * \return True, if the file was successfully opened; false otherwise.
+ */
+bool BufferedFileWriter::open(const std::string& filename,
+                              WriterMode mode,
+                              const BufferedFileWriterOptions& options) noexcept
+{
+  return open(filename.c_str(), mode, options);
+}
+
+/** \brief Writes any buffered data, and closes the file.
+ *
+ * The function will have no effect, if no file is currently opened.
+ *
+ * \return True, if all data has been written successfully (or if no file was open); false otherwise.
+ */
+bool BufferedFileWriter::close() noexcept
+{
+  if (!is_open())
+  {
+    return true;
+  }
+
+  const bool success = flush();
+
+#if defined(_WIN32)
+  ::CloseHandle(file_);
+  file_ = nullptr;
+#else
+  if (direct_fd_ >= 0)
+  {
+    ::close(direct_fd_);
+    direct_fd_ = -1;
+  }
+
+  if (fd_ >= 0)
+  {
+    ::close(fd_);
+    fd_ = -1;
+  }
+#endif
+
+  storage_ = std::vector<std::uint8_t>();
+  buf_ = nullptr;
+  buf_capacity_ = 0;
+  buf_len_ = 0;
+  buf_offset_ = 0;
+  file_size_ = 0;
+  eof_ = false;
+  failed_ = false;
+  return success;
+}
+
+/** \brief Returns whether a file is open.
+ *
+ * \return True, if a file is open; false otherwise.
+ */
+bool BufferedFileWriter::is_open() const noexcept
+{
+#if defined(_WIN32)
+  return file_ != nullptr;
+#else
+  return fd_ >= 0;
+#endif
+}
+
+/** \brief Returns whether the end of the file has been reached by a previous read operation.
+ *
+ * \return True, if the end of the file has been reached (or if no file is open); false otherwise.
+ */
+bool BufferedFileWriter::is_eof() const noexcept
+{
+  return !is_open() || eof_;
+}
+
+/** \brief Returns whether full buffers are written bypassing the page cache.
+ *
+ * \return True, if direct I/O has been requested and is supported for the open file; false otherwise.
+ */
+bool BufferedFileWriter::is_direct() const noexcept
+{
+#if defined(_WIN32)
+  return false;
+#else
+  return direct_fd_ >= 0;
+#endif
+}
+
+/** \brief Returns the current write position.
+ *
+ * \return The current write position, or -1 if no file is open.
+ */
+std::ptrdiff_t BufferedFileWriter::position() const noexcept
+{
+  return is_open() ? buf_offset_ + static_cast<std::ptrdiff_t>(buf_len_) : std::ptrdiff_t(-1);
+}
+
+/** \brief Resets the write position to the beginning of the file.
+ *
+ * The function will have no effect if no file is open.
+ */
+void BufferedFileWriter::rewind() noexcept
+{
+  seek_abs(0);
+}
+
+/** \brief Performs an absolute seek operation to the specified offset.
+ *
+ * Buffered data is written out first, unless the offset equals the current position.
+ * Seeking beyond the end of the file is legal; writing there extends the file.
+ *
+ * \param offset The absolute offset in bytes.
+ * \return True, if the seek operation was successful; false on failure.
+ */
+bool BufferedFileWriter::seek_abs(std::ptrdiff_t offset) noexcept
+{
+  if (!is_open() || offset < 0)
+  {
+    return false;
+  }
+
+  if (offset != position())
+  {
+    flush_buffer(false);
+    buf_offset_ = offset;
+  }
+
+  eof_ = false;
+  return true;
+}
+
+/** \brief Performs a relative seek operation by the specified offset.
+ *
+ * Buffered data is written out first, unless the offset is zero.
+ *
+ * \param offset The relative offset in bytes.
+ * \return True, if the seek operation was successful; false on failure.
+ */
+bool BufferedFileWriter::seek_rel(std::ptrdiff_t offset) noexcept
+{
+  return is_open() && seek_abs(position() + offset);
+}
+
+/** \brief Performs an absolute seek operation to the specified offset, relative to the end of the file.
+ *
+ * Buffered data is written out first, unless the resulting offset equals the current position.
+ *
+ * \param offset The offset in bytes, relative to the end of the file.
+ * \return True, if the seek operation was successful; false on failure.
+ */
+bool BufferedFileWriter::seek_end(std::ptrdiff_t offset) noexcept
+{
+  return is_open() && seek_abs(std::max(file_size_, position()) + offset);
+}
+
+/** \brief Writes any buffered data to the file.
+ *
+ * \return True, if all data written so far has been written successfully; false otherwise.
+ */
+bool BufferedFileWriter::flush() noexcept
+{
+  return is_open() && flush_buffer(false);
+}
+
+/** \brief Returns the free space in the write buffer at the current position, for writing data into it in place.
+ *
+ * Writes out the buffered data first, if the buffer is full. After writing (a prefix of) the returned region, the
+ * number of bytes written has to be passed to `commit()`. Any other operation on the writer invalidates the region.
+ *
+ * \return The free space in the write buffer; empty, if no file is open or on failure.
+ */
+MutableMemoryRegion BufferedFileWriter::buffer_space() noexcept
+{
+  if (!is_open() || (buf_len_ == buf_capacity_ && !flush_buffer(true)) || failed_)
+  {
+    return MutableMemoryRegion{};
+  }
+
+  return MutableMemoryRegion{buf_ + buf_len_, buf_capacity_ - buf_len_};
+}
+
+/** \brief Marks the specified number of bytes at the beginning of the region returned by `buffer_space()` as written.
+ *
+ * \param nr_bytes The number of bytes written into the buffer.
+ */
+void BufferedFileWriter::commit(std::size_t nr_bytes) noexcept
+{
+  SELENE_ASSERT(nr_bytes <= buf_capacity_ - buf_len_);
+  buf_len_ += nr_bytes;
+}
+
+std::size_t BufferedFileWriter::read_bytes(std::uint8_t* dst, std::size_t nr_bytes) noexcept
+{
+  if (!is_open())
+  {
+    return 0;
+  }
+
+  flush_buffer(false);
+#if defined(_WIN32)
+  const auto nr_bytes_read = std::max(read_at(file_, dst, nr_bytes, buf_offset_), std::ptrdiff_t{0});
+#else
+  const auto nr_bytes_read = std::max(read_at(fd_, dst, nr_bytes, buf_offset_), std::ptrdiff_t{0});
+#endif
+  buf_offset_ += nr_bytes_read;
+  eof_ = eof_ || (static_cast<std::size_t>(nr_bytes_read) < nr_bytes);
+  return static_cast<std::size_t>(nr_bytes_read);
+}
+
+std::size_t BufferedFileWriter::write_bytes(const std::uint8_t* src, std::size_t nr_bytes) noexcept
+{
+  if (!is_open() || failed_)
+  {
+    return 0;
+  }
+
+  // Pass large writes on directly, together with the buffered data
+  if (nr_bytes >= buf_capacity_ && !is_direct())
+  {
+#if defined(_WIN32)
+    const bool success = write_at(file_, buf_, buf_len_, src, nr_bytes, buf_offset_);
+#else
+    const bool success = write_at(fd_, buf_, buf_len_, src, nr_bytes, buf_offset_);
+#endif
+    buf_offset_ += static_cast<std::ptrdiff_t>(buf_len_ + nr_bytes);
+    buf_len_ = 0;
+    file_size_ = std::max(file_size_, buf_offset_);
+    failed_ = !success;
+    return success ? nr_bytes : 0;
+  }
+
+  std::size_t total = 0;
+
+  while (total < nr_bytes)
+  {
+    if (buf_len_ == buf_capacity_ && !flush_buffer(true))
+    {
+      break;
+    }
+
+    const auto nr_bytes_to_copy = std::min(nr_bytes - total, buf_capacity_ - buf_len_);
+    std::memcpy(buf_ + buf_len_, src + total, nr_bytes_to_copy);
+    buf_len_ += nr_bytes_to_copy;
+    total += nr_bytes_to_copy;
+  }
+
+  return total;
+}
+
+// Writes out the buffered data. With direct I/O, a trailing partial block can be kept in the buffer, such that
+// subsequent writes stay aligned.
+bool BufferedFileWriter::flush_buffer([[maybe_unused]] bool keep_partial_block) noexcept
+{
+  file_size_ = std::max(file_size_, position());
+
+  if (buf_len_ == 0 || failed_)
+  {
+    buf_offset_ += static_cast<std::ptrdiff_t>(buf_len_);
+    buf_len_ = 0;
+    return !failed_;
+  }
+
+  bool success = true;
+
+#if defined(_WIN32)
+  success = write_at(file_, buf_, buf_len_, buf_offset_);
+#else
+  if (direct_fd_ >= 0)
+  {
+    const auto consume = [this](std::size_t nr_bytes) {
+      std::memmove(buf_, buf_ + nr_bytes, buf_len_ - nr_bytes);
+      buf_offset_ += static_cast<std::ptrdiff_t>(nr_bytes);
+      buf_len_ -= nr_bytes;
+    };
+
+    // Write up to the next aligned file offset regularly; the data following it can then be written directly
+    const auto misalignment = static_cast<std::size_t>(buf_offset_) % direct_io_alignment;
+    if (misalignment != 0)
+    {
+      const auto nr_head_bytes = std::min(direct_io_alignment - misalignment, buf_len_);
+      success = write_at(fd_, buf_, nr_head_bytes, buf_offset_);
+      consume(nr_head_bytes);
+    }
+
+    const auto nr_aligned_bytes = buf_len_ / direct_io_alignment * direct_io_alignment;
+    if (success && nr_aligned_bytes > 0)
+    {
+      if (!write_at(direct_fd_, buf_, nr_aligned_bytes, buf_offset_))
+      {
+        // Direct I/O may be refused after all (e.g. by some file systems); continue without it
+        ::close(direct_fd_);
+        direct_fd_ = -1;
+        success = write_at(fd_, buf_, nr_aligned_bytes, buf_offset_);
+      }
+
+      consume(nr_aligned_bytes);
+    }
+
+    if (success && keep_partial_block)
+    {
+      return true;
+    }
+  }
+
+  if (success && buf_len_ > 0)
+  {
+    success = write_at(fd_, buf_, buf_len_, buf_offset_);
+  }
+#endif
+
+  buf_offset_ += static_cast<std::ptrdiff_t>(buf_len_);
+  buf_len_ = 0;
+  failed_ = !success;
+  return success;
+}
+
+}  // namespace sln
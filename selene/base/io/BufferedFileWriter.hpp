@@ -0,0 +1,307 @@
+// This file is part of the `Selene` library.
+// Copyright 2017-2019 Michael Hofmann (https://github.com/kmhofmann).
+// Distributed under MIT license. See accompanying LICENSE file in the top-level directory.
+
+#ifndef SELENE_IO_BUFFERED_FILE_WRITER_HPP
+#define SELENE_IO_BUFFERED_FILE_WRITER_HPP
+
+/// @file
+
+#include <selene/base/Assert.hpp>
+
+#include <selene/base/io/MemoryRegion.hpp>
+#include <selene/base/io/WriterMode.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace sln {
+
+/// \addtogroup group-base-io
+/// @{
+
+/** \brief Options for the BufferedFileWriter.
+ *
+ * `buffer_size` denotes the size of the write buffer in bytes. Written data is collected in this buffer, and only
+ * passed to the operating system once the buffer is full (or on flushing, seeking, reading, or closing).
+ *
+ * If `direct_io` is set, the file is (additionally) opened for direct I/O (`O_DIRECT`), and full buffers are written
+ * bypassing the page cache. This is useful for writing very large files (e.g. huge TIFF images) without evicting other
+ * data from the page cache. Parts of the data that do not cover whole aligned blocks are written regularly. If the
+ * file system or operating system does not support direct I/O, the option is ignored.
+ */
+struct BufferedFileWriterOptions
+{
+  std::size_t buffer_size;  ///< The size of the write buffer, in bytes.
+  bool direct_io;  ///< Whether to write full buffers bypassing the page cache.
+
+  /** \brief Constructor, setting the respective options.
+   *
+   * @param buffer_size_ The size of the write buffer, in bytes.
+   * @param direct_io_ Whether to write full buffers bypassing the page cache.
+   */
+  explicit BufferedFileWriterOptions(std::size_t buffer_size_ = 1024 * 1024, bool direct_io_ = false)
+      : buffer_size(buffer_size_), direct_io(direct_io_)
+  { }
+};
+
+/** \brief Class for writing binary data to files, with a user-controlled write buffer.
+ *
+ * Whereas each `write()` call on a FileWriter is a separate call into the C standard library, a BufferedFileWriter
+ * collects written data in its own buffer (of configurable size) via an inlined copy, and passes it to the operating
+ * system in large chunks. Writes larger than the buffer are passed on together with the buffered data in a single
+ * vectored write call, without copying.
+ *
+ * Provides the same interface as the FileWriter class, and can be used as sink for encoding images via
+ * `write_image()`, `write_jpeg()`, `write_png()` or `write_tiff()`.
+ *
+ * Buffered data is flushed on seeking (unless to the current position) and on reading. Errors occurring while
+ * flushing are reported by `flush()` and `close()`; the destructor has no way of reporting them, so `close()` should be
+ * called explicitly (`write_image()` does so for temporary BufferedFileWriter sinks).
+ *
+ * Unlike FileWriter, WriterMode::Append does not open the file in append mode: writing starts at the end of the file
+ * as it was when opening, and seeking to earlier positions is possible. Data appended to the file concurrently by
+ * other writers may therefore be overwritten.
+ */
+class BufferedFileWriter
+{
+public:
+  BufferedFileWriter() = default;
+  explicit BufferedFileWriter(const char* filename,
+                              WriterMode mode = WriterMode::Write,
+                              const BufferedFileWriterOptions& options = BufferedFileWriterOptions());
+  explicit BufferedFileWriter(const std::string& filename,
+                              WriterMode mode = WriterMode::Write,
+                              const BufferedFileWriterOptions& options = BufferedFileWriterOptions());
+  ~BufferedFileWriter();
+
+  BufferedFileWriter(const BufferedFileWriter&) = delete;
+  BufferedFileWriter& operator=(const BufferedFileWriter&) = delete;
+  BufferedFileWriter(BufferedFileWriter&&) noexcept;
+  BufferedFileWriter& operator=(BufferedFileWriter&&) noexcept;
+
+  bool open(const char* filename,
+            WriterMode mode = WriterMode::Write,
+            const BufferedFileWriterOptions& options = BufferedFileWriterOptions()) noexcept;
+  bool open(const std::string& filename,
+            WriterMode mode = WriterMode::Write,
+            const BufferedFileWriterOptions& options = BufferedFileWriterOptions()) noexcept;
+  bool close() noexcept;
+
+  bool is_open() const noexcept;
+  bool is_eof() const noexcept;
+  bool is_direct() const noexcept;
+  std::ptrdiff_t position() const noexcept;
+
+  void rewind() noexcept;
+  bool seek_abs(std::ptrdiff_t offset) noexcept;
+  bool seek_rel(std::ptrdiff_t offset) noexcept;
+  bool seek_end(std::ptrdiff_t offset) noexcept;
+  bool flush() noexcept;
+
+  template <typename T, typename = std::enable_if_t<std::is_trivially_copyable_v<T>>>
+  bool read(T& value) noexcept;
+
+  template <typename T, typename = std::enable_if_t<std::is_trivially_copyable_v<T>>>
+  std::size_t read(T* values, std::size_t nr_values) noexcept;
+
+  template <typename T, typename = std::enable_if_t<std::is_trivially_copyable_v<T>>>
+  bool write(const T& value) noexcept;
+
+  template <typename T, typename = std::enable_if_t<std::is_trivially_copyable_v<T>>>
+  std::size_t write(const T* values, std::size_t nr_values) noexcept;
+
+  MutableMemoryRegion buffer_space() noexcept;
+  void commit(std::size_t nr_bytes) noexcept;
+
+private:
+#if defined(_WIN32)
+  void* file_ = nullptr;
+#else
+  int fd_ = -1;
+  int direct_fd_ = -1;
+#endif
+
+  std::vector<std::uint8_t> storage_;
+  std::uint8_t* buf_ = nullptr;  // aligned start of the buffer within storage_
+  std::size_t buf_capacity_ = 0;
+  std::size_t buf_len_ = 0;
+  std::ptrdiff_t buf_offset_ = 0;  // file offset of buf_; the current position is always buf_offset_ + buf_len_
+  std::ptrdiff_t file_size_ = 0;
+  bool eof_ = false;
+  bool failed_ = false;
+
+  std::size_t read_bytes(std::uint8_t* dst, std::size_t nr_bytes) noexcept;
+  std::size_t write_bytes(const std::uint8_t* src, std::size_t nr_bytes) noexcept;
+  bool flush_buffer(bool keep_partial_block) noexcept;
+};
+
+template <typename T, typename = std::enable_if_t<std::is_trivially_copyable_v<T>>>
+T read(BufferedFileWriter& sink);
+
+template <typename T, typename = std::enable_if_t<std::is_trivially_copyable_v<T>>>
+bool read(BufferedFileWriter& sink, T& value) noexcept;
+
+template <typename T, typename = std::enable_if_t<std::is_trivially_copyable_v<T>>>
+std::size_t read(BufferedFileWriter& sink, T* values, std::size_t nr_values) noexcept;
+
+template <typename T, typename = std::enable_if_t<std::is_trivially_copyable_v<T>>>
+bool write(BufferedFileWriter& sink, const T& value) noexcept;
+
+template <typename T, typename = std::enable_if_t<std::is_trivially_copyable_v<T>>>
+std::size_t write(BufferedFileWriter& sink, const T* values, std::size_t nr_values) noexcept;
+
+/// @}
+
+// ----------
+// Implementation:
+
+/** \brief Reads an element of type T and writes the element to the output parameter `value`.
+ *
+ * Any buffered data is flushed first. In generic code, prefer using the corresponding non-member function.
+ *
+ * \tparam T The type of the data element to be read. Needs to be trivially copyable.
+ * \param[out] value An element of type T, if the read operation was successful.
+ * \return True, if read operation was successful, false otherwise.
+ */
+template <typename T, typename>
+inline bool BufferedFileWriter::read(T& value) noexcept
+{
+  return read(&value, 1) == 1;
+}
+
+/** \brief Reads `nr_values` elements of type T and writes the elements to the output parameter `values`.
+ *
+ * Any buffered data is flushed first. In generic code, prefer using the corresponding non-member function.
+ *
+ * \tparam T The type of the data elements to be read. Needs to be trivially copyable.
+ * \param[out] values A pointer to a memory location where the read elements should be written to.
+ * \param nr_values The number of data elements to read.
+ * \return The number of data elements that were successfully read.
+ */
+template <typename T, typename>
+inline std::size_t BufferedFileWriter::read(T* values, std::size_t nr_values) noexcept
+{
+  return read_bytes(reinterpret_cast<std::uint8_t*>(values), nr_values * sizeof(T)) / sizeof(T);
+}
+
+/** \brief Writes an element of type T.
+ *
+ * In generic code, prefer using the corresponding non-member function.
+ *
+ * \tparam T The type of the data element to be written. Needs to be trivially copyable.
+ * \param value The element to be written.
+ * \return True, if the write operation was successful, false otherwise.
+ */
+template <typename T, typename>
+inline bool BufferedFileWriter::write(const T& value) noexcept
+{
+  return write(&value, 1) == 1;
+}
+
+/** \brief Writes `nr_values` elements of type T.
+ *
+ * In generic code, prefer using the corresponding non-member function.
+ *
+ * \tparam T The type of the data elements to be written. Needs to be trivially copyable.
+ * \param values A pointer to a memory location containing the elements to be written.
+ * \param nr_values The number of data elements to write.
+ * \return The number of data elements that were successfully written.
+ */
+template <typename T, typename>
+inline std::size_t BufferedFileWriter::write(const T* values, std::size_t nr_values) noexcept
+{
+  const auto nr_bytes = nr_values * sizeof(T);
+
+  // Fast path: the data fits into the buffer
+  if (buf_capacity_ - buf_len_ >= nr_bytes && !failed_)
+  {
+    std::memcpy(buf_ + buf_len_, static_cast<const void*>(values), nr_bytes);
+    buf_len_ += nr_bytes;
+    return nr_values;
+  }
+
+  return write_bytes(reinterpret_cast<const std::uint8_t*>(values), nr_bytes) / sizeof(T);
+}
+
+// ----------
+
+/** \brief Reads an element of type T from `sink` and returns the element.
+ *
+ * The function does not perform an explicit check (beyond a debug-mode assertion) whether the requested element was
+ * actually read. If the read operation failed, then the returned result is undefined.
+ *
+ * \tparam T The type of the data element to be read. Needs to be trivially copyable.
+ * \param sink The BufferedFileWriter instance.
+ * \return An element of type T, if the read operation was successful.
+ */
+template <typename T, typename>
+T read(BufferedFileWriter& sink)
+{
+  T value{};
+  [[maybe_unused]] bool read = sink.read(value);
+  SELENE_ASSERT(read);
+  return value;
+}
+
+/** \brief Reads an element of type T from `sink` and writes the element to the output parameter `value`.
+ *
+ * \tparam T The type of the data element to be read. Needs to be trivially copyable.
+ * \param sink The BufferedFileWriter instance.
+ * \param[out] value An element of type T, if the read operation was successful.
+ * \return True, if read operation was successful, false otherwise.
+ */
+template <typename T, typename>
+inline bool read(BufferedFileWriter& sink, T& value) noexcept
+{
+  return sink.read(value);
+}
+
+/** \brief Reads `nr_values` elements of type T from `sink` and writes the elements to the output parameter `values`.
+ *
+ * \tparam T The type of the data elements to be read. Needs to be trivially copyable.
+ * \param sink The BufferedFileWriter instance.
+ * \param[out] values A pointer to a memory location where the read elements should be written to.
+ * \param nr_values The number of data elements to read.
+ * \return The number of data elements that were successfully read.
+ */
+template <typename T, typename>
+inline std::size_t read(BufferedFileWriter& sink, T* values, std::size_t nr_values) noexcept
+{
+  return sink.read(values, nr_values);
+}
+
+/** \brief Writes an element of type T to `sink`.
+ *
+ * \tparam T The type of the data element to be written. Needs to be trivially copyable.
+ * \param sink The BufferedFileWriter instance.
+ * \param value The element to be written.
+ * \return True, if the write operation was successful, false otherwise.
+ */
+template <typename T, typename>
+inline bool write(BufferedFileWriter& sink, const T& value) noexcept
+{
+  return sink.write(value);
+}
+
+/** \brief Writes `nr_values` elements of type T to `sink`.
+ *
+ * \tparam T The type of the data elements to be written. Needs to be trivially copyable.
+ * \param sink The BufferedFileWriter instance.
+ * \param values A pointer to a memory location containing the elements to be written.
+ * \param nr_values The number of data elements to write.
+ * \return The number of data elements that were successfully written.
+ */
+template <typename T, typename>
+inline std::size_t write(BufferedFileWriter& sink, const T* values, std::size_t nr_values) noexcept
+{
+  return sink.write(values, nr_values);
+}
+
+}  // namespace sln
+
+#endif  // SELENE_IO_BUFFERED_FILE_WRITER_HPP
@@ -69,7 +69,7 @@ bool write_data_contents(const std::string& path, const std::uint8_t* data_ptr,
   }
 
   const auto nr_written = std::fwrite(data_ptr + nr_full_chunks * chunk_size, std::size_t{1}, last_chunk_size, fp);
-  if (nr_written != chunk_size)
+  if (nr_written != last_chunk_size)
   {
     std::fclose(fp);
     return false;
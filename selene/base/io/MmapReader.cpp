@@ -0,0 +1,274 @@
+// This file is part of the `Selene` library.
+// Copyright 2017-2019 Michael Hofmann (https://github.com/kmhofmann).
+// Distributed under MIT license. See accompanying LICENSE file in the top-level directory.
+
+#include <selene/base/io/MmapReader.hpp>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <utility>
+
+namespace sln {
+
+namespace {
+
+#if !defined(_WIN32)
+int to_madvise_advice(MmapAccessHint hint)
+{
+  switch (hint)
+  {
+    case MmapAccessHint::Sequential: return MADV_SEQUENTIAL;
+    case MmapAccessHint::Random: return MADV_RANDOM;
+    case MmapAccessHint::WillNeed: return MADV_WILLNEED;
+    default: return MADV_NORMAL;
+  }
+}
+#endif
+
+}  // namespace
+
+/** \brief Constructs a reader, and maps the specified file into memory.
+ *
+ * @param filename The name of the file to map.
+ * @param hint The expected access pattern.
+ */
+MmapReader::MmapReader(const char* filename, MmapAccessHint hint)
+{
+  open(filename, hint);
+}
+
+/** \brief Constructs a reader, and maps the specified file into memory.
+ *
+ * @param filename The name of the file to map.
+ * @param hint The expected access pattern.
+ */
+MmapReader::MmapReader(const std::string& filename, MmapAccessHint hint)
+{
+  open(filename, hint);
+}
+
+/** \brief Destructor; releases the mapping, if present.
+ */
+MmapReader::~MmapReader()
+{
+  close();
+}
+
+/** \brief Move constructor.
+ */
+MmapReader::MmapReader(MmapReader&& other) noexcept
+    : reader_(std::move(other.reader_))
+    , mapping_(std::exchange(other.mapping_, nullptr))
+    , mapping_len_(std::exchange(other.mapping_len_, 0))
+#if defined(_WIN32)
+    , mapping_handle_(std::exchange(other.mapping_handle_, nullptr))
+#endif
+{
+  other.reader_.close();
+}
+
+/** \brief Move assignment operator.
+ */
+MmapReader& MmapReader::operator=(MmapReader&& other) noexcept
+{
+  if (this != &other)
+  {
+    close();
+    reader_ = std::move(other.reader_);
+    mapping_ = std::exchange(other.mapping_, nullptr);
+    mapping_len_ = std::exchange(other.mapping_len_, 0);
+#if defined(_WIN32)
+    mapping_handle_ = std::exchange(other.mapping_handle_, nullptr);
+#endif
+    other.reader_.close();
+  }
+
+  return *this;
+}
+
+/** \brief Maps the specified file into memory.
+ *
+ * If another file was mapped before, its mapping is released first.
+ *
+ * @param filename The name of the file to map.
+ * @param hint The expected access pattern.
+ * @return True, if the file was successfully mapped; false otherwise.
+ */
+bool MmapReader::open(const char* filename, MmapAccessHint hint) noexcept
+{
+  close();
+
+#if defined(_WIN32)
+  auto file = ::CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                            (hint == MmapAccessHint::Random) ? FILE_FLAG_RANDOM_ACCESS : FILE_FLAG_SEQUENTIAL_SCAN,
+                            nullptr);
+
+  if (file == INVALID_HANDLE_VALUE)
+  {
+    return false;
+  }
+
+  LARGE_INTEGER file_size;
+  if (!::GetFileSizeEx(file, &file_size) || file_size.QuadPart <= 0)
+  {
+    ::CloseHandle(file);
+    return false;
+  }
+
+  auto mapping_handle = ::CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  ::CloseHandle(file);  // The mapping object keeps its own reference to the file
+
+  if (mapping_handle == nullptr)
+  {
+    return false;
+  }
+
+  auto mapping = ::MapViewOfFile(mapping_handle, FILE_MAP_READ, 0, 0, 0);
+
+  if (mapping == nullptr)
+  {
+    ::CloseHandle(mapping_handle);
+    return false;
+  }
+
+  mapping_handle_ = mapping_handle;
+  mapping_ = mapping;
+  mapping_len_ = static_cast<std::size_t>(file_size.QuadPart);
+#else
+  const auto fd = ::open(filename, O_RDONLY | O_CLOEXEC);
+
+  if (fd < 0)
+  {
+    return false;
+  }
+
+  struct stat file_stat{};
+  if (::fstat(fd, &file_stat) != 0 || !S_ISREG(file_stat.st_mode) || file_stat.st_size <= 0)
+  {
+    ::close(fd);
+    return false;
+  }
+
+  const auto len = static_cast<std::size_t>(file_stat.st_size);
+  auto mapping = ::mmap(nullptr, len, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);  // The mapping keeps its own reference to the file
+
+  if (mapping == MAP_FAILED)
+  {
+    return false;
+  }
+
+  mapping_ = mapping;
+  mapping_len_ = len;
+#endif
+
+  reader_.open(region());
+  advise(hint);
+  return true;
+}
+
+/** \brief Maps the specified file into memory.
+ *
+ * If another file was mapped before, its mapping is released first.
+ *
+ * @param filename The name of the file to map.
+ * @param hint The expected access pattern.
+ * @return True, if the file was successfully mapped; false otherwise.
+ */
+bool MmapReader::open(const std::string& filename, MmapAccessHint hint) noexcept
+{
+  return open(filename.c_str(), hint);
+}
+
+/** \brief Releases the mapping, if present.
+ */
+void MmapReader::close() noexcept
+{
+  reader_.close();
+
+  if (mapping_ == nullptr)
+  {
+    return;
+  }
+
+#if defined(_WIN32)
+  ::UnmapViewOfFile(mapping_);
+  ::CloseHandle(mapping_handle_);
+  mapping_handle_ = nullptr;
+#else
+  ::munmap(mapping_, mapping_len_);
+#endif
+
+  mapping_ = nullptr;
+  mapping_len_ = 0;
+}
+
+/** \brief Returns the memory region of the mapped file contents.
+ *
+ * @return The memory region of the mapped file contents; empty, if no file is mapped.
+ */
+ConstantMemoryRegion MmapReader::region() const noexcept
+{
+  return ConstantMemoryRegion{static_cast<const std::uint8_t*>(mapping_), mapping_len_};
+}
+
+/** \brief Advises the operating system of the expected access pattern to the whole mapping.
+ *
+ * @param hint The expected access pattern.
+ * @return True, if the advice was accepted (or is not applicable on the current platform); false otherwise.
+ */
+bool MmapReader::advise([[maybe_unused]] MmapAccessHint hint) noexcept
+{
+  if (mapping_ == nullptr)
+  {
+    return false;
+  }
+
+#if defined(_WIN32)
+  return (hint == MmapAccessHint::WillNeed) ? prefetch(0, mapping_len_) : true;
+#else
+  return ::madvise(mapping_, mapping_len_, to_madvise_advice(hint)) == 0;
+#endif
+}
+
+/** \brief Asks the operating system to start reading the specified byte range of the file into the page cache.
+ *
+ * This does not block; it can be used to overlap I/O with other work, e.g. before decoding the respective data.
+ *
+ * @param offset The byte offset of the range, relative to the beginning of the file.
+ * @param len The length of the range in bytes. The range is clamped to the file size.
+ * @return True, if the request was accepted; false otherwise.
+ */
+bool MmapReader::prefetch(std::size_t offset, std::size_t len) noexcept
+{
+  if (mapping_ == nullptr || offset >= mapping_len_)
+  {
+    return false;
+  }
+
+  len = std::min(len, mapping_len_ - offset);
+  auto begin = static_cast<std::uint8_t*>(mapping_) + offset;
+
+#if defined(_WIN32)
+  WIN32_MEMORY_RANGE_ENTRY range{begin, len};
+  return ::PrefetchVirtualMemory(::GetCurrentProcess(), 1, &range, 0) != 0;
+#else
+  // madvise() requires a page-aligned start address
+  static const auto page_size = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+  const auto misalignment = static_cast<std::size_t>(begin - static_cast<std::uint8_t*>(mapping_)) % page_size;
+  return ::madvise(begin - misalignment, len + misalignment, MADV_WILLNEED) == 0;
+#endif
+}
+
+}  // namespace sln
@@ -0,0 +1,288 @@
+// This file is part of the `Selene` library.
+// Copyright 2017-2019 Michael Hofmann (https://github.com/kmhofmann).
+// Distributed under MIT license. See accompanying LICENSE file in the top-level directory.
+
+#ifndef SELENE_IO_MMAP_READER_HPP
+#define SELENE_IO_MMAP_READER_HPP
+
+/// @file
+
+#include <selene/base/io/MemoryReader.hpp>
+#include <selene/base/io/MemoryRegion.hpp>
+
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <type_traits>
+
+namespace sln {
+
+/// \addtogroup group-base-io
+/// @{
+
+/** \brief Describes the expected access pattern to a memory-mapped file, as a hint to the operating system.
+ */
+enum class MmapAccessHint : unsigned char
+{
+  Normal,  ///< No specific access pattern.
+  Sequential,  ///< Sequential access; pages can be read ahead aggressively and freed soon after access.
+  Random,  ///< Random access; read-ahead is of little use.
+  WillNeed,  ///< The whole file will be needed soon; reading it into the page cache can start right away.
+};
+
+/** \brief Class for reading binary data from a memory-mapped file.
+ *
+ * The file is mapped into memory once, on opening. Reading then happens directly from the mapped memory (i.e. from
+ * the page cache), without an intermediate stdio buffer layer.
+ *
+ * An MmapReader reads the mapped file contents through a MemoryReader, and provides the same reading interface, so it
+ * can be used for decoding images via `read_image()`, `read_jpeg()`, `read_png()` or `read_tiff()`. The underlying
+ * MemoryReader is accessible via `memory_reader()`; it must not be closed or re-opened directly. The mapping is
+ * released on closing or destruction.
+ *
+ * Only regular, non-empty files can be mapped.
+ */
+class MmapReader
+{
+public:
+  MmapReader() = default;
+  explicit MmapReader(const char* filename, MmapAccessHint hint = MmapAccessHint::Sequential);
+  explicit MmapReader(const std::string& filename, MmapAccessHint hint = MmapAccessHint::Sequential);
+  ~MmapReader();
+
+  MmapReader(const MmapReader&) = delete;
+  MmapReader& operator=(const MmapReader&) = delete;
+  MmapReader(MmapReader&&) noexcept;
+  MmapReader& operator=(MmapReader&&) noexcept;
+
+  const std::uint8_t* handle() noexcept;
+  MemoryReader& memory_reader() noexcept;
+
+  bool open(const char* filename, MmapAccessHint hint = MmapAccessHint::Sequential) noexcept;
+  bool open(const std::string& filename, MmapAccessHint hint = MmapAccessHint::Sequential) noexcept;
+  void close() noexcept;
+
+  bool is_open() const noexcept;
+  bool is_eof() const noexcept;
+  std::ptrdiff_t position() const noexcept;
+  std::size_t size() const noexcept;
+  std::ptrdiff_t bytes_remaining() const noexcept;
+
+  void rewind() noexcept;
+  bool seek_abs(std::ptrdiff_t offset) noexcept;
+  bool seek_rel(std::ptrdiff_t offset) noexcept;
+  bool seek_end(std::ptrdiff_t offset) noexcept;
+
+  template <typename T, typename = std::enable_if_t<std::is_trivially_copyable_v<T>>>
+  bool read(T& value) noexcept;
+
+  template <typename T, typename = std::enable_if_t<std::is_trivially_copyable_v<T>>>
+  std::size_t read(T* values, std::size_t nr_values) noexcept;
+
+  ConstantMemoryRegion region() const noexcept;
+
+  bool advise(MmapAccessHint hint) noexcept;
+  bool prefetch(std::size_t offset, std::size_t len) noexcept;
+
+private:
+  MemoryReader reader_;
+  void* mapping_ = nullptr;
+  std::size_t mapping_len_ = 0;
+#if defined(_WIN32)
+  void* mapping_handle_ = nullptr;
+#endif
+};
+
+template <typename T, typename = std::enable_if_t<std::is_trivially_copyable_v<T>>>
+T read(MmapReader& source);
+
+template <typename T, typename = std::enable_if_t<std::is_trivially_copyable_v<T>>>
+bool read(MmapReader& source, T& value) noexcept;
+
+template <typename T, typename = std::enable_if_t<std::is_trivially_copyable_v<T>>>
+std::size_t read(MmapReader& source, T* values, std::size_t nr_values) noexcept;
+
+/// @}
+
+// ----------
+// Implementation:
+
+/** \brief Returns a native handle to the mapped file contents.
+ *
+ * \return A pointer to the current read position inside the mapped file contents; `nullptr` if no file is mapped.
+ */
+inline const std::uint8_t* MmapReader::handle() noexcept
+{
+  return reader_.handle();
+}
+
+/** \brief Returns the MemoryReader over the mapped file contents.
+ *
+ * The returned reader shares the read position with this MmapReader. It is only valid as long as the mapping is.
+ *
+ * \return The MemoryReader over the mapped file contents.
+ */
+inline MemoryReader& MmapReader::memory_reader() noexcept
+{
+  return reader_;
+}
+
+/** \brief Returns whether a file is mapped.
+ *
+ * \return True, if a file is mapped; false otherwise.
+ */
+inline bool MmapReader::is_open() const noexcept
+{
+  return reader_.is_open();
+}
+
+/** \brief Returns whether the end of the mapped file contents has been reached.
+ *
+ * \return True, if the read position is at the end of the mapped file contents (or if no file is mapped); false
+ * otherwise.
+ */
+inline bool MmapReader::is_eof() const noexcept
+{
+  return reader_.is_eof();
+}
+
+/** \brief Returns the current read position inside the mapped file contents.
+ *
+ * \return The read position in bytes, or -1 if no file is mapped.
+ */
+inline std::ptrdiff_t MmapReader::position() const noexcept
+{
+  return reader_.position();
+}
+
+/** \brief Returns the size of the mapped file contents.
+ *
+ * \return The size of the mapped file contents in bytes.
+ */
+inline std::size_t MmapReader::size() const noexcept
+{
+  return reader_.size();
+}
+
+/** \brief Returns the remaining data size that can still be read.
+ *
+ * \return The size in bytes of the remaining data that can still be read.
+ */
+inline std::ptrdiff_t MmapReader::bytes_remaining() const noexcept
+{
+  return reader_.bytes_remaining();
+}
+
+/** \brief Resets the read position to the beginning of the mapped file contents.
+ */
+inline void MmapReader::rewind() noexcept
+{
+  reader_.rewind();
+}
+
+/** \brief Performs an absolute seek operation to the specified offset.
+ *
+ * \param offset The absolute offset in bytes.
+ * \return True, if the seek operation was successful; false on failure.
+ */
+inline bool MmapReader::seek_abs(std::ptrdiff_t offset) noexcept
+{
+  return reader_.seek_abs(offset);
+}
+
+/** \brief Performs a relative seek operation by the specified offset.
+ *
+ * \param offset The relative offset in bytes.
+ * \return True, if the seek operation was successful; false on failure.
+ */
+inline bool MmapReader::seek_rel(std::ptrdiff_t offset) noexcept
+{
+  return reader_.seek_rel(offset);
+}
+
+/** \brief Performs an absolute seek operation to the specified offset, relative to the end of the mapped file contents.
+ *
+ * \param offset The absolute offset in bytes.
+ * \return True, if the seek operation was successful; false on failure.
+ */
+inline bool MmapReader::seek_end(std::ptrdiff_t offset) noexcept
+{
+  return reader_.seek_end(offset);
+}
+
+/** \brief Reads an element of type T and writes the element to the output parameter `value`.
+ *
+ * In generic code, prefer using the corresponding non-member function.
+ *
+ * \tparam T The type of the data element to be read. Needs to be trivially copyable.
+ * \param[out] value An element of type T, if the read operation was successful.
+ * \return True, if read operation was successful, false otherwise.
+ */
+template <typename T, typename>
+inline bool MmapReader::read(T& value) noexcept
+{
+  return reader_.read(value);
+}
+
+/** \brief Reads `nr_values` elements of type T and writes the elements to the output parameter `values`.
+ *
+ * In generic code, prefer using the corresponding non-member function.
+ *
+ * \tparam T The type of the data elements to be read. Needs to be trivially copyable.
+ * \param[out] values A pointer to a memory location where the read elements should be written to.
+ * \param nr_values The number of data elements to read.
+ * \return The number of data elements that were successfully read.
+ */
+template <typename T, typename>
+inline std::size_t MmapReader::read(T* values, std::size_t nr_values) noexcept
+{
+  return reader_.read(values, nr_values);
+}
+
+// ----------
+
+/** \brief Reads an element of type T from `source` and returns the element.
+ *
+ * The function does not perform an explicit check (beyond a debug-mode assertion) whether the requested element was
+ * actually read. If the read operation failed, then the returned result is undefined.
+ *
+ * \tparam T The type of the data element to be read. Needs to be trivially copyable.
+ * \param source The source MmapReader instance.
+ * \return An element of type T, if the read operation was successful.
+ */
+template <typename T, typename>
+T read(MmapReader& source)
+{
+  return read<T>(source.memory_reader());
+}
+
+/** \brief Reads an element of type T from `source` and writes the element to the output parameter `value`.
+ *
+ * \tparam T The type of the data element to be read. Needs to be trivially copyable.
+ * \param source The source MmapReader instance.
+ * \param[out] value An element of type T, if the read operation was successful.
+ * \return True, if read operation was successful, false otherwise.
+ */
+template <typename T, typename>
+inline bool read(MmapReader& source, T& value) noexcept
+{
+  return source.read(value);
+}
+
+/** \brief Reads `nr_values` elements of type T from `source` and writes the elements to the output parameter `values`.
+ *
+ * \tparam T The type of the data elements to be read. Needs to be trivially copyable.
+ * \param source The source MmapReader instance.
+ * \param[out] values A pointer to a memory location where the read elements should be written to.
+ * \param nr_values The number of data elements to read.
+ * \return The number of data elements that were successfully read.
+ */
+template <typename T, typename>
+inline std::size_t read(MmapReader& source, T* values, std::size_t nr_values) noexcept
+{
+  return source.read(values, nr_values);
+}
+
+}  // namespace sln
+
+#endif  // SELENE_IO_MMAP_READER_HPP
@@ -29,6 +29,8 @@ template <typename> struct is_mutable_dyn_image_view : std::false_type {};
 template <> struct is_mutable_dyn_image_view<DynImageView<ImageModifiability::Mutable>> : std::true_type {};
 template <typename Img> constexpr bool is_mutable_dyn_image_view_v = is_mutable_dyn_image_view<Img>::value;
 
+template <typename Img> constexpr bool is_dyn_image_or_mutable_view_v = is_dyn_image_v<Img> || is_mutable_dyn_image_view_v<Img>;
+
 // -----
 
 template <typename DynImgOrView>
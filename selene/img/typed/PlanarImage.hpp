@@ -0,0 +1,327 @@
+// This file is part of the `Selene` library.
+// Copyright 2017-2019 Michael Hofmann (https://github.com/kmhofmann).
+// Distributed under MIT license. See accompanying LICENSE file in the top-level directory.
+
+#ifndef SELENE_IMG_TYPED_PLANAR_IMAGE_HPP
+#define SELENE_IMG_TYPED_PLANAR_IMAGE_HPP
+
+/// @file
+
+#include <selene/base/Assert.hpp>
+
+#include <selene/img/pixel/Pixel.hpp>
+
+#include <selene/img/typed/Image.hpp>
+#include <selene/img/typed/PlanarImageView.hpp>
+
+#include <array>
+#include <cstddef>
+#include <type_traits>
+
+namespace sln {
+
+/// \addtogroup group-img-typed
+/// @{
+
+/** \brief Statically typed planar image class.
+ *
+ * An instance of `PlanarImage<T, N>` represents a statically typed multi-channel image with `N` channels of element
+ * type `T`, where each channel is stored in a separate plane (i.e. a structure-of-arrays layout), as opposed to the
+ * interleaved storage of `Image<Pixel<T, N>>`.
+ * Each plane is stored as a single-channel `Image<Pixel<T, 1>>`, and is accessible as a single-channel image view, so
+ * that per-channel operations can be applied to each plane independently (see also `for_each_plane()`). All planes
+ * always share the same size; they can only be reallocated together, via `reallocate()`.
+ *
+ * The memory of a `PlanarImage<T, N>` instance is always owned by the instance.
+ * To express a non-owning relation to the underlying data, use a `PlanarImageView<T, N, modifiability>`.
+ *
+ * See `to_planar()` and `to_interleaved()` for conversions from and to interleaved images.
+ *
+ * @tparam T The element type of each channel.
+ * @tparam N The number of channels (planes).
+ * @tparam Allocator_ The allocator type used for each plane.
+ */
+template <typename T, std::size_t N, typename Allocator_ = default_bytes_allocator>
+class PlanarImage
+{
+public:
+  using Element = T;  ///< The element type of each channel.
+  using Allocator = Allocator_;  ///< The allocator type.
+  using PlaneType = Image<Pixel<T, 1>, Allocator_>;  ///< The storage type of each plane.
+
+  constexpr static std::size_t nr_channels = N;  ///< The number of channels, i.e. planes.
+  constexpr static bool is_view = false;
+  constexpr static bool is_modifiable = true;
+
+  constexpr static ImageModifiability modifiability()
+  {
+    return ImageModifiability::Mutable;
+  }
+
+  PlanarImage() = default;  ///< Default constructor.
+
+  explicit PlanarImage(TypedLayout layout);
+
+  template <ImageModifiability modifiability_>
+  explicit PlanarImage(const PlanarImageView<T, N, modifiability_>& view);
+
+  [[nodiscard]] PixelLength width() const noexcept;
+  [[nodiscard]] PixelLength height() const noexcept;
+
+  [[nodiscard]] bool is_empty() const noexcept;
+  [[nodiscard]] bool is_valid() const noexcept;
+
+  MutableImageView<Pixel<T, 1>> plane(std::size_t channel) noexcept;
+  ConstantImageView<Pixel<T, 1>> plane(std::size_t channel) const noexcept;
+
+  MutablePlanarImageView<T, N> view() noexcept;
+  ConstantPlanarImageView<T, N> view() const noexcept;
+  ConstantPlanarImageView<T, N> constant_view() const noexcept;
+
+  void clear();
+
+  bool reallocate(TypedLayout layout);
+
+private:
+  static_assert(N > 0, "Planar image needs at least one plane");
+
+  std::array<PlaneType, N> planes_;
+};
+
+/// @}
+
+namespace impl {
+
+template <typename> struct is_planar_image_type : std::false_type {};
+template <typename T, std::size_t N, typename Allocator> struct is_planar_image_type<PlanarImage<T, N, Allocator>> : std::true_type {};
+template <typename T, std::size_t N, ImageModifiability modifiability> struct is_planar_image_type<PlanarImageView<T, N, modifiability>> : std::true_type {};
+template <typename PlanarImageType> constexpr bool is_planar_image_type_v = is_planar_image_type<std::remove_cv_t<PlanarImageType>>::value;
+
+}  // namespace impl
+
+// ----------
+// Implementation:
+
+/** \brief Constructs a planar image with the specified layout.
+ *
+ * Each of the planes is allocated with the specified layout, i.e. the layout describes a single-channel plane.
+ *
+ * @tparam T The element type of each channel.
+ * @tparam N The number of channels (planes).
+ * @tparam Allocator_ The allocator type used for each plane.
+ * @param layout The layout of each plane.
+ */
+template <typename T, std::size_t N, typename Allocator_>
+PlanarImage<T, N, Allocator_>::PlanarImage(TypedLayout layout)
+{
+  reallocate(layout);
+}
+
+/** \brief Constructs a planar image by copying the contents of a planar image view.
+ *
+ * @tparam T The element type of each channel.
+ * @tparam N The number of channels (planes).
+ * @tparam Allocator_ The allocator type used for each plane.
+ * @tparam modifiability_ Determines whether the view contents are constant or mutable.
+ * @param view The planar image view to be copied from.
+ */
+template <typename T, std::size_t N, typename Allocator_>
+template <ImageModifiability modifiability_>
+PlanarImage<T, N, Allocator_>::PlanarImage(const PlanarImageView<T, N, modifiability_>& view)
+{
+  for (std::size_t c = 0; c < N; ++c)
+  {
+    planes_[c] = PlaneType(view.plane(c));
+  }
+}
+
+/** \brief Returns the image width.
+ *
+ * @tparam T The element type of each channel.
+ * @tparam N The number of channels (planes).
+ * @tparam Allocator_ The allocator type used for each plane.
+ * @return Width of the image in pixels.
+ */
+template <typename T, std::size_t N, typename Allocator_>
+PixelLength PlanarImage<T, N, Allocator_>::width() const noexcept
+{
+  return planes_[0].width();
+}
+
+/** \brief Returns the image height.
+ *
+ * @tparam T The element type of each channel.
+ * @tparam N The number of channels (planes).
+ * @tparam Allocator_ The allocator type used for each plane.
+ * @return Height of the image in pixels.
+ */
+template <typename T, std::size_t N, typename Allocator_>
+PixelLength PlanarImage<T, N, Allocator_>::height() const noexcept
+{
+  return planes_[0].height();
+}
+
+/** \brief Returns whether the image is empty.
+ *
+ * An image is considered empty if any of its planes is empty.
+ *
+ * @tparam T The element type of each channel.
+ * @tparam N The number of channels (planes).
+ * @tparam Allocator_ The allocator type used for each plane.
+ * @return True, if the image is empty; false if it is non-empty.
+ */
+template <typename T, std::size_t N, typename Allocator_>
+bool PlanarImage<T, N, Allocator_>::is_empty() const noexcept
+{
+  for (const auto& p : planes_)
+  {
+    if (p.is_empty())
+    {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+/** \brief Returns whether the image is valid.
+ *
+ * Semantically equal to `!is_empty()`.
+ *
+ * @tparam T The element type of each channel.
+ * @tparam N The number of channels (planes).
+ * @tparam Allocator_ The allocator type used for each plane.
+ * @return True, if the image is valid; false otherwise.
+ */
+template <typename T, std::size_t N, typename Allocator_>
+bool PlanarImage<T, N, Allocator_>::is_valid() const noexcept
+{
+  return !is_empty();
+}
+
+/** \brief Returns a mutable view onto the plane of the specified channel.
+ *
+ * The plane itself cannot be reallocated through the view; use `reallocate()` to change the size of all planes.
+ *
+ * @tparam T The element type of each channel.
+ * @tparam N The number of channels (planes).
+ * @tparam Allocator_ The allocator type used for each plane.
+ * @param channel The channel index.
+ * @return A mutable single-channel view onto the respective plane.
+ */
+template <typename T, std::size_t N, typename Allocator_>
+MutableImageView<Pixel<T, 1>> PlanarImage<T, N, Allocator_>::plane(std::size_t channel) noexcept
+{
+  SELENE_ASSERT(channel < N);
+  return planes_[channel].view();
+}
+
+/** \brief Returns a constant view onto the plane of the specified channel.
+ *
+ * @tparam T The element type of each channel.
+ * @tparam N The number of channels (planes).
+ * @tparam Allocator_ The allocator type used for each plane.
+ * @param channel The channel index.
+ * @return A constant single-channel view onto the respective plane.
+ */
+template <typename T, std::size_t N, typename Allocator_>
+ConstantImageView<Pixel<T, 1>> PlanarImage<T, N, Allocator_>::plane(std::size_t channel) const noexcept
+{
+  SELENE_ASSERT(channel < N);
+  return planes_[channel].constant_view();
+}
+
+/** \brief Returns a mutable planar view onto the image planes.
+ *
+ * @tparam T The element type of each channel.
+ * @tparam N The number of channels (planes).
+ * @tparam Allocator_ The allocator type used for each plane.
+ * @return A mutable planar image view.
+ */
+template <typename T, std::size_t N, typename Allocator_>
+MutablePlanarImageView<T, N> PlanarImage<T, N, Allocator_>::view() noexcept
+{
+  std::array<MutableImageView<Pixel<T, 1>>, N> planes;
+
+  for (std::size_t c = 0; c < N; ++c)
+  {
+    planes[c] = planes_[c].view();
+  }
+
+  return MutablePlanarImageView<T, N>(planes);
+}
+
+/** \brief Returns a constant planar view onto the image planes.
+ *
+ * @tparam T The element type of each channel.
+ * @tparam N The number of channels (planes).
+ * @tparam Allocator_ The allocator type used for each plane.
+ * @return A constant planar image view.
+ */
+template <typename T, std::size_t N, typename Allocator_>
+ConstantPlanarImageView<T, N> PlanarImage<T, N, Allocator_>::view() const noexcept
+{
+  return constant_view();
+}
+
+/** \brief Returns a constant planar view onto the image planes.
+ *
+ * @tparam T The element type of each channel.
+ * @tparam N The number of channels (planes).
+ * @tparam Allocator_ The allocator type used for each plane.
+ * @return A constant planar image view.
+ */
+template <typename T, std::size_t N, typename Allocator_>
+ConstantPlanarImageView<T, N> PlanarImage<T, N, Allocator_>::constant_view() const noexcept
+{
+  std::array<ConstantImageView<Pixel<T, 1>>, N> planes;
+
+  for (std::size_t c = 0; c < N; ++c)
+  {
+    planes[c] = planes_[c].constant_view();
+  }
+
+  return ConstantPlanarImageView<T, N>(planes);
+}
+
+/** \brief Resets the planar image instance by clearing the contents of all planes.
+ *
+ * @tparam T The element type of each channel.
+ * @tparam N The number of channels (planes).
+ * @tparam Allocator_ The allocator type used for each plane.
+ */
+template <typename T, std::size_t N, typename Allocator_>
+void PlanarImage<T, N, Allocator_>::clear()
+{
+  for (auto& p : planes_)
+  {
+    p.clear();
+  }
+}
+
+/** \brief Reallocates all planes with the specified layout.
+ *
+ * No reallocation takes place for planes that already have the specified layout.
+ *
+ * @tparam T The element type of each channel.
+ * @tparam N The number of channels (planes).
+ * @tparam Allocator_ The allocator type used for each plane.
+ * @param layout The layout of each plane.
+ * @return True, if at least one plane was reallocated; false otherwise.
+ */
+template <typename T, std::size_t N, typename Allocator_>
+bool PlanarImage<T, N, Allocator_>::reallocate(TypedLayout layout)
+{
+  bool reallocated = false;
+
+  for (auto& p : planes_)
+  {
+    reallocated = p.reallocate(layout) || reallocated;
+  }
+
+  return reallocated;
+}
+
+}  // namespace sln
+
+#endif  // SELENE_IMG_TYPED_PLANAR_IMAGE_HPP
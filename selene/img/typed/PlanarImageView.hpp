@@ -0,0 +1,292 @@
+// This file is part of the `Selene` library.
+// Copyright 2017-2019 Michael Hofmann (https://github.com/kmhofmann).
+// Distributed under MIT license. See accompanying LICENSE file in the top-level directory.
+
+#ifndef SELENE_IMG_TYPED_PLANAR_IMAGE_VIEW_HPP
+#define SELENE_IMG_TYPED_PLANAR_IMAGE_VIEW_HPP
+
+/// @file
+
+#include <selene/base/Assert.hpp>
+
+#include <selene/img/pixel/Pixel.hpp>
+
+#include <selene/img/typed/ImageView.hpp>
+
+#include <array>
+#include <cstddef>
+
+namespace sln {
+
+/// \addtogroup group-img-typed
+/// @{
+
+template <typename T, std::size_t N, ImageModifiability modifiability_>
+class PlanarImageView;
+
+template <typename T, std::size_t N> using MutablePlanarImageView = PlanarImageView<T, N, ImageModifiability::Mutable>;  ///< A planar image view pointing to mutable data.
+template <typename T, std::size_t N> using ConstantPlanarImageView = PlanarImageView<T, N, ImageModifiability::Constant>;  ///< A planar image view pointing to constant data.
+
+/** \brief Statically typed planar image view class, i.e. non-owning.
+ *
+ * An instance of `PlanarImageView<T, N, modifiability>` represents a statically typed multi-channel image with `N`
+ * channels of element type `T`, where each channel is stored in a separate plane (i.e. a structure-of-arrays layout),
+ * as opposed to the interleaved storage of `ImageView<Pixel<T, N>>`.
+ * Each plane is a single-channel `ImageView<Pixel<T, 1>>`; all planes are of the same size, but may be located
+ * anywhere in memory, and may have different row strides.
+ *
+ * @tparam T The element type of each channel.
+ * @tparam N The number of channels (planes).
+ * @tparam modifiability_ Determines whether image contents are constant or mutable.
+ */
+template <typename T, std::size_t N, ImageModifiability modifiability_>
+class PlanarImageView
+{
+public:
+  using Element = T;  ///< The element type of each channel.
+  using PlaneType = ImageView<Pixel<T, 1>, modifiability_>;  ///< The type of each plane.
+
+  constexpr static std::size_t nr_channels = N;  ///< The number of channels, i.e. planes.
+  constexpr static bool is_view = true;
+  constexpr static bool is_modifiable = (modifiability_ == ImageModifiability::Mutable);
+
+  constexpr static ImageModifiability modifiability()
+  {
+    return modifiability_;
+  }
+
+  PlanarImageView() = default;  ///< Default constructor.
+  explicit PlanarImageView(const std::array<PlaneType, N>& planes);
+
+  [[nodiscard]] PixelLength width() const noexcept;
+  [[nodiscard]] PixelLength height() const noexcept;
+
+  [[nodiscard]] bool is_empty() const noexcept;
+  [[nodiscard]] bool is_valid() const noexcept;
+
+  PlaneType& plane(std::size_t channel) noexcept;
+  const PlaneType& plane(std::size_t channel) const noexcept;
+
+  std::array<PlaneType, N>& planes() noexcept;
+  const std::array<PlaneType, N>& planes() const noexcept;
+
+  PlanarImageView<T, N, modifiability_>& view() noexcept;
+  const PlanarImageView<T, N, modifiability_>& view() const noexcept;
+  ConstantPlanarImageView<T, N> constant_view() const noexcept;
+
+  void clear();
+
+private:
+  static_assert(N > 0, "Planar image view needs at least one plane");
+
+  std::array<PlaneType, N> planes_;
+};
+
+/// @}
+
+// ----------
+// Implementation:
+
+/** \brief Constructs a planar image view from the specified single-channel plane views.
+ *
+ * All planes have to be of the same size.
+ *
+ * @tparam T The element type of each channel.
+ * @tparam N The number of channels (planes).
+ * @tparam modifiability_ Determines whether image contents are constant or mutable.
+ * @param planes The plane views, one per channel.
+ */
+template <typename T, std::size_t N, ImageModifiability modifiability_>
+PlanarImageView<T, N, modifiability_>::PlanarImageView(const std::array<PlaneType, N>& planes)
+    : planes_(planes)
+{
+  for ([[maybe_unused]] const auto& p : planes_)
+  {
+    SELENE_ASSERT(p.width() == planes_[0].width() && p.height() == planes_[0].height());
+  }
+}
+
+/** \brief Returns the image width.
+ *
+ * @tparam T The element type of each channel.
+ * @tparam N The number of channels (planes).
+ * @tparam modifiability_ Determines whether image contents are constant or mutable.
+ * @return Width of the image in pixels.
+ */
+template <typename T, std::size_t N, ImageModifiability modifiability_>
+PixelLength PlanarImageView<T, N, modifiability_>::width() const noexcept
+{
+  return planes_[0].width();
+}
+
+/** \brief Returns the image height.
+ *
+ * @tparam T The element type of each channel.
+ * @tparam N The number of channels (planes).
+ * @tparam modifiability_ Determines whether image contents are constant or mutable.
+ * @return Height of the image in pixels.
+ */
+template <typename T, std::size_t N, ImageModifiability modifiability_>
+PixelLength PlanarImageView<T, N, modifiability_>::height() const noexcept
+{
+  return planes_[0].height();
+}
+
+/** \brief Returns whether the image view is empty.
+ *
+ * An image view is considered empty if any of its planes is empty.
+ *
+ * @tparam T The element type of each channel.
+ * @tparam N The number of channels (planes).
+ * @tparam modifiability_ Determines whether image contents are constant or mutable.
+ * @return True, if the image view is empty; false if it is non-empty.
+ */
+template <typename T, std::size_t N, ImageModifiability modifiability_>
+bool PlanarImageView<T, N, modifiability_>::is_empty() const noexcept
+{
+  for (const auto& p : planes_)
+  {
+    if (p.is_empty())
+    {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+/** \brief Returns whether the image view is valid.
+ *
+ * Semantically equal to `!is_empty()`.
+ *
+ * @tparam T The element type of each channel.
+ * @tparam N The number of channels (planes).
+ * @tparam modifiability_ Determines whether image contents are constant or mutable.
+ * @return True, if the image view is valid; false otherwise.
+ */
+template <typename T, std::size_t N, ImageModifiability modifiability_>
+bool PlanarImageView<T, N, modifiability_>::is_valid() const noexcept
+{
+  return !is_empty();
+}
+
+/** \brief Returns the plane view of the specified channel.
+ *
+ * @tparam T The element type of each channel.
+ * @tparam N The number of channels (planes).
+ * @tparam modifiability_ Determines whether image contents are constant or mutable.
+ * @param channel The channel index.
+ * @return The single-channel view of the respective plane.
+ */
+template <typename T, std::size_t N, ImageModifiability modifiability_>
+auto PlanarImageView<T, N, modifiability_>::plane(std::size_t channel) noexcept -> PlaneType&
+{
+  SELENE_ASSERT(channel < N);
+  return planes_[channel];
+}
+
+/** \brief Returns the plane view of the specified channel.
+ *
+ * @tparam T The element type of each channel.
+ * @tparam N The number of channels (planes).
+ * @tparam modifiability_ Determines whether image contents are constant or mutable.
+ * @param channel The channel index.
+ * @return The single-channel view of the respective plane.
+ */
+template <typename T, std::size_t N, ImageModifiability modifiability_>
+auto PlanarImageView<T, N, modifiability_>::plane(std::size_t channel) const noexcept -> const PlaneType&
+{
+  SELENE_ASSERT(channel < N);
+  return planes_[channel];
+}
+
+/** \brief Returns all plane views.
+ *
+ * @tparam T The element type of each channel.
+ * @tparam N The number of channels (planes).
+ * @tparam modifiability_ Determines whether image contents are constant or mutable.
+ * @return An array of the single-channel plane views.
+ */
+template <typename T, std::size_t N, ImageModifiability modifiability_>
+auto PlanarImageView<T, N, modifiability_>::planes() noexcept -> std::array<PlaneType, N>&
+{
+  return planes_;
+}
+
+/** \brief Returns all plane views.
+ *
+ * @tparam T The element type of each channel.
+ * @tparam N The number of channels (planes).
+ * @tparam modifiability_ Determines whether image contents are constant or mutable.
+ * @return An array of the single-channel plane views.
+ */
+template <typename T, std::size_t N, ImageModifiability modifiability_>
+auto PlanarImageView<T, N, modifiability_>::planes() const noexcept -> const std::array<PlaneType, N>&
+{
+  return planes_;
+}
+
+/** \brief Returns the view itself.
+ *
+ * @tparam T The element type of each channel.
+ * @tparam N The number of channels (planes).
+ * @tparam modifiability_ Determines whether image contents are constant or mutable.
+ * @return A reference to this planar image view.
+ */
+template <typename T, std::size_t N, ImageModifiability modifiability_>
+PlanarImageView<T, N, modifiability_>& PlanarImageView<T, N, modifiability_>::view() noexcept
+{
+  return *this;
+}
+
+/** \brief Returns the view itself.
+ *
+ * @tparam T The element type of each channel.
+ * @tparam N The number of channels (planes).
+ * @tparam modifiability_ Determines whether image contents are constant or mutable.
+ * @return A constant reference to this planar image view.
+ */
+template <typename T, std::size_t N, ImageModifiability modifiability_>
+const PlanarImageView<T, N, modifiability_>& PlanarImageView<T, N, modifiability_>::view() const noexcept
+{
+  return *this;
+}
+
+/** \brief Returns a constant view onto the same planes.
+ *
+ * @tparam T The element type of each channel.
+ * @tparam N The number of channels (planes).
+ * @tparam modifiability_ Determines whether image contents are constant or mutable.
+ * @return A constant planar image view.
+ */
+template <typename T, std::size_t N, ImageModifiability modifiability_>
+ConstantPlanarImageView<T, N> PlanarImageView<T, N, modifiability_>::constant_view() const noexcept
+{
+  std::array<ConstantImageView<Pixel<T, 1>>, N> planes;
+
+  for (std::size_t c = 0; c < N; ++c)
+  {
+    planes[c] = ConstantImageView<Pixel<T, 1>>(planes_[c].byte_ptr(), planes_[c].layout());
+  }
+
+  return ConstantPlanarImageView<T, N>(planes);
+}
+
+/** \brief Resets the planar image view to an empty state.
+ *
+ * @tparam T The element type of each channel.
+ * @tparam N The number of channels (planes).
+ * @tparam modifiability_ Determines whether image contents are constant or mutable.
+ */
+template <typename T, std::size_t N, ImageModifiability modifiability_>
+void PlanarImageView<T, N, modifiability_>::clear()
+{
+  for (auto& p : planes_)
+  {
+    p.clear();
+  }
+}
+
+}  // namespace sln
+
+#endif  // SELENE_IMG_TYPED_PLANAR_IMAGE_VIEW_HPP
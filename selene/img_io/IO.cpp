@@ -4,6 +4,13 @@
 
 #include <selene/img_io/IO.hpp>
 
+#if defined(SELENE_WITH_LIBTIFF)
+#include <selene/img_io/tiff/_impl/TIFFDetail.hpp>
+#endif
+
+#include <algorithm>
+#include <initializer_list>
+
 namespace sln {
 
 namespace impl {
@@ -21,6 +28,82 @@ void add_messages(const MessageLog& message_log_src, MessageLog* message_log_dst
   }
 }
 
+std::optional<ImageFormat> detect_image_format([[maybe_unused]] const std::uint8_t* data,
+                                               [[maybe_unused]] std::size_t len)
+{
+  [[maybe_unused]] const auto starts_with = [data, len](std::initializer_list<std::uint8_t> signature) {
+    return len >= signature.size() && std::equal(signature.begin(), signature.end(), data);
+  };
+
+#if defined(SELENE_WITH_LIBJPEG)
+  // SOI marker, followed by the start of another marker
+  if (starts_with({0xFF, 0xD8, 0xFF}))
+  {
+    return ImageFormat::JPEG;
+  }
+#endif  // defined(SELENE_WITH_LIBJPEG)
+
+#if defined(SELENE_WITH_LIBPNG)
+  if (starts_with({0x89, 'P', 'N', 'G', 0x0D, 0x0A, 0x1A, 0x0A}))
+  {
+    return ImageFormat::PNG;
+  }
+#endif  // defined(SELENE_WITH_LIBPNG)
+
+#if defined(SELENE_WITH_LIBTIFF)
+  // Little-endian or big-endian byte order, followed by the version number (42 for TIFF, 43 for BigTIFF)
+  if (starts_with({'I', 'I', 42, 0}) || starts_with({'M', 'M', 0, 42})
+      || starts_with({'I', 'I', 43, 0}) || starts_with({'M', 'M', 0, 43}))
+  {
+    return ImageFormat::TIFF;
+  }
+#endif  // defined(SELENE_WITH_LIBTIFF)
+
+  return std::nullopt;
+}
+
+#if defined(SELENE_WITH_LIBJPEG)
+ImageInfo to_image_info(const JPEGImageInfo& header_info)
+{
+  if (!header_info.is_valid())
+  {
+    return ImageInfo{};
+  }
+
+  return ImageInfo{ImageFormat::JPEG, header_info.width, header_info.height, header_info.nr_channels,
+                   static_cast<std::int16_t>(8 * header_info.nr_bytes_per_channel()), SampleFormat::UnsignedInteger, 1};
+}
+#endif  // defined(SELENE_WITH_LIBJPEG)
+
+#if defined(SELENE_WITH_LIBPNG)
+ImageInfo to_image_info(const PNGImageInfo& header_info)
+{
+  if (!header_info.is_valid())
+  {
+    return ImageInfo{};
+  }
+
+  return ImageInfo{ImageFormat::PNG, header_info.width, header_info.height, header_info.nr_channels,
+                   header_info.bit_depth, SampleFormat::UnsignedInteger, 1};
+}
+#endif  // defined(SELENE_WITH_LIBPNG)
+
+#if defined(SELENE_WITH_LIBTIFF)
+ImageInfo to_image_info(const std::vector<TiffImageLayout>& layouts)
+{
+  if (layouts.empty())
+  {
+    return ImageInfo{};
+  }
+
+  const auto& layout = layouts.front();
+  return ImageInfo{ImageFormat::TIFF, to_pixel_length(layout.width), to_pixel_length(layout.height),
+                   static_cast<std::int16_t>(layout.samples_per_pixel),
+                   static_cast<std::int16_t>(layout.bits_per_sample),
+                   impl::tiff::sample_format_to_sample_format(layout.sample_format), layouts.size()};
+}
+#endif  // defined(SELENE_WITH_LIBTIFF)
+
 }  // namespace impl
 
 }  // namespace sln
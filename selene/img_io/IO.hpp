@@ -9,6 +9,7 @@
 
 #include <selene/base/Assert.hpp>
 #include <selene/base/MessageLog.hpp>
+#include <selene/base/io/BufferedFileWriter.hpp>
 
 #include <selene/img/dynamic/DynImage.hpp>
 #include <selene/img/dynamic/DynImageView.hpp>
@@ -20,8 +21,13 @@
 #include <selene/img_io/tiff/Read.hpp>
 #include <selene/img_io/tiff/Write.hpp>
 
+#include <array>
+#include <cstdint>
+#include <optional>
 #include <stdexcept>
+#include <type_traits>
 #include <variant>
+#include <vector>
 
 namespace sln {
 
@@ -43,6 +49,34 @@ enum class ImageFormat
 #endif
 };
 
+/** \brief Format-agnostic image information, as obtained by `read_image_info()`.
+ *
+ * All values describe the image as stored in the file; in particular, the number of channels and bit depth may
+ * differ from the respective values of an image decoded with default options (e.g. for palette PNG images).
+ */
+struct ImageInfo
+{
+  ImageFormat format{};  ///< The image format.
+  PixelLength width{0};  ///< The image width.
+  PixelLength height{0};  ///< The image height.
+  std::int16_t nr_channels{0};  ///< The number of channels.
+  std::int16_t bit_depth{0};  ///< The number of bits per channel.
+  SampleFormat sample_format{SampleFormat::Unknown};  ///< The sample format.
+  std::size_t nr_pages{0};  ///< The number of images (pages) contained; can only be larger than 1 for TIFF images.
+
+  /** \brief Returns whether the image information is valid.
+   *
+   * @return True, if the image information is valid; false otherwise.
+   */
+  [[nodiscard]] bool is_valid() const { return width > 0 && height > 0 && nr_channels > 0 && bit_depth > 0; }
+};
+
+template <typename SourceType>
+std::optional<ImageFormat> detect_image_format(SourceType&& source);
+
+template <typename SourceType>
+ImageInfo read_image_info(SourceType&& source, MessageLog* message_log = nullptr);
+
 template <typename Allocator = default_bytes_allocator, typename SourceType>
 DynImage<Allocator> read_image(SourceType&& source, MessageLog* message_log = nullptr);
 
@@ -87,6 +121,38 @@ namespace impl {
 
 void add_messages(const MessageLog& message_log_src, MessageLog* message_log_dst);
 
+/// Closes `sink`, if it is a temporary BufferedFileWriter, s.t. a failure to write out its buffered data is reported,
+/// instead of being lost in its destructor.
+template <typename SinkType>
+bool close_temporary_sink(std::remove_reference_t<SinkType>& sink, MessageLog& message_log)
+{
+  if constexpr (!std::is_lvalue_reference_v<SinkType>
+                && std::is_same_v<std::remove_cv_t<SinkType>, BufferedFileWriter>)
+  {
+    if (!sink.close())
+    {
+      message_log.add("Buffered data could not be written to the output file.", MessageType::Error);
+      return false;
+    }
+  }
+
+  return true;
+}
+
+constexpr std::size_t nr_image_format_signature_bytes = 8;
+
+std::optional<ImageFormat> detect_image_format(const std::uint8_t* data, std::size_t len);
+
+#if defined(SELENE_WITH_LIBJPEG)
+ImageInfo to_image_info(const JPEGImageInfo& header_info);
+#endif
+#if defined(SELENE_WITH_LIBPNG)
+ImageInfo to_image_info(const PNGImageInfo& header_info);
+#endif
+#if defined(SELENE_WITH_LIBTIFF)
+ImageInfo to_image_info(const std::vector<TiffImageLayout>& layouts);
+#endif
+
 #if defined(SELENE_WITH_LIBJPEG)
 
 template <typename Allocator, typename SourceType>
@@ -158,9 +224,109 @@ template <typename Allocator, typename SourceType>
 
 }  // namespace impl
 
+/** \brief Detects the format of an image stream, by inspecting its leading signature bytes.
+ *
+ * No decoder is invoked; only the first few bytes of the stream are read. The source position is re-set to the
+ * original position afterwards.
+ *
+ * @tparam SourceType Type of the input source. Can be FileReader, MemoryReader, MmapReader, or AsyncFileReader.
+ * @param source Input source instance.
+ * @return The detected image format, or `std::nullopt` if the source is not open, if the signature is not recognized,
+ * or if support for the respective format has not been compiled in.
+ */
+template <typename SourceType>
+std::optional<ImageFormat> detect_image_format(SourceType&& source)
+{
+  if (!source.is_open())
+  {
+    return std::nullopt;
+  }
+
+  const auto source_pos = source.position();
+
+  std::array<std::uint8_t, impl::nr_image_format_signature_bytes> signature = {};
+  const auto nr_bytes_read = source.read(signature.data(), signature.size());
+  source.seek_abs(source_pos);
+
+  return impl::detect_image_format(signature.data(), nr_bytes_read);
+}
+
+/** \brief Reads the basic information of an image stream (format, size, number of channels, bit depth, etc.), without
+ * decoding any image data.
+ *
+ * The image format is determined by inspecting the signature bytes of the stream (see `detect_image_format`), and
+ * only the header of the respective format is subsequently read. No memory for pixel data is allocated. The source
+ * position is re-set to the original position afterwards.
+ *
+ * @tparam SourceType Type of the input source. Can be FileReader, MemoryReader, MmapReader, or AsyncFileReader.
+ * @param source Input source instance.
+ * @param message_log Optional pointer to the message log. If provided, warning and error messages will be output there.
+ * @return An `ImageInfo` instance. Reading the image information was successful, if `is_valid() == true`, and
+ * unsuccessful otherwise.
+ */
+template <typename SourceType>
+ImageInfo read_image_info(SourceType&& source, MessageLog* message_log)
+{
+  const auto format = detect_image_format(source);
+
+  if (!format)
+  {
+    if (message_log)
+    {
+      message_log->add("Unknown or unsupported image format.", MessageType::Error);
+    }
+
+    return ImageInfo{};
+  }
+
+  [[maybe_unused]] const auto source_pos = source.position();
+  ImageInfo info;
+
+  switch (*format)
+  {
+#if defined(SELENE_WITH_LIBJPEG)
+    case ImageFormat::JPEG:
+    {
+      JPEGDecompressionObject obj;
+      MessageLog message_log_jpeg;
+      info = impl::to_image_info(read_jpeg_header(obj, source, true, &message_log_jpeg));
+      impl::add_messages(message_log_jpeg, message_log);
+      break;
+    }
+#endif  // defined(SELENE_WITH_LIBJPEG)
+#if defined(SELENE_WITH_LIBPNG)
+    case ImageFormat::PNG:
+    {
+      PNGDecompressionObject obj;
+      MessageLog message_log_png;
+      info = impl::to_image_info(read_png_header(obj, source, true, &message_log_png));
+      impl::add_messages(message_log_png, message_log);
+      break;
+    }
+#endif  // defined(SELENE_WITH_LIBPNG)
+#if defined(SELENE_WITH_LIBTIFF)
+    case ImageFormat::TIFF:
+    {
+      // Only reads the image file directories, not the image data.
+      MessageLog message_log_tiff;
+      info = impl::to_image_info(read_tiff_layouts(source, &message_log_tiff));
+      impl::add_messages(message_log_tiff, message_log);
+      source.seek_abs(source_pos);
+      break;
+    }
+#endif  // defined(SELENE_WITH_LIBTIFF)
+  }
+
+  return info;
+}
+
 /** \brief Reads an image stream, trying all supported formats.
  *
- * @tparam SourceType Type of the input source. Can be FileReader or MemoryReader.
+ * The image format is first determined by inspecting the signature bytes of the stream (see `detect_image_format`),
+ * and the respective decoder is invoked directly. Only if the format cannot be detected, or if the respective decoder
+ * does not succeed, are the remaining supported formats tried in sequence.
+ *
+ * @tparam SourceType Type of the input source. Can be FileReader, MemoryReader, MmapReader, or AsyncFileReader.
  * @param source Input source instance.
  * @param message_log Optional pointer to the message log. If provided, warning and error messages will be output there.
  * @return A `DynImage` instance. Reading the image stream was successful, if `is_valid() == true`, and unsuccessful
@@ -174,45 +340,92 @@ DynImage<Allocator> read_image(SourceType&& source,
   [[maybe_unused]] const auto source_pos = source.position();
   DynImage<Allocator> dyn_img;
 
-  // First, try to read as JPEG image:
+  // Try to dispatch directly to the respective decoder, based on the detected image format:
 
-#if defined(SELENE_WITH_LIBJPEG)
-  reading_attempted = true;
-  const bool read_as_jpeg = impl::try_read_as_jpeg_image(std::forward<SourceType>(source), dyn_img, message_log);
+  const auto detected_format = detect_image_format(source);
 
-  if (read_as_jpeg)
+  if (detected_format)
   {
-    return dyn_img;
+    reading_attempted = true;
+    bool read_as_detected = false;
+
+    switch (*detected_format)
+    {
+#if defined(SELENE_WITH_LIBJPEG)
+      case ImageFormat::JPEG:
+        read_as_detected = impl::try_read_as_jpeg_image(std::forward<SourceType>(source), dyn_img, message_log);
+        break;
+#endif  // defined(SELENE_WITH_LIBJPEG)
+#if defined(SELENE_WITH_LIBPNG)
+      case ImageFormat::PNG:
+        read_as_detected = impl::try_read_as_png_image(std::forward<SourceType>(source), dyn_img, message_log);
+        break;
+#endif  // defined(SELENE_WITH_LIBPNG)
+#if defined(SELENE_WITH_LIBTIFF)
+      case ImageFormat::TIFF:
+        read_as_detected = impl::try_read_as_tiff_image(std::forward<SourceType>(source), dyn_img, message_log);
+        break;
+#endif  // defined(SELENE_WITH_LIBTIFF)
+    }
+
+    if (read_as_detected)
+    {
+      return dyn_img;
+    }
+
+    SELENE_ASSERT(!dyn_img.is_valid());
+    source.seek_abs(source_pos);
   }
 
-  SELENE_ASSERT(!dyn_img.is_valid());
-  source.seek_abs(source_pos);
+  // Otherwise, try the remaining formats in sequence; the decoder for the detected format is not invoked again.
+  // First try to read as JPEG image:
+
+#if defined(SELENE_WITH_LIBJPEG)
+  if (detected_format != ImageFormat::JPEG)
+  {
+    reading_attempted = true;
+    const bool read_as_jpeg = impl::try_read_as_jpeg_image(std::forward<SourceType>(source), dyn_img, message_log);
+
+    if (read_as_jpeg)
+    {
+      return dyn_img;
+    }
+
+    SELENE_ASSERT(!dyn_img.is_valid());
+    source.seek_abs(source_pos);
+  }
 #endif  // defined(SELENE_WITH_LIBJPEG)
 
   // In case that failed, try to read as PNG image:
 
 #if defined(SELENE_WITH_LIBPNG)
-  reading_attempted = true;
-  const bool read_as_png = impl::try_read_as_png_image(std::forward<SourceType>(source), dyn_img, message_log);
-
-  if (read_as_png)
+  if (detected_format != ImageFormat::PNG)
   {
-    return dyn_img;
-  }
+    reading_attempted = true;
+    const bool read_as_png = impl::try_read_as_png_image(std::forward<SourceType>(source), dyn_img, message_log);
 
-  SELENE_ASSERT(!dyn_img.is_valid());
-  source.seek_abs(source_pos);
+    if (read_as_png)
+    {
+      return dyn_img;
+    }
+
+    SELENE_ASSERT(!dyn_img.is_valid());
+    source.seek_abs(source_pos);
+  }
 #endif  // defined(SELENE_WITH_LIBPNG)
 
   // In case that failed, try to read as TIFF image:
 
 #if defined(SELENE_WITH_LIBTIFF)
-  reading_attempted = true;
-  const bool read_as_tiff = impl::try_read_as_tiff_image(std::forward<SourceType>(source), dyn_img, message_log);
-
-  if (read_as_tiff)
+  if (detected_format != ImageFormat::TIFF)
   {
-    return dyn_img;
+    reading_attempted = true;
+    const bool read_as_tiff = impl::try_read_as_tiff_image(std::forward<SourceType>(source), dyn_img, message_log);
+
+    if (read_as_tiff)
+    {
+      return dyn_img;
+    }
   }
 #endif  // defined(SELENE_WITH_LIBTIFF)
 
@@ -227,7 +440,10 @@ DynImage<Allocator> read_image(SourceType&& source,
 
 /** \brief Writes an image stream, given the supplied uncompressed image data (from a `DynImage`).
  *
- * @tparam SinkType Type of the output sink. Can be FileWriter or VectorWriter.
+ * If `sink` is a temporary BufferedFileWriter, it is closed before returning, s.t. the result also reflects whether its
+ * buffered data could be written to the file.
+ *
+ * @tparam SinkType Type of the output sink. Can be FileWriter, BufferedFileWriter, or VectorWriter.
  * @param dyn_img The dynamic image to be written.
  * @param format Desired output image format.
  * @param sink Output sink instance.
@@ -252,13 +468,16 @@ bool write_image(const DynImage<Allocator>& dyn_img,
 #endif
                                     >& options)
 {
-  return write_image(dyn_img.view(), format, sink, message_log, options);
+  return write_image(dyn_img.view(), format, std::forward<SinkType>(sink), message_log, options);
 }
 
 /** \brief Writes an image stream, given the supplied uncompressed image data (from a `DynImageView`).
+ *
+ * If `sink` is a temporary BufferedFileWriter, it is closed before returning, s.t. the result also reflects whether its
+ * buffered data could be written to the file.
  *
  * @tparam modifiability The dynamic image modifiability (mutable or constant).
- * @tparam SinkType Type of the output sink. Can be FileWriter or VectorWriter.
+ * @tparam SinkType Type of the output sink. Can be FileWriter, BufferedFileWriter, or VectorWriter.
  * @param dyn_img_view The dynamic image view to be written.
  * @param format Desired output image format.
  * @param sink Output sink instance.
@@ -290,9 +509,10 @@ bool write_image([[maybe_unused]] const DynImageView<modifiability>& dyn_img_vie
     const auto options_jpeg = std::holds_alternative<JPEGCompressionOptions>(options)
                                 ? std::get<JPEGCompressionOptions>(options) : JPEGCompressionOptions{};
     const bool success = write_jpeg(dyn_img_view, std::forward<SinkType>(sink), options_jpeg, &message_log_jpeg);
+    const bool closed = impl::close_temporary_sink<SinkType>(sink, message_log_jpeg);
 
     impl::add_messages(message_log_jpeg, message_log);
-    return success;
+    return success && closed;
   }
 #endif  // defined(SELENE_WITH_LIBJPEG)
 
@@ -303,9 +523,10 @@ bool write_image([[maybe_unused]] const DynImageView<modifiability>& dyn_img_vie
     const auto options_png = std::holds_alternative<PNGCompressionOptions>(options)
                                ? std::get<PNGCompressionOptions>(options) : PNGCompressionOptions{};
     const bool success = write_png(dyn_img_view, std::forward<SinkType>(sink), options_png, &message_log_png);
+    const bool closed = impl::close_temporary_sink<SinkType>(sink, message_log_png);
 
     impl::add_messages(message_log_png, message_log);
-    return success;
+    return success && closed;
   }
 #endif  // defined(SELENE_WITH_LIBPNG)
 
@@ -316,9 +537,10 @@ bool write_image([[maybe_unused]] const DynImageView<modifiability>& dyn_img_vie
     const auto options_tiff = std::holds_alternative<TIFFWriteOptions>(options)
                                 ? std::get<TIFFWriteOptions>(options) : TIFFWriteOptions{};
     const bool success = write_tiff(dyn_img_view, std::forward<SinkType>(sink), options_tiff, &message_log_tiff);
+    const bool closed = impl::close_temporary_sink<SinkType>(sink, message_log_tiff);
 
     impl::add_messages(message_log_tiff, message_log);
-    return success;
+    return success && closed;
   }
 #endif  // defined(SELENE_WITH_LIBTIFF)
 
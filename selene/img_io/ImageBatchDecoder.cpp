@@ -0,0 +1,320 @@
+// This file is part of the `Selene` library.
+// Copyright 2017-2019 Michael Hofmann (https://github.com/kmhofmann).
+// Distributed under MIT license. See accompanying LICENSE file in the top-level directory.
+
+#include <selene/img_io/ImageBatchDecoder.hpp>
+
+#include <selene/base/_impl/ParallelFor.hpp>
+
+#include <selene/base/io/FileReader.hpp>
+#include <selene/base/io/MemoryReader.hpp>
+#include <selene/base/io/MmapReader.hpp>
+
+#include <selene/img_io/IO.hpp>
+
+#include <algorithm>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+namespace sln {
+
+namespace {
+
+/// Per-thread decoding state, kept across calls to ImageBatchDecoder::decode().
+struct WorkerState
+{
+#if defined(SELENE_WITH_LIBJPEG)
+  JPEGDecompressionObject jpeg_obj;
+#endif
+#if defined(SELENE_WITH_LIBPNG)
+  PNGDecompressionObject png_obj;
+#endif
+  // A TIFFReadObject is bound to the source it has been opened with, so one is created per image instead.
+};
+
+/// The decoding result of one source, waiting for delivery.
+struct DecodingResult
+{
+  DynImage<> img;
+  MessageLog messages;
+  std::exception_ptr exception;
+  bool ready = false;
+};
+
+template <typename SourceType>
+DynImage<> decode_from_source(WorkerState& state, SourceType& source, MessageLog& messages)
+{
+  if (const auto format = detect_image_format(source); format)
+  {
+    switch (*format)
+    {
+#if defined(SELENE_WITH_LIBJPEG)
+      case ImageFormat::JPEG: return read_jpeg(state.jpeg_obj, source, JPEGDecompressionOptions(), &messages);
+#endif  // defined(SELENE_WITH_LIBJPEG)
+#if defined(SELENE_WITH_LIBPNG)
+      case ImageFormat::PNG: return read_png(state.png_obj, source, PNGDecompressionOptions(), &messages);
+#endif  // defined(SELENE_WITH_LIBPNG)
+#if defined(SELENE_WITH_LIBTIFF)
+      case ImageFormat::TIFF: return read_tiff(source, &messages);
+#endif  // defined(SELENE_WITH_LIBTIFF)
+    }
+  }
+
+  auto img = read_image(source, &messages);
+
+  if (!img.is_valid() && !messages.contains_errors())
+  {
+    messages.add("Image could not be decoded; unknown or unsupported image format.", MessageType::Error);
+  }
+
+  return img;
+}
+
+DynImage<> decode_source(WorkerState& state, const ImageBatchSource& source, MessageLog& messages)
+{
+  if (const auto path = std::get_if<std::string>(&source))
+  {
+    // Prefer decoding straight from the page cache; fall back to regular file I/O if the file cannot be mapped
+    MmapReader mmap_reader(*path);
+
+    if (mmap_reader.is_open())
+    {
+      return decode_from_source(state, mmap_reader, messages);
+    }
+
+    FileReader reader(*path);
+
+    if (!reader.is_open())
+    {
+      messages.add("Could not open file " + *path, MessageType::Error);
+      return DynImage<>{};
+    }
+
+    return decode_from_source(state, reader, messages);
+  }
+
+  MemoryReader reader(std::get<ConstantMemoryRegion>(source));
+  return decode_from_source(state, reader, messages);
+}
+
+}  // namespace
+
+struct ImageBatchDecoder::Impl
+{
+  std::size_t nr_threads = 1;
+  std::size_t max_nr_images_in_flight = 2;
+  std::vector<std::unique_ptr<WorkerState>> worker_states;
+};
+
+/** \brief Constructor.
+ *
+ * The per-thread decompression objects are allocated on construction.
+ *
+ * @param options The decoder options.
+ */
+ImageBatchDecoder::ImageBatchDecoder(const ImageBatchDecoderOptions& options)
+    : impl_(std::make_unique<ImageBatchDecoder::Impl>())
+{
+  impl_->nr_threads = impl::get_nr_threads(options.nr_threads);
+  impl_->max_nr_images_in_flight = (options.max_nr_images_in_flight > 0) ? options.max_nr_images_in_flight
+                                                                          : 2 * impl_->nr_threads;
+
+  impl_->worker_states.reserve(impl_->nr_threads);
+  for (std::size_t i = 0; i < impl_->nr_threads; ++i)
+  {
+    impl_->worker_states.push_back(std::make_unique<WorkerState>());
+  }
+}
+
+ImageBatchDecoder::~ImageBatchDecoder() = default;
+
+ImageBatchDecoder::ImageBatchDecoder(ImageBatchDecoder&&) noexcept = default;
+
+ImageBatchDecoder& ImageBatchDecoder::operator=(ImageBatchDecoder&&) noexcept = default;
+
+/** \brief Returns the number of worker threads used for decoding.
+ *
+ * @return The number of worker threads.
+ */
+std::size_t ImageBatchDecoder::nr_threads() const noexcept
+{
+  return impl_->nr_threads;
+}
+
+/** \brief Returns the maximum number of decoded, but not yet delivered images.
+ *
+ * @return The maximum number of images in flight.
+ */
+std::size_t ImageBatchDecoder::max_nr_images_in_flight() const noexcept
+{
+  return impl_->max_nr_images_in_flight;
+}
+
+/** \brief Decodes the given sources concurrently, and passes each decoded image to the result function.
+ *
+ * The result function is called on the calling thread, once per source, in order of the sources. This function
+ * returns after all images have been delivered.
+ *
+ * @param sources The image sources to decode.
+ * @param result_function The function receiving the source index, the decoded image (which is invalid if decoding was
+ * unsuccessful), and the messages emitted during decoding.
+ */
+void ImageBatchDecoder::decode(const std::vector<ImageBatchSource>& sources, const ResultFunction& result_function)
+{
+  const auto nr_sources = sources.size();
+
+  if (nr_sources == 0)
+  {
+    return;
+  }
+
+  const auto nr_threads = std::min(impl_->nr_threads, nr_sources);
+  const auto max_nr_in_flight = std::max(impl_->max_nr_images_in_flight, std::size_t{1});
+
+  // The result of source i is stored in slot (i % max_nr_in_flight); a source is only claimed for decoding once its
+  // slot has been vacated, i.e. once the result of source (i - max_nr_in_flight) has been delivered.
+  std::vector<DecodingResult> slots(max_nr_in_flight);
+  std::mutex mutex;
+  std::condition_variable cv_slot_vacated;
+  std::condition_variable cv_result_ready;
+  std::size_t next_to_decode = 0;
+  std::size_t next_to_deliver = 0;
+  bool cancelled = false;
+
+  auto worker = [&](WorkerState& state) {
+    for (;;)
+    {
+      std::size_t index = 0;
+
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        cv_slot_vacated.wait(lock, [&]() {
+          return cancelled || next_to_decode >= nr_sources || next_to_decode < next_to_deliver + max_nr_in_flight;
+        });
+
+        if (cancelled || next_to_decode >= nr_sources)
+        {
+          return;
+        }
+
+        index = next_to_decode++;
+      }
+
+      DecodingResult result;
+
+      try
+      {
+        result.img = decode_source(state, sources[index], result.messages);
+      }
+      catch (...)
+      {
+        result.exception = std::current_exception();
+      }
+
+      result.ready = true;
+
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        slots[index % max_nr_in_flight] = std::move(result);
+      }
+
+      cv_result_ready.notify_one();
+    }
+  };
+
+  std::vector<std::thread> threads;
+  threads.reserve(nr_threads);
+
+  const auto stop_and_join = [&]() {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      cancelled = true;
+    }
+
+    cv_slot_vacated.notify_all();
+
+    for (auto& thread : threads)
+    {
+      thread.join();
+    }
+  };
+
+  try
+  {
+    for (std::size_t t = 0; t < nr_threads; ++t)
+    {
+      threads.emplace_back(worker, std::ref(*impl_->worker_states[t]));
+    }
+
+    for (std::size_t index = 0; index < nr_sources; ++index)
+    {
+      DecodingResult result;
+
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        auto& slot = slots[index % max_nr_in_flight];
+        cv_result_ready.wait(lock, [&slot]() { return slot.ready; });
+        result = std::move(slot);
+        slot = DecodingResult{};
+      }
+
+      if (result.exception)
+      {
+        std::rethrow_exception(result.exception);
+      }
+
+      result_function(index, std::move(result.img), result.messages);
+
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        ++next_to_deliver;
+      }
+
+      cv_slot_vacated.notify_all();
+    }
+  }
+  catch (...)
+  {
+    stop_and_join();
+    throw;
+  }
+
+  stop_and_join();
+}
+
+/** \brief Decodes the given sources concurrently, and returns the decoded images in order of the sources.
+ *
+ * Note that all decoded images are held in memory at the same time; for large batches, prefer the overload taking a
+ * result function.
+ *
+ * @param sources The image sources to decode.
+ * @param message_logs Optional pointer to a vector of message logs. If provided, it will be resized to the number of
+ * sources, and each element will contain the messages emitted while decoding the respective source.
+ * @return The decoded images. Images that could not be decoded are invalid, i.e. `is_valid() == false`.
+ */
+std::vector<DynImage<>> ImageBatchDecoder::decode(const std::vector<ImageBatchSource>& sources,
+                                                  std::vector<MessageLog>* message_logs)
+{
+  std::vector<DynImage<>> images(sources.size());
+
+  if (message_logs)
+  {
+    message_logs->clear();
+    message_logs->resize(sources.size());
+  }
+
+  decode(sources, [&images, message_logs](std::size_t index, DynImage<> img, const MessageLog& messages) {
+    images[index] = std::move(img);
+
+    if (message_logs)
+    {
+      (*message_logs)[index] = messages;
+    }
+  });
+
+  return images;
+}
+
+}  // namespace sln
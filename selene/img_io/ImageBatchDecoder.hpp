@@ -0,0 +1,107 @@
+// This file is part of the `Selene` library.
+// Copyright 2017-2019 Michael Hofmann (https://github.com/kmhofmann).
+// Distributed under MIT license. See accompanying LICENSE file in the top-level directory.
+
+#ifndef SELENE_IMG_IO_IMAGE_BATCH_DECODER_HPP
+#define SELENE_IMG_IO_IMAGE_BATCH_DECODER_HPP
+
+/// @file
+
+#include <selene/base/MessageLog.hpp>
+#include <selene/base/io/MemoryRegion.hpp>
+
+#include <selene/img/dynamic/DynImage.hpp>
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <variant>
+#include <vector>
+
+namespace sln {
+
+/// \addtogroup group-img-io
+/// @{
+
+/** \brief A single input to the ImageBatchDecoder: either a file path, or a region of memory containing the encoded
+ * image data.
+ *
+ * Memory regions are not copied; the memory has to stay valid for the duration of the decoding call.
+ */
+using ImageBatchSource = std::variant<std::string, ConstantMemoryRegion>;
+
+/** \brief Options for the ImageBatchDecoder.
+ *
+ * `nr_threads` denotes the number of worker threads used for decoding. A value <= 0 denotes the number of concurrent
+ * threads supported by the hardware.
+ *
+ * `max_nr_images_in_flight` bounds the number of images that have been decoded (or are being decoded), but have not
+ * been delivered yet. This limits peak memory consumption when one image takes much longer to decode than the
+ * subsequent ones, since images are always delivered in input order. A value of 0 denotes twice the number of
+ * threads.
+ */
+struct ImageBatchDecoderOptions
+{
+  int nr_threads;  ///< The number of worker threads; a value <= 0 denotes the hardware concurrency.
+  std::size_t max_nr_images_in_flight;  ///< The maximum number of decoded, but not yet delivered images.
+
+  /** \brief Constructor, setting the respective options.
+   *
+   * @param nr_threads_ The number of worker threads; a value <= 0 denotes the hardware concurrency.
+   * @param max_nr_images_in_flight_ The maximum number of decoded, but not yet delivered images; 0 denotes twice the
+   * number of threads.
+   */
+  explicit ImageBatchDecoderOptions(int nr_threads_ = 0, std::size_t max_nr_images_in_flight_ = 0)
+      : nr_threads(nr_threads_), max_nr_images_in_flight(max_nr_images_in_flight_)
+  { }
+};
+
+/** \brief Decodes a batch of images concurrently, delivering the results in input order.
+ *
+ * Each worker thread owns its own set of decompression objects (e.g. `JPEGDecompressionObject`,
+ * `PNGDecompressionObject`), which are kept for the lifetime of the ImageBatchDecoder instance. Repeated calls to
+ * `decode()` hence do not repeatedly set up the respective library state.
+ *
+ * The image format of each source is determined from its signature bytes (see `detect_image_format()`); sources with
+ * unrecognized signatures are passed to `read_image()`.
+ *
+ * Decoded images are passed to the result function on the calling thread, strictly in order of the input sources.
+ * Images that could not be decoded are delivered as invalid `DynImage` instances, together with the respective error
+ * messages. Should the result function throw an exception, all worker threads are stopped before the exception is
+ * propagated to the caller.
+ *
+ * An ImageBatchDecoder instance is not thread-safe itself, i.e. `decode()` must not be called concurrently on the same
+ * instance.
+ */
+class ImageBatchDecoder
+{
+public:
+  /// The type of the result function: receives the source index, the decoded image, and any decoding messages.
+  using ResultFunction = std::function<void(std::size_t, DynImage<>, const MessageLog&)>;
+
+  explicit ImageBatchDecoder(const ImageBatchDecoderOptions& options = ImageBatchDecoderOptions());
+  ~ImageBatchDecoder();
+
+  ImageBatchDecoder(const ImageBatchDecoder&) = delete;
+  ImageBatchDecoder& operator=(const ImageBatchDecoder&) = delete;
+  ImageBatchDecoder(ImageBatchDecoder&&) noexcept;
+  ImageBatchDecoder& operator=(ImageBatchDecoder&&) noexcept;
+
+  std::size_t nr_threads() const noexcept;
+  std::size_t max_nr_images_in_flight() const noexcept;
+
+  void decode(const std::vector<ImageBatchSource>& sources, const ResultFunction& result_function);
+  std::vector<DynImage<>> decode(const std::vector<ImageBatchSource>& sources,
+                                 std::vector<MessageLog>* message_logs = nullptr);
+
+private:
+  struct Impl;
+  std::unique_ptr<Impl> impl_;
+};
+
+/// @}
+
+}  // namespace sln
+
+#endif  // SELENE_IMG_IO_IMAGE_BATCH_DECODER_HPP
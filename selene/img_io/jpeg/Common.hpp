@@ -40,6 +40,15 @@ enum class JPEGColorSpace : std::uint8_t
   Auto  ///< Automatic determination
 };
 
+/** \brief The discrete cosine transform (DCT) method used for compression or decompression.
+ */
+enum class JPEGDCTMethod : std::uint8_t
+{
+  IntegerSlow,  ///< Slow but accurate integer algorithm (default).
+  IntegerFast,  ///< Faster, less accurate integer algorithm.
+  Float,  ///< Floating-point algorithm.
+};
+
 }  // namespace sln
 
 #endif  // defined(SELENE_WITH_LIBJPEG)
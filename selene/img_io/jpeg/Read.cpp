@@ -10,7 +10,10 @@
 #include <selene/img_io/jpeg/_impl/Detail.hpp>
 
 #include <jpeglib.h>
+#include <jerror.h>
 
+#include <algorithm>
+#include <array>
 #include <cstdio>
 #include <stdexcept>
 
@@ -42,10 +45,95 @@ bool JPEGImageInfo::is_valid() const
 
 /// \cond INTERNAL
 
+namespace {
+
+// Source manager handing the buffered blocks of an AsyncFileReader to libjpeg in place, i.e. without a copy.
+// The reader position is kept at the beginning of the block data currently handed out.
+struct AsyncSourceManager
+{
+  jpeg_source_mgr pub;
+  AsyncFileReader* reader = nullptr;
+  std::size_t nr_bytes_handed_out = 0;
+};
+
+void async_init_source(j_decompress_ptr /*cinfo*/)
+{
+}
+
+boolean async_fill_input_buffer(j_decompress_ptr cinfo)
+{
+  static const JOCTET fake_eoi[2] = {0xFF, JPEG_EOI};
+  auto src = reinterpret_cast<AsyncSourceManager*>(cinfo->src);
+
+  src->reader->seek_rel(static_cast<std::ptrdiff_t>(src->nr_bytes_handed_out));
+  const auto region = src->reader->peek();
+
+  if (region.len == 0)
+  {
+    // Premature end of data; insert a fake EOI marker, as libjpeg's own source managers do
+    WARNMS(cinfo, JWRN_JPEG_EOF);
+    src->pub.next_input_byte = fake_eoi;
+    src->pub.bytes_in_buffer = 2;
+    src->nr_bytes_handed_out = 0;
+    return TRUE;
+  }
+
+  src->pub.next_input_byte = region.data;
+  src->pub.bytes_in_buffer = region.len;
+  src->nr_bytes_handed_out = region.len;
+  return TRUE;
+}
+
+void async_skip_input_data(j_decompress_ptr cinfo, long num_bytes)
+{
+  auto src = reinterpret_cast<AsyncSourceManager*>(cinfo->src);
+
+  if (num_bytes <= 0)
+  {
+    return;
+  }
+
+  if (static_cast<std::size_t>(num_bytes) <= src->pub.bytes_in_buffer)
+  {
+    src->pub.next_input_byte += num_bytes;
+    src->pub.bytes_in_buffer -= static_cast<std::size_t>(num_bytes);
+    return;
+  }
+
+  // Skip beyond the data handed out; the next call to async_fill_input_buffer() continues from there
+  const auto nr_bytes_beyond = static_cast<std::size_t>(num_bytes) - src->pub.bytes_in_buffer;
+  if (!src->reader->seek_rel(static_cast<std::ptrdiff_t>(src->nr_bytes_handed_out + nr_bytes_beyond)))
+  {
+    src->reader->seek_end(0);
+  }
+
+  src->pub.next_input_byte = nullptr;
+  src->pub.bytes_in_buffer = 0;
+  src->nr_bytes_handed_out = 0;
+}
+
+void async_term_source(j_decompress_ptr cinfo)
+{
+  // Leave the reader positioned right after the consumed data. After a fake EOI marker was handed out, nothing was
+  // handed out from the reader, so the unconsumed bytes must not move the reader back.
+  auto src = reinterpret_cast<AsyncSourceManager*>(cinfo->src);
+  const auto nr_bytes_consumed = static_cast<std::ptrdiff_t>(src->nr_bytes_handed_out)
+                                 - static_cast<std::ptrdiff_t>(src->pub.bytes_in_buffer);
+  src->reader->seek_rel(std::max(std::ptrdiff_t{0}, nr_bytes_consumed));
+  src->pub.next_input_byte = nullptr;
+  src->pub.bytes_in_buffer = 0;
+  src->nr_bytes_handed_out = 0;
+}
+
+}  // namespace
+
 struct JPEGDecompressionObject::Impl
 {
   jpeg_decompress_struct cinfo;
   impl::JPEGErrorManager error_manager;
+  jpeg_source_mgr* stdio_source = nullptr;  // allocated by libjpeg, on first use
+  jpeg_source_mgr* memory_source = nullptr;  // allocated by libjpeg, on first use
+  AsyncSourceManager async_source;
   bool valid = false;
   bool needs_reset = false;
 };
@@ -103,12 +191,24 @@ JPEGImageInfo JPEGDecompressionObject::get_header_info() const
   return JPEGImageInfo(width, height, num_components, color_space);
 }
 
-void JPEGDecompressionObject::set_decompression_parameters(JPEGColorSpace out_color_space)
+void JPEGDecompressionObject::set_decompression_parameters(const JPEGDecompressionOptions& options)
 {
-  if (out_color_space != JPEGColorSpace::Auto)
+  auto& cinfo = impl_->cinfo;
+
+  if (options.out_color_space != JPEGColorSpace::Auto)
   {
-    impl_->cinfo.out_color_space = impl::color_space_pub_to_lib(out_color_space);
+    cinfo.out_color_space = impl::color_space_pub_to_lib(options.out_color_space);
   }
+
+  if (options.scale_num > 0 && options.scale_denom > 0)
+  {
+    cinfo.scale_num = options.scale_num;
+    cinfo.scale_denom = options.scale_denom;
+  }
+
+  cinfo.dct_method = impl::dct_method_pub_to_lib(options.dct_method);
+  cinfo.do_fancy_upsampling = options.do_fancy_upsampling ? TRUE : FALSE;
+  cinfo.do_block_smoothing = options.do_block_smoothing ? TRUE : FALSE;
 }
 
 void JPEGDecompressionObject::reset_if_needed()
@@ -123,13 +223,27 @@ void JPEGDecompressionObject::reset_if_needed()
 
 namespace impl {
 
-JPEGDecompressionCycle::JPEGDecompressionCycle(JPEGDecompressionObject& obj, const BoundingBox& region)
-    : obj_(obj), region_(region)
+JPEGDecompressionCycle::JPEGDecompressionCycle(JPEGDecompressionObject& obj, const BoundingBox& region, bool raw_data)
+    : obj_(obj), region_(raw_data ? BoundingBox() : region)
 {
   obj_.reset_if_needed();
 
   auto& cinfo = obj_.impl_->cinfo;
 
+  if (raw_data)
+  {
+    // Raw data output is only supported at full scale.
+    cinfo.raw_data_out = TRUE;
+    cinfo.scale_num = 1;
+    cinfo.scale_denom = 1;
+  }
+
+  // jpeg_start_decompress() may already consume (and fail on) the whole input, e.g. for progressive JPEG images
+  if (setjmp(obj_.impl_->error_manager.setjmp_buffer))
+  {
+    goto failure_state;
+  }
+
   jpeg_start_decompress(&cinfo);
 
   if (!region_.empty())
@@ -148,6 +262,13 @@ JPEGDecompressionCycle::JPEGDecompressionCycle(JPEGDecompressionObject& obj, con
     jpeg_crop_scanline(&cinfo, &xoffset, &width);
   }
 #endif
+
+  started_ = true;
+  return;
+
+failure_state:
+  jpeg_abort_decompress(&cinfo);
+  finished_or_aborted_ = true;
 }
 
 JPEGDecompressionCycle::~JPEGDecompressionCycle()
@@ -163,6 +284,11 @@ JPEGDecompressionCycle::~JPEGDecompressionCycle()
 
 JPEGImageInfo JPEGDecompressionCycle::get_output_info() const
 {
+  if (!started_)
+  {
+    return JPEGImageInfo();  // invalid output info
+  }
+
   auto& cinfo = obj_.impl_->cinfo;
   SELENE_FORCED_ASSERT(cinfo.out_color_components == cinfo.output_components);
 
@@ -173,10 +299,36 @@ JPEGImageInfo JPEGDecompressionCycle::get_output_info() const
   return JPEGImageInfo{width, height, color_components, out_color_space};
 }
 
+std::vector<JPEGComponentInfo> JPEGDecompressionCycle::get_component_info() const
+{
+  auto& cinfo = obj_.impl_->cinfo;
+
+  std::vector<JPEGComponentInfo> component_info;
+  if (!started_)
+  {
+    return component_info;
+  }
+
+  for (int c = 0; c < cinfo.num_components; ++c)
+  {
+    const auto& comp = cinfo.comp_info[c];
+    component_info.push_back({to_pixel_length(comp.downsampled_width),
+                              to_pixel_length(comp.downsampled_height),
+                              to_pixel_length(comp.width_in_blocks * DCTSIZE)});
+  }
+
+  return component_info;
+}
+
 bool JPEGDecompressionCycle::decompress(RowPointers& row_pointers)
 {
   using value_type = PixelIndex::value_type;
 
+  if (!started_)
+  {
+    return false;
+  }
+
   auto& cinfo = obj_.impl_->cinfo;
 
   const auto region_valid = !region_.empty();
@@ -193,10 +345,19 @@ bool JPEGDecompressionCycle::decompress(RowPointers& row_pointers)
   jpeg_skip_scanlines(&cinfo, static_cast<JDIMENSION>(skip_lines_top));
 #endif
 
-  while (static_cast<value_type>(cinfo.output_scanline) < static_cast<value_type>(cinfo.output_height) - skip_lines_bottom)
   {
-    const auto idx = static_cast<std::size_t>(static_cast<value_type>(cinfo.output_scanline) - skip_lines_top);
-    jpeg_read_scanlines(&cinfo, &row_pointers[idx], 1);
+    // Request up to `rec_outbuf_height` scanlines per call, which avoids the internal copy through the (possibly
+    // multi-row) upsampling buffer for each single row.
+    const auto last_scanline = static_cast<value_type>(cinfo.output_height) - skip_lines_bottom;
+    const auto max_lines_per_call = std::max(value_type{1}, static_cast<value_type>(cinfo.rec_outbuf_height));
+
+    while (static_cast<value_type>(cinfo.output_scanline) < last_scanline)
+    {
+      const auto scanline = static_cast<value_type>(cinfo.output_scanline);
+      const auto idx = static_cast<std::size_t>(scanline - skip_lines_top);
+      const auto nr_lines = std::min(max_lines_per_call, last_scanline - scanline);
+      jpeg_read_scanlines(&cinfo, &row_pointers[idx], static_cast<JDIMENSION>(nr_lines));
+    }
   }
 
 #if defined(SELENE_LIBJPEG_PARTIAL_DECODING)
@@ -213,6 +374,84 @@ failure_state:
   return false;
 }
 
+bool JPEGDecompressionCycle::decompress_raw(std::vector<MutableImageView<std::uint8_t>>& planes)
+{
+  if (!started_)
+  {
+    return false;
+  }
+
+  auto& cinfo = obj_.impl_->cinfo;
+  SELENE_FORCED_ASSERT(cinfo.raw_data_out);
+
+  const auto nr_components = static_cast<std::size_t>(cinfo.num_components);
+  const auto component_info = get_component_info();
+  const auto nr_lines_per_call = static_cast<JDIMENSION>(cinfo.max_v_samp_factor * DCTSIZE);
+
+  // Rows past the bottom of a plane (up to the next iMCU row boundary) are decompressed into a scratch row.
+  std::size_t max_padded_width = 0;
+  for (const auto& info : component_info)
+  {
+    max_padded_width = std::max(max_padded_width, static_cast<std::size_t>(info.padded_width));
+  }
+  std::vector<JSAMPLE> scratch_row(max_padded_width);
+
+  std::array<std::vector<JSAMPROW>, MAX_COMPONENTS> component_rows;
+  std::array<JSAMPARRAY, MAX_COMPONENTS> data{};
+
+  if (setjmp(obj_.impl_->error_manager.setjmp_buffer))
+  {
+    goto failure_state;
+  }
+
+  if (planes.size() != nr_components || nr_components > MAX_COMPONENTS)
+  {
+    obj_.impl_->error_manager.message_log.add("Number of supplied planes does not match number of components.",
+                                              MessageType::Error);
+    goto failure_state;
+  }
+
+  for (std::size_t c = 0; c < nr_components; ++c)
+  {
+    if (planes[c].width() != component_info[c].width || planes[c].height() != component_info[c].height
+        || planes[c].stride_bytes() < to_stride(component_info[c].padded_width))
+    {
+      obj_.impl_->error_manager.message_log.add("Supplied plane has an incompatible layout.", MessageType::Error);
+      goto failure_state;
+    }
+
+    component_rows[c].resize(static_cast<std::size_t>(cinfo.comp_info[c].v_samp_factor * DCTSIZE));
+    data[c] = component_rows[c].data();
+  }
+
+  while (cinfo.output_scanline < cinfo.output_height)
+  {
+    const auto imcu_row = cinfo.output_scanline / nr_lines_per_call;
+
+    for (std::size_t c = 0; c < nr_components; ++c)
+    {
+      const auto nr_rows = component_rows[c].size();
+      const auto plane_height = static_cast<std::size_t>(component_info[c].height);
+
+      for (std::size_t r = 0; r < nr_rows; ++r)
+      {
+        const auto y = imcu_row * nr_rows + r;
+        component_rows[c][r] = (y < plane_height) ? planes[c].data(to_pixel_index(y)) : scratch_row.data();
+      }
+    }
+
+    jpeg_read_raw_data(&cinfo, data.data(), nr_lines_per_call);
+  }
+
+  jpeg_finish_decompress(&cinfo);
+  finished_or_aborted_ = true;
+  return true;
+
+failure_state:
+  jpeg_abort_decompress(&cinfo);
+  finished_or_aborted_ = true;
+  return false;
+}
 
 // -------------------------------
 // Decompression related functions
@@ -226,9 +465,17 @@ void set_source(JPEGDecompressionObject& obj, FileReader& source)
     goto failure_state;
   }
 
+  // Return to the initial state, in case only the header of the previous stream has been read
+  jpeg_abort_decompress(&obj.impl_->cinfo);
+
+  // libjpeg refuses to replace a source manager of a different type, so restore its own one (if present)
+  obj.impl_->cinfo.src = obj.impl_->stdio_source;
   jpeg_stdio_src(&obj.impl_->cinfo, source.handle());
+  obj.impl_->stdio_source = obj.impl_->cinfo.src;
+  return;
 
-failure_state:;
+failure_state:
+  obj.impl_->needs_reset = true;
 }
 
 void set_source(JPEGDecompressionObject& obj, MemoryReader& source)
@@ -243,9 +490,50 @@ void set_source(JPEGDecompressionObject& obj, MemoryReader& source)
     goto failure_state;
   }
 
+  jpeg_abort_decompress(&obj.impl_->cinfo);
+  obj.impl_->cinfo.src = obj.impl_->memory_source;
   jpeg_mem_src(&obj.impl_->cinfo, handle, static_cast<unsigned long>(source.size()));
+  obj.impl_->memory_source = obj.impl_->cinfo.src;
+  return;
+
+failure_state:
+  obj.impl_->needs_reset = true;
+}
+
+void set_source(JPEGDecompressionObject& obj, MmapReader& source)
+{
+  set_source(obj, source.memory_reader());
+}
+
+void set_source(JPEGDecompressionObject& obj, AsyncFileReader& source)
+{
+  obj.reset_if_needed();
+
+  if (setjmp(obj.impl_->error_manager.setjmp_buffer))
+  {
+    goto failure_state;
+  }
+
+  jpeg_abort_decompress(&obj.impl_->cinfo);
+
+  {
+    auto& async_source = obj.impl_->async_source;
+    async_source.pub.init_source = async_init_source;
+    async_source.pub.fill_input_buffer = async_fill_input_buffer;
+    async_source.pub.skip_input_data = async_skip_input_data;
+    async_source.pub.resync_to_restart = jpeg_resync_to_restart;
+    async_source.pub.term_source = async_term_source;
+    async_source.pub.next_input_byte = nullptr;
+    async_source.pub.bytes_in_buffer = 0;
+    async_source.reader = &source;
+    async_source.nr_bytes_handed_out = 0;
+    obj.impl_->cinfo.src = &async_source.pub;
+  }
+
+  return;
 
-failure_state:;
+failure_state:
+  obj.impl_->needs_reset = true;
 }
 
 JPEGImageInfo read_header(JPEGDecompressionObject& obj)
@@ -261,6 +549,9 @@ JPEGImageInfo read_header(JPEGDecompressionObject& obj)
   return obj.get_header_info();
 
 failure_state:
+  // Return the object to its initial state, so that it can be re-used for reading another stream.
+  jpeg_abort_decompress(&obj.impl_->cinfo);
+  obj.impl_->needs_reset = true;
   return JPEGImageInfo();  // invalid header info
 }
 
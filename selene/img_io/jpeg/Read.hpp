@@ -15,8 +15,10 @@
 #include <selene/base/MessageLog.hpp>
 #include <selene/base/Utils.hpp>
 
+#include <selene/base/io/AsyncFileReader.hpp>
 #include <selene/base/io/FileReader.hpp>
 #include <selene/base/io/MemoryReader.hpp>
+#include <selene/base/io/MmapReader.hpp>
 
 #include <selene/img/common/BoundingBox.hpp>
 #include <selene/img/common/RowPointers.hpp>
@@ -26,6 +28,9 @@
 #include <selene/img/dynamic/_impl/StaticChecks.hpp>
 #include <selene/img/dynamic/_impl/Utils.hpp>
 
+#include <selene/img/typed/Image.hpp>
+#include <selene/img/typed/ImageView.hpp>
+
 #include <selene/img_io/_impl/Util.hpp>
 #include <selene/img_io/jpeg/Common.hpp>
 #include <selene/img_io/jpeg/_impl/Common.hpp>
@@ -33,6 +38,8 @@
 #include <array>
 #include <cstdio>
 #include <memory>
+#include <type_traits>
+#include <vector>
 
 namespace sln {
 
@@ -46,6 +53,8 @@ namespace impl {
 class JPEGDecompressionCycle;
 void set_source(JPEGDecompressionObject&, FileReader&);
 void set_source(JPEGDecompressionObject&, MemoryReader&);
+void set_source(JPEGDecompressionObject&, MmapReader&);
+void set_source(JPEGDecompressionObject&, AsyncFileReader&);
 JPEGImageInfo read_header(JPEGDecompressionObject&);
 }  // namespace impl
 
@@ -72,11 +81,23 @@ struct JPEGImageInfo
 
 /** \brief JPEG decompression options.
  *
+ * Besides the options settable through the constructor, the remaining members can be set directly.
+ *
+ * Setting `scale_num` and `scale_denom` enables scaled decompression in the DCT domain, which is considerably cheaper
+ * than decompressing at full resolution and downscaling afterwards. libjpeg supports scaling factors of M/8 (with
+ * M from 1 to 16, for libjpeg-turbo); other ratios are rounded to the nearest supported factor. The output image
+ * dimensions (as reported in the `JPEGImageInfo` returned by e.g. `JPEGReader<>::get_output_image_info()`) reflect the
+ * scaling; `region`, if set, is interpreted in coordinates of the scaled output image.
  */
 struct JPEGDecompressionOptions
 {
   JPEGColorSpace out_color_space;  ///< The color space for the uncompressed data.
   BoundingBox region;  ///< If set (and supported), decompress only the specified image region (libjpeg-turbo).
+  unsigned int scale_num = 1;  ///< Numerator of the output scaling factor.
+  unsigned int scale_denom = 1;  ///< Denominator of the output scaling factor.
+  JPEGDCTMethod dct_method = JPEGDCTMethod::IntegerSlow;  ///< The inverse DCT method.
+  bool do_fancy_upsampling = true;  ///< If true, use smooth (instead of fast) chroma upsampling.
+  bool do_block_smoothing = true;  ///< If true, apply inter-block smoothing for early progressive scans.
 
   /** \brief Constructor, setting the respective JPEG decompression options.
    *
@@ -118,7 +139,7 @@ public:
   [[nodiscard]] const MessageLog& message_log() const;
 
   [[nodiscard]] JPEGImageInfo get_header_info() const;
-  void set_decompression_parameters(JPEGColorSpace out_color_space = JPEGColorSpace::Auto);
+  void set_decompression_parameters(const JPEGDecompressionOptions& options = JPEGDecompressionOptions());
   /// \endcond
 
 private:
@@ -130,13 +151,14 @@ private:
   friend class impl::JPEGDecompressionCycle;
   friend void impl::set_source(JPEGDecompressionObject&, FileReader&);
   friend void impl::set_source(JPEGDecompressionObject&, MemoryReader&);
+  friend void impl::set_source(JPEGDecompressionObject&, AsyncFileReader&);
   friend JPEGImageInfo impl::read_header(JPEGDecompressionObject&);
 };
 
 
 /** \brief Reads header of JPEG image data stream.
  *
- * @tparam SourceType Type of the input source. Can be FileReader or MemoryReader.
+ * @tparam SourceType Type of the input source. Can be FileReader, MemoryReader, MmapReader, or AsyncFileReader.
  * @param source Input source instance.
  * @param rewind If true, the source position will be re-set to the original position after reading the header.
  * @param messages Optional pointer to the message log. If provided, warning and error messages will be output there.
@@ -149,7 +171,7 @@ JPEGImageInfo read_jpeg_header(SourceType&& source, bool rewind = false, Message
  *
  * This function overload enables re-use of a JPEGDecompressionObject instance.
  *
- * @tparam SourceType Type of the input source. Can be FileReader or MemoryReader.
+ * @tparam SourceType Type of the input source. Can be FileReader, MemoryReader, MmapReader, or AsyncFileReader.
  * @param obj A JPEGDecompressionObject instance.
  * @param source Input source instance.
  * @param rewind If true, the source position will be re-set to the original position after reading the header.
@@ -167,7 +189,7 @@ JPEGImageInfo read_jpeg_header(JPEGDecompressionObject& obj,
  * The source position must be set to the beginning of the JPEG stream, including header. In case img::read_jpeg_header
  * is called before, then it must be with `rewind == true`.
  *
- * @tparam SourceType Type of the input source. Can be FileReader or MemoryReader.
+ * @tparam SourceType Type of the input source. Can be FileReader, MemoryReader, MmapReader, or AsyncFileReader.
  * @param source Input source instance.
  * @param options The decompression options.
  * @param messages Optional pointer to the message log. If provided, warning and error messages will be output there.
@@ -187,7 +209,7 @@ DynImage<Allocator> read_jpeg(SourceType&& source,
  *
  * This function overload enables re-use of a JPEGDecompressionObject instance.
  *
- * @tparam SourceType Type of the input source. Can be FileReader or MemoryReader.
+ * @tparam SourceType Type of the input source. Can be FileReader, MemoryReader, MmapReader, or AsyncFileReader.
  * @param obj A JPEGDecompressionObject instance.
  * @param source Input source instance.
  * @param options The decompression options.
@@ -203,6 +225,112 @@ DynImage<Allocator> read_jpeg(JPEGDecompressionObject& obj,
                               MessageLog* messages = nullptr,
                               const JPEGImageInfo* provided_header_info = nullptr);
 
+/** \brief Reads contents of a JPEG image data stream into a dynamic image or into a pre-allocated dynamic image view.
+ *
+ * In case a `MutableDynImageView` is supplied, its layout has to be compatible with the decompressed image data, i.e.
+ * width, height, number of channels and number of bytes per channel have to match; the row stride may differ.
+ * No memory is allocated for the decompressed image data in this case.
+ *
+ * @tparam SourceType Type of the input source. Can be FileReader, MemoryReader, MmapReader, or AsyncFileReader.
+ * @tparam DynImageOrView Type of the output; either `DynImage<>` or `MutableDynImageView`.
+ * @param source Input source instance.
+ * @param[out] dyn_img_or_view The output dynamic image or view.
+ * @param options The decompression options.
+ * @param messages Optional pointer to the message log. If provided, warning and error messages will be output there.
+ * @return True, if reading the JPEG stream was successful; false otherwise.
+ */
+template <typename SourceType, typename DynImageOrView,
+          typename = std::enable_if_t<impl::is_dyn_image_or_mutable_view_v<DynImageOrView>>>
+bool read_jpeg(SourceType&& source,
+               DynImageOrView& dyn_img_or_view,
+               JPEGDecompressionOptions options = JPEGDecompressionOptions(),
+               MessageLog* messages = nullptr);
+
+/** \brief Reads contents of a JPEG image data stream into a dynamic image or into a pre-allocated dynamic image view.
+ *
+ * In case a `MutableDynImageView` is supplied, its layout has to be compatible with the decompressed image data, i.e.
+ * width, height, number of channels and number of bytes per channel have to match; the row stride may differ.
+ * No memory is allocated for the decompressed image data in this case.
+ *
+ * This function overload enables re-use of a JPEGDecompressionObject instance, e.g. one per thread when decoding a
+ * large batch of images into a pool of pre-allocated views.
+ *
+ * @tparam SourceType Type of the input source. Can be FileReader, MemoryReader, MmapReader, or AsyncFileReader.
+ * @tparam DynImageOrView Type of the output; either `DynImage<>` or `MutableDynImageView`.
+ * @param obj A JPEGDecompressionObject instance.
+ * @param source Input source instance.
+ * @param[out] dyn_img_or_view The output dynamic image or view.
+ * @param options The decompression options.
+ * @param messages Optional pointer to the message log. If provided, warning and error messages will be output there.
+ * @param provided_header_info Optional JPEG header information, obtained through a call to img::read_jpeg_header.
+ * @return True, if reading the JPEG stream was successful; false otherwise.
+ */
+template <typename SourceType, typename DynImageOrView,
+          typename = std::enable_if_t<impl::is_dyn_image_or_mutable_view_v<DynImageOrView>>>
+bool read_jpeg(JPEGDecompressionObject& obj,
+               SourceType&& source,
+               DynImageOrView& dyn_img_or_view,
+               JPEGDecompressionOptions options = JPEGDecompressionOptions(),
+               MessageLog* messages = nullptr,
+               const JPEGImageInfo* provided_header_info = nullptr);
+
+/** \brief Planar JPEG image data, as stored inside the JPEG stream.
+ *
+ * Contains one 8-bit plane per image component, each at its native resolution (i.e. at the chroma subsampling of
+ * the JPEG stream), and without any color conversion applied.
+ *
+ * @tparam Allocator The allocator type of the image planes.
+ */
+template <typename Allocator = default_bytes_allocator>
+struct JPEGPlanarImage
+{
+  std::vector<Image<std::uint8_t, Allocator>> planes;  ///< The image planes, one per component.
+  JPEGColorSpace color_space = JPEGColorSpace::Unknown;  ///< The color space of the components.
+
+  /** \brief Returns whether the planar image data is valid.
+   *
+   * @return True, if the planar image data is valid; false otherwise.
+   */
+  [[nodiscard]] bool is_valid() const { return !planes.empty(); }
+};
+
+/** \brief Reads contents of a JPEG image data stream as raw planar data, without color conversion or upsampling.
+ *
+ * This uses the "raw data" interface of libjpeg. For a typical YCbCr image, the first plane contains the luma
+ * component at full resolution, and the remaining two planes contain the chroma components, potentially at a lower
+ * resolution due to chroma subsampling.
+ * Skipping the color conversion and chroma upsampling steps makes decompression considerably cheaper, e.g. for
+ * applications that only process the luma component.
+ *
+ * The `scale_num`/`scale_denom` and `region` decompression options are not supported and will be ignored.
+ *
+ * @tparam SourceType Type of the input source. Can be FileReader, MemoryReader, MmapReader, or AsyncFileReader.
+ * @param source Input source instance.
+ * @param messages Optional pointer to the message log. If provided, warning and error messages will be output there.
+ * @return A `JPEGPlanarImage` instance. Reading the JPEG stream was successful, if `is_valid() == true`, and
+ * unsuccessful otherwise.
+ */
+template <typename Allocator = default_bytes_allocator, typename SourceType>
+JPEGPlanarImage<Allocator> read_jpeg_planar(SourceType&& source, MessageLog* messages = nullptr);
+
+/** \brief Reads contents of a JPEG image data stream as raw planar data, without color conversion or upsampling.
+ *
+ * This function overload enables re-use of a JPEGDecompressionObject instance.
+ *
+ * @tparam SourceType Type of the input source. Can be FileReader, MemoryReader, MmapReader, or AsyncFileReader.
+ * @param obj A JPEGDecompressionObject instance.
+ * @param source Input source instance.
+ * @param messages Optional pointer to the message log. If provided, warning and error messages will be output there.
+ * @param provided_header_info Optional JPEG header information, obtained through a call to img::read_jpeg_header.
+ * @return A `JPEGPlanarImage` instance. Reading the JPEG stream was successful, if `is_valid() == true`, and
+ * unsuccessful otherwise.
+ */
+template <typename Allocator = default_bytes_allocator, typename SourceType>
+JPEGPlanarImage<Allocator> read_jpeg_planar(JPEGDecompressionObject& obj,
+                                            SourceType&& source,
+                                            MessageLog* messages = nullptr,
+                                            const JPEGImageInfo* provided_header_info = nullptr);
+
 /** Class with functionality to read header and data of a JPEG image data stream.
  *
  * Generally, the free functions read_jpeg() or read_jpeg_header() should be preferred, due to ease of use.
@@ -220,7 +348,7 @@ DynImage<Allocator> read_jpeg(JPEGDecompressionObject& obj,
  * The source may optionally be re-set using `set_source()`; this is required if the previous image has not been read
  * completely or successfully.
  *
- * @tparam SourceType Type of the input source. Can be FileReader or MemoryReader.
+ * @tparam SourceType Type of the input source. Can be FileReader, MemoryReader, MmapReader, or AsyncFileReader.
  */
 template <typename SourceType>
 class JPEGReader
@@ -258,10 +386,17 @@ private:
 
 namespace impl {
 
+struct JPEGComponentInfo
+{
+  PixelLength width;  // width of the component plane
+  PixelLength height;  // height of the component plane
+  PixelLength padded_width;  // width of the component plane, padded to a full DCT block
+};
+
 class JPEGDecompressionCycle
 {
 public:
-  JPEGDecompressionCycle(JPEGDecompressionObject& obj, const BoundingBox& region);
+  JPEGDecompressionCycle(JPEGDecompressionObject& obj, const BoundingBox& region, bool raw_data = false);
 
   JPEGDecompressionCycle(const JPEGDecompressionCycle&) = default;
   JPEGDecompressionCycle& operator=(const JPEGDecompressionCycle&) = delete;
@@ -271,11 +406,14 @@ public:
   ~JPEGDecompressionCycle();
 
   [[nodiscard]] JPEGImageInfo get_output_info() const;
+  [[nodiscard]] std::vector<JPEGComponentInfo> get_component_info() const;
   bool decompress(RowPointers& row_pointers);
+  bool decompress_raw(std::vector<MutableImageView<std::uint8_t>>& planes);
 
 private:
   JPEGDecompressionObject& obj_;
   BoundingBox region_;
+  bool started_ = false;
   bool finished_or_aborted_ = false;
 };
 
@@ -331,6 +469,37 @@ DynImage<Allocator> read_jpeg(JPEGDecompressionObject& obj,
                               JPEGDecompressionOptions options,
                               MessageLog* messages,
                               const JPEGImageInfo* provided_header_info)
+{
+  DynImage<Allocator> dyn_img;
+  const auto success = read_jpeg(obj, std::forward<SourceType>(source), dyn_img, options, messages,
+                                 provided_header_info);
+
+  if (!success)
+  {
+    dyn_img.clear();  // invalidates image data
+  }
+
+  return dyn_img;
+}
+
+template <typename SourceType, typename DynImageOrView, typename>
+bool read_jpeg(SourceType&& source,
+               DynImageOrView& dyn_img_or_view,
+               JPEGDecompressionOptions options,
+               MessageLog* messages)
+{
+  JPEGDecompressionObject obj;
+  SELENE_ASSERT(obj.valid());
+  return read_jpeg(obj, std::forward<SourceType>(source), dyn_img_or_view, options, messages, nullptr);
+}
+
+template <typename SourceType, typename DynImageOrView, typename>
+bool read_jpeg(JPEGDecompressionObject& obj,
+               SourceType&& source,
+               DynImageOrView& dyn_img_or_view,
+               JPEGDecompressionOptions options,
+               MessageLog* messages,
+               const JPEGImageInfo* provided_header_info)
 {
   if (!provided_header_info)
   {
@@ -339,7 +508,7 @@ DynImage<Allocator> read_jpeg(JPEGDecompressionObject& obj,
     if (obj.error_state())
     {
       impl::assign_message_log(obj, messages);
-      return DynImage<Allocator>();
+      return false;
     }
   }
 
@@ -348,14 +517,21 @@ DynImage<Allocator> read_jpeg(JPEGDecompressionObject& obj,
   if (!header_info.is_valid())
   {
     impl::assign_message_log(obj, messages);
-    return DynImage<Allocator>();
+    return false;
   }
 
-  obj.set_decompression_parameters(options.out_color_space);
+  obj.set_decompression_parameters(options);
 
   impl::JPEGDecompressionCycle cycle(obj, options.region);
 
   const auto output_info = cycle.get_output_info();
+
+  if (!output_info.is_valid())
+  {
+    impl::assign_message_log(obj, messages);
+    return false;
+  }
+
   const auto output_width = output_info.width;
   const auto output_height = output_info.height;
   const auto output_nr_channels = static_cast<std::int16_t>(output_info.nr_channels);
@@ -364,19 +540,85 @@ DynImage<Allocator> read_jpeg(JPEGDecompressionObject& obj,
   const auto output_pixel_format = impl::color_space_to_pixel_format(output_info.color_space);
   const auto output_sample_format = SampleFormat::UnsignedInteger;
 
-  DynImage<Allocator> dyn_img({output_width, output_height, output_nr_channels, output_nr_bytes_per_channel,
-                               output_stride_bytes},
-                              {output_pixel_format, output_sample_format});
-  auto row_pointers = get_row_pointers(dyn_img);
+  const auto output_layout = UntypedLayout{output_width, output_height, output_nr_channels, output_nr_bytes_per_channel,
+                                           output_stride_bytes};
+  const auto output_semantics = UntypedImageSemantics{output_pixel_format, output_sample_format};
+
+  const bool prepare_success = impl::prepare_image_or_view(dyn_img_or_view, output_layout, output_semantics);
+
+  if (!prepare_success)
+  {
+    obj.message_log().add("Supplied image view has an incompatible layout.", MessageType::Error);
+    impl::assign_message_log(obj, messages);
+    return false;
+  }
+
+  auto row_pointers = get_row_pointers(dyn_img_or_view);
   const auto dec_success = cycle.decompress(row_pointers);
 
+  impl::assign_message_log(obj, messages);
+  return dec_success;
+}
+
+
+template <typename Allocator, typename SourceType>
+JPEGPlanarImage<Allocator> read_jpeg_planar(SourceType&& source, MessageLog* messages)
+{
+  JPEGDecompressionObject obj;
+  SELENE_ASSERT(obj.valid());
+  return read_jpeg_planar<Allocator>(obj, std::forward<SourceType>(source), messages, nullptr);
+}
+
+template <typename Allocator, typename SourceType>
+JPEGPlanarImage<Allocator> read_jpeg_planar(JPEGDecompressionObject& obj,
+                                            SourceType&& source,
+                                            MessageLog* messages,
+                                            const JPEGImageInfo* provided_header_info)
+{
+  if (!provided_header_info)
+  {
+    impl::set_source(obj, source);
+
+    if (obj.error_state())
+    {
+      impl::assign_message_log(obj, messages);
+      return JPEGPlanarImage<Allocator>();
+    }
+  }
+
+  const JPEGImageInfo header_info = provided_header_info ? *provided_header_info : impl::read_header(obj);
+
+  if (!header_info.is_valid())
+  {
+    impl::assign_message_log(obj, messages);
+    return JPEGPlanarImage<Allocator>();
+  }
+
+  obj.set_decompression_parameters();
+
+  impl::JPEGDecompressionCycle cycle(obj, BoundingBox(), true);
+  const auto component_info = cycle.get_component_info();
+
+  // Each plane is allocated with a row stride covering the full DCT block width, s.t. libjpeg can decompress
+  // directly into the plane memory.
+  JPEGPlanarImage<Allocator> planar_img;
+  planar_img.color_space = header_info.color_space;
+  std::vector<MutableImageView<std::uint8_t>> plane_views;
+  for (const auto& info : component_info)
+  {
+    planar_img.planes.emplace_back(TypedLayout{info.width, info.height, to_stride(info.padded_width)});
+    plane_views.push_back(planar_img.planes.back().view());
+  }
+
+  const auto dec_success = cycle.decompress_raw(plane_views);
+
   if (!dec_success)
   {
-    dyn_img.clear();  // invalidates image data
+    planar_img = JPEGPlanarImage<Allocator>();
   }
 
   impl::assign_message_log(obj, messages);
-  return dyn_img;
+  return planar_img;
 }
 
 
@@ -447,7 +689,7 @@ JPEGImageInfo JPEGReader<SourceType>::get_output_image_info()
 
   if (!cycle_)
   {
-    obj_.set_decompression_parameters(options_.out_color_space);
+    obj_.set_decompression_parameters(options_);
     cycle_ = std::make_unique<impl::JPEGDecompressionCycle>(obj_, options_.region);
   }
 
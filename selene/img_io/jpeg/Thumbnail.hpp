@@ -0,0 +1,152 @@
+// This file is part of the `Selene` library.
+// Copyright 2017-2019 Michael Hofmann (https://github.com/kmhofmann).
+// Distributed under MIT license. See accompanying LICENSE file in the top-level directory.
+
+#ifndef SELENE_IMG_JPEG_THUMBNAIL_HPP
+#define SELENE_IMG_JPEG_THUMBNAIL_HPP
+
+/// @file
+
+#include <selene/selene_config.hpp>
+
+#if defined(SELENE_WITH_LIBJPEG)
+
+#include <selene/base/MessageLog.hpp>
+
+#include <selene/img/dynamic/DynImage.hpp>
+#include <selene/img/interop/DynImageToImage.hpp>
+#include <selene/img/interop/ImageToDynImage.hpp>
+#include <selene/img/pixel/Pixel.hpp>
+#include <selene/img/typed/Image.hpp>
+
+#include <selene/img_io/jpeg/Read.hpp>
+
+#include <selene/img_ops/Resample.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+namespace sln {
+
+/// \addtogroup group-img-io-jpeg
+/// @{
+
+template <typename Allocator = default_bytes_allocator, typename SourceType>
+DynImage<Allocator> read_jpeg_thumbnail(SourceType&& source,
+                                        PixelLength max_width,
+                                        PixelLength max_height,
+                                        JPEGDecompressionOptions options = JPEGDecompressionOptions(),
+                                        MessageLog* messages = nullptr);
+
+/// @}
+
+// ----------
+// Implementation:
+
+namespace impl {
+
+inline PixelLength jpeg_scaled_length(PixelLength length, unsigned int scale_num, unsigned int scale_denom)
+{
+  // libjpeg rounds scaled output dimensions up
+  const auto len = static_cast<std::uint64_t>(length);
+  return to_pixel_length((len * scale_num + scale_denom - 1) / scale_denom);
+}
+
+template <typename PixelType, typename Allocator>
+DynImage<Allocator> resample_dyn_image(DynImage<Allocator>&& dyn_img, PixelLength width, PixelLength height)
+{
+  const auto pixel_format = dyn_img.pixel_format();
+  const auto img_src = to_image<PixelType>(std::move(dyn_img));
+  Image<PixelType, Allocator> img_dst;
+  resample<ImageInterpolationMode::Bilinear>(img_src, width, height, img_dst);
+  return to_dyn_image(std::move(img_dst), pixel_format);
+}
+
+}  // namespace impl
+
+/** \brief Reads a downscaled version of a JPEG image, fitting into the specified maximum extents.
+ *
+ * The aspect ratio of the image is preserved. The image is first decompressed using the smallest scaling factor in the
+ * DCT domain (M/8, with M from 1 to 8) whose result is at least as large as the requested output extents, which is
+ * much cheaper than full decompression. The result is then resampled (bilinearly) to the exact output extents.
+ *
+ * Images that already fit into the maximum extents are returned at their original size.
+ *
+ * @tparam SourceType Type of the input source. Can be FileReader, MemoryReader, MmapReader, or AsyncFileReader.
+ * @param source Input source instance.
+ * @param max_width The maximum width of the output image.
+ * @param max_height The maximum height of the output image.
+ * @param options The decompression options. Any scaling factor set will be overridden, and `region` is ignored.
+ * @param messages Optional pointer to the message log. If provided, warning and error messages will be output there.
+ * @return A `DynImage` instance. Reading the JPEG stream was successful, if `is_valid() == true`, and unsuccessful
+ * otherwise.
+ */
+template <typename Allocator, typename SourceType>
+DynImage<Allocator> read_jpeg_thumbnail(SourceType&& source,
+                                        PixelLength max_width,
+                                        PixelLength max_height,
+                                        JPEGDecompressionOptions options,
+                                        MessageLog* messages)
+{
+  JPEGDecompressionObject obj;
+  SELENE_ASSERT(obj.valid());
+
+  const auto header_info = read_jpeg_header(obj, source, false, messages);
+
+  if (!header_info.is_valid() || max_width <= 0 || max_height <= 0)
+  {
+    return DynImage<Allocator>();
+  }
+
+  // Determine the output extents, preserving the aspect ratio
+  const auto factor = std::min({1.0,
+                                static_cast<double>(max_width) / static_cast<double>(header_info.width),
+                                static_cast<double>(max_height) / static_cast<double>(header_info.height)});
+  const auto width = to_pixel_length(std::max(1.0, std::round(factor * static_cast<double>(header_info.width))));
+  const auto height = to_pixel_length(std::max(1.0, std::round(factor * static_cast<double>(header_info.height))));
+
+  // Determine the smallest DCT domain scaling factor that does not go below the output extents
+  constexpr unsigned int scale_denom = 8;
+  unsigned int scale_num = 1;
+  for (; scale_num < scale_denom; ++scale_num)
+  {
+    if (impl::jpeg_scaled_length(header_info.width, scale_num, scale_denom) >= width
+        && impl::jpeg_scaled_length(header_info.height, scale_num, scale_denom) >= height)
+    {
+      break;
+    }
+  }
+
+  options.scale_num = scale_num;
+  options.scale_denom = scale_denom;
+  options.region = BoundingBox();
+
+  auto dyn_img = read_jpeg<Allocator>(obj, source, options, messages, &header_info);
+
+  if (!dyn_img.is_valid() || (dyn_img.width() == width && dyn_img.height() == height))
+  {
+    return dyn_img;
+  }
+
+  switch (dyn_img.nr_channels())
+  {
+    case 1: return impl::resample_dyn_image<Pixel<std::uint8_t, 1>>(std::move(dyn_img), width, height);
+    case 3: return impl::resample_dyn_image<Pixel<std::uint8_t, 3>>(std::move(dyn_img), width, height);
+    case 4: return impl::resample_dyn_image<Pixel<std::uint8_t, 4>>(std::move(dyn_img), width, height);
+    default:
+    {
+      if (messages)
+      {
+        messages->add("Cannot resample image with unsupported number of channels.", MessageType::Warning);
+      }
+      return dyn_img;
+    }
+  }
+}
+
+}  // namespace sln
+
+#endif  // defined(SELENE_WITH_LIBJPEG)
+
+#endif  // SELENE_IMG_JPEG_THUMBNAIL_HPP
@@ -15,18 +15,185 @@
 #include <csetjmp>
 #include <cstdio>
 #include <stdexcept>
+#include <string>
+#include <vector>
 
 namespace sln {
 
 /// \cond INTERNAL
 
+namespace impl {
+
+namespace {
+
+// Destination managers writing the compressed data directly into the respective sink.
+// The jpeg_destination_mgr member has to come first, since libjpeg only knows about a pointer to it.
+
+struct JPEGVectorDestination
+{
+  jpeg_destination_mgr pub;
+  VectorWriter* sink = nullptr;
+  std::size_t start_pos = 0;
+  std::size_t original_size = 0;
+};
+
+struct JPEGMemoryDestination
+{
+  jpeg_destination_mgr pub;
+  MemoryWriter* sink = nullptr;
+  std::size_t start_pos = 0;
+};
+
+struct JPEGBufferedFileDestination
+{
+  jpeg_destination_mgr pub;
+  BufferedFileWriter* sink = nullptr;
+  std::size_t nr_bytes_handed_out = 0;
+};
+
+[[noreturn]] void destination_error(j_compress_ptr cinfo, const char* msg)
+{
+  auto& err_man = *reinterpret_cast<JPEGErrorManager*>(cinfo->err);
+  err_man.message_log.add(std::string("Error: ") + msg, MessageType::Error);
+  err_man.error_state = true;
+  std::longjmp(err_man.setjmp_buffer, 1);
+}
+
+std::size_t estimate_compressed_size(j_compress_ptr cinfo)
+{
+  // Rough guess, which should cover typical photographic content at higher quality settings; the buffer is grown
+  // as needed otherwise.
+  const auto nr_raw_bytes = std::size_t{cinfo->image_width} * std::size_t{cinfo->image_height}
+                            * static_cast<std::size_t>(cinfo->input_components);
+  return nr_raw_bytes / 4 + 4096;
+}
+
+void resize_vector_destination(j_compress_ptr cinfo, std::size_t new_size)
+{
+  auto& dest = *reinterpret_cast<JPEGVectorDestination*>(cinfo->dest);
+  auto& vec = *dest.sink->handle();
+
+  try
+  {
+    vec.resize(new_size);
+  }
+  catch (const std::exception&)
+  {
+    destination_error(cinfo, "Could not allocate memory for JPEG output");
+  }
+}
+
+void init_vector_destination(j_compress_ptr cinfo)
+{
+  auto& dest = *reinterpret_cast<JPEGVectorDestination*>(cinfo->dest);
+  auto& vec = *dest.sink->handle();
+
+  dest.start_pos = static_cast<std::size_t>(dest.sink->position());
+  dest.original_size = vec.size();
+  resize_vector_destination(cinfo, std::max(vec.size(), dest.start_pos + estimate_compressed_size(cinfo)));
+
+  dest.pub.next_output_byte = vec.data() + dest.start_pos;
+  dest.pub.free_in_buffer = vec.size() - dest.start_pos;
+}
+
+boolean empty_vector_destination(j_compress_ptr cinfo)
+{
+  // Called when the buffer is completely filled; grow geometrically
+  auto& dest = *reinterpret_cast<JPEGVectorDestination*>(cinfo->dest);
+  auto& vec = *dest.sink->handle();
+
+  const auto old_size = vec.size();
+  resize_vector_destination(cinfo, old_size * 2);
+
+  dest.pub.next_output_byte = vec.data() + old_size;
+  dest.pub.free_in_buffer = vec.size() - old_size;
+  return TRUE;
+}
+
+void term_vector_destination(j_compress_ptr cinfo)
+{
+  auto& dest = *reinterpret_cast<JPEGVectorDestination*>(cinfo->dest);
+  auto& vec = *dest.sink->handle();
+
+  // Trim the unused part of the buffer, but never cut off data that was present before
+  const auto end_pos = vec.size() - dest.pub.free_in_buffer;
+  vec.resize(std::max(end_pos, dest.original_size));
+  dest.sink->seek_abs(static_cast<std::ptrdiff_t>(end_pos));
+}
+
+void init_memory_destination(j_compress_ptr cinfo)
+{
+  auto& dest = *reinterpret_cast<JPEGMemoryDestination*>(cinfo->dest);
+
+  dest.start_pos = static_cast<std::size_t>(dest.sink->position());
+  dest.pub.next_output_byte = dest.sink->handle() + dest.start_pos;
+  dest.pub.free_in_buffer = static_cast<std::size_t>(std::max(dest.sink->bytes_remaining(), std::ptrdiff_t{0}));
+}
+
+boolean empty_memory_destination(j_compress_ptr cinfo)
+{
+  destination_error(cinfo, "JPEG output exceeds the size of the memory region");
+}
+
+void term_memory_destination(j_compress_ptr cinfo)
+{
+  auto& dest = *reinterpret_cast<JPEGMemoryDestination*>(cinfo->dest);
+  const auto end_pos = static_cast<std::size_t>(dest.pub.next_output_byte - dest.sink->handle());
+  dest.sink->seek_abs(static_cast<std::ptrdiff_t>(end_pos));
+}
+
+// The buffered file destination lets libjpeg compress directly into the free space of the writer's buffer.
+
+void hand_out_buffered_file_space(j_compress_ptr cinfo)
+{
+  auto& dest = *reinterpret_cast<JPEGBufferedFileDestination*>(cinfo->dest);
+  const auto region = dest.sink->buffer_space();
+
+  if (region.len == 0)
+  {
+    destination_error(cinfo, "Could not write JPEG output to file");
+  }
+
+  dest.pub.next_output_byte = region.data;
+  dest.pub.free_in_buffer = region.len;
+  dest.nr_bytes_handed_out = region.len;
+}
+
+void init_buffered_file_destination(j_compress_ptr cinfo)
+{
+  hand_out_buffered_file_space(cinfo);
+}
+
+boolean empty_buffered_file_destination(j_compress_ptr cinfo)
+{
+  // Called when the handed out space is completely filled
+  auto& dest = *reinterpret_cast<JPEGBufferedFileDestination*>(cinfo->dest);
+  dest.sink->commit(dest.nr_bytes_handed_out);
+  hand_out_buffered_file_space(cinfo);
+  return TRUE;
+}
+
+void term_buffered_file_destination(j_compress_ptr cinfo)
+{
+  auto& dest = *reinterpret_cast<JPEGBufferedFileDestination*>(cinfo->dest);
+  dest.sink->commit(dest.nr_bytes_handed_out - dest.pub.free_in_buffer);
+  dest.pub.free_in_buffer = 0;
+  dest.nr_bytes_handed_out = 0;
+}
+
+}  // namespace
+
+}  // namespace impl
+
 struct JPEGCompressionObject::Impl
 {
   jpeg_compress_struct cinfo;
   impl::JPEGErrorManager error_manager;
 
-  unsigned char* output_buffer = nullptr;  // temporary buffer for in-memory decompression
-  unsigned long output_size = 0;  // size of in-memory buffer
+  jpeg_destination_mgr* stdio_destination = nullptr;  // allocated by libjpeg, on first use
+  impl::JPEGVectorDestination vector_destination;
+  impl::JPEGMemoryDestination memory_destination;
+  impl::JPEGBufferedFileDestination buffered_file_destination;
 
   bool valid = false;
   bool needs_reset = false;
@@ -38,18 +205,28 @@ JPEGCompressionObject::JPEGCompressionObject() : impl_(std::make_unique<JPEGComp
   impl_->cinfo.err->error_exit = impl::error_exit;
   impl_->cinfo.err->output_message = impl::output_message;
   jpeg_create_compress(&impl_->cinfo);
+
+  auto& vector_dest = impl_->vector_destination.pub;
+  vector_dest.init_destination = impl::init_vector_destination;
+  vector_dest.empty_output_buffer = impl::empty_vector_destination;
+  vector_dest.term_destination = impl::term_vector_destination;
+
+  auto& memory_dest = impl_->memory_destination.pub;
+  memory_dest.init_destination = impl::init_memory_destination;
+  memory_dest.empty_output_buffer = impl::empty_memory_destination;
+  memory_dest.term_destination = impl::term_memory_destination;
+
+  auto& buffered_file_dest = impl_->buffered_file_destination.pub;
+  buffered_file_dest.init_destination = impl::init_buffered_file_destination;
+  buffered_file_dest.empty_output_buffer = impl::empty_buffered_file_destination;
+  buffered_file_dest.term_destination = impl::term_buffered_file_destination;
+
   impl_->valid = true;
 }
 
 JPEGCompressionObject::~JPEGCompressionObject()
 {
   jpeg_destroy_compress(&impl_->cinfo);
-
-  if (impl_->output_buffer != nullptr)
-  {
-    std::free(impl_->output_buffer);
-    impl_->output_buffer = nullptr;
-  }
 }
 
 bool JPEGCompressionObject::valid() const
@@ -110,6 +287,109 @@ failure_state:
   return false;
 }
 
+bool JPEGCompressionObject::set_raw_image_info(const std::vector<ConstantImageView<std::uint8_t>>& planes,
+                                               JPEGColorSpace jpeg_color_space)
+{
+  const auto nr_components = static_cast<int>(planes.size());
+  auto& cinfo = impl_->cinfo;
+
+  if (nr_components == 0 || nr_components > MAX_COMPONENTS)
+  {
+    impl_->error_manager.message_log.add("Invalid number of image planes", MessageType::Error);
+    return false;
+  }
+
+  if (jpeg_color_space == JPEGColorSpace::Auto)
+  {
+    jpeg_color_space = (nr_components == 1) ? JPEGColorSpace::Grayscale
+                     : (nr_components == 3) ? JPEGColorSpace::YCbCr
+                     : (nr_components == 4) ? JPEGColorSpace::CMYK
+                     : JPEGColorSpace::Unknown;
+  }
+
+  if (jpeg_color_space == JPEGColorSpace::Unknown)
+  {
+    impl_->error_manager.message_log.add("Cannot determine JPEG color space from number of image planes",
+                                         MessageType::Error);
+    return false;
+  }
+
+  // Infer the sampling factors from the plane extents
+  int width = 0;
+  int height = 0;
+  for (const auto& plane : planes)
+  {
+    width = std::max(width, static_cast<int>(plane.width()));
+    height = std::max(height, static_cast<int>(plane.height()));
+  }
+
+  std::array<int, MAX_COMPONENTS> subsampling_x{};
+  std::array<int, MAX_COMPONENTS> subsampling_y{};
+  int max_subsampling_x = 1;
+  int max_subsampling_y = 1;
+  for (int c = 0; c < nr_components; ++c)
+  {
+    const auto plane_width = static_cast<int>(planes[static_cast<std::size_t>(c)].width());
+    const auto plane_height = static_cast<int>(planes[static_cast<std::size_t>(c)].height());
+
+    if (plane_width <= 0 || plane_height <= 0)
+    {
+      impl_->error_manager.message_log.add("Image plane is empty", MessageType::Error);
+      return false;
+    }
+
+    subsampling_x[c] = (width + plane_width / 2) / plane_width;
+    subsampling_y[c] = (height + plane_height / 2) / plane_height;
+    max_subsampling_x = std::max(max_subsampling_x, subsampling_x[c]);
+    max_subsampling_y = std::max(max_subsampling_y, subsampling_y[c]);
+  }
+
+  if (setjmp(impl_->error_manager.setjmp_buffer))
+  {
+    goto failure_state;
+  }
+
+  cinfo.image_width = static_cast<JDIMENSION>(width);
+  cinfo.image_height = static_cast<JDIMENSION>(height);
+  cinfo.input_components = nr_components;
+  cinfo.in_color_space = impl::color_space_pub_to_lib(jpeg_color_space);
+
+  jpeg_set_defaults(&cinfo);
+  jpeg_set_colorspace(&cinfo, impl::color_space_pub_to_lib(jpeg_color_space));
+  cinfo.raw_data_in = TRUE;
+
+  for (int c = 0; c < nr_components; ++c)
+  {
+    const auto h_samp_factor = max_subsampling_x / subsampling_x[c];
+    const auto v_samp_factor = max_subsampling_y / subsampling_y[c];
+    const auto plane_width = static_cast<int>(planes[static_cast<std::size_t>(c)].width());
+    const auto plane_height = static_cast<int>(planes[static_cast<std::size_t>(c)].height());
+
+    // Verify that the plane extents are consistent with what libjpeg computes from the sampling factors
+    const auto max_h_samp_factor = max_subsampling_x;
+    const auto max_v_samp_factor = max_subsampling_y;
+    const auto expected_width = (width * h_samp_factor + max_h_samp_factor - 1) / max_h_samp_factor;
+    const auto expected_height = (height * v_samp_factor + max_v_samp_factor - 1) / max_v_samp_factor;
+
+    if (max_subsampling_x % subsampling_x[c] != 0 || max_subsampling_y % subsampling_y[c] != 0
+        || h_samp_factor > MAX_SAMP_FACTOR || v_samp_factor > MAX_SAMP_FACTOR
+        || plane_width != expected_width || plane_height != expected_height)
+    {
+      impl_->error_manager.message_log.add("Image plane extents do not correspond to a supported chroma subsampling",
+                                           MessageType::Error);
+      return false;
+    }
+
+    cinfo.comp_info[c].h_samp_factor = h_samp_factor;
+    cinfo.comp_info[c].v_samp_factor = v_samp_factor;
+  }
+
+  return true;
+
+failure_state:
+  return false;
+}
+
 bool JPEGCompressionObject::set_compression_parameters(int quality, JPEGColorSpace color_space, bool optimize_coding)
 {
   const auto force_baseline = TRUE;
@@ -151,38 +431,141 @@ namespace impl {
 JPEGCompressionCycle::JPEGCompressionCycle(JPEGCompressionObject& obj) : obj_(obj)
 {
   obj_.reset_if_needed();
+
+  if (setjmp(obj_.impl_->error_manager.setjmp_buffer))
+  {
+    // e.g. the destination manager could not set up its buffer
+    jpeg_abort_compress(&obj_.impl_->cinfo);
+    aborted_ = true;
+    return;
+  }
+
   jpeg_start_compress(&obj_.impl_->cinfo, TRUE);
 }
 
 JPEGCompressionCycle::~JPEGCompressionCycle()
 {
-  jpeg_finish_compress(&obj_.impl_->cinfo);
+  if (!aborted_)
+  {
+    if (setjmp(obj_.impl_->error_manager.setjmp_buffer))
+    {
+      jpeg_abort_compress(&obj_.impl_->cinfo);
+    }
+    else
+    {
+      jpeg_finish_compress(&obj_.impl_->cinfo);
+    }
+  }
+
   obj_.impl_->needs_reset = true;
 }
 
 void JPEGCompressionCycle::compress(const ConstRowPointers& row_pointers)
 {
+  if (aborted_)
+  {
+    return;
+  }
+
   auto& cinfo = obj_.impl_->cinfo;
-  std::array<JSAMPLE*, 1> row_ptr = {{nullptr}};
+  SELENE_FORCED_ASSERT(row_pointers.size() == static_cast<std::size_t>(cinfo.image_height));
 
   if (setjmp(obj_.impl_->error_manager.setjmp_buffer))
   {
     goto failure_state;
   }
 
+  // Pass all remaining scanlines at once; libjpeg consumes as many as it can per call.
   while (cinfo.next_scanline < cinfo.image_height)
   {
-    auto row_ptr_c = row_pointers[cinfo.next_scanline];
     // Hack to accommodate non-const correct API
-    row_ptr[0] = const_cast<JSAMPLE*>(row_ptr_c);
-    const auto nr_scanlines_written = jpeg_write_scanlines(&cinfo, row_ptr.data(), 1);
-    SELENE_FORCED_ASSERT(nr_scanlines_written == 1);
+    const auto rows = const_cast<JSAMPARRAY>(row_pointers.data() + cinfo.next_scanline);
+    const auto nr_scanlines_written = jpeg_write_scanlines(&cinfo, rows, cinfo.image_height - cinfo.next_scanline);
+    SELENE_FORCED_ASSERT(nr_scanlines_written > 0);
   }
 
   return;
 
 failure_state:
   jpeg_abort_compress(&cinfo);
+  aborted_ = true;
+}
+
+void JPEGCompressionCycle::compress_raw(const std::vector<ConstantImageView<std::uint8_t>>& planes)
+{
+  if (aborted_)
+  {
+    return;
+  }
+
+  auto& cinfo = obj_.impl_->cinfo;
+  SELENE_FORCED_ASSERT(cinfo.raw_data_in);
+  SELENE_FORCED_ASSERT(planes.size() == static_cast<std::size_t>(cinfo.num_components));
+
+  const auto nr_components = planes.size();
+  const auto nr_lines_per_call = static_cast<JDIMENSION>(cinfo.max_v_samp_factor * DCTSIZE);
+
+  // libjpeg expects the input data to be padded to full iMCU extents. Rows that are not wide enough (or that lie past
+  // the bottom of a plane) are copied to a scratch buffer and padded by edge replication; all other rows are passed
+  // to libjpeg directly.
+  std::array<std::vector<JSAMPROW>, MAX_COMPONENTS> component_rows;
+  std::array<std::vector<JSAMPLE>, MAX_COMPONENTS> component_scratch;
+  std::array<std::size_t, MAX_COMPONENTS> padded_widths{};
+  std::array<JSAMPARRAY, MAX_COMPONENTS> data{};
+
+  for (std::size_t c = 0; c < nr_components; ++c)
+  {
+    const auto nr_rows = static_cast<std::size_t>(cinfo.comp_info[c].v_samp_factor * DCTSIZE);
+    padded_widths[c] = static_cast<std::size_t>(cinfo.comp_info[c].width_in_blocks * DCTSIZE);
+    component_rows[c].resize(nr_rows);
+    component_scratch[c].resize(nr_rows * padded_widths[c]);
+    data[c] = component_rows[c].data();
+  }
+
+  if (setjmp(obj_.impl_->error_manager.setjmp_buffer))
+  {
+    goto failure_state;
+  }
+
+  while (cinfo.next_scanline < cinfo.image_height)
+  {
+    const auto imcu_row = cinfo.next_scanline / nr_lines_per_call;
+
+    for (std::size_t c = 0; c < nr_components; ++c)
+    {
+      const auto& plane = planes[c];
+      const auto plane_width = static_cast<std::size_t>(plane.width());
+      const auto plane_height = static_cast<std::size_t>(plane.height());
+      const auto nr_rows = component_rows[c].size();
+
+      for (std::size_t r = 0; r < nr_rows; ++r)
+      {
+        const auto y = imcu_row * nr_rows + r;
+        const auto src_row = plane.data(to_pixel_index(std::min(y, plane_height - 1)));
+
+        if (y < plane_height && plane_width == padded_widths[c])
+        {
+          // Hack to accommodate non-const correct API
+          component_rows[c][r] = const_cast<JSAMPLE*>(src_row);
+        }
+        else
+        {
+          auto dst_row = component_scratch[c].data() + r * padded_widths[c];
+          std::copy(src_row, src_row + plane_width, dst_row);
+          std::fill(dst_row + plane_width, dst_row + padded_widths[c], src_row[plane_width - 1]);
+          component_rows[c][r] = dst_row;
+        }
+      }
+    }
+
+    jpeg_write_raw_data(&cinfo, data.data(), nr_lines_per_call);
+  }
+
+  return;
+
+failure_state:
+  jpeg_abort_compress(&cinfo);
+  aborted_ = true;
 }
 
 // -----------------------------
@@ -197,44 +580,54 @@ void set_destination(JPEGCompressionObject& obj, FileWriter& sink)
     goto failure_state;
   }
 
+  // libjpeg refuses to replace a destination manager set up by someone else, so restore its own one (if present)
+  obj.impl_->cinfo.dest = obj.impl_->stdio_destination;
   jpeg_stdio_dest(&obj.impl_->cinfo, sink.handle());
+  obj.impl_->stdio_destination = obj.impl_->cinfo.dest;
 
 failure_state:;
 }
 
-void set_destination(JPEGCompressionObject& obj, VectorWriter& /*sink*/)
+void set_destination(JPEGCompressionObject& obj, BufferedFileWriter& sink)
 {
   obj.reset_if_needed();
+  obj.impl_->buffered_file_destination.sink = &sink;
+  obj.impl_->cinfo.dest = &obj.impl_->buffered_file_destination.pub;
+}
 
-  if (setjmp(obj.impl_->error_manager.setjmp_buffer))
-  {
-    goto failure_state;
-  }
-
-  jpeg_mem_dest(&obj.impl_->cinfo, &obj.impl_->output_buffer, &obj.impl_->output_size);
+void set_destination(JPEGCompressionObject& obj, VectorWriter& sink)
+{
+  obj.reset_if_needed();
+  obj.impl_->vector_destination.sink = &sink;
+  obj.impl_->cinfo.dest = &obj.impl_->vector_destination.pub;
+}
 
-failure_state:;
+void set_destination(JPEGCompressionObject& obj, MemoryWriter& sink)
+{
+  obj.reset_if_needed();
+  obj.impl_->memory_destination.sink = &sink;
+  obj.impl_->cinfo.dest = &obj.impl_->memory_destination.pub;
 }
 
+// The compressed data is written directly to the sink by the destination managers, so there is nothing to flush.
+
 bool flush_data_buffer(JPEGCompressionObject& /*obj*/, FileWriter& /*sink*/)
 {
   return true;
 }
 
-bool flush_data_buffer(JPEGCompressionObject& obj, VectorWriter& sink)
+bool flush_data_buffer(JPEGCompressionObject& /*obj*/, BufferedFileWriter& /*sink*/)
 {
-  if (obj.impl_->output_buffer != nullptr)
-  {
-    const auto buf = static_cast<const std::uint8_t*>(obj.impl_->output_buffer);
-    const auto len = static_cast<std::size_t>(obj.impl_->output_size);
-    const auto nr_written = sink.write(buf, len);
+  return true;
+}
 
-    if (nr_written != static_cast<std::size_t>(obj.impl_->output_size))
-    {
-      return false;
-    }
-  }
+bool flush_data_buffer(JPEGCompressionObject& /*obj*/, VectorWriter& /*sink*/)
+{
+  return true;
+}
 
+bool flush_data_buffer(JPEGCompressionObject& /*obj*/, MemoryWriter& /*sink*/)
+{
   return true;
 }
 
@@ -15,7 +15,9 @@
 #include <selene/base/MessageLog.hpp>
 #include <selene/base/Utils.hpp>
 
+#include <selene/base/io/BufferedFileWriter.hpp>
 #include <selene/base/io/FileWriter.hpp>
+#include <selene/base/io/MemoryWriter.hpp>
 #include <selene/base/io/VectorWriter.hpp>
 
 #include <selene/img/common/BoundingBox.hpp>
@@ -25,6 +27,8 @@
 #include <selene/img/dynamic/DynImageView.hpp>
 #include <selene/img/dynamic/_impl/StaticChecks.hpp>
 
+#include <selene/img/typed/ImageView.hpp>
+
 #include <selene/img_io/_impl/Util.hpp>
 #include <selene/img_io/jpeg/Common.hpp>
 #include <selene/img_io/jpeg/_impl/Common.hpp>
@@ -32,6 +36,7 @@
 #include <array>
 #include <cstdio>
 #include <memory>
+#include <vector>
 
 namespace sln {
 
@@ -43,9 +48,13 @@ class JPEGCompressionObject;
 namespace impl {
 class JPEGCompressionCycle;
 void set_destination(JPEGCompressionObject&, FileWriter&);
+void set_destination(JPEGCompressionObject&, BufferedFileWriter&);
 void set_destination(JPEGCompressionObject&, VectorWriter&);
+void set_destination(JPEGCompressionObject&, MemoryWriter&);
 bool flush_data_buffer(JPEGCompressionObject&, FileWriter&);
+bool flush_data_buffer(JPEGCompressionObject&, BufferedFileWriter&);
 bool flush_data_buffer(JPEGCompressionObject&, VectorWriter&);
+bool flush_data_buffer(JPEGCompressionObject&, MemoryWriter&);
 }  // namespace impl
 
 /** \brief JPEG compression options.
@@ -98,6 +107,7 @@ public:
   [[nodiscard]] const MessageLog& message_log() const;
 
   bool set_image_info(int width, int height, int nr_channels, int nr_bytes_per_channel, JPEGColorSpace in_color_space);
+  bool set_raw_image_info(const std::vector<ConstantImageView<std::uint8_t>>& planes, JPEGColorSpace jpeg_color_space);
   bool set_compression_parameters(int quality,
                                   JPEGColorSpace color_space = JPEGColorSpace::Auto,
                                   bool optimize_coding = false);
@@ -111,15 +121,22 @@ private:
 
   friend class impl::JPEGCompressionCycle;
   friend void impl::set_destination(JPEGCompressionObject&, FileWriter&);
+  friend void impl::set_destination(JPEGCompressionObject&, BufferedFileWriter&);
   friend void impl::set_destination(JPEGCompressionObject&, VectorWriter&);
+  friend void impl::set_destination(JPEGCompressionObject&, MemoryWriter&);
   friend bool impl::flush_data_buffer(JPEGCompressionObject&, FileWriter&);
+  friend bool impl::flush_data_buffer(JPEGCompressionObject&, BufferedFileWriter&);
   friend bool impl::flush_data_buffer(JPEGCompressionObject&, VectorWriter&);
+  friend bool impl::flush_data_buffer(JPEGCompressionObject&, MemoryWriter&);
 };
 
 
 /** \brief Writes a JPEG image data stream, given the supplied uncompressed image data.
  *
- * @tparam SinkType Type of the output sink. Can be FileWriter or VectorWriter.
+ * The compressed data is written directly into the sink, without intermediate buffering. When writing to a
+ * MemoryWriter, the operation fails if the compressed data does not fit into the remaining memory region.
+ *
+ * @tparam SinkType Type of the output sink. Can be FileWriter, BufferedFileWriter, VectorWriter, or MemoryWriter.
  * @param img_data The image data to be written.
  * @param sink Output sink instance.
  * @param options The compression options.
@@ -136,7 +153,7 @@ bool write_jpeg(const DynImageOrView& dyn_img_or_view,
  *
  * This function overload enables re-use of a JPEGCompressionObject instance.
  *
- * @tparam SinkType Type of the output sink. Can be FileWriter or VectorWriter.
+ * @tparam SinkType Type of the output sink. Can be FileWriter, BufferedFileWriter, VectorWriter, or MemoryWriter.
  * @param img_data The image data to be written.
  * @param obj A JPEGCompressionObject instance.
  * @param sink Output sink instance.
@@ -151,6 +168,48 @@ bool write_jpeg(const DynImageOrView& dyn_img_or_view,
                 JPEGCompressionOptions options = JPEGCompressionOptions(),
                 MessageLog* messages = nullptr);
 
+/** \brief Writes a JPEG image data stream, given the supplied raw planar image data.
+ *
+ * This uses the "raw data" interface of libjpeg, i.e. no color conversion or chroma downsampling is performed.
+ * Each supplied plane represents one image component. The chroma subsampling factors are inferred from the plane
+ * extents; e.g. for 4:2:0 YCbCr data, the second and third plane have half the width and height of the first one.
+ *
+ * The color space of the supplied planes (and of the compressed data) is taken from `options.jpeg_color_space`. If
+ * this is `JPEGColorSpace::Auto`, it is chosen based on the number of planes (1: grayscale, 3: YCbCr, 4: CMYK).
+ * `options.in_color_space` is ignored.
+ *
+ * @tparam SinkType Type of the output sink. Can be FileWriter, BufferedFileWriter, VectorWriter, or MemoryWriter.
+ * @param planes The image planes to be written.
+ * @param sink Output sink instance.
+ * @param options The compression options.
+ * @param messages Optional pointer to the message log. If provided, warning and error messages will be output there.
+ * @return True, if the write operation was successful; false otherwise.
+ */
+template <typename SinkType>
+bool write_jpeg_planar(const std::vector<ConstantImageView<std::uint8_t>>& planes,
+                       SinkType&& sink,
+                       JPEGCompressionOptions options = JPEGCompressionOptions(),
+                       MessageLog* messages = nullptr);
+
+/** \brief Writes a JPEG image data stream, given the supplied raw planar image data.
+ *
+ * This function overload enables re-use of a JPEGCompressionObject instance.
+ *
+ * @tparam SinkType Type of the output sink. Can be FileWriter, BufferedFileWriter, VectorWriter, or MemoryWriter.
+ * @param planes The image planes to be written.
+ * @param obj A JPEGCompressionObject instance.
+ * @param sink Output sink instance.
+ * @param options The compression options.
+ * @param messages Optional pointer to the message log. If provided, warning and error messages will be output there.
+ * @return True, if the write operation was successful; false otherwise.
+ */
+template <typename SinkType>
+bool write_jpeg_planar(const std::vector<ConstantImageView<std::uint8_t>>& planes,
+                       JPEGCompressionObject& obj,
+                       SinkType&& sink,
+                       JPEGCompressionOptions options = JPEGCompressionOptions(),
+                       MessageLog* messages = nullptr);
+
 /// @}
 
 // ----------
@@ -171,9 +230,11 @@ public:
   ~JPEGCompressionCycle();
 
   void compress(const ConstRowPointers& row_pointers);
+  void compress_raw(const std::vector<ConstantImageView<std::uint8_t>>& planes);
 
 private:
   JPEGCompressionObject& obj_;
+  bool aborted_ = false;
 };
 
 }  // namespace impl
@@ -252,6 +313,67 @@ bool write_jpeg(const DynImageOrView& dyn_img_or_view,
   return !obj.error_state();
 }
 
+template <typename SinkType>
+bool write_jpeg_planar(const std::vector<ConstantImageView<std::uint8_t>>& planes,
+                       SinkType&& sink,
+                       JPEGCompressionOptions options,
+                       MessageLog* messages)
+{
+  JPEGCompressionObject obj;
+  SELENE_ASSERT(obj.valid());
+  return write_jpeg_planar(planes, obj, std::forward<SinkType>(sink), options, messages);
+}
+
+template <typename SinkType>
+bool write_jpeg_planar(const std::vector<ConstantImageView<std::uint8_t>>& planes,
+                       JPEGCompressionObject& obj,
+                       SinkType&& sink,
+                       JPEGCompressionOptions options,
+                       MessageLog* messages)
+{
+  impl::set_destination(obj, sink);
+
+  if (obj.error_state())
+  {
+    impl::assign_message_log(obj, messages);
+    return false;
+  }
+
+  const auto img_info_set = obj.set_raw_image_info(planes, options.jpeg_color_space);
+
+  if (!img_info_set)
+  {
+    impl::assign_message_log(obj, messages);
+    return false;
+  }
+
+  // The color space has already been set; setting it again would reset the sampling factors.
+  const bool pars_set = obj.set_compression_parameters(options.quality, JPEGColorSpace::Auto,
+                                                       options.optimize_coding);
+
+  if (!pars_set)
+  {
+    impl::assign_message_log(obj, messages);
+    return false;
+  }
+
+  {
+    impl::JPEGCompressionCycle cycle(obj);
+    cycle.compress_raw(planes);
+    // Destructor of JPEGCompressionCycle calls jpeg_finish_compress(), which updates internal state
+  }
+
+  bool flushed = impl::flush_data_buffer(obj, sink);
+  if (!flushed)
+  {
+    impl::assign_message_log(obj, messages);
+    return false;
+  }
+
+  impl::assign_message_log(obj, messages);
+  return !obj.error_state();
+}
+
 }  // namespace sln
 
 #endif  // defined(SELENE_WITH_LIBJPEG)
@@ -64,6 +64,17 @@ JPEGColorSpace color_space_lib_to_pub(J_COLOR_SPACE color_space)
   }
 }
 
+J_DCT_METHOD dct_method_pub_to_lib(JPEGDCTMethod dct_method)
+{
+  switch (dct_method)
+  {
+    case JPEGDCTMethod::IntegerSlow: return JDCT_ISLOW;
+    case JPEGDCTMethod::IntegerFast: return JDCT_IFAST;
+    case JPEGDCTMethod::Float: return JDCT_FLOAT;
+    default: return JDCT_DEFAULT;
+  }
+}
+
 void error_exit(j_common_ptr cinfo)
 {
   auto& err_man = *reinterpret_cast<JPEGErrorManager*>(cinfo->err);
@@ -24,6 +24,7 @@ namespace sln::impl {
 
 J_COLOR_SPACE color_space_pub_to_lib(JPEGColorSpace color_space);
 JPEGColorSpace color_space_lib_to_pub(J_COLOR_SPACE color_space);
+J_DCT_METHOD dct_method_pub_to_lib(JPEGDCTMethod dct_method);
 
 // Error handling structures
 
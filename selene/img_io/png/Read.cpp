@@ -47,60 +47,25 @@ bool PNGImageInfo::is_valid() const
 
 /// \cond INTERNAL
 
-struct PNGDecompressionObject::Impl
-{
-  png_structp png_ptr = nullptr;
-  png_infop info_ptr = nullptr;
-  png_infop end_info = nullptr;
-  impl::PNGErrorManager error_manager;
-  PixelFormat pixel_format_ = PixelFormat::Unknown;
-  bool valid = false;
-  bool needs_reset = false;
-};
-
-PNGDecompressionObject::PNGDecompressionObject() : impl_(std::make_unique<PNGDecompressionObject::Impl>())
-{
-  allocate();
-}
-
-PNGDecompressionObject::~PNGDecompressionObject()
-{
-  deallocate();
-}
-
-bool PNGDecompressionObject::valid() const
-{
-  return impl_->valid;
-}
-
-bool PNGDecompressionObject::error_state() const
-{
-  return impl_->error_manager.error_state;
-}
-
-MessageLog& PNGDecompressionObject::message_log()
-{
-  return impl_->error_manager.message_log;
-}
-
-const MessageLog& PNGDecompressionObject::message_log() const
+namespace {
+
+/// Sets up the libpng input transformations according to the decompression options, and determines the resulting
+/// pixel format. Errors are signaled via longjmp(), i.e. the caller has to have established a jump buffer.
+void set_input_transformations(png_structp png_ptr,
+                               png_infop info_ptr,
+                               const PNGDecompressionOptions& options,
+                               PixelFormat& pixel_format)
 {
-  return impl_->error_manager.message_log;
-}
-
-bool PNGDecompressionObject::set_decompression_parameters(bool force_bit_depth_8,
-                                                          bool set_background,
-                                                          bool strip_alpha_channel,
-                                                          bool swap_alpha_channel,
-                                                          bool set_bgr,
-                                                          bool invert_alpha_channel,
-                                                          bool invert_monochrome,
-                                                          bool convert_gray_to_rgb,
-                                                          bool convert_rgb_to_gray,
-                                                          bool keep_big_endian)
-{
-  auto png_ptr = impl_->png_ptr;
-  auto info_ptr = impl_->info_ptr;
+  const bool force_bit_depth_8 = options.force_bit_depth_8;
+  const bool set_background = options.set_background;
+  const bool strip_alpha_channel = options.strip_alpha_channel;
+  const bool swap_alpha_channel = options.swap_alpha_channel;
+  const bool set_bgr = options.set_bgr;
+  const bool invert_alpha_channel = options.invert_alpha_channel;
+  const bool invert_monochrome = options.invert_monochrome;
+  const bool convert_gray_to_rgb = options.convert_gray_to_rgb;
+  const bool convert_rgb_to_gray = options.convert_rgb_to_gray;
+  const bool keep_big_endian = options.keep_big_endian;
 
   png_uint_32 width = 0;
   png_uint_32 height = 0;
@@ -110,22 +75,12 @@ bool PNGDecompressionObject::set_decompression_parameters(bool force_bit_depth_8
   int compression_method = 0;
   int filter_method = 0;
 
-  // png_byte nr_channels = 0;
-  // png_size_t rowbytes = 0;
-  // png_const_bytep signature = 0;
-
 #if (defined LIBPNG16_AND_UP)
   double screen_gamma = PNG_DEFAULT_sRGB;  // TODO: Or supply user-defined value.
 #else
   double screen_gamma = 2.2;
 #endif
 
-  // Unfortunately, no more variable initializations after this line:
-  if (setjmp(png_jmpbuf(png_ptr)))
-  {
-    goto failure_state;
-  }
-
   png_set_compression_buffer_size(png_ptr, 4 * 8192);  // Default is 8192
   // png_set_crc_action(png_ptr, crit_action, ancil_action);
   // TODO: Set up callback for unknown chunks? See line 492 in manual
@@ -152,11 +107,11 @@ bool PNGDecompressionObject::set_decompression_parameters(bool force_bit_depth_8
 
   switch (color_type)
   {
-    case PNG_COLOR_TYPE_GRAY: impl_->pixel_format_ = PixelFormat::Y; break;
-    case PNG_COLOR_TYPE_GRAY_ALPHA: impl_->pixel_format_ = PixelFormat::YA; break;
-    case PNG_COLOR_TYPE_RGB: impl_->pixel_format_ = PixelFormat::RGB; break;
-    case PNG_COLOR_TYPE_RGBA: impl_->pixel_format_ = PixelFormat::RGBA; break;
-    default: impl_->pixel_format_ = PixelFormat::Unknown; break;
+    case PNG_COLOR_TYPE_GRAY: pixel_format = PixelFormat::Y; break;
+    case PNG_COLOR_TYPE_GRAY_ALPHA: pixel_format = PixelFormat::YA; break;
+    case PNG_COLOR_TYPE_RGB: pixel_format = PixelFormat::RGB; break;
+    case PNG_COLOR_TYPE_RGBA: pixel_format = PixelFormat::RGBA; break;
+    default: pixel_format = PixelFormat::Unknown; break;
   }
 
   // - Strip the alpha channel, if desired
@@ -164,13 +119,13 @@ bool PNGDecompressionObject::set_decompression_parameters(bool force_bit_depth_8
   {
     png_set_strip_alpha(png_ptr);
 
-    if (impl_->pixel_format_ == PixelFormat::YA)
+    if (pixel_format == PixelFormat::YA)
     {
-      impl_->pixel_format_ = PixelFormat::Y;
+      pixel_format = PixelFormat::Y;
     }
-    else if (impl_->pixel_format_ == PixelFormat::RGBA)
+    else if (pixel_format == PixelFormat::RGBA)
     {
-      impl_->pixel_format_ = PixelFormat::RGB;
+      pixel_format = PixelFormat::RGB;
     }
   }
 
@@ -178,7 +133,7 @@ bool PNGDecompressionObject::set_decompression_parameters(bool force_bit_depth_8
   if (color_type == PNG_COLOR_TYPE_PALETTE)
   {
     png_set_palette_to_rgb(png_ptr);
-    impl_->pixel_format_ = PixelFormat::RGB;
+    pixel_format = PixelFormat::RGB;
   }
 
   // - Expand bit depths < 8 bits to 8 bits
@@ -193,13 +148,13 @@ bool PNGDecompressionObject::set_decompression_parameters(bool force_bit_depth_8
   {
     png_set_tRNS_to_alpha(png_ptr);
 
-    if (impl_->pixel_format_ == PixelFormat::Y)
+    if (pixel_format == PixelFormat::Y)
     {
-      impl_->pixel_format_ = PixelFormat::YA;
+      pixel_format = PixelFormat::YA;
     }
-    else if (impl_->pixel_format_ == PixelFormat::RGB)
+    else if (pixel_format == PixelFormat::RGB)
     {
-      impl_->pixel_format_ = PixelFormat::RGBA;
+      pixel_format = PixelFormat::RGBA;
     }
   }
 
@@ -252,13 +207,13 @@ bool PNGDecompressionObject::set_decompression_parameters(bool force_bit_depth_8
   {
     png_set_bgr(png_ptr);
 
-    if (impl_->pixel_format_ == PixelFormat::RGB)
+    if (pixel_format == PixelFormat::RGB)
     {
-      impl_->pixel_format_ = PixelFormat::BGR;
+      pixel_format = PixelFormat::BGR;
     }
-    else if (impl_->pixel_format_ == PixelFormat::RGBA)
+    else if (pixel_format == PixelFormat::RGBA)
     {
-      impl_->pixel_format_ = PixelFormat::BGRA;
+      pixel_format = PixelFormat::BGRA;
     }
   }
 
@@ -266,13 +221,13 @@ bool PNGDecompressionObject::set_decompression_parameters(bool force_bit_depth_8
   {
     png_set_swap_alpha(png_ptr);
 
-    if (impl_->pixel_format_ == PixelFormat::RGBA)
+    if (pixel_format == PixelFormat::RGBA)
     {
-      impl_->pixel_format_ = PixelFormat::ARGB;
+      pixel_format = PixelFormat::ARGB;
     }
-    else if (impl_->pixel_format_ == PixelFormat::BGRA)
+    else if (pixel_format == PixelFormat::BGRA)
     {
-      impl_->pixel_format_ = PixelFormat::ABGR;
+      pixel_format = PixelFormat::ABGR;
     }
   }
 
@@ -280,13 +235,13 @@ bool PNGDecompressionObject::set_decompression_parameters(bool force_bit_depth_8
   {
     png_set_gray_to_rgb(png_ptr);
 
-    if (impl_->pixel_format_ == PixelFormat::Y)
+    if (pixel_format == PixelFormat::Y)
     {
-      impl_->pixel_format_ = PixelFormat::RGB;
+      pixel_format = PixelFormat::RGB;
     }
-    else if (impl_->pixel_format_ == PixelFormat::YA)
+    else if (pixel_format == PixelFormat::YA)
     {
-      impl_->pixel_format_ = PixelFormat::RGBA;
+      pixel_format = PixelFormat::RGBA;
     }
   }
 
@@ -302,13 +257,13 @@ bool PNGDecompressionObject::set_decompression_parameters(bool force_bit_depth_8
     png_set_rgb_to_gray(png_ptr, error_action, -1, -1);
 #endif
 
-    if (impl_->pixel_format_ == PixelFormat::RGB)
+    if (pixel_format == PixelFormat::RGB)
     {
-      impl_->pixel_format_ = PixelFormat::Y;
+      pixel_format = PixelFormat::Y;
     }
-    else if (impl_->pixel_format_ == PixelFormat::RGBA)
+    else if (pixel_format == PixelFormat::RGBA)
     {
-      impl_->pixel_format_ = PixelFormat::YA;
+      pixel_format = PixelFormat::YA;
     }
   }
 
@@ -319,10 +274,75 @@ bool PNGDecompressionObject::set_decompression_parameters(bool force_bit_depth_8
 
   png_set_interlace_handling(png_ptr);
 
-  return true;
+}
 
-  failure_state:
-  return false;
+}  // namespace
+
+
+struct PNGDecompressionObject::Impl
+{
+  png_structp png_ptr = nullptr;
+  png_infop info_ptr = nullptr;
+  png_infop end_info = nullptr;
+  impl::PNGErrorManager error_manager;
+  PixelFormat pixel_format_ = PixelFormat::Unknown;
+  bool valid = false;
+  bool needs_reset = false;
+  bool header_read = false;
+};
+
+PNGDecompressionObject::PNGDecompressionObject() : impl_(std::make_unique<PNGDecompressionObject::Impl>())
+{
+  allocate();
+}
+
+PNGDecompressionObject::~PNGDecompressionObject()
+{
+  deallocate();
+}
+
+bool PNGDecompressionObject::valid() const
+{
+  return impl_->valid;
+}
+
+bool PNGDecompressionObject::error_state() const
+{
+  return impl_->error_manager.error_state;
+}
+
+MessageLog& PNGDecompressionObject::message_log()
+{
+  return impl_->error_manager.message_log;
+}
+
+const MessageLog& PNGDecompressionObject::message_log() const
+{
+  return impl_->error_manager.message_log;
+}
+
+bool PNGDecompressionObject::set_decompression_parameters(bool force_bit_depth_8,
+                                                          bool set_background,
+                                                          bool strip_alpha_channel,
+                                                          bool swap_alpha_channel,
+                                                          bool set_bgr,
+                                                          bool invert_alpha_channel,
+                                                          bool invert_monochrome,
+                                                          bool convert_gray_to_rgb,
+                                                          bool convert_rgb_to_gray,
+                                                          bool keep_big_endian)
+{
+  const PNGDecompressionOptions options(force_bit_depth_8, set_background, strip_alpha_channel, swap_alpha_channel,
+                                        set_bgr, invert_alpha_channel, invert_monochrome, convert_gray_to_rgb,
+                                        convert_rgb_to_gray, keep_big_endian);
+
+  if (setjmp(png_jmpbuf(impl_->png_ptr)))
+  {
+    return false;
+  }
+
+  set_input_transformations(impl_->png_ptr, impl_->info_ptr, options, impl_->pixel_format_);
+  return true;
 }
 
 PixelFormat PNGDecompressionObject::get_pixel_format() const
@@ -383,6 +403,7 @@ void PNGDecompressionObject::deallocate()
   impl_->error_manager = impl::PNGErrorManager();
   impl_->pixel_format_ = PixelFormat::Unknown;
   impl_->valid = false;
+  impl_->header_read = false;
 }
 
 void PNGDecompressionObject::reset_if_needed()
@@ -451,6 +472,11 @@ PNGImageInfo PNGDecompressionCycle::get_output_info() const
   return PNGImageInfo{width, height, nr_channels, bit_depth};
 }
 
+bool PNGDecompressionCycle::is_interlaced() const
+{
+  return png_get_interlace_type(obj_.impl_->png_ptr, obj_.impl_->info_ptr) != PNG_INTERLACE_NONE;
+}
+
 bool PNGDecompressionCycle::decompress(RowPointers& row_pointers)
 {
   auto png_ptr = obj_.impl_->png_ptr;
@@ -474,6 +500,69 @@ failure_state:
   return false;
 }
 
+bool PNGDecompressionCycle::decompress_rows(RowPointers& row_pointers)
+{
+  SELENE_ASSERT(!is_interlaced());
+  auto png_ptr = obj_.impl_->png_ptr;
+
+  if (setjmp(png_jmpbuf(png_ptr)))
+  {
+    goto failure_state;
+  }
+
+  // Read the next rows of a non-interlaced PNG image
+  png_read_rows(png_ptr, row_pointers.data(), nullptr, static_cast<png_uint_32>(row_pointers.size()));
+
+  return true;
+
+failure_state:
+  return false;
+}
+
+bool PNGDecompressionCycle::finish_decompression()
+{
+  auto png_ptr = obj_.impl_->png_ptr;
+  auto end_info = obj_.impl_->end_info;
+
+  if (setjmp(png_jmpbuf(png_ptr)))
+  {
+    goto failure_state;
+  }
+
+  png_read_end(png_ptr, end_info);
+
+  return true;
+
+failure_state:
+  return false;
+}
+
+// ------------------------------------------
+// Progressive decompression related functions
+
+struct PNGProgressiveCallbacks
+{
+  static PNGProgressiveReader* reader(png_structp png_ptr)
+  {
+    return static_cast<PNGProgressiveReader*>(png_get_progressive_ptr(png_ptr));
+  }
+
+  static void info_callback(png_structp png_ptr, png_infop /*info_ptr*/)
+  {
+    reader(png_ptr)->on_header_decoded();
+  }
+
+  static void row_callback(png_structp png_ptr, png_bytep new_row, png_uint_32 row_num, int /*pass*/)
+  {
+    reader(png_ptr)->on_row_decoded(new_row, row_num);
+  }
+
+  static void end_callback(png_structp png_ptr, png_infop /*info_ptr*/)
+  {
+    reader(png_ptr)->on_end_decoded();
+  }
+};
+
 // -------------------------------
 // Decompression related functions
 
@@ -498,8 +587,28 @@ void user_read_data(png_structp png_ptr, png_bytep data, png_size_t length)
   SELENE_FORCED_ASSERT(nr_bytes_read == length);
 }
 
+void user_read_data_async(png_structp png_ptr, png_bytep data, png_size_t length)
+{
+  void* io_ptr = png_get_io_ptr(png_ptr);
+
+  if (io_ptr == nullptr)
+  {
+    impl::error_handler(png_ptr, "[selene] png_get_io_ptr() failed");
+  }
+
+  auto reader = static_cast<AsyncFileReader*>(io_ptr);
+  SELENE_ASSERT(reader);
+
+  if (read(*reader, data, length) != length)
+  {
+    impl::error_handler(png_ptr, "[selene] access in user_read_data_async() out of bounds");
+  }
+}
+
 void set_source(PNGDecompressionObject& obj, FileReader& source)
 {
+  // A new stream requires fresh libpng structures, also if only the header of the previous one has been read
+  obj.impl_->needs_reset = obj.impl_->needs_reset || obj.impl_->header_read;
   obj.reset_if_needed();
 
   if (setjmp(png_jmpbuf(obj.impl_->png_ptr)))
@@ -514,6 +623,7 @@ failure_state:;
 
 void set_source(PNGDecompressionObject& obj, MemoryReader& source)
 {
+  obj.impl_->needs_reset = obj.impl_->needs_reset || obj.impl_->header_read;
   obj.reset_if_needed();
 
   if (setjmp(png_jmpbuf(obj.impl_->png_ptr)))
@@ -526,6 +636,26 @@ void set_source(PNGDecompressionObject& obj, MemoryReader& source)
 failure_state:;
 }
 
+void set_source(PNGDecompressionObject& obj, MmapReader& source)
+{
+  set_source(obj, source.memory_reader());
+}
+
+void set_source(PNGDecompressionObject& obj, AsyncFileReader& source)
+{
+  obj.impl_->needs_reset = obj.impl_->needs_reset || obj.impl_->header_read;
+  obj.reset_if_needed();
+
+  if (setjmp(png_jmpbuf(obj.impl_->png_ptr)))
+  {
+    goto failure_state;
+  }
+
+  png_set_read_fn(obj.impl_->png_ptr, static_cast<png_voidp>(&source), user_read_data_async);
+
+failure_state:;
+}
+
 PNGImageInfo read_header_info(PNGDecompressionObject& obj, const std::array<std::uint8_t, 8>& header_bytes, bool eof)
 {
   obj.reset_if_needed();
@@ -565,6 +695,7 @@ PNGImageInfo read_header_info(PNGDecompressionObject& obj, const std::array<std:
   height = to_pixel_length(png_get_image_height(png_ptr, info_ptr));
   bit_depth = static_cast<std::int16_t>(png_get_bit_depth(png_ptr, info_ptr));
   nr_channels = static_cast<std::int16_t>(png_get_channels(png_ptr, info_ptr));
+  obj.impl_->header_read = true;
 
   return PNGImageInfo(width, height, nr_channels, bit_depth);
 
@@ -591,10 +722,204 @@ PNGImageInfo read_header(MemoryReader& source, PNGDecompressionObject& obj)
   return read_header_info(obj, header_bytes, source.is_eof());
 }
 
+PNGImageInfo read_header(MmapReader& source, PNGDecompressionObject& obj)
+{
+  return read_header(source.memory_reader(), obj);
+}
+
+PNGImageInfo read_header(AsyncFileReader& source, PNGDecompressionObject& obj)
+{
+  // Check if the file is a PNG file (look at first 8 bytes)
+  std::array<std::uint8_t, 8> header_bytes = {0, 0, 0, 0, 0, 0, 0, 0};
+  source.template read<std::uint8_t>(header_bytes.data(), 8);
+
+  return read_header_info(obj, header_bytes, source.is_eof());
+}
+
 }  // namespace impl
 
 /// \endcond
 
+/** \brief Constructor.
+ *
+ * @param row_function The function to be called for each decompressed row.
+ * @param options The decompression options.
+ */
+PNGProgressiveReader::PNGProgressiveReader(RowFunction row_function, PNGDecompressionOptions options)
+    : options_(options), row_function_(std::move(row_function))
+{
+  if (!obj_.valid())
+  {
+    failed_ = true;
+    return;
+  }
+
+  auto png_ptr = obj_.impl_->png_ptr;
+
+  if (setjmp(png_jmpbuf(png_ptr)))
+  {
+    failed_ = true;
+    return;
+  }
+
+  png_set_progressive_read_fn(png_ptr, static_cast<png_voidp>(this), impl::PNGProgressiveCallbacks::info_callback,
+                              impl::PNGProgressiveCallbacks::row_callback,
+                              impl::PNGProgressiveCallbacks::end_callback);
+}
+
+/** \brief Pushes the next chunk of PNG data to the reader.
+ *
+ * Rows that can be decompressed from the data pushed so far are passed to the row function before this function
+ * returns.
+ *
+ * @param data Pointer to the chunk of PNG data.
+ * @param len Length of the chunk in bytes.
+ * @return True, if the data was successfully processed; false otherwise. After an error occurred, all subsequent
+ * calls will return false.
+ */
+bool PNGProgressiveReader::push(const std::uint8_t* data, std::size_t len)
+{
+  if (failed_)
+  {
+    return false;
+  }
+
+  if (finished_ || len == 0)
+  {
+    return true;
+  }
+
+  auto png_ptr = obj_.impl_->png_ptr;
+  auto info_ptr = obj_.impl_->info_ptr;
+
+  if (setjmp(png_jmpbuf(png_ptr)))
+  {
+    failed_ = true;
+    return false;
+  }
+
+  // libpng does not modify the input data, but png_process_data() is not const correct
+  png_process_data(png_ptr, info_ptr, const_cast<png_bytep>(data), len);
+
+  return !failed_;
+}
+
+/** \brief Returns whether an error occurred during decompression.
+ *
+ * @return True, if an error occurred; false otherwise.
+ */
+bool PNGProgressiveReader::error_state() const
+{
+  return failed_;
+}
+
+/** \brief Returns whether the PNG header has been decoded.
+ *
+ * @return True, if the header has been decoded; false otherwise.
+ */
+bool PNGProgressiveReader::header_decoded() const
+{
+  return output_info_.has_value();
+}
+
+/** \brief Returns whether the complete PNG image has been decoded, i.e. all rows have been passed on.
+ *
+ * @return True, if the image has been decoded completely; false otherwise.
+ */
+bool PNGProgressiveReader::finished() const
+{
+  return finished_;
+}
+
+/** \brief Returns the output image information (i.e. after applying the decompression options).
+ *
+ * @return The output image information; invalid, if the header has not been decoded yet.
+ */
+PNGImageInfo PNGProgressiveReader::get_output_image_info() const
+{
+  return output_info_.value_or(PNGImageInfo());
+}
+
+/** \brief Returns the pixel format of the output image.
+ *
+ * @return The output pixel format; `PixelFormat::Unknown`, if the header has not been decoded yet.
+ */
+PixelFormat PNGProgressiveReader::get_pixel_format() const
+{
+  return output_info_ ? obj_.get_pixel_format() : PixelFormat::Unknown;
+}
+
+/** \brief Returns the message log, containing warning and error messages that occurred during decompression.
+ *
+ * @return The message log.
+ */
+MessageLog& PNGProgressiveReader::message_log()
+{
+  return obj_.message_log();
+}
+
+void PNGProgressiveReader::on_header_decoded()
+{
+  // Called by libpng from within png_process_data(), i.e. the jump buffer set up in push() is active.
+  auto png_ptr = obj_.impl_->png_ptr;
+  auto info_ptr = obj_.impl_->info_ptr;
+
+  set_input_transformations(png_ptr, info_ptr, options_, obj_.impl_->pixel_format_);
+  png_read_update_info(png_ptr, info_ptr);
+
+  const auto bit_depth = static_cast<std::int16_t>(png_get_bit_depth(png_ptr, info_ptr));
+
+  if (bit_depth != 8 && bit_depth != 16)  // bit depths 1, 2, 4 should be already converted
+  {
+    png_error(png_ptr, "[selene] Unsupported output bit depth");
+  }
+
+  const auto width = to_pixel_length(png_get_image_width(png_ptr, info_ptr));
+  const auto height = to_pixel_length(png_get_image_height(png_ptr, info_ptr));
+  const auto nr_channels = static_cast<std::int16_t>(png_get_channels(png_ptr, info_ptr));
+  output_info_.emplace(width, height, nr_channels, bit_depth);
+
+  row_bytes_ = static_cast<std::size_t>(png_get_rowbytes(png_ptr, info_ptr));
+  interlaced_ = png_get_interlace_type(png_ptr, info_ptr) != PNG_INTERLACE_NONE;
+
+  if (interlaced_)
+  {
+    interlaced_rows_.assign(row_bytes_ * static_cast<std::size_t>(height), std::uint8_t{0});
+  }
+}
+
+void PNGProgressiveReader::on_row_decoded(std::uint8_t* row_data, std::uint32_t row_index)
+{
+  if (row_data == nullptr)  // no change to this row in the current pass
+  {
+    return;
+  }
+
+  if (!interlaced_)
+  {
+    row_function_(to_pixel_index(row_index), row_data);
+    return;
+  }
+
+  png_progressive_combine_row(obj_.impl_->png_ptr, interlaced_rows_.data() + row_index * row_bytes_, row_data);
+}
+
+void PNGProgressiveReader::on_end_decoded()
+{
+  if (interlaced_)
+  {
+    const auto height = static_cast<std::size_t>(output_info_->height);
+    for (std::size_t y = 0; y < height; ++y)
+    {
+      row_function_(to_pixel_index(static_cast<std::ptrdiff_t>(y)), interlaced_rows_.data() + y * row_bytes_);
+    }
+
+    interlaced_rows_ = std::vector<std::uint8_t>();
+  }
+
+  finished_ = true;
+}
+
 }  // namespace sln
 
 #endif  // defined(SELENE_WITH_LIBPNG)
@@ -15,8 +15,10 @@
 #include <selene/base/MessageLog.hpp>
 #include <selene/base/Utils.hpp>
 
+#include <selene/base/io/AsyncFileReader.hpp>
 #include <selene/base/io/FileReader.hpp>
 #include <selene/base/io/MemoryReader.hpp>
+#include <selene/base/io/MmapReader.hpp>
 
 #include <selene/img/common/BoundingBox.hpp>
 #include <selene/img/common/PixelFormat.hpp>
@@ -29,9 +31,13 @@
 
 #include <selene/img_io/_impl/Util.hpp>
 
+#include <algorithm>
 #include <array>
 #include <cstdio>
+#include <functional>
 #include <memory>
+#include <optional>
+#include <vector>
 
 namespace sln {
 
@@ -41,14 +47,20 @@ namespace sln {
 class PNGImageInfo;
 struct PNGDecompressionOptions;
 class PNGDecompressionObject;
+class PNGProgressiveReader;
 
 namespace impl {
 class PNGDecompressionCycle;
+struct PNGProgressiveCallbacks;
 void set_source(PNGDecompressionObject&, FileReader&);
 void set_source(PNGDecompressionObject&, MemoryReader&);
+void set_source(PNGDecompressionObject&, MmapReader&);
+void set_source(PNGDecompressionObject&, AsyncFileReader&);
 PNGImageInfo read_header_info(PNGDecompressionObject&, const std::array<std::uint8_t, 8>&, bool);
 PNGImageInfo read_header(FileReader&, PNGDecompressionObject&);
 PNGImageInfo read_header(MemoryReader&, PNGDecompressionObject&);
+PNGImageInfo read_header(MmapReader&, PNGDecompressionObject&);
+PNGImageInfo read_header(AsyncFileReader&, PNGDecompressionObject&);
 }  // namespace impl
 
 /** \brief PNG image information, containing the image size, the number of channels, and the bit depth.
@@ -160,14 +172,16 @@ private:
   void reset_if_needed();
 
   friend class impl::PNGDecompressionCycle;
+  friend class PNGProgressiveReader;
   friend void impl::set_source(PNGDecompressionObject&, FileReader&);
   friend void impl::set_source(PNGDecompressionObject&, MemoryReader&);
+  friend void impl::set_source(PNGDecompressionObject&, AsyncFileReader&);
   friend PNGImageInfo impl::read_header_info(PNGDecompressionObject&, const std::array<std::uint8_t, 8>&, bool);
 };
 
 /** \brief Reads header of PNG image data stream.
  *
- * @tparam SourceType Type of the input source. Can be FileReader or MemoryReader.
+ * @tparam SourceType Type of the input source. Can be FileReader, MemoryReader, MmapReader, or AsyncFileReader.
  * @param source Input source instance.
  * @param rewind If true, the source position will be re-set to the original position after reading the header.
  * @param messages Optional pointer to the message log. If provided, warning and error messages will be output there.
@@ -180,7 +194,7 @@ PNGImageInfo read_png_header(SourceType&& source, bool rewind = false, MessageLo
  *
  * This function overload enables re-use of a PNGDecompressionObject instance.
  *
- * @tparam SourceType Type of the input source. Can be FileReader or MemoryReader.
+ * @tparam SourceType Type of the input source. Can be FileReader, MemoryReader, MmapReader, or AsyncFileReader.
  * @param obj A PNGDecompressionObject instance.
  * @param source Input source instance.
  * @param rewind If true, the source position will be re-set to the original position after reading the header.
@@ -198,7 +212,7 @@ PNGImageInfo read_png_header(PNGDecompressionObject& obj,
  * The source position must be set to the beginning of the PNG stream, including header. In case img::read_png_header
  * is called before, then it must be with `rewind == true`.
  *
- * @tparam SourceType Type of the input source. Can be FileReader or MemoryReader.
+ * @tparam SourceType Type of the input source. Can be FileReader, MemoryReader, MmapReader, or AsyncFileReader.
  * @param source Input source instance.
  * @param options The decompression options.
  * @param messages Optional pointer to the message log. If provided, warning and error messages will be output there.
@@ -218,7 +232,7 @@ DynImage<Allocator> read_png(SourceType&& source,
  *
  * This function overload enables re-use of a PNGDecompressionObject instance.
  *
- * @tparam SourceType Type of the input source. Can be FileReader or MemoryReader.
+ * @tparam SourceType Type of the input source. Can be FileReader, MemoryReader, MmapReader, or AsyncFileReader.
  * @param obj A PNGDecompressionObject instance.
  * @param source Input source instance.
  * @param options The decompression options.
@@ -243,6 +257,9 @@ DynImage<Allocator> read_png(PNGDecompressionObject& obj,
  * `DynImage` instance (or by providing a `DynImageView` into pre-allocated memory), and finally calling
  * `read_image_data(DynImage&)` or `read_image_data(MutableDynImageView&)`.
  *
+ * Alternatively, `read_image_rows()` passes the decompressed rows to a user-provided function as soon as they are
+ * decoded, without ever holding the whole image in memory (for non-interlaced images).
+ *
  * A PNGReader<> instance is stateful:
  * Calling of `read_header()`, `set_decompression_options()`, or `get_output_image_info()` is optional.
  * The only required function to be called in order to read the image data is `read_image_data()`.
@@ -251,7 +268,7 @@ DynImage<Allocator> read_png(PNGDecompressionObject& obj,
  * The source may optionally be re-set using `set_source()`; this is required if the previous image has not been read
  * completely or successfully.
  *
- * @tparam SourceType Type of the input source. Can be FileReader or MemoryReader.
+ * @tparam SourceType Type of the input source. Can be FileReader, MemoryReader, MmapReader, or AsyncFileReader.
  */
 template <typename SourceType>
 class PNGReader
@@ -268,6 +285,7 @@ public:
   PNGImageInfo get_output_image_info();
   template <typename Allocator = default_bytes_allocator> DynImage<Allocator> read_image_data();
   template <typename DynImageOrView> bool read_image_data(DynImageOrView& dyn_img_or_view);
+  template <typename RowFunction> bool read_image_rows(RowFunction&& row_function, PixelLength nr_rows_per_band = 16_px);
 
   MessageLog& message_log();
 
@@ -282,6 +300,63 @@ private:
   void reset();
 };
 
+/** \brief Progressive (push-based) PNG reader, for decoding PNG data that arrives in chunks.
+ *
+ * Unlike the other PNG reading functions, this class does not pull data from a source. Instead, arbitrarily sized
+ * chunks of the PNG stream are pushed via `push()`, e.g. as they arrive from a non-seekable network stream.
+ * Each decompressed row is passed to the row function as soon as it is available; the row function receives the row
+ * index and a pointer to the row data, which is only valid for the duration of the call.
+ *
+ * Output image information is available via `get_output_image_info()` once the header has been decoded, i.e. at the
+ * latest when the row function is called for the first time.
+ *
+ * For interlaced images, rows can only be passed on once the last pass has been decoded, i.e. after the end of the
+ * image data has been pushed. Rows are always passed on in increasing order.
+ *
+ * The row function must not throw exceptions.
+ */
+class PNGProgressiveReader
+{
+public:
+  using RowFunction = std::function<void(PixelIndex, const std::uint8_t*)>;
+
+  explicit PNGProgressiveReader(RowFunction row_function,
+                                PNGDecompressionOptions options = PNGDecompressionOptions());
+
+  // libpng holds a pointer to the instance, so it can be neither copied nor moved
+  PNGProgressiveReader(const PNGProgressiveReader&) = delete;
+  PNGProgressiveReader& operator=(const PNGProgressiveReader&) = delete;
+  PNGProgressiveReader(PNGProgressiveReader&&) = delete;
+  PNGProgressiveReader& operator=(PNGProgressiveReader&&) = delete;
+
+  bool push(const std::uint8_t* data, std::size_t len);
+
+  [[nodiscard]] bool error_state() const;
+  [[nodiscard]] bool header_decoded() const;
+  [[nodiscard]] bool finished() const;
+  [[nodiscard]] PNGImageInfo get_output_image_info() const;
+  [[nodiscard]] PixelFormat get_pixel_format() const;
+
+  MessageLog& message_log();
+
+private:
+  PNGDecompressionObject obj_;
+  PNGDecompressionOptions options_;
+  RowFunction row_function_;
+  std::optional<PNGImageInfo> output_info_;
+  std::vector<std::uint8_t> interlaced_rows_;
+  std::size_t row_bytes_ = 0;
+  bool interlaced_ = false;
+  bool finished_ = false;
+  bool failed_ = false;
+
+  void on_header_decoded();
+  void on_row_decoded(std::uint8_t* row_data, std::uint32_t row_index);
+  void on_end_decoded();
+
+  friend struct impl::PNGProgressiveCallbacks;
+};
+
 /// @}
 
 // ----------
@@ -303,7 +378,10 @@ public:
 
   [[nodiscard]] bool error_state() const;
   [[nodiscard]] PNGImageInfo get_output_info() const;
+  [[nodiscard]] bool is_interlaced() const;
   bool decompress(RowPointers& row_pointers);
+  bool decompress_rows(RowPointers& row_pointers);
+  bool finish_decompression();
 
 private:
   PNGDecompressionObject& obj_;
@@ -568,6 +646,92 @@ bool PNGReader<SourceType>::read_image_data(DynImageOrView& dyn_img_or_view)
   return dec_success;
 }
 
+/** \brief Reads the image data row by row, passing each decompressed row to the provided function.
+ *
+ * The row function is called with the row index (of type `PixelIndex`) and a pointer to the constant row data,
+ * which is laid out as given by `get_output_image_info()` and only valid for the duration of the call.
+ * Rows are passed in increasing order.
+ *
+ * For non-interlaced images, rows are decompressed in bands of `nr_rows_per_band` rows, which are passed on as soon as
+ * each band is decoded; memory usage is therefore independent of the image height. Interlaced images have to be
+ * decompressed in full before any row is final, so these are first read into a temporary image.
+ *
+ * @tparam RowFunction Type of the row function.
+ * @param row_function The row function, with signature `void(PixelIndex, const std::uint8_t*)`.
+ * @param nr_rows_per_band The number of rows to decompress in one go.
+ * @return True, if decompression was successful; false otherwise.
+ */
+template <typename SourceType>
+template <typename RowFunction>
+bool PNGReader<SourceType>::read_image_rows(RowFunction&& row_function, PixelLength nr_rows_per_band)
+{
+  const auto output_info = get_output_image_info();
+
+  if (!output_info.is_valid())
+  {
+    return false;
+  }
+
+  const auto row_bytes = static_cast<std::size_t>(output_info.width * output_info.nr_channels
+                                                  * output_info.nr_bytes_per_channel());
+  const auto height = static_cast<std::ptrdiff_t>(output_info.height);
+
+  auto call_row_function = [&row_function](const RowPointers& rows, std::ptrdiff_t first_row) {
+    for (std::size_t i = 0; i < rows.size(); ++i)
+    {
+      row_function(to_pixel_index(first_row + static_cast<std::ptrdiff_t>(i)),
+                   static_cast<const std::uint8_t*>(rows[i]));
+    }
+  };
+
+  if (cycle_->is_interlaced())
+  {
+    std::vector<std::uint8_t> buffer(row_bytes * static_cast<std::size_t>(height));
+    RowPointers row_pointers(static_cast<std::size_t>(height));
+    for (std::size_t y = 0; y < row_pointers.size(); ++y)
+    {
+      row_pointers[y] = buffer.data() + y * row_bytes;
+    }
+
+    const auto dec_success = cycle_->decompress(row_pointers);
+    reset();
+
+    if (dec_success)
+    {
+      call_row_function(row_pointers, 0);
+    }
+
+    return dec_success;
+  }
+
+  const auto band_height = std::clamp(static_cast<std::ptrdiff_t>(nr_rows_per_band), std::ptrdiff_t{1}, height);
+  std::vector<std::uint8_t> buffer(row_bytes * static_cast<std::size_t>(band_height));
+  RowPointers row_pointers;
+  row_pointers.reserve(static_cast<std::size_t>(band_height));
+
+  for (std::ptrdiff_t y = 0; y < height; y += band_height)
+  {
+    const auto nr_rows = std::min(band_height, height - y);
+    row_pointers.clear();
+    for (std::ptrdiff_t i = 0; i < nr_rows; ++i)
+    {
+      row_pointers.push_back(buffer.data() + static_cast<std::size_t>(i) * row_bytes);
+    }
+
+    if (!cycle_->decompress_rows(row_pointers))
+    {
+      reset();
+      return false;
+    }
+
+    call_row_function(row_pointers, y);
+  }
+
+  const auto fin_success = cycle_->finish_decompression();
+  reset();
+  return fin_success;
+}
+
 template <typename SourceType>
 MessageLog& PNGReader<SourceType>::message_log()
 {
@@ -7,17 +7,24 @@
 #if defined(SELENE_WITH_LIBPNG)
 
 #include <png.h>
+#include <zlib.h>
 
 #include <selene/base/Utils.hpp>
+#include <selene/base/_impl/ParallelFor.hpp>
 
 #include <selene/img_io/png/Write.hpp>
 #include <selene/img_io/png/_impl/Detail.hpp>
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <cstdint>
 #include <cstdio>
+#include <cstdlib>
+#include <limits>
 #include <stdexcept>
+#include <thread>
+#include <vector>
 
 namespace sln {
 
@@ -43,6 +50,234 @@ int determine_color_type(PixelFormat pixel_format)
   }
 }
 
+int determine_filters(PNGFilterSet filter_set)
+{
+  switch (filter_set)
+  {
+    case PNGFilterSet::None: return PNG_FILTER_NONE;
+    case PNGFilterSet::Sub: return PNG_FILTER_SUB;
+    case PNGFilterSet::Up: return PNG_FILTER_UP;
+    case PNGFilterSet::Average: return PNG_FILTER_AVG;
+    case PNGFilterSet::Paeth: return PNG_FILTER_PAETH;
+    case PNGFilterSet::Fast: return PNG_FILTER_NONE | PNG_FILTER_SUB | PNG_FILTER_UP;
+    case PNGFilterSet::Default:
+    case PNGFilterSet::All:
+    default: return PNG_ALL_FILTERS;
+  }
+}
+
+int determine_strategy(PNGCompressionStrategy strategy, int filters)
+{
+  switch (strategy)
+  {
+    case PNGCompressionStrategy::Standard: return Z_DEFAULT_STRATEGY;
+    case PNGCompressionStrategy::Filtered: return Z_FILTERED;
+    case PNGCompressionStrategy::HuffmanOnly: return Z_HUFFMAN_ONLY;
+    case PNGCompressionStrategy::RLE: return Z_RLE;
+    case PNGCompressionStrategy::Fixed: return Z_FIXED;
+    case PNGCompressionStrategy::Default:
+    default: return (filters == PNG_FILTER_NONE) ? Z_DEFAULT_STRATEGY : Z_FILTERED;  // mirrors libpng's choice
+  }
+}
+
+// ---------------------------------------------------------
+// Helper functions for parallel (band-wise) PNG compression
+
+// Amount of uncompressed image data per band. Bands are fixed by the image size only, so that the output does not
+// depend on the number of threads.
+constexpr std::size_t parallel_band_size = std::size_t{256} * 1024;
+
+constexpr std::size_t zlib_max_window_size = std::size_t{1} << 15;
+
+struct RowTransformations
+{
+  std::size_t nr_channels;
+  std::size_t nr_bytes_per_channel;
+  bool swap_red_blue;
+  bool invert_gray;
+  bool invert_alpha;
+  bool swap_bytes;
+};
+
+/// Applies the transformations that libpng would otherwise apply when writing a row (in place).
+void transform_row(const RowTransformations& tr, std::uint8_t* row, std::size_t row_bytes)
+{
+  const auto nr_bytes_per_pixel = tr.nr_channels * tr.nr_bytes_per_channel;
+  const auto bpc = tr.nr_bytes_per_channel;
+
+  if (tr.swap_red_blue || tr.invert_gray || tr.invert_alpha)
+  {
+    for (std::size_t i = 0; i < row_bytes; i += nr_bytes_per_pixel)
+    {
+      auto px = row + i;
+
+      if (tr.swap_red_blue)
+      {
+        std::swap_ranges(px, px + bpc, px + 2 * bpc);
+      }
+
+      if (tr.invert_gray)
+      {
+        std::transform(px, px + bpc, px, [](std::uint8_t v) { return static_cast<std::uint8_t>(~v); });
+      }
+
+      if (tr.invert_alpha)
+      {
+        auto alpha = px + (tr.nr_channels - 1) * bpc;
+        std::transform(alpha, alpha + bpc, alpha, [](std::uint8_t v) { return static_cast<std::uint8_t>(~v); });
+      }
+    }
+  }
+
+  if (tr.swap_bytes)
+  {
+    for (std::size_t i = 0; i + 1 < row_bytes; i += 2)
+    {
+      std::swap(row[i], row[i + 1]);
+    }
+  }
+}
+
+/// Filters one row with the specified filter type; writes the filter type byte, followed by the filtered row.
+/// Returns the sum of absolute (signed) values of the filtered bytes, as used by libpng for filter selection.
+std::size_t filter_row(int filter_type,
+                       const std::uint8_t* row,
+                       const std::uint8_t* prev_row,
+                       std::size_t row_bytes,
+                       std::size_t bpp,
+                       std::uint8_t* out)
+{
+  out[0] = static_cast<std::uint8_t>(filter_type);
+  auto dst = out + 1;
+  std::size_t sum = 0;
+
+  const auto left = [row, bpp](std::size_t i) -> int { return i >= bpp ? row[i - bpp] : 0; };
+  const auto up = [prev_row](std::size_t i) -> int { return prev_row ? prev_row[i] : 0; };
+  const auto up_left = [prev_row, bpp](std::size_t i) -> int { return (prev_row && i >= bpp) ? prev_row[i - bpp] : 0; };
+
+  for (std::size_t i = 0; i < row_bytes; ++i)
+  {
+    int predictor = 0;
+
+    switch (filter_type)
+    {
+      case 1: predictor = left(i); break;
+      case 2: predictor = up(i); break;
+      case 3: predictor = (left(i) + up(i)) / 2; break;
+      case 4:
+      {
+        const auto a = left(i);
+        const auto b = up(i);
+        const auto c = up_left(i);
+        const auto pa = std::abs(b - c);
+        const auto pb = std::abs(a - c);
+        const auto pc = std::abs(a + b - 2 * c);
+        predictor = (pa <= pb && pa <= pc) ? a : (pb <= pc ? b : c);
+        break;
+      }
+      default: break;
+    }
+
+    dst[i] = static_cast<std::uint8_t>(row[i] - predictor);
+    sum += static_cast<std::size_t>(std::abs(static_cast<int>(static_cast<std::int8_t>(dst[i]))));
+  }
+
+  return sum;
+}
+
+/// Filters one row, selecting the filter type with the minimum sum of absolute differences (if more than one).
+void filter_row_adaptive(int filters,
+                         const std::uint8_t* row,
+                         const std::uint8_t* prev_row,
+                         std::size_t row_bytes,
+                         std::size_t bpp,
+                         std::uint8_t* out,
+                         std::uint8_t* scratch)
+{
+  constexpr std::array<int, 5> filter_flags = {{PNG_FILTER_NONE, PNG_FILTER_SUB, PNG_FILTER_UP, PNG_FILTER_AVG,
+                                                PNG_FILTER_PAETH}};
+  auto best_sum = std::numeric_limits<std::size_t>::max();
+  auto best_out = out;
+
+  for (std::size_t filter_type = 0; filter_type < filter_flags.size(); ++filter_type)
+  {
+    if ((filters & filter_flags[filter_type]) == 0)
+    {
+      continue;
+    }
+
+    // Filter into whichever buffer does not hold the best result so far
+    auto dst = (best_out == out && best_sum != std::numeric_limits<std::size_t>::max()) ? scratch : out;
+    const auto sum = filter_row(static_cast<int>(filter_type), row, prev_row, row_bytes, bpp, dst);
+
+    if (sum < best_sum)
+    {
+      best_sum = sum;
+      best_out = dst;
+    }
+  }
+
+  if (best_out != out)
+  {
+    std::copy(best_out, best_out + row_bytes + 1, out);
+  }
+}
+
+/// Deflates one band into a raw deflate stream, which can be concatenated with the streams of the other bands.
+bool deflate_band(const std::uint8_t* data,
+                  std::size_t len,
+                  const std::uint8_t* dictionary,
+                  std::size_t dictionary_len,
+                  bool is_last,
+                  int level,
+                  int window_bits,
+                  int memory_level,
+                  int strategy,
+                  std::vector<std::uint8_t>& out)
+{
+  z_stream strm{};
+
+  if (deflateInit2(&strm, level, Z_DEFLATED, -window_bits, memory_level, strategy) != Z_OK)
+  {
+    return false;
+  }
+
+  bool success = true;
+
+  if (dictionary_len > 0)
+  {
+    success = deflateSetDictionary(&strm, dictionary, static_cast<uInt>(dictionary_len)) == Z_OK;
+  }
+
+  // A sync flush appends an empty stored block (at most 5 bytes plus padding) to the bounded size
+  out.resize(deflateBound(&strm, static_cast<uLong>(len)) + 16);
+
+  strm.next_in = const_cast<Bytef*>(data);  // zlib is not const correct
+  strm.avail_in = static_cast<uInt>(len);
+  strm.next_out = out.data();
+  strm.avail_out = static_cast<uInt>(out.size());
+
+  if (success)
+  {
+    // All bands but the last end on a byte boundary without setting the final block bit
+    const auto ret = deflate(&strm, is_last ? Z_FINISH : Z_SYNC_FLUSH);
+    success = (ret == (is_last ? Z_STREAM_END : Z_OK)) && strm.avail_in == 0 && strm.avail_out > 0;
+  }
+
+  out.resize(static_cast<std::size_t>(strm.total_out));
+  deflateEnd(&strm);
+  return success;
+}
+
+std::array<std::uint8_t, 2> zlib_header(int level, int window_bits)
+{
+  const auto cmf = static_cast<unsigned int>(((window_bits - 8) << 4) | Z_DEFLATED);
+  const auto flevel = (level < 2) ? 0u : (level < 6) ? 1u : (level == 6) ? 2u : 3u;
+  auto flg = flevel << 6;
+  flg += 31 - ((cmf << 8) + flg) % 31;
+  return {{static_cast<std::uint8_t>(cmf), static_cast<std::uint8_t>(flg)}};
+}
+
 }  // namespace
 
 /// \cond INTERNAL
@@ -57,6 +292,16 @@ struct PNGCompressionObject::Impl
 };
 
 PNGCompressionObject::PNGCompressionObject() : impl_(std::make_unique<PNGCompressionObject::Impl>())
+{
+  allocate();
+}
+
+PNGCompressionObject::~PNGCompressionObject()
+{
+  deallocate();
+}
+
+void PNGCompressionObject::allocate()
 {
   auto user_error_ptr = static_cast<png_voidp>(&impl_->error_manager);
   png_error_ptr user_error_fn = impl::error_handler;
@@ -81,9 +326,14 @@ PNGCompressionObject::PNGCompressionObject() : impl_(std::make_unique<PNGCompres
   impl_->valid = true;
 }
 
-PNGCompressionObject::~PNGCompressionObject()
+void PNGCompressionObject::deallocate()
 {
   png_destroy_write_struct(&impl_->png_ptr, &impl_->info_ptr);
+
+  impl_->png_ptr = nullptr;
+  impl_->info_ptr = nullptr;
+  impl_->error_manager = impl::PNGErrorManager();
+  impl_->valid = false;
 }
 
 bool PNGCompressionObject::valid() const
@@ -153,21 +403,31 @@ failure_state:
   return false;
 }
 
-bool PNGCompressionObject::set_compression_parameters(int compression_level,
-                                                      bool invert_alpha_channel)
+bool PNGCompressionObject::set_compression_parameters(const PNGCompressionOptions& options)
 {
   auto png_ptr = impl_->png_ptr;
 
-  compression_level = std::clamp(compression_level, 0, 9);
+  const auto compression_level = std::clamp(options.compression_level, 0, 9);
+  const auto filters = determine_filters(options.filters);
+  const auto strategy = determine_strategy(options.strategy, filters);
+  const auto window_bits = std::clamp(options.window_bits, 8, 15);
+  const auto memory_level = std::clamp(options.memory_level, 1, 9);
+  const auto buffer_size = std::max(options.buffer_size, std::size_t{1});
 
   if (setjmp(png_jmpbuf(png_ptr)))
   {
     goto failure_state;
   }
 
+  // All parameters are set explicitly, since they persist when the compression object is re-used.
   png_set_compression_level(png_ptr, compression_level);
+  png_set_filter(png_ptr, PNG_FILTER_TYPE_BASE, filters);
+  png_set_compression_strategy(png_ptr, strategy);
+  png_set_compression_window_bits(png_ptr, window_bits);
+  png_set_compression_mem_level(png_ptr, memory_level);
+  png_set_compression_buffer_size(png_ptr, buffer_size);
 
-  if (invert_alpha_channel)
+  if (options.invert_alpha_channel)
   {
     png_set_invert_alpha(png_ptr);
   }
@@ -182,9 +442,9 @@ void PNGCompressionObject::reset_if_needed()
 {
   if (impl_->needs_reset)
   {
-    // TODO: do we also need to deallocate and reallocate the png structs here, as in the decompression object?
-    impl_->error_manager.error_state = false;
-    impl_->error_manager.message_log.clear();
+    // A libpng write struct cannot be re-used after an image has been written (e.g. the signature would be omitted).
+    deallocate();
+    allocate();
     impl_->needs_reset = false;
   }
 }
@@ -258,6 +518,188 @@ void PNGCompressionCycle::compress(const ConstRowPointers& row_pointers)
 }
 
 
+PNGParallelCompressionCycle::PNGParallelCompressionCycle(PNGCompressionObject& obj,
+                                                         const PNGCompressionOptions& options,
+                                                         int bit_depth)
+    : obj_(obj), options_(options), bit_depth_(bit_depth), error_state_(false)
+{
+  obj_.reset_if_needed();
+
+  auto png_ptr = obj_.impl_->png_ptr;
+  auto info_ptr = obj_.impl_->info_ptr;
+
+  if (setjmp(png_jmpbuf(png_ptr)))
+  {
+    goto failure_state;
+  }
+
+  // Writes the signature and all chunks preceding the image data
+  png_write_info(png_ptr, info_ptr);
+
+  return;
+
+failure_state:
+  error_state_ = true;
+}
+
+PNGParallelCompressionCycle::~PNGParallelCompressionCycle()
+{
+  obj_.impl_->needs_reset = true;
+}
+
+bool PNGParallelCompressionCycle::error_state() const
+{
+  return error_state_;
+}
+
+void PNGParallelCompressionCycle::compress(const ConstRowPointers& row_pointers)
+{
+  if (error_state_)
+  {
+    return;
+  }
+
+  auto png_ptr = obj_.impl_->png_ptr;
+  auto info_ptr = obj_.impl_->info_ptr;
+  auto& message_log = obj_.impl_->error_manager.message_log;
+
+  const auto height = row_pointers.size();
+  const auto color_type = png_get_color_type(png_ptr, info_ptr);
+  const auto nr_channels = static_cast<std::size_t>(png_get_channels(png_ptr, info_ptr));
+  const auto nr_bytes_per_channel = static_cast<std::size_t>(bit_depth_ / 8);
+  const auto bpp = nr_channels * nr_bytes_per_channel;
+  const auto row_bytes = static_cast<std::size_t>(png_get_rowbytes(png_ptr, info_ptr));
+  const auto filtered_row_bytes = row_bytes + 1;
+
+  const auto is_gray = (color_type == PNG_COLOR_TYPE_GRAY || color_type == PNG_COLOR_TYPE_GRAY_ALPHA);
+  const auto is_rgb = (color_type == PNG_COLOR_TYPE_RGB || color_type == PNG_COLOR_TYPE_RGB_ALPHA);
+  const auto has_alpha = (color_type & PNG_COLOR_MASK_ALPHA) != 0;
+  const RowTransformations transformations{nr_channels,
+                                           nr_bytes_per_channel,
+                                           options_.set_bgr && is_rgb,
+                                           options_.invert_monochrome && is_gray,
+                                           options_.invert_alpha_channel && has_alpha,
+                                           bit_depth_ > 8 && !options_.keep_endianness};
+
+  const auto level = std::clamp(options_.compression_level, 0, 9);
+  const auto filters = determine_filters(options_.filters);
+  const auto strategy = determine_strategy(options_.strategy, filters);
+  const auto window_bits = std::clamp(options_.window_bits, 9, 15);  // zlib does not support 8 for raw deflate
+  const auto memory_level = std::clamp(options_.memory_level, 1, 9);
+  const auto nr_threads = impl::get_nr_threads(options_.nr_threads);
+
+  const auto nr_rows_per_band = std::max(std::size_t{1}, parallel_band_size / filtered_row_bytes);
+  const auto nr_bands = (height + nr_rows_per_band - 1) / nr_rows_per_band;
+
+  std::vector<std::uint8_t> filtered(height * filtered_row_bytes);
+  std::vector<std::vector<std::uint8_t>> compressed(nr_bands);
+  std::vector<uLong> adlers(nr_bands);
+  std::atomic<bool> success{true};
+
+  // Stage 1: transform and filter the rows of each band
+  impl::parallel_for(nr_bands, nr_threads, [&](std::size_t band) {
+    std::vector<std::uint8_t> prev_row(row_bytes);
+    std::vector<std::uint8_t> cur_row(row_bytes);
+    std::vector<std::uint8_t> scratch(filtered_row_bytes);
+
+    const auto y_begin = band * nr_rows_per_band;
+    const auto y_end = std::min(height, y_begin + nr_rows_per_band);
+
+    if (y_begin > 0)
+    {
+      std::copy(row_pointers[y_begin - 1], row_pointers[y_begin - 1] + row_bytes, prev_row.begin());
+      transform_row(transformations, prev_row.data(), row_bytes);
+    }
+
+    for (auto y = y_begin; y < y_end; ++y)
+    {
+      std::copy(row_pointers[y], row_pointers[y] + row_bytes, cur_row.begin());
+      transform_row(transformations, cur_row.data(), row_bytes);
+      filter_row_adaptive(filters, cur_row.data(), y > 0 ? prev_row.data() : nullptr, row_bytes, bpp,
+                          filtered.data() + y * filtered_row_bytes, scratch.data());
+      std::swap(prev_row, cur_row);
+    }
+  });
+
+  // Stage 2: deflate each band, using the end of the preceding band as dictionary
+  impl::parallel_for(nr_bands, nr_threads, [&](std::size_t band) {
+    const auto begin = band * nr_rows_per_band * filtered_row_bytes;
+    const auto end = std::min(height, (band + 1) * nr_rows_per_band) * filtered_row_bytes;
+    const auto dictionary_len = std::min(begin, zlib_max_window_size);
+    const auto band_data = filtered.data() + begin;
+
+    adlers[band] = adler32(adler32(0, nullptr, 0), band_data, static_cast<uInt>(end - begin));
+
+    if (!deflate_band(band_data, end - begin, band_data - dictionary_len, dictionary_len, band == nr_bands - 1, level,
+                      window_bits, memory_level, strategy, compressed[band]))
+    {
+      success = false;
+    }
+  });
+
+  if (!success)
+  {
+    message_log.add("Error: Parallel PNG compression failed", MessageType::Error);
+    obj_.impl_->error_manager.error_state = true;
+    error_state_ = true;
+    return;
+  }
+
+  auto adler = adlers[0];
+  for (std::size_t band = 1; band < nr_bands; ++band)
+  {
+    const auto begin = band * nr_rows_per_band * filtered_row_bytes;
+    const auto end = std::min(height, (band + 1) * nr_rows_per_band) * filtered_row_bytes;
+    adler = adler32_combine(adler, adlers[band], static_cast<z_off_t>(end - begin));
+  }
+
+  const auto header = zlib_header(level, window_bits);
+  const std::array<std::uint8_t, 4> trailer = {{static_cast<std::uint8_t>((adler >> 24) & 0xFF),
+                                                static_cast<std::uint8_t>((adler >> 16) & 0xFF),
+                                                static_cast<std::uint8_t>((adler >> 8) & 0xFF),
+                                                static_cast<std::uint8_t>(adler & 0xFF)}};
+  static const std::array<png_byte, 5> chunk_name_idat = {{'I', 'D', 'A', 'T', '\0'}};
+  static const std::array<png_byte, 5> chunk_name_iend = {{'I', 'E', 'N', 'D', '\0'}};
+
+  if (setjmp(png_jmpbuf(png_ptr)))
+  {
+    goto failure_state;
+  }
+
+  // Write one IDAT chunk per band; the zlib header goes into the first, the Adler-32 checksum into the last one
+  for (std::size_t band = 0; band < nr_bands; ++band)
+  {
+    const auto is_first = (band == 0);
+    const auto is_last = (band == nr_bands - 1);
+    const auto chunk_len = compressed[band].size() + (is_first ? header.size() : 0) + (is_last ? trailer.size() : 0);
+
+    png_write_chunk_start(png_ptr, chunk_name_idat.data(), static_cast<png_uint_32>(chunk_len));
+
+    if (is_first)
+    {
+      png_write_chunk_data(png_ptr, header.data(), header.size());
+    }
+
+    png_write_chunk_data(png_ptr, compressed[band].data(), compressed[band].size());
+
+    if (is_last)
+    {
+      png_write_chunk_data(png_ptr, trailer.data(), trailer.size());
+    }
+
+    png_write_chunk_end(png_ptr);
+  }
+
+  png_write_chunk(png_ptr, chunk_name_iend.data(), nullptr, 0);
+  png_write_flush(png_ptr);
+
+  return;
+
+failure_state:
+  error_state_ = true;
+}
+
+
 void user_write_data(png_structp png_ptr, png_bytep data, png_size_t length)
 {
   void* io_ptr = png_get_io_ptr(png_ptr);
@@ -278,6 +720,24 @@ void user_flush_data(png_structp /*png_ptr*/)
 {
 }
 
+void user_write_data_buffered(png_structp png_ptr, png_bytep data, png_size_t length)
+{
+  void* io_ptr = png_get_io_ptr(png_ptr);
+
+  if (io_ptr == nullptr)
+  {
+    impl::error_handler(png_ptr, "[selene] png_get_io_ptr() failed");
+  }
+
+  auto writer = static_cast<BufferedFileWriter*>(io_ptr);
+  SELENE_ASSERT(writer);
+
+  if (write(*writer, data, length) != length)
+  {
+    impl::error_handler(png_ptr, "[selene] writing PNG data failed");
+  }
+}
+
 void set_destination(PNGCompressionObject& obj, FileWriter& sink)
 {
   obj.reset_if_needed();
@@ -292,6 +752,21 @@ void set_destination(PNGCompressionObject& obj, FileWriter& sink)
 failure_state:;
 }
 
+void set_destination(PNGCompressionObject& obj, BufferedFileWriter& sink)
+{
+  obj.reset_if_needed();
+
+  if (setjmp(png_jmpbuf(obj.impl_->png_ptr)))
+  {
+    goto failure_state;
+  }
+
+  // The writer buffers itself, and flushes on closing
+  png_set_write_fn(obj.impl_->png_ptr, static_cast<png_voidp>(&sink), user_write_data_buffered, user_flush_data);
+
+failure_state:;
+}
+
 void set_destination(PNGCompressionObject& obj, VectorWriter& sink)
 {
   obj.reset_if_needed();
@@ -15,6 +15,7 @@
 #include <selene/base/MessageLog.hpp>
 #include <selene/base/Utils.hpp>
 
+#include <selene/base/io/BufferedFileWriter.hpp>
 #include <selene/base/io/FileWriter.hpp>
 #include <selene/base/io/VectorWriter.hpp>
 
@@ -28,6 +29,7 @@
 
 #include <array>
 #include <csetjmp>
+#include <cstdint>
 #include <cstdio>
 #include <memory>
 
@@ -43,14 +45,50 @@ class PNGCompressionObject;
 
 namespace impl {
 class PNGCompressionCycle;
+class PNGParallelCompressionCycle;
 void set_destination(PNGCompressionObject&, FileWriter&);
+void set_destination(PNGCompressionObject&, BufferedFileWriter&);
 void set_destination(PNGCompressionObject&, VectorWriter&);
 }  // namespace impl
 
+/** \brief Set of PNG row filters that the encoder may choose from.
+ *
+ * If more than one filter is allowed, libpng heuristically selects a filter for each row, which requires filtering
+ * each row with all candidate filters. Restricting the set trades compression ratio for encoding speed.
+ */
+enum class PNGFilterSet : std::uint8_t
+{
+  Default,  ///< libpng default (all filters, adaptive selection).
+  None,  ///< No filtering.
+  Sub,  ///< Sub filter only.
+  Up,  ///< Up filter only.
+  Average,  ///< Average filter only.
+  Paeth,  ///< Paeth filter only.
+  Fast,  ///< Adaptive selection between the computationally cheap filters: none, sub, and up.
+  All,  ///< Adaptive selection between all filters.
+};
+
+/** \brief zlib compression strategy used by the PNG encoder.
+ */
+enum class PNGCompressionStrategy : std::uint8_t
+{
+  Default,  ///< libpng default (`Z_FILTERED` for filtered image data, `Z_DEFAULT_STRATEGY` otherwise).
+  Standard,  ///< zlib default strategy (`Z_DEFAULT_STRATEGY`).
+  Filtered,  ///< Favor Huffman coding over string matching (`Z_FILTERED`).
+  HuffmanOnly,  ///< Huffman coding only, no string matching (`Z_HUFFMAN_ONLY`). Very fast.
+  RLE,  ///< Limit match distances to one, i.e. run-length encoding (`Z_RLE`). Fast, and good for filtered data.
+  Fixed,  ///< Use fixed Huffman codes only (`Z_FIXED`).
+};
+
 /** \brief PNG compression options.
  *
  * For more detailed information, consult the libpng manual (libpng-manual.txt) provided with every libpng source
  * distribution, or available here: http://www.libpng.org/pub/png/libpng-manual.txt
+ *
+ * If `nr_threads` is not 1 (and the image is not interlaced), the image is split into bands of rows, which are
+ * filtered and deflated concurrently (similar to pigz), and then concatenated into one valid zlib stream. The output
+ * is a regular PNG stream, and is independent of the actual number of threads used; it may be slightly larger than
+ * with single-threaded compression. `buffer_size` does not apply in this case.
  */
 struct PNGCompressionOptions
 {
@@ -60,6 +98,12 @@ struct PNGCompressionOptions
   bool invert_monochrome;  ///< If true, invert grayscale or grayscale_alpha image values. Defaults to false.
   bool keep_endianness;  ///< If true, keep endianness. Otherwise, convert endianness (as likely done when reading). Defaults to false.
   bool interlaced;  ///< If true, write PNG image as interlaced. Defaults to false.
+  PNGFilterSet filters = PNGFilterSet::Default;  ///< The set of row filters the encoder may choose from.
+  PNGCompressionStrategy strategy = PNGCompressionStrategy::Default;  ///< The zlib compression strategy.
+  int window_bits = 15;  ///< The zlib window size (base-2 logarithm); may take values from 8 to 15.
+  int memory_level = 8;  ///< The zlib memory level; may take values from 1 (least memory) to 9 (fastest).
+  std::size_t buffer_size = 8192;  ///< The size of the compression buffer, i.e. the maximum size of an IDAT chunk.
+  int nr_threads = 1;  ///< Number of compression threads; see below. A value <= 0 denotes the hardware concurrency.
 
   /** \brief Constructor, setting the respective JPEG compression options.
    *
@@ -85,6 +129,24 @@ struct PNGCompressionOptions
       , interlaced(interlaced_)
   {
   }
+
+  /** \brief Returns compression options tuned for encoding speed rather than for compression ratio.
+   *
+   * Uses the lowest compression level, a single cheap row filter (no heuristic filter selection), run-length
+   * encoding, and a large compression buffer. Output will typically be somewhat larger than with the default
+   * options, while encoding is several times faster.
+   *
+   * @return The compression options.
+   */
+  static PNGCompressionOptions fast()
+  {
+    PNGCompressionOptions options(1);
+    options.filters = PNGFilterSet::Up;
+    options.strategy = PNGCompressionStrategy::RLE;
+    options.memory_level = 9;
+    options.buffer_size = 1 << 16;
+    return options;
+  }
 };
 
 /** \brief Opaque PNG compression object, holding internal state.
@@ -108,24 +170,28 @@ public:
   [[nodiscard]] const MessageLog& message_log() const;
 
   bool set_image_info(int width, int height, int nr_channels, int bit_depth, bool interlaced, PixelFormat pixel_format);
-  bool set_compression_parameters(int, bool);
+  bool set_compression_parameters(const PNGCompressionOptions& options);
   /// \endcond
 
 private:
   struct Impl;
   std::unique_ptr<Impl> impl_;
 
+  void allocate();
+  void deallocate();
   void reset_if_needed();
 
   friend class impl::PNGCompressionCycle;
+  friend class impl::PNGParallelCompressionCycle;
   friend void impl::set_destination(PNGCompressionObject&, FileWriter&);
+  friend void impl::set_destination(PNGCompressionObject&, BufferedFileWriter&);
   friend void impl::set_destination(PNGCompressionObject&, VectorWriter&);
 };
 
 
 /** \brief Writes a PNG image data stream, given the supplied uncompressed image data.
  *
- * @tparam SinkType Type of the output sink. Can be FileWriter or VectorWriter.
+ * @tparam SinkType Type of the output sink. Can be FileWriter, BufferedFileWriter, or VectorWriter.
  * @param img_data The image data to be written.
  * @param sink Output sink instance.
  * @param options The compression options.
@@ -142,7 +208,7 @@ bool write_png(const DynImageOrView& dyn_img_or_view,
  *
  * This function overload enables re-use of a PNGCompressionObject instance.
  *
- * @tparam SinkType Type of the output sink. Can be FileWriter or VectorWriter.
+ * @tparam SinkType Type of the output sink. Can be FileWriter, BufferedFileWriter, or VectorWriter.
  * @param img_data The image data to be written.
  * @param obj A PNGCompressionObject instance.
  * @param sink Output sink instance.
@@ -184,6 +250,28 @@ private:
   bool error_state_;
 };
 
+class PNGParallelCompressionCycle
+{
+public:
+  explicit PNGParallelCompressionCycle(PNGCompressionObject& obj, const PNGCompressionOptions& options, int bit_depth);
+
+  PNGParallelCompressionCycle(const PNGParallelCompressionCycle&) = delete;
+  PNGParallelCompressionCycle& operator=(const PNGParallelCompressionCycle&) = delete;
+  PNGParallelCompressionCycle(PNGParallelCompressionCycle&&) = delete;
+  PNGParallelCompressionCycle& operator=(PNGParallelCompressionCycle&&) = delete;
+
+  ~PNGParallelCompressionCycle();
+
+  [[nodiscard]] bool error_state() const;
+  void compress(const ConstRowPointers& row_pointers);
+
+private:
+  PNGCompressionObject& obj_;
+  PNGCompressionOptions options_;
+  int bit_depth_;
+  bool error_state_;
+};
+
 }  // namespace impl
 
 
@@ -239,7 +327,7 @@ bool write_png(const DynImageOrView& dyn_img_or_view,
     return false;
   }
 
-  const bool pars_set = obj.set_compression_parameters(options.compression_level, options.invert_alpha_channel);
+  const bool pars_set = obj.set_compression_parameters(options);
 
   if (!pars_set)
   {
@@ -247,10 +335,19 @@ bool write_png(const DynImageOrView& dyn_img_or_view,
     return false;
   }
 
-  impl::PNGCompressionCycle cycle(obj, options.set_bgr, options.invert_monochrome, options.keep_endianness,
-                                  static_cast<int>(bit_depth));
   const auto row_pointers = get_const_row_pointers(dyn_img_or_view);
-  cycle.compress(row_pointers);
+
+  if (options.nr_threads != 1 && !options.interlaced)
+  {
+    impl::PNGParallelCompressionCycle cycle(obj, options, static_cast<int>(bit_depth));
+    cycle.compress(row_pointers);
+  }
+  else
+  {
+    impl::PNGCompressionCycle cycle(obj, options.set_bgr, options.invert_monochrome, options.keep_endianness,
+                                    static_cast<int>(bit_depth));
+    cycle.compress(row_pointers);
+  }
 
   impl::assign_message_log(obj, messages);
   return !obj.error_state();
@@ -0,0 +1,625 @@
+// This file is part of the `Selene` library.
+// Copyright 2017-2019 Michael Hofmann (https://github.com/kmhofmann).
+// Distributed under MIT license. See accompanying LICENSE file in the top-level directory.
+
+#include <selene/selene_config.hpp>
+
+#if defined(SELENE_WITH_LIBTIFF)
+
+#include <selene/img_io/tiff/PageIndex.hpp>
+
+#include <selene/base/Assert.hpp>
+#include <selene/base/_impl/ParallelFor.hpp>
+#include <selene/base/io/FileReader.hpp>
+#include <selene/base/io/MemoryReader.hpp>
+#include <selene/base/io/MmapReader.hpp>
+
+#include <selene/img_io/tiff/Read.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <exception>
+#include <limits>
+#include <thread>
+#include <unordered_set>
+#include <variant>
+
+namespace sln {
+
+namespace {
+
+/// Describes where the TIFF data is read from: either a file, or a region of memory.
+struct PageSourceInfo
+{
+  std::optional<std::string> filename;
+  ConstantMemoryRegion region{nullptr, 0};
+};
+
+/// Returns the unsigned integer of `nr_bytes` bytes at `ptr`, stored in the given byte order.
+std::uint64_t get_uint(const std::uint8_t* ptr, std::size_t nr_bytes, bool big_endian)
+{
+  std::uint64_t value = 0;
+
+  for (std::size_t i = 0; i < nr_bytes; ++i)
+  {
+    value = (value << 8) | ptr[big_endian ? i : nr_bytes - 1 - i];
+  }
+
+  return value;
+}
+
+/// Returns the offsets of all image file directories in the main chain of directories, without parsing their entries.
+template <typename SourceType>
+std::vector<std::uint64_t> scan_directory_offsets(SourceType& source, MessageLog& message_log)
+{
+  std::vector<std::uint64_t> offsets;
+
+  // Classic TIFF: "II" or "MM", version 42, 4-byte offset of the first directory.
+  // BigTIFF: "II" or "MM", version 43, offset size 8, 2 bytes of padding, 8-byte offset of the first directory.
+  std::array<std::uint8_t, 16> header{};
+
+  if (read(source, header.data(), 8) != 8
+      || !((header[0] == 'I' && header[1] == 'I') || (header[0] == 'M' && header[1] == 'M')))
+  {
+    message_log.add("Data stream is not in the TIFF format.", MessageType::Error);
+    return offsets;
+  }
+
+  const bool big_endian = (header[0] == 'M');
+  const auto version = get_uint(&header[2], 2, big_endian);
+  const bool big_tiff = (version == 43);
+
+  if (version != 42 && !big_tiff)
+  {
+    message_log.add("Data stream is not in the TIFF format.", MessageType::Error);
+    return offsets;
+  }
+
+  if (big_tiff && (get_uint(&header[4], 2, big_endian) != 8 || read(source, &header[8], 8) != 8))
+  {
+    message_log.add("Data stream has an invalid BigTIFF header.", MessageType::Error);
+    return offsets;
+  }
+
+  const std::size_t count_size = big_tiff ? 8 : 2;
+  const std::size_t entry_size = big_tiff ? 20 : 12;
+  const std::size_t offset_size = big_tiff ? 8 : 4;
+  const auto max_offset = static_cast<std::uint64_t>(std::numeric_limits<std::ptrdiff_t>::max() / 2);
+
+  auto offset = big_tiff ? get_uint(&header[8], 8, big_endian) : get_uint(&header[4], 4, big_endian);
+  std::unordered_set<std::uint64_t> visited_offsets;
+  std::array<std::uint8_t, 8> buffer{};
+
+  while (offset != 0)
+  {
+    if (!visited_offsets.insert(offset).second)
+    {
+      message_log.add("TIFF directory chain contains a loop; ignoring subsequent directories.", MessageType::Warning);
+      break;
+    }
+
+    if (offset > max_offset || !source.seek_abs(static_cast<std::ptrdiff_t>(offset))
+        || read(source, buffer.data(), count_size) != count_size)
+    {
+      message_log.add("TIFF directory offset is out of bounds; ignoring subsequent directories.",
+                      MessageType::Warning);
+      break;
+    }
+
+    offsets.push_back(offset);
+
+    // A missing or truncated offset to the next directory terminates the chain, as in libtiff.
+    const auto nr_entries = get_uint(buffer.data(), count_size, big_endian);
+    const auto next_offset_pos = offset + count_size + nr_entries * entry_size;
+
+    if (nr_entries > max_offset / entry_size || next_offset_pos > max_offset
+        || !source.seek_abs(static_cast<std::ptrdiff_t>(next_offset_pos))
+        || read(source, buffer.data(), offset_size) != offset_size)
+    {
+      break;
+    }
+
+    offset = get_uint(buffer.data(), offset_size, big_endian);
+  }
+
+  return offsets;
+}
+
+}  // namespace
+
+namespace impl {
+
+/// Reading state, owned by one thread at a time: a source for the TIFF data, and a TIFFReadObject opened on it.
+class TIFFPageReader
+{
+public:
+  TIFFPageReader() = default;
+  TIFFPageReader(const TIFFPageReader&) = delete;
+  TIFFPageReader& operator=(const TIFFPageReader&) = delete;
+
+  /// Opens the source, optionally scanning its directory offsets before handing it to libtiff.
+  bool open(const PageSourceInfo& info, MessageLog& message_log, std::vector<std::uint64_t>* offsets = nullptr)
+  {
+    tiff_set_handlers();
+
+    if (info.filename)
+    {
+      // Prefer decoding straight from the page cache; fall back to regular file I/O if the file cannot be mapped
+      if (mmap_source_.open(*info.filename, MmapAccessHint::Normal))
+      {
+        return open_object(mmap_source_, message_log, offsets);
+      }
+
+      if (file_source_.open(*info.filename))
+      {
+        return open_object(file_source_, message_log, offsets);
+      }
+
+      message_log.add("Could not open file " + *info.filename, MessageType::Error);
+      return false;
+    }
+
+    memory_source_.open(info.region);
+    return open_object(memory_source_, message_log, offsets);
+  }
+
+  std::optional<TiffImageLayout> layout(std::uint64_t offset, MessageLog& message_log)
+  {
+    return std::visit(
+        [offset, &message_log](auto& obj) -> std::optional<TiffImageLayout> {
+          if constexpr (std::is_same_v<std::decay_t<decltype(obj)>, std::monostate>)
+          {
+            return std::nullopt;
+          }
+          else
+          {
+            if (!set_directory(obj, offset, message_log))
+            {
+              return std::nullopt;
+            }
+
+            return obj.get_layout();
+          }
+        },
+        obj_);
+  }
+
+  template <typename DynImageOrView>
+  bool read(std::uint64_t offset, DynImageOrView& dyn_img_or_view, MessageLog& message_log)
+  {
+    return std::visit(
+        [offset, &dyn_img_or_view, &message_log](auto& obj) {
+          if constexpr (std::is_same_v<std::decay_t<decltype(obj)>, std::monostate>)
+          {
+            return false;
+          }
+          else
+          {
+            return set_directory(obj, offset, message_log)
+                   && tiff_read_current_directory(obj, message_log, dyn_img_or_view);
+          }
+        },
+        obj_);
+  }
+
+private:
+  MmapReader mmap_source_;
+  FileReader file_source_;
+  MemoryReader memory_source_;
+  std::variant<std::monostate, TIFFReadObject<MmapReader>, TIFFReadObject<FileReader>, TIFFReadObject<MemoryReader>>
+      obj_;
+
+  template <typename SourceType>
+  bool open_object(SourceType& source, MessageLog& message_log, std::vector<std::uint64_t>* offsets)
+  {
+    if (offsets != nullptr)
+    {
+      *offsets = scan_directory_offsets(source, message_log);
+      source.rewind();
+
+      if (offsets->empty())
+      {
+        return false;
+      }
+    }
+
+    auto& obj = obj_.template emplace<TIFFReadObject<SourceType>>();
+
+    if (!obj.open(source))
+    {
+      obj_ = std::monostate{};
+      message_log.add("Data stream could not be opened.", MessageType::Error);
+      return false;
+    }
+
+    return true;
+  }
+
+  template <typename SourceType>
+  static bool set_directory(TIFFReadObject<SourceType>& obj, std::uint64_t offset, MessageLog& message_log)
+  {
+    if (!obj.set_directory_offset(offset))
+    {
+      message_log.add("TIFF directory at offset " + std::to_string(offset) + " could not be read.",
+                      MessageType::Error);
+      return false;
+    }
+
+    return true;
+  }
+};
+
+}  // namespace impl
+
+struct TIFFPageIndex::Impl
+{
+  PageSourceInfo source_info;
+  std::vector<std::uint64_t> offsets;
+  std::vector<std::optional<TiffImageLayout>> layouts;
+  std::unique_ptr<impl::TIFFPageReader> reader;  // used on the calling thread
+
+  // Static, s.t. it can also be called on a moved-from index, i.e. without an Impl instance.
+  template <typename DynImageOrView>
+  static bool read_page(Impl* self, std::size_t index, DynImageOrView& dyn_img_or_view, MessageLog* message_log)
+  {
+    MessageLog local_message_log;
+    bool success = false;
+
+    if (self == nullptr || self->reader == nullptr)
+    {
+      local_message_log.add("TIFFPageIndex is not open.", MessageType::Error);
+    }
+    else if (index >= self->offsets.size())
+    {
+      local_message_log.add("TIFF page index " + std::to_string(index) + " is out of range.", MessageType::Error);
+    }
+    else
+    {
+      success = self->reader->read(self->offsets[index], dyn_img_or_view, local_message_log);
+    }
+
+    impl::tiff_assign_message_log(local_message_log, message_log);
+    return success;
+  }
+
+  bool open(PageSourceInfo info, MessageLog* message_log)
+  {
+    close();
+    source_info = std::move(info);
+    reader = std::make_unique<impl::TIFFPageReader>();
+
+    MessageLog local_message_log;
+    const bool success = reader->open(source_info, local_message_log, &offsets);
+    impl::tiff_assign_message_log(local_message_log, message_log);
+
+    if (!success)
+    {
+      close();
+      return false;
+    }
+
+    layouts.resize(offsets.size());
+    return true;
+  }
+
+  void close()
+  {
+    reader.reset();
+    source_info = PageSourceInfo{};
+    offsets.clear();
+    layouts.clear();
+  }
+};
+
+/** \brief Default constructor. The index needs to be opened on a file or memory region before use.
+ */
+TIFFPageIndex::TIFFPageIndex()
+    : impl_(std::make_unique<TIFFPageIndex::Impl>())
+{
+}
+
+/** \brief Opens the specified TIFF file, and scans the offsets of the contained pages.
+ *
+ * If the file cannot be opened or is not a TIFF file, then `is_open()` will return false.
+ *
+ * @param filename The name of the TIFF file.
+ * @param message_log Optional pointer to the message log. If provided, warning and error messages will be output there.
+ */
+TIFFPageIndex::TIFFPageIndex(const std::string& filename, MessageLog* message_log)
+    : TIFFPageIndex()
+{
+  open(filename, message_log);
+}
+
+/** \brief Opens the TIFF data stream in the specified memory region, and scans the offsets of the contained pages.
+ *
+ * If the memory region does not contain TIFF data, then `is_open()` will return false.
+ *
+ * @param region The memory region containing the TIFF data stream. It has to stay valid during the index' lifetime.
+ * @param message_log Optional pointer to the message log. If provided, warning and error messages will be output there.
+ */
+TIFFPageIndex::TIFFPageIndex(ConstantMemoryRegion region, MessageLog* message_log)
+    : TIFFPageIndex()
+{
+  open(region, message_log);
+}
+
+TIFFPageIndex::~TIFFPageIndex() = default;
+
+TIFFPageIndex::TIFFPageIndex(TIFFPageIndex&&) noexcept = default;
+
+TIFFPageIndex& TIFFPageIndex::operator=(TIFFPageIndex&&) noexcept = default;
+
+/** \brief Opens the specified TIFF file, and scans the offsets of the contained pages.
+ *
+ * Any previously opened file or memory region will be closed.
+ *
+ * @param filename The name of the TIFF file.
+ * @param message_log Optional pointer to the message log. If provided, warning and error messages will be output there.
+ * @return True, if the file was successfully opened and contains at least one page; false otherwise.
+ */
+bool TIFFPageIndex::open(const std::string& filename, MessageLog* message_log)
+{
+  PageSourceInfo info;
+  info.filename = filename;
+
+  if (impl_ == nullptr)
+  {
+    impl_ = std::make_unique<TIFFPageIndex::Impl>();
+  }
+
+  return impl_->open(std::move(info), message_log);
+}
+
+/** \brief Opens the TIFF data stream in the specified memory region, and scans the offsets of the contained pages.
+ *
+ * Any previously opened file or memory region will be closed.
+ *
+ * @param region The memory region containing the TIFF data stream. It has to stay valid during the index' lifetime.
+ * @param message_log Optional pointer to the message log. If provided, warning and error messages will be output there.
+ * @return True, if the memory region contains a TIFF data stream with at least one page; false otherwise.
+ */
+bool TIFFPageIndex::open(ConstantMemoryRegion region, MessageLog* message_log)
+{
+  PageSourceInfo info;
+  info.region = region;
+
+  if (impl_ == nullptr)
+  {
+    impl_ = std::make_unique<TIFFPageIndex::Impl>();
+  }
+
+  return impl_->open(std::move(info), message_log);
+}
+
+/** \brief Closes the indexed file or memory region, and clears the index.
+ */
+void TIFFPageIndex::close()
+{
+  if (impl_ != nullptr)
+  {
+    impl_->close();
+  }
+}
+
+/** \brief Returns whether a TIFF file or memory region is open.
+ *
+ * @return True, if a TIFF file or memory region is open; false otherwise.
+ */
+bool TIFFPageIndex::is_open() const noexcept
+{
+  return impl_ != nullptr && impl_->reader != nullptr;
+}
+
+/** \brief Returns the number of pages (image file directories) in the TIFF data stream.
+ *
+ * @return The number of pages.
+ */
+std::size_t TIFFPageIndex::nr_pages() const noexcept
+{
+  return (impl_ != nullptr) ? impl_->offsets.size() : std::size_t{0};
+}
+
+/** \brief Returns the offset of the image file directory of the specified page, within the TIFF data stream.
+ *
+ * @param index The page index.
+ * @return The directory offset, or 0, if the index is out of range.
+ */
+std::uint64_t TIFFPageIndex::page_offset(std::size_t index) const noexcept
+{
+  return (index < nr_pages()) ? impl_->offsets[index] : std::uint64_t{0};
+}
+
+/** \brief Returns the layout of the specified page.
+ *
+ * The layout is read from the respective image file directory on first access, and cached subsequently.
+ *
+ * @param index The page index.
+ * @param message_log Optional pointer to the message log. If provided, warning and error messages will be output there.
+ * @return The layout of the page; empty, if the index is out of range or the directory could not be read.
+ */
+std::optional<TiffImageLayout> TIFFPageIndex::layout(std::size_t index, MessageLog* message_log)
+{
+  if (!is_open() || index >= impl_->offsets.size())
+  {
+    return std::nullopt;
+  }
+
+  auto& layout = impl_->layouts[index];
+
+  if (!layout)
+  {
+    MessageLog local_message_log;
+    layout = impl_->reader->layout(impl_->offsets[index], local_message_log);
+    impl::tiff_assign_message_log(local_message_log, message_log);
+  }
+
+  return layout;
+}
+
+/** \brief Decodes the specified page.
+ *
+ * @param index The page index.
+ * @param message_log Optional pointer to the message log. If provided, warning and error messages will be output there.
+ * @return The decoded page. In case the page could not be read successfully, the image will not be valid (i.e.
+ * `is_valid() == false`).
+ */
+DynImage<> TIFFPageIndex::read_page(std::size_t index, MessageLog* message_log)
+{
+  DynImage<> dyn_img;
+  [[maybe_unused]] const bool success = Impl::read_page(impl_.get(), index, dyn_img, message_log);
+  return dyn_img;
+}
+
+/** \brief Decodes the specified page into pre-allocated memory.
+ *
+ * The layout of the view has to match the layout of the page (see `layout()`).
+ *
+ * @param index The page index.
+ * @param dyn_img_view The view into the pre-allocated memory.
+ * @param message_log Optional pointer to the message log. If provided, warning and error messages will be output there.
+ * @return True, if the page was read successfully; false otherwise.
+ */
+bool TIFFPageIndex::read_page(std::size_t index, MutableDynImageView& dyn_img_view, MessageLog* message_log)
+{
+  return Impl::read_page(impl_.get(), index, dyn_img_view, message_log);
+}
+
+/** \brief Decodes a range of consecutive pages, in parallel.
+ *
+ * See the overload taking a vector of page indices.
+ *
+ * @param first_index The index of the first page to decode.
+ * @param nr_pages The number of pages to decode; clamped to the number of available pages.
+ * @param nr_threads The number of threads to use for decoding; a value <= 0 denotes the hardware concurrency.
+ * @param message_logs Optional pointer to a vector of message logs. If provided, it will be resized to the number of
+ * decoded pages, and each element will contain the messages emitted while decoding the respective page.
+ * @return The decoded pages, in order.
+ */
+std::vector<DynImage<>> TIFFPageIndex::read_pages(std::size_t first_index,
+                                                  std::size_t nr_pages,
+                                                  int nr_threads,
+                                                  std::vector<MessageLog>* message_logs)
+{
+  const auto nr_indexed_pages = this->nr_pages();
+  const auto end_index = std::min(nr_indexed_pages, first_index + std::min(nr_pages, nr_indexed_pages));
+  std::vector<std::size_t> indices;
+
+  for (auto index = first_index; index < end_index; ++index)
+  {
+    indices.push_back(index);
+  }
+
+  return read_pages(indices, nr_threads, message_logs);
+}
+
+/** \brief Decodes the specified pages, in parallel.
+ *
+ * Each additional worker thread opens its own source (and TIFFReadObject) on the indexed file or memory region; the
+ * calling thread takes part in decoding.
+ *
+ * @param indices The indices of the pages to decode.
+ * @param nr_threads The number of threads to use for decoding; a value <= 0 denotes the hardware concurrency.
+ * @param message_logs Optional pointer to a vector of message logs. If provided, it will be resized to the number of
+ * indices, and each element will contain the messages emitted while decoding the respective page.
+ * @return The decoded pages, in order of the given indices. Pages that could not be read successfully will not be
+ * valid (i.e. `is_valid() == false`).
+ */
+std::vector<DynImage<>> TIFFPageIndex::read_pages(const std::vector<std::size_t>& indices,
+                                                  int nr_threads,
+                                                  std::vector<MessageLog>* message_logs)
+{
+  std::vector<DynImage<>> images(indices.size());
+  std::vector<MessageLog> local_message_logs(indices.size());
+  std::atomic<std::size_t> next_position{0};
+
+  auto decode_pages = [&](impl::TIFFPageReader* reader, MessageLog& open_message_log) {
+    for (auto pos = next_position++; pos < indices.size(); pos = next_position++)
+    {
+      const auto index = indices[pos];
+
+      if (reader == nullptr)
+      {
+        local_message_logs[pos] = open_message_log;
+      }
+      else if (index >= impl_->offsets.size())
+      {
+        local_message_logs[pos].add("TIFF page index " + std::to_string(index) + " is out of range.",
+                                    MessageType::Error);
+      }
+      else
+      {
+        [[maybe_unused]] const bool success = reader->read(impl_->offsets[index], images[pos], local_message_logs[pos]);
+      }
+    }
+  };
+
+  const auto nr_workers = is_open() ? std::min(impl::get_nr_threads(nr_threads), indices.size()) : std::size_t{0};
+  std::vector<std::exception_ptr> exceptions(std::max(nr_workers, std::size_t{1}));
+
+  {
+    std::vector<std::thread> threads;
+    threads.reserve(nr_workers);
+    const impl::ThreadJoinGuard join_guard(threads);
+
+    for (std::size_t t = 1; t < nr_workers; ++t)
+    {
+      try
+      {
+        threads.emplace_back([&, t]() {
+          try
+          {
+            MessageLog open_message_log;
+            impl::TIFFPageReader reader;
+            const bool opened = reader.open(impl_->source_info, open_message_log);
+            decode_pages(opened ? &reader : nullptr, open_message_log);
+          }
+          catch (...)
+          {
+            // Let the other threads run out of work
+            next_position = indices.size();
+            exceptions[t] = std::current_exception();
+          }
+        });
+      }
+      catch (...)
+      {
+        // The remaining pages are decoded by the threads that could be started
+        break;
+      }
+    }
+
+    try
+    {
+      MessageLog open_message_log;
+      open_message_log.add("TIFFPageIndex is not open.", MessageType::Error);
+      decode_pages(is_open() ? impl_->reader.get() : nullptr, open_message_log);
+    }
+    catch (...)
+    {
+      // Let the other threads run out of work
+      next_position = indices.size();
+      exceptions[0] = std::current_exception();
+    }
+  }
+
+  for (const auto& exception : exceptions)
+  {
+    if (exception)
+    {
+      std::rethrow_exception(exception);
+    }
+  }
+
+  if (message_logs)
+  {
+    *message_logs = std::move(local_message_logs);
+  }
+
+  return images;
+}
+
+}  // namespace sln
+
+#endif  // defined(SELENE_WITH_LIBTIFF)
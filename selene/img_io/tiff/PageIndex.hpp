@@ -0,0 +1,96 @@
+// This file is part of the `Selene` library.
+// Copyright 2017-2019 Michael Hofmann (https://github.com/kmhofmann).
+// Distributed under MIT license. See accompanying LICENSE file in the top-level directory.
+
+#ifndef SELENE_IMG_IO_TIFF_PAGE_INDEX_HPP
+#define SELENE_IMG_IO_TIFF_PAGE_INDEX_HPP
+
+/// @file
+
+#include <selene/selene_config.hpp>
+
+#if defined(SELENE_WITH_LIBTIFF)
+
+#include <selene/base/MessageLog.hpp>
+#include <selene/base/io/MemoryRegion.hpp>
+
+#include <selene/img/dynamic/DynImage.hpp>
+#include <selene/img/dynamic/DynImageView.hpp>
+
+#include <selene/img_io/tiff/Common.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace sln {
+
+/// \addtogroup group-img-io-tiff
+/// @{
+
+/** \brief Index over the pages (image file directories) of a multi-page TIFF file, providing random access to them.
+ *
+ * Whereas `read_tiff_all()` decodes all pages of a TIFF file in sequence, a TIFFPageIndex allows decoding only the
+ * pages that are actually needed.
+ *
+ * On opening, only the chain of directory offsets is scanned: per page, the number of directory entries and the offset
+ * of the next directory are read, but no tags are parsed. Page layouts are read on first access, and cached.
+ * A page is decoded by positioning *libtiff* directly at the respective directory offset, i.e. independently of the
+ * number of preceding pages.
+ *
+ * Ranges or subsets of pages can be decoded in parallel. Each worker thread then reads through its own source and its
+ * own TIFFReadObject; files are preferably accessed via memory mapping (see MmapReader).
+ *
+ * The file (or memory region) has to remain unchanged while it is indexed. Memory regions are not copied; the memory
+ * has to stay valid for the lifetime of the index.
+ * A TIFFPageIndex instance is not thread-safe itself, i.e. its member functions must not be called concurrently.
+ */
+class TIFFPageIndex
+{
+public:
+  TIFFPageIndex();
+  explicit TIFFPageIndex(const std::string& filename, MessageLog* message_log = nullptr);
+  explicit TIFFPageIndex(ConstantMemoryRegion region, MessageLog* message_log = nullptr);
+  ~TIFFPageIndex();
+
+  TIFFPageIndex(const TIFFPageIndex&) = delete;
+  TIFFPageIndex& operator=(const TIFFPageIndex&) = delete;
+  TIFFPageIndex(TIFFPageIndex&&) noexcept;
+  TIFFPageIndex& operator=(TIFFPageIndex&&) noexcept;
+
+  bool open(const std::string& filename, MessageLog* message_log = nullptr);
+  bool open(ConstantMemoryRegion region, MessageLog* message_log = nullptr);
+  void close();
+
+  bool is_open() const noexcept;
+  std::size_t nr_pages() const noexcept;
+  std::uint64_t page_offset(std::size_t index) const noexcept;
+
+  std::optional<TiffImageLayout> layout(std::size_t index, MessageLog* message_log = nullptr);
+
+  DynImage<> read_page(std::size_t index, MessageLog* message_log = nullptr);
+  bool read_page(std::size_t index, MutableDynImageView& dyn_img_view, MessageLog* message_log = nullptr);
+
+  std::vector<DynImage<>> read_pages(std::size_t first_index,
+                                     std::size_t nr_pages,
+                                     int nr_threads = 0,
+                                     std::vector<MessageLog>* message_logs = nullptr);
+  std::vector<DynImage<>> read_pages(const std::vector<std::size_t>& indices,
+                                     int nr_threads = 0,
+                                     std::vector<MessageLog>* message_logs = nullptr);
+
+private:
+  struct Impl;
+  std::unique_ptr<Impl> impl_;
+};
+
+/// @}
+
+}  // namespace sln
+
+#endif  // defined(SELENE_WITH_LIBTIFF)
+
+#endif  // SELENE_IMG_IO_TIFF_PAGE_INDEX_HPP
@@ -10,14 +10,20 @@
 
 #include <selene/base/Assert.hpp>
 #include <selene/base/Utils.hpp>
+#include <selene/base/io/AsyncFileReader.hpp>
 #include <selene/base/io/FileReader.hpp>
 #include <selene/base/io/MemoryReader.hpp>
+#include <selene/base/io/MmapReader.hpp>
 
 #include <selene/img_io/tiff/_impl/TIFFDetail.hpp>
 #include <selene/img_io/tiff/_impl/TIFFIOFunctions.hpp>
 #include <selene/img_io/tiff/_impl/TIFFReadStrips.hpp>
 #include <selene/img_io/tiff/_impl/TIFFReadTiles.hpp>
 
+#include <selene/img_ops/_impl/ChannelKernels.hpp>
+
+#include <array>
+#include <cstring>
 #include <tuple>
 #include <type_traits>
 
@@ -164,6 +170,99 @@ bool check_suitability(const TiffImageLayout& layout, MessageLog& message_log)
   return true;
 }
 
+bool check_planes(const TiffImageLayout& layout, const std::vector<MutableDynImageView>& planes, MessageLog& message_log)
+{
+  const auto nr_bytes_per_channel = std::max(1, layout.bits_per_sample / 8);
+
+  if (planes.size() != layout.samples_per_pixel)
+  {
+    message_log.add("TIFF reader: Number of planes (" + std::to_string(planes.size()) + ") does not match number of "
+                    "samples per pixel (" + std::to_string(layout.samples_per_pixel) + ").", MessageType::Error);
+    return false;
+  }
+
+  for (const auto& plane : planes)
+  {
+    if (plane.width() != to_pixel_length(layout.width) || plane.height() != to_pixel_length(layout.height)
+        || plane.nr_channels() != 1 || plane.nr_bytes_per_channel() != nr_bytes_per_channel)
+    {
+      message_log.add("TIFF reader: Plane layout does not match image layout.", MessageType::Error);
+      return false;
+    }
+  }
+
+  return true;
+}
+
+template <std::size_t N, typename T>
+void split_rows_into_planes(const ConstantDynImageView& src, const std::vector<MutableDynImageView>& planes)
+{
+  std::array<T*, N> ptrs_dst{};
+
+  for (auto y = 0_idx; y < src.height(); ++y)
+  {
+    for (std::size_t c = 0; c < N; ++c)
+    {
+      ptrs_dst[c] = reinterpret_cast<T*>(planes[c].byte_ptr(y));
+    }
+
+    impl::deinterleave_row<N>(reinterpret_cast<const T*>(src.byte_ptr(y)), ptrs_dst,
+                              static_cast<std::ptrdiff_t>(src.width()));
+  }
+}
+
+template <typename T>
+bool split_into_planes_typed(const ConstantDynImageView& src, const std::vector<MutableDynImageView>& planes)
+{
+  switch (planes.size())
+  {
+    case 1: split_rows_into_planes<1, T>(src, planes); return true;
+    case 2: split_rows_into_planes<2, T>(src, planes); return true;
+    case 3: split_rows_into_planes<3, T>(src, planes); return true;
+    case 4: split_rows_into_planes<4, T>(src, planes); return true;
+    default: return false;
+  }
+}
+
+// Splits an interleaved image into its planes (sample-wise, for uncommon layouts).
+void split_into_planes(const ConstantDynImageView& src, const std::vector<MutableDynImageView>& planes)
+{
+  const auto nr_bytes_per_channel = static_cast<std::size_t>(src.nr_bytes_per_channel());
+
+  const bool split = [&]() {
+    switch (nr_bytes_per_channel)
+    {
+      case 1: return split_into_planes_typed<std::uint8_t>(src, planes);
+      case 2: return split_into_planes_typed<std::uint16_t>(src, planes);
+      case 4: return split_into_planes_typed<std::uint32_t>(src, planes);
+      default: return false;
+    }
+  }();
+
+  if (split)
+  {
+    return;
+  }
+
+  const auto nr_bytes_per_pixel = static_cast<std::size_t>(src.layout().nr_bytes_per_pixel());
+
+  for (auto y = 0_idx; y < src.height(); ++y)
+  {
+    for (std::size_t c = 0; c < planes.size(); ++c)
+    {
+      auto src_ptr = src.byte_ptr(y) + c * nr_bytes_per_channel;
+      auto dst_ptr = planes[c].byte_ptr(y);
+
+      for (auto x = 0_idx; x < src.width(); ++x)
+      {
+        std::memcpy(dst_ptr, src_ptr, nr_bytes_per_channel);
+        src_ptr += nr_bytes_per_pixel;
+        dst_ptr += nr_bytes_per_channel;
+      }
+    }
+  }
+}
+
 }  // namespace
 
 template <typename SourceType>
@@ -177,15 +276,33 @@ struct TIFFReadObject<SourceType>::Impl
     close();
 
     ss = impl::tiff::SourceStruct{&source};
-    tif = TIFFClientOpen("", "rm",
-                         reinterpret_cast<thandle_t>(&ss),
-                         impl::tiff::r_read_func<SourceType>,
-                         impl::tiff::r_write_func<SourceType>,
-                         impl::tiff::r_seek_func<SourceType>,
-                         impl::tiff::r_close_func<SourceType>,
-                         impl::tiff::r_size_func<SourceType>,
-                         nullptr, nullptr);
-    SELENE_ASSERT(tif != nullptr);
+
+    if constexpr (std::is_same_v<SourceType, MmapReader>)
+    {
+      // Let libtiff access the mapped file contents directly, instead of copying them through the read function.
+      tif = TIFFClientOpen("", "r",
+                           reinterpret_cast<thandle_t>(&ss),
+                           impl::tiff::r_read_func<SourceType>,
+                           impl::tiff::r_write_func<SourceType>,
+                           impl::tiff::r_seek_func<SourceType>,
+                           impl::tiff::r_close_func<SourceType>,
+                           impl::tiff::r_size_func<SourceType>,
+                           impl::tiff::r_map_memory_func<SourceType>,
+                           impl::tiff::r_unmap_func<SourceType>);
+    }
+    else
+    {
+      tif = TIFFClientOpen("", "rm",
+                           reinterpret_cast<thandle_t>(&ss),
+                           impl::tiff::r_read_func<SourceType>,
+                           impl::tiff::r_write_func<SourceType>,
+                           impl::tiff::r_seek_func<SourceType>,
+                           impl::tiff::r_close_func<SourceType>,
+                           impl::tiff::r_size_func<SourceType>,
+                           nullptr, nullptr);
+    }
+
+    // A null handle (e.g. if the source does not contain TIFF data) is reported to the caller by open()
   }
 
   void open_read(SourceType&& source)
@@ -198,6 +315,7 @@ struct TIFFReadObject<SourceType>::Impl
     if (tif != nullptr)
     {
       TIFFClose(tif);
+      tif = nullptr;
     }
   }
 };
@@ -256,9 +374,23 @@ bool TIFFReadObject<SourceType>::set_directory(std::uint16_t index)
   return (TIFFSetDirectory(impl_->tif, index) == 1);
 }
 
+// Unlike set_directory(), this does not walk the directory chain from the beginning of the file.
+template <typename SourceType>
+bool TIFFReadObject<SourceType>::set_directory_offset(std::uint64_t offset)
+{
+  if (impl_->tif == nullptr)
+  {
+    return false;
+  }
+
+  return (TIFFSetSubDirectory(impl_->tif, static_cast<toff_t>(offset)) == 1);
+}
+
 // Explicit instantiations:
 template class TIFFReadObject<FileReader>;
 template class TIFFReadObject<MemoryReader>;
+template class TIFFReadObject<MmapReader>;
+template class TIFFReadObject<AsyncFileReader>;
 
 
 namespace impl {
@@ -306,6 +438,46 @@ bool tiff_read_current_directory(TIFFReadObject<SourceType>& tiff_obj,
   return read_successfully;
 }
 
+template <typename SourceType>
+bool tiff_read_current_directory_planes(TIFFReadObject<SourceType>& tiff_obj,
+                                        MessageLog& message_log,
+                                        const std::vector<MutableDynImageView>& planes)
+{
+  auto tif = tiff_obj.impl_->tif;
+  const auto layout = get_tiff_layout(tif);
+
+  if (!check_suitability(layout, message_log) || !check_planes(layout, planes, message_log))
+  {
+    return false;
+  }
+
+  // Separately stored samples are read directly into the respective planes; this is not possible for data that
+  // needs to be converted first (YCbCr, Lab, or sub-byte samples).
+  const bool read_directly = layout.planar_config == TIFFPlanarConfig::Separate && layout.bits_per_sample >= 8
+                             && !layout.is_format_ycbcr() && !layout.is_format_lab();
+
+  if (!read_directly)
+  {
+    DynImage<> dyn_img;
+    if (!tiff_read_current_directory(tiff_obj, message_log, dyn_img))
+    {
+      return false;
+    }
+
+    split_into_planes(dyn_img.constant_view(), planes);
+    return true;
+  }
+
+  const auto& cs = get_tiff_color_conversion_structures(tif);
+
+  if (TIFFIsTiled(tif) == 0)
+  {
+    return impl::read_data_strips_into_planes(tif, layout, cs.ycbcr_info, cs.ycbcr_converter, cs.lab_converter, planes, message_log);
+  }
+
+  return impl::read_data_tiles_into_planes(tif, layout, cs.ycbcr_info, cs.ycbcr_converter, cs.lab_converter, planes, message_log);
+}
+
 // Explicit instantiations:
 template bool tiff_read_current_directory(TIFFReadObject<FileReader>&, MessageLog&, DynImage<>&);
 template bool tiff_read_current_directory(TIFFReadObject<FileReader>&, MessageLog&, MutableDynImageView&);
@@ -313,6 +485,17 @@ template bool tiff_read_current_directory(TIFFReadObject<FileReader>&, MessageLo
 template bool tiff_read_current_directory(TIFFReadObject<MemoryReader>&, MessageLog&, DynImage<>&);
 template bool tiff_read_current_directory(TIFFReadObject<MemoryReader>&, MessageLog&, MutableDynImageView&);
 
+template bool tiff_read_current_directory(TIFFReadObject<MmapReader>&, MessageLog&, DynImage<>&);
+template bool tiff_read_current_directory(TIFFReadObject<MmapReader>&, MessageLog&, MutableDynImageView&);
+
+template bool tiff_read_current_directory(TIFFReadObject<AsyncFileReader>&, MessageLog&, DynImage<>&);
+template bool tiff_read_current_directory(TIFFReadObject<AsyncFileReader>&, MessageLog&, MutableDynImageView&);
+
+template bool tiff_read_current_directory_planes(TIFFReadObject<FileReader>&, MessageLog&, const std::vector<MutableDynImageView>&);
+template bool tiff_read_current_directory_planes(TIFFReadObject<MemoryReader>&, MessageLog&, const std::vector<MutableDynImageView>&);
+template bool tiff_read_current_directory_planes(TIFFReadObject<MmapReader>&, MessageLog&, const std::vector<MutableDynImageView>&);
+template bool tiff_read_current_directory_planes(TIFFReadObject<AsyncFileReader>&, MessageLog&, const std::vector<MutableDynImageView>&);
+
 }  // namespace impl
 
 }  // namespace sln
@@ -15,9 +15,16 @@
 
 #include <selene/img/dynamic/DynImage.hpp>
 
+#include <selene/img/interop/ImageToDynImage.hpp>
+
+#include <selene/img/typed/PlanarImage.hpp>
+
 #include <selene/img_io/tiff/Common.hpp>
 
+#include <algorithm>
+#include <cstddef>
 #include <memory>
+#include <string>
 #include <vector>
 
 namespace sln {
@@ -43,12 +50,23 @@ std::vector<DynImage<Allocator>> read_tiff_all(SourceType&&,
                                                MessageLog* = nullptr,
                                                TIFFReadObject<std::remove_reference_t<SourceType>>* = nullptr);
 
+template <typename T, std::size_t N, typename Allocator = default_bytes_allocator, typename SourceType>
+PlanarImage<T, N, Allocator> read_tiff_planar(SourceType&&,
+                                              MessageLog* = nullptr,
+                                              TIFFReadObject<std::remove_reference_t<SourceType>>* = nullptr);
 
 namespace impl {
+class TIFFPageReader;
+
 template <typename SourceType, typename DynImageOrView>
     [[nodiscard]] bool tiff_read_current_directory(TIFFReadObject<SourceType>& tiff_obj,
                                                    MessageLog& message_log,
                                                    DynImageOrView& dyn_img_or_view);
+
+template <typename SourceType>
+    [[nodiscard]] bool tiff_read_current_directory_planes(TIFFReadObject<SourceType>& tiff_obj,
+                                                          MessageLog& message_log,
+                                                          const std::vector<MutableDynImageView>& planes);
 }  // namespace impl
 
 /** \brief Opaque TIFF reading object, holding internal state.
@@ -75,14 +93,19 @@ private:
   TiffImageLayout get_layout();
   bool advance_directory();
   bool set_directory(std::uint16_t index);
+  bool set_directory_offset(std::uint64_t offset);
 
   template <typename SourceType2> friend std::vector<TiffImageLayout> read_tiff_layouts(SourceType2&&, MessageLog*, TIFFReadObject<std::remove_reference_t<SourceType2>>*);
   template <typename Allocator, typename SourceType2> friend DynImage<Allocator> read_tiff(SourceType2&&, MessageLog*, TIFFReadObject<std::remove_reference_t<SourceType2>>*);
   template <typename Allocator, typename SourceType2> friend std::vector<DynImage<Allocator>> read_tiff_all(SourceType2&&, MessageLog*, TIFFReadObject<std::remove_reference_t<SourceType2>>*);
 
+  template <typename T, std::size_t N, typename Allocator, typename SourceType2> friend PlanarImage<T, N, Allocator> read_tiff_planar(SourceType2&&, MessageLog*, TIFFReadObject<std::remove_reference_t<SourceType2>>*);
+
   template <typename SourceType2, typename DynImageOrView> friend bool impl::tiff_read_current_directory(TIFFReadObject<SourceType2>&, MessageLog&, DynImageOrView&);
+  template <typename SourceType2> friend bool impl::tiff_read_current_directory_planes(TIFFReadObject<SourceType2>&, MessageLog&, const std::vector<MutableDynImageView>&);
 
   friend class TIFFReader<SourceType>;
+  friend class impl::TIFFPageReader;
 };
 
 /** \brief Class with functionality to read header and data of a TIFF image data stream.
@@ -101,7 +124,7 @@ private:
  * image; there is no guarantee that after reading image data, the stream pointer will point past the end of the TIFF
  * file.
  *
- * @tparam SourceType Type of the input source. Can be FileReader or MemoryReader.
+ * @tparam SourceType Type of the input source. Can be FileReader, MemoryReader, MmapReader, or AsyncFileReader.
  */
 template <typename SourceType>
 class TIFFReader
@@ -143,7 +166,7 @@ private:
  *
  * After reading, the source position will point to the beginning of the TIFF data stream.
  *
- * @tparam SourceType Type of the input source. Can be FileReader or MemoryReader.
+ * @tparam SourceType Type of the input source. Can be FileReader, MemoryReader, MmapReader, or AsyncFileReader.
  * @param source Input source instance.
  * @param messages Optional pointer to the message log. If provided, warning and error messages will be output there.
  * @param tiff_object Optional TIFFReadObject instance, which can be explicitly instantiated outside of this function.
@@ -187,7 +210,7 @@ std::vector<TiffImageLayout> read_tiff_layouts(SourceType&& source, MessageLog*
  *
  * After reading, the source position may *not* point past the end of the TIFF data stream.
  *
- * @tparam SourceType Type of the input source. Can be FileReader or MemoryReader.
+ * @tparam SourceType Type of the input source. Can be FileReader, MemoryReader, MmapReader, or AsyncFileReader.
  * @param source Input source instance.
  * @param messages Optional pointer to the message log. If provided, warning and error messages will be output there.
  * @param tiff_object Optional TIFFReadObject instance, which can be explicitly instantiated outside of this function.
@@ -229,7 +252,7 @@ DynImage<Allocator> read_tiff(SourceType&& source,
  *
  * After reading, the source position may *not* point past the end of the TIFF data stream.
  *
- * @tparam SourceType Type of the input source. Can be FileReader or MemoryReader.
+ * @tparam SourceType Type of the input source. Can be FileReader, MemoryReader, MmapReader, or AsyncFileReader.
  * @param source Input source instance.
  * @param messages Optional pointer to the message log. If provided, warning and error messages will be output there.
  * @param tiff_object Optional TIFFReadObject instance, which can be explicitly instantiated outside of this function.
@@ -269,11 +292,84 @@ std::vector<DynImage<Allocator>> read_tiff_all(SourceType&& source,
   return images;
 }
 
+/** \brief Read the first TIFF image within a file into a planar image, with one plane per sample (channel).
+ *
+ * If the TIFF image data is stored separately per sample (i.e. planar), each sample is read directly into the
+ * respective plane, without going through an interleaved representation. Otherwise, the image data is read
+ * interleaved, and subsequently split into planes.
+ *
+ * The number of samples per pixel in the TIFF image has to be equal to `N`, and the number of bytes per sample has to
+ * be equal to `sizeof(T)`. Otherwise, an error message is added to the message log, and an invalid planar image is
+ * returned.
+ *
+ * After reading, the source position may *not* point past the end of the TIFF data stream.
+ *
+ * @tparam T The element type of each plane.
+ * @tparam N The number of planes, i.e. channels.
+ * @tparam SourceType Type of the input source. Can be FileReader, MemoryReader, MmapReader, or AsyncFileReader.
+ * @param source Input source instance.
+ * @param messages Optional pointer to the message log. If provided, warning and error messages will be output there.
+ * @param tiff_object Optional TIFFReadObject instance, which can be explicitly instantiated outside of this function.
+ * Providing this may save internal memory (de)allocations.
+ * @return The read planar TIFF image from the data stream/file. In case the image could not be read successfully, it
+ * will not be valid (i.e. `is_valid() == false`).
+ */
+template <typename T, std::size_t N, typename Allocator, typename SourceType>
+PlanarImage<T, N, Allocator> read_tiff_planar(SourceType&& source,
+                                              MessageLog* message_log,
+                                              TIFFReadObject<std::remove_reference_t<SourceType>>* tiff_object)
+{
+  impl::tiff_set_handlers();
+  TIFFReadObject<std::remove_reference_t<SourceType>> local_tiff_object;
+  TIFFReadObject<std::remove_reference_t<SourceType>>* obj = tiff_object ? tiff_object : &local_tiff_object;
+
+  MessageLog local_message_log;
+
+  SELENE_ASSERT(source.is_open());
+
+  if (!obj->open(std::forward<SourceType>(source)))
+  {
+    local_message_log.add("Data stream could not be opened.", MessageType::Error);
+    impl::tiff_assign_message_log(local_message_log, message_log);
+    return PlanarImage<T, N, Allocator>{};
+  }
+
+  const auto layout = obj->get_layout();
+  const auto nr_bytes_per_sample = std::max(std::size_t{1}, std::size_t{layout.bits_per_sample} / 8);
+
+  if (layout.samples_per_pixel != N || nr_bytes_per_sample != sizeof(T))
+  {
+    local_message_log.add("TIFF reader: Image layout does not match planar image type (samples per pixel: "
+                          + std::to_string(layout.samples_per_pixel) + ", bits per sample: "
+                          + std::to_string(layout.bits_per_sample) + ").", MessageType::Error);
+    impl::tiff_assign_message_log(local_message_log, message_log);
+    return PlanarImage<T, N, Allocator>{};
+  }
+
+  PlanarImage<T, N, Allocator> planar({to_pixel_length(layout.width), to_pixel_length(layout.height)});
+
+  std::vector<MutableDynImageView> planes;
+  planes.reserve(N);
+
+  for (std::size_t c = 0; c < N; ++c)
+  {
+    planes.push_back(to_dyn_image_view(planar.plane(c), PixelFormat::Y));
+  }
+
+  if (!impl::tiff_read_current_directory_planes(*obj, local_message_log, planes))
+  {
+    planar.clear();
+  }
+
+  impl::tiff_assign_message_log(local_message_log, message_log);
+  return planar;
+}
+
 // -----
 
 /** \brief Constructs a TIFFReader instance with the given data stream source.
  *
- * @tparam SourceType Type of the input source. Can be FileReader or MemoryReader.
+ * @tparam SourceType Type of the input source. Can be FileReader, MemoryReader, MmapReader, or AsyncFileReader.
  * @param source Input source instance.
  */
 template <typename SourceType>
@@ -286,7 +382,7 @@ TIFFReader<SourceType>::TIFFReader(SourceType& source)
 
 /** \brief Sets an input source stream.
  *
- * @tparam SourceType Type of the input source. Can be FileReader or MemoryReader.
+ * @tparam SourceType Type of the input source. Can be FileReader, MemoryReader, MmapReader, or AsyncFileReader.
  * @param source Input source instance.
  */
 template <typename SourceType>
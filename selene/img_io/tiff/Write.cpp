@@ -11,6 +11,7 @@
 
 #include <selene/base/Assert.hpp>
 #include <selene/base/_impl/Utils.hpp>
+#include <selene/base/io/BufferedFileWriter.hpp>
 #include <selene/base/io/FileWriter.hpp>
 #include <selene/base/io/VectorWriter.hpp>
 
@@ -20,7 +21,10 @@
 #include <selene/img_io/tiff/_impl/TIFFDetail.hpp>
 #include <selene/img_io/tiff/_impl/TIFFIOFunctions.hpp>
 
+#include <algorithm>
 #include <array>
+#include <cstdint>
+#include <cstring>
 #include <ctime>
 #include <string>
 #include <type_traits>
@@ -32,27 +36,31 @@ namespace sln {
 
 namespace {
 
-void set_tiff_layout(TIFF* tif, const ConstantDynImageView& view, const TIFFWriteOptions& write_options)
+void set_tiff_layout(TIFF* tif,
+                     const UntypedLayout& layout,
+                     const UntypedImageSemantics& semantics,
+                     const TIFFWriteOptions& write_options,
+                     TIFFPlanarConfig planar_config = TIFFPlanarConfig::Contiguous)
 {
   using impl::tiff::set_field;
   using impl::tiff::set_string_field;
-  set_field<uint32>(tif, TIFFTAG_IMAGEWIDTH, static_cast<uint32>(view.width()));
-  set_field<uint32>(tif, TIFFTAG_IMAGELENGTH, static_cast<uint32>(view.height()));
+  set_field<uint32>(tif, TIFFTAG_IMAGEWIDTH, static_cast<uint32>(layout.width));
+  set_field<uint32>(tif, TIFFTAG_IMAGELENGTH, static_cast<uint32>(layout.height));
   set_field<uint32>(tif, TIFFTAG_IMAGEDEPTH, uint32{1});
 
-  set_field<uint16>(tif, TIFFTAG_SAMPLESPERPIXEL, static_cast<uint16>(view.nr_channels()));
-  set_field<uint16>(tif, TIFFTAG_BITSPERSAMPLE, static_cast<uint16>(view.nr_bytes_per_channel() * 8));
-  set_field<uint16>(tif, TIFFTAG_PHOTOMETRIC, impl::tiff::pixel_format_to_photometric(view.pixel_format()));
-  set_field<uint16>(tif, TIFFTAG_SAMPLEFORMAT, impl::tiff::sample_format_to_sample_format(view.sample_format()));
+  set_field<uint16>(tif, TIFFTAG_SAMPLESPERPIXEL, static_cast<uint16>(layout.nr_channels));
+  set_field<uint16>(tif, TIFFTAG_BITSPERSAMPLE, static_cast<uint16>(layout.nr_bytes_per_channel * 8));
+  set_field<uint16>(tif, TIFFTAG_PHOTOMETRIC, impl::tiff::pixel_format_to_photometric(semantics.pixel_format));
+  set_field<uint16>(tif, TIFFTAG_SAMPLEFORMAT, impl::tiff::sample_format_to_sample_format(semantics.sample_format));
 
-  if (view.pixel_format() == PixelFormat::RGBA)
+  if (semantics.pixel_format == PixelFormat::RGBA)
   {
     // We need to specify the extra sample.
     std::array<uint16, 1> extra_sample_types = {{EXTRASAMPLE_ASSOCALPHA}};
     set_field<uint16>(tif, TIFFTAG_EXTRASAMPLES, 1, extra_sample_types.data());
   }
 
-  set_field<uint16>(tif, TIFFTAG_PLANARCONFIG, PLANARCONFIG_CONTIG);  // we only write interleaved data
+  set_field<uint16>(tif, TIFFTAG_PLANARCONFIG, impl::tiff::planar_config_pub_to_lib(planar_config));
   set_field<uint16>(tif, TIFFTAG_ORIENTATION, ORIENTATION_TOPLEFT);
 
   set_field<uint16>(tif, TIFFTAG_COMPRESSION, impl::tiff::compression_pub_to_lib(write_options.compression_type));
@@ -81,7 +89,7 @@ void set_tiff_layout_tiles(TIFF* tif, std::size_t tile_width, std::size_t tile_h
   set_field<uint32>(tif, TIFFTAG_TILEDEPTH, uint32{1});
 }
 
-bool check_tiff_tile_size(TIFF* tif, const ConstantDynImageView& /*view*/, TIFFWriteOptions& opts, MessageLog& /*message_log*/)
+bool check_tiff_tile_size(TIFF* tif, TIFFWriteOptions& opts)
 {
   auto tw = static_cast<uint32>(opts.tile_width);
   auto th = static_cast<uint32>(opts.tile_height);
@@ -92,6 +100,99 @@ bool check_tiff_tile_size(TIFF* tif, const ConstantDynImageView& /*view*/, TIFFW
   return true;
 }
 
+template <typename T>
+inline T average_of_four(T a, T b, T c, T d)
+{
+  if constexpr (std::is_floating_point_v<T>)
+  {
+    return (a + b + c + d) * T(0.25);
+  }
+  else if constexpr (std::is_unsigned_v<T>)
+  {
+    const auto sum = std::uint64_t{a} + std::uint64_t{b} + std::uint64_t{c} + std::uint64_t{d};
+    return static_cast<T>((sum + 2) / 4);
+  }
+  else
+  {
+    const auto sum = std::int64_t{a} + std::int64_t{b} + std::int64_t{c} + std::int64_t{d};
+    return static_cast<T>(sum >= 0 ? (sum + 2) / 4 : -((-sum + 2) / 4));
+  }
+}
+
+// Reduces `src` to half its resolution by averaging blocks of 2x2 pixels, and writes the result to `dst`, starting at
+// row `dst_y`. If the width or height of `src` is odd, its last column or row is replicated.
+template <typename T>
+void reduce_by_two_typed(const ConstantDynImageView& src, DynImage<>& dst, std::ptrdiff_t dst_y)
+{
+  const auto nr_channels = static_cast<std::ptrdiff_t>(src.nr_channels());
+  const auto src_width = static_cast<std::ptrdiff_t>(src.width());
+  const auto src_height = static_cast<std::ptrdiff_t>(src.height());
+
+  for (std::ptrdiff_t y = 0; y < src_height; y += 2)
+  {
+    const auto row0 = reinterpret_cast<const T*>(src.byte_ptr(to_pixel_index(y)));
+    const auto row1 = reinterpret_cast<const T*>(src.byte_ptr(to_pixel_index(std::min(y + 1, src_height - 1))));
+    auto dst_row = reinterpret_cast<T*>(dst.byte_ptr(to_pixel_index(dst_y + y / 2)));
+
+    for (std::ptrdiff_t x = 0; x < src_width; x += 2)
+    {
+      const auto i0 = x * nr_channels;
+      const auto i1 = std::min(x + 1, src_width - 1) * nr_channels;
+      auto dst_px = dst_row + (x / 2) * nr_channels;
+
+      for (std::ptrdiff_t c = 0; c < nr_channels; ++c)
+      {
+        dst_px[c] = average_of_four(row0[i0 + c], row0[i1 + c], row1[i0 + c], row1[i1 + c]);
+      }
+    }
+  }
+}
+
+template <typename Func>
+bool dispatch_sample_type(std::int16_t nr_bytes_per_channel, SampleFormat sample_format, Func func)
+{
+  switch (sample_format)
+  {
+    case SampleFormat::FloatingPoint:
+      switch (nr_bytes_per_channel)
+      {
+        case 4: func(float{}); return true;
+        case 8: func(double{}); return true;
+        default: return false;
+      }
+    case SampleFormat::SignedInteger:
+      switch (nr_bytes_per_channel)
+      {
+        case 1: func(std::int8_t{}); return true;
+        case 2: func(std::int16_t{}); return true;
+        case 4: func(std::int32_t{}); return true;
+        default: return false;
+      }
+    default:
+      switch (nr_bytes_per_channel)
+      {
+        case 1: func(std::uint8_t{}); return true;
+        case 2: func(std::uint16_t{}); return true;
+        case 4: func(std::uint32_t{}); return true;
+        default: return false;
+      }
+  }
+}
+
+bool can_reduce_by_two(const UntypedLayout& layout, const UntypedImageSemantics& semantics)
+{
+  return dispatch_sample_type(layout.nr_bytes_per_channel, semantics.sample_format, [](auto) {});
+}
+
+void reduce_by_two(const ConstantDynImageView& src, DynImage<>& dst, std::ptrdiff_t dst_y)
+{
+  [[maybe_unused]] const bool reduced = dispatch_sample_type(src.nr_bytes_per_channel(), src.sample_format(),
+                                                             [&](auto sample) {
+    reduce_by_two_typed<decltype(sample)>(src, dst, dst_y);
+  });
+  SELENE_ASSERT(reduced);
+}
+
 }  // namespace
 
 template <typename SinkType>
@@ -188,22 +289,25 @@ void TIFFWriteObject<SinkType>::close()
 
 // Explicit instantiations:
 template class TIFFWriteObject<FileWriter>;
+template class TIFFWriteObject<BufferedFileWriter>;
 template class TIFFWriteObject<VectorWriter>;
 
 
 namespace impl {
 
-bool tiff_write_to_current_directory_strips(TIFF* tif, const TIFFWriteOptions& write_options, MessageLog& /*message_log*/, const ConstantDynImageView& view)
+std::size_t tiff_nr_rows_per_strip(const TIFFWriteOptions& write_options, std::size_t row_size_bytes)
+{
+  // For JPEG compression, the nr of rows per strip must be a multiple of 8.
+  const auto nrps = std::size_t(write_options.max_bytes_per_strip / row_size_bytes);
+  return std::min(write_options.nr_rows_per_strip, std::max(std::size_t{8}, nrps - (nrps % 8)));
+}
+
+// Writes the strips of the given sample (plane), which are taken from `view`. In case of separately stored samples,
+// `view` contains only the respective sample; otherwise, it contains the interleaved image data (and `sample == 0`).
+bool tiff_write_strips(TIFF* tif, std::size_t nr_rows_per_strip, const ConstantDynImageView& view, uint16 sample)
 {
   const auto height = view.height();
   const auto row_size_bytes = to_unsigned(view.row_bytes());
-  const auto nr_rows_per_strip = [&write_options, row_size_bytes]() {
-    // For JPEG compression, the nr of rows per strip must be a multiple of 8.
-    const auto nrps = std::size_t(write_options.max_bytes_per_strip / row_size_bytes);
-    return std::min(write_options.nr_rows_per_strip, std::max(std::size_t{8}, nrps - (nrps % 8)));
-  }();
-
-  set_tiff_layout_strips(tif, nr_rows_per_strip);
 
   const auto nr_strips = std::size_t{to_unsigned(height) / nr_rows_per_strip + ((to_unsigned(height) % nr_rows_per_strip > 0) ? 1 : 0)};
   const auto rows_in_last_strip = (to_unsigned(height) % nr_rows_per_strip > 0) ? (to_unsigned(height) % nr_rows_per_strip) : (nr_rows_per_strip);
@@ -242,8 +346,8 @@ bool tiff_write_to_current_directory_strips(TIFF* tif, const TIFFWriteOptions& w
       return buffer.data();
     }();
 
-    tstrip_t strip = TIFFComputeStrip(tif, static_cast<uint32>(cur_row), 0);
-    SELENE_ASSERT(static_cast<std::size_t>(strip) == strip_idx);
+    tstrip_t strip = TIFFComputeStrip(tif, static_cast<uint32>(cur_row), sample);
+    SELENE_ASSERT(static_cast<std::size_t>(strip) == strip_idx + sample * nr_strips);
 
     auto size_written = TIFFWriteEncodedStrip(tif, strip, const_cast<void*>(static_cast<const void*>(buf_ptr)), buf_size);
 
@@ -256,13 +360,26 @@ bool tiff_write_to_current_directory_strips(TIFF* tif, const TIFFWriteOptions& w
   return true;
 }
 
-bool tiff_write_to_current_directory_tiles(TIFF* tif, const TIFFWriteOptions& write_options, MessageLog& message_log, const ConstantDynImageView& view)
+bool tiff_write_to_current_directory_strips(TIFF* tif, const TIFFWriteOptions& write_options, MessageLog& /*message_log*/, const ConstantDynImageView& view)
 {
-  using value_type = PixelIndex::value_type;
+  const auto nr_rows_per_strip = tiff_nr_rows_per_strip(write_options, to_unsigned(view.row_bytes()));
+  set_tiff_layout_strips(tif, nr_rows_per_strip);
+  return tiff_write_strips(tif, nr_rows_per_strip, view, 0);
+}
 
-  const auto tile_width = write_options.tile_width;
-  const auto tile_height = write_options.tile_height;
-  set_tiff_layout_tiles(tif, tile_width, tile_height);
+// Writes the tiles covering `view`, whose first row is located at row `view_y` of the image in the current directory.
+// `view_y` has to be a multiple of the tile height. In case of separately stored samples, `view` contains only the
+// given sample (plane).
+bool tiff_write_tiles(TIFF* tif,
+                      std::size_t tile_width,
+                      std::size_t tile_height,
+                      MessageLog& message_log,
+                      const ConstantDynImageView& view,
+                      std::size_t view_y,
+                      uint16 sample = 0)
+{
+  using value_type = PixelIndex::value_type;
+  SELENE_ASSERT(view_y % tile_height == 0);
 
   const auto width = static_cast<value_type>(view.width());
   const auto height = static_cast<value_type>(view.height());
@@ -272,14 +389,13 @@ bool tiff_write_to_current_directory_tiles(TIFF* tif, const TIFFWriteOptions& wr
   std::vector<std::uint8_t> buffer(tile_width * tile_height * to_unsigned(nr_bytes_per_pixel));
 
   // For each tile...
-  uint32 tile_ctr = 0;
+  uint32 tile_ctr = TIFFComputeTile(tif, uint32{0}, static_cast<uint32>(view_y), uint32{0}, sample);
   for (auto src_y = 0_idx; src_y < height; src_y += to_pixel_index(tile_height))
   {
     for (auto src_x = 0_idx; src_x < width; src_x += to_pixel_index(tile_width))
     {
       const auto x = static_cast<uint32>(src_x);
-      const auto y = static_cast<uint32>(src_y);
-      uint16 sample = 0;
+      const auto y = static_cast<uint32>(static_cast<std::size_t>(src_y) + view_y);
       const auto tile_idx = TIFFComputeTile(tif, x, y, uint32{0}, sample);
       SELENE_ASSERT(tile_idx == tile_ctr); // ???
 
@@ -316,6 +432,12 @@ bool tiff_write_to_current_directory_tiles(TIFF* tif, const TIFFWriteOptions& wr
   return true;
 }
 
+bool tiff_write_to_current_directory_tiles(TIFF* tif, const TIFFWriteOptions& write_options, MessageLog& message_log, const ConstantDynImageView& view)
+{
+  set_tiff_layout_tiles(tif, write_options.tile_width, write_options.tile_height);
+  return tiff_write_tiles(tif, write_options.tile_width, write_options.tile_height, message_log, view, 0);
+}
+
 template <typename SinkType, typename DynImageOrView>
 bool tiff_write_to_current_directory(TIFFWriteObject<SinkType>& tiff_obj,
                                      const TIFFWriteOptions& write_options,
@@ -326,7 +448,7 @@ bool tiff_write_to_current_directory(TIFFWriteObject<SinkType>& tiff_obj,
   auto tif = tiff_obj.impl_->tif;
   const auto view = dyn_img_or_view.constant_view();
 
-  set_tiff_layout(tif, view, write_options);
+  set_tiff_layout(tif, view.layout(), view.semantics(), write_options);
 
   if (directory_index >= 0)
   {
@@ -344,7 +466,7 @@ bool tiff_write_to_current_directory(TIFFWriteObject<SinkType>& tiff_obj,
   else
   {
     TIFFWriteOptions local_write_options = write_options;
-    const bool size_ok = check_tiff_tile_size(tif, view, local_write_options, message_log);
+    const bool size_ok = check_tiff_tile_size(tif, local_write_options);
 
     if (!size_ok)
     {
@@ -355,17 +477,395 @@ bool tiff_write_to_current_directory(TIFFWriteObject<SinkType>& tiff_obj,
   }
 }
 
+template <typename SinkType>
+bool tiff_write_planes_to_current_directory(TIFFWriteObject<SinkType>& tiff_obj,
+                                            const TIFFWriteOptions& write_options,
+                                            MessageLog& message_log,
+                                            const std::vector<ConstantDynImageView>& planes,
+                                            const UntypedImageSemantics& semantics)
+{
+  auto tif = tiff_obj.impl_->tif;
+
+  if (planes.empty())
+  {
+    message_log.add("TIFF writer: No planes supplied.", MessageType::Error);
+    return false;
+  }
+
+  const auto& plane_layout = planes.front().layout();
+
+  for (const auto& plane : planes)
+  {
+    if (plane.width() != plane_layout.width || plane.height() != plane_layout.height || plane.nr_channels() != 1
+        || plane.nr_bytes_per_channel() != plane_layout.nr_bytes_per_channel)
+    {
+      message_log.add("TIFF writer: Planes have to be single-channel, and of the same layout.", MessageType::Error);
+      return false;
+    }
+  }
+
+  const auto layout = UntypedLayout{plane_layout.width, plane_layout.height,
+                                    static_cast<std::int16_t>(planes.size()), plane_layout.nr_bytes_per_channel};
+  set_tiff_layout(tif, layout, semantics, write_options, TIFFPlanarConfig::Separate);
+
+  if (write_options.layout == TIFFWriteOptions::Layout::Strips)
+  {
+    const auto nr_rows_per_strip = tiff_nr_rows_per_strip(write_options, to_unsigned(planes.front().row_bytes()));
+    set_tiff_layout_strips(tif, nr_rows_per_strip);
+
+    for (std::size_t sample = 0; sample < planes.size(); ++sample)
+    {
+      if (!tiff_write_strips(tif, nr_rows_per_strip, planes[sample], static_cast<uint16>(sample)))
+      {
+        return false;
+      }
+    }
+
+    return true;
+  }
+  else
+  {
+    TIFFWriteOptions local_write_options = write_options;
+    const bool size_ok = check_tiff_tile_size(tif, local_write_options);
+
+    if (!size_ok)
+    {
+      return false;
+    }
+
+    set_tiff_layout_tiles(tif, local_write_options.tile_width, local_write_options.tile_height);
+
+    for (std::size_t sample = 0; sample < planes.size(); ++sample)
+    {
+      if (!tiff_write_tiles(tif, local_write_options.tile_width, local_write_options.tile_height, message_log,
+                            planes[sample], 0, static_cast<uint16>(sample)))
+      {
+        return false;
+      }
+    }
+
+    return true;
+  }
+}
+
 // Explicit instantiations:
 template bool tiff_write_to_current_directory(TIFFWriteObject<FileWriter>&, const TIFFWriteOptions&, MessageLog&, const DynImage<>&, std::ptrdiff_t);
 template bool tiff_write_to_current_directory(TIFFWriteObject<FileWriter>&, const TIFFWriteOptions&, MessageLog&, const ConstantDynImageView&, std::ptrdiff_t);
 template bool tiff_write_to_current_directory(TIFFWriteObject<FileWriter>&, const TIFFWriteOptions&, MessageLog&, const MutableDynImageView&, std::ptrdiff_t);
 
+template bool tiff_write_to_current_directory(TIFFWriteObject<BufferedFileWriter>&, const TIFFWriteOptions&, MessageLog&, const DynImage<>&, std::ptrdiff_t);
+template bool tiff_write_to_current_directory(TIFFWriteObject<BufferedFileWriter>&, const TIFFWriteOptions&, MessageLog&, const ConstantDynImageView&, std::ptrdiff_t);
+template bool tiff_write_to_current_directory(TIFFWriteObject<BufferedFileWriter>&, const TIFFWriteOptions&, MessageLog&, const MutableDynImageView&, std::ptrdiff_t);
+
 template bool tiff_write_to_current_directory(TIFFWriteObject<VectorWriter>&, const TIFFWriteOptions&, MessageLog&, const DynImage<>&, std::ptrdiff_t);
 template bool tiff_write_to_current_directory(TIFFWriteObject<VectorWriter>&, const TIFFWriteOptions&, MessageLog&, const ConstantDynImageView&, std::ptrdiff_t);
 template bool tiff_write_to_current_directory(TIFFWriteObject<VectorWriter>&, const TIFFWriteOptions&, MessageLog&, const MutableDynImageView&, std::ptrdiff_t);
 
+template bool tiff_write_planes_to_current_directory(TIFFWriteObject<FileWriter>&, const TIFFWriteOptions&, MessageLog&, const std::vector<ConstantDynImageView>&, const UntypedImageSemantics&);
+template bool tiff_write_planes_to_current_directory(TIFFWriteObject<BufferedFileWriter>&, const TIFFWriteOptions&, MessageLog&, const std::vector<ConstantDynImageView>&, const UntypedImageSemantics&);
+template bool tiff_write_planes_to_current_directory(TIFFWriteObject<VectorWriter>&, const TIFFWriteOptions&, MessageLog&, const std::vector<ConstantDynImageView>&, const UntypedImageSemantics&);
+
 }  // namespace impl
 
+// -----
+
+/** \brief Default constructor. The writer has to be opened via `open()` before writing rows.
+ *
+ * @tparam SinkType Type of the output sink. Can be FileWriter, BufferedFileWriter, or VectorWriter.
+ */
+template <typename SinkType>
+TIFFPyramidWriter<SinkType>::TIFFPyramidWriter() = default;
+
+/** \brief Constructs a TIFFPyramidWriter instance, and opens it for writing an image of the given layout to `sink`.
+ *
+ * @tparam SinkType Type of the output sink. Can be FileWriter, BufferedFileWriter, or VectorWriter.
+ * @param sink Output sink instance.
+ * @param layout The layout of the full-resolution image. Any specified row stride is ignored.
+ * @param semantics The pixel semantics of the full-resolution image.
+ * @param options Options for writing the pyramidal TIFF image.
+ */
+template <typename SinkType>
+TIFFPyramidWriter<SinkType>::TIFFPyramidWriter(SinkType& sink,
+                                               const UntypedLayout& layout,
+                                               const UntypedImageSemantics& semantics,
+                                               const TIFFPyramidOptions& options)
+{
+  open(sink, layout, semantics, options);
+}
+
+/** \brief Destructor. Calls `finish_writing()`, if the writer is still open.
+ *
+ * @tparam SinkType Type of the output sink. Can be FileWriter, BufferedFileWriter, or VectorWriter.
+ */
+template <typename SinkType>
+TIFFPyramidWriter<SinkType>::~TIFFPyramidWriter()
+{
+  if (is_open_)
+  {
+    finish_writing();
+  }
+}
+
+/** \brief Opens the writer for writing an image of the given layout to `sink`.
+ *
+ * If the writer is currently open, `finish_writing()` is called first.
+ *
+ * @tparam SinkType Type of the output sink. Can be FileWriter, BufferedFileWriter, or VectorWriter.
+ * @param sink Output sink instance.
+ * @param layout The layout of the full-resolution image. Any specified row stride is ignored.
+ * @param semantics The pixel semantics of the full-resolution image.
+ * @param options Options for writing the pyramidal TIFF image.
+ * @return True, if the writer was successfully opened; false otherwise.
+ */
+template <typename SinkType>
+bool TIFFPyramidWriter<SinkType>::open(SinkType& sink,
+                                       const UntypedLayout& layout,
+                                       const UntypedImageSemantics& semantics,
+                                       const TIFFPyramidOptions& options)
+{
+  if (is_open_)
+  {
+    finish_writing();
+  }
+
+  options_ = options;
+  options_.write_options.layout = TIFFWriteOptions::Layout::Tiles;
+  layout_ = UntypedLayout{layout.width, layout.height, layout.nr_channels, layout.nr_bytes_per_channel};
+  semantics_ = semantics;
+  band_ = DynImage<>{};
+  levels_.clear();
+  nr_band_rows_ = 0;
+  nr_rows_written_ = 0;
+  failed_ = false;
+  message_log_.clear();
+
+  if (layout_.width == 0 || layout_.height == 0 || layout_.nr_channels == 0 || layout_.nr_bytes_per_channel == 0)
+  {
+    message_log_.add("TIFF pyramid writer: ERROR: Image layout is empty.", MessageType::Error);
+    return false;
+  }
+
+  impl::tiff_set_handlers();
+
+  if (!write_object_.open(sink))
+  {
+    message_log_.add("TIFF pyramid writer: ERROR: Data stream could not be opened.", MessageType::Error);
+    return false;
+  }
+
+  auto tif = write_object_.impl_->tif;
+  auto& write_options = options_.write_options;
+  set_tiff_layout(tif, layout_, semantics_, write_options);
+
+  if (!check_tiff_tile_size(tif, write_options))
+  {
+    message_log_.add("TIFF pyramid writer: ERROR: Invalid tile size.", MessageType::Error);
+    write_object_.close();
+    return false;
+  }
+
+  set_tiff_layout_tiles(tif, write_options.tile_width, write_options.tile_height);
+
+  band_ = DynImage<>{UntypedLayout{layout_.width, to_pixel_length(write_options.tile_height), layout_.nr_channels,
+                                   layout_.nr_bytes_per_channel},
+                     semantics_};
+
+  // Allocate the reduced-resolution levels
+  auto width = static_cast<std::size_t>(layout_.width);
+  auto height = static_cast<std::size_t>(layout_.height);
+  while ((width > write_options.tile_width || height > write_options.tile_height)
+         && (options_.max_nr_levels == 0 || levels_.size() < options_.max_nr_levels))
+  {
+    width = (width + 1) / 2;
+    height = (height + 1) / 2;
+    levels_.emplace_back(
+        UntypedLayout{to_pixel_length(width), to_pixel_length(height), layout_.nr_channels, layout_.nr_bytes_per_channel},
+        semantics_);
+  }
+
+  if (!levels_.empty() && !can_reduce_by_two(layout_, semantics_))
+  {
+    message_log_.add("TIFF pyramid writer: ERROR: Sample type is not supported for generating reduced-resolution levels.",
+                     MessageType::Error);
+    write_object_.close();
+    levels_.clear();
+    band_ = DynImage<>{};
+    return false;
+  }
+
+  is_open_ = true;
+  return true;
+}
+
+/** \brief Finishes writing the pyramidal TIFF image: writes the full-resolution image directory, followed by the
+ * reduced-resolution levels, and closes the TIFF stream.
+ *
+ * All rows of the full-resolution image need to have been written before.
+ *
+ * @tparam SinkType Type of the output sink. Can be FileWriter, BufferedFileWriter, or VectorWriter.
+ * @return True, if the complete image was successfully written; false otherwise.
+ */
+template <typename SinkType>
+bool TIFFPyramidWriter<SinkType>::finish_writing()
+{
+  if (!is_open_)
+  {
+    return false;
+  }
+
+  is_open_ = false;
+  bool success = !failed_;
+
+  if (success && nr_rows_written_ != static_cast<std::size_t>(layout_.height))
+  {
+    message_log_.add("TIFF pyramid writer: ERROR: Only " + std::to_string(nr_rows_written_) + " of "
+                     + std::to_string(static_cast<std::size_t>(layout_.height)) + " rows have been written.", MessageType::Error);
+    success = false;
+  }
+
+  success = success && write_object_.write_directory();
+
+  auto tif = write_object_.impl_->tif;
+  const auto& write_options = options_.write_options;
+
+  for (std::size_t level_idx = 0; success && level_idx < levels_.size(); ++level_idx)
+  {
+    // The first level has been generated while writing the full-resolution rows
+    if (level_idx > 0)
+    {
+      reduce_by_two(levels_[level_idx - 1].constant_view(), levels_[level_idx], 0);
+    }
+
+    const auto& level = levels_[level_idx];
+    set_tiff_layout(tif, level.layout(), semantics_, write_options);
+    impl::tiff::set_field<uint32>(tif, TIFFTAG_SUBFILETYPE, FILETYPE_REDUCEDIMAGE);
+    set_tiff_layout_tiles(tif, write_options.tile_width, write_options.tile_height);
+
+    success = impl::tiff_write_tiles(tif, write_options.tile_width, write_options.tile_height, message_log_,
+                                     level.constant_view(), 0)
+              && write_object_.write_directory();
+  }
+
+  if (!success)
+  {
+    message_log_.add("TIFF pyramid writer: ERROR: Image could not be written completely.", MessageType::Error);
+  }
+
+  write_object_.close();
+  band_ = DynImage<>{};
+  levels_.clear();
+  return success;
+}
+
+/** \brief Returns the number of rows of the full-resolution image written so far.
+ *
+ * @tparam SinkType Type of the output sink. Can be FileWriter, BufferedFileWriter, or VectorWriter.
+ * @return The number of rows written so far.
+ */
+template <typename SinkType>
+std::size_t TIFFPyramidWriter<SinkType>::nr_rows_written() const noexcept
+{
+  return nr_rows_written_;
+}
+
+/** \brief Returns the number of resolution levels to be written, including the full-resolution level.
+ *
+ * @tparam SinkType Type of the output sink. Can be FileWriter, BufferedFileWriter, or VectorWriter.
+ * @return The number of resolution levels; 0, if the writer is not open.
+ */
+template <typename SinkType>
+std::size_t TIFFPyramidWriter<SinkType>::nr_levels() const noexcept
+{
+  return is_open_ ? levels_.size() + 1 : 0;
+}
+
+/** \brief Returns the internal message log, containing any warning or error messages.
+ *
+ * @tparam SinkType Type of the output sink. Can be FileWriter, BufferedFileWriter, or VectorWriter.
+ * @return The message log.
+ */
+template <typename SinkType>
+MessageLog& TIFFPyramidWriter<SinkType>::message_log()
+{
+  return message_log_;
+}
+
+template <typename SinkType>
+bool TIFFPyramidWriter<SinkType>::write_rows_view(const ConstantDynImageView& view)
+{
+  if (!is_open_ || failed_)
+  {
+    message_log_.add("TIFF pyramid writer: ERROR: Writer is not open.", MessageType::Error);
+    return false;
+  }
+
+  if (view.width() != layout_.width || view.nr_channels() != layout_.nr_channels
+      || view.nr_bytes_per_channel() != layout_.nr_bytes_per_channel)
+  {
+    message_log_.add("TIFF pyramid writer: ERROR: Row layout does not match the image layout.", MessageType::Error);
+    return false;
+  }
+
+  const auto nr_rows = static_cast<std::size_t>(view.height());
+  if (nr_rows_written_ + nr_rows > static_cast<std::size_t>(layout_.height))
+  {
+    message_log_.add("TIFF pyramid writer: ERROR: Attempting to write more rows than the image height.",
+                     MessageType::Error);
+    return false;
+  }
+
+  const auto row_bytes = static_cast<std::size_t>(layout_.row_bytes());
+  for (std::size_t y = 0; y < nr_rows; ++y)
+  {
+    std::memcpy(band_.byte_ptr(to_pixel_index(nr_band_rows_)), view.byte_ptr(to_pixel_index(y)), row_bytes);
+    ++nr_band_rows_;
+    ++nr_rows_written_;
+
+    if (nr_band_rows_ == static_cast<std::size_t>(band_.height())
+        || nr_rows_written_ == static_cast<std::size_t>(layout_.height))
+    {
+      if (!write_band())
+      {
+        failed_ = true;
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+template <typename SinkType>
+bool TIFFPyramidWriter<SinkType>::write_band()
+{
+  const auto band_y = nr_rows_written_ - nr_band_rows_;
+  const auto band_view = ConstantDynImageView{
+      band_.byte_ptr(),
+      UntypedLayout{layout_.width, to_pixel_length(nr_band_rows_), layout_.nr_channels, layout_.nr_bytes_per_channel,
+                    band_.stride_bytes()},
+      semantics_};
+  nr_band_rows_ = 0;
+
+  const auto& write_options = options_.write_options;
+  if (!impl::tiff_write_tiles(write_object_.impl_->tif, write_options.tile_width, write_options.tile_height,
+                              message_log_, band_view, band_y))
+  {
+    return false;
+  }
+
+  if (!levels_.empty())
+  {
+    reduce_by_two(band_view, levels_[0], static_cast<std::ptrdiff_t>(band_y / 2));
+  }
+
+  return true;
+}
+
+// Explicit instantiations:
+template class TIFFPyramidWriter<FileWriter>;
+template class TIFFPyramidWriter<BufferedFileWriter>;
+template class TIFFPyramidWriter<VectorWriter>;
+
 }  // namespace sln
 
 #endif  // defined(SELENE_WITH_LIBTIFF)
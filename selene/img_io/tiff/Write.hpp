@@ -17,7 +17,19 @@
 
 #include <selene/img_io/tiff/Common.hpp>
 
+#include <selene/img/dynamic/DynImage.hpp>
+#include <selene/img/dynamic/DynImageView.hpp>
+
+#include <selene/img/interop/ImageToDynImage.hpp>
+
+#include <selene/img/pixel/PixelTraits.hpp>
+
+#include <selene/img/typed/PlanarImage.hpp>
+
+#include <array>
+#include <cstddef>
 #include <memory>
+#include <vector>
 
 namespace sln {
 
@@ -26,6 +38,7 @@ namespace sln {
 
 template <typename SinkType> class TIFFWriteObject;
 template <typename SinkType> class TIFFWriter;
+template <typename SinkType> class TIFFPyramidWriter;
 
 /** \brief Options for TIFF writing, controlling (parts of) the output format.
  *
@@ -66,11 +79,22 @@ bool write_tiff(const DynImageOrView& dyn_img_or_view,
                 MessageLog* message_log = nullptr,
                 TIFFWriteObject<std::remove_reference_t<SinkType>>* = nullptr);
 
+template <typename PlanarImageOrView, typename SinkType>
+bool write_tiff_planar(const PlanarImageOrView& planar_img_or_view,
+                       SinkType&& sink,
+                       PixelFormat pixel_format = PixelFormat::Unknown,
+                       const TIFFWriteOptions& write_options = TIFFWriteOptions(),
+                       MessageLog* message_log = nullptr,
+                       TIFFWriteObject<std::remove_reference_t<SinkType>>* = nullptr);
 
 namespace impl {
 template <typename SinkType, typename DynImageOrView>
     bool tiff_write_to_current_directory(TIFFWriteObject<SinkType>&, const TIFFWriteOptions&, MessageLog&,
                                          const DynImageOrView&, std::ptrdiff_t = -1);
+
+template <typename SinkType>
+    bool tiff_write_planes_to_current_directory(TIFFWriteObject<SinkType>&, const TIFFWriteOptions&, MessageLog&,
+                                                const std::vector<ConstantDynImageView>&, const UntypedImageSemantics&);
 }  // namespace impl
 
 /** \brief Opaque TIFF writing object, holding internal state.
@@ -99,9 +123,12 @@ private:
   void close();
 
   template <typename DynImageOrView, typename SinkType2> friend bool write_tiff(const DynImageOrView&, SinkType2&&, const TIFFWriteOptions&, MessageLog*, TIFFWriteObject<std::remove_reference_t<SinkType2>>*);
+  template <typename PlanarImageOrView, typename SinkType2> friend bool write_tiff_planar(const PlanarImageOrView&, SinkType2&&, PixelFormat, const TIFFWriteOptions&, MessageLog*, TIFFWriteObject<std::remove_reference_t<SinkType2>>*);
   template <typename SinkType2, typename DynImageOrView> friend bool impl::tiff_write_to_current_directory(TIFFWriteObject<SinkType2>&, const TIFFWriteOptions&, MessageLog&, const DynImageOrView&, std::ptrdiff_t);
+  template <typename SinkType2> friend bool impl::tiff_write_planes_to_current_directory(TIFFWriteObject<SinkType2>&, const TIFFWriteOptions&, MessageLog&, const std::vector<ConstantDynImageView>&, const UntypedImageSemantics&);
 
   friend class TIFFWriter<SinkType>;
+  friend class TIFFPyramidWriter<SinkType>;
 };
 
 /** \brief Class with functionality to write a TIFF image data stream.
@@ -133,7 +160,7 @@ private:
  * image; there is no guarantee that after reading image data, the stream pointer will point past the end of the TIFF
  * file.
  *
- * @tparam SinkType Type of the output sink. Can be FileWriter or VectorWriter.
+ * @tparam SinkType Type of the output sink. Can be FileWriter, BufferedFileWriter, or VectorWriter.
  */
 template <typename SinkType>
 class TIFFWriter
@@ -158,6 +185,103 @@ private:
   std::ptrdiff_t nr_images_written{0};
 };
 
+/** \brief Options for writing a tiled, multi-resolution (pyramidal) TIFF image, controlling (parts of) the output format.
+ *
+ * `write_options` determine compression and tile size of all resolution levels; the storage layout is always tiled.
+ * Reduced-resolution levels, each of half the width and height of the preceding one, are generated until a level fits
+ * into a single tile, or until `max_nr_levels` reduced-resolution levels have been generated (if non-zero).
+ */
+struct TIFFPyramidOptions
+{
+  TIFFWriteOptions write_options;  ///< The options for writing each resolution level.
+  std::size_t max_nr_levels;  ///< The maximum number of reduced-resolution levels (0: no limit).
+
+  /** \brief Constructor, setting the respective options.
+   *
+   * @param write_options_ The options for writing each resolution level. The layout will be set to tiles.
+   * @param max_nr_levels_ The maximum number of reduced-resolution levels (0: no limit).
+   */
+  explicit TIFFPyramidOptions(const TIFFWriteOptions& write_options_ = TIFFWriteOptions{},
+                              std::size_t max_nr_levels_ = 0)
+      : write_options(write_options_), max_nr_levels(max_nr_levels_)
+  {
+    write_options.layout = TIFFWriteOptions::Layout::Tiles;
+  }
+};
+
+/** \brief Class with functionality to write a tiled, multi-resolution (pyramidal) TIFF image data stream.
+ *
+ * The full-resolution image is streamed to the writer in bands of rows by calling `write_rows` repeatedly (from top to
+ * bottom), so that the full-resolution image never needs to be held in memory at once. As soon as a full row of
+ * tiles has been collected, it is encoded and written to the sink, and reduced to half resolution by 2x2 averaging.
+ *
+ * On `finish_writing`, the full-resolution image directory is written, followed by one directory for each of the
+ * reduced-resolution levels (with `subfile_type` set to `FILETYPE_REDUCEDIMAGE`), in decreasing order of resolution.
+ * All directories are part of the main directory chain, and can therefore be read via `read_tiff_layouts()` or
+ * `TIFFPageIndex`.
+ * Calling `finish_writing` also happens when the `TIFFPyramidWriter` instance goes out of scope.
+ *
+ * The reduced-resolution levels are kept in memory until `finish_writing` is called; together, they occupy at most
+ * one third of the size of the full-resolution image.
+ *
+ * Any errors will be written to an internal `MessageLog` instance, which can be queried via the `message_log`
+ * function.
+ *
+ * @tparam SinkType Type of the output sink. Can be FileWriter, BufferedFileWriter, or VectorWriter.
+ */
+template <typename SinkType>
+class TIFFPyramidWriter
+{
+public:
+  TIFFPyramidWriter();
+  TIFFPyramidWriter(SinkType& sink,
+                    const UntypedLayout& layout,
+                    const UntypedImageSemantics& semantics,
+                    const TIFFPyramidOptions& options = TIFFPyramidOptions{});
+  ~TIFFPyramidWriter();
+
+  TIFFPyramidWriter(const TIFFPyramidWriter&) = delete;
+  TIFFPyramidWriter& operator=(const TIFFPyramidWriter&) = delete;
+  TIFFPyramidWriter(TIFFPyramidWriter&&) = delete;
+  TIFFPyramidWriter& operator=(TIFFPyramidWriter&&) = delete;
+
+  bool open(SinkType& sink,
+            const UntypedLayout& layout,
+            const UntypedImageSemantics& semantics,
+            const TIFFPyramidOptions& options = TIFFPyramidOptions{});
+
+  template <typename DynImageOrView>
+      bool write_rows(const DynImageOrView& dyn_img_or_view);
+  bool finish_writing();
+
+  std::size_t nr_rows_written() const noexcept;
+  std::size_t nr_levels() const noexcept;
+
+  MessageLog& message_log();
+
+private:
+  TIFFWriteObject<SinkType> write_object_;
+  TIFFPyramidOptions options_;
+  UntypedLayout layout_;
+  UntypedImageSemantics semantics_;
+  DynImage<> band_;  // collects one row of tiles of the full-resolution image
+  std::vector<DynImage<>> levels_;  // the reduced-resolution levels
+  std::size_t nr_band_rows_{0};
+  std::size_t nr_rows_written_{0};
+  bool is_open_{false};
+  bool failed_{false};
+  MessageLog message_log_;
+
+  bool write_rows_view(const ConstantDynImageView& view);
+  bool write_band();
+};
+
+template <typename DynImageOrView, typename SinkType>
+bool write_tiff_pyramid(const DynImageOrView& dyn_img_or_view,
+                        SinkType&& sink,
+                        const TIFFPyramidOptions& options = TIFFPyramidOptions{},
+                        MessageLog* message_log = nullptr);
+
 /// @}
 
 // ----------
@@ -166,7 +290,7 @@ private:
 /** \brief Write a TIFF image data stream, given the supplied uncompressed image data.
  *
  * @tparam DynImageOrView The type of the input image data. Can be of type `DynImage` or `DynImageView<>`.
- * @tparam SinkType Type of the output sink. Can be FileWriter or VectorWriter.
+ * @tparam SinkType Type of the output sink. Can be FileWriter, BufferedFileWriter, or VectorWriter.
  * @param dyn_img_or_view The dynamic image (view) to be written.
  * @param sink Output sink instance.
  * @param write_options Options for writing the TIFF image.
@@ -204,11 +328,79 @@ bool write_tiff(const DynImageOrView& dyn_img_or_view,
   return success && flushed;
 }
 
+/** \brief Write a TIFF image data stream from a planar image, storing each plane as a separate sample (planar
+ * configuration `TIFFPlanarConfig::Separate`).
+ *
+ * The planes are written directly, without going through an interleaved representation.
+ *
+ * @tparam PlanarImageOrView The type of the input image data. Can be of type `PlanarImage` or `PlanarImageView`.
+ * @tparam SinkType Type of the output sink. Can be FileWriter, BufferedFileWriter, or VectorWriter.
+ * @param planar_img_or_view The planar image (view) to be written.
+ * @param sink Output sink instance.
+ * @param pixel_format The pixel format of the image data. If `PixelFormat::Unknown`, it is derived from the number of
+ * planes (Y, YA, RGB, or RGBA).
+ * @param write_options Options for writing the TIFF image.
+ * @param messages Optional pointer to the message log. If provided, warning and error messages will be output there.
+ * @param tiff_object Optional TIFFWriteObject instance, which can be explicitly instantiated outside of this function.
+ * Providing this may save internal memory (de)allocations.
+ * @return True, if the write operation was successful; false otherwise.
+ */
+template <typename PlanarImageOrView, typename SinkType>
+bool write_tiff_planar(const PlanarImageOrView& planar_img_or_view,
+                       SinkType&& sink,
+                       PixelFormat pixel_format,
+                       const TIFFWriteOptions& write_options,
+                       MessageLog* message_log,
+                       TIFFWriteObject<std::remove_reference_t<SinkType>>* tiff_object)
+{
+  static_assert(impl::is_planar_image_type_v<PlanarImageOrView>, "Need to supply a planar image (owning or view)");
+
+  using PlaneType = typename PlanarImageOrView::PlaneType::PixelType;
+  constexpr auto nr_planes = PlanarImageOrView::nr_channels;
+
+  impl::tiff_set_handlers();
+  TIFFWriteObject<std::remove_reference_t<SinkType>> local_tiff_object;
+  TIFFWriteObject<std::remove_reference_t<SinkType>>* obj = tiff_object ? tiff_object : &local_tiff_object;
+
+  MessageLog local_message_log;
+
+  if (pixel_format == PixelFormat::Unknown)
+  {
+    constexpr std::array<PixelFormat, 4> default_formats = {{PixelFormat::Y, PixelFormat::YA, PixelFormat::RGB,
+                                                            PixelFormat::RGBA}};
+    pixel_format = (nr_planes <= default_formats.size()) ? default_formats[nr_planes - 1] : PixelFormat::Unknown;
+  }
+
+  if (!obj->open(std::forward<SinkType>(sink)))
+  {
+    local_message_log.add("TIFF writer: ERROR: Data stream could not be opened.", MessageType::Error);
+    impl::tiff_assign_message_log(local_message_log, message_log);
+    return false;
+  }
+
+  const auto view = planar_img_or_view.constant_view();
+  std::vector<ConstantDynImageView> planes;
+  planes.reserve(nr_planes);
+
+  for (std::size_t c = 0; c < nr_planes; ++c)
+  {
+    planes.push_back(to_dyn_image_view(view.plane(c), PixelFormat::Y));
+  }
+
+  const auto semantics = UntypedImageSemantics{pixel_format, PixelTraits<PlaneType>::sample_format};
+  const bool success = impl::tiff_write_planes_to_current_directory(*obj, write_options, local_message_log, planes,
+                                                                    semantics);
+  const bool flushed = obj->flush();
+
+  impl::tiff_assign_message_log(local_message_log, message_log);
+  return success && flushed;
+}
+
 // -----
 
 /** \brief Constructs a TIFFReader instance with the given data stream source.
  *
- * @tparam SinkType Type of the output sink. Can be FileWriter or VectorWriter.
+ * @tparam SinkType Type of the output sink. Can be FileWriter, BufferedFileWriter, or VectorWriter.
  * @param sink Output sink instance.
  */
 template <typename SinkType>
@@ -221,7 +413,7 @@ TIFFWriter<SinkType>::TIFFWriter(SinkType& sink)
 
 /** \brief Sets an output sink stream.
  *
- * @tparam SinkType Type of the output sink. Can be FileWriter or VectorWriter.
+ * @tparam SinkType Type of the output sink. Can be FileWriter, BufferedFileWriter, or VectorWriter.
  * @param sink Output sink instance.
  */
 template <typename SinkType>
@@ -265,6 +457,55 @@ MessageLog& TIFFWriter<SinkType>::message_log()
   return message_log_;
 }
 
+// -----
+
+/** \brief Writes (the next) rows of the full-resolution image.
+ *
+ * The rows are appended to the ones previously written. Their width, number of channels and number of bytes per
+ * channel have to match the layout given on opening the writer.
+ *
+ * @tparam SinkType Type of the output sink. Can be FileWriter, BufferedFileWriter, or VectorWriter.
+ * @tparam DynImageOrView The type of the input image data. Can be of type `DynImage` or `DynImageView<>`.
+ * @param dyn_img_or_view The dynamic image (view) containing the rows to be written.
+ * @return True, if the rows were successfully written (or collected); false otherwise.
+ */
+template <typename SinkType>
+template <typename DynImageOrView>
+bool TIFFPyramidWriter<SinkType>::write_rows(const DynImageOrView& dyn_img_or_view)
+{
+  impl::static_assert_is_dyn_image_or_view<DynImageOrView>();
+  return write_rows_view(dyn_img_or_view.constant_view());
+}
+
+/** \brief Write a tiled, multi-resolution (pyramidal) TIFF image data stream, given the supplied uncompressed image data.
+ *
+ * See TIFFPyramidWriter for a description of the written data stream.
+ *
+ * @tparam DynImageOrView The type of the input image data. Can be of type `DynImage` or `DynImageView<>`.
+ * @tparam SinkType Type of the output sink. Can be FileWriter, BufferedFileWriter, or VectorWriter.
+ * @param dyn_img_or_view The dynamic image (view) to be written.
+ * @param sink Output sink instance.
+ * @param options Options for writing the pyramidal TIFF image.
+ * @param message_log Optional pointer to the message log. If provided, warning and error messages will be output there.
+ * @return True, if the write operation was successful; false otherwise.
+ */
+template <typename DynImageOrView, typename SinkType>
+bool write_tiff_pyramid(const DynImageOrView& dyn_img_or_view,
+                        SinkType&& sink,
+                        const TIFFPyramidOptions& options,
+                        MessageLog* message_log)
+{
+  impl::static_assert_is_dyn_image_or_view<DynImageOrView>();
+
+  TIFFPyramidWriter<std::remove_reference_t<SinkType>> writer(sink, dyn_img_or_view.layout(),
+                                                              dyn_img_or_view.semantics(), options);
+  const bool rows_written = writer.write_rows(dyn_img_or_view);
+  const bool finished = writer.finish_writing();
+
+  impl::tiff_assign_message_log(writer.message_log(), message_log);
+  return rows_written && finished;
+}
+
 }  // namespace sln
 
 #endif  // defined(SELENE_WITH_LIBTIFF)
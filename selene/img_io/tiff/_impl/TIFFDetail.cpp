@@ -12,6 +12,9 @@
 #include <selene/img/pixel/PixelTypeAliases.hpp>
 #include <selene/img/typed/ImageViewTypeAliases.hpp>
 
+#include <selene/img_ops/Lut.hpp>
+
+#include <limits>
 #include <mutex>
 #include <stdexcept>
 
@@ -416,10 +419,26 @@ std::ostream& operator<<(std::ostream& os, const OutputLayout& info)
   return os;
 }
 
+void invert_samples(std::uint8_t* begin, std::uint8_t* end)
+{
+  static constexpr auto inversion_lut = make_lut<std::uint8_t>([](std::uint8_t value) {
+    return static_cast<std::uint8_t>(std::numeric_limits<std::uint8_t>::max() - value);
+  });
+
+  impl::apply_lut_row(begin, begin, end - begin, inversion_lut.data());
+}
+
 std::uint8_t* copy_samples(const std::uint8_t* src_dense, std::size_t nr_src_pixels, std::size_t channel_offset,
                            std::int16_t nr_bytes_per_channel, std::int16_t nr_channels, std::uint8_t* dst)
 {
-  dst += channel_offset;
+  if (nr_channels == 1)
+  {
+    const auto nr_bytes = nr_src_pixels * static_cast<std::size_t>(nr_bytes_per_channel);
+    std::memcpy(dst, src_dense, nr_bytes);
+    return dst + nr_bytes;
+  }
+
+  dst += channel_offset * static_cast<std::size_t>(nr_bytes_per_channel);
   const auto dst_offset = nr_bytes_per_channel * nr_channels;
 
   for (std::size_t s = 0; s < nr_src_pixels; ++s)
@@ -434,6 +453,19 @@ std::uint8_t* copy_samples(const std::uint8_t* src_dense, std::size_t nr_src_pix
   return dst;
 }
 
+void copy_samples_to_target(const std::uint8_t* src_dense, std::size_t nr_src_pixels, std::size_t sample_index,
+                            std::int16_t nr_bytes_per_channel, const std::vector<MutableDynImageView>& targets,
+                            PixelIndex x, PixelIndex y)
+{
+  SELENE_ASSERT(!targets.empty());
+  const bool interleaved = (targets.size() == 1);
+  const auto& target = interleaved ? targets.front() : targets[sample_index];
+  SELENE_ASSERT(target.nr_bytes_per_channel() == nr_bytes_per_channel);
+
+  copy_samples(src_dense, nr_src_pixels, interleaved ? sample_index : std::size_t{0}, nr_bytes_per_channel,
+               target.nr_channels(), target.byte_ptr(x, y));
+}
+
 std::vector<std::uint8_t> convert_single_channel_1bit_to_8bit(const std::vector<std::uint8_t>& buf,
                                                               [[maybe_unused]] std::ptrdiff_t nr_bytes_read,
                                                               std::uint32_t width,
@@ -15,6 +15,8 @@
 #include <selene/img/common/PixelFormat.hpp>
 #include <selene/img/common/Types.hpp>
 
+#include <selene/img/dynamic/DynImageView.hpp>
+
 #include <selene/img_io/tiff/Common.hpp>
 
 #include <algorithm>
@@ -380,9 +382,19 @@ std::ostream& operator<<(std::ostream& os, const ImageLayoutTiles& info);
 std::ostream& operator<<(std::ostream& os, const YCbCrInfo& info);
 std::ostream& operator<<(std::ostream& os, const OutputLayout& info);
 
+// Inverts all bytes in [begin, end), i.e. applies the transformation of inverted photometric interpretations (e.g.
+// TIFF MinIsWhite).
+void invert_samples(std::uint8_t* begin, std::uint8_t* end);
+
 std::uint8_t* copy_samples(const std::uint8_t* src_dense, std::size_t nr_src_pixels, std::size_t channel_offset,
                            std::int16_t nr_bytes_per_channel, std::int16_t nr_channels, std::uint8_t* dst);
 
+// Copies a row of separately stored (planar) samples to position (x, y) of the target: `targets` is either a single
+// interleaved view, or one single-channel view per sample.
+void copy_samples_to_target(const std::uint8_t* src_dense, std::size_t nr_src_pixels, std::size_t sample_index,
+                            std::int16_t nr_bytes_per_channel, const std::vector<MutableDynImageView>& targets,
+                            PixelIndex x, PixelIndex y);
+
 std::vector<std::uint8_t> convert_single_channel_1bit_to_8bit(const std::vector<std::uint8_t>& buf,
                                                               std::ptrdiff_t nr_bytes_read,
                                                               std::uint32_t width,
@@ -102,6 +102,24 @@ int r_map_func([[maybe_unused]] thandle_t data, [[maybe_unused]] void** base, [[
   return 0;
 }
 
+// For memory-mapped sources: hands the mapped contents (from the start of the TIFF stream) directly to libtiff.
+template <typename Source>
+int r_map_memory_func(thandle_t data, void** base, toff_t* size)
+{
+  auto ss = reinterpret_cast<SourceStruct<Source>*>(data);
+  const auto region = ss->source->region();
+  const auto start_pos = static_cast<std::size_t>(ss->start_pos);
+
+  if (region.data == nullptr || start_pos >= region.len)
+  {
+    return 0;
+  }
+
+  *base = const_cast<std::uint8_t*>(region.data + start_pos);  // libtiff only reads from the mapping
+  *size = static_cast<toff_t>(region.len - start_pos);
+  return 1;
+}
+
 template <typename Source>
 void r_unmap_func([[maybe_unused]] thandle_t data, [[maybe_unused]] void* base, [[maybe_unused]] toff_t size)
 {
@@ -118,7 +136,7 @@ tmsize_t w_write_func([[maybe_unused]] thandle_t data, [[maybe_unused]] void* bu
 
   const auto nr_bytes_written =
       ss->sink->template write<std::uint8_t>(static_cast<std::uint8_t*>(buf), static_cast<std::size_t>(size));
-  SELENE_ASSERT(nr_bytes_written == static_cast<std::size_t>(size));
+  // A short write (e.g. on a full disk) is reported as an error by libtiff
   return static_cast<tmsize_t>(nr_bytes_written);
 }
 
@@ -118,8 +118,7 @@ bool read_data_strips_interleaved(TIFF* tif,
 
     if (src.inverted())
     {
-      std::for_each(buf_begin, buf_end, [](auto& px){
-        px = static_cast<std::uint8_t>(std::numeric_limits<std::uint8_t>::max() - px); });
+      impl::tiff::invert_samples(buf_begin, buf_end);
     }
 
     // Copy buffer into target image. Data is stored interleaved.
@@ -171,7 +170,7 @@ bool read_data_strips_planar(TIFF* tif,
                              const sln::impl::tiff::YCbCrConverter& /*ycbcr_converter*/,
                              const sln::impl::tiff::LabConverter& /*lab_converter*/,
                              const sln::impl::tiff::OutputLayout& out,
-                             sln::MutableDynImageView& dyn_img_view,
+                             const std::vector<sln::MutableDynImageView>& targets,
                              sln::MessageLog& message_log)
 {
   if (src.is_format_ycbcr())
@@ -225,8 +224,7 @@ bool read_data_strips_planar(TIFF* tif,
 
     if (src.inverted())
     {
-      std::for_each(buf_begin, buf_end, [](auto& px){
-        px = static_cast<std::uint8_t>(std::numeric_limits<std::uint8_t>::max() - px); });
+      impl::tiff::invert_samples(buf_begin, buf_end);
     }
 
     // Copy buffer into target image. Data is stored in separate planes.
@@ -240,9 +238,8 @@ bool read_data_strips_planar(TIFF* tif,
       SELENE_ASSERT(buf_ptr + nr_bytes_per_input_row <= buf_end);
 
       const auto row_y = to_pixel_index(plane_strip_index * strip_layout.rows_per_strip + to_unsigned(y));
-      auto img_ptr = dyn_img_view.byte_ptr(row_y);
-
-      impl::tiff::copy_samples(buf_ptr, to_unsigned(out.width), channel_index, out.nr_bytes_per_channel, out.nr_channels, img_ptr);
+      impl::tiff::copy_samples_to_target(buf_ptr, to_unsigned(out.width), channel_index, out.nr_bytes_per_channel,
+                                         targets, 0_idx, row_y);
     }
   }
 
@@ -336,10 +333,29 @@ bool read_data_strips(TIFF* tif,
   }
   else  // planar_config == TIFFPlanarConfig::Separate
   {
-    return read_data_strips_planar(tif, src, strip_layout, ycbcr_info, ycbcr_converter, lab_converter, out, dyn_img_or_view.view(), message_log);
+    const std::vector<MutableDynImageView> targets = {dyn_img_or_view.view()};
+    return read_data_strips_planar(tif, src, strip_layout, ycbcr_info, ycbcr_converter, lab_converter, out, targets, message_log);
   }
 }
 
+bool read_data_strips_into_planes(TIFF* tif,
+                                  const sln::TiffImageLayout& src,
+                                  const sln::impl::tiff::YCbCrInfo& ycbcr_info,
+                                  const sln::impl::tiff::YCbCrConverter& ycbcr_converter,
+                                  const sln::impl::tiff::LabConverter& lab_converter,
+                                  const std::vector<MutableDynImageView>& planes,
+                                  sln::MessageLog& message_log)
+{
+  SELENE_ASSERT(src.planar_config == TIFFPlanarConfig::Separate);
+  SELENE_ASSERT(planes.size() == src.samples_per_pixel);
+
+  const auto nr_rows_per_strip = std::min(src.height, impl::tiff::get_field<uint32>(tif, TIFFTAG_ROWSPERSTRIP));
+  const sln::impl::tiff::ImageLayoutStrips strip_layout(TIFFNumberOfStrips(tif), TIFFStripSize(tif), nr_rows_per_strip);
+
+  const auto out = get_output_layout(tif, src, ycbcr_info, strip_layout, message_log);
+  return read_data_strips_planar(tif, src, strip_layout, ycbcr_info, ycbcr_converter, lab_converter, out, planes, message_log);
+}
+
 // Explicit instantiations:
 template bool read_data_strips(TIFF*,
                                const sln::TiffImageLayout&,
@@ -19,6 +19,8 @@
 #include <selene/img_io/tiff/Common.hpp>
 #include <selene/img_io/tiff/_impl/TIFFDetail.hpp>
 
+#include <vector>
+
 namespace sln::impl {
 
 template <typename DynImageOrView>
@@ -30,6 +32,15 @@ bool read_data_strips(TIFF* tif,
                       DynImageOrView& dyn_img_or_view,
                       sln::MessageLog& message_log);
 
+// Reads separately stored (planar) strip data directly into one single-channel view per sample.
+bool read_data_strips_into_planes(TIFF* tif,
+                                  const sln::TiffImageLayout& src,
+                                  const sln::impl::tiff::YCbCrInfo& ycbcr_info,
+                                  const sln::impl::tiff::YCbCrConverter& ycbcr_converter,
+                                  const sln::impl::tiff::LabConverter& lab_converter,
+                                  const std::vector<sln::MutableDynImageView>& planes,
+                                  sln::MessageLog& message_log);
+
 }  // namespace sln::impl
 
 #endif  // defined(SELENE_WITH_LIBTIFF)
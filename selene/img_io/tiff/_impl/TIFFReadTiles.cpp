@@ -98,8 +98,7 @@ bool read_data_tiles_interleaved(TIFF* tif,
 
       if (src.inverted())
       {
-        std::for_each(data_begin, data_end, [](auto& px){
-          px = static_cast<std::uint8_t>(std::numeric_limits<std::uint8_t>::max() - px); });
+        impl::tiff::invert_samples(data_begin, data_end);
       }
 
       // Data is stored interleaved.
@@ -145,7 +144,7 @@ bool read_data_tiles_planar(TIFF* tif,
                             const sln::impl::tiff::YCbCrConverter& /*ycbcr_converter*/,
                             const sln::impl::tiff::LabConverter& /*lab_converter*/,
                             const sln::impl::tiff::OutputLayout& out,
-                            sln::MutableDynImageView& dyn_img_view,
+                            const std::vector<sln::MutableDynImageView>& targets,
                             sln::MessageLog& message_log)
 {
   using value_type = PixelIndex::value_type;
@@ -163,7 +162,7 @@ bool read_data_tiles_planar(TIFF* tif,
     return false;
   }
 
-  const auto nr_channels = to_unsigned(out.nr_channels);
+  [[maybe_unused]] const auto nr_channels = to_unsigned(out.nr_channels);
   const auto nr_bytes_per_channel = to_unsigned(out.nr_bytes_per_channel);
 
   SELENE_ASSERT(nr_channels == static_cast<std::int16_t>(src.samples_per_pixel));
@@ -193,8 +192,7 @@ bool read_data_tiles_planar(TIFF* tif,
 
         if (src.inverted())
         {
-          std::for_each(data_begin, data_end, [](auto& px){
-            px = static_cast<std::uint8_t>(std::numeric_limits<std::uint8_t>::max() - px); });
+          impl::tiff::invert_samples(data_begin, data_end);
         }
 
         // Copy buffer into target image
@@ -207,25 +205,13 @@ bool read_data_tiles_planar(TIFF* tif,
 
         for (PixelIndex dst_y = src_y; dst_y < max_y; ++dst_y)  // For each target row...
         {
-          const auto img_ptr_y_start = dyn_img_view.byte_ptr(dst_x, dst_y);
-          const auto img_ptr_y_end = img_ptr_y_start + dyn_img_view.row_bytes();
-
           const std::size_t tile_row_nr_bytes = tile_layout.width * nr_bytes_per_channel;
           const auto tile_row_index = static_cast<std::size_t>(dst_y - src_y);
           const auto buf_ptr_start = buf.data() + tile_row_index * tile_row_nr_bytes;
+          SELENE_ASSERT(buf_ptr_start + this_tile_width * nr_bytes_per_channel <= data_end);
 
-          const std::size_t nr_bytes_to_write = this_tile_width * nr_channels * nr_bytes_per_channel;
-          const std::size_t max_bytes_to_write = std::min(static_cast<std::size_t>(nr_bytes_to_write),
-                                                          static_cast<std::size_t>(img_ptr_y_end - img_ptr_y_start));
-
-          if (max_bytes_to_write < nr_bytes_to_write)
-          {
-            message_log.add("Writing fewer bytes than expected to target image...", MessageType::Warning);
-          }
-
-          const auto nr_src_pixels = max_bytes_to_write / (nr_channels * nr_bytes_per_channel);
-          impl::tiff::copy_samples(buf_ptr_start, nr_src_pixels, std::size_t{sample_index},
-                                   to_signed(nr_bytes_per_channel), to_signed(nr_channels), img_ptr_y_start);
+          impl::tiff::copy_samples_to_target(buf_ptr_start, this_tile_width, std::size_t{sample_index},
+                                             to_signed(nr_bytes_per_channel), targets, dst_x, dst_y);
         }
       }
     }
@@ -290,10 +276,37 @@ bool read_data_tiles(TIFF* tif,
   }
   else  // planar_config == TIFFPlanarConfig::Separate
   {
-    return read_data_tiles_planar(tif, src, tile_layout, ycbcr_info, ycbcr_converter, lab_converter, out, dyn_img_or_view.view(), message_log);
+    const std::vector<MutableDynImageView> targets = {dyn_img_or_view.view()};
+    return read_data_tiles_planar(tif, src, tile_layout, ycbcr_info, ycbcr_converter, lab_converter, out, targets, message_log);
   }
 }
 
+bool read_data_tiles_into_planes(TIFF* tif,
+                                 const sln::TiffImageLayout& src,
+                                 const sln::impl::tiff::YCbCrInfo& ycbcr_info,
+                                 const sln::impl::tiff::YCbCrConverter& ycbcr_converter,
+                                 const sln::impl::tiff::LabConverter& lab_converter,
+                                 const std::vector<MutableDynImageView>& planes,
+                                 sln::MessageLog& message_log)
+{
+  SELENE_ASSERT(src.planar_config == TIFFPlanarConfig::Separate);
+  SELENE_ASSERT(planes.size() == src.samples_per_pixel);
+
+  const sln::impl::tiff::ImageLayoutTiles tile_layout(
+      impl::tiff::get_field<uint32>(tif, TIFFTAG_TILEWIDTH),
+      impl::tiff::get_field<uint32>(tif, TIFFTAG_TILELENGTH),
+      impl::tiff::get_field<uint32>(tif, TIFFTAG_TILEDEPTH, 1),
+      TIFFTileSize(tif));
+
+  const auto nr_bytes_per_channel_out = std::max(std::uint16_t{1}, static_cast<std::uint16_t>(src.bits_per_sample >> 3));
+  sln::impl::tiff::OutputLayout out(to_pixel_length(src.width), to_pixel_length(src.height),
+                                    to_signed(src.samples_per_pixel), to_signed(nr_bytes_per_channel_out),
+                                    impl::tiff::photometric_to_pixel_format(src.photometric, src.samples_per_pixel),
+                                    impl::tiff::sample_format_to_sample_format(src.sample_format));
+
+  return read_data_tiles_planar(tif, src, tile_layout, ycbcr_info, ycbcr_converter, lab_converter, out, planes, message_log);
+}
+
 // Explicit instantiations:
 template bool read_data_tiles(TIFF*,
                               const sln::TiffImageLayout&,
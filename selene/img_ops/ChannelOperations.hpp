@@ -15,15 +15,26 @@
 #include <selene/img/typed/Utilities.hpp>
 #include <selene/img/typed/_impl/StaticChecks.hpp>
 
+#include <selene/img_ops/Allocate.hpp>
 #include <selene/img_ops/Clone.hpp>
 
+#include <selene/img_ops/_impl/ChannelKernels.hpp>
+
+#include <array>
+#include <cstddef>
+#include <stdexcept>
+#include <type_traits>
+
 namespace sln {
 
 template <typename ImgSrc, typename ImgDst>
 void inject_channels(const ImgSrc& src, ImgDst& dst, std::size_t dst_start_channel);
 
 template <sln::PixelFormat pixel_format = sln::PixelFormat::Unknown, typename... Imgs>
-auto stack_images(Imgs... imgs);
+auto stack_images(const Imgs&... imgs);
+
+template <typename Img>
+auto split_channels(const Img& img);
 
 /// @}
 
@@ -124,6 +135,29 @@ namespace impl
 
   template <typename... Imgs> using ElementType_t = typename ElementType<Imgs...>::type;
 
+  template <typename Img, typename... Imgs>
+  constexpr bool are_single_channel_of_same_element_type()
+  {
+    using T = typename sln::PixelTraits<typename Img::PixelType>::Element;
+    return sln::PixelTraits<typename Img::PixelType>::nr_channels == 1
+           && ((sln::PixelTraits<typename Imgs::PixelType>::nr_channels == 1
+                && std::is_same_v<typename sln::PixelTraits<typename Imgs::PixelType>::Element, T>) && ...);
+  }
+
+  template <typename ImgDst, typename... ImgsSrc>
+  void interleave_images(ImgDst& img_dst, const ImgsSrc&... imgs_src)
+  {
+    using T = typename sln::PixelTraits<typename ImgDst::PixelType>::Element;
+    constexpr auto nr_channels = sizeof...(ImgsSrc);
+
+    for (auto y = 0_idx; y < img_dst.height(); ++y)
+    {
+      const std::array<const T*, nr_channels> ptrs_src = {{reinterpret_cast<const T*>(imgs_src.byte_ptr(y))...}};
+      impl::interleave_row<nr_channels>(ptrs_src, reinterpret_cast<T*>(img_dst.byte_ptr(y)),
+                                        static_cast<std::ptrdiff_t>(img_dst.width()));
+    }
+  }
+
   template <typename ImgSrc, typename ImgDst>
   void inject_channels_rec(ImgDst& img_dst, std::size_t dst_start_channel, const ImgSrc& img_src)
   {
@@ -131,7 +165,7 @@ namespace impl
   }
 
   template <typename ImgSrc, typename... ImgsSrc, typename ImgDst>
-  void inject_channels_rec(ImgDst& img_dst, std::size_t dst_start_channel, const ImgSrc& img_src, ImgsSrc&&... imgs_src)
+  void inject_channels_rec(ImgDst& img_dst, std::size_t dst_start_channel, const ImgSrc& img_src, const ImgsSrc&... imgs_src)
   {
     constexpr auto nr_channels_src = sln::PixelTraits<typename ImgSrc::PixelType>::nr_channels;
     constexpr auto nr_channels_dst = sln::PixelTraits<typename ImgDst::PixelType>::nr_channels;
@@ -142,7 +176,7 @@ namespace impl
     }
 
     inject_channels(img_src, img_dst, dst_start_channel);
-    inject_channels_rec(img_dst, dst_start_channel + nr_channels_src, std::forward<ImgsSrc>(imgs_src)...);
+    inject_channels_rec(img_dst, dst_start_channel + nr_channels_src, imgs_src...);
   }
 
 } // namespace impl
@@ -157,6 +191,9 @@ auto stack_images(const Img& img)
  *
  * The number of channels of the returned image will be equal to the cumulative number of channels of the input
  * images.
+ * The input images (owning images or views) are taken by reference, i.e. they are not copied before stacking.
+ * If all input images are single-channel images of the same element type, their rows are interleaved directly, using
+ * SIMD instructions for the common cases of 3 or 4 images of 8-bit, 16-bit or 32-bit elements (where supported).
  *
  * All input images have to be of the same size; otherwise, an exception is thrown.
  *
@@ -166,10 +203,10 @@ auto stack_images(const Img& img)
  * @return The concatenated output image.
  */
 template <sln::PixelFormat pixel_format, typename... Imgs>
-auto stack_images(Imgs... imgs)
+auto stack_images(const Imgs&... imgs)
 {
   using T = impl::ElementType_t<Imgs...>;
-  constexpr auto nr_channels = count_nr_channels(std::forward<Imgs>(imgs)...);
+  constexpr auto nr_channels = (sln::PixelTraits<typename Imgs::PixelType>::nr_channels + ...);
 
   // Determine minimum width and height of common image
   const auto min_width = impl::apply_min([](const auto& img){ return img.width(); }, imgs...);
@@ -178,17 +215,65 @@ auto stack_images(Imgs... imgs)
   const auto height = impl::apply_max([](const auto& img){ return img.height(); }, imgs...);
   using PixelType = sln::Pixel<T, nr_channels, pixel_format>;
 
-  sln::Image<PixelType> img_dst({width, height});
-
   if (width > min_width || height > min_height)
   {
     throw std::runtime_error("stack_images: Images are not all the same size.");
   }
 
-  impl::inject_channels_rec(img_dst, 0, std::forward<Imgs>(imgs)...);
+  sln::Image<PixelType> img_dst({width, height});
+
+  if constexpr (impl::are_single_channel_of_same_element_type<Imgs...>())
+  {
+    impl::interleave_images(img_dst, imgs...);
+  }
+  else
+  {
+    impl::inject_channels_rec(img_dst, 0, imgs...);
+  }
+
   return img_dst;
 }
 
+/** \brief Splits the specified multi-channel image into single-channel images, one per channel.
+ *
+ * This is the inverse operation of stacking single-channel images via `stack_images`. SIMD instructions are used for
+ * the common cases of 3-channel or 4-channel images of 8-bit, 16-bit or 32-bit elements (where supported).
+ *
+ * @tparam Img The image type of the input image (owning image or view).
+ * @param img The input image.
+ * @return An array of single-channel images, where the n-th image contains the n-th channel of the input image.
+ */
+template <typename Img>
+auto split_channels(const Img& img)
+{
+  static_assert(impl::is_image_type_v<Img>,
+                "Need to supply a typed image (owning or view) as input argument to split_channels");
+
+  using T = typename sln::PixelTraits<typename Img::PixelType>::Element;
+  constexpr auto nr_channels = static_cast<std::size_t>(sln::PixelTraits<typename Img::PixelType>::nr_channels);
+
+  std::array<sln::Image<sln::Pixel<T, 1>>, nr_channels> imgs_dst;
+  std::array<T*, nr_channels> ptrs_dst{};
+
+  for (auto& img_dst : imgs_dst)
+  {
+    sln::allocate(img_dst, {img.width(), img.height()});
+  }
+
+  for (auto y = 0_idx; y < img.height(); ++y)
+  {
+    for (std::size_t c = 0; c < nr_channels; ++c)
+    {
+      ptrs_dst[c] = reinterpret_cast<T*>(imgs_dst[c].byte_ptr(y));
+    }
+
+    impl::deinterleave_row<nr_channels>(reinterpret_cast<const T*>(img.byte_ptr(y)), ptrs_dst,
+                                        static_cast<std::ptrdiff_t>(img.width()));
+  }
+
+  return imgs_dst;
+}
+
 }  // namespace sln
 
 #endif  // SELENE_IMG_OPS_CHANNEL_OPERATIONS_HPP
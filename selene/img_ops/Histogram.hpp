@@ -0,0 +1,651 @@
+// This file is part of the `Selene` library.
+// Copyright 2017-2019 Michael Hofmann (https://github.com/kmhofmann).
+// Distributed under MIT license. See accompanying LICENSE file in the top-level directory.
+
+#ifndef SELENE_IMG_OPS_HISTOGRAM_HPP
+#define SELENE_IMG_OPS_HISTOGRAM_HPP
+
+/// @file
+
+#include <selene/base/Assert.hpp>
+#include <selene/base/Types.hpp>
+#include <selene/base/_impl/ParallelFor.hpp>
+
+#include <selene/img/common/BoundingBox.hpp>
+#include <selene/img/pixel/PixelTraits.hpp>
+
+#include <selene/img/typed/Image.hpp>
+#include <selene/img/typed/ImageBase.hpp>
+
+#include <selene/img_ops/Allocate.hpp>
+#include <selene/img_ops/View.hpp>
+
+#include <selene/img_ops/_impl/LutKernels.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+namespace sln {
+
+/// \addtogroup group-img-ops
+/// @{
+
+/** \brief Describes whether a histogram is computed for each channel separately, or jointly over all channels.
+ */
+enum class HistogramMode
+{
+  PerChannel,  ///< One histogram per channel.
+  Joint,  ///< One histogram, into which the values of all channels are counted.
+};
+
+/// The bins of a histogram; i.e. the number of occurrences of each value.
+using HistogramBins = std::vector<std::uint64_t>;
+
+template <HistogramMode mode = HistogramMode::PerChannel, typename DerivedSrc>
+auto histogram(const ImageBase<DerivedSrc>& img, int nr_threads = 0);
+
+template <HistogramMode mode = HistogramMode::PerChannel, typename DerivedSrc>
+auto histogram(const ImageBase<DerivedSrc>& img, const BoundingBox& region, int nr_threads = 0);
+
+template <typename DerivedSrc, typename DerivedDst>
+void equalize_histogram(const ImageBase<DerivedSrc>& img_src, ImageBase<DerivedDst>& img_dst, int nr_threads = 0);
+
+template <typename DerivedSrc>
+Image<typename DerivedSrc::PixelType> equalize_histogram(const ImageBase<DerivedSrc>& img_src, int nr_threads = 0);
+
+template <typename DerivedSrc, typename DerivedDst>
+void clahe(const ImageBase<DerivedSrc>& img_src,
+           ImageBase<DerivedDst>& img_dst,
+           std::size_t nr_tiles_x = 8,
+           std::size_t nr_tiles_y = 8,
+           float64_t clip_limit = 2.0,
+           int nr_threads = 0);
+
+template <typename DerivedSrc>
+Image<typename DerivedSrc::PixelType> clahe(const ImageBase<DerivedSrc>& img_src,
+                                            std::size_t nr_tiles_x = 8,
+                                            std::size_t nr_tiles_y = 8,
+                                            float64_t clip_limit = 2.0,
+                                            int nr_threads = 0);
+
+/// @}
+
+// ----------
+// Implementation:
+
+namespace impl {
+
+template <typename T>
+constexpr bool is_histogram_element_type_v = std::is_integral_v<T> && std::is_unsigned_v<T> && sizeof(T) <= 2;
+
+template <typename T>
+constexpr std::size_t histogram_nr_bins = std::size_t{1} << (8 * sizeof(T));
+
+// Number of private sub-histograms per task. Consecutive elements are counted in different sub-histograms, so that
+// runs of equal values do not serialize on store-to-load dependencies of the same bin. For 16-bit elements, such runs
+// are less frequent, and a single histogram of 32-bit bins per task is kept to stay cache-resident.
+template <typename T>
+constexpr std::size_t histogram_nr_sub_histograms = (sizeof(T) == 1) ? 4 : 1;
+
+// Maximum number of elements per task, such that the 32-bit sub-histogram bins cannot overflow.
+constexpr std::size_t histogram_max_task_size = std::size_t{1} << 31;
+
+// Minimum number of elements per task. Smaller images are processed on the calling thread, since creating threads (and,
+// for histogram computation, clearing and merging per-task sub-histograms) would outweigh the actual work.
+constexpr std::size_t histogram_min_task_size = std::size_t{64} * 1024;
+
+template <HistogramMode mode, std::size_t N>
+constexpr std::size_t histogram_count = (mode == HistogramMode::PerChannel) ? N : 1;
+
+template <typename T, std::size_t N, HistogramMode mode, typename DerivedSrc>
+void count_histogram_rows(const ImageBase<DerivedSrc>& img,
+                          PixelIndex y_begin,
+                          PixelIndex y_end,
+                          std::vector<std::uint32_t>& sub_bins)
+{
+  constexpr auto nr_bins = histogram_nr_bins<T>;
+  constexpr auto nr_sub = histogram_nr_sub_histograms<T>;
+  constexpr auto nr_hist = histogram_count<mode, N>;
+  constexpr auto sub_size = nr_hist * nr_bins;
+
+  const auto width = static_cast<std::ptrdiff_t>(img.width());
+  const auto bins = sub_bins.data();
+
+  for (auto y = y_begin; y < y_end; ++y)
+  {
+    const auto src = reinterpret_cast<const T*>(img.byte_ptr(y));
+
+    if constexpr (mode == HistogramMode::PerChannel)
+    {
+      std::ptrdiff_t x = 0;
+      for (; x + static_cast<std::ptrdiff_t>(nr_sub) <= width; x += nr_sub)
+      {
+        for (std::size_t s = 0; s < nr_sub; ++s)
+        {
+          for (std::size_t c = 0; c < N; ++c)
+          {
+            ++bins[s * sub_size + c * nr_bins + src[N * (x + s) + c]];
+          }
+        }
+      }
+
+      for (; x < width; ++x)
+      {
+        for (std::size_t c = 0; c < N; ++c)
+        {
+          ++bins[c * nr_bins + src[N * x + c]];
+        }
+      }
+    }
+    else
+    {
+      const auto nr_elements = width * static_cast<std::ptrdiff_t>(N);
+      std::ptrdiff_t i = 0;
+      for (; i + static_cast<std::ptrdiff_t>(nr_sub) <= nr_elements; i += nr_sub)
+      {
+        for (std::size_t s = 0; s < nr_sub; ++s)
+        {
+          ++bins[s * sub_size + src[i + s]];
+        }
+      }
+
+      for (; i < nr_elements; ++i)
+      {
+        ++bins[src[i]];
+      }
+    }
+  }
+}
+
+template <typename T, std::size_t N, HistogramMode mode, typename DerivedSrc>
+auto compute_histogram(const ImageBase<DerivedSrc>& img, int nr_threads)
+{
+  constexpr auto nr_bins = histogram_nr_bins<T>;
+  constexpr auto nr_sub = histogram_nr_sub_histograms<T>;
+  constexpr auto nr_hist = histogram_count<mode, N>;
+
+  std::array<HistogramBins, nr_hist> result;
+  for (auto& bins : result)
+  {
+    bins.assign(nr_bins, 0);
+  }
+
+  const auto width = static_cast<std::size_t>(img.width());
+  const auto height = static_cast<std::size_t>(img.height());
+  if (width == 0 || height == 0)
+  {
+    return result;
+  }
+
+  // Each task counts a contiguous range of rows into its own set of sub-histograms. Tasks are sized by the number of
+  // elements, with each task counting at least 8 elements per sub-histogram bin, so that clearing and merging the
+  // sub-histograms stays cheap in comparison to counting (e.g. 512K elements per task for 16-bit elements).
+  const auto nr_elements = width * height * N;
+  const auto min_task_size = std::max(histogram_min_task_size, 8 * nr_sub * nr_hist * nr_bins);
+  const auto min_nr_tasks = (nr_elements + histogram_max_task_size - 1) / histogram_max_task_size;
+  const auto nr_tasks = std::min(
+      height, std::max(impl::get_nr_tasks(nr_elements, min_task_size, impl::get_nr_threads(nr_threads)), min_nr_tasks));
+  std::vector<std::array<HistogramBins, nr_hist>> task_results(nr_tasks);
+
+  impl::parallel_for(nr_tasks, nr_tasks, [&](std::size_t task) {
+    const auto y_begin = PixelIndex{static_cast<PixelIndex::value_type>(height * task / nr_tasks)};
+    const auto y_end = PixelIndex{static_cast<PixelIndex::value_type>(height * (task + 1) / nr_tasks)};
+
+    std::vector<std::uint32_t> sub_bins(nr_sub * nr_hist * nr_bins, 0);
+    count_histogram_rows<T, N, mode>(img, y_begin, y_end, sub_bins);
+
+    // The first task merges directly into the (zero-initialized) result, the others into their own histograms.
+    auto& task_result = (task == 0) ? result : task_results[task];
+    for (std::size_t h = 0; h < nr_hist; ++h)
+    {
+      if (task > 0)
+      {
+        task_result[h].assign(nr_bins, 0);
+      }
+
+      for (std::size_t s = 0; s < nr_sub; ++s)
+      {
+        const auto sub = sub_bins.data() + (s * nr_hist + h) * nr_bins;
+        for (std::size_t b = 0; b < nr_bins; ++b)
+        {
+          task_result[h][b] += sub[b];
+        }
+      }
+    }
+  });
+
+  for (std::size_t task = 1; task < nr_tasks; ++task)
+  {
+    for (std::size_t h = 0; h < nr_hist; ++h)
+    {
+      for (std::size_t b = 0; b < nr_bins; ++b)
+      {
+        result[h][b] += task_results[task][h][b];
+      }
+    }
+  }
+
+  return result;
+}
+
+template <typename T>
+std::vector<T> equalization_lut(const HistogramBins& bins)
+{
+  constexpr auto max_value = static_cast<float64_t>(std::numeric_limits<T>::max());
+  const auto nr_bins = bins.size();
+
+  std::vector<T> lut(nr_bins);
+
+  std::uint64_t total = 0;
+  for (const auto count : bins)
+  {
+    total += count;
+  }
+
+  const auto it_min = std::find_if(bins.cbegin(), bins.cend(), [](std::uint64_t count) { return count > 0; });
+  const auto cdf_min = (it_min != bins.cend()) ? *it_min : std::uint64_t{0};
+
+  if (total == cdf_min)
+  {
+    // Constant (or empty) channel: identity mapping
+    for (std::size_t v = 0; v < nr_bins; ++v)
+    {
+      lut[v] = static_cast<T>(v);
+    }
+    return lut;
+  }
+
+  const auto scale = max_value / static_cast<float64_t>(total - cdf_min);
+  std::uint64_t cdf = 0;
+  for (std::size_t v = 0; v < nr_bins; ++v)
+  {
+    cdf += bins[v];
+    lut[v] = (cdf < cdf_min) ? T{0} : static_cast<T>(std::lround(static_cast<float64_t>(cdf - cdf_min) * scale));
+  }
+
+  return lut;
+}
+
+template <typename T>
+std::vector<T> clahe_tile_lut(HistogramBins bins, std::uint64_t nr_tile_pixels, float64_t clip_limit)
+{
+  constexpr auto max_value = static_cast<float64_t>(std::numeric_limits<T>::max());
+  const auto nr_bins = bins.size();
+
+  if (clip_limit > 0.0)
+  {
+    const auto limit = std::max(
+        std::uint64_t{1}, static_cast<std::uint64_t>(clip_limit * static_cast<float64_t>(nr_tile_pixels) / static_cast<float64_t>(nr_bins)));
+
+    std::uint64_t excess = 0;
+    for (auto& count : bins)
+    {
+      if (count > limit)
+      {
+        excess += count - limit;
+        count = limit;
+      }
+    }
+
+    // Redistribute the clipped counts uniformly; the remainder is spread evenly over the range.
+    const auto increment = excess / nr_bins;
+    const auto residual = excess % nr_bins;
+    for (auto& count : bins)
+    {
+      count += increment;
+    }
+
+    if (residual > 0)
+    {
+      const auto step = std::max(std::size_t{1}, static_cast<std::size_t>(nr_bins / residual));
+      for (std::size_t b = 0, r = 0; b < nr_bins && r < residual; b += step, ++r)
+      {
+        ++bins[b];
+      }
+    }
+  }
+
+  std::vector<T> lut(nr_bins);
+  const auto scale = max_value / static_cast<float64_t>(nr_tile_pixels);
+  std::uint64_t cdf = 0;
+  for (std::size_t v = 0; v < nr_bins; ++v)
+  {
+    cdf += bins[v];
+    lut[v] = static_cast<T>(std::min(max_value, std::round(static_cast<float64_t>(cdf) * scale)));
+  }
+
+  return lut;
+}
+
+// Describes, for one coordinate, the two neighboring tiles (by their centers) and the interpolation weight of the
+// second one.
+struct ClaheInterpolation
+{
+  std::size_t tile_0;
+  std::size_t tile_1;
+  float32_t weight_1;
+};
+
+inline std::vector<ClaheInterpolation> clahe_interpolation(std::size_t length, std::size_t tile_size, std::size_t nr_tiles)
+{
+  const auto center = [length, tile_size](std::size_t t) {
+    const auto begin = t * tile_size;
+    const auto end = std::min(length, begin + tile_size);
+    return 0.5 * static_cast<float64_t>(begin + end - 1);
+  };
+
+  std::vector<ClaheInterpolation> interpolation(length);
+  std::size_t t = 0;
+  for (std::size_t i = 0; i < length; ++i)
+  {
+    const auto pos = static_cast<float64_t>(i);
+    while (t + 1 < nr_tiles && center(t + 1) <= pos)
+    {
+      ++t;
+    }
+
+    if (pos <= center(0))
+    {
+      interpolation[i] = {0, 0, 0.0f};
+    }
+    else if (t + 1 >= nr_tiles)
+    {
+      interpolation[i] = {t, t, 0.0f};
+    }
+    else
+    {
+      const auto c0 = center(t);
+      const auto c1 = center(t + 1);
+      interpolation[i] = {t, t + 1, static_cast<float32_t>((pos - c0) / (c1 - c0))};
+    }
+  }
+
+  return interpolation;
+}
+
+template <typename T, std::size_t N, typename DerivedSrc, typename DerivedDst>
+void apply_channel_luts(const ImageBase<DerivedSrc>& img_src,
+                        ImageBase<DerivedDst>& img_dst,
+                        const std::array<std::vector<T>, N>& luts,
+                        int nr_threads)
+{
+  const auto width = static_cast<std::ptrdiff_t>(img_src.width());
+  const auto height = static_cast<std::size_t>(img_src.height());
+  const auto nr_elements = static_cast<std::size_t>(width) * height * N;
+  const auto nr_tasks = std::min(
+      height, impl::get_nr_tasks(nr_elements, histogram_min_task_size, impl::get_nr_threads(nr_threads)));
+
+  std::array<const T*, N> tables;
+  for (std::size_t c = 0; c < N; ++c)
+  {
+    tables[c] = luts[c].data();
+  }
+
+  impl::parallel_for(nr_tasks, nr_tasks, [&](std::size_t task) {
+    const auto y_begin = PixelIndex{static_cast<PixelIndex::value_type>(height * task / nr_tasks)};
+    const auto y_end = PixelIndex{static_cast<PixelIndex::value_type>(height * (task + 1) / nr_tasks)};
+
+    for (auto y = y_begin; y < y_end; ++y)
+    {
+      impl::apply_luts_row<N>(reinterpret_cast<const T*>(img_src.byte_ptr(y)), reinterpret_cast<T*>(img_dst.byte_ptr(y)),
+                              width, tables);
+    }
+  });
+}
+
+}  // namespace impl
+
+/// \addtogroup group-img-ops
+/// @{
+
+/** \brief Computes the histogram(s) of an image.
+ *
+ * Supported are images with 8-bit or 16-bit unsigned integral elements, resulting in histograms of 256 or 65536 bins,
+ * respectively.
+ *
+ * The image is split into contiguous row ranges, which are processed in parallel. Each of these tasks counts into
+ * multiple private sub-histograms (consecutive elements into different ones), to avoid store-to-load conflicts on runs
+ * of equal values. All sub-histograms are merged at the end. The number of tasks depends on the image size; small
+ * images are processed on the calling thread.
+ *
+ * @tparam mode Whether to compute one histogram per channel, or one joint histogram over all channels.
+ * @tparam DerivedSrc The typed image type.
+ * @param img The input image.
+ * @param nr_threads The number of threads to use. A value <= 0 denotes the number of concurrent threads supported by
+ *                   the hardware.
+ * @return A `std::array<HistogramBins, M>`, where `M` is the number of channels for `HistogramMode::PerChannel`, and 1
+ *         for `HistogramMode::Joint`.
+ */
+template <HistogramMode mode, typename DerivedSrc>
+auto histogram(const ImageBase<DerivedSrc>& img, int nr_threads)
+{
+  using PixelType = typename ImageBase<DerivedSrc>::PixelType;
+  using T = typename PixelTraits<PixelType>::Element;
+  constexpr auto nr_channels = static_cast<std::size_t>(PixelTraits<PixelType>::nr_channels);
+  static_assert(impl::is_histogram_element_type_v<T>, "Histograms are only supported for 8-bit or 16-bit unsigned elements");
+
+  return impl::compute_histogram<T, nr_channels, mode>(img, nr_threads);
+}
+
+/** \brief Computes the histogram(s) of a region of an image.
+ *
+ * See `histogram(const ImageBase<DerivedSrc>&, int)` for details. The region is clipped to the image bounds.
+ *
+ * @tparam mode Whether to compute one histogram per channel, or one joint histogram over all channels.
+ * @tparam DerivedSrc The typed image type.
+ * @param img The input image.
+ * @param region The image region to compute the histogram(s) of.
+ * @param nr_threads The number of threads to use. A value <= 0 denotes the number of concurrent threads supported by
+ *                   the hardware.
+ * @return A `std::array<HistogramBins, M>`, where `M` is the number of channels for `HistogramMode::PerChannel`, and 1
+ *         for `HistogramMode::Joint`.
+ */
+template <HistogramMode mode, typename DerivedSrc>
+auto histogram(const ImageBase<DerivedSrc>& img, const BoundingBox& region, int nr_threads)
+{
+  auto sanitized_region = region;
+  sanitized_region.sanitize(img.width(), img.height());
+  return histogram<mode>(view(img, sanitized_region), nr_threads);
+}
+
+/** \brief Performs histogram equalization of an image.
+ *
+ * Each channel is equalized separately, based on its own histogram. Channels consisting of one value only are left
+ * unchanged.
+ * `img_dst` will be (re-)allocated if necessary; `img_dst` and `img_src` may refer to the same image.
+ *
+ * @tparam DerivedSrc The typed source image type.
+ * @tparam DerivedDst The typed target image type.
+ * @param img_src The source image.
+ * @param img_dst The target image.
+ * @param nr_threads The number of threads to use. A value <= 0 denotes the number of concurrent threads supported by
+ *                   the hardware.
+ */
+template <typename DerivedSrc, typename DerivedDst>
+void equalize_histogram(const ImageBase<DerivedSrc>& img_src, ImageBase<DerivedDst>& img_dst, int nr_threads)
+{
+  using PixelType = typename ImageBase<DerivedSrc>::PixelType;
+  using T = typename PixelTraits<PixelType>::Element;
+  constexpr auto nr_channels = static_cast<std::size_t>(PixelTraits<PixelType>::nr_channels);
+  static_assert(std::is_same_v<PixelType, typename ImageBase<DerivedDst>::PixelType>, "Pixel type mismatch");
+
+  const auto histograms = histogram<HistogramMode::PerChannel>(img_src, nr_threads);
+
+  std::array<std::vector<T>, nr_channels> luts;
+  for (std::size_t c = 0; c < nr_channels; ++c)
+  {
+    luts[c] = impl::equalization_lut<T>(histograms[c]);
+  }
+
+  allocate(img_dst, {img_src.width(), img_src.height()});
+  impl::apply_channel_luts<T, nr_channels>(img_src, img_dst, luts, nr_threads);
+}
+
+/** \brief Performs histogram equalization of an image.
+ *
+ * See `equalize_histogram(const ImageBase<DerivedSrc>&, ImageBase<DerivedDst>&, int)` for details.
+ *
+ * @tparam DerivedSrc The typed source image type.
+ * @param img_src The source image.
+ * @param nr_threads The number of threads to use. A value <= 0 denotes the number of concurrent threads supported by
+ *                   the hardware.
+ * @return The equalized image.
+ */
+template <typename DerivedSrc>
+Image<typename DerivedSrc::PixelType> equalize_histogram(const ImageBase<DerivedSrc>& img_src, int nr_threads)
+{
+  Image<typename DerivedSrc::PixelType> img_dst;
+  equalize_histogram(img_src, img_dst, nr_threads);
+  return img_dst;
+}
+
+/** \brief Performs contrast limited adaptive histogram equalization (CLAHE) of an image.
+ *
+ * The image is divided into `nr_tiles_x` x `nr_tiles_y` tiles. For each tile, a histogram is computed and clipped at
+ * `clip_limit` times the average bin count, with the excess redistributed over all bins; its cumulative distribution
+ * then defines the tile's mapping function. Each output pixel is bilinearly interpolated between the mappings of the
+ * four nearest tile centers. A non-positive `clip_limit` disables clipping (i.e. results in adaptive histogram
+ * equalization).
+ *
+ * Each channel is processed separately. Tile histograms and the output rows are computed in parallel.
+ * `img_dst` will be (re-)allocated if necessary; it must not refer to the same image as `img_src`.
+ *
+ * @tparam DerivedSrc The typed source image type.
+ * @tparam DerivedDst The typed target image type.
+ * @param img_src The source image.
+ * @param img_dst The target image.
+ * @param nr_tiles_x The number of tiles in x-direction.
+ * @param nr_tiles_y The number of tiles in y-direction.
+ * @param clip_limit The relative clip limit.
+ * @param nr_threads The number of threads to use. A value <= 0 denotes the number of concurrent threads supported by
+ *                   the hardware.
+ */
+template <typename DerivedSrc, typename DerivedDst>
+void clahe(const ImageBase<DerivedSrc>& img_src,
+           ImageBase<DerivedDst>& img_dst,
+           std::size_t nr_tiles_x,
+           std::size_t nr_tiles_y,
+           float64_t clip_limit,
+           int nr_threads)
+{
+  using PixelType = typename ImageBase<DerivedSrc>::PixelType;
+  using T = typename PixelTraits<PixelType>::Element;
+  constexpr auto nr_channels = static_cast<std::size_t>(PixelTraits<PixelType>::nr_channels);
+  static_assert(std::is_same_v<PixelType, typename ImageBase<DerivedDst>::PixelType>, "Pixel type mismatch");
+  static_assert(impl::is_histogram_element_type_v<T>, "CLAHE is only supported for 8-bit or 16-bit unsigned elements");
+
+  const auto width = static_cast<std::size_t>(img_src.width());
+  const auto height = static_cast<std::size_t>(img_src.height());
+
+  allocate(img_dst, {img_src.width(), img_src.height()});
+
+  if (width == 0 || height == 0)
+  {
+    return;
+  }
+
+  SELENE_ASSERT(nr_tiles_x > 0 && nr_tiles_y > 0);
+  const auto tile_width = (width + std::min(nr_tiles_x, width) - 1) / std::min(nr_tiles_x, width);
+  const auto tile_height = (height + std::min(nr_tiles_y, height) - 1) / std::min(nr_tiles_y, height);
+  nr_tiles_x = (width + tile_width - 1) / tile_width;
+  nr_tiles_y = (height + tile_height - 1) / tile_height;
+
+  // Mapping functions of all tiles: luts[(ty * nr_tiles_x + tx) * nr_channels + c]
+  std::vector<std::vector<T>> luts(nr_tiles_x * nr_tiles_y * nr_channels);
+
+  // Both passes are sized by the number of elements, s.t. small images are processed on the calling thread.
+  const auto nr_elements = width * height * nr_channels;
+  const auto nr_tasks_max = impl::get_nr_tasks(nr_elements, impl::histogram_min_task_size,
+                                               impl::get_nr_threads(nr_threads));
+
+  impl::parallel_for(nr_tiles_x * nr_tiles_y, nr_tasks_max, [&](std::size_t tile) {
+    const auto tx = tile % nr_tiles_x;
+    const auto ty = tile / nr_tiles_x;
+    const auto x0 = tx * tile_width;
+    const auto y0 = ty * tile_height;
+    const auto tile_w = std::min(width, x0 + tile_width) - x0;
+    const auto tile_h = std::min(height, y0 + tile_height) - y0;
+
+    const BoundingBox region(PixelIndex{static_cast<PixelIndex::value_type>(x0)},
+                             PixelIndex{static_cast<PixelIndex::value_type>(y0)},
+                             PixelLength{static_cast<PixelLength::value_type>(tile_w)},
+                             PixelLength{static_cast<PixelLength::value_type>(tile_h)});
+    const auto histograms = histogram<HistogramMode::PerChannel>(img_src, region, 1);
+
+    for (std::size_t c = 0; c < nr_channels; ++c)
+    {
+      luts[tile * nr_channels + c] = impl::clahe_tile_lut<T>(histograms[c], tile_w * tile_h, clip_limit);
+    }
+  });
+
+  const auto interpolation_x = impl::clahe_interpolation(width, tile_width, nr_tiles_x);
+  const auto interpolation_y = impl::clahe_interpolation(height, tile_height, nr_tiles_y);
+  const auto nr_tasks = std::min(height, nr_tasks_max);
+
+  impl::parallel_for(nr_tasks, nr_tasks, [&](std::size_t task) {
+    const auto y_begin = height * task / nr_tasks;
+    const auto y_end = height * (task + 1) / nr_tasks;
+
+    for (auto y = y_begin; y < y_end; ++y)
+    {
+      const auto& iy = interpolation_y[y];
+      const auto row_0 = iy.tile_0 * nr_tiles_x;
+      const auto row_1 = iy.tile_1 * nr_tiles_x;
+      const auto src = reinterpret_cast<const T*>(img_src.byte_ptr(PixelIndex{static_cast<PixelIndex::value_type>(y)}));
+      const auto dst = reinterpret_cast<T*>(img_dst.byte_ptr(PixelIndex{static_cast<PixelIndex::value_type>(y)}));
+
+      for (std::size_t x = 0; x < width; ++x)
+      {
+        const auto& ix = interpolation_x[x];
+        for (std::size_t c = 0; c < nr_channels; ++c)
+        {
+          const auto v = src[nr_channels * x + c];
+          const auto lut = [&](std::size_t tile) {
+            return static_cast<float32_t>(luts[tile * nr_channels + c][v]);
+          };
+          const auto top = lut(row_0 + ix.tile_0) + ix.weight_1 * (lut(row_0 + ix.tile_1) - lut(row_0 + ix.tile_0));
+          const auto bottom = lut(row_1 + ix.tile_0) + ix.weight_1 * (lut(row_1 + ix.tile_1) - lut(row_1 + ix.tile_0));
+          dst[nr_channels * x + c] = static_cast<T>(top + iy.weight_1 * (bottom - top) + 0.5f);
+        }
+      }
+    }
+  });
+}
+
+/** \brief Performs contrast limited adaptive histogram equalization (CLAHE) of an image.
+ *
+ * See `clahe(const ImageBase<DerivedSrc>&, ImageBase<DerivedDst>&, std::size_t, std::size_t, float64_t, int)` for
+ * details.
+ *
+ * @tparam DerivedSrc The typed source image type.
+ * @param img_src The source image.
+ * @param nr_tiles_x The number of tiles in x-direction.
+ * @param nr_tiles_y The number of tiles in y-direction.
+ * @param clip_limit The relative clip limit.
+ * @param nr_threads The number of threads to use. A value <= 0 denotes the number of concurrent threads supported by
+ *                   the hardware.
+ * @return The equalized image.
+ */
+template <typename DerivedSrc>
+Image<typename DerivedSrc::PixelType> clahe(const ImageBase<DerivedSrc>& img_src,
+                                            std::size_t nr_tiles_x,
+                                            std::size_t nr_tiles_y,
+                                            float64_t clip_limit,
+                                            int nr_threads)
+{
+  Image<typename DerivedSrc::PixelType> img_dst;
+  clahe(img_src, img_dst, nr_tiles_x, nr_tiles_y, clip_limit, nr_threads);
+  return img_dst;
+}
+
+/// @}
+
+}  // namespace sln
+
+#endif  // SELENE_IMG_OPS_HISTOGRAM_HPP
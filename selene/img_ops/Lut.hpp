@@ -0,0 +1,333 @@
+// This file is part of the `Selene` library.
+// Copyright 2017-2019 Michael Hofmann (https://github.com/kmhofmann).
+// Distributed under MIT license. See accompanying LICENSE file in the top-level directory.
+
+#ifndef SELENE_IMG_OPS_LUT_HPP
+#define SELENE_IMG_OPS_LUT_HPP
+
+/// @file
+
+#include <selene/img/pixel/Pixel.hpp>
+#include <selene/img/pixel/PixelTraits.hpp>
+
+#include <selene/img/typed/Image.hpp>
+#include <selene/img/typed/ImageBase.hpp>
+
+#include <selene/img_ops/Allocate.hpp>
+
+#include <selene/img_ops/_impl/LutKernels.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace sln {
+
+/// \addtogroup group-img-ops
+/// @{
+
+/** \brief A look-up table (LUT), mapping each possible value of an 8-bit or 16-bit unsigned input type to an output
+ * value.
+ *
+ * A `Lut` is built once from a callable, which is evaluated for every possible input value.
+ * A table for 8-bit inputs (256 entries) is stored inline, and its construction is `constexpr`, so that it can be
+ * computed at compile time, e.g.
+ * `constexpr auto lut = sln::make_lut<std::uint8_t>([](std::uint8_t v) { return std::uint8_t(255 - v); });`
+ * A table for 16-bit inputs (65536 entries) is allocated on the heap; the `Lut` object itself is small, and can be kept
+ * on the stack, or be returned by value. After being moved from, it must not be accessed anymore.
+ *
+ * The output type may be an arithmetic type, or a pixel type (e.g. for palette expansion of single-channel images).
+ *
+ * See `apply_lut()` for its application to images.
+ *
+ * @tparam In The input type; `std::uint8_t` or `std::uint16_t`.
+ * @tparam Out The output type.
+ */
+template <typename In, typename Out = In>
+class Lut
+{
+public:
+  static_assert(std::is_same_v<In, std::uint8_t> || std::is_same_v<In, std::uint16_t>,
+                "LUT input type has to be std::uint8_t or std::uint16_t");
+
+  using InputType = In;  ///< The input type.
+  using OutputType = Out;  ///< The output type.
+
+  static constexpr std::size_t nr_entries = std::size_t{1} << (8 * sizeof(In));  ///< The number of table entries.
+
+  constexpr Lut() = default;  ///< Default constructor. All table entries are value-initialized.
+
+  template <typename Function, typename = std::enable_if_t<std::is_invocable_v<Function, In>>>
+  constexpr explicit Lut(Function func);
+
+  constexpr const Out& operator[](In value) const noexcept;
+  constexpr Out& operator[](In value) noexcept;
+
+  constexpr const Out* data() const noexcept;
+  constexpr Out* data() noexcept;
+
+private:
+  impl::LutTable<Out, nr_entries> table_;
+};
+
+template <typename In, typename Out = In, typename Function>
+constexpr Lut<In, Out> make_lut(Function func);
+
+template <typename DerivedSrc, typename DerivedDst, typename In, typename Out>
+void apply_lut(const ImageBase<DerivedSrc>& img_src, ImageBase<DerivedDst>& img_dst, const Lut<In, Out>& lut);
+
+template <typename DerivedSrc, typename DerivedDst, typename In, typename Out, std::size_t N>
+void apply_lut(const ImageBase<DerivedSrc>& img_src,
+               ImageBase<DerivedDst>& img_dst,
+               const std::array<Lut<In, Out>, N>& luts);
+
+template <typename DerivedSrc, typename In, typename Out>
+auto apply_lut(const ImageBase<DerivedSrc>& img_src, const Lut<In, Out>& lut);
+
+template <typename DerivedSrc, typename In, typename Out, std::size_t N>
+auto apply_lut(const ImageBase<DerivedSrc>& img_src, const std::array<Lut<In, Out>, N>& luts);
+
+/// @}
+
+// ----------
+// Implementation:
+
+namespace impl {
+
+// Output pixel type of a LUT application: the element type is replaced for arithmetic output types; pixel output
+// types (which require a single-channel input) replace the whole pixel.
+template <typename PixelTypeSrc, typename Out, typename = void>
+struct LutOutputPixel
+{
+  using type = Pixel<Out,
+                     static_cast<std::size_t>(PixelTraits<PixelTypeSrc>::nr_channels),
+                     PixelTraits<PixelTypeSrc>::pixel_format>;
+};
+
+template <typename PixelTypeSrc, typename Out>
+struct LutOutputPixel<PixelTypeSrc, Out, std::enable_if_t<!std::is_arithmetic_v<Out>>>
+{
+  static_assert(PixelTraits<PixelTypeSrc>::nr_channels == 1, "LUTs with pixel outputs require single-channel inputs");
+  using type = Out;
+};
+
+template <typename PixelTypeSrc, typename Out>
+using lut_output_pixel_t = typename LutOutputPixel<PixelTypeSrc, Out>::type;
+
+template <typename DerivedSrc, typename DerivedDst, typename In, typename Out>
+void static_check_lut_compatibility()
+{
+  using PixelTypeSrc = typename ImageBase<DerivedSrc>::PixelType;
+  using PixelTypeDst = typename ImageBase<DerivedDst>::PixelType;
+  static_assert(std::is_same_v<typename PixelTraits<PixelTypeSrc>::Element, In>, "Source element type mismatch");
+  static_assert(std::is_same_v<PixelTypeDst, lut_output_pixel_t<PixelTypeSrc, Out>>
+                    || (PixelTraits<PixelTypeDst>::nr_channels == PixelTraits<PixelTypeSrc>::nr_channels
+                        && std::is_same_v<typename PixelTraits<PixelTypeDst>::Element, Out>),
+                "Target pixel type mismatch");
+}
+
+}  // namespace impl
+
+/** \brief Constructs a look-up table by evaluating `func` for every possible input value.
+ *
+ * @tparam In The input type.
+ * @tparam Out The output type.
+ * @tparam Function The function type.
+ * @param func The function to evaluate. Its signature should be `Out f(In)`, or any compatible callable.
+ */
+template <typename In, typename Out>
+template <typename Function, typename>
+constexpr Lut<In, Out>::Lut(Function func)
+{
+  for (std::size_t i = 0; i < nr_entries; ++i)
+  {
+    table_.data()[i] = static_cast<Out>(func(static_cast<In>(i)));
+  }
+}
+
+/** \brief Returns the table entry for the specified input value.
+ *
+ * @tparam In The input type.
+ * @tparam Out The output type.
+ * @param value The input value.
+ * @return A constant reference to the output value.
+ */
+template <typename In, typename Out>
+constexpr const Out& Lut<In, Out>::operator[](In value) const noexcept
+{
+  return table_.data()[value];
+}
+
+/** \brief Returns the table entry for the specified input value.
+ *
+ * @tparam In The input type.
+ * @tparam Out The output type.
+ * @param value The input value.
+ * @return A reference to the output value.
+ */
+template <typename In, typename Out>
+constexpr Out& Lut<In, Out>::operator[](In value) noexcept
+{
+  return table_.data()[value];
+}
+
+/** \brief Returns a pointer to the first table entry.
+ *
+ * @tparam In The input type.
+ * @tparam Out The output type.
+ * @return A constant pointer to the table of `nr_entries` output values.
+ */
+template <typename In, typename Out>
+constexpr const Out* Lut<In, Out>::data() const noexcept
+{
+  return table_.data();
+}
+
+/** \brief Returns a pointer to the first table entry.
+ *
+ * @tparam In The input type.
+ * @tparam Out The output type.
+ * @return A pointer to the table of `nr_entries` output values.
+ */
+template <typename In, typename Out>
+constexpr Out* Lut<In, Out>::data() noexcept
+{
+  return table_.data();
+}
+
+/** \brief Constructs a look-up table by evaluating `func` for every possible input value.
+ *
+ * @tparam In The input type.
+ * @tparam Out The output type.
+ * @tparam Function The function type.
+ * @param func The function to evaluate. Its signature should be `Out f(In)`, or any compatible callable.
+ * @return The look-up table.
+ */
+template <typename In, typename Out, typename Function>
+constexpr Lut<In, Out> make_lut(Function func)
+{
+  return Lut<In, Out>(func);
+}
+
+/** \brief Applies a look-up table to each pixel element of an image.
+ *
+ * The same table is applied to all channels. If its output type is a pixel type, the source image has to be a
+ * single-channel image, and each pixel is replaced by the respective output pixel (e.g. for palette expansion).
+ *
+ * `img_dst` will be (re-)allocated if necessary. If the input and output types are the same, `img_dst` and `img_src`
+ * may refer to the same image.
+ *
+ * @tparam DerivedSrc The typed source image type.
+ * @tparam DerivedDst The typed target image type.
+ * @tparam In The LUT input type.
+ * @tparam Out The LUT output type.
+ * @param img_src The source image.
+ * @param img_dst The target image.
+ * @param lut The look-up table.
+ */
+template <typename DerivedSrc, typename DerivedDst, typename In, typename Out>
+void apply_lut(const ImageBase<DerivedSrc>& img_src, ImageBase<DerivedDst>& img_dst, const Lut<In, Out>& lut)
+{
+  using PixelTypeSrc = typename ImageBase<DerivedSrc>::PixelType;
+  constexpr auto nr_channels = static_cast<std::size_t>(PixelTraits<PixelTypeSrc>::nr_channels);
+  impl::static_check_lut_compatibility<DerivedSrc, DerivedDst, In, Out>();
+
+  allocate(img_dst, {img_src.width(), img_src.height()});
+
+  const auto nr_elements = static_cast<std::ptrdiff_t>(img_src.width())
+                           * static_cast<std::ptrdiff_t>(std::is_arithmetic_v<Out> ? nr_channels : 1);
+
+  for (auto y = 0_idx; y < img_src.height(); ++y)
+  {
+    impl::apply_lut_row(reinterpret_cast<const In*>(img_src.byte_ptr(y)), reinterpret_cast<Out*>(img_dst.byte_ptr(y)),
+                        nr_elements, lut.data());
+  }
+}
+
+/** \brief Applies a separate look-up table to each channel of an image.
+ *
+ * `img_dst` will be (re-)allocated if necessary. If the input and output types are the same, `img_dst` and `img_src`
+ * may refer to the same image.
+ *
+ * @tparam DerivedSrc The typed source image type.
+ * @tparam DerivedDst The typed target image type.
+ * @tparam In The LUT input type.
+ * @tparam Out The LUT output type.
+ * @tparam N The number of channels.
+ * @param img_src The source image.
+ * @param img_dst The target image.
+ * @param luts The look-up tables; one per channel.
+ */
+template <typename DerivedSrc, typename DerivedDst, typename In, typename Out, std::size_t N>
+void apply_lut(const ImageBase<DerivedSrc>& img_src,
+               ImageBase<DerivedDst>& img_dst,
+               const std::array<Lut<In, Out>, N>& luts)
+{
+  using PixelTypeSrc = typename ImageBase<DerivedSrc>::PixelType;
+  static_assert(static_cast<std::size_t>(PixelTraits<PixelTypeSrc>::nr_channels) == N, "Number of LUTs mismatch");
+  static_assert(std::is_arithmetic_v<Out>, "Per-channel LUTs need to have arithmetic output types");
+  impl::static_check_lut_compatibility<DerivedSrc, DerivedDst, In, Out>();
+
+  allocate(img_dst, {img_src.width(), img_src.height()});
+
+  std::array<const Out*, N> tables;
+  for (std::size_t c = 0; c < N; ++c)
+  {
+    tables[c] = luts[c].data();
+  }
+
+  const auto width = static_cast<std::ptrdiff_t>(img_src.width());
+  for (auto y = 0_idx; y < img_src.height(); ++y)
+  {
+    impl::apply_luts_row<N>(reinterpret_cast<const In*>(img_src.byte_ptr(y)),
+                            reinterpret_cast<Out*>(img_dst.byte_ptr(y)), width, tables);
+  }
+}
+
+/** \brief Applies a look-up table to each pixel element of an image.
+ *
+ * See `apply_lut(const ImageBase<DerivedSrc>&, ImageBase<DerivedDst>&, const Lut<In, Out>&)` for details.
+ *
+ * @tparam DerivedSrc The typed source image type.
+ * @tparam In The LUT input type.
+ * @tparam Out The LUT output type.
+ * @param img_src The source image.
+ * @param lut The look-up table.
+ * @return An image of the same pixel format (and number of channels) with element type `Out`; or, if `Out` is a pixel
+ *         type, an image of pixel type `Out`.
+ */
+template <typename DerivedSrc, typename In, typename Out>
+auto apply_lut(const ImageBase<DerivedSrc>& img_src, const Lut<In, Out>& lut)
+{
+  using PixelTypeDst = impl::lut_output_pixel_t<typename ImageBase<DerivedSrc>::PixelType, Out>;
+  Image<PixelTypeDst> img_dst;
+  apply_lut(img_src, img_dst, lut);
+  return img_dst;
+}
+
+/** \brief Applies a separate look-up table to each channel of an image.
+ *
+ * See `apply_lut(const ImageBase<DerivedSrc>&, ImageBase<DerivedDst>&, const std::array<Lut<In, Out>, N>&)` for
+ * details.
+ *
+ * @tparam DerivedSrc The typed source image type.
+ * @tparam In The LUT input type.
+ * @tparam Out The LUT output type.
+ * @tparam N The number of channels.
+ * @param img_src The source image.
+ * @param luts The look-up tables; one per channel.
+ * @return An image of the same pixel format (and number of channels) with element type `Out`.
+ */
+template <typename DerivedSrc, typename In, typename Out, std::size_t N>
+auto apply_lut(const ImageBase<DerivedSrc>& img_src, const std::array<Lut<In, Out>, N>& luts)
+{
+  using PixelTypeDst = impl::lut_output_pixel_t<typename ImageBase<DerivedSrc>::PixelType, Out>;
+  Image<PixelTypeDst> img_dst;
+  apply_lut(img_src, img_dst, luts);
+  return img_dst;
+}
+
+}  // namespace sln
+
+#endif  // SELENE_IMG_OPS_LUT_HPP
@@ -0,0 +1,266 @@
+// This file is part of the `Selene` library.
+// Copyright 2017-2019 Michael Hofmann (https://github.com/kmhofmann).
+// Distributed under MIT license. See accompanying LICENSE file in the top-level directory.
+
+#ifndef SELENE_IMG_OPS_MEDIAN_FILTER_HPP
+#define SELENE_IMG_OPS_MEDIAN_FILTER_HPP
+
+/// @file
+
+#include <selene/base/Assert.hpp>
+#include <selene/base/_impl/ParallelFor.hpp>
+
+#include <selene/img/common/Types.hpp>
+#include <selene/img/pixel/PixelTraits.hpp>
+
+#include <selene/img/typed/Image.hpp>
+#include <selene/img/typed/ImageBase.hpp>
+
+#include <selene/img/typed/access/BorderAccessors.hpp>
+
+#include <selene/img_ops/Allocate.hpp>
+
+#include <selene/img_ops/_impl/BorderPadding.hpp>
+#include <selene/img_ops/_impl/MedianFilterKernels.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+namespace sln {
+
+/// \addtogroup group-img-ops
+/// @{
+
+/// The maximum radius supported by `median_filter`.
+constexpr std::size_t median_filter_max_radius = 127;
+
+template <BorderAccessMode access_mode = BorderAccessMode::Replicated, typename DerivedSrc, typename DerivedDst>
+void median_filter(const ImageBase<DerivedSrc>& img_src,
+                   ImageBase<DerivedDst>& img_dst,
+                   std::size_t radius,
+                   int nr_threads = 0);
+
+template <BorderAccessMode access_mode = BorderAccessMode::Replicated, typename DerivedSrc>
+Image<typename DerivedSrc::PixelType> median_filter(const ImageBase<DerivedSrc>& img_src,
+                                                    std::size_t radius,
+                                                    int nr_threads = 0);
+
+/// @}
+
+// ----------
+// Implementation:
+
+namespace impl {
+
+// Minimum number of pixels per row band. Smaller images are processed on the calling thread.
+constexpr std::size_t median_filter_min_band_size = std::size_t{64} * 1024;
+
+// Computes the median filter of rows [y_begin, y_end) using a selection network of size (2 * radius + 1)^2.
+template <std::ptrdiff_t radius, BorderAccessMode access_mode, std::size_t N, typename DerivedSrc, typename DerivedDst>
+void median_filter_rows_network(const ImageBase<DerivedSrc>& img_src,
+                                ImageBase<DerivedDst>& img_dst,
+                                std::ptrdiff_t y_begin,
+                                std::ptrdiff_t y_end)
+{
+  constexpr auto k = 2 * radius + 1;
+  const auto width = static_cast<std::ptrdiff_t>(img_src.width());
+  const auto padded_len = static_cast<std::size_t>(N) * static_cast<std::size_t>(width + 2 * radius);
+
+  // Ring buffer of the k most recent padded rows; row y is held in slot (y mod k).
+  std::array<std::vector<std::uint8_t>, k> lines;
+  std::array<const std::uint8_t*, k> slots{};
+  for (auto& line : lines)
+  {
+    line.resize(padded_len);
+  }
+
+  const auto slot_index = [](std::ptrdiff_t y) { return static_cast<std::size_t>(((y % k) + k) % k); };
+  const auto load_row = [&](std::ptrdiff_t y) {
+    const auto s = slot_index(y);
+    slots[s] = padded_row<access_mode, std::uint8_t, N>(img_src, y, radius, radius, lines[s]);
+  };
+
+  for (auto y = y_begin - radius; y < y_begin + radius; ++y)
+  {
+    load_row(y);
+  }
+
+  std::vector<std::uint8_t> buffer(radius == 1 ? 3 * padded_len : 0);
+  std::array<const std::uint8_t*, k> rows;
+
+  for (auto y = y_begin; y < y_end; ++y)
+  {
+    load_row(y + radius);
+    for (std::ptrdiff_t j = 0; j < k; ++j)
+    {
+      rows[static_cast<std::size_t>(j)] = slots[slot_index(y - radius + j)];
+    }
+
+    const auto dst = reinterpret_cast<std::uint8_t*>(img_dst.byte_ptr(PixelIndex{static_cast<PixelIndex::value_type>(y)}));
+    if constexpr (radius == 1)
+    {
+      median_3x3_row<N>(rows.data(), dst, width, buffer.data());
+    }
+    else
+    {
+      median_5x5_row<N>(rows.data(), dst, width);
+    }
+  }
+}
+
+// Computes the median filter of rows [y_begin, y_end) using sliding column histograms.
+template <BorderAccessMode access_mode, std::size_t N, typename DerivedSrc, typename DerivedDst>
+void median_filter_rows_histogram(const ImageBase<DerivedSrc>& img_src,
+                                  ImageBase<DerivedDst>& img_dst,
+                                  std::ptrdiff_t radius,
+                                  std::ptrdiff_t y_begin,
+                                  std::ptrdiff_t y_end)
+{
+  const auto width = static_cast<std::ptrdiff_t>(img_src.width());
+  const auto padded_width = width + 2 * radius;
+  const auto nr_columns = N * static_cast<std::size_t>(padded_width);
+
+  std::vector<std::uint8_t> line(nr_columns);
+  std::vector<std::uint16_t> col_coarse(nr_columns * median_nr_coarse_bins, 0);
+  std::vector<std::uint16_t> col_fine(nr_columns * median_nr_fine_bins, 0);
+
+  const auto update = [&](auto add, std::ptrdiff_t y) {
+    const auto row = padded_row<access_mode, std::uint8_t, N>(img_src, y, radius, radius, line);
+    median_update_column_histograms<decltype(add)::value, N>(row, padded_width, col_coarse.data(), col_fine.data());
+  };
+
+  for (auto y = y_begin - radius; y < y_begin + radius; ++y)
+  {
+    update(std::true_type{}, y);
+  }
+
+  for (auto y = y_begin; y < y_end; ++y)
+  {
+    if (y > y_begin)
+    {
+      update(std::false_type{}, y - radius - 1);
+    }
+    update(std::true_type{}, y + radius);
+
+    const auto dst = reinterpret_cast<std::uint8_t*>(img_dst.byte_ptr(PixelIndex{static_cast<PixelIndex::value_type>(y)}));
+    for (std::size_t c = 0; c < N; ++c)
+    {
+      const auto col_offset = c * static_cast<std::size_t>(padded_width);
+      median_histogram_row<N>(col_coarse.data() + col_offset * median_nr_coarse_bins,
+                              col_fine.data() + col_offset * median_nr_fine_bins, dst + c, width, radius);
+    }
+  }
+}
+
+}  // namespace impl
+
+/** \brief Applies a median filter to the source image; i.e. replaces each pixel (channel-wise) by the median over the
+ * square neighborhood of size (2 * radius + 1) x (2 * radius + 1).
+ *
+ * Only images with 8-bit unsigned elements are supported.
+ * Neighborhoods of size 3x3 and 5x5 are computed using min/max selection networks; for larger sizes, the cost per pixel
+ * is constant, i.e. independent of the radius (Perreault-Hébert algorithm).
+ * The rows of the image are processed in parallel bands. Each band spans at least 4 * radius rows, s.t. the rows
+ * additionally loaded above and below each band do not dominate; small images are processed on the calling thread.
+ *
+ * Source and target image may not be the same image.
+ *
+ * @tparam access_mode The border access mode to be used when going outside the image bounds.
+ *                     `BorderAccessMode::Replicated` by default.
+ *                     `BorderAccessMode::Unchecked` requires the source image to be a view into a larger image, such
+ *                     that all neighborhood pixels can be accessed.
+ * @tparam DerivedSrc The typed source image type.
+ * @tparam DerivedDst The typed target image type.
+ * @param img_src The source image.
+ * @param img_dst The target image.
+ * @param radius The neighborhood radius. Has to be at most `median_filter_max_radius`. A radius of 0 copies the image.
+ * @param nr_threads The number of threads to use. A value <= 0 denotes the number of concurrent threads supported by
+ *                   the hardware.
+ */
+template <BorderAccessMode access_mode, typename DerivedSrc, typename DerivedDst>
+void median_filter(const ImageBase<DerivedSrc>& img_src,
+                   ImageBase<DerivedDst>& img_dst,
+                   std::size_t radius,
+                   int nr_threads)
+{
+  using PixelType = typename DerivedSrc::PixelType;
+  constexpr auto N = static_cast<std::size_t>(PixelTraits<PixelType>::nr_channels);
+  static_assert(std::is_same_v<typename PixelTraits<PixelType>::Element, std::uint8_t>,
+                "Median filtering requires 8-bit unsigned pixel elements");
+  static_assert(std::is_same_v<PixelType, typename DerivedDst::PixelType>, "Incompatible source and target types");
+  SELENE_ASSERT(radius <= median_filter_max_radius);
+
+  allocate(img_dst, {img_src.width(), img_src.height()});
+
+  if (img_src.width() == 0 || img_src.height() == 0)
+  {
+    return;
+  }
+
+  const auto width = static_cast<std::size_t>(img_src.width());
+  const auto height = static_cast<std::size_t>(img_src.height());
+  const auto r = static_cast<std::ptrdiff_t>(radius);
+
+  // Each band first loads the 2 * radius rows surrounding it. Bands therefore span at least 4 * radius rows, which
+  // bounds this overhead independently of the number of threads, and cover a minimum number of pixels.
+  const auto max_nr_tasks = impl::get_nr_threads(nr_threads);
+  const auto nr_tasks = std::min(impl::get_nr_tasks(height, std::max(std::size_t{1}, 4 * radius), max_nr_tasks),
+                                 impl::get_nr_tasks(width * height, impl::median_filter_min_band_size, max_nr_tasks));
+
+  impl::parallel_for(nr_tasks, nr_tasks, [&](std::size_t task) {
+    const auto y_begin = static_cast<std::ptrdiff_t>(height * task / nr_tasks);
+    const auto y_end = static_cast<std::ptrdiff_t>(height * (task + 1) / nr_tasks);
+
+    if (r == 0)
+    {
+      for (auto y = y_begin; y < y_end; ++y)
+      {
+        const auto py = PixelIndex{static_cast<PixelIndex::value_type>(y)};
+        std::copy(img_src.byte_ptr(py), img_src.byte_ptr(py) + img_src.row_bytes(), img_dst.byte_ptr(py));
+      }
+    }
+    else if (r == 1)
+    {
+      impl::median_filter_rows_network<1, access_mode, N>(img_src, img_dst, y_begin, y_end);
+    }
+    else if (r == 2)
+    {
+      impl::median_filter_rows_network<2, access_mode, N>(img_src, img_dst, y_begin, y_end);
+    }
+    else
+    {
+      impl::median_filter_rows_histogram<access_mode, N>(img_src, img_dst, r, y_begin, y_end);
+    }
+  });
+}
+
+/** \brief Applies a median filter to the source image; i.e. replaces each pixel (channel-wise) by the median over the
+ * square neighborhood of size (2 * radius + 1) x (2 * radius + 1).
+ *
+ * See the overload taking a target image for details.
+ *
+ * @tparam access_mode The border access mode to be used when going outside the image bounds.
+ * @tparam DerivedSrc The typed source image type.
+ * @param img_src The source image.
+ * @param radius The neighborhood radius. Has to be at most `median_filter_max_radius`.
+ * @param nr_threads The number of threads to use. A value <= 0 denotes the number of concurrent threads supported by
+ *                   the hardware.
+ * @return The median filtered image.
+ */
+template <BorderAccessMode access_mode, typename DerivedSrc>
+Image<typename DerivedSrc::PixelType> median_filter(const ImageBase<DerivedSrc>& img_src,
+                                                    std::size_t radius,
+                                                    int nr_threads)
+{
+  Image<typename DerivedSrc::PixelType> img_dst;
+  median_filter<access_mode>(img_src, img_dst, radius, nr_threads);
+  return img_dst;
+}
+
+}  // namespace sln
+
+#endif  // SELENE_IMG_OPS_MEDIAN_FILTER_HPP
@@ -0,0 +1,568 @@
+// This file is part of the `Selene` library.
+// Copyright 2017-2019 Michael Hofmann (https://github.com/kmhofmann).
+// Distributed under MIT license. See accompanying LICENSE file in the top-level directory.
+
+#ifndef SELENE_IMG_OPS_MORPHOLOGY_HPP
+#define SELENE_IMG_OPS_MORPHOLOGY_HPP
+
+/// @file
+
+#include <selene/base/Assert.hpp>
+
+#include <selene/img/common/Types.hpp>
+#include <selene/img/pixel/PixelTraits.hpp>
+
+#include <selene/img/typed/Image.hpp>
+#include <selene/img/typed/ImageBase.hpp>
+
+#include <selene/img/typed/access/BorderAccessors.hpp>
+
+#include <selene/img_ops/Allocate.hpp>
+
+#include <selene/img_ops/_impl/BorderPadding.hpp>
+#include <selene/img_ops/_impl/MorphologyKernels.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+namespace sln {
+
+/// \addtogroup group-img-ops
+/// @{
+
+/** \brief Describes the shape of a structuring element.
+ */
+enum class StructuringElementShape
+{
+  Rectangle,  ///< All pixels of the (width x height) rectangle.
+  Cross,  ///< The center row and the center column of the (width x height) rectangle.
+};
+
+/** \brief Represents a flat structuring element for morphological operations, centered on each pixel.
+ *
+ * The structuring element spans the (width x height) rectangle with top-left corner ((1 - width) / 2, (1 - height) / 2)
+ * relative to the center pixel; i.e. it is symmetric for odd sizes.
+ */
+class StructuringElement
+{
+public:
+  constexpr StructuringElement(PixelLength width,
+                               PixelLength height,
+                               StructuringElementShape shape = StructuringElementShape::Rectangle) noexcept;
+
+  [[nodiscard]] constexpr PixelLength width() const noexcept;
+  [[nodiscard]] constexpr PixelLength height() const noexcept;
+  [[nodiscard]] constexpr StructuringElementShape shape() const noexcept;
+
+private:
+  PixelLength width_;
+  PixelLength height_;
+  StructuringElementShape shape_;
+};
+
+template <BorderAccessMode access_mode = BorderAccessMode::Replicated, typename DerivedSrc, typename DerivedDst>
+void erode(const ImageBase<DerivedSrc>& img_src, ImageBase<DerivedDst>& img_dst, const StructuringElement& se);
+
+template <BorderAccessMode access_mode = BorderAccessMode::Replicated, typename DerivedSrc>
+Image<typename DerivedSrc::PixelType> erode(const ImageBase<DerivedSrc>& img_src, const StructuringElement& se);
+
+template <BorderAccessMode access_mode = BorderAccessMode::Replicated, typename DerivedSrc, typename DerivedDst>
+void dilate(const ImageBase<DerivedSrc>& img_src, ImageBase<DerivedDst>& img_dst, const StructuringElement& se);
+
+template <BorderAccessMode access_mode = BorderAccessMode::Replicated, typename DerivedSrc>
+Image<typename DerivedSrc::PixelType> dilate(const ImageBase<DerivedSrc>& img_src, const StructuringElement& se);
+
+template <BorderAccessMode access_mode = BorderAccessMode::Replicated, typename DerivedSrc, typename DerivedDst>
+void opening(const ImageBase<DerivedSrc>& img_src, ImageBase<DerivedDst>& img_dst, const StructuringElement& se);
+
+template <BorderAccessMode access_mode = BorderAccessMode::Replicated, typename DerivedSrc>
+Image<typename DerivedSrc::PixelType> opening(const ImageBase<DerivedSrc>& img_src, const StructuringElement& se);
+
+template <BorderAccessMode access_mode = BorderAccessMode::Replicated, typename DerivedSrc, typename DerivedDst>
+void closing(const ImageBase<DerivedSrc>& img_src, ImageBase<DerivedDst>& img_dst, const StructuringElement& se);
+
+template <BorderAccessMode access_mode = BorderAccessMode::Replicated, typename DerivedSrc>
+Image<typename DerivedSrc::PixelType> closing(const ImageBase<DerivedSrc>& img_src, const StructuringElement& se);
+
+template <BorderAccessMode access_mode = BorderAccessMode::Replicated, typename DerivedSrc, typename DerivedDst>
+void morphological_gradient(const ImageBase<DerivedSrc>& img_src,
+                            ImageBase<DerivedDst>& img_dst,
+                            const StructuringElement& se);
+
+template <BorderAccessMode access_mode = BorderAccessMode::Replicated, typename DerivedSrc>
+Image<typename DerivedSrc::PixelType> morphological_gradient(const ImageBase<DerivedSrc>& img_src,
+                                                             const StructuringElement& se);
+
+template <BorderAccessMode access_mode = BorderAccessMode::Replicated, typename DerivedSrc, typename DerivedDst>
+void top_hat(const ImageBase<DerivedSrc>& img_src, ImageBase<DerivedDst>& img_dst, const StructuringElement& se);
+
+template <BorderAccessMode access_mode = BorderAccessMode::Replicated, typename DerivedSrc>
+Image<typename DerivedSrc::PixelType> top_hat(const ImageBase<DerivedSrc>& img_src, const StructuringElement& se);
+
+template <BorderAccessMode access_mode = BorderAccessMode::Replicated, typename DerivedSrc, typename DerivedDst>
+void black_hat(const ImageBase<DerivedSrc>& img_src, ImageBase<DerivedDst>& img_dst, const StructuringElement& se);
+
+template <BorderAccessMode access_mode = BorderAccessMode::Replicated, typename DerivedSrc>
+Image<typename DerivedSrc::PixelType> black_hat(const ImageBase<DerivedSrc>& img_src, const StructuringElement& se);
+
+/// @}
+
+// ----------
+// Implementation:
+
+/** \brief Constructs a structuring element of the given size and shape.
+ *
+ * @param width The width of the structuring element. Has to be positive.
+ * @param height The height of the structuring element. Has to be positive.
+ * @param shape The shape of the structuring element.
+ */
+constexpr StructuringElement::StructuringElement(PixelLength width,
+                                                 PixelLength height,
+                                                 StructuringElementShape shape) noexcept
+    : width_(width), height_(height), shape_(shape)
+{
+  SELENE_ASSERT(width_ > 0);
+  SELENE_ASSERT(height_ > 0);
+}
+
+/** \brief Returns the width of the structuring element.
+ *
+ * @return The width of the structuring element.
+ */
+constexpr PixelLength StructuringElement::width() const noexcept
+{
+  return width_;
+}
+
+/** \brief Returns the height of the structuring element.
+ *
+ * @return The height of the structuring element.
+ */
+constexpr PixelLength StructuringElement::height() const noexcept
+{
+  return height_;
+}
+
+/** \brief Returns the shape of the structuring element.
+ *
+ * @return The shape of the structuring element.
+ */
+constexpr StructuringElementShape StructuringElement::shape() const noexcept
+{
+  return shape_;
+}
+
+namespace impl {
+
+// Returns the row pointers for rows [-pad_top, height + pad_bottom) of an image with `height` rows, where rows outside
+// the image are substituted according to the border access mode.
+// For BorderAccessMode::Unchecked, `get_row` needs to be valid for all row indices in the padded range.
+template <BorderAccessMode access_mode, typename T, typename GetRowFunc>
+std::vector<const T*> morphology_padded_rows(std::ptrdiff_t height,
+                                             std::ptrdiff_t pad_top,
+                                             std::ptrdiff_t pad_bottom,
+                                             const T* zero_row,
+                                             GetRowFunc get_row)
+{
+  std::vector<const T*> rows(static_cast<std::size_t>(height + pad_top + pad_bottom));
+  for (std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t>(rows.size()); ++i)
+  {
+    const auto y = i - pad_top;
+    if constexpr (access_mode == BorderAccessMode::Unchecked)
+    {
+      rows[static_cast<std::size_t>(i)] = get_row(y);
+    }
+    else if constexpr (access_mode == BorderAccessMode::ZeroPadding)
+    {
+      rows[static_cast<std::size_t>(i)] = (y >= 0 && y < height) ? get_row(y) : zero_row;
+    }
+    else
+    {
+      rows[static_cast<std::size_t>(i)] = get_row(std::clamp(y, std::ptrdiff_t{0}, height - 1));
+    }
+  }
+  return rows;
+}
+
+template <MorphologyOperation op, BorderAccessMode access_mode, typename DerivedSrc, typename DerivedDst>
+void morphology(const ImageBase<DerivedSrc>& img_src, ImageBase<DerivedDst>& img_dst, const StructuringElement& se)
+{
+  using PixelType = typename DerivedSrc::PixelType;
+  using T = typename PixelTraits<PixelType>::Element;
+  constexpr auto N = static_cast<std::size_t>(PixelTraits<PixelType>::nr_channels);
+  constexpr auto n = static_cast<std::ptrdiff_t>(N);
+  static_assert(std::is_same_v<PixelType, typename DerivedDst::PixelType>, "Incompatible source and target types");
+  static_assert(std::is_arithmetic_v<T>, "Morphological operations require arithmetic pixel elements");
+
+  const auto width = static_cast<std::ptrdiff_t>(img_src.width());
+  const auto height = static_cast<std::ptrdiff_t>(img_src.height());
+  const auto kx = static_cast<std::ptrdiff_t>(se.width());
+  const auto ky = static_cast<std::ptrdiff_t>(se.height());
+  const auto pad_left = (kx - 1) / 2;
+  const auto pad_right = kx - 1 - pad_left;
+  const auto pad_top = (ky - 1) / 2;
+  const auto pad_bottom = ky - 1 - pad_top;
+  const auto row_len = n * width;
+
+  allocate(img_dst, {img_src.width(), img_src.height()});
+
+  if (width == 0 || height == 0)
+  {
+    return;
+  }
+
+  std::vector<T> line(static_cast<std::size_t>(n * (width + kx - 1)));
+  std::vector<T> row_buffer(kx > morphology_max_direct_size_x ? 2 * line.size() : 0);
+  std::vector<T> column_buffer(ky > morphology_max_direct_size_y ? static_cast<std::size_t>((2 * ky - 1) * row_len) : 0);
+  std::vector<T> zero_row(access_mode == BorderAccessMode::ZeroPadding ? static_cast<std::size_t>(row_len) : 0, T{0});
+
+  const auto dst_row = [&img_dst](std::ptrdiff_t y) {
+    return reinterpret_cast<T*>(img_dst.byte_ptr(PixelIndex{static_cast<PixelIndex::value_type>(y)}));
+  };
+
+  const auto filter_row = [&](PixelIndex y, T* dst) {
+    const auto src_row = horizontally_padded_row<access_mode, T, N>(img_src, y, pad_left, pad_right, line);
+    morphology_row<op, N>(src_row, dst, width, kx, row_buffer.data());
+  };
+
+  if (se.shape() == StructuringElementShape::Rectangle)
+  {
+    // Filter in x-direction into a temporary image (including the rows above and below the image, if these are to be
+    // accessed directly), then in y-direction into the target image.
+    const auto tmp_pad_top = (access_mode == BorderAccessMode::Unchecked) ? pad_top : std::ptrdiff_t{0};
+    const auto tmp_pad_bottom = (access_mode == BorderAccessMode::Unchecked) ? pad_bottom : std::ptrdiff_t{0};
+    const auto tmp_height = height + tmp_pad_top + tmp_pad_bottom;
+    Image<PixelType> img_tmp({img_src.width(), PixelLength{static_cast<PixelLength::value_type>(tmp_height)}});
+
+    for (std::ptrdiff_t i = 0; i < tmp_height; ++i)
+    {
+      const auto y = PixelIndex{static_cast<PixelIndex::value_type>(i - tmp_pad_top)};
+      filter_row(y, reinterpret_cast<T*>(img_tmp.byte_ptr(PixelIndex{static_cast<PixelIndex::value_type>(i)})));
+    }
+
+    const auto rows = morphology_padded_rows<access_mode>(height, pad_top, pad_bottom, zero_row.data(), [&](auto y) {
+      return reinterpret_cast<const T*>(img_tmp.byte_ptr(PixelIndex{static_cast<PixelIndex::value_type>(y + tmp_pad_top)}));
+    });
+    morphology_columns<op>(rows.data(), height, ky, row_len, column_buffer.data(), dst_row);
+  }
+  else
+  {
+    // Filter in y-direction into a temporary image, then combine each row with the row filtered in x-direction.
+    Image<PixelType> img_tmp({img_src.width(), img_src.height()});
+
+    const auto rows = morphology_padded_rows<access_mode>(height, pad_top, pad_bottom, zero_row.data(), [&](auto y) {
+      return reinterpret_cast<const T*>(img_src.byte_ptr(PixelIndex{static_cast<PixelIndex::value_type>(y)}));
+    });
+    morphology_columns<op>(rows.data(), height, ky, row_len, column_buffer.data(), [&img_tmp](std::ptrdiff_t y) {
+      return reinterpret_cast<T*>(img_tmp.byte_ptr(PixelIndex{static_cast<PixelIndex::value_type>(y)}));
+    });
+
+    std::vector<T> filtered_row(static_cast<std::size_t>(row_len));
+    for (std::ptrdiff_t y = 0; y < height; ++y)
+    {
+      const auto py = PixelIndex{static_cast<PixelIndex::value_type>(y)};
+      filter_row(py, filtered_row.data());
+      const T* srcs[2] = {filtered_row.data(), reinterpret_cast<const T*>(img_tmp.byte_ptr(py))};
+      reduce_rows<op>(srcs, 2, dst_row(y), row_len);
+    }
+  }
+}
+
+// Computes img_dst = img_a - img_b, element-wise, where img_a >= img_b for each element.
+template <typename DerivedA, typename DerivedB, typename DerivedDst>
+void morphology_difference(const ImageBase<DerivedA>& img_a,
+                           const ImageBase<DerivedB>& img_b,
+                           ImageBase<DerivedDst>& img_dst)
+{
+  using PixelType = typename DerivedA::PixelType;
+  using T = typename PixelTraits<PixelType>::Element;
+  constexpr auto n = static_cast<std::ptrdiff_t>(PixelTraits<PixelType>::nr_channels);
+
+  SELENE_ASSERT(img_a.width() == img_b.width() && img_a.height() == img_b.height());
+  allocate(img_dst, {img_a.width(), img_a.height()});
+
+  const auto row_len = n * static_cast<std::ptrdiff_t>(img_a.width());
+  for (auto y = PixelIndex{0}; y < img_a.height(); ++y)
+  {
+    const auto a = reinterpret_cast<const T*>(img_a.byte_ptr(y));
+    const auto b = reinterpret_cast<const T*>(img_b.byte_ptr(y));
+    const auto dst = reinterpret_cast<T*>(img_dst.byte_ptr(y));
+    for (std::ptrdiff_t i = 0; i < row_len; ++i)
+    {
+      dst[i] = static_cast<T>(a[i] - b[i]);
+    }
+  }
+}
+
+}  // namespace impl
+
+/** \brief Erodes the source image with the given structuring element; i.e. computes the minimum over the structuring
+ * element, for each pixel and channel.
+ *
+ * Rectangular structuring elements are decomposed into a filter in x-direction followed by a filter in y-direction,
+ * cross-shaped elements into the minimum of both. Each of these is computed in constant time per pixel, regardless of
+ * the structuring element size (using the van Herk/Gil-Werman algorithm), or directly for small sizes.
+ *
+ * Source and target image may be the same image.
+ *
+ * @tparam access_mode The border access mode to be used when going outside the image bounds.
+ *                     `BorderAccessMode::Replicated` by default, which leaves borders unaffected.
+ *                     With `BorderAccessMode::ZeroPadding`, structures touching the image border are eroded from it.
+ *                     `BorderAccessMode::Unchecked` requires the source image to be a view into a larger image, such
+ *                     that all pixels covered by the structuring element can be accessed.
+ * @tparam DerivedSrc The typed source image type.
+ * @tparam DerivedDst The typed target image type.
+ * @param img_src The source image.
+ * @param img_dst The target image.
+ * @param se The structuring element.
+ */
+template <BorderAccessMode access_mode, typename DerivedSrc, typename DerivedDst>
+void erode(const ImageBase<DerivedSrc>& img_src, ImageBase<DerivedDst>& img_dst, const StructuringElement& se)
+{
+  impl::morphology<impl::MorphologyOperation::Erosion, access_mode>(img_src, img_dst, se);
+}
+
+/** \brief Erodes the source image with the given structuring element; i.e. computes the minimum over the structuring
+ * element, for each pixel and channel.
+ *
+ * See the overload taking a target image for details.
+ *
+ * @tparam access_mode The border access mode to be used when going outside the image bounds.
+ * @tparam DerivedSrc The typed source image type.
+ * @param img_src The source image.
+ * @param se The structuring element.
+ * @return The eroded image.
+ */
+template <BorderAccessMode access_mode, typename DerivedSrc>
+Image<typename DerivedSrc::PixelType> erode(const ImageBase<DerivedSrc>& img_src, const StructuringElement& se)
+{
+  Image<typename DerivedSrc::PixelType> img_dst;
+  erode<access_mode>(img_src, img_dst, se);
+  return img_dst;
+}
+
+/** \brief Dilates the source image with the given structuring element; i.e. computes the maximum over the structuring
+ * element, for each pixel and channel.
+ *
+ * Source and target image may be the same image. See `erode` for details on the computation and border handling.
+ *
+ * @tparam access_mode The border access mode to be used when going outside the image bounds.
+ *                     `BorderAccessMode::Replicated` by default.
+ * @tparam DerivedSrc The typed source image type.
+ * @tparam DerivedDst The typed target image type.
+ * @param img_src The source image.
+ * @param img_dst The target image.
+ * @param se The structuring element.
+ */
+template <BorderAccessMode access_mode, typename DerivedSrc, typename DerivedDst>
+void dilate(const ImageBase<DerivedSrc>& img_src, ImageBase<DerivedDst>& img_dst, const StructuringElement& se)
+{
+  impl::morphology<impl::MorphologyOperation::Dilation, access_mode>(img_src, img_dst, se);
+}
+
+/** \brief Dilates the source image with the given structuring element; i.e. computes the maximum over the structuring
+ * element, for each pixel and channel.
+ *
+ * @tparam access_mode The border access mode to be used when going outside the image bounds.
+ * @tparam DerivedSrc The typed source image type.
+ * @param img_src The source image.
+ * @param se The structuring element.
+ * @return The dilated image.
+ */
+template <BorderAccessMode access_mode, typename DerivedSrc>
+Image<typename DerivedSrc::PixelType> dilate(const ImageBase<DerivedSrc>& img_src, const StructuringElement& se)
+{
+  Image<typename DerivedSrc::PixelType> img_dst;
+  dilate<access_mode>(img_src, img_dst, se);
+  return img_dst;
+}
+
+/** \brief Computes the morphological opening of the source image; i.e. an erosion followed by a dilation.
+ *
+ * Opening removes bright structures smaller than the structuring element.
+ *
+ * @tparam access_mode The border access mode to be used when going outside the image bounds.
+ *                     `BorderAccessMode::Unchecked` only applies to the erosion; the dilation uses
+ *                     `BorderAccessMode::Replicated`.
+ * @tparam DerivedSrc The typed source image type.
+ * @tparam DerivedDst The typed target image type.
+ * @param img_src The source image.
+ * @param img_dst The target image.
+ * @param se The structuring element.
+ */
+template <BorderAccessMode access_mode, typename DerivedSrc, typename DerivedDst>
+void opening(const ImageBase<DerivedSrc>& img_src, ImageBase<DerivedDst>& img_dst, const StructuringElement& se)
+{
+  constexpr auto second_access_mode
+      = (access_mode == BorderAccessMode::Unchecked) ? BorderAccessMode::Replicated : access_mode;
+  const auto img_eroded = erode<access_mode>(img_src, se);
+  dilate<second_access_mode>(img_eroded, img_dst, se);
+}
+
+/** \brief Computes the morphological opening of the source image; i.e. an erosion followed by a dilation.
+ *
+ * @tparam access_mode The border access mode to be used when going outside the image bounds.
+ * @tparam DerivedSrc The typed source image type.
+ * @param img_src The source image.
+ * @param se The structuring element.
+ * @return The opened image.
+ */
+template <BorderAccessMode access_mode, typename DerivedSrc>
+Image<typename DerivedSrc::PixelType> opening(const ImageBase<DerivedSrc>& img_src, const StructuringElement& se)
+{
+  Image<typename DerivedSrc::PixelType> img_dst;
+  opening<access_mode>(img_src, img_dst, se);
+  return img_dst;
+}
+
+/** \brief Computes the morphological closing of the source image; i.e. a dilation followed by an erosion.
+ *
+ * Closing removes dark structures smaller than the structuring element, e.g. fills small holes in masks.
+ *
+ * @tparam access_mode The border access mode to be used when going outside the image bounds.
+ *                     `BorderAccessMode::Unchecked` only applies to the dilation; the erosion uses
+ *                     `BorderAccessMode::Replicated`.
+ * @tparam DerivedSrc The typed source image type.
+ * @tparam DerivedDst The typed target image type.
+ * @param img_src The source image.
+ * @param img_dst The target image.
+ * @param se The structuring element.
+ */
+template <BorderAccessMode access_mode, typename DerivedSrc, typename DerivedDst>
+void closing(const ImageBase<DerivedSrc>& img_src, ImageBase<DerivedDst>& img_dst, const StructuringElement& se)
+{
+  constexpr auto second_access_mode
+      = (access_mode == BorderAccessMode::Unchecked) ? BorderAccessMode::Replicated : access_mode;
+  const auto img_dilated = dilate<access_mode>(img_src, se);
+  erode<second_access_mode>(img_dilated, img_dst, se);
+}
+
+/** \brief Computes the morphological closing of the source image; i.e. a dilation followed by an erosion.
+ *
+ * @tparam access_mode The border access mode to be used when going outside the image bounds.
+ * @tparam DerivedSrc The typed source image type.
+ * @param img_src The source image.
+ * @param se The structuring element.
+ * @return The closed image.
+ */
+template <BorderAccessMode access_mode, typename DerivedSrc>
+Image<typename DerivedSrc::PixelType> closing(const ImageBase<DerivedSrc>& img_src, const StructuringElement& se)
+{
+  Image<typename DerivedSrc::PixelType> img_dst;
+  closing<access_mode>(img_src, img_dst, se);
+  return img_dst;
+}
+
+/** \brief Computes the morphological gradient of the source image; i.e. the difference between its dilation and its
+ * erosion.
+ *
+ * @tparam access_mode The border access mode to be used when going outside the image bounds.
+ * @tparam DerivedSrc The typed source image type.
+ * @tparam DerivedDst The typed target image type.
+ * @param img_src The source image.
+ * @param img_dst The target image.
+ * @param se The structuring element.
+ */
+template <BorderAccessMode access_mode, typename DerivedSrc, typename DerivedDst>
+void morphological_gradient(const ImageBase<DerivedSrc>& img_src,
+                            ImageBase<DerivedDst>& img_dst,
+                            const StructuringElement& se)
+{
+  const auto img_dilated = dilate<access_mode>(img_src, se);
+  const auto img_eroded = erode<access_mode>(img_src, se);
+  impl::morphology_difference(img_dilated, img_eroded, img_dst);
+}
+
+/** \brief Computes the morphological gradient of the source image; i.e. the difference between its dilation and its
+ * erosion.
+ *
+ * @tparam access_mode The border access mode to be used when going outside the image bounds.
+ * @tparam DerivedSrc The typed source image type.
+ * @param img_src The source image.
+ * @param se The structuring element.
+ * @return The morphological gradient image.
+ */
+template <BorderAccessMode access_mode, typename DerivedSrc>
+Image<typename DerivedSrc::PixelType> morphological_gradient(const ImageBase<DerivedSrc>& img_src,
+                                                             const StructuringElement& se)
+{
+  Image<typename DerivedSrc::PixelType> img_dst;
+  morphological_gradient<access_mode>(img_src, img_dst, se);
+  return img_dst;
+}
+
+/** \brief Computes the (white) top-hat transform of the source image; i.e. the difference between the image and its
+ * opening.
+ *
+ * The top-hat transform extracts bright structures smaller than the structuring element.
+ *
+ * @tparam access_mode The border access mode to be used when going outside the image bounds.
+ * @tparam DerivedSrc The typed source image type.
+ * @tparam DerivedDst The typed target image type.
+ * @param img_src The source image.
+ * @param img_dst The target image.
+ * @param se The structuring element.
+ */
+template <BorderAccessMode access_mode, typename DerivedSrc, typename DerivedDst>
+void top_hat(const ImageBase<DerivedSrc>& img_src, ImageBase<DerivedDst>& img_dst, const StructuringElement& se)
+{
+  const auto img_opened = opening<access_mode>(img_src, se);
+  impl::morphology_difference(img_src, img_opened, img_dst);
+}
+
+/** \brief Computes the (white) top-hat transform of the source image; i.e. the difference between the image and its
+ * opening.
+ *
+ * @tparam access_mode The border access mode to be used when going outside the image bounds.
+ * @tparam DerivedSrc The typed source image type.
+ * @param img_src The source image.
+ * @param se The structuring element.
+ * @return The top-hat transformed image.
+ */
+template <BorderAccessMode access_mode, typename DerivedSrc>
+Image<typename DerivedSrc::PixelType> top_hat(const ImageBase<DerivedSrc>& img_src, const StructuringElement& se)
+{
+  Image<typename DerivedSrc::PixelType> img_dst;
+  top_hat<access_mode>(img_src, img_dst, se);
+  return img_dst;
+}
+
+/** \brief Computes the black-hat transform of the source image; i.e. the difference between its closing and the image.
+ *
+ * The black-hat transform extracts dark structures smaller than the structuring element.
+ *
+ * @tparam access_mode The border access mode to be used when going outside the image bounds.
+ * @tparam DerivedSrc The typed source image type.
+ * @tparam DerivedDst The typed target image type.
+ * @param img_src The source image.
+ * @param img_dst The target image.
+ * @param se The structuring element.
+ */
+template <BorderAccessMode access_mode, typename DerivedSrc, typename DerivedDst>
+void black_hat(const ImageBase<DerivedSrc>& img_src, ImageBase<DerivedDst>& img_dst, const StructuringElement& se)
+{
+  const auto img_closed = closing<access_mode>(img_src, se);
+  impl::morphology_difference(img_closed, img_src, img_dst);
+}
+
+/** \brief Computes the black-hat transform of the source image; i.e. the difference between its closing and the image.
+ *
+ * @tparam access_mode The border access mode to be used when going outside the image bounds.
+ * @tparam DerivedSrc The typed source image type.
+ * @param img_src The source image.
+ * @param se The structuring element.
+ * @return The black-hat transformed image.
+ */
+template <BorderAccessMode access_mode, typename DerivedSrc>
+Image<typename DerivedSrc::PixelType> black_hat(const ImageBase<DerivedSrc>& img_src, const StructuringElement& se)
+{
+  Image<typename DerivedSrc::PixelType> img_dst;
+  black_hat<access_mode>(img_src, img_dst, se);
+  return img_dst;
+}
+
+}  // namespace sln
+
+#endif  // SELENE_IMG_OPS_MORPHOLOGY_HPP
@@ -0,0 +1,227 @@
+// This file is part of the `Selene` library.
+// Copyright 2017-2019 Michael Hofmann (https://github.com/kmhofmann).
+// Distributed under MIT license. See accompanying LICENSE file in the top-level directory.
+
+#ifndef SELENE_IMG_OPS_PLANAR_OPERATIONS_HPP
+#define SELENE_IMG_OPS_PLANAR_OPERATIONS_HPP
+
+/// @file
+
+#include <selene/base/_impl/ParallelFor.hpp>
+
+#include <selene/img/pixel/PixelTraits.hpp>
+
+#include <selene/img/typed/Image.hpp>
+#include <selene/img/typed/PlanarImage.hpp>
+#include <selene/img/typed/PlanarImageView.hpp>
+#include <selene/img/typed/_impl/StaticChecks.hpp>
+
+#include <selene/img_ops/Allocate.hpp>
+
+#include <selene/img_ops/_impl/ChannelKernels.hpp>
+
+#include <array>
+#include <cstddef>
+#include <stdexcept>
+#include <type_traits>
+
+namespace sln {
+
+/// \addtogroup group-img-ops
+/// @{
+
+template <typename Img, typename PlanarImgDst>
+void to_planar(const Img& img, PlanarImgDst& planar_dst);
+
+template <typename Img>
+auto to_planar(const Img& img);
+
+template <typename PlanarImg, typename ImgDst>
+void to_interleaved(const PlanarImg& planar, ImgDst& img_dst);
+
+template <PixelFormat pixel_format = PixelFormat::Unknown, typename PlanarImg>
+auto to_interleaved(const PlanarImg& planar);
+
+template <typename PlanarImg, typename Func>
+void for_each_plane(PlanarImg& planar, Func func, int nr_threads = 1);
+
+/// @}
+
+// ----------
+// Implementation:
+
+namespace impl {
+
+template <typename PlanarImg>
+void prepare_planar_image(PlanarImg& planar, PixelLength width, PixelLength height)
+{
+  if (planar.width() == width && planar.height() == height && planar.is_valid())
+  {
+    return;
+  }
+
+  if constexpr (PlanarImg::is_view)
+  {
+    throw std::runtime_error("Cannot resize planar image view.");
+  }
+  else
+  {
+    planar.reallocate({width, height});
+  }
+}
+
+}  // namespace impl
+
+/// \addtogroup group-img-ops
+/// @{
+
+/** \brief Converts an interleaved multi-channel image into a planar image, with one plane per channel.
+ *
+ * If `planar_dst` is a `PlanarImage`, it is reallocated, if necessary. If it is a `PlanarImageView`, it has to be of
+ * the same size as the source image; otherwise, an exception is thrown.
+ * SIMD instructions are used for the common cases of 3-channel or 4-channel images of 8-bit, 16-bit or 32-bit
+ * elements (where supported).
+ *
+ * @tparam Img The image type of the source image (owning image or view).
+ * @tparam PlanarImgDst The type of the target planar image (owning image or mutable view).
+ * @param img The interleaved source image.
+ * @param planar_dst The planar target image.
+ */
+template <typename Img, typename PlanarImgDst>
+void to_planar(const Img& img, PlanarImgDst& planar_dst)
+{
+  static_assert(impl::is_image_type_v<Img>, "Need to supply a typed image (owning or view) as input argument");
+  static_assert(impl::is_planar_image_type_v<PlanarImgDst>, "Need to supply a planar image as output argument");
+
+  using T = typename PixelTraits<typename Img::PixelType>::Element;
+  constexpr auto nr_channels = static_cast<std::size_t>(PixelTraits<typename Img::PixelType>::nr_channels);
+  static_assert(std::is_same_v<T, typename PlanarImgDst::Element>, "Element type mismatch");
+  static_assert(nr_channels == PlanarImgDst::nr_channels, "Number of channels mismatch");
+
+  impl::prepare_planar_image(planar_dst, img.width(), img.height());
+
+  std::array<T*, nr_channels> ptrs_dst{};
+
+  for (auto y = 0_idx; y < img.height(); ++y)
+  {
+    for (std::size_t c = 0; c < nr_channels; ++c)
+    {
+      ptrs_dst[c] = reinterpret_cast<T*>(planar_dst.plane(c).byte_ptr(y));
+    }
+
+    impl::deinterleave_row<nr_channels>(reinterpret_cast<const T*>(img.byte_ptr(y)), ptrs_dst,
+                                        static_cast<std::ptrdiff_t>(img.width()));
+  }
+}
+
+/** \brief Converts an interleaved multi-channel image into a planar image, with one plane per channel.
+ *
+ * @tparam Img The image type of the source image (owning image or view).
+ * @param img The interleaved source image.
+ * @return A `PlanarImage<T, N>`, where `T` is the element type and `N` the number of channels of the source image.
+ */
+template <typename Img>
+auto to_planar(const Img& img)
+{
+  using T = typename PixelTraits<typename Img::PixelType>::Element;
+  constexpr auto nr_channels = static_cast<std::size_t>(PixelTraits<typename Img::PixelType>::nr_channels);
+
+  PlanarImage<T, nr_channels> planar;
+  to_planar(img, planar);
+  return planar;
+}
+
+/** \brief Converts a planar image into an interleaved multi-channel image.
+ *
+ * If `img_dst` is an owning image, it is reallocated, if necessary. If it is a view, it has to be of the same size as
+ * the source image; otherwise, an exception is thrown.
+ * SIMD instructions are used for the common cases of 3-channel or 4-channel images of 8-bit, 16-bit or 32-bit
+ * elements (where supported).
+ *
+ * @tparam PlanarImg The type of the source planar image (owning image or view).
+ * @tparam ImgDst The image type of the target image (owning image or mutable view).
+ * @param planar The planar source image.
+ * @param img_dst The interleaved target image.
+ */
+template <typename PlanarImg, typename ImgDst>
+void to_interleaved(const PlanarImg& planar, ImgDst& img_dst)
+{
+  static_assert(impl::is_planar_image_type_v<PlanarImg>, "Need to supply a planar image as input argument");
+  static_assert(impl::is_image_type_v<ImgDst>, "Need to supply a typed image (owning or view) as output argument");
+
+  using T = typename PlanarImg::Element;
+  constexpr auto nr_channels = PlanarImg::nr_channels;
+  static_assert(std::is_same_v<T, typename PixelTraits<typename ImgDst::PixelType>::Element>, "Element type mismatch");
+  static_assert(nr_channels == static_cast<std::size_t>(PixelTraits<typename ImgDst::PixelType>::nr_channels),
+                "Number of channels mismatch");
+
+  sln::allocate(img_dst, {planar.width(), planar.height()});
+
+  std::array<const T*, nr_channels> ptrs_src{};
+
+  for (auto y = 0_idx; y < planar.height(); ++y)
+  {
+    for (std::size_t c = 0; c < nr_channels; ++c)
+    {
+      ptrs_src[c] = reinterpret_cast<const T*>(planar.plane(c).byte_ptr(y));
+    }
+
+    impl::interleave_row<nr_channels>(ptrs_src, reinterpret_cast<T*>(img_dst.byte_ptr(y)),
+                                      static_cast<std::ptrdiff_t>(planar.width()));
+  }
+}
+
+/** \brief Converts a planar image into an interleaved multi-channel image.
+ *
+ * @tparam pixel_format The desired pixel format of the output image.
+ * @tparam PlanarImg The type of the source planar image (owning image or view).
+ * @param planar The planar source image.
+ * @return An `Image<Pixel<T, N, pixel_format>>`, where `T` is the element type and `N` the number of channels of the
+ * source image.
+ */
+template <PixelFormat pixel_format, typename PlanarImg>
+auto to_interleaved(const PlanarImg& planar)
+{
+  using PixelType = Pixel<typename PlanarImg::Element, PlanarImg::nr_channels, pixel_format>;
+
+  Image<PixelType> img_dst;
+  to_interleaved(planar, img_dst);
+  return img_dst;
+}
+
+/** \brief Applies a function to each plane of a planar image, optionally in parallel.
+ *
+ * The function `func` is called as `func(plane, channel)`, where `plane` is a single-channel view onto the plane (an
+ * `ImageView<Pixel<T, 1>, modifiability>`), and `channel` is the channel index.
+ *
+ * By default, the planes are processed one after the other on the calling thread. If `nr_threads` is larger than 1
+ * (or <= 0, denoting the number of concurrent threads supported by the hardware), the planes are distributed over up to
+ * `nr_threads` threads, including the calling thread. The function must then be safe to call concurrently for
+ * different planes. If `func` throws, no further planes are processed, and the exception is re-thrown on the calling
+ * thread.
+ *
+ * @tparam PlanarImg The type of the planar image (owning image or view).
+ * @tparam Func The function type.
+ * @param planar The planar image.
+ * @param func The function to apply to each plane.
+ * @param nr_threads The maximum number of threads to use.
+ */
+template <typename PlanarImg, typename Func>
+void for_each_plane(PlanarImg& planar, Func func, int nr_threads)
+{
+  static_assert(impl::is_planar_image_type_v<PlanarImg>, "Need to supply a planar image as input argument");
+
+  constexpr auto nr_channels = std::remove_cv_t<PlanarImg>::nr_channels;
+  const auto nr_tasks = impl::get_nr_tasks(nr_channels, 1, impl::get_nr_threads(nr_threads));
+
+  impl::parallel_for(nr_channels, nr_tasks, [&](std::size_t c) {
+    auto plane = planar.plane(c);
+    func(plane, c);
+  });
+}
+
+/// @}
+
+}  // namespace sln
+
+#endif  // SELENE_IMG_OPS_PLANAR_OPERATIONS_HPP
@@ -0,0 +1,478 @@
+// This file is part of the `Selene` library.
+// Copyright 2017-2019 Michael Hofmann (https://github.com/kmhofmann).
+// Distributed under MIT license. See accompanying LICENSE file in the top-level directory.
+
+#ifndef SELENE_IMG_OPS_STATISTICS_HPP
+#define SELENE_IMG_OPS_STATISTICS_HPP
+
+/// @file
+
+#include <selene/base/Types.hpp>
+#include <selene/base/_impl/ParallelFor.hpp>
+
+#include <selene/img/pixel/Pixel.hpp>
+#include <selene/img/pixel/PixelTraits.hpp>
+
+#include <selene/img/typed/ImageBase.hpp>
+
+#include <selene/img_ops/_impl/StatisticsKernels.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+namespace sln {
+
+/// \addtogroup group-img-ops
+/// @{
+
+/** \brief Minimum and maximum value of one image channel, including their locations.
+ *
+ * If a value occurs more than once, the location of its first occurrence (in row-major order) is reported.
+ *
+ * @tparam T The element type of the channel.
+ */
+template <typename T>
+struct ChannelMinMax
+{
+  T min;  ///< The minimum value.
+  T max;  ///< The maximum value.
+  PixelIndex min_x;  ///< The x-coordinate of the minimum value.
+  PixelIndex min_y;  ///< The y-coordinate of the minimum value.
+  PixelIndex max_x;  ///< The x-coordinate of the maximum value.
+  PixelIndex max_y;  ///< The y-coordinate of the maximum value.
+};
+
+template <typename DerivedSrc>
+auto sum(const ImageBase<DerivedSrc>& img, int nr_threads = 0);
+
+template <typename DerivedSrc>
+auto mean(const ImageBase<DerivedSrc>& img, int nr_threads = 0);
+
+template <typename DerivedSrc>
+auto variance(const ImageBase<DerivedSrc>& img, int nr_threads = 0);
+
+template <typename DerivedSrc>
+auto min_max(const ImageBase<DerivedSrc>& img, int nr_threads = 0);
+
+template <typename DerivedSrc, typename Predicate>
+std::size_t count_if(const ImageBase<DerivedSrc>& img, Predicate pred, int nr_threads = 0);
+
+/// @}
+
+// ----------
+// Implementation:
+
+namespace impl {
+
+// Number of pixels per row band. Bands are fixed by the image size only, so that the (merged) results do not depend on
+// the number of threads.
+constexpr std::size_t statistics_band_size = std::size_t{64} * 1024;
+
+/** \brief Computes one result per row band of the image, possibly in parallel.
+ *
+ * The function `band_func` is called as `band_func(y_begin, y_end)` and returns the result for rows [y_begin, y_end).
+ * The results are returned in band order.
+ */
+template <typename Result, typename DerivedSrc, typename BandFunction>
+std::vector<Result> reduce_row_bands(const ImageBase<DerivedSrc>& img, int nr_threads, BandFunction band_func)
+{
+  const auto width = static_cast<std::size_t>(img.width());
+  const auto height = static_cast<std::size_t>(img.height());
+
+  if (width == 0 || height == 0)
+  {
+    return {};
+  }
+
+  const auto nr_rows_per_band = std::max(std::size_t{1}, statistics_band_size / width);
+  const auto nr_bands = (height + nr_rows_per_band - 1) / nr_rows_per_band;
+
+  std::vector<Result> results(nr_bands);
+  impl::parallel_for(nr_bands, impl::get_nr_threads(nr_threads), [&](std::size_t band) {
+    const auto y_begin = PixelIndex{static_cast<PixelIndex::value_type>(band * nr_rows_per_band)};
+    const auto y_end = PixelIndex{static_cast<PixelIndex::value_type>(std::min(height, (band + 1) * nr_rows_per_band))};
+    results[band] = band_func(y_begin, y_end);
+  });
+
+  return results;
+}
+
+template <typename T, std::size_t N>
+struct BandMoments
+{
+  std::size_t count = 0;
+  std::array<float64_t, N> mean{};
+  std::array<float64_t, N> m2{};  // sum of squared differences from the mean
+};
+
+template <typename T, std::size_t N, typename DerivedSrc>
+BandMoments<T, N> band_moments(const ImageBase<DerivedSrc>& img, PixelIndex y_begin, PixelIndex y_end)
+{
+  const auto width = static_cast<std::ptrdiff_t>(img.width());
+
+  BandMoments<T, N> moments;
+  moments.count = static_cast<std::size_t>(width) * static_cast<std::size_t>(y_end - y_begin);
+  const auto n = static_cast<float64_t>(moments.count);
+
+  if constexpr (std::is_integral_v<T> && sizeof(T) == 1)
+  {
+    // Exact integer sums of values and squares; one band is small enough to rule out overflows.
+    using Acc = statistics_accumulator_t<T>;
+    std::array<Acc, N> sum{};
+    std::array<Acc, N> sum_sq{};
+
+    for (auto y = y_begin; y < y_end; ++y)
+    {
+      sum_squares_row<N>(reinterpret_cast<const T*>(img.byte_ptr(y)), width, sum, sum_sq);
+    }
+
+    const auto count = static_cast<Acc>(moments.count);
+    for (std::size_t c = 0; c < N; ++c)
+    {
+      moments.mean[c] = static_cast<float64_t>(sum[c]) / n;
+      moments.m2[c] = static_cast<float64_t>(count * sum_sq[c] - sum[c] * sum[c]) / n;
+    }
+  }
+  else
+  {
+    // Two passes over the (cache-resident) band for numerical stability.
+    std::array<float64_t, N> sum{};
+    for (auto y = y_begin; y < y_end; ++y)
+    {
+      sum_row<N>(reinterpret_cast<const T*>(img.byte_ptr(y)), width, sum);
+    }
+
+    for (std::size_t c = 0; c < N; ++c)
+    {
+      moments.mean[c] = sum[c] / n;
+    }
+
+    for (auto y = y_begin; y < y_end; ++y)
+    {
+      const auto src = reinterpret_cast<const T*>(img.byte_ptr(y));
+      for (std::ptrdiff_t x = 0; x < width; ++x)
+      {
+        for (std::size_t c = 0; c < N; ++c)
+        {
+          const auto d = static_cast<float64_t>(src[N * x + c]) - moments.mean[c];
+          moments.m2[c] += d * d;
+        }
+      }
+    }
+  }
+
+  return moments;
+}
+
+template <typename T, std::size_t N>
+void merge_moments(BandMoments<T, N>& a, const BandMoments<T, N>& b)
+{
+  // Pairwise update of mean and M2 (Chan et al.)
+  const auto n_a = static_cast<float64_t>(a.count);
+  const auto n_b = static_cast<float64_t>(b.count);
+  const auto n = n_a + n_b;
+
+  for (std::size_t c = 0; c < N; ++c)
+  {
+    const auto delta = b.mean[c] - a.mean[c];
+    a.mean[c] += delta * (n_b / n);
+    a.m2[c] += b.m2[c] + delta * delta * (n_a * n_b / n);
+  }
+
+  a.count += b.count;
+}
+
+template <typename T, std::size_t N, typename DerivedSrc>
+std::array<ChannelMinMax<T>, N> band_min_max(const ImageBase<DerivedSrc>& img, PixelIndex y_begin, PixelIndex y_end)
+{
+  const auto width = static_cast<std::ptrdiff_t>(img.width());
+
+  std::array<ChannelMinMax<T>, N> result;
+  const auto first = reinterpret_cast<const T*>(img.byte_ptr(y_begin));
+  for (std::size_t c = 0; c < N; ++c)
+  {
+    result[c] = ChannelMinMax<T>{first[c], first[c], PixelIndex{0}, y_begin, PixelIndex{0}, y_begin};
+  }
+
+  for (auto y = y_begin; y < y_end; ++y)
+  {
+    const auto src = reinterpret_cast<const T*>(img.byte_ptr(y));
+
+    std::array<T, N> row_min;
+    std::array<T, N> row_max;
+    for (std::size_t c = 0; c < N; ++c)
+    {
+      row_min[c] = result[c].min;
+      row_max[c] = result[c].max;
+    }
+
+    min_max_row<N>(src, width, row_min, row_max);
+
+    // Locations are only searched for in rows that strictly improve on the current values, which keeps the first
+    // occurrence in row-major order.
+    for (std::size_t c = 0; c < N; ++c)
+    {
+      if (row_min[c] < result[c].min)
+      {
+        result[c].min = row_min[c];
+        result[c].min_x = PixelIndex{static_cast<PixelIndex::value_type>(find_first_in_row<N>(src, width, c, row_min[c]))};
+        result[c].min_y = y;
+      }
+      if (result[c].max < row_max[c])
+      {
+        result[c].max = row_max[c];
+        result[c].max_x = PixelIndex{static_cast<PixelIndex::value_type>(find_first_in_row<N>(src, width, c, row_max[c]))};
+        result[c].max_y = y;
+      }
+    }
+  }
+
+  return result;
+}
+
+}  // namespace impl
+
+/// \addtogroup group-img-ops
+/// @{
+
+/** \brief Computes the channel-wise sum of all pixel values of an image.
+ *
+ * The sums are accumulated in a promoted type (see `promote`) that is three steps larger than the element type; i.e.
+ * in a 64-bit integer type for integral element types, and in `float64_t` for floating point element types.
+ *
+ * The image is reduced in row bands, possibly in parallel; the results are independent of the number of threads.
+ * SIMD instructions are used for 8-bit unsigned images with up to 4 channels (where supported).
+ *
+ * @tparam DerivedSrc The typed image type.
+ * @param img The input image.
+ * @param nr_threads The number of threads to use. A value <= 0 denotes the number of concurrent threads supported by
+ *                   the hardware.
+ * @return A `Pixel<Acc, N>` containing the sum of each channel.
+ */
+template <typename DerivedSrc>
+auto sum(const ImageBase<DerivedSrc>& img, int nr_threads)
+{
+  using PixelType = typename ImageBase<DerivedSrc>::PixelType;
+  using T = typename PixelTraits<PixelType>::Element;
+  constexpr auto nr_channels = static_cast<std::size_t>(PixelTraits<PixelType>::nr_channels);
+  using Acc = impl::statistics_accumulator_t<T>;
+
+  const auto width = static_cast<std::ptrdiff_t>(img.width());
+  const auto band_sums = impl::reduce_row_bands<std::array<Acc, nr_channels>>(
+      img, nr_threads, [&img, width](PixelIndex y_begin, PixelIndex y_end) {
+        std::array<Acc, nr_channels> band_sum{};
+        for (auto y = y_begin; y < y_end; ++y)
+        {
+          impl::sum_row<nr_channels>(reinterpret_cast<const T*>(img.byte_ptr(y)), width, band_sum);
+        }
+        return band_sum;
+      });
+
+  Pixel<Acc, nr_channels> result;
+  for (std::size_t c = 0; c < nr_channels; ++c)
+  {
+    result[c] = Acc{0};
+    for (const auto& band_sum : band_sums)
+    {
+      result[c] += band_sum[c];
+    }
+  }
+
+  return result;
+}
+
+/** \brief Computes the channel-wise mean of all pixel values of an image.
+ *
+ * See `sum()` for a description of the accumulation. For an empty image, the result is undefined (NaN).
+ *
+ * @tparam DerivedSrc The typed image type.
+ * @param img The input image.
+ * @param nr_threads The number of threads to use. A value <= 0 denotes the number of concurrent threads supported by
+ *                   the hardware.
+ * @return A `Pixel<float64_t, N>` containing the mean of each channel.
+ */
+template <typename DerivedSrc>
+auto mean(const ImageBase<DerivedSrc>& img, int nr_threads)
+{
+  using PixelType = typename ImageBase<DerivedSrc>::PixelType;
+  constexpr auto nr_channels = static_cast<std::size_t>(PixelTraits<PixelType>::nr_channels);
+
+  const auto sums = sum(img, nr_threads);
+  const auto nr_pixels = static_cast<float64_t>(img.width()) * static_cast<float64_t>(img.height());
+
+  Pixel<float64_t, nr_channels> result;
+  for (std::size_t c = 0; c < nr_channels; ++c)
+  {
+    result[c] = static_cast<float64_t>(sums[c]) / nr_pixels;
+  }
+
+  return result;
+}
+
+/** \brief Computes the channel-wise (population) variance of all pixel values of an image.
+ *
+ * The first and second moments are computed per row band (exactly in integer arithmetic for 8-bit images, and with two
+ * passes over the band in `float64_t` otherwise), and are then merged pairwise in band order.
+ * The image is reduced in row bands, possibly in parallel; the results are independent of the number of threads.
+ * For an empty image, the result is undefined (NaN).
+ *
+ * The standard deviation can be obtained as the square root of the variance.
+ *
+ * @tparam DerivedSrc The typed image type.
+ * @param img The input image.
+ * @param nr_threads The number of threads to use. A value <= 0 denotes the number of concurrent threads supported by
+ *                   the hardware.
+ * @return A `Pixel<float64_t, N>` containing the variance of each channel.
+ */
+template <typename DerivedSrc>
+auto variance(const ImageBase<DerivedSrc>& img, int nr_threads)
+{
+  using PixelType = typename ImageBase<DerivedSrc>::PixelType;
+  using T = typename PixelTraits<PixelType>::Element;
+  constexpr auto nr_channels = static_cast<std::size_t>(PixelTraits<PixelType>::nr_channels);
+
+  const auto band_moments = impl::reduce_row_bands<impl::BandMoments<T, nr_channels>>(
+      img, nr_threads, [&img](PixelIndex y_begin, PixelIndex y_end) {
+        return impl::band_moments<T, nr_channels>(img, y_begin, y_end);
+      });
+
+  Pixel<float64_t, nr_channels> result;
+
+  if (band_moments.empty())
+  {
+    for (std::size_t c = 0; c < nr_channels; ++c)
+    {
+      result[c] = std::numeric_limits<float64_t>::quiet_NaN();
+    }
+    return result;
+  }
+
+  auto moments = band_moments[0];
+  for (std::size_t i = 1; i < band_moments.size(); ++i)
+  {
+    impl::merge_moments(moments, band_moments[i]);
+  }
+
+  for (std::size_t c = 0; c < nr_channels; ++c)
+  {
+    result[c] = moments.m2[c] / static_cast<float64_t>(moments.count);
+  }
+
+  return result;
+}
+
+/** \brief Computes the channel-wise minimum and maximum values of an image, including their locations.
+ *
+ * If a value occurs more than once, the location of its first occurrence (in row-major order) is reported.
+ * The image is reduced in row bands, possibly in parallel; the results are independent of the number of threads.
+ * SIMD instructions are used for 8-bit unsigned images with up to 4 channels (where supported).
+ *
+ * For an empty image, `min` is set to the largest and `max` to the lowest representable value of the element type, and
+ * all locations are set to -1.
+ *
+ * @tparam DerivedSrc The typed image type.
+ * @param img The input image.
+ * @param nr_threads The number of threads to use. A value <= 0 denotes the number of concurrent threads supported by
+ *                   the hardware.
+ * @return A `std::array<ChannelMinMax<T>, N>` containing minimum and maximum value of each channel.
+ */
+template <typename DerivedSrc>
+auto min_max(const ImageBase<DerivedSrc>& img, int nr_threads)
+{
+  using PixelType = typename ImageBase<DerivedSrc>::PixelType;
+  using T = typename PixelTraits<PixelType>::Element;
+  constexpr auto nr_channels = static_cast<std::size_t>(PixelTraits<PixelType>::nr_channels);
+
+  const auto band_results = impl::reduce_row_bands<std::array<ChannelMinMax<T>, nr_channels>>(
+      img, nr_threads, [&img](PixelIndex y_begin, PixelIndex y_end) {
+        return impl::band_min_max<T, nr_channels>(img, y_begin, y_end);
+      });
+
+  if (band_results.empty())
+  {
+    std::array<ChannelMinMax<T>, nr_channels> result;
+    const auto invalid_index = PixelIndex{-1};
+    for (std::size_t c = 0; c < nr_channels; ++c)
+    {
+      result[c] = ChannelMinMax<T>{std::numeric_limits<T>::max(), std::numeric_limits<T>::lowest(), invalid_index,
+                                   invalid_index, invalid_index, invalid_index};
+    }
+    return result;
+  }
+
+  auto result = band_results[0];
+  for (std::size_t i = 1; i < band_results.size(); ++i)
+  {
+    for (std::size_t c = 0; c < nr_channels; ++c)
+    {
+      const auto& band_result = band_results[i][c];
+      if (band_result.min < result[c].min)
+      {
+        result[c].min = band_result.min;
+        result[c].min_x = band_result.min_x;
+        result[c].min_y = band_result.min_y;
+      }
+      if (result[c].max < band_result.max)
+      {
+        result[c].max = band_result.max;
+        result[c].max_x = band_result.max_x;
+        result[c].max_y = band_result.max_y;
+      }
+    }
+  }
+
+  return result;
+}
+
+/** \brief Counts the number of pixels of an image for which a predicate returns true.
+ *
+ * The predicate is called as `pred(px)`, where `px` is a constant reference to the respective pixel. If `nr_threads`
+ * is not 1, it may be called concurrently from several threads.
+ *
+ * @tparam DerivedSrc The typed image type.
+ * @tparam Predicate The predicate type.
+ * @param img The input image.
+ * @param pred The predicate. Its signature should be `bool f(const PixelType&)`, or any compatible callable.
+ * @param nr_threads The number of threads to use. A value <= 0 denotes the number of concurrent threads supported by
+ *                   the hardware.
+ * @return The number of pixels for which `pred` returned true.
+ */
+template <typename DerivedSrc, typename Predicate>
+std::size_t count_if(const ImageBase<DerivedSrc>& img, Predicate pred, int nr_threads)
+{
+  using PixelType = typename ImageBase<DerivedSrc>::PixelType;
+  static_assert(std::is_invocable_r_v<bool, Predicate, const PixelType&>,
+                "Predicate supplied to count_if must be of (or convertible to) type 'bool(const PixelType&)'.");
+
+  const auto band_counts = impl::reduce_row_bands<std::size_t>(
+      img, nr_threads, [&img, &pred](PixelIndex y_begin, PixelIndex y_end) {
+        std::size_t count = 0;
+        for (auto y = y_begin; y < y_end; ++y)
+        {
+          for (auto ptr = img.data(y), end = img.data_row_end(y); ptr != end; ++ptr)
+          {
+            count += std::invoke(pred, *ptr) ? 1 : 0;
+          }
+        }
+        return count;
+      });
+
+  std::size_t count = 0;
+  for (const auto band_count : band_counts)
+  {
+    count += band_count;
+  }
+
+  return count;
+}
+
+/// @}
+
+}  // namespace sln
+
+#endif  // SELENE_IMG_OPS_STATISTICS_HPP
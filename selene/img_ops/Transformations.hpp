@@ -17,10 +17,14 @@
 #include <selene/img_ops/Allocate.hpp>
 #include <selene/img_ops/TransformationDirections.hpp>
 #include <selene/img_ops/_impl/FlipExpr.hpp>
+#include <selene/img_ops/_impl/FlipKernels.hpp>
 #include <selene/img_ops/_impl/IdentityExpr.hpp>
 #include <selene/img_ops/_impl/TransposeExpr.hpp>
+#include <selene/img_ops/_impl/TransposeKernels.hpp>
 
 #include <algorithm>
+#include <cstddef>
+#include <type_traits>
 #include <utility>
 
 
@@ -83,16 +87,20 @@ auto rotate_expr(const ImageExpr<DerivedSrc>& img);
 template <FlipDirection flip_dir, typename DerivedSrcDst>
 void flip(const ImageBase<DerivedSrcDst>& img_src, ImageBase<DerivedSrcDst>& img_dst)
 {
+  using PixelType = typename DerivedSrcDst::PixelType;
+
   SELENE_ASSERT(&img_src != &img_dst);
   allocate(img_dst, img_src.layout());
 
+  const auto width = static_cast<std::ptrdiff_t>(img_src.width());
+
   switch (flip_dir)
   {
     case FlipDirection::Horizontal:
     {
       for (auto y_src = 0_idx; y_src < img_src.height(); ++y_src)
       {
-        std::reverse_copy(img_src.data(y_src), img_src.data_row_end(y_src), img_dst.data(y_src));
+        impl::flip_row_copy<PixelType>(img_src.data(y_src), img_dst.data(y_src), width);
       }
       break;
     }
@@ -110,7 +118,7 @@ void flip(const ImageBase<DerivedSrcDst>& img_src, ImageBase<DerivedSrcDst>& img
       for (auto y_src = 0_idx; y_src < img_src.height(); ++y_src)
       {
         const auto y_dst = PixelIndex{img_src.height() - y_src - 1};
-        std::reverse_copy(img_src.data(y_src), img_src.data_row_end(y_src), img_dst.data(y_dst));
+        impl::flip_row_copy<PixelType>(img_src.data(y_src), img_dst.data(y_dst), width);
       }
       break;
     }
@@ -157,18 +165,12 @@ auto flip_expr(const ImageExpr<DerivedSrc>& img)
 template <typename DerivedSrcDst>
 void flip_horizontally_in_place(ImageBase<DerivedSrcDst>& img)
 {
-  const auto half_width = img.width() / 2;
+  using PixelType = typename DerivedSrcDst::PixelType;
+  const auto width = static_cast<std::ptrdiff_t>(img.width());
 
   for (auto y = 0_idx; y < img.height(); ++y)
   {
-    auto row_ptr = img.data(y);
-
-    for (auto x_left = 0_idx; x_left < half_width; ++x_left)
-    {
-      using std::swap;
-      const auto x_right = img.width() - x_left - 1;
-      swap(row_ptr[ptrdiff_t{x_left}], row_ptr[ptrdiff_t{x_right}]);
-    }
+    impl::flip_row_in_place<PixelType>(img.data(y), width);
   }
 }
 
@@ -180,35 +182,22 @@ void flip_horizontally_in_place(ImageBase<DerivedSrcDst>& img)
 template <typename DerivedSrcDst>
 void flip_vertically_in_place(ImageBase<DerivedSrcDst>& img)
 {
+  using PixelType = typename DerivedSrcDst::PixelType;
   const auto half_height = img.height() / 2;
 
   for (auto y_top = 0_idx; y_top < half_height; ++y_top)
   {
     const auto y_bottom = PixelIndex{img.height() - y_top - 1};
 
-    const auto x_top_end = img.data_row_end(y_top);
-    auto x_top = img.data(y_top);
-    auto x_bottom = img.data(y_bottom);
-
-    for (; x_top != x_top_end; ++x_top, ++x_bottom)
+    if constexpr (std::is_trivially_copyable_v<PixelType>)
     {
-      using std::swap;
-      swap(*x_top, *x_bottom);
+      impl::swap_rows(img.byte_ptr(y_top), img.byte_ptr(y_bottom), static_cast<std::size_t>(img.row_bytes()));
+    }
+    else
+    {
+      std::swap_ranges(img.data(y_top), img.data_row_end(y_top), img.data(y_bottom));
     }
   }
-
-  // TODO: measure
-#if 0
-  std::vector<PixelType> buffer(old_img.width());  // TODO: could be stack-based in some cases?
-
-  for (auto y_top = 0_px; y_top < half_height; ++y_top)
-  {
-    const auto y_bottom = PixelIndex{old_img.height() - 1 - y_top};
-    std::copy(old_img.data(y_top), old_img.data_row_end(y_top), buffer.begin());
-    std::copy(old_img.data(y_bottom), old_img.data_row_end(y_bottom), old_img.data(y_top));
-    std::copy(std::cbegin(buffer), std::cend(buffer), old_img.data(y_bottom));
-  }
-#endif
 }
 
 /** \brief Transpose the image.
@@ -216,6 +205,9 @@ void flip_vertically_in_place(ImageBase<DerivedSrcDst>& img)
  * The output image will have transposed extents, i.e. output width will be input height, and output height will be
  * input width.
  *
+ * The image is transposed in cache-sized tiles, each of which is processed in blocks of 8x8 pixels. If SSE2 is
+ * available, blocks of pixels with a size of 1, 2 or 4 bytes are transposed in registers.
+ *
  * @tparam flip_h If true, the output will additionally be horizontally flipped.
  * @tparam flip_v If true, the output will additionally be vertically flipped.
  * @tparam DerivedSrcDst The typed source/target image type.
@@ -227,16 +219,7 @@ void transpose(const ImageBase<DerivedSrcDst>& img_src, ImageBase<DerivedSrcDst>
 {
   SELENE_ASSERT(&img_src != &img_dst);
   allocate(img_dst, {img_src.height(), img_src.width()});
-
-   for (auto dst_y = 0_idx; dst_y < img_dst.height(); ++dst_y)
-  {
-    for (auto dst_x = 0_idx; dst_x < img_dst.width(); ++dst_x)
-    {
-      const auto src_x = flip_v ? PixelIndex{img_src.width() - 1 - dst_y} : dst_y;  // branch determined at
-      const auto src_y = flip_h ? PixelIndex{img_src.height() - 1 - dst_x} : dst_x;  // compile time
-      img_dst(dst_x, dst_y) = img_src(src_x, src_y);
-    }
-  }
+  impl::transpose_tiled<flip_h, flip_v>(img_src, img_dst);
 }
 
 /** \brief Transpose the image.
@@ -254,7 +237,7 @@ template <bool flip_h, bool flip_v, typename DerivedSrc>
 Image<typename DerivedSrc::PixelType> transpose(const ImageBase<DerivedSrc>& img)
 {
   Image<typename DerivedSrc::PixelType> img_t;
-  transpose(img, img_t);
+  transpose<flip_h, flip_v>(img, img_t);
   return img_t;
 }
 
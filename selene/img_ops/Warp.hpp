@@ -0,0 +1,374 @@
+// This file is part of the `Selene` library.
+// Copyright 2017-2019 Michael Hofmann (https://github.com/kmhofmann).
+// Distributed under MIT license. See accompanying LICENSE file in the top-level directory.
+
+#ifndef SELENE_IMG_OPS_WARP_HPP
+#define SELENE_IMG_OPS_WARP_HPP
+
+/// @file
+
+#include <selene/base/Assert.hpp>
+#include <selene/base/Types.hpp>
+#include <selene/base/_impl/ParallelFor.hpp>
+
+#include <selene/img/common/Types.hpp>
+
+#include <selene/img/typed/Image.hpp>
+#include <selene/img/typed/ImageBase.hpp>
+
+#include <selene/img/typed/access/BorderAccessors.hpp>
+#include <selene/img/typed/access/Interpolators.hpp>
+
+#include <selene/img_ops/Allocate.hpp>
+
+#include <selene/img_ops/_impl/WarpKernels.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+namespace sln {
+
+/// \addtogroup group-img-ops
+/// @{
+
+/** \brief An affine transformation, given as the first two rows of a 3x3 matrix in row-major order.
+ *
+ * The transformation maps a location (x, y) to (m[0] * x + m[1] * y + m[2], m[3] * x + m[4] * y + m[5]).
+ */
+using AffineTransform = std::array<default_float_t, 6>;
+
+/** \brief A perspective transformation (homography), given as a 3x3 matrix in row-major order.
+ *
+ * The transformation maps a location (x, y) to ((m[0] * x + m[1] * y + m[2]) / w, (m[3] * x + m[4] * y + m[5]) / w),
+ * where w = m[6] * x + m[7] * y + m[8].
+ */
+using PerspectiveTransform = std::array<default_float_t, 9>;
+
+template <ImageInterpolationMode interpolation_mode = ImageInterpolationMode::Bilinear,
+          BorderAccessMode access_mode = BorderAccessMode::Replicated, typename DerivedSrc, typename DerivedDst>
+void warp_affine(const ImageBase<DerivedSrc>& img_src,
+                 ImageBase<DerivedDst>& img_dst,
+                 const AffineTransform& transform,
+                 PixelLength width,
+                 PixelLength height,
+                 int nr_threads = 0);
+
+template <ImageInterpolationMode interpolation_mode = ImageInterpolationMode::Bilinear,
+          BorderAccessMode access_mode = BorderAccessMode::Replicated, typename DerivedSrc>
+Image<typename DerivedSrc::PixelType> warp_affine(const ImageBase<DerivedSrc>& img_src,
+                                                  const AffineTransform& transform,
+                                                  PixelLength width,
+                                                  PixelLength height,
+                                                  int nr_threads = 0);
+
+template <ImageInterpolationMode interpolation_mode = ImageInterpolationMode::Bilinear,
+          BorderAccessMode access_mode = BorderAccessMode::Replicated, typename DerivedSrc, typename DerivedDst>
+void warp_perspective(const ImageBase<DerivedSrc>& img_src,
+                      ImageBase<DerivedDst>& img_dst,
+                      const PerspectiveTransform& transform,
+                      PixelLength width,
+                      PixelLength height,
+                      int nr_threads = 0);
+
+template <ImageInterpolationMode interpolation_mode = ImageInterpolationMode::Bilinear,
+          BorderAccessMode access_mode = BorderAccessMode::Replicated, typename DerivedSrc>
+Image<typename DerivedSrc::PixelType> warp_perspective(const ImageBase<DerivedSrc>& img_src,
+                                                       const PerspectiveTransform& transform,
+                                                       PixelLength width,
+                                                       PixelLength height,
+                                                       int nr_threads = 0);
+
+/// @}
+
+// ----------
+// Implementation:
+
+namespace impl {
+
+// Minimum number of target pixels per row band. Smaller images are processed on the calling thread.
+constexpr std::size_t warp_min_band_size = std::size_t{64} * 1024;
+
+// Computes the fixed-point source coordinates of target row y under an affine transformation. Returns whether the
+// coordinates are exactly linear in x.
+inline bool warp_affine_row_coordinates(const AffineTransform& m,
+                                        std::ptrdiff_t y,
+                                        std::ptrdiff_t width,
+                                        std::int64_t* xs,
+                                        std::int64_t* ys)
+{
+  const auto dy = static_cast<double>(y);
+  const auto x_first = double(m[1]) * dy + double(m[2]);
+  const auto y_first = double(m[4]) * dy + double(m[5]);
+  const auto x_last = x_first + double(m[0]) * static_cast<double>(width - 1);
+  const auto y_last = y_first + double(m[3]) * static_cast<double>(width - 1);
+
+  const auto in_range = [](double value) { return std::abs(value) <= warp_max_coordinate; };
+  if (in_range(x_first) && in_range(x_last) && in_range(y_first) && in_range(y_last) && in_range(double(m[0]))
+      && in_range(double(m[3])))
+  {
+    // Incremental evaluation; the rounding error of the steps accumulates to at most width * 2^-33 pixels.
+    auto fx = warp_to_fixed(x_first);
+    auto fy = warp_to_fixed(y_first);
+    const auto step_x = static_cast<std::int64_t>(std::round(double(m[0]) * double(warp_one)));
+    const auto step_y = static_cast<std::int64_t>(std::round(double(m[3]) * double(warp_one)));
+    for (std::ptrdiff_t x = 0; x < width; ++x)
+    {
+      xs[x] = fx;
+      ys[x] = fy;
+      fx += step_x;
+      fy += step_y;
+    }
+    return true;
+  }
+
+  // Parts of the row map far outside of the source image; evaluate each coordinate separately, with clamping.
+  for (std::ptrdiff_t x = 0; x < width; ++x)
+  {
+    const auto dx = static_cast<double>(x);
+    xs[x] = warp_to_fixed(x_first + double(m[0]) * dx);
+    ys[x] = warp_to_fixed(y_first + double(m[3]) * dx);
+  }
+  return false;
+}
+
+// Computes the fixed-point source coordinates of target row y under a perspective transformation.
+inline bool warp_perspective_row_coordinates(const PerspectiveTransform& m,
+                                             std::ptrdiff_t y,
+                                             std::ptrdiff_t width,
+                                             std::int64_t* xs,
+                                             std::int64_t* ys)
+{
+  const auto dy = static_cast<double>(y);
+  auto nx = double(m[1]) * dy + double(m[2]);
+  auto ny = double(m[4]) * dy + double(m[5]);
+  auto nw = double(m[7]) * dy + double(m[8]);
+
+  // Along the row, w is linear in x. If it has the same sign (and is not close to zero) at both ends, the source
+  // coordinates are monotonic along the row, and lie between those at the ends. If the latter are well within range, no
+  // coordinate of the row needs to be clamped.
+  const auto last = static_cast<double>(width - 1);
+  const auto nx_last = nx + double(m[0]) * last;
+  const auto ny_last = ny + double(m[3]) * last;
+  const auto nw_last = nw + double(m[6]) * last;
+  const auto nw_min = 1e-6 * (std::abs(nw) + std::abs(double(m[6])) * last);
+  const auto in_range = [](double value) { return std::abs(value) <= 0.5 * warp_max_coordinate; };
+
+  if (((nw > nw_min && nw_last > nw_min) || (nw < -nw_min && nw_last < -nw_min)) && in_range(nx / nw)
+      && in_range(ny / nw) && in_range(nx_last / nw_last) && in_range(ny_last / nw_last))
+  {
+    for (std::ptrdiff_t x = 0; x < width; ++x)
+    {
+      const auto inv_w = 1.0 / nw;
+      xs[x] = warp_to_fixed_unclamped(nx * inv_w);
+      ys[x] = warp_to_fixed_unclamped(ny * inv_w);
+      nx += double(m[0]);
+      ny += double(m[3]);
+      nw += double(m[6]);
+    }
+    return false;
+  }
+
+  // Numerators and denominator are stepped incrementally; locations with w = 0 are clamped by warp_to_fixed.
+  for (std::ptrdiff_t x = 0; x < width; ++x)
+  {
+    const auto inv_w = 1.0 / nw;
+    xs[x] = warp_to_fixed(nx * inv_w);
+    ys[x] = warp_to_fixed(ny * inv_w);
+    nx += double(m[0]);
+    ny += double(m[3]);
+    nw += double(m[6]);
+  }
+  return false;
+}
+
+template <ImageInterpolationMode interpolation_mode, BorderAccessMode access_mode, typename DerivedSrc,
+          typename DerivedDst, typename RowCoordinatesFunc>
+void warp(const ImageBase<DerivedSrc>& img_src,
+          ImageBase<DerivedDst>& img_dst,
+          PixelLength width,
+          PixelLength height,
+          int nr_threads,
+          RowCoordinatesFunc row_coordinates)
+{
+  static_assert(std::is_same_v<typename DerivedSrc::PixelType, typename DerivedDst::PixelType>,
+                "Incompatible source and target types");
+  SELENE_ASSERT(img_src.width() > 0 && img_src.height() > 0);
+
+  allocate(img_dst, {width, height});
+
+  if (width == 0 || height == 0)
+  {
+    return;
+  }
+
+  const auto dst_width = static_cast<std::ptrdiff_t>(width);
+  const auto dst_height = static_cast<std::size_t>(height);
+  const auto nr_pixels = static_cast<std::size_t>(dst_width) * dst_height;
+  const auto nr_tasks = std::min(dst_height, get_nr_tasks(nr_pixels, warp_min_band_size, get_nr_threads(nr_threads)));
+
+  parallel_for(nr_tasks, nr_tasks, [&](std::size_t task) {
+    const auto y_begin = static_cast<std::ptrdiff_t>(dst_height * task / nr_tasks);
+    const auto y_end = static_cast<std::ptrdiff_t>(dst_height * (task + 1) / nr_tasks);
+
+    std::vector<std::int64_t> xs(static_cast<std::size_t>(dst_width));
+    std::vector<std::int64_t> ys(static_cast<std::size_t>(dst_width));
+
+    for (auto y = y_begin; y < y_end; ++y)
+    {
+      const bool is_linear = row_coordinates(y, dst_width, xs.data(), ys.data());
+      const auto dst = img_dst.data(PixelIndex{static_cast<PixelIndex::value_type>(y)});
+      warp_row<interpolation_mode, access_mode>(img_src, xs.data(), ys.data(), is_linear, dst, dst_width);
+    }
+  });
+}
+
+}  // namespace impl
+
+/** \brief Applies an affine transformation to the source image.
+ *
+ * Each target pixel (x, y) is sampled from the source image at location `transform`(x, y); i.e. `transform` maps
+ * target to source coordinates.
+ * Source coordinates are stepped incrementally along each row, in fixed-point arithmetic. Only the pixels of each row
+ * that are sampled from outside of (or at the very border of) the source image use bounds-checking border access; the
+ * rows are processed in parallel bands.
+ *
+ * Source and target image may not be the same image.
+ *
+ * @tparam interpolation_mode The interpolation mode to use.
+ * @tparam access_mode The border access mode to be used when sampling outside the source image bounds.
+ *                     `BorderAccessMode::Replicated` by default.
+ *                     `BorderAccessMode::Unchecked` requires all source locations to be accessible, e.g. because the
+ *                     source image is a view into a larger image.
+ * @tparam DerivedSrc The typed source image type.
+ * @tparam DerivedDst The typed target image type.
+ * @param img_src The source image. May not be empty.
+ * @param img_dst The target image.
+ * @param transform The affine transformation from target to source coordinates.
+ * @param width The width of the target image.
+ * @param height The height of the target image.
+ * @param nr_threads The number of threads to use. A value <= 0 denotes the number of concurrent threads supported by
+ *                   the hardware.
+ */
+template <ImageInterpolationMode interpolation_mode, BorderAccessMode access_mode, typename DerivedSrc,
+          typename DerivedDst>
+void warp_affine(const ImageBase<DerivedSrc>& img_src,
+                 ImageBase<DerivedDst>& img_dst,
+                 const AffineTransform& transform,
+                 PixelLength width,
+                 PixelLength height,
+                 int nr_threads)
+{
+  impl::warp<interpolation_mode, access_mode>(
+      img_src, img_dst, width, height, nr_threads,
+      [&transform](std::ptrdiff_t y, std::ptrdiff_t row_width, std::int64_t* xs, std::int64_t* ys) {
+        return impl::warp_affine_row_coordinates(transform, y, row_width, xs, ys);
+      });
+}
+
+/** \brief Applies an affine transformation to the source image.
+ *
+ * See the overload taking a target image for details.
+ *
+ * @tparam interpolation_mode The interpolation mode to use.
+ * @tparam access_mode The border access mode to be used when sampling outside the source image bounds.
+ * @tparam DerivedSrc The typed source image type.
+ * @param img_src The source image. May not be empty.
+ * @param transform The affine transformation from target to source coordinates.
+ * @param width The width of the target image.
+ * @param height The height of the target image.
+ * @param nr_threads The number of threads to use. A value <= 0 denotes the number of concurrent threads supported by
+ *                   the hardware.
+ * @return The warped image.
+ */
+template <ImageInterpolationMode interpolation_mode, BorderAccessMode access_mode, typename DerivedSrc>
+Image<typename DerivedSrc::PixelType> warp_affine(const ImageBase<DerivedSrc>& img_src,
+                                                  const AffineTransform& transform,
+                                                  PixelLength width,
+                                                  PixelLength height,
+                                                  int nr_threads)
+{
+  Image<typename DerivedSrc::PixelType> img_dst;
+  warp_affine<interpolation_mode, access_mode>(img_src, img_dst, transform, width, height, nr_threads);
+  return img_dst;
+}
+
+/** \brief Applies a perspective transformation to the source image.
+ *
+ * Each target pixel (x, y) is sampled from the source image at location `transform`(x, y); i.e. `transform` maps
+ * target to source coordinates. Target pixels for which the transformation is undefined (w = 0) are sampled from far
+ * outside of the source image.
+ * Numerators and denominator of the source coordinates are stepped incrementally along each row. Only the pixels of
+ * each row that are sampled from outside of (or at the very border of) the source image use bounds-checking border
+ * access; the rows are processed in parallel bands.
+ * Unlike for an affine transformation, source coordinates are not linear along a row: each target pixel still requires
+ * one division, and the interior span of each row is determined by scanning its coordinates. A perspective warp is
+ * therefore only moderately faster than sampling each target pixel at its individually transformed location.
+ *
+ * Source and target image may not be the same image.
+ *
+ * @tparam interpolation_mode The interpolation mode to use.
+ * @tparam access_mode The border access mode to be used when sampling outside the source image bounds.
+ *                     `BorderAccessMode::Replicated` by default.
+ *                     `BorderAccessMode::Unchecked` requires all source locations to be accessible, e.g. because the
+ *                     source image is a view into a larger image.
+ * @tparam DerivedSrc The typed source image type.
+ * @tparam DerivedDst The typed target image type.
+ * @param img_src The source image. May not be empty.
+ * @param img_dst The target image.
+ * @param transform The perspective transformation from target to source coordinates.
+ * @param width The width of the target image.
+ * @param height The height of the target image.
+ * @param nr_threads The number of threads to use. A value <= 0 denotes the number of concurrent threads supported by
+ *                   the hardware.
+ */
+template <ImageInterpolationMode interpolation_mode, BorderAccessMode access_mode, typename DerivedSrc,
+          typename DerivedDst>
+void warp_perspective(const ImageBase<DerivedSrc>& img_src,
+                      ImageBase<DerivedDst>& img_dst,
+                      const PerspectiveTransform& transform,
+                      PixelLength width,
+                      PixelLength height,
+                      int nr_threads)
+{
+  impl::warp<interpolation_mode, access_mode>(
+      img_src, img_dst, width, height, nr_threads,
+      [&transform](std::ptrdiff_t y, std::ptrdiff_t row_width, std::int64_t* xs, std::int64_t* ys) {
+        return impl::warp_perspective_row_coordinates(transform, y, row_width, xs, ys);
+      });
+}
+
+/** \brief Applies a perspective transformation to the source image.
+ *
+ * See the overload taking a target image for details.
+ *
+ * @tparam interpolation_mode The interpolation mode to use.
+ * @tparam access_mode The border access mode to be used when sampling outside the source image bounds.
+ * @tparam DerivedSrc The typed source image type.
+ * @param img_src The source image. May not be empty.
+ * @param transform The perspective transformation from target to source coordinates.
+ * @param width The width of the target image.
+ * @param height The height of the target image.
+ * @param nr_threads The number of threads to use. A value <= 0 denotes the number of concurrent threads supported by
+ *                   the hardware.
+ * @return The warped image.
+ */
+template <ImageInterpolationMode interpolation_mode, BorderAccessMode access_mode, typename DerivedSrc>
+Image<typename DerivedSrc::PixelType> warp_perspective(const ImageBase<DerivedSrc>& img_src,
+                                                       const PerspectiveTransform& transform,
+                                                       PixelLength width,
+                                                       PixelLength height,
+                                                       int nr_threads)
+{
+  Image<typename DerivedSrc::PixelType> img_dst;
+  warp_perspective<interpolation_mode, access_mode>(img_src, img_dst, transform, width, height, nr_threads);
+  return img_dst;
+}
+
+}  // namespace sln
+
+#endif  // SELENE_IMG_OPS_WARP_HPP
@@ -0,0 +1,98 @@
+// This file is part of the `Selene` library.
+// Copyright 2017-2019 Michael Hofmann (https://github.com/kmhofmann).
+// Distributed under MIT license. See accompanying LICENSE file in the top-level directory.
+
+#ifndef SELENE_IMG_IMPL_BORDER_PADDING_HPP
+#define SELENE_IMG_IMPL_BORDER_PADDING_HPP
+
+/// @file
+
+#include <selene/img/common/Types.hpp>
+
+#include <selene/img/typed/ImageBase.hpp>
+
+#include <selene/img/typed/access/BorderAccessors.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+namespace sln::impl {
+
+// Helpers for row-based image filters, which operate on rows padded according to a border access mode.
+
+// Returns a pointer to the first element of image row y (which has to lie inside the image), padded by `pad_left` pixels
+// on the left and `pad_right` pixels on the right. Except for BorderAccessMode::Unchecked, the padded row is assembled
+// in `line`, which needs to hold (width + pad_left + pad_right) pixels.
+template <BorderAccessMode access_mode, typename T, std::size_t N, typename DerivedSrc>
+const T* horizontally_padded_row(const ImageBase<DerivedSrc>& img,
+                                 PixelIndex y,
+                                 std::ptrdiff_t pad_left,
+                                 std::ptrdiff_t pad_right,
+                                 std::vector<T>& line)
+{
+  constexpr auto n = static_cast<std::ptrdiff_t>(N);
+  const auto row = reinterpret_cast<const T*>(img.byte_ptr(y));
+
+  if constexpr (access_mode == BorderAccessMode::Unchecked)
+  {
+    return row - n * pad_left;
+  }
+  else
+  {
+    const auto row_len = n * static_cast<std::ptrdiff_t>(img.width());
+    const auto dst = line.data();
+    std::copy(row, row + row_len, dst + n * pad_left);
+
+    for (std::ptrdiff_t i = 0; i < pad_left; ++i)
+    {
+      for (std::ptrdiff_t c = 0; c < n; ++c)
+      {
+        dst[n * i + c] = (access_mode == BorderAccessMode::ZeroPadding) ? T{0} : row[c];
+      }
+    }
+
+    const auto right = dst + n * pad_left + row_len;
+    for (std::ptrdiff_t i = 0; i < pad_right; ++i)
+    {
+      for (std::ptrdiff_t c = 0; c < n; ++c)
+      {
+        right[n * i + c] = (access_mode == BorderAccessMode::ZeroPadding) ? T{0} : row[row_len - n + c];
+      }
+    }
+
+    return dst;
+  }
+}
+
+// Returns a pointer to the first element of row y, padded as in `horizontally_padded_row`, for any row index y; rows
+// outside the image are substituted according to the border access mode.
+template <BorderAccessMode access_mode, typename T, std::size_t N, typename DerivedSrc>
+const T* padded_row(const ImageBase<DerivedSrc>& img,
+                    std::ptrdiff_t y,
+                    std::ptrdiff_t pad_left,
+                    std::ptrdiff_t pad_right,
+                    std::vector<T>& line)
+{
+  const auto height = static_cast<std::ptrdiff_t>(img.height());
+
+  if constexpr (access_mode == BorderAccessMode::ZeroPadding)
+  {
+    if (y < 0 || y >= height)
+    {
+      std::fill(line.begin(), line.end(), T{0});
+      return line.data();
+    }
+  }
+  else if constexpr (access_mode == BorderAccessMode::Replicated)
+  {
+    y = std::clamp(y, std::ptrdiff_t{0}, height - 1);
+  }
+
+  return horizontally_padded_row<access_mode, T, N>(img, PixelIndex{static_cast<PixelIndex::value_type>(y)}, pad_left,
+                                                    pad_right, line);
+}
+
+}  // namespace sln::impl
+
+#endif  // SELENE_IMG_IMPL_BORDER_PADDING_HPP
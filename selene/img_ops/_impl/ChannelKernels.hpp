@@ -0,0 +1,358 @@
+// This file is part of the `Selene` library.
+// Copyright 2017-2019 Michael Hofmann (https://github.com/kmhofmann).
+// Distributed under MIT license. See accompanying LICENSE file in the top-level directory.
+
+#ifndef SELENE_IMG_IMPL_CHANNEL_KERNELS_HPP
+#define SELENE_IMG_IMPL_CHANNEL_KERNELS_HPP
+
+/// @file
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#endif
+
+namespace sln::impl {
+
+// Interleaving N single-channel rows into one N-channel row, and the reverse. 16 bytes per channel are processed at a
+// time in SIMD registers for 8-, 16- and 32-bit elements (if available): 4-channel rows via SSE2 unpack operations,
+// and 3-channel rows via SSSE3 byte shuffles, or, with SSE2 only, as 4-channel rows whose zero fourth channel is
+// squeezed out (or inserted) with shift operations. All other cases, as well as the row remainders, are copied
+// element-wise.
+
+template <std::size_t N, typename T>
+constexpr bool channel_interleave_vectorizable()
+{
+  constexpr auto size = sizeof(T);
+  constexpr bool valid_type = std::is_arithmetic_v<T> && (size == 1 || size == 2 || size == 4);
+#if defined(__SSE2__)
+  return valid_type && (N == 3 || N == 4);
+#else
+  return false;
+#endif
+}
+
+#if defined(__SSE2__)
+
+template <std::size_t nr_bytes>
+inline __m128i unpack_lo(__m128i a, __m128i b)
+{
+  if constexpr (nr_bytes == 1) { return _mm_unpacklo_epi8(a, b); }
+  else if constexpr (nr_bytes == 2) { return _mm_unpacklo_epi16(a, b); }
+  else if constexpr (nr_bytes == 4) { return _mm_unpacklo_epi32(a, b); }
+  else { return _mm_unpacklo_epi64(a, b); }
+}
+
+template <std::size_t nr_bytes>
+inline __m128i unpack_hi(__m128i a, __m128i b)
+{
+  if constexpr (nr_bytes == 1) { return _mm_unpackhi_epi8(a, b); }
+  else if constexpr (nr_bytes == 2) { return _mm_unpackhi_epi16(a, b); }
+  else if constexpr (nr_bytes == 4) { return _mm_unpackhi_epi32(a, b); }
+  else { return _mm_unpackhi_epi64(a, b); }
+}
+
+template <std::size_t nr_bytes>
+inline void interleave_4(const __m128i (&in)[4], __m128i (&out)[4])
+{
+  const auto lo_01 = unpack_lo<nr_bytes>(in[0], in[1]);
+  const auto hi_01 = unpack_hi<nr_bytes>(in[0], in[1]);
+  const auto lo_23 = unpack_lo<nr_bytes>(in[2], in[3]);
+  const auto hi_23 = unpack_hi<nr_bytes>(in[2], in[3]);
+  out[0] = unpack_lo<2 * nr_bytes>(lo_01, lo_23);
+  out[1] = unpack_hi<2 * nr_bytes>(lo_01, lo_23);
+  out[2] = unpack_lo<2 * nr_bytes>(hi_01, hi_23);
+  out[3] = unpack_hi<2 * nr_bytes>(hi_01, hi_23);
+}
+
+// Takes two consecutive registers of 4-channel pixels; afterwards, `a` holds channels 0 and 1, and `b` holds channels
+// 2 and 3 (each channel as a contiguous block of elements).
+template <std::size_t nr_bytes>
+inline void unzip_4(__m128i& a, __m128i& b)
+{
+  constexpr int nr_rounds = (nr_bytes == 1) ? 3 : (nr_bytes == 2) ? 2 : 1;
+  for (int i = 0; i < nr_rounds; ++i)
+  {
+    const auto lo = unpack_lo<nr_bytes>(a, b);
+    const auto hi = unpack_hi<nr_bytes>(a, b);
+    a = lo;
+    b = hi;
+  }
+}
+
+template <std::size_t nr_bytes>
+inline void deinterleave_4(const __m128i (&in)[4], __m128i (&out)[4])
+{
+  auto a_01 = in[0];
+  auto a_23 = in[1];
+  auto b_01 = in[2];
+  auto b_23 = in[3];
+  unzip_4<nr_bytes>(a_01, a_23);
+  unzip_4<nr_bytes>(b_01, b_23);
+  out[0] = _mm_unpacklo_epi64(a_01, b_01);
+  out[1] = _mm_unpackhi_epi64(a_01, b_01);
+  out[2] = _mm_unpacklo_epi64(a_23, b_23);
+  out[3] = _mm_unpackhi_epi64(a_23, b_23);
+}
+
+#endif  // defined(__SSE2__)
+
+#if defined(__SSSE3__)
+
+// Byte shuffle masks for 3-channel (de)interleaving; 0x80 zeroes the respective output byte.
+struct ShuffleMasks3
+{
+  std::uint8_t bytes[3][3][16];
+};
+
+template <std::size_t nr_bytes>
+constexpr ShuffleMasks3 make_interleave_3_masks()
+{
+  // bytes[j][c]: contribution of channel register c to output register j
+  ShuffleMasks3 m{};
+  for (std::size_t j = 0; j < 3; ++j)
+  {
+    for (std::size_t k = 0; k < 16; ++k)
+    {
+      const auto element = (16 * j + k) / nr_bytes;
+      const auto pixel = element / 3;
+      const auto channel = element % 3;
+      for (std::size_t c = 0; c < 3; ++c)
+      {
+        m.bytes[j][c][k] = (c == channel) ? static_cast<std::uint8_t>(pixel * nr_bytes + k % nr_bytes) : 0x80;
+      }
+    }
+  }
+  return m;
+}
+
+template <std::size_t nr_bytes>
+constexpr ShuffleMasks3 make_deinterleave_3_masks()
+{
+  // bytes[c][j]: contribution of input register j to channel register c
+  ShuffleMasks3 m{};
+  for (std::size_t c = 0; c < 3; ++c)
+  {
+    for (std::size_t k = 0; k < 16; ++k)
+    {
+      const auto pixel = k / nr_bytes;
+      const auto byte = (pixel * 3 + c) * nr_bytes + k % nr_bytes;
+      for (std::size_t j = 0; j < 3; ++j)
+      {
+        m.bytes[c][j][k] = (byte / 16 == j) ? static_cast<std::uint8_t>(byte % 16) : 0x80;
+      }
+    }
+  }
+  return m;
+}
+
+inline __m128i shuffle_or_3(const __m128i (&in)[3], const std::uint8_t (&masks)[3][16])
+{
+  const auto mask = [&masks](std::size_t i) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(masks[i])); };
+  return _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(in[0], mask(0)), _mm_shuffle_epi8(in[1], mask(1))),
+                      _mm_shuffle_epi8(in[2], mask(2)));
+}
+
+template <std::size_t nr_bytes>
+inline void interleave_3(const __m128i (&in)[3], __m128i (&out)[3])
+{
+  static constexpr auto masks = make_interleave_3_masks<nr_bytes>();
+  for (std::size_t j = 0; j < 3; ++j)
+  {
+    out[j] = shuffle_or_3(in, masks.bytes[j]);
+  }
+}
+
+template <std::size_t nr_bytes>
+inline void deinterleave_3(const __m128i (&in)[3], __m128i (&out)[3])
+{
+  static constexpr auto masks = make_deinterleave_3_masks<nr_bytes>();
+  for (std::size_t c = 0; c < 3; ++c)
+  {
+    out[c] = shuffle_or_3(in, masks.bytes[c]);
+  }
+}
+
+#elif defined(__SSE2__)
+
+// Packs the 3-channel pixels of a register, each followed by one zero element, into its lower 12 bytes.
+template <std::size_t nr_bytes>
+inline __m128i pack_padded_pixels_3(__m128i v)
+{
+  if constexpr (nr_bytes == 1)
+  {
+    const auto lo_pixels = _mm_and_si128(v, _mm_set_epi32(0, -1, 0, -1));
+    v = _mm_or_si128(lo_pixels, _mm_slli_epi64(_mm_srli_epi64(v, 32), 24));
+  }
+
+  if constexpr (nr_bytes <= 2)
+  {
+    v = _mm_or_si128(_mm_move_epi64(v), _mm_slli_si128(_mm_srli_si128(v, 8), 6));
+  }
+
+  return v;
+}
+
+// Reverses pack_padded_pixels_3(); the upper 4 bytes of the input register need to be zero.
+template <std::size_t nr_bytes>
+inline __m128i unpack_padded_pixels_3(__m128i v)
+{
+  if constexpr (nr_bytes <= 2)
+  {
+    const auto mask_6 = _mm_set_epi32(0, 0, 0xFFFF, -1);
+    v = _mm_or_si128(_mm_and_si128(v, mask_6), _mm_slli_si128(_mm_and_si128(_mm_srli_si128(v, 6), mask_6), 8));
+  }
+
+  if constexpr (nr_bytes == 1)
+  {
+    const auto mask_3 = _mm_set_epi32(0, 0xFFFFFF, 0, 0xFFFFFF);
+    v = _mm_or_si128(_mm_and_si128(v, mask_3), _mm_slli_epi64(_mm_srli_epi64(v, 24), 32));
+  }
+
+  return v;
+}
+
+template <std::size_t nr_bytes>
+inline void interleave_3(const __m128i (&in)[3], __m128i (&out)[3])
+{
+  // Each of the four padded registers holds 12 bytes of the interleaved output.
+  const __m128i in_4[4] = {in[0], in[1], in[2], _mm_setzero_si128()};
+  __m128i padded[4];
+  interleave_4<nr_bytes>(in_4, padded);
+  for (auto& v : padded)
+  {
+    v = pack_padded_pixels_3<nr_bytes>(v);
+  }
+
+  out[0] = _mm_or_si128(padded[0], _mm_slli_si128(padded[1], 12));
+  out[1] = _mm_or_si128(_mm_srli_si128(padded[1], 4), _mm_slli_si128(padded[2], 8));
+  out[2] = _mm_or_si128(_mm_srli_si128(padded[2], 8), _mm_slli_si128(padded[3], 4));
+}
+
+template <std::size_t nr_bytes>
+inline void deinterleave_3(const __m128i (&in)[3], __m128i (&out)[3])
+{
+  const auto mask_12 = _mm_set_epi32(0, -1, -1, -1);
+  const __m128i padded[4] = {
+      unpack_padded_pixels_3<nr_bytes>(_mm_and_si128(in[0], mask_12)),
+      unpack_padded_pixels_3<nr_bytes>(
+          _mm_and_si128(_mm_or_si128(_mm_srli_si128(in[0], 12), _mm_slli_si128(in[1], 4)), mask_12)),
+      unpack_padded_pixels_3<nr_bytes>(
+          _mm_and_si128(_mm_or_si128(_mm_srli_si128(in[1], 8), _mm_slli_si128(in[2], 8)), mask_12)),
+      unpack_padded_pixels_3<nr_bytes>(_mm_srli_si128(in[2], 4))};
+
+  __m128i out_4[4];
+  deinterleave_4<nr_bytes>(padded, out_4);
+  for (std::size_t c = 0; c < 3; ++c)
+  {
+    out[c] = out_4[c];
+  }
+}
+
+#endif  // defined(__SSSE3__)
+
+/** \brief Interleaves the elements of N single-channel rows of `width` elements into one N-channel row.
+ */
+template <std::size_t N, typename T>
+inline void interleave_row(const std::array<const T*, N>& src, T* dst, std::ptrdiff_t width)
+{
+  std::ptrdiff_t x = 0;
+
+#if defined(__SSE2__)
+  if constexpr (channel_interleave_vectorizable<N, T>())
+  {
+    constexpr auto nr_elements = static_cast<std::ptrdiff_t>(16 / sizeof(T));
+    for (; x + nr_elements <= width; x += nr_elements)
+    {
+      __m128i in[N];
+      __m128i out[N];
+
+      for (std::size_t c = 0; c < N; ++c)
+      {
+        in[c] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src[c] + x));
+      }
+
+      if constexpr (N == 4)
+      {
+        interleave_4<sizeof(T)>(in, out);
+      }
+      else
+      {
+        interleave_3<sizeof(T)>(in, out);
+      }
+
+      for (std::size_t j = 0; j < N; ++j)
+      {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + N * x + j * nr_elements), out[j]);
+      }
+    }
+  }
+#endif
+
+  for (; x < width; ++x)
+  {
+    for (std::size_t c = 0; c < N; ++c)
+    {
+      dst[N * x + c] = src[c][x];
+    }
+  }
+}
+
+/** \brief Splits one N-channel row of `width` pixels into N single-channel rows.
+ */
+template <std::size_t N, typename T>
+inline void deinterleave_row(const T* src, const std::array<T*, N>& dst, std::ptrdiff_t width)
+{
+  std::ptrdiff_t x = 0;
+
+#if defined(__SSE2__)
+  if constexpr (channel_interleave_vectorizable<N, T>())
+  {
+    constexpr auto nr_elements = static_cast<std::ptrdiff_t>(16 / sizeof(T));
+    for (; x + nr_elements <= width; x += nr_elements)
+    {
+      __m128i in[N];
+      __m128i out[N];
+
+      for (std::size_t j = 0; j < N; ++j)
+      {
+        in[j] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + N * x + j * nr_elements));
+      }
+
+      if constexpr (N == 4)
+      {
+        deinterleave_4<sizeof(T)>(in, out);
+      }
+      else
+      {
+        deinterleave_3<sizeof(T)>(in, out);
+      }
+
+      for (std::size_t c = 0; c < N; ++c)
+      {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst[c] + x), out[c]);
+      }
+    }
+  }
+#endif
+
+  for (; x < width; ++x)
+  {
+    for (std::size_t c = 0; c < N; ++c)
+    {
+      dst[c][x] = src[N * x + c];
+    }
+  }
+}
+
+}  // namespace sln::impl
+
+#endif  // SELENE_IMG_IMPL_CHANNEL_KERNELS_HPP
@@ -0,0 +1,135 @@
+// This file is part of the `Selene` library.
+// Copyright 2017-2019 Michael Hofmann (https://github.com/kmhofmann).
+// Distributed under MIT license. See accompanying LICENSE file in the top-level directory.
+
+#ifndef SELENE_IMG_IMPL_FLIP_KERNELS_HPP
+#define SELENE_IMG_IMPL_FLIP_KERNELS_HPP
+
+/// @file
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace sln::impl {
+
+// Horizontal flips reverse the order of the pixels in each row. For pixels of 1, 2, 4 or 8 bytes (i.e. 8-bit pixels
+// with 1, 2 or 4 channels, and 16-bit pixels with 1, 2 or 4 channels), 16 bytes at a time are reversed in SSE2
+// registers (if available). Vertical flips swap or copy whole rows via memcpy.
+
+template <typename PixelType>
+constexpr bool flip_row_vectorizable()
+{
+#if defined(__SSE2__)
+  constexpr auto size = sizeof(PixelType);
+  return std::is_trivially_copyable_v<PixelType> && (size == 1 || size == 2 || size == 4 || size == 8);
+#else
+  return false;
+#endif
+}
+
+#if defined(__SSE2__)
+
+template <std::size_t nr_bytes_per_pixel>
+inline __m128i reverse_pixels(__m128i v)
+{
+  if constexpr (nr_bytes_per_pixel == 8)
+  {
+    return _mm_shuffle_epi32(v, 0x4E);
+  }
+  else
+  {
+    v = _mm_shuffle_epi32(v, 0x1B);  // reverse 4-byte elements
+
+    if constexpr (nr_bytes_per_pixel <= 2)
+    {
+      v = _mm_shufflehi_epi16(_mm_shufflelo_epi16(v, 0xB1), 0xB1);  // swap 2-byte elements within 4-byte elements
+    }
+
+    if constexpr (nr_bytes_per_pixel == 1)
+    {
+      v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));  // swap bytes within 2-byte elements
+    }
+
+    return v;
+  }
+}
+
+#endif  // defined(__SSE2__)
+
+/** \brief Copies a row of `width` pixels from `src` to `dst` in reversed order. The rows must not overlap.
+ */
+template <typename PixelType>
+inline void flip_row_copy(const PixelType* src, PixelType* dst, std::ptrdiff_t width)
+{
+  std::ptrdiff_t x = 0;
+
+#if defined(__SSE2__)
+  if constexpr (flip_row_vectorizable<PixelType>())
+  {
+    constexpr auto nr_pixels = static_cast<std::ptrdiff_t>(16 / sizeof(PixelType));
+    for (; x + nr_pixels <= width; x += nr_pixels)
+    {
+      const auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + (width - x - nr_pixels)),
+                       reverse_pixels<sizeof(PixelType)>(v));
+    }
+  }
+#endif
+
+  std::reverse_copy(src + x, src + width, dst);
+}
+
+/** \brief Reverses the order of the `width` pixels in `row`, in-place.
+ */
+template <typename PixelType>
+inline void flip_row_in_place(PixelType* row, std::ptrdiff_t width)
+{
+  std::ptrdiff_t left = 0;
+  std::ptrdiff_t right = width;  // exclusive
+
+#if defined(__SSE2__)
+  if constexpr (flip_row_vectorizable<PixelType>())
+  {
+    // Swap reversed 16-byte chunks from both ends, until these would overlap.
+    constexpr auto nr_pixels = static_cast<std::ptrdiff_t>(16 / sizeof(PixelType));
+    for (; right - left >= 2 * nr_pixels; left += nr_pixels, right -= nr_pixels)
+    {
+      const auto ptr_left = reinterpret_cast<__m128i*>(row + left);
+      const auto ptr_right = reinterpret_cast<__m128i*>(row + (right - nr_pixels));
+      const auto v_left = _mm_loadu_si128(ptr_left);
+      const auto v_right = _mm_loadu_si128(ptr_right);
+      _mm_storeu_si128(ptr_left, reverse_pixels<sizeof(PixelType)>(v_right));
+      _mm_storeu_si128(ptr_right, reverse_pixels<sizeof(PixelType)>(v_left));
+    }
+  }
+#endif
+
+  std::reverse(row + left, row + right);
+}
+
+/** \brief Swaps the contents of two non-overlapping rows of `nr_bytes` bytes each, via a small stack buffer.
+ */
+inline void swap_rows(std::uint8_t* row_0, std::uint8_t* row_1, std::size_t nr_bytes)
+{
+  constexpr std::size_t buffer_size = 2048;
+  std::uint8_t buffer[buffer_size];
+
+  for (std::size_t offset = 0; offset < nr_bytes; offset += buffer_size)
+  {
+    const auto n = std::min(buffer_size, nr_bytes - offset);
+    std::memcpy(buffer, row_0 + offset, n);
+    std::memcpy(row_0 + offset, row_1 + offset, n);
+    std::memcpy(row_1 + offset, buffer, n);
+  }
+}
+
+}  // namespace sln::impl
+
+#endif  // SELENE_IMG_IMPL_FLIP_KERNELS_HPP
@@ -0,0 +1,116 @@
+// This file is part of the `Selene` library.
+// Copyright 2017-2019 Michael Hofmann (https://github.com/kmhofmann).
+// Distributed under MIT license. See accompanying LICENSE file in the top-level directory.
+
+#ifndef SELENE_IMG_IMPL_LUT_KERNELS_HPP
+#define SELENE_IMG_IMPL_LUT_KERNELS_HPP
+
+/// @file
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <vector>
+
+namespace sln::impl {
+
+/** \brief Storage of the entries of a look-up table.
+ *
+ * Small tables (i.e. for 8-bit inputs) are stored inline, which allows constructing them at compile time. Large tables
+ * (i.e. for 16-bit inputs) are allocated on the heap, so that a table object can be kept on the stack.
+ */
+template <typename Out, std::size_t nr_entries, bool is_inline = (nr_entries <= 256)>
+struct LutTable
+{
+  std::array<Out, nr_entries> values{};
+
+  constexpr const Out* data() const noexcept { return values.data(); }
+  constexpr Out* data() noexcept { return values.data(); }
+};
+
+template <typename Out, std::size_t nr_entries>
+struct LutTable<Out, nr_entries, false>
+{
+  std::vector<Out> values = std::vector<Out>(nr_entries);
+
+  const Out* data() const noexcept { return values.data(); }
+  Out* data() noexcept { return values.data(); }
+};
+
+// Row kernels for look-up table application. The table look-ups are unrolled into independent loads followed by the
+// respective stores, so that several look-ups are in flight at a time. (For arbitrary tables of 256 entries, this is
+// faster than emulating the gather with 16 SIMD byte shuffles per vector.)
+// For 16-bit inputs with separate tables per channel, each row is processed in chunks, and each chunk channel by
+// channel, so that only one (up to 256 KiB) table is hot in the cache at a time.
+
+constexpr std::ptrdiff_t lut_channel_chunk_size = 1024;
+
+/** \brief Looks up `nr_elements` consecutive elements of `src` in `table`, and writes the results to `dst`.
+ *
+ * `src` and `dst` may point to the same memory location.
+ */
+template <typename In, typename Out>
+inline void apply_lut_row(const In* src, Out* dst, std::ptrdiff_t nr_elements, const Out* table)
+{
+  std::ptrdiff_t i = 0;
+
+  for (; i + 4 <= nr_elements; i += 4)
+  {
+    const auto v0 = table[src[i + 0]];
+    const auto v1 = table[src[i + 1]];
+    const auto v2 = table[src[i + 2]];
+    const auto v3 = table[src[i + 3]];
+    dst[i + 0] = v0;
+    dst[i + 1] = v1;
+    dst[i + 2] = v2;
+    dst[i + 3] = v3;
+  }
+
+  for (; i < nr_elements; ++i)
+  {
+    dst[i] = table[src[i]];
+  }
+}
+
+/** \brief Looks up each channel `c` of one N-channel row of `width` pixels in `tables[c]`, and writes the results to
+ * `dst`.
+ *
+ * `src` and `dst` may point to the same memory location.
+ */
+template <std::size_t N, typename In, typename Out>
+inline void apply_luts_row(const In* src, Out* dst, std::ptrdiff_t width, const std::array<const Out*, N>& tables)
+{
+  if constexpr (N == 1)
+  {
+    apply_lut_row(src, dst, width, tables[0]);
+  }
+  else if constexpr (sizeof(In) == 1)
+  {
+    for (std::ptrdiff_t x = 0; x < width; ++x)
+    {
+      for (std::size_t c = 0; c < N; ++c)
+      {
+        dst[N * x + c] = tables[c][src[N * x + c]];
+      }
+    }
+  }
+  else
+  {
+    for (std::ptrdiff_t x0 = 0; x0 < width; x0 += lut_channel_chunk_size)
+    {
+      const auto x1 = std::min(width, x0 + lut_channel_chunk_size);
+      for (std::size_t c = 0; c < N; ++c)
+      {
+        const auto table = tables[c];
+        for (auto x = x0; x < x1; ++x)
+        {
+          dst[N * x + c] = table[src[N * x + c]];
+        }
+      }
+    }
+  }
+}
+
+}  // namespace sln::impl
+
+#endif  // SELENE_IMG_IMPL_LUT_KERNELS_HPP
@@ -0,0 +1,332 @@
+// This file is part of the `Selene` library.
+// Copyright 2017-2019 Michael Hofmann (https://github.com/kmhofmann).
+// Distributed under MIT license. See accompanying LICENSE file in the top-level directory.
+
+#ifndef SELENE_IMG_IMPL_MEDIAN_FILTER_KERNELS_HPP
+#define SELENE_IMG_IMPL_MEDIAN_FILTER_KERNELS_HPP
+
+/// @file
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace sln::impl {
+
+// Kernels for median filtering of 8-bit elements.
+// The 3x3 and 5x5 kernels compute the median with min/max operations only, on 16 elements at a time in a SIMD register
+// (if available). For 3x3, each column of three rows is sorted first, and the median of 9 is the median of the maximum
+// of the minima, the median of the medians, and the minimum of the maxima. For 5x5, a selection network of 99
+// compare-exchange operations is applied (N. Devillard, "Fast median search: an ANSI C implementation").
+// For larger sizes, the histogram-based algorithm of Perreault and Hébert ("Median Filtering in Constant Time", 2007)
+// keeps a histogram for each (padded) column, which is updated by one row removal and one row addition per output row.
+// The kernel histogram is slid along the row by adding one and removing one column histogram per output pixel. All
+// histograms are kept in two tiers, i.e. 16 coarse and 256 fine bins; fine bins of the kernel histogram are only
+// brought up to date for the one coarse bin that contains the median.
+
+// Element-wise operations on either single 8-bit elements, or vectors of 16 8-bit elements.
+
+template <typename V>
+inline V median_load(const std::uint8_t* ptr);
+
+template <>
+inline std::uint8_t median_load<std::uint8_t>(const std::uint8_t* ptr)
+{
+  return *ptr;
+}
+
+inline void median_store(std::uint8_t* ptr, std::uint8_t v)
+{
+  *ptr = v;
+}
+
+inline std::uint8_t median_min(std::uint8_t a, std::uint8_t b)
+{
+  return std::min(a, b);
+}
+
+inline std::uint8_t median_max(std::uint8_t a, std::uint8_t b)
+{
+  return std::max(a, b);
+}
+
+#if defined(__SSE2__)
+template <>
+inline __m128i median_load<__m128i>(const std::uint8_t* ptr)
+{
+  return _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr));
+}
+
+inline void median_store(std::uint8_t* ptr, __m128i v)
+{
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(ptr), v);
+}
+
+inline __m128i median_min(__m128i a, __m128i b)
+{
+  return _mm_min_epu8(a, b);
+}
+
+inline __m128i median_max(__m128i a, __m128i b)
+{
+  return _mm_max_epu8(a, b);
+}
+#endif
+
+template <typename V>
+inline void median_sort2(V& a, V& b)
+{
+  const auto t = median_min(a, b);
+  b = median_max(a, b);
+  a = t;
+}
+
+template <typename V>
+inline V median_of_3(V a, V b, V c)
+{
+  return median_max(median_min(a, b), median_min(median_max(a, b), c));
+}
+
+// Calls `body(V{}, i)` for each of `n` element indices i, with V being a SIMD vector type for as many indices as
+// possible, and a scalar type for the remainder.
+template <typename Body>
+inline void median_for_each(std::ptrdiff_t n, Body body)
+{
+  std::ptrdiff_t i = 0;
+#if defined(__SSE2__)
+  for (; i + 16 <= n; i += 16)
+  {
+    body(__m128i{}, i);
+  }
+#endif
+  for (; i < n; ++i)
+  {
+    body(std::uint8_t{}, i);
+  }
+}
+
+/** \brief Computes the 3x3 median of one row of `width` N-channel pixels, given the 3 respective padded rows of
+ * (width + 2) pixels each.
+ *
+ * `buffer` needs to provide space for (3 * (width + 2) * N) elements.
+ */
+template <std::size_t N>
+inline void median_3x3_row(const std::uint8_t* const* rows, std::uint8_t* dst, std::ptrdiff_t width, std::uint8_t* buffer)
+{
+  constexpr auto n = static_cast<std::ptrdiff_t>(N);
+  const auto len = n * (width + 2);
+  const auto lo = buffer;
+  const auto mid = buffer + len;
+  const auto hi = buffer + 2 * len;
+
+  median_for_each(len, [&](auto tag, std::ptrdiff_t i) {
+    using V = decltype(tag);
+    auto a = median_load<V>(rows[0] + i);
+    auto b = median_load<V>(rows[1] + i);
+    auto c = median_load<V>(rows[2] + i);
+    median_sort2(a, b);
+    median_sort2(b, c);
+    median_sort2(a, b);
+    median_store(lo + i, a);
+    median_store(mid + i, b);
+    median_store(hi + i, c);
+  });
+
+  median_for_each(n * width, [&](auto tag, std::ptrdiff_t i) {
+    using V = decltype(tag);
+    const auto max_lo = median_max(median_max(median_load<V>(lo + i), median_load<V>(lo + i + n)),
+                                   median_load<V>(lo + i + 2 * n));
+    const auto med_mid
+        = median_of_3(median_load<V>(mid + i), median_load<V>(mid + i + n), median_load<V>(mid + i + 2 * n));
+    const auto min_hi = median_min(median_min(median_load<V>(hi + i), median_load<V>(hi + i + n)),
+                                   median_load<V>(hi + i + 2 * n));
+    median_store(dst + i, median_of_3(max_lo, med_mid, min_hi));
+  });
+}
+
+// Selection network for the median of 25 elements (element 12 after application).
+constexpr std::array<std::array<std::uint8_t, 2>, 99> median_25_network = {{
+    {0, 1},   {3, 4},   {2, 4},   {2, 3},   {6, 7},   {5, 7},   {5, 6},   {9, 10},  {8, 10},  {8, 9},
+    {12, 13}, {11, 13}, {11, 12}, {15, 16}, {14, 16}, {14, 15}, {18, 19}, {17, 19}, {17, 18}, {21, 22},
+    {20, 22}, {20, 21}, {23, 24}, {2, 5},   {3, 6},   {0, 6},   {0, 3},   {4, 7},   {1, 7},   {1, 4},
+    {11, 14}, {8, 14},  {8, 11},  {12, 15}, {9, 15},  {9, 12},  {13, 16}, {10, 16}, {10, 13}, {20, 23},
+    {17, 23}, {17, 20}, {21, 24}, {18, 24}, {18, 21}, {19, 22}, {8, 17},  {9, 18},  {0, 18},  {0, 9},
+    {10, 19}, {1, 19},  {1, 10},  {11, 20}, {2, 20},  {2, 11},  {12, 21}, {3, 21},  {3, 12},  {13, 22},
+    {4, 22},  {4, 13},  {14, 23}, {5, 23},  {5, 14},  {15, 24}, {6, 24},  {6, 15},  {7, 16},  {7, 19},
+    {13, 21}, {15, 23}, {7, 13},  {7, 15},  {1, 9},   {3, 11},  {5, 17},  {11, 17}, {9, 17},  {4, 10},
+    {6, 12},  {7, 14},  {4, 6},   {4, 7},   {12, 14}, {10, 14}, {6, 7},   {10, 12}, {6, 10},  {6, 17},
+    {12, 17}, {7, 17},  {7, 10},  {12, 18}, {7, 12},  {10, 18}, {12, 20}, {10, 20}, {10, 12},
+}};
+
+template <typename V, std::size_t... Is>
+inline void median_apply_25_network(std::array<V, 25>& p, std::index_sequence<Is...>)
+{
+  (median_sort2(p[median_25_network[Is][0]], p[median_25_network[Is][1]]), ...);
+}
+
+/** \brief Computes the 5x5 median of one row of `width` N-channel pixels, given the 5 respective padded rows of
+ * (width + 4) pixels each.
+ */
+template <std::size_t N>
+inline void median_5x5_row(const std::uint8_t* const* rows, std::uint8_t* dst, std::ptrdiff_t width)
+{
+  constexpr auto n = static_cast<std::ptrdiff_t>(N);
+
+  median_for_each(n * width, [&](auto tag, std::ptrdiff_t i) {
+    using V = decltype(tag);
+    std::array<V, 25> p;
+    for (std::size_t dy = 0; dy < 5; ++dy)
+    {
+      for (std::size_t dx = 0; dx < 5; ++dx)
+      {
+        p[5 * dy + dx] = median_load<V>(rows[dy] + i + n * static_cast<std::ptrdiff_t>(dx));
+      }
+    }
+
+    median_apply_25_network(p, std::make_index_sequence<median_25_network.size()>{});
+    median_store(dst + i, p[12]);
+  });
+}
+
+constexpr std::size_t median_nr_coarse_bins = 16;
+constexpr std::size_t median_nr_fine_bins = 256;
+
+/** \brief Adds (`add == true`) or removes (`add == false`) one padded row of `padded_width` N-channel pixels to/from the
+ * column histograms.
+ *
+ * The column histograms of channel `c` and column `x` start at index `(c * padded_width + x) * nr_bins`.
+ */
+template <bool add, std::size_t N>
+inline void median_update_column_histograms(const std::uint8_t* row,
+                                            std::ptrdiff_t padded_width,
+                                            std::uint16_t* col_coarse,
+                                            std::uint16_t* col_fine)
+{
+  for (std::size_t c = 0; c < N; ++c)
+  {
+    const auto channel_offset = c * static_cast<std::size_t>(padded_width);
+    for (std::ptrdiff_t x = 0; x < padded_width; ++x)
+    {
+      const auto v = row[N * static_cast<std::size_t>(x) + c];
+      const auto col = channel_offset + static_cast<std::size_t>(x);
+      auto& bin_coarse = col_coarse[col * median_nr_coarse_bins + (v >> 4)];
+      auto& bin_fine = col_fine[col * median_nr_fine_bins + v];
+      if constexpr (add)
+      {
+        ++bin_coarse;
+        ++bin_fine;
+      }
+      else
+      {
+        --bin_coarse;
+        --bin_fine;
+      }
+    }
+  }
+}
+
+/** \brief Computes the medians of one row of `width` pixels (of one channel, written with a pixel stride of N elements),
+ * given the (width + 2 * radius) column histograms of that channel.
+ */
+template <std::size_t N>
+inline void median_histogram_row(const std::uint16_t* col_coarse,
+                                 const std::uint16_t* col_fine,
+                                 std::uint8_t* dst,
+                                 std::ptrdiff_t width,
+                                 std::ptrdiff_t radius)
+{
+  constexpr auto nr_coarse = median_nr_coarse_bins;
+  constexpr auto nr_fine = median_nr_fine_bins;
+  constexpr auto segment_size = nr_fine / nr_coarse;
+
+  const auto k = 2 * radius + 1;
+  const auto rank = static_cast<std::uint32_t>(k * k / 2);  // 0-based index of the median
+
+  std::array<std::uint16_t, nr_coarse> coarse{};
+  std::array<std::uint16_t, nr_fine> fine{};
+  std::array<std::ptrdiff_t, nr_coarse> last_update;  // window start for which each fine segment is up to date
+  last_update.fill(-k);
+
+  const auto col_coarse_at = [=](std::ptrdiff_t x) { return col_coarse + static_cast<std::size_t>(x) * nr_coarse; };
+  const auto col_segment_at = [=](std::ptrdiff_t x, std::size_t b) {
+    return col_fine + static_cast<std::size_t>(x) * nr_fine + b * segment_size;
+  };
+
+  for (std::ptrdiff_t j = 0; j < k; ++j)
+  {
+    const auto col = col_coarse_at(j);
+    for (std::size_t b = 0; b < nr_coarse; ++b)
+    {
+      coarse[b] = static_cast<std::uint16_t>(coarse[b] + col[b]);
+    }
+  }
+
+  for (std::ptrdiff_t x = 0; x < width; ++x)
+  {
+    if (x > 0)
+    {
+      const auto col_add = col_coarse_at(x + k - 1);
+      const auto col_sub = col_coarse_at(x - 1);
+      for (std::size_t b = 0; b < nr_coarse; ++b)
+      {
+        coarse[b] = static_cast<std::uint16_t>(coarse[b] + col_add[b] - col_sub[b]);
+      }
+    }
+
+    std::uint32_t sum = 0;
+    std::size_t b = 0;
+    while (sum + coarse[b] <= rank)
+    {
+      sum += coarse[b];
+      ++b;
+    }
+
+    // Bring the fine segment of the coarse bin containing the median up to date; either incrementally, or from scratch
+    // if the window moved far since the last update.
+    const auto segment = fine.data() + b * segment_size;
+    if (2 * (x - last_update[b]) > k)
+    {
+      std::fill(segment, segment + segment_size, std::uint16_t{0});
+      for (auto j = x; j < x + k; ++j)
+      {
+        const auto col = col_segment_at(j, b);
+        for (std::size_t i = 0; i < segment_size; ++i)
+        {
+          segment[i] = static_cast<std::uint16_t>(segment[i] + col[i]);
+        }
+      }
+    }
+    else
+    {
+      for (auto j = last_update[b]; j < x; ++j)
+      {
+        const auto col_add = col_segment_at(j + k, b);
+        const auto col_sub = col_segment_at(j, b);
+        for (std::size_t i = 0; i < segment_size; ++i)
+        {
+          segment[i] = static_cast<std::uint16_t>(segment[i] + col_add[i] - col_sub[i]);
+        }
+      }
+    }
+    last_update[b] = x;
+
+    std::size_t v = b * segment_size;
+    while (sum + fine[v] <= rank)
+    {
+      sum += fine[v];
+      ++v;
+    }
+
+    dst[N * static_cast<std::size_t>(x)] = static_cast<std::uint8_t>(v);
+  }
+}
+
+}  // namespace sln::impl
+
+#endif  // SELENE_IMG_IMPL_MEDIAN_FILTER_KERNELS_HPP
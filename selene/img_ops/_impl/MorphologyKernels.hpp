@@ -0,0 +1,282 @@
+// This file is part of the `Selene` library.
+// Copyright 2017-2019 Michael Hofmann (https://github.com/kmhofmann).
+// Distributed under MIT license. See accompanying LICENSE file in the top-level directory.
+
+#ifndef SELENE_IMG_IMPL_MORPHOLOGY_KERNELS_HPP
+#define SELENE_IMG_IMPL_MORPHOLOGY_KERNELS_HPP
+
+/// @file
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace sln::impl {
+
+// Kernels for separable (1-D) morphological minimum/maximum filters.
+// Small filter sizes are computed directly, as the element-wise minimum/maximum of k shifted rows (16 elements at a time
+// in a SIMD register, for 8-bit elements, if available). Larger filter sizes use the van Herk/Gil-Werman algorithm,
+// which partitions the (padded) input into blocks of k elements and computes per-block prefix and suffix minima/maxima;
+// each output element is then the minimum/maximum of one suffix and one prefix value, i.e. the cost per element is
+// constant, independent of the filter size.
+// In x-direction, the input is a padded row of (width + k - 1) interleaved N-channel pixels. In y-direction, the input
+// is a list of (height + k - 1) padded row pointers, and the algorithm operates on whole rows at a time.
+
+enum class MorphologyOperation
+{
+  Erosion,
+  Dilation,
+};
+
+// Filter sizes up to (and including) these sizes are computed directly. In y-direction, the van Herk/Gil-Werman
+// algorithm operates on whole rows and is vectorized, whereas in x-direction, the prefix/suffix computations are
+// sequential within each block; direct computation therefore pays off for larger sizes in x-direction.
+constexpr std::ptrdiff_t morphology_max_direct_size_x = 15;
+constexpr std::ptrdiff_t morphology_max_direct_size_y = 5;
+
+template <MorphologyOperation op, typename T>
+inline T morphology_op(T a, T b)
+{
+  if constexpr (op == MorphologyOperation::Erosion)
+  {
+    return std::min(a, b);
+  }
+  else
+  {
+    return std::max(a, b);
+  }
+}
+
+#if defined(__SSE2__)
+template <MorphologyOperation op>
+inline __m128i morphology_op_u8(__m128i a, __m128i b)
+{
+  if constexpr (op == MorphologyOperation::Erosion)
+  {
+    return _mm_min_epu8(a, b);
+  }
+  else
+  {
+    return _mm_max_epu8(a, b);
+  }
+}
+#endif
+
+#if defined(__SSE2__)
+// Computes the element-wise minimum/maximum of 8-bit arrays; `fixed_nr_srcs` is either `nr_srcs`, or 0 if not known at
+// compile time.
+template <MorphologyOperation op, std::ptrdiff_t fixed_nr_srcs>
+inline void reduce_rows_u8_sse2(const std::uint8_t* const* srcs,
+                                std::ptrdiff_t nr_srcs,
+                                std::uint8_t* dst,
+                                std::ptrdiff_t n)
+{
+  const auto k = (fixed_nr_srcs > 0) ? fixed_nr_srcs : nr_srcs;
+
+  std::ptrdiff_t i = 0;
+  for (; i + 16 <= n; i += 16)
+  {
+    auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(srcs[0] + i));
+    for (std::ptrdiff_t j = 1; j < k; ++j)
+    {
+      v = morphology_op_u8<op>(v, _mm_loadu_si128(reinterpret_cast<const __m128i*>(srcs[j] + i)));
+    }
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), v);
+  }
+
+  for (; i < n; ++i)
+  {
+    auto v = srcs[0][i];
+    for (std::ptrdiff_t j = 1; j < k; ++j)
+    {
+      v = morphology_op<op>(v, srcs[j][i]);
+    }
+    dst[i] = v;
+  }
+}
+#endif
+
+/** \brief Computes the element-wise minimum/maximum of `nr_srcs` arrays `srcs[j]` of `n` elements each, and writes the
+ * result to `dst`.
+ *
+ * `dst` may not overlap with any of the source arrays, unless `nr_srcs == 1`.
+ */
+template <MorphologyOperation op, typename T>
+inline void reduce_rows(const T* const* srcs, std::ptrdiff_t nr_srcs, T* dst, std::ptrdiff_t n)
+{
+  if (nr_srcs == 1)
+  {
+    std::memmove(dst, srcs[0], static_cast<std::size_t>(n) * sizeof(T));
+    return;
+  }
+
+#if defined(__SSE2__)
+  if constexpr (std::is_same_v<T, std::uint8_t>)
+  {
+    // Specializations for the common small sizes keep all loads of a vector in registers.
+    switch (nr_srcs)
+    {
+      case 2: reduce_rows_u8_sse2<op, 2>(srcs, nr_srcs, dst, n); break;
+      case 3: reduce_rows_u8_sse2<op, 3>(srcs, nr_srcs, dst, n); break;
+      case 4: reduce_rows_u8_sse2<op, 4>(srcs, nr_srcs, dst, n); break;
+      case 5: reduce_rows_u8_sse2<op, 5>(srcs, nr_srcs, dst, n); break;
+      default: reduce_rows_u8_sse2<op, 0>(srcs, nr_srcs, dst, n); break;
+    }
+    return;
+  }
+#endif
+
+  // One pass per source array; each of these loops is vectorizable by the compiler.
+  const auto src0 = srcs[0];
+  const auto src1 = srcs[1];
+  for (std::ptrdiff_t i = 0; i < n; ++i)
+  {
+    dst[i] = morphology_op<op>(src0[i], src1[i]);
+  }
+
+  for (std::ptrdiff_t j = 2; j < nr_srcs; ++j)
+  {
+    const auto src = srcs[j];
+    for (std::ptrdiff_t i = 0; i < n; ++i)
+    {
+      dst[i] = morphology_op<op>(dst[i], src[i]);
+    }
+  }
+}
+
+/** \brief Computes the minimum/maximum filter of size `k` of one padded row of (width + k - 1) N-channel pixels, and
+ * writes `width` pixels to `dst`.
+ *
+ * `buffer` needs to provide space for (2 * (width + k - 1) * N) elements, and is only used for sizes larger than
+ * `morphology_max_direct_size_x`. `dst` may not overlap with `src`.
+ */
+template <MorphologyOperation op, std::size_t N, typename T>
+inline void morphology_row(const T* src, T* dst, std::ptrdiff_t width, std::ptrdiff_t k, T* buffer)
+{
+  constexpr auto n = static_cast<std::ptrdiff_t>(N);
+
+  if (k <= morphology_max_direct_size_x)
+  {
+    const T* srcs[morphology_max_direct_size_x] = {};
+    for (std::ptrdiff_t j = 0; j < k; ++j)
+    {
+      srcs[j] = src + n * j;
+    }
+
+    reduce_rows<op>(srcs, k, dst, n * width);
+    return;
+  }
+
+  const auto len = width + k - 1;
+  T* prefix = buffer;
+  T* suffix = buffer + n * len;
+
+  for (std::ptrdiff_t b = 0; b < len; b += k)
+  {
+    const auto e = std::min(b + k, len);
+
+    for (std::ptrdiff_t c = 0; c < n; ++c)
+    {
+      prefix[n * b + c] = src[n * b + c];
+    }
+
+    for (auto i = b + 1; i < e; ++i)
+    {
+      for (std::ptrdiff_t c = 0; c < n; ++c)
+      {
+        prefix[n * i + c] = morphology_op<op>(prefix[n * (i - 1) + c], src[n * i + c]);
+      }
+    }
+
+    for (std::ptrdiff_t c = 0; c < n; ++c)
+    {
+      suffix[n * (e - 1) + c] = src[n * (e - 1) + c];
+    }
+
+    for (auto i = e - 2; i >= b; --i)
+    {
+      for (std::ptrdiff_t c = 0; c < n; ++c)
+      {
+        suffix[n * i + c] = morphology_op<op>(suffix[n * (i + 1) + c], src[n * i + c]);
+      }
+    }
+  }
+
+  // The window [x, x + k) covers the suffix of one block and the prefix of the next one.
+  const auto prefix_offset = prefix + n * (k - 1);
+  for (std::ptrdiff_t i = 0; i < n * width; ++i)
+  {
+    dst[i] = morphology_op<op>(suffix[i], prefix_offset[i]);
+  }
+}
+
+/** \brief Computes the minimum/maximum filter of size `k` in y-direction, given (height + k - 1) padded rows of
+ * `row_len` elements each. Output row `y` is written to `dst_row(y)`.
+ *
+ * `buffer` needs to provide space for ((2 * k - 1) * row_len) elements, and is only used for sizes larger than
+ * `morphology_max_direct_size_y`. The output rows may not overlap with the input rows.
+ */
+template <MorphologyOperation op, typename T, typename DstRowFunc>
+inline void morphology_columns(const T* const* rows,
+                               std::ptrdiff_t height,
+                               std::ptrdiff_t k,
+                               std::ptrdiff_t row_len,
+                               T* buffer,
+                               DstRowFunc dst_row)
+{
+  if (k <= morphology_max_direct_size_y)
+  {
+    for (std::ptrdiff_t y = 0; y < height; ++y)
+    {
+      reduce_rows<op>(rows + y, k, dst_row(y), row_len);
+    }
+    return;
+  }
+
+  T* suffix = buffer;  // k rows
+  T* prefix = buffer + k * row_len;  // (k - 1) rows
+  const auto suffix_row = [=](std::ptrdiff_t j) { return suffix + j * row_len; };
+  const auto prefix_row = [=](std::ptrdiff_t j) { return prefix + j * row_len; };
+
+  for (std::ptrdiff_t b = 0; b < height; b += k)
+  {
+    const auto nr_out = std::min(k, height - b);
+
+    // Suffix rows of the block [b, b + k)
+    std::memcpy(suffix_row(k - 1), rows[b + k - 1], static_cast<std::size_t>(row_len) * sizeof(T));
+    for (auto j = k - 2; j >= 0; --j)
+    {
+      const T* srcs[2] = {rows[b + j], suffix_row(j + 1)};
+      reduce_rows<op>(srcs, 2, suffix_row(j), row_len);
+    }
+
+    // Prefix rows of the block [b + k, b + 2 * k), as far as needed
+    if (nr_out > 1)
+    {
+      std::memcpy(prefix_row(0), rows[b + k], static_cast<std::size_t>(row_len) * sizeof(T));
+    }
+
+    for (std::ptrdiff_t j = 1; j < nr_out - 1; ++j)
+    {
+      const T* srcs[2] = {prefix_row(j - 1), rows[b + k + j]};
+      reduce_rows<op>(srcs, 2, prefix_row(j), row_len);
+    }
+
+    std::memcpy(dst_row(b), suffix_row(0), static_cast<std::size_t>(row_len) * sizeof(T));
+    for (std::ptrdiff_t j = 1; j < nr_out; ++j)
+    {
+      const T* srcs[2] = {suffix_row(j), prefix_row(j - 1)};
+      reduce_rows<op>(srcs, 2, dst_row(b + j), row_len);
+    }
+  }
+}
+
+}  // namespace sln::impl
+
+#endif  // SELENE_IMG_IMPL_MORPHOLOGY_KERNELS_HPP
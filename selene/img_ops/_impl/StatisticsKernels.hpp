@@ -0,0 +1,316 @@
+// This file is part of the `Selene` library.
+// Copyright 2017-2019 Michael Hofmann (https://github.com/kmhofmann).
+// Distributed under MIT license. See accompanying LICENSE file in the top-level directory.
+
+#ifndef SELENE_IMG_IMPL_STATISTICS_KERNELS_HPP
+#define SELENE_IMG_IMPL_STATISTICS_KERNELS_HPP
+
+/// @file
+
+#include <selene/base/Promote.hpp>
+#include <selene/base/Types.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace sln::impl {
+
+// Row kernels for the image statistics functions. Each kernel processes one row of `width` interleaved N-channel
+// pixels and accumulates per-channel results.
+// For 8-bit unsigned elements with up to 4 channels, 16 pixels are processed at a time in N SIMD registers (if
+// available), where byte k of register j belongs to channel (16 * j + k) % N. Per-channel sums are computed by masking
+// out all other channels, followed by `_mm_sad_epu8` (sums) or `_mm_madd_epi16` (sums of squares).
+
+template <typename T>
+using statistics_accumulator_t = std::conditional_t<std::is_floating_point_v<T>, float64_t,
+                                                    promote_t<promote_t<promote_t<T>>>>;
+
+template <std::size_t N, typename T>
+constexpr bool statistics_vectorizable()
+{
+#if defined(__SSE2__)
+  return std::is_same_v<T, std::uint8_t> && N >= 1 && N <= 4;
+#else
+  return false;
+#endif
+}
+
+#if defined(__SSE2__)
+
+struct ChannelByteMasks
+{
+  std::uint8_t bytes[4][4][16];  // [register][channel][byte]
+};
+
+template <std::size_t N>
+constexpr ChannelByteMasks make_channel_byte_masks()
+{
+  ChannelByteMasks m{};
+  for (std::size_t j = 0; j < N; ++j)
+  {
+    for (std::size_t c = 0; c < N; ++c)
+    {
+      for (std::size_t k = 0; k < 16; ++k)
+      {
+        m.bytes[j][c][k] = ((16 * j + k) % N == c) ? 0xFF : 0x00;
+      }
+    }
+  }
+  return m;
+}
+
+inline std::uint64_t horizontal_sum_epi64(__m128i v)
+{
+  alignas(16) std::uint64_t lanes[2];
+  _mm_store_si128(reinterpret_cast<__m128i*>(lanes), v);
+  return lanes[0] + lanes[1];
+}
+
+// Returns the number of pixels processed; i.e. the row remainder has to be processed by the caller.
+template <std::size_t N, bool with_squares>
+inline std::ptrdiff_t sum_row_u8_sse2(const std::uint8_t* src,
+                                      std::ptrdiff_t width,
+                                      std::array<std::uint64_t, N>& sum,
+                                      std::array<std::uint64_t, N>& sum_sq)
+{
+  static constexpr auto masks = make_channel_byte_masks<N>();
+  // Each channel receives at most 16 squares (<= 255^2 each) per block, so the 32-bit lanes cannot overflow within
+  // 4096 blocks.
+  constexpr std::ptrdiff_t max_blocks_per_flush = 4096;
+
+  const auto zero = _mm_setzero_si128();
+  const auto mask = [](std::size_t j, std::size_t c) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(masks.bytes[j][c]));
+  };
+
+  __m128i acc_sum[N];
+  __m128i acc_sq[N];
+  for (std::size_t c = 0; c < N; ++c)
+  {
+    acc_sum[c] = zero;
+    acc_sq[c] = zero;
+  }
+
+  const auto nr_blocks = width / 16;
+
+  for (std::ptrdiff_t b0 = 0; b0 < nr_blocks; b0 += max_blocks_per_flush)
+  {
+    const auto b1 = std::min(nr_blocks, b0 + max_blocks_per_flush);
+    __m128i acc_sq_32[N];
+    for (std::size_t c = 0; c < N; ++c)
+    {
+      acc_sq_32[c] = zero;
+    }
+
+    for (auto b = b0; b < b1; ++b)
+    {
+      const auto ptr = src + b * 16 * static_cast<std::ptrdiff_t>(N);
+      for (std::size_t j = 0; j < N; ++j)
+      {
+        const auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr + 16 * j));
+        for (std::size_t c = 0; c < N; ++c)
+        {
+          const auto m = mask(j, c);
+          const auto v_c = _mm_and_si128(v, m);
+          acc_sum[c] = _mm_add_epi64(acc_sum[c], _mm_sad_epu8(v_c, zero));
+
+          if constexpr (with_squares)
+          {
+            const auto lo = _mm_unpacklo_epi8(v_c, zero);
+            const auto hi = _mm_unpackhi_epi8(v_c, zero);
+            acc_sq_32[c] = _mm_add_epi32(acc_sq_32[c], _mm_madd_epi16(lo, lo));
+            acc_sq_32[c] = _mm_add_epi32(acc_sq_32[c], _mm_madd_epi16(hi, hi));
+          }
+        }
+      }
+    }
+
+    if constexpr (with_squares)
+    {
+      for (std::size_t c = 0; c < N; ++c)
+      {
+        acc_sq[c] = _mm_add_epi64(acc_sq[c], _mm_unpacklo_epi32(acc_sq_32[c], zero));
+        acc_sq[c] = _mm_add_epi64(acc_sq[c], _mm_unpackhi_epi32(acc_sq_32[c], zero));
+      }
+    }
+  }
+
+  for (std::size_t c = 0; c < N; ++c)
+  {
+    sum[c] += horizontal_sum_epi64(acc_sum[c]);
+    if constexpr (with_squares)
+    {
+      sum_sq[c] += horizontal_sum_epi64(acc_sq[c]);
+    }
+  }
+
+  return nr_blocks * 16;
+}
+
+// Returns the number of pixels processed; i.e. the row remainder has to be processed by the caller.
+template <std::size_t N>
+inline std::ptrdiff_t min_max_row_u8_sse2(const std::uint8_t* src,
+                                          std::ptrdiff_t width,
+                                          std::array<std::uint8_t, N>& min,
+                                          std::array<std::uint8_t, N>& max)
+{
+  const auto nr_blocks = width / 16;
+  if (nr_blocks == 0)
+  {
+    return 0;
+  }
+
+  __m128i v_min[N];
+  __m128i v_max[N];
+  for (std::size_t j = 0; j < N; ++j)
+  {
+    v_min[j] = _mm_set1_epi8(static_cast<char>(0xFF));
+    v_max[j] = _mm_setzero_si128();
+  }
+
+  for (std::ptrdiff_t b = 0; b < nr_blocks; ++b)
+  {
+    const auto ptr = src + b * 16 * static_cast<std::ptrdiff_t>(N);
+    for (std::size_t j = 0; j < N; ++j)
+    {
+      const auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr + 16 * j));
+      v_min[j] = _mm_min_epu8(v_min[j], v);
+      v_max[j] = _mm_max_epu8(v_max[j], v);
+    }
+  }
+
+  alignas(16) std::uint8_t mins[N][16];
+  alignas(16) std::uint8_t maxs[N][16];
+  for (std::size_t j = 0; j < N; ++j)
+  {
+    _mm_store_si128(reinterpret_cast<__m128i*>(mins[j]), v_min[j]);
+    _mm_store_si128(reinterpret_cast<__m128i*>(maxs[j]), v_max[j]);
+  }
+
+  for (std::size_t j = 0; j < N; ++j)
+  {
+    for (std::size_t k = 0; k < 16; ++k)
+    {
+      const auto c = (16 * j + k) % N;
+      min[c] = std::min(min[c], mins[j][k]);
+      max[c] = std::max(max[c], maxs[j][k]);
+    }
+  }
+
+  return nr_blocks * 16;
+}
+
+#endif  // defined(__SSE2__)
+
+/** \brief Adds the per-channel sums of the elements of one N-channel row of `width` pixels to `sum`.
+ */
+template <std::size_t N, typename T, typename Acc>
+inline void sum_row(const T* src, std::ptrdiff_t width, std::array<Acc, N>& sum)
+{
+  std::ptrdiff_t x = 0;
+
+#if defined(__SSE2__)
+  if constexpr (statistics_vectorizable<N, T>() && std::is_same_v<Acc, std::uint64_t>)
+  {
+    x = sum_row_u8_sse2<N, false>(src, width, sum, sum);
+  }
+#endif
+
+  for (; x < width; ++x)
+  {
+    for (std::size_t c = 0; c < N; ++c)
+    {
+      sum[c] += static_cast<Acc>(src[N * x + c]);
+    }
+  }
+}
+
+/** \brief Adds the per-channel sums and sums of squares of the elements of one N-channel row of `width` pixels to
+ * `sum` and `sum_sq`.
+ *
+ * Only to be used for 8-bit element types, for which the results are exact.
+ */
+template <std::size_t N, typename T, typename Acc>
+inline void sum_squares_row(const T* src, std::ptrdiff_t width, std::array<Acc, N>& sum, std::array<Acc, N>& sum_sq)
+{
+  static_assert(sizeof(T) == 1 && std::is_integral_v<T>);
+
+  std::ptrdiff_t x = 0;
+
+#if defined(__SSE2__)
+  if constexpr (statistics_vectorizable<N, T>() && std::is_same_v<Acc, std::uint64_t>)
+  {
+    x = sum_row_u8_sse2<N, true>(src, width, sum, sum_sq);
+  }
+#endif
+
+  for (; x < width; ++x)
+  {
+    for (std::size_t c = 0; c < N; ++c)
+    {
+      const auto v = static_cast<Acc>(src[N * x + c]);
+      sum[c] += v;
+      sum_sq[c] += v * v;
+    }
+  }
+}
+
+/** \brief Updates the per-channel minimum and maximum values `min` and `max` with the elements of one N-channel row of
+ * `width` pixels.
+ */
+template <std::size_t N, typename T>
+inline void min_max_row(const T* src, std::ptrdiff_t width, std::array<T, N>& min, std::array<T, N>& max)
+{
+  std::ptrdiff_t x = 0;
+
+#if defined(__SSE2__)
+  if constexpr (statistics_vectorizable<N, T>())
+  {
+    x = min_max_row_u8_sse2<N>(src, width, min, max);
+  }
+#endif
+
+  for (; x < width; ++x)
+  {
+    for (std::size_t c = 0; c < N; ++c)
+    {
+      const auto v = src[N * x + c];
+      if (v < min[c])
+      {
+        min[c] = v;
+      }
+      if (max[c] < v)
+      {
+        max[c] = v;
+      }
+    }
+  }
+}
+
+/** \brief Returns the index of the first pixel in one N-channel row of `width` pixels whose channel `channel` equals
+ * `value`, or `width`, if there is no such pixel.
+ */
+template <std::size_t N, typename T>
+inline std::ptrdiff_t find_first_in_row(const T* src, std::ptrdiff_t width, std::size_t channel, T value)
+{
+  for (std::ptrdiff_t x = 0; x < width; ++x)
+  {
+    if (src[N * x + channel] == value)
+    {
+      return x;
+    }
+  }
+
+  return width;
+}
+
+}  // namespace sln::impl
+
+#endif  // SELENE_IMG_IMPL_STATISTICS_KERNELS_HPP
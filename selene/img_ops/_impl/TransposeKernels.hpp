@@ -0,0 +1,316 @@
+// This file is part of the `Selene` library.
+// Copyright 2017-2019 Michael Hofmann (https://github.com/kmhofmann).
+// Distributed under MIT license. See accompanying LICENSE file in the top-level directory.
+
+#ifndef SELENE_IMG_IMPL_TRANSPOSE_KERNELS_HPP
+#define SELENE_IMG_IMPL_TRANSPOSE_KERNELS_HPP
+
+/// @file
+
+#include <selene/img/typed/ImageBase.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace sln::impl {
+
+// Transposition is performed in tiles that fit (together with their transposed counterpart) into a typical L1 data
+// cache of 32 KiB. Each tile is processed in blocks of 8x8 pixels; for pixels of 1, 2 or 4 bytes, these blocks are
+// transposed in SSE2 registers (if available), and pixels of 3 bytes are moved via overlapping 4-byte copies.
+//
+// All kernels read a block as rows `src + i * src_stride` (i = 0, ..., 7), each containing 8 consecutive pixels, and
+// write row `i` of the block to column `i` of the destination, i.e. to `dst + j * dst_stride` (j = 0, ..., 7).
+// Negative strides are used to realize the additional flips.
+
+constexpr std::ptrdiff_t transpose_block_size = 8;
+
+template <std::size_t nr_bytes_per_pixel>
+constexpr std::ptrdiff_t transpose_tile_size()
+{
+  constexpr std::size_t l1_budget = 16 * 1024;  // half of the L1 data cache, for each of source and destination
+  std::size_t size = transpose_block_size;
+  while ((size + transpose_block_size) * (size + transpose_block_size) * nr_bytes_per_pixel <= l1_budget)
+  {
+    size += transpose_block_size;
+  }
+  return static_cast<std::ptrdiff_t>(size);
+}
+
+template <typename PixelType>
+inline void transpose_block_generic(const std::uint8_t* src,
+                                    std::ptrdiff_t src_stride,
+                                    std::uint8_t* dst,
+                                    std::ptrdiff_t dst_stride,
+                                    std::ptrdiff_t nr_rows,
+                                    std::ptrdiff_t nr_cols)
+{
+  for (std::ptrdiff_t j = 0; j < nr_cols; ++j)
+  {
+    auto dst_row = reinterpret_cast<PixelType*>(dst + j * dst_stride);
+    for (std::ptrdiff_t i = 0; i < nr_rows; ++i)
+    {
+      dst_row[i] = reinterpret_cast<const PixelType*>(src + i * src_stride)[j];
+    }
+  }
+}
+
+// Pixels of 3 bytes are gathered via overlapping 4-byte loads and stores into a small buffer, which is copied to the
+// destination row as a whole. The last column of the block is read with 3-byte loads, to stay within the block.
+inline void transpose_block_8x8_3(const std::uint8_t* src,
+                                  std::ptrdiff_t src_stride,
+                                  std::uint8_t* dst,
+                                  std::ptrdiff_t dst_stride)
+{
+  std::uint8_t buffer[8 * 3 + 1];
+
+  for (std::ptrdiff_t j = 0; j < 7; ++j)
+  {
+    for (std::ptrdiff_t i = 0; i < 8; ++i)
+    {
+      std::memcpy(buffer + 3 * i, src + i * src_stride + 3 * j, 4);
+    }
+    std::memcpy(dst + j * dst_stride, buffer, 8 * 3);
+  }
+
+  for (std::ptrdiff_t i = 0; i < 8; ++i)
+  {
+    std::memcpy(buffer + 3 * i, src + i * src_stride + 3 * 7, 3);
+  }
+  std::memcpy(dst + 7 * dst_stride, buffer, 8 * 3);
+}
+
+#if defined(__SSE2__)
+
+inline void transpose_block_8x8_1(const std::uint8_t* src,
+                                  std::ptrdiff_t src_stride,
+                                  std::uint8_t* dst,
+                                  std::ptrdiff_t dst_stride)
+{
+  const auto load = [src, src_stride](std::ptrdiff_t i) {
+    return _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + i * src_stride));
+  };
+
+  const auto t0 = _mm_unpacklo_epi8(load(0), load(1));
+  const auto t1 = _mm_unpacklo_epi8(load(2), load(3));
+  const auto t2 = _mm_unpacklo_epi8(load(4), load(5));
+  const auto t3 = _mm_unpacklo_epi8(load(6), load(7));
+
+  const auto u0 = _mm_unpacklo_epi16(t0, t1);
+  const auto u1 = _mm_unpackhi_epi16(t0, t1);
+  const auto u2 = _mm_unpacklo_epi16(t2, t3);
+  const auto u3 = _mm_unpackhi_epi16(t2, t3);
+
+  const auto v0 = _mm_unpacklo_epi32(u0, u2);  // columns 0, 1
+  const auto v1 = _mm_unpackhi_epi32(u0, u2);  // columns 2, 3
+  const auto v2 = _mm_unpacklo_epi32(u1, u3);  // columns 4, 5
+  const auto v3 = _mm_unpackhi_epi32(u1, u3);  // columns 6, 7
+
+  const auto store = [dst, dst_stride](std::ptrdiff_t j, __m128i v) {
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + j * dst_stride), v);
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + (j + 1) * dst_stride), _mm_unpackhi_epi64(v, v));
+  };
+
+  store(0, v0);
+  store(2, v1);
+  store(4, v2);
+  store(6, v3);
+}
+
+inline void transpose_block_8x8_2(const std::uint8_t* src,
+                                  std::ptrdiff_t src_stride,
+                                  std::uint8_t* dst,
+                                  std::ptrdiff_t dst_stride)
+{
+  const auto load = [src, src_stride](std::ptrdiff_t i) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * src_stride));
+  };
+
+  const auto r0 = load(0), r1 = load(1), r2 = load(2), r3 = load(3);
+  const auto r4 = load(4), r5 = load(5), r6 = load(6), r7 = load(7);
+
+  const auto t0 = _mm_unpacklo_epi16(r0, r1);
+  const auto t1 = _mm_unpackhi_epi16(r0, r1);
+  const auto t2 = _mm_unpacklo_epi16(r2, r3);
+  const auto t3 = _mm_unpackhi_epi16(r2, r3);
+  const auto t4 = _mm_unpacklo_epi16(r4, r5);
+  const auto t5 = _mm_unpackhi_epi16(r4, r5);
+  const auto t6 = _mm_unpacklo_epi16(r6, r7);
+  const auto t7 = _mm_unpackhi_epi16(r6, r7);
+
+  const auto u0 = _mm_unpacklo_epi32(t0, t2);
+  const auto u1 = _mm_unpackhi_epi32(t0, t2);
+  const auto u2 = _mm_unpacklo_epi32(t1, t3);
+  const auto u3 = _mm_unpackhi_epi32(t1, t3);
+  const auto u4 = _mm_unpacklo_epi32(t4, t6);
+  const auto u5 = _mm_unpackhi_epi32(t4, t6);
+  const auto u6 = _mm_unpacklo_epi32(t5, t7);
+  const auto u7 = _mm_unpackhi_epi32(t5, t7);
+
+  const auto store = [dst, dst_stride](std::ptrdiff_t j, __m128i v) {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + j * dst_stride), v);
+  };
+
+  store(0, _mm_unpacklo_epi64(u0, u4));
+  store(1, _mm_unpackhi_epi64(u0, u4));
+  store(2, _mm_unpacklo_epi64(u1, u5));
+  store(3, _mm_unpackhi_epi64(u1, u5));
+  store(4, _mm_unpacklo_epi64(u2, u6));
+  store(5, _mm_unpackhi_epi64(u2, u6));
+  store(6, _mm_unpacklo_epi64(u3, u7));
+  store(7, _mm_unpackhi_epi64(u3, u7));
+}
+
+inline void transpose_block_4x4_4(const std::uint8_t* src,
+                                  std::ptrdiff_t src_stride,
+                                  std::uint8_t* dst,
+                                  std::ptrdiff_t dst_stride)
+{
+  const auto load = [src, src_stride](std::ptrdiff_t i) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * src_stride));
+  };
+
+  const auto r0 = load(0), r1 = load(1), r2 = load(2), r3 = load(3);
+
+  const auto t0 = _mm_unpacklo_epi32(r0, r1);
+  const auto t1 = _mm_unpacklo_epi32(r2, r3);
+  const auto t2 = _mm_unpackhi_epi32(r0, r1);
+  const auto t3 = _mm_unpackhi_epi32(r2, r3);
+
+  const auto store = [dst, dst_stride](std::ptrdiff_t j, __m128i v) {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + j * dst_stride), v);
+  };
+
+  store(0, _mm_unpacklo_epi64(t0, t1));
+  store(1, _mm_unpackhi_epi64(t0, t1));
+  store(2, _mm_unpacklo_epi64(t2, t3));
+  store(3, _mm_unpackhi_epi64(t2, t3));
+}
+
+inline void transpose_block_8x8_4(const std::uint8_t* src,
+                                  std::ptrdiff_t src_stride,
+                                  std::uint8_t* dst,
+                                  std::ptrdiff_t dst_stride)
+{
+  transpose_block_4x4_4(src, src_stride, dst, dst_stride);
+  transpose_block_4x4_4(src + 16, src_stride, dst + 4 * dst_stride, dst_stride);
+  transpose_block_4x4_4(src + 4 * src_stride, src_stride, dst + 16, dst_stride);
+  transpose_block_4x4_4(src + 4 * src_stride + 16, src_stride, dst + 4 * dst_stride + 16, dst_stride);
+}
+
+#endif  // defined(__SSE2__)
+
+template <typename PixelType>
+inline void transpose_block_8x8(const std::uint8_t* src,
+                                std::ptrdiff_t src_stride,
+                                std::uint8_t* dst,
+                                std::ptrdiff_t dst_stride)
+{
+#if defined(__SSE2__)
+  if constexpr (std::is_trivially_copyable_v<PixelType> && sizeof(PixelType) == 1)
+  {
+    transpose_block_8x8_1(src, src_stride, dst, dst_stride);
+  }
+  else if constexpr (std::is_trivially_copyable_v<PixelType> && sizeof(PixelType) == 2)
+  {
+    transpose_block_8x8_2(src, src_stride, dst, dst_stride);
+  }
+  else if constexpr (std::is_trivially_copyable_v<PixelType> && sizeof(PixelType) == 4)
+  {
+    transpose_block_8x8_4(src, src_stride, dst, dst_stride);
+  }
+  else
+#endif
+  if constexpr (std::is_trivially_copyable_v<PixelType> && sizeof(PixelType) == 3)
+  {
+    transpose_block_8x8_3(src, src_stride, dst, dst_stride);
+  }
+  else
+  {
+    transpose_block_generic<PixelType>(src, src_stride, dst, dst_stride, transpose_block_size, transpose_block_size);
+  }
+}
+
+/** \brief Cache-blocked transposition of `img_src` into `img_dst`, with optional additional flips.
+ *
+ * Performs `img_dst(dst_x, dst_y) = img_src(src_x, src_y)`, where `src_x = flip_v ? (width - 1 - dst_y) : dst_y` and
+ * `src_y = flip_h ? (height - 1 - dst_x) : dst_x`. The destination image needs to be allocated already.
+ */
+template <bool flip_h, bool flip_v, typename DerivedSrc, typename DerivedDst>
+void transpose_tiled(const ImageBase<DerivedSrc>& img_src, ImageBase<DerivedDst>& img_dst)
+{
+  using PixelType = typename DerivedSrc::PixelType;
+  constexpr auto px_size = static_cast<std::ptrdiff_t>(sizeof(PixelType));
+  constexpr auto tile_size = transpose_tile_size<sizeof(PixelType)>();
+  constexpr auto block_size = transpose_block_size;
+
+  const auto src_width = static_cast<std::ptrdiff_t>(img_src.width());
+  const auto src_height = static_cast<std::ptrdiff_t>(img_src.height());
+  const auto src_stride = static_cast<std::ptrdiff_t>(img_src.stride_bytes());
+  const auto dst_stride = static_cast<std::ptrdiff_t>(img_dst.stride_bytes());
+  const std::uint8_t* const src_base = img_src.byte_ptr();
+  std::uint8_t* const dst_base = img_dst.byte_ptr();
+
+  // Processes the source region [x0, x0 + nr_cols) x [y0, y0 + nr_rows).
+  const auto transpose_region = [&](std::ptrdiff_t x0, std::ptrdiff_t y0, std::ptrdiff_t nr_cols,
+                                    std::ptrdiff_t nr_rows, auto full_block) {
+    // With flip_h, source rows are read bottom-up, so that the destination columns are written left to right.
+    const auto src_row = flip_h ? (y0 + nr_rows - 1) : y0;
+    const auto src = src_base + src_row * src_stride + x0 * px_size;
+    const auto src_step = flip_h ? -src_stride : src_stride;
+
+    // With flip_v, destination rows are written bottom-up.
+    const auto dst_x = flip_h ? (src_height - y0 - nr_rows) : y0;
+    const auto dst_y = flip_v ? (src_width - 1 - x0) : x0;
+    const auto dst = dst_base + dst_y * dst_stride + dst_x * px_size;
+    const auto dst_step = flip_v ? -dst_stride : dst_stride;
+
+    if constexpr (decltype(full_block)::value)
+    {
+      transpose_block_8x8<PixelType>(src, src_step, dst, dst_step);
+    }
+    else
+    {
+      transpose_block_generic<PixelType>(src, src_step, dst, dst_step, nr_rows, nr_cols);
+    }
+  };
+
+  for (std::ptrdiff_t tile_y = 0; tile_y < src_height; tile_y += tile_size)
+  {
+    const auto tile_y_end = std::min(tile_y + tile_size, src_height);
+
+    for (std::ptrdiff_t tile_x = 0; tile_x < src_width; tile_x += tile_size)
+    {
+      const auto tile_x_end = std::min(tile_x + tile_size, src_width);
+
+      for (auto y = tile_y; y < tile_y_end; y += block_size)
+      {
+        const auto nr_rows = std::min(block_size, tile_y_end - y);
+
+        for (auto x = tile_x; x < tile_x_end; x += block_size)
+        {
+          const auto nr_cols = std::min(block_size, tile_x_end - x);
+
+          if (nr_rows == block_size && nr_cols == block_size)
+          {
+            transpose_region(x, y, nr_cols, nr_rows, std::true_type{});
+          }
+          else
+          {
+            transpose_region(x, y, nr_cols, nr_rows, std::false_type{});
+          }
+        }
+      }
+    }
+  }
+}
+
+}  // namespace sln::impl
+
+#endif  // SELENE_IMG_IMPL_TRANSPOSE_KERNELS_HPP
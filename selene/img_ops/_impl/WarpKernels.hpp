@@ -0,0 +1,327 @@
+// This file is part of the `Selene` library.
+// Copyright 2017-2019 Michael Hofmann (https://github.com/kmhofmann).
+// Distributed under MIT license. See accompanying LICENSE file in the top-level directory.
+
+#ifndef SELENE_IMG_IMPL_WARP_KERNELS_HPP
+#define SELENE_IMG_IMPL_WARP_KERNELS_HPP
+
+/// @file
+
+#include <selene/base/Round.hpp>
+#include <selene/base/Types.hpp>
+
+#include <selene/img/common/Types.hpp>
+#include <selene/img/pixel/PixelTraits.hpp>
+
+#include <selene/img/typed/ImageBase.hpp>
+#include <selene/img/typed/access/BorderAccessors.hpp>
+#include <selene/img/typed/access/Interpolators.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace sln::impl {
+
+// Kernels for sampling a source image at a row of precomputed source coordinates.
+// Source coordinates are represented in 32.32 fixed-point format, i.e. as 64-bit integers scaled by 2^32. Bilinear
+// interpolation of integral elements of up to 16 bits uses integer weights with `warp_weight_bits<Element>` bits of
+// precision; other element types are interpolated in floating point.
+
+constexpr int warp_fraction_bits = 32;
+constexpr std::int64_t warp_one = std::int64_t{1} << warp_fraction_bits;
+
+template <typename Element>
+constexpr int warp_weight_bits = (sizeof(Element) == 1) ? 11 : 16;
+
+// The weighted sums are bounded by the element range times 2^(2 * warp_weight_bits<Element>), and fit this type.
+template <typename Element>
+using WarpAccumulator = std::conditional_t<
+    sizeof(Element) == 1,
+    std::conditional_t<std::is_signed_v<Element>, std::int32_t, std::uint32_t>,
+    std::conditional_t<std::is_signed_v<Element>, std::int64_t, std::uint64_t>>;
+
+// Source coordinates are clamped to this magnitude (in pixels), which keeps all fixed-point values, and sums of up to
+// two of them, within range.
+constexpr double warp_max_coordinate = double(std::int64_t{1} << 29);
+
+/** \brief Converts the given source coordinate, which has to be of magnitude at most `warp_max_coordinate`, to fixed-point
+ * format (without clamping).
+ */
+inline std::int64_t warp_to_fixed_unclamped(double value) noexcept
+{
+  const auto scaled = value * double(warp_one);
+  return static_cast<std::int64_t>(scaled + std::copysign(0.5, scaled));
+}
+
+/** \brief Converts the given source coordinate to fixed-point format, clamping it to +/- `warp_max_coordinate`.
+ *
+ * Non-finite values are clamped as well; NaN maps to the lower bound.
+ */
+inline std::int64_t warp_to_fixed(double value) noexcept
+{
+  // The argument order matters: std::max/std::min return their first argument if the comparison involves NaN.
+  value = std::max(-warp_max_coordinate, value);
+  value = std::min(warp_max_coordinate, value);
+  return warp_to_fixed_unclamped(value);
+}
+
+inline PixelIndex warp_floor(std::int64_t value) noexcept
+{
+  return PixelIndex{static_cast<PixelIndex::value_type>(value >> warp_fraction_bits)};
+}
+
+/** \brief Returns the range [lower, upper) of fixed-point source coordinates for which `warp_sample` only accesses
+ * pixels within [0, length).
+ */
+template <ImageInterpolationMode interpolation_mode>
+inline std::pair<std::int64_t, std::int64_t> warp_interior_range(PixelLength length) noexcept
+{
+  const auto len = static_cast<std::int64_t>(length);
+  if constexpr (interpolation_mode == ImageInterpolationMode::NearestNeighbor)
+  {
+    return {1 - warp_one / 2, len * warp_one - warp_one / 2 + 1};
+  }
+  else
+  {
+    return {0, (len - 1) * warp_one};
+  }
+}
+
+/** \brief Returns the span [begin, end) of the first contiguous run of target pixels whose source coordinates are
+ * within the interior of the source image.
+ *
+ * Affine and (pole-free) perspective transformations map a target row to a monotonic sequence of source coordinates,
+ * so that this run contains all interior pixels of the row. Pixels outside of the span are always safe to be sampled
+ * with bounds-checking border access.
+ */
+template <ImageInterpolationMode interpolation_mode>
+inline std::pair<std::ptrdiff_t, std::ptrdiff_t> warp_interior_span(const std::int64_t* xs,
+                                                                    const std::int64_t* ys,
+                                                                    std::ptrdiff_t width,
+                                                                    PixelLength src_width,
+                                                                    PixelLength src_height) noexcept
+{
+  const auto [x_lower, x_upper] = warp_interior_range<interpolation_mode>(src_width);
+  const auto [y_lower, y_upper] = warp_interior_range<interpolation_mode>(src_height);
+  const auto is_interior = [&](std::ptrdiff_t x) {
+    return xs[x] >= x_lower && xs[x] < x_upper && ys[x] >= y_lower && ys[x] < y_upper;
+  };
+
+  std::ptrdiff_t begin = 0;
+  while (begin < width && !is_interior(begin))
+  {
+    ++begin;
+  }
+
+  auto end = begin;
+  while (end < width && is_interior(end))
+  {
+    ++end;
+  }
+
+  return {begin, end};
+}
+
+inline std::int64_t warp_floor_div(std::int64_t a, std::int64_t b) noexcept
+{
+  const auto q = a / b;
+  return (a % b != 0 && a < 0) ? q - 1 : q;
+}
+
+inline std::int64_t warp_ceil_div(std::int64_t a, std::int64_t b) noexcept
+{
+  const auto q = a / b;
+  return (a % b != 0 && a > 0) ? q + 1 : q;
+}
+
+/** \brief Returns the range [begin, end) of all x in [0, width) that satisfy lower <= start + x * step < upper.
+ *
+ * All values start + x * step, as well as `lower` and `upper`, need to be of magnitude less than 2^62.
+ */
+inline std::pair<std::int64_t, std::int64_t> warp_linear_range(std::int64_t start,
+                                                               std::int64_t step,
+                                                               std::int64_t width,
+                                                               std::int64_t lower,
+                                                               std::int64_t upper) noexcept
+{
+  if (step == 0)
+  {
+    return (start >= lower && start < upper) ? std::make_pair(std::int64_t{0}, width)
+                                             : std::make_pair(std::int64_t{0}, std::int64_t{0});
+  }
+
+  const auto first = (step > 0) ? warp_ceil_div(lower - start, step) : warp_ceil_div(start - upper + 1, -step);
+  const auto last = (step > 0) ? warp_floor_div(upper - 1 - start, step) : warp_floor_div(start - lower, -step);
+  return {std::max(first, std::int64_t{0}), std::min(last + 1, width)};
+}
+
+/** \brief Returns the span [begin, end) of all target pixels whose source coordinates are within the interior of the
+ * source image, for source coordinates that are exactly linear in x; i.e. xs[x] = xs[0] + x * (xs[1] - xs[0]), and
+ * likewise for ys.
+ *
+ * The span is computed in constant time, by solving the (linear) bounds constraints for x.
+ */
+template <ImageInterpolationMode interpolation_mode>
+inline std::pair<std::ptrdiff_t, std::ptrdiff_t> warp_linear_interior_span(const std::int64_t* xs,
+                                                                           const std::int64_t* ys,
+                                                                           std::ptrdiff_t width,
+                                                                           PixelLength src_width,
+                                                                           PixelLength src_height) noexcept
+{
+  // Clamping the bounds does not change the result, since all coordinates are of magnitude <= 2^61.
+  constexpr auto bound = std::int64_t{1} << 62;
+  const auto clamp_bound = [=](std::int64_t value) { return std::clamp(value, -bound, bound); };
+  const auto [x_lower, x_upper] = warp_interior_range<interpolation_mode>(src_width);
+  const auto [y_lower, y_upper] = warp_interior_range<interpolation_mode>(src_height);
+
+  const auto step_x = (width > 1) ? xs[1] - xs[0] : std::int64_t{0};
+  const auto step_y = (width > 1) ? ys[1] - ys[0] : std::int64_t{0};
+  const auto range_x = warp_linear_range(xs[0], step_x, width, clamp_bound(x_lower), clamp_bound(x_upper));
+  const auto range_y = warp_linear_range(ys[0], step_y, width, clamp_bound(y_lower), clamp_bound(y_upper));
+
+  const auto begin = static_cast<std::ptrdiff_t>(std::max(range_x.first, range_y.first));
+  const auto end = static_cast<std::ptrdiff_t>(std::min(range_x.second, range_y.second));
+  return {begin, std::max(begin, end)};
+}
+
+/** \brief Bilinearly interpolates the four neighboring pixels a = (x0, y0), b = (x0 + 1, y0), c = (x0, y0 + 1) and
+ * d = (x0 + 1, y0 + 1), given the fixed-point location (x, y).
+ */
+template <typename PixelType>
+inline PixelType warp_bilinear(const PixelType& a,
+                               const PixelType& b,
+                               const PixelType& c,
+                               const PixelType& d,
+                               std::int64_t x,
+                               std::int64_t y) noexcept
+{
+  using Element = typename PixelTraits<PixelType>::Element;
+  constexpr auto nr_channels = PixelTraits<PixelType>::nr_channels;
+
+  PixelType result;
+  if constexpr (std::is_integral_v<Element> && sizeof(Element) <= 2)
+  {
+    using Acc = WarpAccumulator<Element>;
+    constexpr auto bits = warp_weight_bits<Element>;
+    constexpr auto one = Acc{1} << bits;
+    constexpr auto shift = warp_fraction_bits - bits;
+    constexpr auto mask = (std::int64_t{1} << bits) - 1;
+    const auto wx = static_cast<Acc>((x >> shift) & mask);
+    const auto wy = static_cast<Acc>((y >> shift) & mask);
+
+    for (std::size_t i = 0; i < nr_channels; ++i)
+    {
+      const auto top = static_cast<Acc>(a[i]) * (one - wx) + static_cast<Acc>(b[i]) * wx;
+      const auto bottom = static_cast<Acc>(c[i]) * (one - wx) + static_cast<Acc>(d[i]) * wx;
+      result[i] = static_cast<Element>((top * (one - wy) + bottom * wy + one * one / 2) >> (2 * bits));
+    }
+  }
+  else
+  {
+    constexpr auto scale = default_float_t{1} / static_cast<default_float_t>(warp_one);
+    const auto rx = static_cast<default_float_t>(x & (warp_one - 1)) * scale;
+    const auto ry = static_cast<default_float_t>(y & (warp_one - 1)) * scale;
+
+    for (std::size_t i = 0; i < nr_channels; ++i)
+    {
+      const auto va = static_cast<default_float_t>(a[i]);
+      const auto vb = static_cast<default_float_t>(b[i]);
+      const auto vc = static_cast<default_float_t>(c[i]);
+      const auto vd = static_cast<default_float_t>(d[i]);
+      const auto value = va + (vb - va) * rx + (vc - va) * ry + (va - vb - vc + vd) * rx * ry;
+      if constexpr (std::is_integral_v<Element>)
+      {
+        result[i] = round_half_up<Element>(value);
+      }
+      else
+      {
+        result[i] = static_cast<Element>(value);
+      }
+    }
+  }
+
+  return result;
+}
+
+/** \brief Samples the source image at the fixed-point location (x, y), using the specified interpolation and border
+ * access modes. The result is of the source pixel type.
+ */
+template <ImageInterpolationMode interpolation_mode, BorderAccessMode access_mode, typename DerivedSrc>
+inline auto warp_sample(const ImageBase<DerivedSrc>& img, std::int64_t x, std::int64_t y) noexcept
+{
+  using PixelType = typename DerivedSrc::PixelType;
+
+  if constexpr (interpolation_mode == ImageInterpolationMode::NearestNeighbor)
+  {
+    // Rounds half down, as ImageInterpolator<ImageInterpolationMode::NearestNeighbor>
+    const auto ix = warp_floor(x + warp_one / 2 - 1);
+    const auto iy = warp_floor(y + warp_one / 2 - 1);
+    return PixelType{ImageBorderAccessor<access_mode>::access(img, ix, iy)};
+  }
+  else if constexpr (access_mode == BorderAccessMode::Unchecked)
+  {
+    const auto ix = static_cast<std::ptrdiff_t>(x >> warp_fraction_bits);
+    const auto iy = warp_floor(y);
+    const auto row_0 = img.data(iy);
+    const auto row_1 = img.data(iy + 1);
+    return warp_bilinear(row_0[ix], row_0[ix + 1], row_1[ix], row_1[ix + 1], x, y);
+  }
+  else
+  {
+    const auto ix = warp_floor(x);
+    const auto iy = warp_floor(y);
+    return warp_bilinear<PixelType>(ImageBorderAccessor<access_mode>::access(img, ix, iy),
+                                    ImageBorderAccessor<access_mode>::access(img, ix + 1, iy),
+                                    ImageBorderAccessor<access_mode>::access(img, ix, iy + 1),
+                                    ImageBorderAccessor<access_mode>::access(img, ix + 1, iy + 1), x, y);
+  }
+}
+
+/** \brief Samples the source image at `width` fixed-point locations (xs[x], ys[x]) and writes the results to `dst`.
+ *
+ * Only pixels at the borders of the row are sampled using bounds-checking border access; the interior span of the row is
+ * sampled using unchecked access. If `is_linear` is true, the source coordinates have to be exactly linear in x (see
+ * `warp_linear_interior_span`).
+ */
+template <ImageInterpolationMode interpolation_mode, BorderAccessMode access_mode, typename DerivedSrc,
+          typename PixelType>
+inline void warp_row(const ImageBase<DerivedSrc>& img_src,
+                     const std::int64_t* xs,
+                     const std::int64_t* ys,
+                     bool is_linear,
+                     PixelType* dst,
+                     std::ptrdiff_t width)
+{
+  std::ptrdiff_t x_begin = 0;
+  std::ptrdiff_t x_end = width;
+  if constexpr (access_mode != BorderAccessMode::Unchecked)
+  {
+    std::tie(x_begin, x_end) =
+        is_linear ? warp_linear_interior_span<interpolation_mode>(xs, ys, width, img_src.width(), img_src.height())
+                  : warp_interior_span<interpolation_mode>(xs, ys, width, img_src.width(), img_src.height());
+  }
+
+  for (std::ptrdiff_t x = 0; x < x_begin; ++x)
+  {
+    dst[x] = warp_sample<interpolation_mode, access_mode>(img_src, xs[x], ys[x]);
+  }
+
+  for (auto x = x_begin; x < x_end; ++x)
+  {
+    dst[x] = warp_sample<interpolation_mode, BorderAccessMode::Unchecked>(img_src, xs[x], ys[x]);
+  }
+
+  for (auto x = x_end; x < width; ++x)
+  {
+    dst[x] = warp_sample<interpolation_mode, access_mode>(img_src, xs[x], ys[x]);
+  }
+}
+
+}  // namespace sln::impl
+
+#endif  // SELENE_IMG_IMPL_WARP_KERNELS_HPP
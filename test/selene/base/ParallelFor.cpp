@@ -0,0 +1,57 @@
+// This file is part of the `Selene` library.
+// Copyright 2017-2019 Michael Hofmann (https://github.com/kmhofmann).
+// Distributed under MIT license. See accompanying LICENSE file in the top-level directory.
+
+#include <catch2/catch.hpp>
+
+#include <selene/base/_impl/ParallelFor.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+TEST_CASE("Parallel for", "[base]")
+{
+  REQUIRE(sln::impl::get_nr_tasks(0, 100, 8) == 1);
+  REQUIRE(sln::impl::get_nr_tasks(99, 100, 8) == 1);
+  REQUIRE(sln::impl::get_nr_tasks(250, 100, 8) == 2);
+  REQUIRE(sln::impl::get_nr_tasks(100000, 100, 8) == 8);
+  REQUIRE(sln::impl::get_nr_tasks(100000, 0, 8) == 8);
+
+  for (std::size_t nr_threads : {1, 2, 5})
+  {
+    // Each task is executed exactly once
+    for (std::size_t nr_tasks : {0, 1, 3, 100})
+    {
+      std::vector<int> counts(nr_tasks, 0);
+      sln::impl::parallel_for(nr_tasks, nr_threads, [&counts](std::size_t task) { ++counts[task]; });
+      REQUIRE(std::all_of(counts.cbegin(), counts.cend(), [](int count) { return count == 1; }));
+    }
+
+    // An exception thrown by a task is propagated to the calling thread, after all threads have finished
+    for (std::size_t throwing_task : {0, 1, 57, 99})
+    {
+      std::atomic<std::size_t> nr_tasks_run{0};
+      const auto run = [&]() {
+        sln::impl::parallel_for(100, nr_threads, [&](std::size_t task) {
+          ++nr_tasks_run;
+          if (task == throwing_task)
+          {
+            throw std::runtime_error("task failed");
+          }
+        });
+      };
+      REQUIRE_THROWS_AS(run(), std::runtime_error);
+      REQUIRE(nr_tasks_run >= 1);
+      REQUIRE(nr_tasks_run <= 100);
+    }
+
+    // If several tasks throw, exactly one of the exceptions is propagated
+    const auto run_all_throwing = [nr_threads]() {
+      sln::impl::parallel_for(20, nr_threads, [](std::size_t) { throw std::logic_error("task failed"); });
+    };
+    REQUIRE_THROWS_AS(run_all_throwing(), std::logic_error);
+  }
+}
@@ -5,11 +5,14 @@
 #include <catch2/catch.hpp>
 
 #include <selene/base/Types.hpp>
+#include <selene/base/io/AsyncFileReader.hpp>
+#include <selene/base/io/BufferedFileWriter.hpp>
 #include <selene/base/io/FileReader.hpp>
 #include <selene/base/io/FileUtils.hpp>
 #include <selene/base/io/FileWriter.hpp>
 #include <selene/base/io/MemoryReader.hpp>
 #include <selene/base/io/MemoryWriter.hpp>
+#include <selene/base/io/MmapReader.hpp>
 #include <selene/base/io/VectorReader.hpp>
 #include <selene/base/io/VectorWriter.hpp>
 
@@ -19,9 +22,20 @@
 #include <array>
 #include <cstring>
 #include <limits>
+#include <numeric>
 #include <random>
 #include <type_traits>
 
+bool handle_valid(sln::AsyncFileReader& source)
+{
+  return source.is_open();
+}
+
+bool handle_valid(sln::BufferedFileWriter& source)
+{
+  return source.is_open();
+}
+
 bool handle_valid(sln::FileReader& source)
 {
   return source.handle() != nullptr;
@@ -37,6 +51,11 @@ bool handle_valid(sln::MemoryReader& source)
   return source.handle() != nullptr;
 }
 
+bool handle_valid(sln::MmapReader& source)
+{
+  return source.handle() != nullptr;
+}
+
 bool handle_valid(sln::MemoryWriter& source)
 {
   return source.handle() != nullptr;
@@ -176,8 +195,17 @@ TEST_CASE("Test I/O classes", "[io]")
   const auto& filename_str = filename.string();
   write_test_1<sln::FileWriter>(&filename_str);
   read_test_1<sln::FileReader>(&filename_str);
+  read_test_1<sln::MmapReader>(&filename_str);
+  read_test_1<sln::AsyncFileReader>(&filename_str);
   write_test_2<sln::FileWriter>(&filename_str);
   read_test_2<sln::FileReader>(&filename_str);
+  read_test_2<sln::MmapReader>(&filename_str);
+  read_test_2<sln::AsyncFileReader>(&filename_str);
+
+  write_test_1<sln::BufferedFileWriter>(&filename_str);
+  read_test_1<sln::FileReader>(&filename_str);
+  write_test_2<sln::BufferedFileWriter>(&filename_str);
+  read_test_2<sln::FileReader>(&filename_str);
 
   std::vector<std::uint8_t> vec;
   write_test_1<sln::VectorWriter>(&vec);
@@ -192,6 +220,241 @@ TEST_CASE("Test I/O classes", "[io]")
   read_test_1<sln::MemoryReader>(&constant_memory_region);
 }
 
+TEST_CASE("Test memory-mapped file reading", "[io]")
+{
+  const auto tmp_path = sln_test::get_tmp_path();
+  const auto filename = (tmp_path / "test_mmap.bin").string();
+
+  std::vector<std::uint8_t> data(3 * 4096 + 17);
+  std::iota(data.begin(), data.end(), std::uint8_t{0});
+  REQUIRE(sln::write_data_contents(filename, data.data(), data.size()));
+
+  sln::MmapReader f(filename, sln::MmapAccessHint::Random);
+  REQUIRE(f.is_open());
+  REQUIRE(f.size() == data.size());
+  REQUIRE(f.region().len == data.size());
+  REQUIRE(std::equal(data.cbegin(), data.cend(), f.region().data));
+
+  REQUIRE(f.advise(sln::MmapAccessHint::Sequential));
+  REQUIRE(f.advise(sln::MmapAccessHint::WillNeed));
+  REQUIRE(f.prefetch(4097, 100000));
+  REQUIRE(!f.prefetch(data.size(), 1));
+
+  REQUIRE(f.seek_abs(4099));
+  REQUIRE(sln::read<std::uint8_t>(f) == data[4099]);
+
+  // Moving transfers the mapping, including the read position
+  sln::MmapReader g(std::move(f));
+  REQUIRE(!f.is_open());
+  REQUIRE(f.region().data == nullptr);
+  REQUIRE(g.is_open());
+  REQUIRE(g.position() == 4100);
+  REQUIRE(sln::read<std::uint8_t>(g) == data[4100]);
+  REQUIRE(g.memory_reader().position() == 4101);
+
+  g.close();
+  REQUIRE(!g.is_open());
+  REQUIRE(!g.advise(sln::MmapAccessHint::Normal));
+
+  // Missing or empty files cannot be mapped
+  REQUIRE(!g.open((tmp_path / "does_not_exist.bin").string()));
+  REQUIRE(sln::write_data_contents(filename, data.data(), 0));
+  REQUIRE(!g.open(filename));
+  REQUIRE(!g.is_open());
+}
+
+TEST_CASE("Test asynchronous file reading", "[io]")
+{
+  const auto tmp_path = sln_test::get_tmp_path();
+  const auto filename = (tmp_path / "test_async.bin").string();
+
+  std::mt19937 rng(42);
+  std::uniform_int_distribution<int> dist_byte(0, 255);
+  std::vector<std::uint8_t> data(100000 + 17);
+  std::generate(data.begin(), data.end(), [&]() { return static_cast<std::uint8_t>(dist_byte(rng)); });
+  REQUIRE(sln::write_data_contents(filename, data.data(), data.size()));
+
+  for (const auto backend : {sln::AsyncIOBackend::Auto, sln::AsyncIOBackend::IoUring, sln::AsyncIOBackend::Threads})
+  {
+    for (const auto nr_blocks_ahead : {std::size_t{0}, std::size_t{3}, std::size_t{100}})
+    {
+      sln::AsyncFileReader f(filename, sln::AsyncFileReaderOptions(4096, nr_blocks_ahead, backend, 2));
+      REQUIRE(f.is_open());
+      REQUIRE(f.size() == data.size());
+      REQUIRE(f.backend() != sln::AsyncIOBackend::Auto);
+      if (backend == sln::AsyncIOBackend::Threads)
+      {
+        REQUIRE(f.backend() == sln::AsyncIOBackend::Threads);
+      }
+
+      // Sequential reading, in chunks crossing block boundaries
+      std::vector<std::uint8_t> buffer(data.size());
+      std::size_t nr_bytes_read = 0;
+      while (nr_bytes_read < data.size())
+      {
+        const auto nr_bytes = std::min(std::size_t{1000}, data.size() - nr_bytes_read);
+        REQUIRE(f.read(buffer.data() + nr_bytes_read, nr_bytes) == nr_bytes);
+        nr_bytes_read += nr_bytes;
+      }
+      REQUIRE(buffer == data);
+      REQUIRE(f.is_eof());
+      std::uint8_t tmp = 0;
+      REQUIRE(!f.read(tmp));
+
+      // Random access
+      std::uniform_int_distribution<std::ptrdiff_t> dist_pos(0, static_cast<std::ptrdiff_t>(data.size()) - 8);
+      for (int i = 0; i < 200; ++i)
+      {
+        const auto pos = dist_pos(rng);
+        REQUIRE(f.seek_abs(pos));
+        REQUIRE(f.position() == pos);
+        std::uint64_t value = 0;
+        REQUIRE(f.read(value));
+        REQUIRE(std::memcmp(&value, &data[static_cast<std::size_t>(pos)], sizeof(value)) == 0);
+        REQUIRE(f.position() == pos + 8);
+      }
+
+      REQUIRE(f.seek_end(-3));
+      REQUIRE(f.read(buffer.data(), 10) == 3);
+      REQUIRE(std::equal(buffer.cbegin(), buffer.cbegin() + 3, data.cend() - 3));
+      REQUIRE(!f.seek_abs(static_cast<std::ptrdiff_t>(data.size()) + 1));
+      REQUIRE(!f.seek_rel(-static_cast<std::ptrdiff_t>(data.size()) - 1));
+
+      // Peeking returns the buffered data up to the end of the current block, without advancing
+      REQUIRE(f.seek_abs(4000));
+      const auto region = f.peek();
+      REQUIRE(region.len == 96);
+      REQUIRE(std::equal(region.data, region.data + region.len, data.cbegin() + 4000));
+      REQUIRE(f.position() == 4000);
+
+      // Moving transfers the file, including the read position
+      sln::AsyncFileReader g(std::move(f));
+      REQUIRE(!f.is_open());
+      REQUIRE(f.position() == -1);
+      REQUIRE(g.position() == 4000);
+      REQUIRE(sln::read<std::uint8_t>(g) == data[4000]);
+      g.close();
+      REQUIRE(!g.is_open());
+      REQUIRE(g.is_eof());
+    }
+  }
+
+  // Missing files cannot be opened; empty files can
+  sln::AsyncFileReader f;
+  REQUIRE(!f.open((tmp_path / "does_not_exist.bin").string()));
+  REQUIRE(sln::write_data_contents(filename, data.data(), 0));
+  REQUIRE(f.open(filename));
+  REQUIRE(f.is_eof());
+  REQUIRE(f.peek().len == 0);
+}
+
+TEST_CASE("Test buffered file writing", "[io]")
+{
+  const auto tmp_path = sln_test::get_tmp_path();
+  const auto filename = (tmp_path / "test_buffered.bin").string();
+
+  std::mt19937 rng(43);
+  std::uniform_int_distribution<int> dist_byte(0, 255);
+  std::uniform_int_distribution<std::size_t> dist_len(0, 300);
+  std::vector<std::uint8_t> data(200000 + 13);
+  std::generate(data.begin(), data.end(), [&]() { return static_cast<std::uint8_t>(dist_byte(rng)); });
+
+  for (const auto direct_io : {false, true})
+  {
+    for (const auto buffer_size : {std::size_t{1}, std::size_t{100}, std::size_t{4096}, std::size_t{10000}})
+    {
+      sln::BufferedFileWriter f(filename, sln::WriterMode::Write, sln::BufferedFileWriterOptions(buffer_size, direct_io));
+      REQUIRE(f.is_open());
+      REQUIRE(!f.is_eof());
+      if (!direct_io)
+      {
+        REQUIRE(!f.is_direct());
+      }
+
+      // Mixed small and large writes, and writes into the buffer in place
+      std::size_t nr_bytes_written = 0;
+      bool in_place = false;
+      while (nr_bytes_written < data.size())
+      {
+        const auto len = std::min(dist_len(rng) * (in_place ? 1 : 40), data.size() - nr_bytes_written);
+        if (in_place)
+        {
+          const auto region = f.buffer_space();
+          REQUIRE(region.len > 0);
+          const auto nr_bytes = std::min(len, region.len);
+          std::memcpy(region.data, data.data() + nr_bytes_written, nr_bytes);
+          f.commit(nr_bytes);
+          nr_bytes_written += nr_bytes;
+        }
+        else
+        {
+          REQUIRE(f.write(data.data() + nr_bytes_written, len) == len);
+          nr_bytes_written += len;
+        }
+
+        REQUIRE(f.position() == static_cast<std::ptrdiff_t>(nr_bytes_written));
+        in_place = !in_place;
+      }
+
+      // Overwriting at arbitrary positions
+      std::uniform_int_distribution<std::ptrdiff_t> dist_pos(0, static_cast<std::ptrdiff_t>(data.size()) - 8);
+      for (int i = 0; i < 50; ++i)
+      {
+        const auto pos = dist_pos(rng);
+        const auto value = static_cast<std::uint64_t>(rng());
+        REQUIRE(f.seek_abs(pos));
+        REQUIRE(write(f, value));
+        std::memcpy(&data[static_cast<std::size_t>(pos)], &value, sizeof(value));
+      }
+
+      // Reading back flushes buffered data first
+      REQUIRE(f.seek_abs(1000));
+      std::array<std::uint8_t, 64> buffer{};
+      REQUIRE(f.read(buffer.data(), buffer.size()) == buffer.size());
+      REQUIRE(std::equal(buffer.cbegin(), buffer.cend(), data.cbegin() + 1000));
+      REQUIRE(f.seek_end(-3));
+      REQUIRE(f.read(buffer.data(), buffer.size()) == 3);
+      REQUIRE(f.is_eof());
+      REQUIRE(f.seek_end(0));
+      REQUIRE(!f.is_eof());
+      REQUIRE(f.position() == static_cast<std::ptrdiff_t>(data.size()));
+
+      // Moving transfers the file, including buffered data
+      REQUIRE(write(f, std::uint8_t{42}));
+      data.push_back(42);
+      sln::BufferedFileWriter g(std::move(f));
+      REQUIRE(!f.is_open());
+      REQUIRE(f.position() == -1);
+      REQUIRE(g.position() == static_cast<std::ptrdiff_t>(data.size()));
+      REQUIRE(g.close());
+      REQUIRE(!g.is_open());
+      data.pop_back();
+
+      const auto contents = sln::read_file_contents(filename);
+      REQUIRE(contents);
+      REQUIRE(contents->size() == data.size() + 1);
+      REQUIRE(std::equal(data.cbegin(), data.cend(), contents->cbegin()));
+      REQUIRE(contents->back() == 42);
+    }
+  }
+
+  // Appending to an existing file
+  REQUIRE(sln::write_data_contents(filename, data.data(), 10));
+  sln::BufferedFileWriter f(filename, sln::WriterMode::Append);
+  REQUIRE(f.position() == 10);
+  REQUIRE(f.write(data.data() + 10, 5) == 5);
+  REQUIRE(f.flush());
+  const auto contents = sln::read_file_contents(filename);
+  REQUIRE(contents);
+  REQUIRE(contents->size() == 15);
+  REQUIRE(std::equal(contents->cbegin(), contents->cend(), data.cbegin()));
+
+  // Files in non-existing directories cannot be opened
+  REQUIRE(!f.open((tmp_path / "does_not_exist" / "file.bin").string()));
+  REQUIRE(!f.is_open());
+  REQUIRE(f.write(data.data(), 5) == 0);
+}
+
 TEST_CASE("Test binary data I/O", "[io]")
 {
   const auto tmp_path = sln_test::get_tmp_path();
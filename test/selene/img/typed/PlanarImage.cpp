@@ -0,0 +1,159 @@
+// This file is part of the `Selene` library.
+// Copyright 2017-2019 Michael Hofmann (https://github.com/kmhofmann).
+// Distributed under MIT license. See accompanying LICENSE file in the top-level directory.
+
+#include <catch2/catch.hpp>
+
+#include <selene/img/typed/PlanarImage.hpp>
+#include <selene/img/typed/PlanarImageView.hpp>
+
+#include <array>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+using namespace sln::literals;
+
+namespace {
+
+template <typename T, std::size_t N, typename PlanarImg>
+void fill_planes(PlanarImg& planar)
+{
+  for (std::size_t c = 0; c < N; ++c)
+  {
+    for (auto y = 0_idx; y < planar.height(); ++y)
+    {
+      for (auto x = 0_idx; x < planar.width(); ++x)
+      {
+        planar.plane(c)(x, y) = static_cast<T>(100 * c + 10 * y + x);
+      }
+    }
+  }
+}
+
+template <typename T, std::size_t N, typename PlanarImg>
+void check_planes(const PlanarImg& planar)
+{
+  for (std::size_t c = 0; c < N; ++c)
+  {
+    for (auto y = 0_idx; y < planar.height(); ++y)
+    {
+      for (auto x = 0_idx; x < planar.width(); ++x)
+      {
+        REQUIRE(planar.plane(c)(x, y) == static_cast<T>(100 * c + 10 * y + x));
+      }
+    }
+  }
+}
+
+}  // namespace
+
+TEST_CASE("Planar image construction", "[img]")
+{
+  SECTION("Default construction")
+  {
+    sln::PlanarImage<std::uint8_t, 3> planar;
+    REQUIRE(planar.is_empty());
+    REQUIRE(!planar.is_valid());
+    REQUIRE(planar.nr_channels == 3);
+  }
+
+  SECTION("Construction with layout")
+  {
+    sln::PlanarImage<std::uint16_t, 4> planar({7_px, 5_px});
+    REQUIRE(planar.width() == 7_px);
+    REQUIRE(planar.height() == 5_px);
+    REQUIRE(planar.is_valid());
+
+    for (std::size_t c = 0; c < 4; ++c)
+    {
+      REQUIRE(planar.plane(c).width() == 7_px);
+      REQUIRE(planar.plane(c).height() == 5_px);
+      REQUIRE(planar.plane(c).stride_bytes() >= sln::Stride{7 * 2});
+    }
+
+    for (std::size_t c = 1; c < 4; ++c)
+    {
+      REQUIRE(planar.plane(c).byte_ptr() != planar.plane(0).byte_ptr());
+    }
+
+    // Planes are only accessible as views, s.t. they cannot be reallocated individually
+    static_assert(std::is_same_v<decltype(planar.plane(0)), sln::MutableImageView<sln::Pixel<std::uint16_t, 1>>>);
+    static_assert(std::is_same_v<decltype(std::as_const(planar).plane(0)),
+                                 sln::ConstantImageView<sln::Pixel<std::uint16_t, 1>>>);
+
+    fill_planes<std::uint16_t, 4>(planar);
+    check_planes<std::uint16_t, 4>(planar);
+  }
+
+  SECTION("Reallocation and clearing")
+  {
+    sln::PlanarImage<float, 2> planar({4_px, 3_px});
+    REQUIRE(!planar.reallocate(planar.plane(0).layout()));
+    REQUIRE(planar.reallocate({8_px, 6_px}));
+    REQUIRE(planar.width() == 8_px);
+    REQUIRE(planar.height() == 6_px);
+
+    planar.clear();
+    REQUIRE(planar.is_empty());
+  }
+}
+
+TEST_CASE("Planar image views", "[img]")
+{
+  sln::PlanarImage<std::uint8_t, 3> planar({6_px, 4_px});
+  fill_planes<std::uint8_t, 3>(planar);
+
+  SECTION("Mutable view")
+  {
+    auto view = planar.view();
+    REQUIRE(view.is_view);
+    REQUIRE(view.is_modifiable);
+    REQUIRE(view.width() == 6_px);
+    REQUIRE(view.height() == 4_px);
+    check_planes<std::uint8_t, 3>(view);
+
+    view.plane(1)(2_idx, 3_idx) = std::uint8_t{255};
+    REQUIRE(planar.plane(1)(2_idx, 3_idx) == 255);
+  }
+
+  SECTION("Constant view")
+  {
+    const auto view = planar.constant_view();
+    REQUIRE(view.is_view);
+    REQUIRE(!view.is_modifiable);
+    check_planes<std::uint8_t, 3>(view);
+
+    for (std::size_t c = 0; c < 3; ++c)
+    {
+      REQUIRE(view.plane(c).byte_ptr() == planar.plane(c).byte_ptr());
+    }
+  }
+
+  SECTION("Deep copy from view")
+  {
+    const sln::PlanarImage<std::uint8_t, 3> planar_copy(planar.constant_view());
+    check_planes<std::uint8_t, 3>(planar_copy);
+
+    for (std::size_t c = 0; c < 3; ++c)
+    {
+      REQUIRE(planar_copy.plane(c).byte_ptr() != planar.plane(c).byte_ptr());
+    }
+  }
+
+  SECTION("View from separately allocated planes")
+  {
+    sln::Image<sln::Pixel<std::uint8_t, 1>> plane_0({6_px, 4_px});
+    sln::Image<sln::Pixel<std::uint8_t, 1>> plane_1({6_px, 4_px, sln::Stride{32}});
+    sln::Image<sln::Pixel<std::uint8_t, 1>> plane_2({6_px, 4_px});
+    const std::array<sln::MutableImageView<sln::Pixel<std::uint8_t, 1>>, 3> planes = {
+        {plane_0.view(), plane_1.view(), plane_2.view()}};
+    sln::MutablePlanarImageView<std::uint8_t, 3> view(planes);
+    fill_planes<std::uint8_t, 3>(view);
+    check_planes<std::uint8_t, 3>(view.constant_view());
+    REQUIRE(plane_1(5_idx, 3_idx) == 135);
+
+    view.clear();
+    REQUIRE(view.is_empty());
+  }
+}
@@ -9,7 +9,10 @@
 
 #include <test/utils/Utils.hpp>
 
+#include <cmath>
 #include <random>
+#include <utility>
+#include <vector>
 
 namespace sln_test {
 
@@ -94,6 +97,56 @@ sln::Image<PixelType> construct_random_image(sln::PixelLength width, sln::PixelL
   return img;
 }
 
+using ImageSize = std::pair<sln::PixelLength, sln::PixelLength>;
+
+/** \brief Returns small image sizes for comparing image operations against naive reference implementations: a single
+ * pixel, a single row, a single column, and two images with odd extents.
+ */
+inline std::vector<ImageSize> reference_test_sizes()
+{
+  using namespace sln::literals;
+  return {{1_px, 1_px}, {9_px, 1_px}, {1_px, 7_px}, {17_px, 13_px}, {31_px, 23_px}};
+}
+
+/** \brief Returns image sizes large enough to be split into several tasks by the parallel image operations (which
+ * process bands of at least 64K pixels), including an image whose rows are longer than such a band.
+ */
+inline std::vector<ImageSize> parallel_test_sizes()
+{
+  using namespace sln::literals;
+  return {{512_px, 400_px}, {70000_px, 3_px}};
+}
+
+/** \brief Returns whether two images have the same size, and all corresponding channel values differ by at most
+ * `tolerance`.
+ */
+template <typename Img0, typename Img1>
+bool images_nearly_equal(const Img0& img_0, const Img1& img_1, double tolerance)
+{
+  using namespace sln::literals;
+  using PixelType = typename Img0::PixelType;
+
+  if (img_0.width() != img_1.width() || img_0.height() != img_1.height())
+  {
+    return false;
+  }
+
+  for (auto y = 0_idx; y < img_0.height(); ++y)
+  {
+    for (auto x = 0_idx; x < img_0.width(); ++x)
+    {
+      for (std::size_t i = 0; i < sln::PixelTraits<PixelType>::nr_channels; ++i)
+      {
+        if (std::abs(double(img_0(x, y)[i]) - double(img_1(x, y)[i])) > tolerance)
+        {
+          return false;
+        }
+      }
+    }
+  }
+  return true;
+}
+
 }  // namespace sln_test
 
 #endif  // SELENE_TEST_IMG_TYPED_UTILS_HPP
@@ -6,14 +6,24 @@
 
 #include <selene/base/MessageLog.hpp>
 
+#include <selene/base/io/AsyncFileReader.hpp>
+#include <selene/base/io/BufferedFileWriter.hpp>
 #include <selene/base/io/FileReader.hpp>
+#include <selene/base/io/FileUtils.hpp>
 #include <selene/base/io/FileWriter.hpp>
+#include <selene/base/io/MemoryReader.hpp>
+#include <selene/base/io/MmapReader.hpp>
 #include <selene/base/io/VectorWriter.hpp>
 
 #include <selene/img_io/IO.hpp>
 
 #include <test/utils/Utils.hpp>
 
+#include <algorithm>
+#include <array>
+#include <optional>
+#include <utility>
+
 constexpr auto duck_ref_width = 1024;
 constexpr auto duck_ref_height = 684;
 
@@ -125,3 +135,298 @@ TEST_CASE("Image reading with automatic format selection", "[img]")
   }
 #endif // defined(SELENE_WITH_LIBTIFF)
 }
+
+TEST_CASE("Image reading from memory-mapped files", "[img]")
+{
+  const auto check_equal = [](const sln::DynImage<>& img_0, const sln::DynImage<>& img_1) {
+    REQUIRE(img_0.is_valid());
+    REQUIRE(img_1.is_valid());
+    REQUIRE(img_0.total_bytes() == img_1.total_bytes());
+    REQUIRE(std::equal(img_0.byte_ptr(), img_0.byte_ptr() + img_0.total_bytes(), img_1.byte_ptr()));
+  };
+
+  const auto check_file = [&check_equal](const char* filename, auto read_func) {
+    const auto path = sln_test::full_data_path(filename).string();
+    const auto ref_img = read_func(sln::FileReader(path));
+
+    sln::MmapReader source(path);
+    REQUIRE(source.is_open());
+    check_equal(read_func(source), ref_img);
+
+    source.rewind();
+    check_equal(sln::read_image(source), ref_img);
+  };
+
+#if defined(SELENE_WITH_LIBJPEG)
+  check_file("bike_duck.jpg", [](auto&& source) { return sln::read_jpeg(source); });
+#endif  // defined(SELENE_WITH_LIBJPEG)
+
+#if defined(SELENE_WITH_LIBPNG)
+  check_file("bike_duck.png", [](auto&& source) { return sln::read_png(source); });
+#endif  // defined(SELENE_WITH_LIBPNG)
+
+#if defined(SELENE_WITH_LIBTIFF)
+  check_file("stickers_lzw.tif", [](auto&& source) { return sln::read_tiff(source); });
+#endif  // defined(SELENE_WITH_LIBTIFF)
+}
+
+TEST_CASE("Image reading via asynchronous file I/O", "[img]")
+{
+  const auto check_equal = [](const sln::DynImage<>& img_0, const sln::DynImage<>& img_1) {
+    REQUIRE(img_0.is_valid());
+    REQUIRE(img_1.is_valid());
+    REQUIRE(img_0.total_bytes() == img_1.total_bytes());
+    REQUIRE(std::equal(img_0.byte_ptr(), img_0.byte_ptr() + img_0.total_bytes(), img_1.byte_ptr()));
+  };
+
+  const auto check_file = [&check_equal](const char* filename, auto read_func) {
+    const auto path = sln_test::full_data_path(filename).string();
+    const auto ref_img = read_func(sln::FileReader(path));
+
+    // Small blocks, to exercise handing over many blocks to the decoders
+    for (const auto backend : {sln::AsyncIOBackend::Auto, sln::AsyncIOBackend::Threads})
+    {
+      sln::AsyncFileReader source(path, sln::AsyncFileReaderOptions(4096, 2, backend));
+      REQUIRE(source.is_open());
+      check_equal(read_func(source), ref_img);
+
+      source.rewind();
+      check_equal(sln::read_image(source), ref_img);
+
+      source.rewind();
+      const auto info = sln::read_image_info(source);
+      REQUIRE(info.is_valid());
+      REQUIRE(info.width == ref_img.width());
+      REQUIRE(info.height == ref_img.height());
+      REQUIRE(source.position() == 0);
+    }
+  };
+
+#if defined(SELENE_WITH_LIBJPEG)
+  check_file("bike_duck.jpg", [](auto&& source) { return sln::read_jpeg(source); });
+
+  // The same decompression object can alternate between source types
+  {
+    const auto path = sln_test::full_data_path("bike_duck.jpg").string();
+    sln::JPEGDecompressionObject obj;
+    sln::AsyncFileReader async_source(path);
+    const auto img_0 = sln::read_jpeg(obj, async_source);
+    const auto img_1 = sln::read_jpeg(obj, sln::FileReader(path));
+    async_source.rewind();
+    const auto img_2 = sln::read_jpeg(obj, async_source);
+    check_equal(img_0, img_1);
+    check_equal(img_0, img_2);
+  }
+
+  // Truncated files: the image is progressive, so all scans are already read by jpeg_start_decompress()
+  {
+    const auto contents = sln::read_file_contents(sln_test::full_data_path("bike_duck.jpg").string());
+    REQUIRE(contents);
+    const auto path = (sln_test::get_tmp_path() / "bike_duck_truncated.jpg").string();
+
+    const auto find_marker = [&contents](std::uint8_t marker, std::size_t offset) {
+      const std::array<std::uint8_t, 2> pattern = {{0xFF, marker}};
+      return static_cast<std::size_t>(
+          std::search(contents->begin() + static_cast<std::ptrdiff_t>(offset), contents->end(), pattern.begin(),
+                      pattern.end())
+          - contents->begin());
+    };
+
+    const auto read_truncated = [&](std::size_t truncated_size, sln::MessageLog& messages) {
+      REQUIRE(sln::write_data_contents(path, contents->data(), truncated_size));
+      sln::AsyncFileReader source(path, sln::AsyncFileReaderOptions(4096, 2));
+      auto img = sln::read_jpeg(source, sln::JPEGDecompressionOptions(), &messages);
+      return std::make_pair(std::move(img), source.position());
+    };
+
+    // Ending within entropy-coded data: decoded with a warning, and the reader is left at the end of the data
+    sln::MessageLog messages_0;
+    const auto [img_0, position_0] = read_truncated(contents->size() / 2, messages_0);
+    REQUIRE(img_0.is_valid());
+    REQUIRE(!messages_0.messages().empty());
+    REQUIRE(position_0 == static_cast<std::ptrdiff_t>(contents->size() / 2));
+
+    // Ending within the Huffman tables following the first scan: fails within jpeg_start_decompress()
+    constexpr std::uint8_t marker_sos = 0xDA;  // start of scan
+    constexpr std::uint8_t marker_dht = 0xC4;  // define Huffman table(s)
+    const auto dht_offset = find_marker(marker_dht, find_marker(marker_sos, 0));
+    REQUIRE(dht_offset < contents->size());
+    sln::MessageLog messages_1;
+    const auto [img_1, position_1] = read_truncated(dht_offset + 6, messages_1);
+    REQUIRE(!img_1.is_valid());
+    REQUIRE(!messages_1.messages().empty());
+    REQUIRE(position_1 <= static_cast<std::ptrdiff_t>(dht_offset + 6));
+  }
+#endif  // defined(SELENE_WITH_LIBJPEG)
+
+#if defined(SELENE_WITH_LIBPNG)
+  check_file("bike_duck.png", [](auto&& source) { return sln::read_png(source); });
+#endif  // defined(SELENE_WITH_LIBPNG)
+
+#if defined(SELENE_WITH_LIBTIFF)
+  check_file("stickers_lzw.tif", [](auto&& source) { return sln::read_tiff(source); });
+#endif  // defined(SELENE_WITH_LIBTIFF)
+}
+
+TEST_CASE("Image writing via buffered file I/O", "[img]")
+{
+  const auto tmp_path = sln_test::get_tmp_path();
+
+  const auto check_file = [&tmp_path](const char* filename, sln::ImageFormat format) {
+    const auto img = sln::read_image(sln::FileReader(sln_test::full_data_path(filename).string()));
+    REQUIRE(img.is_valid());
+
+    const auto ref_path = (tmp_path / "buffered_ref.bin").string();
+    REQUIRE(sln::write_image(img, format, sln::FileWriter(ref_path)));
+    const auto ref_contents = sln::read_file_contents(ref_path);
+    REQUIRE(ref_contents);
+
+    // Small buffers, to exercise flushing while encoding
+    for (const auto& options : {sln::BufferedFileWriterOptions(1000), sln::BufferedFileWriterOptions(),
+                                sln::BufferedFileWriterOptions(8192, true)})
+    {
+      const auto path = (tmp_path / "buffered_test.bin").string();
+
+      {
+        sln::BufferedFileWriter sink(path, sln::WriterMode::Write, options);
+        REQUIRE(sln::write_image(img, format, sink));
+        REQUIRE(sink.close());
+      }
+
+      const auto contents = sln::read_file_contents(path);
+      REQUIRE(contents);
+      REQUIRE(*contents == *ref_contents);
+
+      // Temporaries are closed by write_image(), writing out their buffered data
+      REQUIRE(sln::write_image(img, format, sln::BufferedFileWriter(path, sln::WriterMode::Write, options)));
+      REQUIRE(*sln::read_file_contents(path) == *ref_contents);
+
+#if defined(__linux__)
+      // Failing to write out the buffered data of a temporary is reported (writing to /dev/full fails with ENOSPC)
+      sln::MessageLog message_log;
+      REQUIRE(!sln::write_image(img, format, sln::BufferedFileWriter("/dev/full", sln::WriterMode::Write, options),
+                                &message_log));
+      REQUIRE(message_log.contains_errors());
+#endif
+    }
+  };
+
+#if defined(SELENE_WITH_LIBJPEG)
+  check_file("bike_duck.jpg", sln::ImageFormat::JPEG);
+#endif  // defined(SELENE_WITH_LIBJPEG)
+
+#if defined(SELENE_WITH_LIBPNG)
+  check_file("bike_duck.png", sln::ImageFormat::PNG);
+#endif  // defined(SELENE_WITH_LIBPNG)
+
+#if defined(SELENE_WITH_LIBTIFF)
+  check_file("stickers_lzw.tif", sln::ImageFormat::TIFF);
+#endif  // defined(SELENE_WITH_LIBTIFF)
+}
+
+TEST_CASE("Image format detection", "[img]")
+{
+  const auto check_detection = [](const char* filename, std::optional<sln::ImageFormat> ref_format) {
+    sln::FileReader source(sln_test::full_data_path(filename).string());
+    REQUIRE(source.is_open());
+
+    // Detection must not consume any data
+    const auto pos = source.position();
+    REQUIRE(sln::detect_image_format(source) == ref_format);
+    REQUIRE(source.position() == pos);
+  };
+
+#if defined(SELENE_WITH_LIBJPEG)
+  check_detection("bike_duck.jpg", sln::ImageFormat::JPEG);
+#endif  // defined(SELENE_WITH_LIBJPEG)
+
+#if defined(SELENE_WITH_LIBPNG)
+  check_detection("bike_duck.png", sln::ImageFormat::PNG);
+#endif  // defined(SELENE_WITH_LIBPNG)
+
+#if defined(SELENE_WITH_LIBTIFF)
+  check_detection("stickers_jpeg.tif", sln::ImageFormat::TIFF);
+#endif  // defined(SELENE_WITH_LIBTIFF)
+
+  // Unknown or truncated signatures
+  const std::array<std::uint8_t, 8> garbage = {{0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07}};
+  REQUIRE(sln::detect_image_format(sln::MemoryReader({garbage.data(), garbage.size()})) == std::nullopt);
+  REQUIRE(sln::detect_image_format(sln::MemoryReader({garbage.data(), 0})) == std::nullopt);
+
+  const std::array<std::uint8_t, 2> truncated_jpeg = {{0xFF, 0xD8}};
+  REQUIRE(sln::detect_image_format(sln::MemoryReader({truncated_jpeg.data(), truncated_jpeg.size()})) == std::nullopt);
+
+#if defined(SELENE_WITH_LIBPNG)
+  // A valid signature followed by garbage is rejected, after falling back to the remaining decoders
+  const std::array<std::uint8_t, 12> corrupt_png = {
+      {0x89, 0x50, 0x4E, 0x47, 0x0D, 0x0A, 0x1A, 0x0A, 0x00, 0x01, 0x02, 0x03}};
+  REQUIRE(!sln::read_image(sln::MemoryReader({corrupt_png.data(), corrupt_png.size()})).is_valid());
+#endif  // defined(SELENE_WITH_LIBPNG)
+}
+
+TEST_CASE("Image information reading", "[img]")
+{
+  const auto check_info = [](const char* filename, sln::ImageFormat ref_format, std::int16_t ref_nr_channels,
+                             std::int16_t ref_bit_depth) {
+    const auto path = sln_test::full_data_path(filename).string();
+    const auto ref_img = sln::read_image(sln::FileReader(path));
+    REQUIRE(ref_img.is_valid());
+
+    // Repeated header reads (without decoding in between) re-use the internal decompression objects
+    for (int i = 0; i < 2; ++i)
+    {
+      sln::FileReader source(path);
+      REQUIRE(source.is_open());
+      const auto pos = source.position();
+      sln::MessageLog messages;
+      const auto info = sln::read_image_info(source, &messages);
+      REQUIRE(messages.messages().empty());
+      REQUIRE(source.position() == pos);
+      REQUIRE(info.is_valid());
+      REQUIRE(info.format == ref_format);
+      REQUIRE(info.width == ref_img.width());
+      REQUIRE(info.height == ref_img.height());
+      REQUIRE(info.nr_channels == ref_nr_channels);
+      REQUIRE(info.bit_depth == ref_bit_depth);
+      REQUIRE(info.sample_format == sln::SampleFormat::UnsignedInteger);
+      REQUIRE(info.nr_pages == 1);
+
+      const auto contents = sln::read_file_contents(path);
+      REQUIRE(contents.has_value());
+      const auto info_mem = sln::read_image_info(sln::MemoryReader({contents->data(), contents->size()}));
+      REQUIRE(info_mem.width == info.width);
+      REQUIRE(info_mem.height == info.height);
+    }
+
+    // Decoding still works after only reading header information
+    const auto img = sln::read_image(sln::FileReader(path));
+    REQUIRE(img.is_valid());
+    REQUIRE(img.total_bytes() == ref_img.total_bytes());
+  };
+
+#if defined(SELENE_WITH_LIBJPEG)
+  check_info("bike_duck.jpg", sln::ImageFormat::JPEG, 3, 8);
+#endif  // defined(SELENE_WITH_LIBJPEG)
+
+#if defined(SELENE_WITH_LIBPNG)
+  check_info("bike_duck.png", sln::ImageFormat::PNG, 3, 8);
+  check_info("png_suite/basn0g16.png", sln::ImageFormat::PNG, 1, 16);
+  check_info("png_suite/basn6a08.png", sln::ImageFormat::PNG, 4, 8);
+#endif  // defined(SELENE_WITH_LIBPNG)
+
+#if defined(SELENE_WITH_LIBTIFF)
+  check_info("stickers_lzw.tif", sln::ImageFormat::TIFF, 3, 8);
+#endif  // defined(SELENE_WITH_LIBTIFF)
+
+  const std::array<std::uint8_t, 8> garbage = {{0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07}};
+  sln::MessageLog messages;
+  REQUIRE(!sln::read_image_info(sln::MemoryReader({garbage.data(), garbage.size()}), &messages).is_valid());
+  REQUIRE(messages.contains_errors());
+
+#if defined(SELENE_WITH_LIBPNG)
+  // A PNG signature without a valid header
+  const std::array<std::uint8_t, 12> truncated_png = {{0x89, 'P', 'N', 'G', 0x0D, 0x0A, 0x1A, 0x0A, 0, 0, 0, 13}};
+  REQUIRE(!sln::read_image_info(sln::MemoryReader({truncated_png.data(), truncated_png.size()})).is_valid());
+  REQUIRE(sln::read_image_info(sln::FileReader(sln_test::full_data_path("bike_duck.png").string())).is_valid());
+#endif  // defined(SELENE_WITH_LIBPNG)
+}
@@ -8,11 +8,14 @@
 
 #include <catch2/catch.hpp>
 
+#include <algorithm>
 #include <cstdlib>
+#include <vector>
 
 #include <selene/base/io/FileReader.hpp>
 #include <selene/base/io/FileUtils.hpp>
 #include <selene/base/io/FileWriter.hpp>
+#include <selene/base/io/MemoryWriter.hpp>
 #include <selene/base/io/MemoryReader.hpp>
 #include <selene/base/io/VectorWriter.hpp>
 
@@ -29,6 +32,7 @@
 #include <selene/img/interop/ImageToDynImage.hpp>
 
 #include <selene/img_io/jpeg/Read.hpp>
+#include <selene/img_io/jpeg/Thumbnail.hpp>
 #include <selene/img_io/jpeg/Write.hpp>
 
 #include <test/utils/Utils.hpp>
@@ -211,6 +215,208 @@ TEST_CASE("JPEG image reading / reusing decompression object", "[img]")
   }
 }
 
+TEST_CASE("JPEG image reading / into pre-allocated views, reusing decompression object", "[img]")
+{
+  const auto file_contents = sln::read_file_contents(sln_test::full_data_path("bike_duck.jpg").string());
+  REQUIRE(file_contents.has_value());
+  const auto& jpeg_data = file_contents.value();
+
+  constexpr std::size_t pool_size = 3;
+  const auto layout = sln::UntypedLayout{sln::to_pixel_length(duck_ref_width), sln::to_pixel_length(duck_ref_height),
+                                         3, 1};
+  sln::DynImage<> pool_memory({layout.width, sln::to_pixel_length(duck_ref_height * pool_size), 3, 1});
+
+  std::vector<sln::MutableDynImageView> pool;
+  for (std::size_t i = 0; i < pool_size; ++i)
+  {
+    const auto y0 = sln::to_pixel_index(duck_ref_height * i);
+    pool.emplace_back(pool_memory.byte_ptr(y0), sln::UntypedLayout{layout.width, layout.height, 3, 1,
+                                                                   pool_memory.stride_bytes()});
+  }
+
+  sln::JPEGDecompressionObject decompression_object;
+
+  // A failed decompression must not prevent re-use of the decompression object
+  const std::vector<std::uint8_t> not_jpeg_data(256, std::uint8_t{0x42});
+  sln::MessageLog messages_fail;
+  REQUIRE(!sln::read_jpeg(decompression_object, sln::MemoryReader({not_jpeg_data.data(), not_jpeg_data.size()}),
+                          pool[0], sln::JPEGDecompressionOptions(), &messages_fail));
+  REQUIRE(!messages_fail.messages().empty());
+
+  for (auto& view : pool)
+  {
+    sln::MessageLog messages_read;
+    const auto res = sln::read_jpeg(decompression_object, sln::MemoryReader({jpeg_data.data(), jpeg_data.size()}),
+                                    view, sln::JPEGDecompressionOptions(), &messages_read);
+    REQUIRE(res);
+    REQUIRE(messages_read.messages().empty());
+    REQUIRE(view.byte_ptr() != nullptr);
+    REQUIRE(view.width() == duck_ref_width);
+    REQUIRE(view.height() == duck_ref_height);
+    REQUIRE(view.pixel_format() == sln::PixelFormat::RGB);
+
+    const auto img = sln::to_image_view<sln::Pixel_8u3>(view);
+
+    for (std::size_t i = 0; i < 3; ++i)
+    {
+      const auto x = sln::to_pixel_index(pix[i][0]);
+      const auto y = sln::to_pixel_index(pix[i][1]);
+      REQUIRE(img(x, y) == sln::Pixel_8u3(pix[i][2], pix[i][3], pix[i][4]));
+    }
+  }
+
+  // Views with an incompatible layout are rejected
+  sln::MutableDynImageView small_view{pool_memory.byte_ptr(), sln::UntypedLayout{layout.width - 1, layout.height, 3, 1}};
+  REQUIRE(!sln::read_jpeg(decompression_object, sln::MemoryReader({jpeg_data.data(), jpeg_data.size()}), small_view));
+
+  // Reading into a DynImage allocates as necessary
+  sln::DynImage<> dyn_img;
+  REQUIRE(sln::read_jpeg(sln::MemoryReader({jpeg_data.data(), jpeg_data.size()}), dyn_img));
+  REQUIRE(dyn_img.width() == duck_ref_width);
+  REQUIRE(dyn_img.height() == duck_ref_height);
+  REQUIRE(dyn_img.is_packed());
+}
+
+TEST_CASE("JPEG image reading / scaled decompression", "[img]")
+{
+  sln::FileReader source(sln_test::full_data_path("bike_duck.jpg").string());
+  REQUIRE(source.is_open());
+  const auto pos = source.position();
+
+  for (auto dct_method : {sln::JPEGDCTMethod::IntegerSlow, sln::JPEGDCTMethod::IntegerFast, sln::JPEGDCTMethod::Float})
+  {
+    source.seek_abs(pos);
+
+    sln::JPEGDecompressionOptions options;
+    options.scale_num = 1;
+    options.scale_denom = 4;
+    options.dct_method = dct_method;
+    options.do_fancy_upsampling = false;
+    options.do_block_smoothing = false;
+
+    sln::JPEGReader<sln::FileReader> jpeg_reader(source, options);
+    const auto info = jpeg_reader.get_output_image_info();
+    REQUIRE(info.is_valid());
+    REQUIRE(info.width == duck_ref_width / 4);
+    REQUIRE(info.height == duck_ref_height / 4);
+
+    const auto dyn_img = jpeg_reader.read_image_data();
+    REQUIRE(jpeg_reader.message_log().messages().empty());
+    REQUIRE(dyn_img.is_valid());
+    REQUIRE(dyn_img.width() == duck_ref_width / 4);
+    REQUIRE(dyn_img.height() == duck_ref_height / 4);
+    REQUIRE(dyn_img.nr_channels() == 3);
+  }
+}
+
+TEST_CASE("JPEG image reading / thumbnail", "[img]")
+{
+  const auto path = sln_test::full_data_path("bike_duck.jpg").string();
+
+  sln::MessageLog messages;
+  const auto thumbnail = sln::read_jpeg_thumbnail(sln::FileReader(path), 200_px, 200_px,
+                                                  sln::JPEGDecompressionOptions(), &messages);
+  REQUIRE(messages.messages().empty());
+  REQUIRE(thumbnail.is_valid());
+  REQUIRE(thumbnail.width() == 200);
+  REQUIRE(thumbnail.height() == 134);
+  REQUIRE(thumbnail.nr_channels() == 3);
+  REQUIRE(thumbnail.pixel_format() == sln::PixelFormat::RGB);
+
+  // Exactly matching a DCT scaling factor requires no further resampling
+  const auto half = sln::read_jpeg_thumbnail(sln::FileReader(path), 512_px, 1000_px);
+  REQUIRE(half.width() == 512);
+  REQUIRE(half.height() == 342);
+
+  // Images that are already small enough are not enlarged
+  const auto full = sln::read_jpeg_thumbnail(sln::FileReader(path), 4000_px, 4000_px);
+  REQUIRE(full.width() == duck_ref_width);
+  REQUIRE(full.height() == duck_ref_height);
+
+  const auto invalid = sln::read_jpeg_thumbnail(sln::FileReader(path), 0_px, 100_px);
+  REQUIRE(!invalid.is_valid());
+}
+
+TEST_CASE("JPEG image reading and writing / raw planar data", "[img]")
+{
+  const auto path = sln_test::full_data_path("bike_duck.jpg").string();
+
+  sln::MessageLog messages_read;
+  const auto planar_img = sln::read_jpeg_planar(sln::FileReader(path), &messages_read);
+  REQUIRE(messages_read.messages().empty());
+  REQUIRE(planar_img.is_valid());
+  REQUIRE(planar_img.color_space == sln::JPEGColorSpace::YCbCr);
+  REQUIRE(planar_img.planes.size() == 3);
+  REQUIRE(planar_img.planes[0].width() == duck_ref_width);
+  REQUIRE(planar_img.planes[0].height() == duck_ref_height);
+  REQUIRE(planar_img.planes[1].width() == duck_ref_width);  // no chroma subsampling (4:4:4)
+  REQUIRE(planar_img.planes[1].height() == duck_ref_height);
+  REQUIRE(planar_img.planes[2].width() == duck_ref_width);
+  REQUIRE(planar_img.planes[2].height() == duck_ref_height);
+
+  // The luma plane has to be identical to grayscale decompression
+  auto dyn_img_y = sln::read_jpeg(sln::FileReader(path), sln::JPEGDecompressionOptions(sln::JPEGColorSpace::Grayscale));
+  const auto img_y = sln::to_image_view<sln::Pixel_8u1>(dyn_img_y);
+  bool luma_identical = true;
+  for (auto y = 0_idx; y < img_y.height(); ++y)
+  {
+    for (auto x = 0_idx; x < img_y.width(); ++x)
+    {
+      luma_identical &= (planar_img.planes[0](x, y) == img_y(x, y)[0]);
+    }
+  }
+  REQUIRE(luma_identical);
+
+  // Subsample the chroma planes (4:2:0), write the planes, and read them back
+  std::vector<sln::Image<std::uint8_t>> chroma_planes;
+  for (std::size_t c = 1; c < 3; ++c)
+  {
+    const auto& plane = planar_img.planes[c];
+    sln::Image<std::uint8_t> chroma_plane({plane.width() / 2, plane.height() / 2});
+    for (auto y = 0_idx; y < chroma_plane.height(); ++y)
+    {
+      for (auto x = 0_idx; x < chroma_plane.width(); ++x)
+      {
+        chroma_plane(x, y) = plane(2 * x, 2 * y);
+      }
+    }
+    chroma_planes.push_back(std::move(chroma_plane));
+  }
+
+  std::vector<sln::ConstantImageView<std::uint8_t>> planes = {planar_img.planes[0].constant_view(),
+                                                              chroma_planes[0].constant_view(),
+                                                              chroma_planes[1].constant_view()};
+
+  std::vector<std::uint8_t> compressed_data;
+  sln::MessageLog messages_write;
+  const auto write_success = sln::write_jpeg_planar(planes, sln::VectorWriter(compressed_data),
+                                                    sln::JPEGCompressionOptions(compression_factor), &messages_write);
+  REQUIRE(write_success);
+  REQUIRE(messages_write.messages().empty());
+  REQUIRE(!compressed_data.empty());
+
+  const auto planar_img_2 = sln::read_jpeg_planar(sln::MemoryReader({compressed_data.data(), compressed_data.size()}));
+  REQUIRE(planar_img_2.is_valid());
+  REQUIRE(planar_img_2.planes.size() == 3);
+  for (std::size_t c = 0; c < 3; ++c)
+  {
+    REQUIRE(planar_img_2.planes[c].width() == planes[c].width());
+    REQUIRE(planar_img_2.planes[c].height() == planes[c].height());
+  }
+
+  auto dyn_img = sln::read_jpeg(sln::MemoryReader({compressed_data.data(), compressed_data.size()}));
+  REQUIRE(dyn_img.is_valid());
+  REQUIRE(dyn_img.width() == duck_ref_width);
+  REQUIRE(dyn_img.height() == duck_ref_height);
+  REQUIRE(dyn_img.nr_channels() == 3);
+
+  // Planes with unsupported extents are rejected
+  sln::Image<std::uint8_t> odd_plane({300_px, 200_px});
+  std::vector<sln::ConstantImageView<std::uint8_t>> odd_planes = {planes[0], odd_plane.constant_view(), planes[2]};
+  compressed_data.clear();
+  REQUIRE(!sln::write_jpeg_planar(odd_planes, sln::VectorWriter(compressed_data)));
+}
+
 TEST_CASE("JPEG image writing / reusing compression object", "[img]")
 {
   const auto tmp_path = sln_test::get_tmp_path();
@@ -360,6 +566,64 @@ TEST_CASE("JPEG image reading and writing / reading/writing from/to memory", "[i
   REQUIRE(compressed_data.size() > 80000);  // conservative lower bound estimate; should be around 118000
 }
 
+TEST_CASE("JPEG image writing / directly into memory sinks", "[img]")
+{
+  const auto tmp_path = sln_test::get_tmp_path();
+  const auto dyn_img = sln::read_jpeg(sln::FileReader(sln_test::full_data_path("bike_duck.jpg").string()));
+  REQUIRE(dyn_img.is_valid());
+
+  sln::JPEGCompressionObject comp_obj;
+
+  // Write to file, as reference
+  {
+    sln::FileWriter sink((tmp_path / "test_duck_sinks.jpg").string());
+    REQUIRE(sln::write_jpeg(dyn_img, comp_obj, sink));
+  }
+  const auto ref_data = sln::read_file_contents((tmp_path / "test_duck_sinks.jpg").string());
+  REQUIRE(ref_data.has_value());
+
+  // Write to a vector, re-using the compression object
+  std::vector<std::uint8_t> vec_data;
+  REQUIRE(sln::write_jpeg(dyn_img, comp_obj, sln::VectorWriter(vec_data)));
+  REQUIRE(vec_data == *ref_data);
+
+  // Append to a vector with existing contents
+  std::vector<std::uint8_t> vec_data_append = {1, 2, 3};
+  {
+    sln::VectorWriter sink(vec_data_append, sln::WriterMode::Append);
+    REQUIRE(sln::write_jpeg(dyn_img, comp_obj, sink));
+    REQUIRE(sink.position() == static_cast<std::ptrdiff_t>(vec_data_append.size()));
+  }
+  REQUIRE(vec_data_append.size() == 3 + ref_data->size());
+  REQUIRE(std::equal(ref_data->cbegin(), ref_data->cend(), vec_data_append.cbegin() + 3));
+
+  // Write to a sufficiently large memory region
+  std::vector<std::uint8_t> mem_data(ref_data->size() + 100);
+  {
+    sln::MemoryWriter sink({mem_data.data(), mem_data.size()});
+    REQUIRE(sln::write_jpeg(dyn_img, comp_obj, sink));
+    REQUIRE(sink.position() == static_cast<std::ptrdiff_t>(ref_data->size()));
+  }
+  REQUIRE(std::equal(ref_data->cbegin(), ref_data->cend(), mem_data.cbegin()));
+
+  // Write to a memory region that is too small
+  {
+    sln::MemoryWriter sink({mem_data.data(), ref_data->size() / 2});
+    sln::MessageLog messages_write;
+    REQUIRE(!sln::write_jpeg(dyn_img, comp_obj, sink, sln::JPEGCompressionOptions(), &messages_write));
+    REQUIRE(!messages_write.messages().empty());
+    REQUIRE(sink.position() == 0);
+  }
+
+  // The compression object is still usable afterwards
+  {
+    sln::FileWriter sink((tmp_path / "test_duck_sinks.jpg").string());
+    sln::MessageLog messages_write;
+    REQUIRE(sln::write_jpeg(dyn_img, comp_obj, sink, sln::JPEGCompressionOptions(), &messages_write));
+    REQUIRE(messages_write.messages().empty());
+  }
+}
+
 TEST_CASE("JPEG image reading / through JPEGReader interface", "[img]")
 {
   const auto tmp_path = sln_test::get_tmp_path();
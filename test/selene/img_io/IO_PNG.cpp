@@ -10,8 +10,11 @@
 
 #include <catch2/catch.hpp>
 
+#include <algorithm>
+#include <array>
 #include <cstdlib>
 #include <cstring>
+#include <vector>
 
 #include <selene/base/io/FileReader.hpp>
 #include <selene/base/io/FileUtils.hpp>
@@ -300,6 +303,169 @@ TEST_CASE("PNG image reading and writing / reading/writing from/to memory", "[im
   REQUIRE(messages_write.messages().empty());
 }
 
+TEST_CASE("PNG image writing / compression options", "[img]")
+{
+  const auto dyn_img = sln::read_png(sln::FileReader(sln_test::full_data_path("bike_duck.png").string()));
+  REQUIRE(dyn_img.is_valid());
+
+  auto options_filtered = sln::PNGCompressionOptions(9);
+  options_filtered.filters = sln::PNGFilterSet::Paeth;
+  options_filtered.strategy = sln::PNGCompressionStrategy::Filtered;
+  options_filtered.window_bits = 10;
+  options_filtered.memory_level = 2;
+  options_filtered.buffer_size = 1000;
+
+  auto options_huffman = sln::PNGCompressionOptions(3);
+  options_huffman.filters = sln::PNGFilterSet::Fast;
+  options_huffman.strategy = sln::PNGCompressionStrategy::HuffmanOnly;
+
+  auto options_unfiltered = sln::PNGCompressionOptions(0);
+  options_unfiltered.filters = sln::PNGFilterSet::None;
+
+  const std::vector<sln::PNGCompressionOptions> all_options = {sln::PNGCompressionOptions(), options_filtered,
+                                                               options_huffman, options_unfiltered,
+                                                               sln::PNGCompressionOptions::fast()};
+
+  // Re-use the compression object, to check that the options do not leak into subsequent writes
+  sln::PNGCompressionObject obj;
+  std::vector<std::size_t> compressed_sizes;
+
+  for (const auto& options : all_options)
+  {
+    std::vector<std::uint8_t> compressed_data;
+    sln::MessageLog messages_write;
+    REQUIRE(sln::write_png(dyn_img, obj, sln::VectorWriter(compressed_data), options, &messages_write));
+    REQUIRE(messages_write.messages().empty());
+    compressed_sizes.push_back(compressed_data.size());
+
+    // Encoding is lossless, regardless of the options
+    const auto dyn_img_2 = sln::read_png(sln::MemoryReader({compressed_data.data(), compressed_data.size()}));
+    REQUIRE(dyn_img_2.is_valid());
+    REQUIRE(dyn_img_2.total_bytes() == dyn_img.total_bytes());
+    REQUIRE(std::equal(dyn_img.byte_ptr(), dyn_img.byte_ptr() + dyn_img.total_bytes(), dyn_img_2.byte_ptr()));
+  }
+
+  // Storing without compression is largest
+  REQUIRE(compressed_sizes[3] > static_cast<std::size_t>(dyn_img.total_bytes()));
+  REQUIRE(*std::max_element(compressed_sizes.cbegin(), compressed_sizes.cend()) == compressed_sizes[3]);
+
+  // Writing with default options again yields the same result as before
+  std::vector<std::uint8_t> compressed_data;
+  REQUIRE(sln::write_png(dyn_img, obj, sln::VectorWriter(compressed_data)));
+  REQUIRE(compressed_data.size() == compressed_sizes[0]);
+}
+
+TEST_CASE("PNG image writing / parallel compression", "[img]")
+{
+  const auto make_random_image = [](sln::PixelLength width, sln::PixelLength height, std::int16_t nr_channels,
+                                    std::int16_t nr_bytes_per_channel, sln::PixelFormat pixel_format) {
+    sln::DynImage<> img({width, height, nr_channels, nr_bytes_per_channel},
+                        {pixel_format, sln::SampleFormat::UnsignedInteger});
+    std::srand(42);
+    for (auto y = 0_idx; y < img.height(); ++y)
+    {
+      // Smooth-ish content, so that the choice of filter actually matters
+      const auto y_offset = static_cast<std::ptrdiff_t>(y) * 3;
+      for (std::ptrdiff_t i = 0; i < img.row_bytes(); ++i)
+      {
+        img.byte_ptr(y)[i] = static_cast<std::uint8_t>((i / 7 + y_offset + std::rand() % 8) & 0xFF);
+      }
+    }
+    return img;
+  };
+
+  std::vector<sln::DynImage<>> images;
+  images.push_back(sln::read_png(sln::FileReader(sln_test::full_data_path("bike_duck.png").string())));
+  images.push_back(sln::read_png(sln::FileReader(sln_test::full_data_path("stickers.png").string())));
+  images.push_back(make_random_image(333_px, 1111_px, 4, 2, sln::PixelFormat::RGBA));
+  images.push_back(make_random_image(2000_px, 257_px, 2, 1, sln::PixelFormat::YA));
+  images.push_back(make_random_image(1_px, 1_px, 1, 1, sln::PixelFormat::Y));
+
+  auto options_paeth = sln::PNGCompressionOptions(9);
+  options_paeth.filters = sln::PNGFilterSet::Paeth;
+  options_paeth.window_bits = 10;
+  options_paeth.memory_level = 2;
+
+  auto options_unfiltered = sln::PNGCompressionOptions(0);
+  options_unfiltered.filters = sln::PNGFilterSet::None;
+
+  auto options_transforms = sln::PNGCompressionOptions();
+  options_transforms.set_bgr = true;
+  options_transforms.invert_monochrome = true;
+  options_transforms.invert_alpha_channel = true;
+
+  auto options_endianness = sln::PNGCompressionOptions::fast();
+  options_endianness.keep_endianness = true;
+
+  const std::vector<sln::PNGCompressionOptions> all_options = {sln::PNGCompressionOptions(), options_paeth,
+                                                               options_unfiltered, options_transforms,
+                                                               options_endianness, sln::PNGCompressionOptions::fast()};
+
+  sln::PNGCompressionObject obj;
+
+  for (const auto& dyn_img : images)
+  {
+    REQUIRE(dyn_img.is_valid());
+
+    for (auto options : all_options)
+    {
+      // Single-threaded reference, written through the regular libpng code path
+      std::vector<std::uint8_t> reference_data;
+      REQUIRE(sln::write_png(dyn_img, obj, sln::VectorWriter(reference_data), options));
+      const auto reference_img = sln::read_png(sln::MemoryReader({reference_data.data(), reference_data.size()}));
+      REQUIRE(reference_img.is_valid());
+
+      std::vector<std::uint8_t> first_data;
+
+      for (const auto nr_threads : {2, 4, 0})
+      {
+        options.nr_threads = nr_threads;
+        std::vector<std::uint8_t> compressed_data;
+        sln::MessageLog messages_write;
+        REQUIRE(sln::write_png(dyn_img, obj, sln::VectorWriter(compressed_data), options, &messages_write));
+        REQUIRE(messages_write.messages().empty());
+
+        // The output does not depend on the number of threads
+        if (first_data.empty())
+        {
+          first_data = compressed_data;
+        }
+        REQUIRE(compressed_data == first_data);
+
+        // ...and decodes to the same image as the output of the regular code path
+        sln::MessageLog messages_read;
+        const auto dyn_img_2 = sln::read_png(sln::MemoryReader({compressed_data.data(), compressed_data.size()}),
+                                             sln::PNGDecompressionOptions(), &messages_read);
+        REQUIRE(messages_read.messages().empty());
+        REQUIRE(dyn_img_2.is_valid());
+        REQUIRE(dyn_img_2.total_bytes() == reference_img.total_bytes());
+        REQUIRE(std::equal(reference_img.byte_ptr(), reference_img.byte_ptr() + reference_img.total_bytes(),
+                           dyn_img_2.byte_ptr()));
+      }
+    }
+  }
+
+  // Each filter type (and each adaptive selection) round-trips through the libpng decoder
+  for (const auto filters : {sln::PNGFilterSet::Default, sln::PNGFilterSet::None, sln::PNGFilterSet::Sub,
+                             sln::PNGFilterSet::Up, sln::PNGFilterSet::Average, sln::PNGFilterSet::Paeth,
+                             sln::PNGFilterSet::Fast, sln::PNGFilterSet::All})
+  {
+    for (const auto& dyn_img : images)
+    {
+      auto options = sln::PNGCompressionOptions();
+      options.filters = filters;
+      options.nr_threads = 3;
+
+      std::vector<std::uint8_t> compressed_data;
+      REQUIRE(sln::write_png(dyn_img, obj, sln::VectorWriter(compressed_data), options));
+      const auto dyn_img_2 = sln::read_png(sln::MemoryReader({compressed_data.data(), compressed_data.size()}));
+      REQUIRE(dyn_img_2.is_valid());
+      REQUIRE(dyn_img_2.total_bytes() == dyn_img.total_bytes());
+      REQUIRE(std::equal(dyn_img.byte_ptr(), dyn_img.byte_ptr() + dyn_img.total_bytes(), dyn_img_2.byte_ptr()));
+    }
+  }
+}
+
 TEST_CASE("PNG reading of the official test suite", "[img]")
 {
   const auto tmp_path = sln_test::get_tmp_path();
@@ -459,4 +625,91 @@ TEST_CASE("PNG image reading / through PNGReader interface", "[img]")
 }
 
 
+TEST_CASE("PNG image reading / row streaming", "[img]")
+{
+  const auto test_suite_path = sln_test::full_data_path("png_suite");
+
+  // Compares the rows passed to the row function with the image read in one go
+  const auto check_rows = [](const sln::DynImage<>& dyn_img_ref, std::vector<std::uint8_t>& rows_data,
+                             std::ptrdiff_t& next_row) {
+    return [&dyn_img_ref, &rows_data, &next_row](sln::PixelIndex y, const std::uint8_t* row) {
+      REQUIRE(y == next_row);
+      ++next_row;
+      const auto row_bytes = static_cast<std::size_t>(dyn_img_ref.row_bytes());
+      rows_data.insert(rows_data.end(), row, row + row_bytes);
+    };
+  };
+
+  const auto ref_data = [](const sln::DynImage<>& dyn_img) {
+    return std::vector<std::uint8_t>(dyn_img.byte_ptr(), dyn_img.byte_ptr() + dyn_img.total_bytes());
+  };
+
+  for (const auto& e : sln_fs::directory_iterator(test_suite_path))
+  {
+    const auto is_broken = (e.path().stem().c_str()[0] == 'x');  // Broken image files begin with 'x'
+
+    if (e.path().extension() != ".png" || is_broken)
+    {
+      continue;
+    }
+
+    sln::FileReader source(e.path().string());
+    REQUIRE(source.is_open());
+    const auto dyn_img_ref = sln::read_png(source);
+    REQUIRE(dyn_img_ref.is_valid());
+    REQUIRE(dyn_img_ref.is_packed());
+
+    // Row streaming through PNGReader, in bands of a few rows
+    {
+      source.seek_abs(0);
+      sln::PNGReader<sln::FileReader> png_reader(source);
+
+      std::vector<std::uint8_t> rows_data;
+      std::ptrdiff_t next_row = 0;
+      const auto res = png_reader.read_image_rows(check_rows(dyn_img_ref, rows_data, next_row), 3_px);
+      REQUIRE(res);
+      REQUIRE(next_row == dyn_img_ref.height());
+      REQUIRE(rows_data == ref_data(dyn_img_ref));
+    }
+
+    // Progressive reading, pushing the data in small chunks
+    {
+      const auto file_contents = sln::read_file_contents(e.path().string());
+      REQUIRE(file_contents.has_value());
+
+      std::vector<std::uint8_t> rows_data;
+      std::ptrdiff_t next_row = 0;
+      sln::PNGProgressiveReader png_reader(check_rows(dyn_img_ref, rows_data, next_row));
+      REQUIRE(!png_reader.header_decoded());
+
+      constexpr std::size_t chunk_size = 97;
+      for (std::size_t i = 0; i < file_contents->size(); i += chunk_size)
+      {
+        const auto len = std::min(chunk_size, file_contents->size() - i);
+        REQUIRE(png_reader.push(file_contents->data() + i, len));
+      }
+
+      REQUIRE(!png_reader.error_state());
+      REQUIRE(png_reader.header_decoded());
+      REQUIRE(png_reader.finished());
+      REQUIRE(png_reader.get_output_image_info().width == dyn_img_ref.width());
+      REQUIRE(png_reader.get_output_image_info().height == dyn_img_ref.height());
+      REQUIRE(png_reader.get_pixel_format() == dyn_img_ref.pixel_format());
+      REQUIRE(next_row == dyn_img_ref.height());
+      REQUIRE(rows_data == ref_data(dyn_img_ref));
+    }
+  }
+
+  SECTION("Progressive reading of invalid data")
+  {
+    const std::array<std::uint8_t, 16> garbage = {};
+    sln::PNGProgressiveReader png_reader([](sln::PixelIndex, const std::uint8_t*) {});
+    REQUIRE(!png_reader.push(garbage.data(), garbage.size()));
+    REQUIRE(png_reader.error_state());
+    REQUIRE(!png_reader.header_decoded());
+    REQUIRE(!png_reader.push(garbage.data(), garbage.size()));
+  }
+}
+
+
 #endif  // defined(SELENE_WITH_LIBPNG)
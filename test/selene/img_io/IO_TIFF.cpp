@@ -29,9 +29,12 @@
 //#include <selene/img/interop/DynImageToImage.hpp>
 //#include <selene/img/interop/ImageToDynImage.hpp>
 
+#include <selene/img_io/tiff/PageIndex.hpp>
 #include <selene/img_io/tiff/Read.hpp>
 #include <selene/img_io/tiff/Write.hpp>
 
+#include <selene/img_ops/PlanarOperations.hpp>
+
 #include <test/utils/Utils.hpp>
 
 #include <wrappers/fs/Filesystem.hpp>
@@ -350,6 +353,14 @@ void write_multiple_tiff_directories(const sln::DynImage<>& ref_img, SinkArg&& s
   }
 }
 
+void check_dyn_images_equal(const sln::DynImage<>& img_0, const sln::DynImage<>& img_1)
+{
+  REQUIRE(img_0.is_valid());
+  REQUIRE(img_1.is_valid());
+  REQUIRE(img_0.total_bytes() == img_1.total_bytes());
+  REQUIRE(std::memcmp(img_0.byte_ptr(), img_1.byte_ptr(), img_0.total_bytes()) == 0);
+}
+
 }  // namespace _
 
 TEST_CASE("TIFF image writing / through TIFFWriter interface", "[img]")
@@ -391,4 +402,317 @@ TEST_CASE("TIFF image writing / through TIFFWriter interface", "[img]")
   }
 }
 
+TEST_CASE("TIFF page index", "[img]")
+{
+  const auto tmp_path = sln_test::get_tmp_path();
+  const auto ref_img = sln::read_tiff(sln::FileReader(sln_test::full_data_path("stickers_lzw.tif").string()));
+  REQUIRE(ref_img.is_valid());
+
+  // Write a multi-page file, with distinguishable pages
+  constexpr std::size_t nr_pages = 12;
+  std::vector<sln::DynImage<>> ref_pages;
+  const auto out_path = (tmp_path / "test_page_index.tif").string();
+
+  {
+    sln::FileWriter sink(out_path);
+    REQUIRE(sink.is_open());
+    sln::TIFFWriter tiff_writer{sink};
+
+    for (std::size_t i = 0; i < nr_pages; ++i)
+    {
+      auto page = ref_img;
+      page.byte_ptr()[0] = static_cast<std::uint8_t>(i);
+      tiff_writer.write_image_data(page);
+      ref_pages.push_back(std::move(page));
+    }
+
+    tiff_writer.finish_writing();
+    REQUIRE(tiff_writer.message_log().messages().empty());
+  }
+
+  const auto check_index = [&](sln::TIFFPageIndex& index) {
+    REQUIRE(index.is_open());
+    REQUIRE(index.nr_pages() == nr_pages);
+    REQUIRE(index.page_offset(0) > 0);
+    REQUIRE(index.page_offset(nr_pages) == 0);
+
+    // Random access to layouts and pages
+    for (const auto i : {std::size_t{7}, std::size_t{0}, std::size_t{11}, std::size_t{7}})
+    {
+      const auto layout = index.layout(i);
+      REQUIRE(layout);
+      REQUIRE(layout->width == stickers_ref_width);
+      REQUIRE(layout->height == stickers_ref_height);
+      REQUIRE(layout->samples_per_pixel == 3);
+      check_dyn_images_equal(index.read_page(i), ref_pages[i]);
+    }
+
+    REQUIRE(!index.layout(nr_pages));
+    sln::MessageLog message_log;
+    REQUIRE(!index.read_page(nr_pages, &message_log).is_valid());
+    REQUIRE(message_log.contains_errors());
+
+    // Reading into pre-allocated memory
+    sln::DynImage<> img(ref_img.layout(), ref_img.semantics());
+    auto view = img.view();
+    REQUIRE(index.read_page(3, view));
+    check_dyn_images_equal(img, ref_pages[3]);
+
+    // Parallel decoding of ranges and subsets
+    for (const int nr_threads : {1, 4, 0})
+    {
+      std::vector<sln::MessageLog> message_logs;
+      const auto pages = index.read_pages(2, 7, nr_threads, &message_logs);
+      REQUIRE(pages.size() == 7);
+      REQUIRE(message_logs.size() == 7);
+      for (std::size_t i = 0; i < pages.size(); ++i)
+      {
+        check_dyn_images_equal(pages[i], ref_pages[2 + i]);
+      }
+
+      REQUIRE(index.read_pages(10, 5, nr_threads).size() == 2);
+
+      const std::vector<std::size_t> indices = {9, 1, 1, nr_pages, 4};
+      const auto subset = index.read_pages(indices, nr_threads, &message_logs);
+      REQUIRE(subset.size() == indices.size());
+      check_dyn_images_equal(subset[0], ref_pages[9]);
+      check_dyn_images_equal(subset[1], ref_pages[1]);
+      check_dyn_images_equal(subset[2], ref_pages[1]);
+      REQUIRE(!subset[3].is_valid());
+      REQUIRE(message_logs[3].contains_errors());
+      check_dyn_images_equal(subset[4], ref_pages[4]);
+    }
+  };
+
+  sln::TIFFPageIndex file_index(out_path);
+  check_index(file_index);
+
+  const auto contents = sln::read_file_contents(out_path);
+  REQUIRE(contents);
+  sln::TIFFPageIndex memory_index(sln::ConstantMemoryRegion{contents->data(), contents->size()});
+  check_index(memory_index);
+
+  // Moving keeps the index usable
+  sln::TIFFPageIndex moved_index(std::move(memory_index));
+  REQUIRE(moved_index.nr_pages() == nr_pages);
+  check_dyn_images_equal(moved_index.read_page(5), ref_pages[5]);
+
+  // A moved-from index is not open, and can be re-opened
+  REQUIRE(!memory_index.is_open());
+  REQUIRE(memory_index.nr_pages() == 0);
+  sln::MessageLog not_open_message_log;
+  REQUIRE(!memory_index.read_page(0, &not_open_message_log).is_valid());
+  REQUIRE(not_open_message_log.messages().size() == 1);
+  REQUIRE(not_open_message_log.messages()[0].text.find("not open") != std::string::npos);
+  REQUIRE(memory_index.read_pages(0, 3).empty());
+  REQUIRE(memory_index.open(out_path));
+  check_dyn_images_equal(memory_index.read_page(5), ref_pages[5]);
+
+  // Reading from a closed index is reported as such
+  memory_index.close();
+  not_open_message_log.clear();
+  REQUIRE(!memory_index.read_page(0, &not_open_message_log).is_valid());
+  REQUIRE(not_open_message_log.messages()[0].text.find("not open") != std::string::npos);
+
+  // Non-TIFF data is rejected
+  sln::MessageLog message_log;
+  sln::TIFFPageIndex invalid_index(sln_test::full_data_path("bike_duck.png").string(), &message_log);
+  REQUIRE(!invalid_index.is_open());
+  REQUIRE(invalid_index.nr_pages() == 0);
+  REQUIRE(message_log.contains_errors());
+  REQUIRE(invalid_index.read_pages(0, 3).size() == 0);
+}
+
+
+TEST_CASE("TIFF pyramid writing", "[img]")
+{
+  const auto tmp_path = sln_test::get_tmp_path();
+  const auto ref_img = sln::read_tiff(sln::FileReader(sln_test::full_data_path("stickers_lzw.tif").string()));
+  REQUIRE(ref_img.is_valid());
+
+  auto write_options = sln::TIFFWriteOptions{sln::TIFFCompression::LZW};
+  write_options.tile_width = 64;
+  write_options.tile_height = 64;
+  const auto options = sln::TIFFPyramidOptions{write_options};
+
+  // Reference for the first reduced-resolution level: 2x2 averages of the full-resolution image
+  sln::DynImage<> ref_level(sln::UntypedLayout{sln::to_pixel_length(stickers_ref_width / 2),
+                                               sln::to_pixel_length(stickers_ref_height / 2), 3, 1},
+                            ref_img.semantics());
+  for (auto y = 0_idx; y < ref_level.height(); ++y)
+  {
+    for (auto x = 0_idx; x < ref_level.width(); ++x)
+    {
+      for (std::ptrdiff_t c = 0; c < 3; ++c)
+      {
+        const auto src_0 = ref_img.byte_ptr(sln::to_pixel_index(2 * x), sln::to_pixel_index(2 * y));
+        const auto src_1 = ref_img.byte_ptr(sln::to_pixel_index(2 * x), sln::to_pixel_index(2 * y + 1));
+        const auto sum = src_0[c] + src_0[3 + c] + src_1[c] + src_1[3 + c];
+        ref_level.byte_ptr(x, y)[c] = static_cast<std::uint8_t>((sum + 2) / 4);
+      }
+    }
+  }
+
+  // Stream the full-resolution image in bands of rows that are not aligned to the tile height
+  const auto out_path = (tmp_path / "test_pyramid.tif").string();
+  {
+    sln::FileWriter sink(out_path);
+    REQUIRE(sink.is_open());
+    sln::TIFFPyramidWriter<sln::FileWriter> writer(sink, ref_img.layout(), ref_img.semantics(), options);
+    REQUIRE(writer.nr_levels() == 4);
+
+    constexpr std::ptrdiff_t band_height = 37;
+    for (std::ptrdiff_t y = 0; y < stickers_ref_height; y += band_height)
+    {
+      const auto nr_rows = std::min(band_height, std::ptrdiff_t{stickers_ref_height} - y);
+      const auto band = sln::ConstantDynImageView{
+          ref_img.byte_ptr(sln::to_pixel_index(y)),
+          sln::UntypedLayout{ref_img.width(), sln::to_pixel_length(nr_rows), 3, 1, ref_img.stride_bytes()},
+          ref_img.semantics()};
+      REQUIRE(writer.write_rows(band));
+    }
+
+    REQUIRE(writer.nr_rows_written() == stickers_ref_height);
+    REQUIRE(writer.finish_writing());
+    REQUIRE(!writer.message_log().contains_errors());
+  }
+
+  const auto layouts = sln::read_tiff_layouts(sln::FileReader(out_path));
+  REQUIRE(layouts.size() == 4);
+  for (std::size_t i = 0; i < layouts.size(); ++i)
+  {
+    REQUIRE(layouts[i].width == std::uint32_t{stickers_ref_width} >> i);
+    REQUIRE(layouts[i].height == std::uint32_t{stickers_ref_height} >> i);
+    REQUIRE(layouts[i].samples_per_pixel == 3);
+    REQUIRE(layouts[i].subfile_type == (i == 0 ? 0u : 1u));  // FILETYPE_REDUCEDIMAGE
+  }
+
+  sln::TIFFPageIndex index(out_path);
+  REQUIRE(index.nr_pages() == 4);
+  check_dyn_images_equal(index.read_page(0), ref_img);
+  check_dyn_images_equal(index.read_page(1), ref_level);
+
+  // Limited number of levels, in memory, via the free function
+  {
+    std::vector<std::uint8_t> buffer;
+    sln::MessageLog message_log;
+    REQUIRE(sln::write_tiff_pyramid(ref_img, sln::VectorWriter(buffer), sln::TIFFPyramidOptions{write_options, 1},
+                                    &message_log));
+    REQUIRE(!message_log.contains_errors());
+
+    const auto mem_layouts = sln::read_tiff_layouts(sln::MemoryReader(sln::ConstantMemoryRegion{buffer.data(), buffer.size()}));
+    REQUIRE(mem_layouts.size() == 2);
+    check_dyn_images_equal(
+        sln::read_tiff(sln::MemoryReader(sln::ConstantMemoryRegion{buffer.data(), buffer.size()})), ref_img);
+  }
+
+  // Excess and missing rows are reported as errors
+  {
+    std::vector<std::uint8_t> buffer;
+    sln::VectorWriter sink(buffer);
+    sln::TIFFPyramidWriter<sln::VectorWriter> writer(sink, ref_img.layout(), ref_img.semantics(), options);
+    REQUIRE(writer.write_rows(ref_img.constant_view()));
+    REQUIRE(!writer.write_rows(ref_img));  // too many rows
+    REQUIRE(writer.finish_writing());
+    REQUIRE(writer.message_log().contains_errors());
+
+    REQUIRE(writer.open(sink, ref_img.layout(), ref_img.semantics(), options));
+    REQUIRE(!writer.finish_writing());
+    REQUIRE(writer.message_log().contains_errors());
+  }
+}
+
+TEST_CASE("TIFF planar reading and writing", "[img]")
+{
+  const auto ref_img = sln::read_tiff(sln::FileReader(sln_test::full_data_path("stickers_lzw.tif").string()));
+  REQUIRE(ref_img.is_valid());
+  REQUIRE(ref_img.nr_channels() == 3);
+
+  const auto check_planes = [](const sln::DynImage<>& img, const auto& planar) {
+    REQUIRE(planar.is_valid());
+    REQUIRE(planar.width() == img.width());
+    REQUIRE(planar.height() == img.height());
+    using T = typename std::remove_reference_t<decltype(planar)>::Element;
+    for (std::size_t c = 0; c < planar.nr_channels; ++c)
+    {
+      for (auto y = 0_idx; y < img.height(); ++y)
+      {
+        for (auto x = 0_idx; x < img.width(); ++x)
+        {
+          REQUIRE(planar.plane(c)(x, y) == reinterpret_cast<const T*>(img.byte_ptr(x, y))[c]);
+        }
+      }
+    }
+  };
+
+  // Reading of interleaved TIFF data into planes
+  sln::MessageLog message_log;
+  const auto planar = sln::read_tiff_planar<std::uint8_t, 3>(
+      sln::FileReader(sln_test::full_data_path("stickers_lzw.tif").string()), &message_log);
+  REQUIRE(!message_log.contains_errors());
+  check_planes(ref_img, planar);
+
+  // Mismatching number of channels
+  const auto planar_invalid = sln::read_tiff_planar<std::uint8_t, 4>(
+      sln::FileReader(sln_test::full_data_path("stickers_lzw.tif").string()), &message_log);
+  REQUIRE(!planar_invalid.is_valid());
+  REQUIRE(message_log.contains_errors());
+
+  // Writing and reading of separately stored (planar) TIFF data, as strips and as tiles
+  for (auto layout : {sln::TIFFWriteOptions::Layout::Strips, sln::TIFFWriteOptions::Layout::Tiles})
+  {
+    auto write_options = sln::TIFFWriteOptions{sln::TIFFCompression::LZW, 95, layout};
+    write_options.max_bytes_per_strip = 8 * 1024;
+    write_options.tile_width = 64;
+    write_options.tile_height = 64;
+
+    std::vector<std::uint8_t> buffer;
+    sln::MessageLog write_message_log;
+    REQUIRE(sln::write_tiff_planar(planar.constant_view(), sln::VectorWriter(buffer), sln::PixelFormat::Unknown,
+                                   write_options, &write_message_log));
+    REQUIRE(!write_message_log.contains_errors());
+
+    const auto layouts = sln::read_tiff_layouts(sln::MemoryReader(sln::ConstantMemoryRegion{buffer.data(), buffer.size()}));
+    REQUIRE(layouts.size() == 1);
+    REQUIRE(layouts[0].planar_config == sln::TIFFPlanarConfig::Separate);
+    REQUIRE(layouts[0].samples_per_pixel == 3);
+    REQUIRE(layouts[0].photometric == sln::TIFFPhotometricTag::RGB);
+
+    const auto img_read = sln::read_tiff(sln::MemoryReader(sln::ConstantMemoryRegion{buffer.data(), buffer.size()}));
+    REQUIRE(img_read.is_valid());
+    REQUIRE(img_read.total_bytes() == ref_img.total_bytes());
+    REQUIRE(std::memcmp(img_read.byte_ptr(), ref_img.byte_ptr(), ref_img.total_bytes()) == 0);
+
+    sln::MessageLog read_message_log;
+    const auto planar_read = sln::read_tiff_planar<std::uint8_t, 3>(sln::MemoryReader(sln::ConstantMemoryRegion{buffer.data(), buffer.size()}),
+                                                                    &read_message_log);
+    REQUIRE(!read_message_log.contains_errors());
+    check_planes(ref_img, planar_read);
+
+    // 16-bit data, with an odd image size
+    sln::PlanarImage<std::uint16_t, 4> planar_16u({sln::to_pixel_length(101), sln::to_pixel_length(77)});
+    sln::for_each_plane(planar_16u, [](auto& plane, std::size_t c) {
+      for (auto y = 0_idx; y < plane.height(); ++y)
+      {
+        for (auto x = 0_idx; x < plane.width(); ++x)
+        {
+          plane(x, y) = static_cast<std::uint16_t>(1000 * c + 100 * y + x);
+        }
+      }
+    });
+
+    std::vector<std::uint8_t> buffer_16u;
+    REQUIRE(sln::write_tiff_planar(planar_16u, sln::VectorWriter(buffer_16u), sln::PixelFormat::RGBA, write_options));
+
+    const auto img_16u = sln::read_tiff(sln::MemoryReader(sln::ConstantMemoryRegion{buffer_16u.data(), buffer_16u.size()}));
+    REQUIRE(img_16u.nr_channels() == 4);
+    REQUIRE(img_16u.nr_bytes_per_channel() == 2);
+    check_planes(img_16u, planar_16u);
+
+    const auto planar_16u_read = sln::read_tiff_planar<std::uint16_t, 4>(
+        sln::MemoryReader(sln::ConstantMemoryRegion{buffer_16u.data(), buffer_16u.size()}));
+    check_planes(img_16u, planar_16u_read);
+  }
+}
+
 #endif  // defined(SELENE_WITH_LIBTIFF)
@@ -0,0 +1,145 @@
+// This file is part of the `Selene` library.
+// Copyright 2017-2019 Michael Hofmann (https://github.com/kmhofmann).
+// Distributed under MIT license. See accompanying LICENSE file in the top-level directory.
+
+#include <catch2/catch.hpp>
+
+#include <selene/base/MessageLog.hpp>
+
+#include <selene/base/io/FileReader.hpp>
+#include <selene/base/io/FileUtils.hpp>
+#include <selene/base/io/MemoryReader.hpp>
+
+#include <selene/img_io/IO.hpp>
+#include <selene/img_io/ImageBatchDecoder.hpp>
+
+#include <test/utils/Utils.hpp>
+
+#include <wrappers/fs/Filesystem.hpp>
+
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace sln::literals;
+
+namespace {
+
+bool images_equal(const sln::DynImage<>& img_0, const sln::DynImage<>& img_1)
+{
+  if (img_0.is_valid() != img_1.is_valid())
+  {
+    return false;
+  }
+
+  if (!img_0.is_valid())
+  {
+    return true;
+  }
+
+  if (img_0.width() != img_1.width() || img_0.height() != img_1.height()
+      || img_0.nr_channels() != img_1.nr_channels() || img_0.nr_bytes_per_channel() != img_1.nr_bytes_per_channel())
+  {
+    return false;
+  }
+
+  for (auto y = 0_idx; y < img_0.height(); ++y)
+  {
+    if (!std::equal(img_0.byte_ptr(y), img_0.byte_ptr(y) + img_0.row_bytes(), img_1.byte_ptr(y)))
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+}  // namespace
+
+TEST_CASE("Image batch decoding", "[img]")
+{
+  // Collect a mix of file and memory sources, including some that cannot be decoded
+  std::vector<std::string> paths;
+  for (const auto& entry : sln_fs::directory_iterator(sln_test::full_data_path("png_suite")))
+  {
+    if (entry.path().extension() == ".png")
+    {
+      paths.push_back(entry.path().string());
+    }
+  }
+  std::sort(paths.begin(), paths.end());
+  paths.push_back(sln_test::full_data_path("bike_duck.jpg").string());
+  paths.push_back(sln_test::full_data_path("stickers.png").string());
+
+  const auto jpeg_contents = sln::read_file_contents(sln_test::full_data_path("bike_duck.jpg").string());
+  const auto png_contents = sln::read_file_contents(sln_test::full_data_path("bike_duck.png").string());
+  REQUIRE(jpeg_contents.has_value());
+  REQUIRE(png_contents.has_value());
+  const std::array<std::uint8_t, 16> garbage = {{0x42}};
+
+  std::vector<sln::ImageBatchSource> sources(paths.cbegin(), paths.cend());
+  sources.insert(sources.begin() + 1, sln::ConstantMemoryRegion{jpeg_contents->data(), jpeg_contents->size()});
+  sources.insert(sources.begin() + 5, sln::ConstantMemoryRegion{png_contents->data(), png_contents->size()});
+  sources.insert(sources.begin() + 7, sln::ConstantMemoryRegion{garbage.data(), garbage.size()});
+  sources.insert(sources.begin() + 9, std::string("/this/file/does/not/exist.png"));
+
+  // Reference: sequential decoding via read_image()
+  std::vector<sln::DynImage<>> ref_images;
+  for (const auto& source : sources)
+  {
+    if (const auto path = std::get_if<std::string>(&source))
+    {
+      sln::FileReader reader(*path);
+      ref_images.push_back(reader.is_open() ? sln::read_image(reader) : sln::DynImage<>{});
+    }
+    else
+    {
+      ref_images.push_back(sln::read_image(sln::MemoryReader(std::get<sln::ConstantMemoryRegion>(source))));
+    }
+  }
+
+  REQUIRE(!ref_images[7].is_valid());
+  REQUIRE(!ref_images[9].is_valid());
+
+  for (const auto& options : {sln::ImageBatchDecoderOptions(1, 1), sln::ImageBatchDecoderOptions(3, 1),
+                              sln::ImageBatchDecoderOptions(4), sln::ImageBatchDecoderOptions()})
+  {
+    sln::ImageBatchDecoder decoder(options);
+    REQUIRE(decoder.nr_threads() >= 1);
+    REQUIRE(decoder.max_nr_images_in_flight() >= 1);
+
+    // Results are delivered in order, via the result function...
+    std::size_t expected_index = 0;
+    decoder.decode(sources, [&](std::size_t index, sln::DynImage<> img, sln::MessageLog messages) {
+      REQUIRE(index == expected_index++);
+      REQUIRE(images_equal(img, ref_images[index]));
+      REQUIRE(messages.contains_errors() == !img.is_valid());
+    });
+    REQUIRE(expected_index == sources.size());
+
+    // ...or collectively, re-using the same decoder
+    std::vector<sln::MessageLog> message_logs;
+    const auto images = decoder.decode(sources, &message_logs);
+    REQUIRE(images.size() == sources.size());
+    REQUIRE(message_logs.size() == sources.size());
+    for (std::size_t i = 0; i < sources.size(); ++i)
+    {
+      REQUIRE(images_equal(images[i], ref_images[i]));
+    }
+    REQUIRE(message_logs[9].contains_errors());
+
+    // Exceptions from the result function are propagated, and the decoder stays usable
+    REQUIRE_THROWS_AS(decoder.decode(sources,
+                                     [](std::size_t index, sln::DynImage<>, const sln::MessageLog&) {
+                                       if (index == 2)
+                                       {
+                                         throw std::runtime_error("Stop");
+                                       }
+                                     }),
+                      std::runtime_error);
+    REQUIRE(decoder.decode(std::vector<sln::ImageBatchSource>{}).empty());
+    REQUIRE(images_equal(decoder.decode({sources[1]})[0], ref_images[1]));
+  }
+}
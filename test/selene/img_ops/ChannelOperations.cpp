@@ -11,6 +11,13 @@
 #include <selene/img/typed/ImageTypeAliases.hpp>
 
 #include <selene/img_ops/Fill.hpp>
+#include <selene/img_ops/View.hpp>
+
+#include <array>
+#include <cstdint>
+#include <random>
+
+#include <test/selene/img/typed/_Utils.hpp>
 
 using namespace sln::literals;
 
@@ -43,6 +50,62 @@ void check_channels(const Img& img, const std::array<std::uint8_t, N>& values)
   }
 }
 
+template <typename Element, std::size_t N, typename ImgStacked>
+void check_stacked_channels(const ImgStacked& img_stacked, const std::array<sln::Image<sln::Pixel<Element, 1>>, N>& imgs)
+{
+  static_assert(sln::PixelTraits<typename ImgStacked::PixelType>::nr_channels == N, "nr channels mismatch");
+
+  for (std::size_t c = 0; c < N; ++c)
+  {
+    REQUIRE(imgs[c].width() == img_stacked.width());
+    REQUIRE(imgs[c].height() == img_stacked.height());
+  }
+
+  for (auto y = 0_idx; y < img_stacked.height(); ++y)
+  {
+    for (auto x = 0_idx; x < img_stacked.width(); ++x)
+    {
+      for (std::size_t c = 0; c < N; ++c)
+      {
+        REQUIRE(img_stacked(x, y)[c] == imgs[c](x, y));
+      }
+    }
+  }
+}
+
+template <typename Element>
+void test_stack_and_split(std::mt19937& rng)
+{
+  using PixelType = sln::Pixel<Element, 1>;
+
+  for (auto width : {1, 7, 15, 16, 17, 33, 100})
+  {
+    const auto w = sln::PixelLength{width};
+    const auto h = sln::PixelLength{3};
+    const std::array<sln::Image<PixelType>, 4> imgs = {{sln_test::construct_random_image<PixelType>(w, h, rng),
+                                                        sln_test::construct_random_image<PixelType>(w, h, rng),
+                                                        sln_test::construct_random_image<PixelType>(w, h, rng),
+                                                        sln_test::construct_random_image<PixelType>(w, h, rng)}};
+
+    const auto img_2 = sln::stack_images(imgs[0], imgs[1]);
+    check_stacked_channels<Element, 2>(img_2, {{imgs[0], imgs[1]}});
+    check_stacked_channels<Element, 2>(img_2, sln::split_channels(img_2));
+
+    const auto img_3 = sln::stack_images<sln::PixelFormat::RGB>(imgs[0], imgs[1], imgs[2]);
+    check_stacked_channels<Element, 3>(img_3, {{imgs[0], imgs[1], imgs[2]}});
+    check_stacked_channels<Element, 3>(img_3, sln::split_channels(img_3));
+
+    const auto img_4 = sln::stack_images<sln::PixelFormat::RGBA>(imgs[0], imgs[1], imgs[2], imgs[3]);
+    check_stacked_channels<Element, 4>(img_4, {{imgs[0], imgs[1], imgs[2], imgs[3]}});
+    check_stacked_channels<Element, 4>(img_4, sln::split_channels(img_4));
+    check_stacked_channels<Element, 4>(img_4, sln::split_channels(sln::view(img_4)));
+
+    // Stacking of views, and of a mix of views and owning images
+    const auto img_4_v = sln::stack_images(sln::view(imgs[0]), imgs[1], sln::view(imgs[2]), sln::view(imgs[3]));
+    check_stacked_channels<Element, 4>(img_4_v, {{imgs[0], imgs[1], imgs[2], imgs[3]}});
+  }
+}
+
 }  // namespace
 
 
@@ -121,3 +184,29 @@ TEST_CASE("Channel stacking", "[old_img]")
     check_channels<6>(img_6, {{val_r, val_g, val_b, val_b, val_r, val_b}});
   }
 }
+
+TEST_CASE("Channel stacking and splitting / random images", "[img]")
+{
+  std::mt19937 rng(42);
+  test_stack_and_split<std::uint8_t>(rng);
+  test_stack_and_split<std::uint16_t>(rng);
+  test_stack_and_split<std::int32_t>(rng);
+  test_stack_and_split<float>(rng);
+  test_stack_and_split<double>(rng);
+}
+
+TEST_CASE("Channel splitting", "[img]")
+{
+  sln::ImageRGB_8u img_rgb({w_test, h_test});
+  sln::fill(img_rgb, sln::PixelRGB_8u{val_r, val_g, val_b});
+
+  const auto imgs = sln::split_channels(img_rgb);
+  REQUIRE(imgs.size() == 3);
+
+  for (std::size_t c = 0; c < imgs.size(); ++c)
+  {
+    REQUIRE(imgs[c].width() == w_test);
+    REQUIRE(imgs[c].height() == h_test);
+    check_channels<1>(imgs[c], {{values_rgb[c]}});
+  }
+}
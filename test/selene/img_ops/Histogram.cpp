@@ -0,0 +1,205 @@
+// This file is part of the `Selene` library.
+// Copyright 2017-2019 Michael Hofmann (https://github.com/kmhofmann).
+// Distributed under MIT license. See accompanying LICENSE file in the top-level directory.
+
+#include <catch2/catch.hpp>
+
+#include <selene/img_ops/Histogram.hpp>
+
+#include <selene/img/pixel/PixelTypeAliases.hpp>
+
+#include <selene/img/typed/ImageTypeAliases.hpp>
+
+#include <selene/img_ops/Fill.hpp>
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include <test/selene/img/typed/_Utils.hpp>
+
+using namespace sln::literals;
+
+namespace {
+
+template <typename PixelType>
+void check_histograms(const sln::Image<PixelType>& img, const sln::BoundingBox& region)
+{
+  using T = typename sln::PixelTraits<PixelType>::Element;
+  constexpr auto nr_channels = static_cast<std::size_t>(sln::PixelTraits<PixelType>::nr_channels);
+  constexpr auto nr_bins = std::size_t{1} << (8 * sizeof(T));
+
+  std::array<sln::HistogramBins, nr_channels> ref_per_channel;
+  sln::HistogramBins ref_joint(nr_bins, 0);
+  std::array<sln::HistogramBins, nr_channels> ref_region;
+  for (std::size_t c = 0; c < nr_channels; ++c)
+  {
+    ref_per_channel[c].assign(nr_bins, 0);
+    ref_region[c].assign(nr_bins, 0);
+  }
+
+  for (auto y = 0_idx; y < img.height(); ++y)
+  {
+    for (auto x = 0_idx; x < img.width(); ++x)
+    {
+      const bool in_region = x >= region.x0() && x < region.x1() && y >= region.y0() && y < region.y1();
+      for (std::size_t c = 0; c < nr_channels; ++c)
+      {
+        const auto v = img(x, y)[c];
+        ++ref_per_channel[c][v];
+        ++ref_joint[v];
+        ref_region[c][v] += in_region ? 1 : 0;
+      }
+    }
+  }
+
+  for (int nr_threads : {1, 3, 0})
+  {
+    const auto per_channel = sln::histogram(img, nr_threads);
+    const auto joint = sln::histogram<sln::HistogramMode::Joint>(img, nr_threads);
+    const auto in_region = sln::histogram(img, region, nr_threads);
+
+    REQUIRE(joint.size() == 1);
+    REQUIRE(joint[0] == ref_joint);
+    for (std::size_t c = 0; c < nr_channels; ++c)
+    {
+      REQUIRE(per_channel[c] == ref_per_channel[c]);
+      REQUIRE(in_region[c] == ref_region[c]);
+    }
+  }
+}
+
+}  // namespace _
+
+TEST_CASE("Histogram computation", "[img]")
+{
+  std::mt19937 rng(42);
+
+  // 16-bit histograms are only split into several tasks for larger images, due to the size of the bins.
+  auto sizes = sln_test::reference_test_sizes();
+  const auto large_sizes = sln_test::parallel_test_sizes();
+  sizes.insert(sizes.end(), large_sizes.cbegin(), large_sizes.cend());
+  sizes.emplace_back(1280_px, 960_px);
+
+  for (const auto& [w, h] : sizes)
+  {
+    const auto region = sln::BoundingBox(sln::PixelIndex{static_cast<std::int32_t>(w) / 3},
+                                         sln::PixelIndex{static_cast<std::int32_t>(h) / 4}, 100_px, 100_px);
+
+    check_histograms(sln_test::construct_random_image<sln::Pixel_8u1>(w, h, rng), region);
+    check_histograms(sln_test::construct_random_image<sln::Pixel_8u3>(w, h, rng), region);
+    check_histograms(sln_test::construct_random_image<sln::Pixel_16u1>(w, h, rng), region);
+    check_histograms(sln_test::construct_random_image<sln::Pixel_16u2>(w, h, rng), region);
+  }
+
+  // Runs of equal values (counted in different sub-histograms)
+  sln::Image_8u1 img({100_px, 50_px});
+  sln::fill(img, sln::Pixel_8u1(7));
+  const auto hist = sln::histogram(img, 2);
+  REQUIRE(hist[0][7] == 100 * 50);
+  REQUIRE(std::accumulate(hist[0].cbegin(), hist[0].cend(), std::uint64_t{0}) == 100 * 50);
+
+  const auto empty_hist = sln::histogram(sln::Image_16u1{});
+  REQUIRE(empty_hist[0].size() == 65536);
+  REQUIRE(std::accumulate(empty_hist[0].cbegin(), empty_hist[0].cend(), std::uint64_t{0}) == 0);
+}
+
+TEST_CASE("Histogram equalization", "[img]")
+{
+  // Values 100..149, each occurring 10 times, are stretched to the full range.
+  sln::Image_8u1 img({50_px, 10_px});
+  for (auto y = 0_idx; y < img.height(); ++y)
+  {
+    for (auto x = 0_idx; x < img.width(); ++x)
+    {
+      img(x, y) = static_cast<std::uint8_t>(100 + x);
+    }
+  }
+
+  const auto img_eq = sln::equalize_histogram(img);
+  REQUIRE(img_eq.width() == img.width());
+  REQUIRE(img_eq.height() == img.height());
+  REQUIRE(img_eq(0_idx, 0_idx) == 0);
+  REQUIRE(img_eq(49_idx, 9_idx) == 255);
+
+  for (auto y = 0_idx; y < img.height(); ++y)
+  {
+    for (auto x = 1_idx; x < img.width(); ++x)
+    {
+      REQUIRE(img_eq(x, y) > img_eq(x - 1, y));
+      REQUIRE(img_eq(x, y) == img_eq(x, 0_idx));
+    }
+  }
+
+  // In-place equalization gives the same result
+  auto img_in_place = img;
+  sln::equalize_histogram(img_in_place, img_in_place, 3);
+  REQUIRE(sln::equal(img_in_place, img_eq));
+
+  // Constant channels remain unchanged
+  sln::Image_16u1 img_const({20_px, 20_px});
+  sln::fill(img_const, sln::Pixel_16u1(1000));
+  const auto img_const_eq = sln::equalize_histogram(img_const);
+  REQUIRE(img_const_eq(5_idx, 5_idx) == 1000);
+}
+
+TEST_CASE("Contrast limited adaptive histogram equalization", "[img]")
+{
+  std::mt19937 rng(42);
+
+  // Without clipping and with one tile, CLAHE reduces to a plain (non-offset) histogram equalization.
+  const auto img = sln_test::construct_random_image<sln::Pixel_8u1>(64_px, 48_px, rng);
+  const auto img_ahe = sln::clahe(img, 1, 1, 0.0);
+  const auto hist = sln::histogram(img);
+  std::uint64_t cdf = 0;
+  std::vector<std::uint8_t> lut(256);
+  for (std::size_t v = 0; v < 256; ++v)
+  {
+    cdf += hist[0][v];
+    lut[v] = static_cast<std::uint8_t>(std::round(static_cast<double>(cdf) * 255.0 / (64.0 * 48.0)));
+  }
+
+  for (auto y = 0_idx; y < img.height(); ++y)
+  {
+    for (auto x = 0_idx; x < img.width(); ++x)
+    {
+      REQUIRE(img_ahe(x, y) == lut[img(x, y)]);
+    }
+  }
+
+  // Results are independent of the number of threads (the image is large enough to be split into several tasks)
+  sln::Image_16u3 img_16({400_px, 240_px});
+  for (auto y = 0_idx; y < img_16.height(); ++y)
+  {
+    for (auto x = 0_idx; x < img_16.width(); ++x)
+    {
+      img_16(x, y) = sln::Pixel_16u3(static_cast<std::uint16_t>(x * 100 + y), static_cast<std::uint16_t>(y * 10),
+                                     static_cast<std::uint16_t>(30000));
+    }
+  }
+
+  const auto img_16_1 = sln::clahe(img_16, 4, 3, 2.0, 1);
+  const auto img_16_n = sln::clahe(img_16, 4, 3, 2.0, 3);
+  REQUIRE(img_16_1.width() == img_16.width());
+  REQUIRE(img_16_1.height() == img_16.height());
+  REQUIRE(sln::equal(img_16_1, img_16_n));
+
+  // Clipping limits the contrast enhancement of a constant channel
+  for (auto y = 0_idx; y < img_16.height(); ++y)
+  {
+    for (auto x = 0_idx; x < img_16.width(); ++x)
+    {
+      REQUIRE(img_16_1(x, y)[2] == img_16_1(0_idx, 0_idx)[2]);
+    }
+  }
+
+  // More tiles than pixels
+  sln::Image_8u1 img_small({3_px, 2_px});
+  sln::fill(img_small, sln::Pixel_8u1(50));
+  const auto img_small_eq = sln::clahe(img_small, 8, 8);
+  REQUIRE(img_small_eq.width() == 3_px);
+  REQUIRE(img_small_eq.height() == 2_px);
+}
@@ -0,0 +1,166 @@
+// This file is part of the `Selene` library.
+// Copyright 2017-2019 Michael Hofmann (https://github.com/kmhofmann).
+// Distributed under MIT license. See accompanying LICENSE file in the top-level directory.
+
+#include <catch2/catch.hpp>
+
+#include <selene/img_ops/Lut.hpp>
+
+#include <selene/img/pixel/PixelTypeAliases.hpp>
+
+#include <selene/img/typed/ImageTypeAliases.hpp>
+
+#include <selene/img_ops/View.hpp>
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <random>
+
+#include <test/selene/img/typed/_Utils.hpp>
+
+using namespace sln::literals;
+
+namespace {
+
+constexpr auto inversion_lut = sln::make_lut<std::uint8_t>([](std::uint8_t v) {
+  return static_cast<std::uint8_t>(255 - v);
+});
+
+static_assert(inversion_lut[0] == 255);
+static_assert(inversion_lut[200] == 55);
+
+template <typename ImgSrc, typename ImgDst, typename Function>
+void check_mapped(const ImgSrc& img_src, const ImgDst& img_dst, Function func)
+{
+  using PixelType = typename ImgSrc::PixelType;
+  constexpr auto nr_channels = static_cast<std::size_t>(sln::PixelTraits<PixelType>::nr_channels);
+
+  REQUIRE(img_dst.width() == img_src.width());
+  REQUIRE(img_dst.height() == img_src.height());
+
+  for (auto y = 0_idx; y < img_src.height(); ++y)
+  {
+    for (auto x = 0_idx; x < img_src.width(); ++x)
+    {
+      for (std::size_t c = 0; c < nr_channels; ++c)
+      {
+        REQUIRE(img_dst(x, y)[c] == func(img_src(x, y)[c], c));
+      }
+    }
+  }
+}
+
+}  // namespace _
+
+TEST_CASE("Look-up table construction", "[img]")
+{
+  // Tables for 16-bit inputs are allocated on the heap
+  static_assert(sizeof(sln::Lut<std::uint16_t, float>) < 1024);
+  static_assert(sizeof(sln::Lut<std::uint8_t, float>) == 256 * sizeof(float));
+
+  const auto lut = sln::make_lut<std::uint16_t, float>([](std::uint16_t v) { return float(v) / 65535.0f; });
+  REQUIRE(lut.nr_entries == 65536);
+  REQUIRE(lut[0] == 0.0f);
+  REQUIRE(lut[65535] == 1.0f);
+
+  auto lut_copy = lut;
+  lut_copy[65535] = 2.0f;
+  REQUIRE(lut_copy[65535] == 2.0f);
+  REQUIRE(lut[65535] == 1.0f);
+  REQUIRE(lut_copy.data() != lut.data());
+
+  sln::Lut<std::uint16_t> lut_16u_default;
+  REQUIRE(lut_16u_default[0] == 0);
+  REQUIRE(lut_16u_default[65535] == 0);
+
+  sln::Lut<std::uint8_t> lut_default;
+  REQUIRE(lut_default[17] == 0);
+  lut_default[17] = 42;
+  REQUIRE(lut_default[17] == 42);
+  REQUIRE(lut_default.data()[17] == 42);
+}
+
+TEST_CASE("Look-up table application", "[img]")
+{
+  std::mt19937 rng(42);
+
+  auto sizes = sln_test::reference_test_sizes();
+  const auto large_sizes = sln_test::parallel_test_sizes();
+  sizes.insert(sizes.end(), large_sizes.cbegin(), large_sizes.cend());
+
+  for (const auto& [w, h] : sizes)
+  {
+    // 8-bit, one table for all channels
+    const auto img_8u3 = sln_test::construct_random_image<sln::Pixel_8u3>(w, h, rng);
+    const auto img_8u3_inv = sln::apply_lut(img_8u3, inversion_lut);
+    static_assert(std::is_same_v<std::remove_cv_t<decltype(img_8u3_inv)>, sln::Image_8u3>);
+    check_mapped(img_8u3, img_8u3_inv, [](std::uint8_t v, std::size_t) { return static_cast<std::uint8_t>(255 - v); });
+
+    // In place, on a view
+    auto img_8u3_copy = img_8u3;
+    auto view_8u3 = sln::view(img_8u3_copy);
+    sln::apply_lut(view_8u3, view_8u3, inversion_lut);
+    REQUIRE(sln::equal(img_8u3_copy, img_8u3_inv));
+
+    // 8-bit to float
+    const auto lut_float = sln::make_lut<std::uint8_t, float>([](std::uint8_t v) { return std::sqrt(float(v)); });
+    const auto img_8u3_float = sln::apply_lut(img_8u3, lut_float);
+    check_mapped(img_8u3, img_8u3_float, [](std::uint8_t v, std::size_t) { return std::sqrt(float(v)); });
+
+    // 8-bit, per-channel tables
+    const std::array<sln::Lut<std::uint8_t>, 3> luts_8u = {
+        sln::make_lut<std::uint8_t>([](std::uint8_t v) { return static_cast<std::uint8_t>(v / 2); }),
+        sln::make_lut<std::uint8_t>([](std::uint8_t v) { return static_cast<std::uint8_t>(v ^ 0x5A); }),
+        inversion_lut};
+    const auto img_8u3_per_channel = sln::apply_lut(img_8u3, luts_8u);
+    check_mapped(img_8u3, img_8u3_per_channel, [&luts_8u](std::uint8_t v, std::size_t c) { return luts_8u[c][v]; });
+
+    // 16-bit, per-channel tables
+    const auto img_16u4 = sln_test::construct_random_image<sln::Pixel_16u4>(w, h, rng);
+    std::array<sln::Lut<std::uint16_t>, 4> luts_16u;
+    for (std::size_t c = 0; c < 4; ++c)
+    {
+      luts_16u[c] = sln::Lut<std::uint16_t>(
+          [c](std::uint16_t v) { return static_cast<std::uint16_t>(v * (c + 1) + 7); });
+    }
+
+    const auto img_16u4_per_channel = sln::apply_lut(img_16u4, luts_16u);
+    check_mapped(img_16u4, img_16u4_per_channel, [](std::uint16_t v, std::size_t c) {
+      return static_cast<std::uint16_t>(v * (c + 1) + 7);
+    });
+
+    sln::Image_16u4 img_16u4_in_place = img_16u4;
+    sln::apply_lut(img_16u4_in_place, img_16u4_in_place, luts_16u);
+    REQUIRE(sln::equal(img_16u4_in_place, img_16u4_per_channel));
+  }
+}
+
+TEST_CASE("Look-up table palette expansion", "[img]")
+{
+  const auto palette = sln::make_lut<std::uint8_t, sln::PixelRGB_8u>([](std::uint8_t v) {
+    return sln::PixelRGB_8u(v, static_cast<std::uint8_t>(255 - v), static_cast<std::uint8_t>(v / 2));
+  });
+
+  sln::Image_8u1 img({5_px, 3_px});
+  for (auto y = 0_idx; y < img.height(); ++y)
+  {
+    for (auto x = 0_idx; x < img.width(); ++x)
+    {
+      img(x, y) = static_cast<std::uint8_t>(x * 40 + y);
+    }
+  }
+
+  const auto img_rgb = sln::apply_lut(img, palette);
+  static_assert(std::is_same_v<std::remove_cv_t<decltype(img_rgb)>, sln::Image<sln::PixelRGB_8u>>);
+  REQUIRE(img_rgb.width() == img.width());
+  REQUIRE(img_rgb.height() == img.height());
+
+  for (auto y = 0_idx; y < img.height(); ++y)
+  {
+    for (auto x = 0_idx; x < img.width(); ++x)
+    {
+      REQUIRE(img_rgb(x, y) == palette[img(x, y)]);
+    }
+  }
+}
@@ -0,0 +1,134 @@
+// This file is part of the `Selene` library.
+// Copyright 2017-2019 Michael Hofmann (https://github.com/kmhofmann).
+// Distributed under MIT license. See accompanying LICENSE file in the top-level directory.
+
+#include <catch2/catch.hpp>
+
+#include <selene/img_ops/MedianFilter.hpp>
+
+#include <selene/img/pixel/PixelTypeAliases.hpp>
+
+#include <selene/img/typed/ImageTypeAliases.hpp>
+
+#include <selene/img_ops/Fill.hpp>
+#include <selene/img_ops/View.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include <test/selene/img/typed/_Utils.hpp>
+
+using namespace sln::literals;
+
+namespace {
+
+template <sln::BorderAccessMode access_mode, typename DerivedSrc>
+auto median_filter_reference(const sln::ImageBase<DerivedSrc>& img, std::int32_t radius)
+{
+  using PixelType = typename DerivedSrc::PixelType;
+  constexpr auto nr_channels = static_cast<std::size_t>(sln::PixelTraits<PixelType>::nr_channels);
+
+  sln::Image<PixelType> img_dst({img.width(), img.height()});
+  std::vector<std::uint8_t> values;
+  for (auto y = 0_idx; y < img.height(); ++y)
+  {
+    for (auto x = 0_idx; x < img.width(); ++x)
+    {
+      for (std::size_t c = 0; c < nr_channels; ++c)
+      {
+        values.clear();
+        for (auto dy = -radius; dy <= radius; ++dy)
+        {
+          for (auto dx = -radius; dx <= radius; ++dx)
+          {
+            values.push_back(sln::ImageBorderAccessor<access_mode>::access(img, sln::PixelIndex{x + dx},
+                                                                           sln::PixelIndex{y + dy})[c]);
+          }
+        }
+
+        const auto mid = values.begin() + static_cast<std::ptrdiff_t>(values.size() / 2);
+        std::nth_element(values.begin(), mid, values.end());
+        img_dst(x, y)[c] = *mid;
+      }
+    }
+  }
+  return img_dst;
+}
+
+template <typename PixelType, typename RNG>
+void check_median_filter(sln::PixelLength width, sln::PixelLength height, RNG& rng)
+{
+  const auto img = sln_test::construct_random_image<PixelType>(width, height, rng);
+
+  for (auto radius : {0, 1, 2, 3, 6, 15})
+  {
+    const auto ref_replicated = median_filter_reference<sln::BorderAccessMode::Replicated>(img, radius);
+    const auto ref_zero = median_filter_reference<sln::BorderAccessMode::ZeroPadding>(img, radius);
+
+    for (int nr_threads : {1, 3})
+    {
+      const auto r = static_cast<std::size_t>(radius);
+      REQUIRE(sln::equal(sln::median_filter(img, r, nr_threads), ref_replicated));
+      REQUIRE(sln::equal(sln::median_filter<sln::BorderAccessMode::ZeroPadding>(img, r, nr_threads), ref_zero));
+    }
+  }
+}
+
+}  // namespace _
+
+TEST_CASE("Median filter", "[img]")
+{
+  std::mt19937 rng(42);
+
+  for (const auto& [w, h] : sln_test::reference_test_sizes())
+  {
+    check_median_filter<sln::Pixel_8u1>(w, h, rng);
+    check_median_filter<sln::Pixel_8u3>(w, h, rng);
+  }
+
+  // Images large enough to be split into several row bands give the same results for any number of threads
+  for (const auto& [w, h] : sln_test::parallel_test_sizes())
+  {
+    const auto img_large = sln_test::construct_random_image<sln::Pixel_8u3>(w, h, rng);
+    for (std::size_t radius : {1, 2, 6, 40})
+    {
+      const auto img_filtered_1 = sln::median_filter(img_large, radius, 1);
+      REQUIRE(sln::equal(sln::median_filter(img_large, radius, 3), img_filtered_1));
+      REQUIRE(sln::equal(sln::median_filter(img_large, radius, 5), img_filtered_1));
+    }
+  }
+
+  // Unchecked access on a view into a larger image gives the same result as accessing the larger image directly.
+  const auto img = sln_test::construct_random_image<sln::Pixel_8u2>(80_px, 60_px, rng);
+  const auto region = sln::BoundingBox(20_idx, 15_idx, 40_px, 30_px);
+  for (std::size_t radius : {1, 2, 7})
+  {
+    const auto img_filtered = sln::median_filter<sln::BorderAccessMode::Unchecked>(sln::view(img, region), radius);
+    const auto img_filtered_ref = sln::median_filter(img, radius);
+    REQUIRE(sln::equal(img_filtered, sln::view(img_filtered_ref, region)));
+  }
+
+  // Salt-and-pepper noise is removed
+  sln::Image_8u1 img_noisy({40_px, 30_px});
+  sln::fill(img_noisy, sln::Pixel_8u1(100));
+  std::uniform_int_distribution<std::int32_t> die_x(0, 39);
+  std::uniform_int_distribution<std::int32_t> die_y(0, 29);
+  for (int i = 0; i < 60; ++i)
+  {
+    img_noisy(sln::PixelIndex{die_x(rng)}, sln::PixelIndex{die_y(rng)}) = (i % 2 == 0) ? 0 : 255;
+  }
+
+  for (std::size_t radius : {2, 4})
+  {
+    const auto img_denoised = sln::median_filter(img_noisy, radius);
+    for (auto y = 0_idx; y < img_denoised.height(); ++y)
+    {
+      for (auto x = 0_idx; x < img_denoised.width(); ++x)
+      {
+        REQUIRE(img_denoised(x, y) == 100);
+      }
+    }
+  }
+}
@@ -0,0 +1,182 @@
+// This file is part of the `Selene` library.
+// Copyright 2017-2019 Michael Hofmann (https://github.com/kmhofmann).
+// Distributed under MIT license. See accompanying LICENSE file in the top-level directory.
+
+#include <catch2/catch.hpp>
+
+#include <selene/img_ops/Morphology.hpp>
+
+#include <selene/img/pixel/PixelTypeAliases.hpp>
+
+#include <selene/img/typed/ImageTypeAliases.hpp>
+
+#include <selene/img_ops/Fill.hpp>
+#include <selene/img_ops/View.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include <test/selene/img/typed/_Utils.hpp>
+
+using namespace sln::literals;
+
+namespace {
+
+template <bool is_erosion, sln::BorderAccessMode access_mode, typename DerivedSrc>
+auto morphology_reference(const sln::ImageBase<DerivedSrc>& img, const sln::StructuringElement& se)
+{
+  using PixelType = typename DerivedSrc::PixelType;
+  constexpr auto nr_channels = static_cast<std::size_t>(sln::PixelTraits<PixelType>::nr_channels);
+
+  const auto x_off = static_cast<std::int32_t>((se.width() - 1) / 2);
+  const auto y_off = static_cast<std::int32_t>((se.height() - 1) / 2);
+  const bool is_cross = se.shape() == sln::StructuringElementShape::Cross;
+
+  sln::Image<PixelType> img_dst({img.width(), img.height()});
+  for (auto y = 0_idx; y < img.height(); ++y)
+  {
+    for (auto x = 0_idx; x < img.width(); ++x)
+    {
+      auto res = sln::ImageBorderAccessor<access_mode>::access(img, x, y);
+      for (std::int32_t dy = 0; dy < se.height(); ++dy)
+      {
+        for (std::int32_t dx = 0; dx < se.width(); ++dx)
+        {
+          if (is_cross && dx != x_off && dy != y_off)
+          {
+            continue;
+          }
+
+          const auto px = sln::ImageBorderAccessor<access_mode>::access(img, sln::PixelIndex{x + dx - x_off},
+                                                                         sln::PixelIndex{y + dy - y_off});
+          for (std::size_t c = 0; c < nr_channels; ++c)
+          {
+            res[c] = is_erosion ? std::min(res[c], px[c]) : std::max(res[c], px[c]);
+          }
+        }
+      }
+      img_dst(x, y) = res;
+    }
+  }
+  return img_dst;
+}
+
+template <sln::BorderAccessMode access_mode, typename PixelType>
+void check_erosion_dilation(const sln::Image<PixelType>& img, const sln::StructuringElement& se)
+{
+  const auto img_eroded = sln::erode<access_mode>(img, se);
+  const auto img_dilated = sln::dilate<access_mode>(img, se);
+  REQUIRE(sln::equal(img_eroded, morphology_reference<true, access_mode>(img, se)));
+  REQUIRE(sln::equal(img_dilated, morphology_reference<false, access_mode>(img, se)));
+}
+
+template <typename PixelType, typename RNG>
+void check_all_modes(sln::PixelLength width, sln::PixelLength height, RNG& rng)
+{
+  const auto img = sln_test::construct_random_image<PixelType>(width, height, rng);
+
+  for (auto shape : {sln::StructuringElementShape::Rectangle, sln::StructuringElementShape::Cross})
+  {
+    const std::vector<std::pair<sln::PixelLength, sln::PixelLength>> se_sizes = {
+        {1_px, 1_px}, {3_px, 3_px}, {5_px, 5_px}, {4_px, 1_px}, {1_px, 8_px}, {9_px, 7_px}, {22_px, 31_px}};
+    for (const auto& [se_width, se_height] : se_sizes)
+    {
+      const auto se = sln::StructuringElement(se_width, se_height, shape);
+      check_erosion_dilation<sln::BorderAccessMode::Replicated>(img, se);
+      check_erosion_dilation<sln::BorderAccessMode::ZeroPadding>(img, se);
+    }
+  }
+}
+
+}  // namespace _
+
+TEST_CASE("Morphological erosion and dilation", "[img]")
+{
+  std::mt19937 rng(42);
+
+  for (const auto& [w, h] : sln_test::reference_test_sizes())
+  {
+    check_all_modes<sln::Pixel_8u1>(w, h, rng);
+    check_all_modes<sln::Pixel_8u3>(w, h, rng);
+    check_all_modes<sln::Pixel_16u1>(w, h, rng);
+    check_all_modes<sln::Pixel_32f2>(w, h, rng);
+  }
+
+  // Unchecked access on a view into a larger image gives the same result as accessing the larger image directly.
+  const auto img = sln_test::construct_random_image<sln::Pixel_8u1>(80_px, 60_px, rng);
+  const auto region = sln::BoundingBox(20_idx, 15_idx, 40_px, 30_px);
+  for (auto shape : {sln::StructuringElementShape::Rectangle, sln::StructuringElementShape::Cross})
+  {
+    for (auto k : {3, 11})
+    {
+      const auto se = sln::StructuringElement(sln::PixelLength{k}, sln::PixelLength{k}, shape);
+      const auto img_eroded = sln::erode<sln::BorderAccessMode::Unchecked>(sln::view(img, region), se);
+      const auto img_eroded_ref = sln::erode(img, se);
+      REQUIRE(sln::equal(img_eroded, sln::view(img_eroded_ref, region)));
+    }
+  }
+
+  // In place
+  auto img_in_place = img;
+  const auto se = sln::StructuringElement(7_px, 7_px, sln::StructuringElementShape::Cross);
+  sln::dilate(img_in_place, img_in_place, se);
+  REQUIRE(sln::equal(img_in_place, sln::dilate(img, se)));
+}
+
+TEST_CASE("Morphological compound operations", "[img]")
+{
+  std::mt19937 rng(42);
+  const auto img = sln_test::construct_random_image<sln::Pixel_8u3>(50_px, 40_px, rng);
+  const auto se = sln::StructuringElement(7_px, 5_px);
+
+  const auto img_eroded = sln::erode(img, se);
+  const auto img_dilated = sln::dilate(img, se);
+  const auto img_opened = sln::opening(img, se);
+  const auto img_closed = sln::closing(img, se);
+  REQUIRE(sln::equal(img_opened, sln::dilate(img_eroded, se)));
+  REQUIRE(sln::equal(img_closed, sln::erode(img_dilated, se)));
+
+  const auto img_gradient = sln::morphological_gradient(img, se);
+  const auto img_top_hat = sln::top_hat(img, se);
+  const auto img_black_hat = sln::black_hat(img, se);
+
+  for (auto y = 0_idx; y < img.height(); ++y)
+  {
+    for (auto x = 0_idx; x < img.width(); ++x)
+    {
+      for (std::size_t c = 0; c < 3; ++c)
+      {
+        REQUIRE(img_opened(x, y)[c] <= img(x, y)[c]);
+        REQUIRE(img_closed(x, y)[c] >= img(x, y)[c]);
+        REQUIRE(img_gradient(x, y)[c] == img_dilated(x, y)[c] - img_eroded(x, y)[c]);
+        REQUIRE(img_top_hat(x, y)[c] == img(x, y)[c] - img_opened(x, y)[c]);
+        REQUIRE(img_black_hat(x, y)[c] == img_closed(x, y)[c] - img(x, y)[c]);
+      }
+    }
+  }
+
+  // Mask cleanup: opening removes a speck, closing fills a hole.
+  sln::Image_8u1 mask({30_px, 30_px});
+  sln::fill(mask, sln::Pixel_8u1(0));
+  for (auto y = 5_idx; y < 25_idx; ++y)
+  {
+    for (auto x = 5_idx; x < 25_idx; ++x)
+    {
+      mask(x, y) = 255;
+    }
+  }
+  mask(15_idx, 15_idx) = 0;
+  mask(1_idx, 1_idx) = 255;
+
+  const auto se_3x3 = sln::StructuringElement(3_px, 3_px);
+  const auto mask_opened = sln::opening(mask, se_3x3);
+  REQUIRE(mask_opened(1_idx, 1_idx) == 0);
+  REQUIRE(mask_opened(10_idx, 10_idx) == 255);
+
+  const auto mask_closed = sln::closing(mask, se_3x3);
+  REQUIRE(mask_closed(15_idx, 15_idx) == 255);
+  REQUIRE(mask_closed(28_idx, 28_idx) == 0);
+}
@@ -0,0 +1,134 @@
+// This file is part of the `Selene` library.
+// Copyright 2017-2019 Michael Hofmann (https://github.com/kmhofmann).
+// Distributed under MIT license. See accompanying LICENSE file in the top-level directory.
+
+#include <catch2/catch.hpp>
+
+#include <selene/img_ops/PlanarOperations.hpp>
+
+#include <selene/img/pixel/PixelTypeAliases.hpp>
+
+#include <selene/img/typed/ImageTypeAliases.hpp>
+
+#include <selene/img_ops/Fill.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+
+#include <test/selene/img/typed/_Utils.hpp>
+
+using namespace sln::literals;
+
+namespace {
+
+template <typename Img, typename PlanarImg>
+void check_planar_equals_interleaved(const Img& img, const PlanarImg& planar)
+{
+  constexpr auto nr_channels = PlanarImg::nr_channels;
+  REQUIRE(planar.width() == img.width());
+  REQUIRE(planar.height() == img.height());
+
+  for (auto y = 0_idx; y < img.height(); ++y)
+  {
+    for (auto x = 0_idx; x < img.width(); ++x)
+    {
+      for (std::size_t c = 0; c < nr_channels; ++c)
+      {
+        REQUIRE(planar.plane(c)(x, y) == img(x, y)[c]);
+      }
+    }
+  }
+}
+
+template <typename PixelType>
+void test_planar_round_trip(std::mt19937& rng)
+{
+  using T = typename sln::PixelTraits<PixelType>::Element;
+  constexpr auto nr_channels = static_cast<std::size_t>(sln::PixelTraits<PixelType>::nr_channels);
+
+  for (auto width : {1, 5, 16, 17, 40})
+  {
+    const auto img = sln_test::construct_random_image<PixelType>(sln::PixelLength{width}, 3_px, rng);
+
+    const auto planar = sln::to_planar(img);
+    static_assert(std::is_same_v<std::remove_cv_t<decltype(planar)>, sln::PlanarImage<T, nr_channels>>);
+    check_planar_equals_interleaved(img, planar);
+
+    const auto img_interleaved = sln::to_interleaved<sln::PixelTraits<PixelType>::pixel_format>(planar);
+    static_assert(std::is_same_v<typename std::remove_cv_t<decltype(img_interleaved)>::PixelType, PixelType>);
+    REQUIRE(sln::equal(img, img_interleaved));
+
+    // Conversions from and into views
+    const auto planar_from_view = sln::to_planar(img.view());
+    check_planar_equals_interleaved(img, planar_from_view);
+
+    sln::Image<PixelType> img_dst(img.layout());
+    auto img_dst_view = img_dst.view();
+    sln::to_interleaved(planar.constant_view(), img_dst_view);
+    REQUIRE(sln::equal(img, img_dst));
+  }
+}
+
+}  // namespace
+
+TEST_CASE("Planar image conversions", "[img]")
+{
+  std::mt19937 rng(23);
+  test_planar_round_trip<sln::Pixel_8u1>(rng);
+  test_planar_round_trip<sln::Pixel_8u2>(rng);
+  test_planar_round_trip<sln::PixelRGB_8u>(rng);
+  test_planar_round_trip<sln::PixelRGBA_8u>(rng);
+  test_planar_round_trip<sln::Pixel_16u3>(rng);
+  test_planar_round_trip<sln::Pixel_16u4>(rng);
+  test_planar_round_trip<sln::Pixel_32f3>(rng);
+  test_planar_round_trip<sln::Pixel_32f4>(rng);
+  test_planar_round_trip<sln::Pixel_64f3>(rng);
+
+  SECTION("Conversion into a planar view of wrong size")
+  {
+    sln::Image_8u3 img({4_px, 4_px});
+    sln::PlanarImage<std::uint8_t, 3> planar({5_px, 4_px});
+    auto planar_view = planar.view();
+    REQUIRE_THROWS(sln::to_planar(img, planar_view));
+  }
+}
+
+TEST_CASE("Planar image per-plane operations", "[img]")
+{
+  sln::PlanarImage<std::uint16_t, 4> planar({33_px, 17_px});
+
+  for (int nr_threads : {1, 3, 0})
+  {
+    sln::for_each_plane(planar, [](auto& plane, std::size_t c) {
+      sln::fill(plane, sln::Pixel<std::uint16_t, 1>(static_cast<std::uint16_t>(1000 + c)));
+    }, nr_threads);
+
+    for (std::size_t c = 0; c < 4; ++c)
+    {
+      for (auto y = 0_idx; y < planar.height(); ++y)
+      {
+        for (auto x = 0_idx; x < planar.width(); ++x)
+        {
+          REQUIRE(planar.plane(c)(x, y) == 1000 + c);
+        }
+      }
+    }
+
+    std::atomic<int> nr_calls{0};
+    auto view = planar.view();
+    sln::for_each_plane(view, [&nr_calls](auto& plane, std::size_t) {
+      REQUIRE(plane.width() == 33_px);
+      ++nr_calls;
+    }, nr_threads);
+    REQUIRE(nr_calls == 4);
+
+    REQUIRE_THROWS_AS(sln::for_each_plane(planar, [](auto&, std::size_t c) {
+      if (c == 2)
+      {
+        throw std::runtime_error("error");
+      }
+    }, nr_threads), std::runtime_error);
+  }
+}
@@ -0,0 +1,209 @@
+// This file is part of the `Selene` library.
+// Copyright 2017-2019 Michael Hofmann (https://github.com/kmhofmann).
+// Distributed under MIT license. See accompanying LICENSE file in the top-level directory.
+
+#include <catch2/catch.hpp>
+
+#include <selene/img_ops/Statistics.hpp>
+
+#include <selene/img/pixel/PixelTypeAliases.hpp>
+
+#include <selene/img/typed/ImageTypeAliases.hpp>
+
+#include <selene/img_ops/Fill.hpp>
+#include <selene/img_ops/View.hpp>
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <random>
+
+#include <test/selene/img/typed/_Utils.hpp>
+
+using namespace sln::literals;
+
+namespace {
+
+template <typename Img>
+void check_statistics(const Img& img)
+{
+  using PixelType = typename Img::PixelType;
+  using T = typename sln::PixelTraits<PixelType>::Element;
+  constexpr auto nr_channels = static_cast<std::size_t>(sln::PixelTraits<PixelType>::nr_channels);
+  constexpr bool is_int = sln::PixelTraits<PixelType>::is_integral;
+
+  // Naive reference computations
+  std::array<long double, nr_channels> ref_sum{};
+  std::array<T, nr_channels> ref_min{};
+  std::array<T, nr_channels> ref_max{};
+  std::array<sln::PixelIndex, nr_channels> ref_min_x{}, ref_min_y{}, ref_max_x{}, ref_max_y{};
+
+  for (std::size_t c = 0; c < nr_channels; ++c)
+  {
+    ref_min[c] = img(0_idx, 0_idx)[c];
+    ref_max[c] = img(0_idx, 0_idx)[c];
+  }
+
+  for (auto y = 0_idx; y < img.height(); ++y)
+  {
+    for (auto x = 0_idx; x < img.width(); ++x)
+    {
+      const auto px = img(x, y);
+      for (std::size_t c = 0; c < nr_channels; ++c)
+      {
+        ref_sum[c] += static_cast<long double>(px[c]);
+        if (px[c] < ref_min[c])
+        {
+          ref_min[c] = px[c];
+          ref_min_x[c] = x;
+          ref_min_y[c] = y;
+        }
+        if (px[c] > ref_max[c])
+        {
+          ref_max[c] = px[c];
+          ref_max_x[c] = x;
+          ref_max_y[c] = y;
+        }
+      }
+    }
+  }
+
+  const auto nr_px = static_cast<long double>(img.width()) * static_cast<long double>(img.height());
+  std::array<long double, nr_channels> ref_var{};
+  for (auto y = 0_idx; y < img.height(); ++y)
+  {
+    for (auto x = 0_idx; x < img.width(); ++x)
+    {
+      for (std::size_t c = 0; c < nr_channels; ++c)
+      {
+        const auto d = static_cast<long double>(img(x, y)[c]) - ref_sum[c] / nr_px;
+        ref_var[c] += d * d;
+      }
+    }
+  }
+
+  const auto s = sln::sum(img);
+  const auto m = sln::mean(img);
+  const auto v = sln::variance(img);
+  const auto mm = sln::min_max(img);
+
+  for (std::size_t c = 0; c < nr_channels; ++c)
+  {
+    if constexpr (is_int)
+    {
+      REQUIRE(static_cast<long double>(s[c]) == ref_sum[c]);
+    }
+    else
+    {
+      REQUIRE(static_cast<long double>(s[c]) == Approx(static_cast<double>(ref_sum[c])).epsilon(1e-9));
+    }
+
+    REQUIRE(m[c] == Approx(static_cast<double>(ref_sum[c] / nr_px)).epsilon(1e-9));
+    REQUIRE(v[c] == Approx(static_cast<double>(ref_var[c] / nr_px)).epsilon(1e-6));
+    REQUIRE(mm[c].min == ref_min[c]);
+    REQUIRE(mm[c].max == ref_max[c]);
+    REQUIRE(mm[c].min_x == ref_min_x[c]);
+    REQUIRE(mm[c].min_y == ref_min_y[c]);
+    REQUIRE(mm[c].max_x == ref_max_x[c]);
+    REQUIRE(mm[c].max_y == ref_max_y[c]);
+  }
+
+  // Results have to be identical for any number of threads
+  for (int nr_threads : {1, 3, 0})
+  {
+    const auto s_t = sln::sum(img, nr_threads);
+    const auto v_t = sln::variance(img, nr_threads);
+    const auto mm_t = sln::min_max(img, nr_threads);
+
+    for (std::size_t c = 0; c < nr_channels; ++c)
+    {
+      REQUIRE(s_t[c] == s[c]);
+      REQUIRE(v_t[c] == v[c]);
+      REQUIRE(mm_t[c].min == mm[c].min);
+      REQUIRE(mm_t[c].max == mm[c].max);
+      REQUIRE(mm_t[c].min_x == mm[c].min_x);
+      REQUIRE(mm_t[c].min_y == mm[c].min_y);
+      REQUIRE(mm_t[c].max_x == mm[c].max_x);
+      REQUIRE(mm_t[c].max_y == mm[c].max_y);
+    }
+  }
+}
+
+template <typename PixelType>
+void check_random_images(std::mt19937& rng)
+{
+  auto sizes = sln_test::reference_test_sizes();
+  const auto large_sizes = sln_test::parallel_test_sizes();
+  sizes.insert(sizes.end(), large_sizes.cbegin(), large_sizes.cend());
+
+  for (const auto& [width, height] : sizes)
+  {
+    const auto img = sln_test::construct_random_image<PixelType>(width, height, rng);
+    check_statistics(img);
+
+    if (img.width() > 1)
+    {
+      check_statistics(sln::view(img, {1_idx, 0_idx, img.width() - 1, img.height()}));
+    }
+  }
+}
+
+}  // namespace _
+
+TEST_CASE("Image statistics", "[img]")
+{
+  std::mt19937 rng(42);
+
+  check_random_images<sln::Pixel_8u1>(rng);
+  check_random_images<sln::Pixel_8u2>(rng);
+  check_random_images<sln::Pixel_8u3>(rng);
+  check_random_images<sln::Pixel_8u4>(rng);
+  check_random_images<sln::Pixel_8s2>(rng);
+  check_random_images<sln::Pixel_16u1>(rng);
+  check_random_images<sln::Pixel_32s3>(rng);
+  check_random_images<sln::Pixel_32f3>(rng);
+}
+
+TEST_CASE("Image statistics on constant images", "[img]")
+{
+  sln::Image_8u3 img({40_px, 30_px});
+  sln::fill(img, sln::Pixel_8u3(10, 20, 30));
+  img(5_idx, 7_idx) = sln::Pixel_8u3(10, 255, 0);
+  img(6_idx, 7_idx) = sln::Pixel_8u3(10, 255, 0);
+
+  const auto mm = sln::min_max(img);
+  REQUIRE(mm[0].min == 10);
+  REQUIRE(mm[0].max == 10);
+  REQUIRE(mm[0].min_x == 0_idx);
+  REQUIRE(mm[0].min_y == 0_idx);
+  REQUIRE(mm[1].max == 255);
+  REQUIRE(mm[1].max_x == 5_idx);
+  REQUIRE(mm[1].max_y == 7_idx);
+  REQUIRE(mm[2].min == 0);
+  REQUIRE(mm[2].min_x == 5_idx);
+  REQUIRE(mm[2].min_y == 7_idx);
+
+  const auto v = sln::variance(img);
+  REQUIRE(v[0] == 0.0);
+
+  const auto nr_bright = sln::count_if(img, [](const sln::Pixel_8u3& px) { return px[1] == 255; });
+  REQUIRE(nr_bright == 2);
+
+  const auto nr_all = sln::count_if(img, [](const sln::Pixel_8u3&) { return true; }, 3);
+  REQUIRE(nr_all == 40 * 30);
+
+  const auto s = sln::sum(sln::Image_8u3{});
+  REQUIRE(s[0] == 0);
+  REQUIRE(sln::count_if(sln::Image_8u3{}, [](const sln::Pixel_8u3&) { return true; }) == 0);
+
+  const auto mm_empty = sln::min_max(sln::Image_8u3{});
+  REQUIRE(mm_empty[0].min == 255);
+  REQUIRE(mm_empty[0].max == 0);
+  REQUIRE(mm_empty[0].min_x == sln::PixelIndex{-1});
+  REQUIRE(mm_empty[2].max_y == sln::PixelIndex{-1});
+
+  const auto mm_empty_32f = sln::min_max(sln::Image_32f1({0_px, 10_px}), 3);
+  REQUIRE(mm_empty_32f[0].min == std::numeric_limits<sln::float32_t>::max());
+  REQUIRE(mm_empty_32f[0].max == std::numeric_limits<sln::float32_t>::lowest());
+}
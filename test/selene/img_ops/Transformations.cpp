@@ -12,7 +12,9 @@
 
 #include <selene/img_ops/Clone.hpp>
 
+#include <array>
 #include <random>
+#include <utility>
 
 #include <test/selene/img/typed/_Utils.hpp>
 
@@ -125,6 +127,83 @@ TEST_CASE("Image transformations / random images", "[img]")
   }
 }
 
+template <typename PixelType> void test_flip_sizes(std::mt19937& rng)
+{
+  // Widths cover rows shorter than, equal to, and longer than one or two SIMD registers
+  const std::array<sln::PixelIndex::value_type, 8> widths = {{1, 2, 7, 8, 15, 16, 17, 101}};
+
+  for (const auto width : widths)
+  {
+    for (const auto height : {1, 4, 5})
+    {
+      const auto img = sln_test::construct_random_image<PixelType>(sln::PixelLength{width}, sln::PixelLength{height},
+                                                                   rng);
+      test_flip(img);
+    }
+  }
+}
+
+TEST_CASE("Image transformations / flips", "[img]")
+{
+  std::mt19937 rng(300);
+  test_flip_sizes<sln::Pixel_8u1>(rng);
+  test_flip_sizes<sln::Pixel_8u2>(rng);
+  test_flip_sizes<sln::Pixel_8u3>(rng);
+  test_flip_sizes<sln::Pixel_8u4>(rng);
+  test_flip_sizes<sln::Pixel_16u1>(rng);
+  test_flip_sizes<sln::Pixel_16u2>(rng);
+  test_flip_sizes<sln::Pixel_16u3>(rng);
+  test_flip_sizes<sln::Pixel_16u4>(rng);
+  test_flip_sizes<sln::Pixel_64f2>(rng);
+}
+
+template <bool flip_h, bool flip_v, typename Img> void test_transpose_flipped(const Img& img)
+{
+  const auto img_transp = sln::transpose<flip_h, flip_v>(img);
+  REQUIRE(img_transp.width() == img.height());
+  REQUIRE(img_transp.height() == img.width());
+
+  for (auto y = 0_idx; y < img_transp.height(); ++y)
+  {
+    for (auto x = 0_idx; x < img_transp.width(); ++x)
+    {
+      const auto src_x = flip_v ? sln::PixelIndex{img.width() - 1 - y} : y;
+      const auto src_y = flip_h ? sln::PixelIndex{img.height() - 1 - x} : x;
+      REQUIRE(img_transp(x, y) == img(src_x, src_y));
+    }
+  }
+}
+
+template <typename PixelType> void test_transpose_tiled(std::mt19937& rng)
+{
+  // Sizes cover single pixels, partial and full blocks of 8x8 pixels, and images spanning multiple tiles
+  const std::array<std::pair<sln::PixelIndex::value_type, sln::PixelIndex::value_type>, 6> sizes = {
+      {{1, 1}, {7, 9}, {8, 8}, {16, 24}, {67, 133}, {300, 171}}};
+
+  for (const auto& size : sizes)
+  {
+    const auto img = sln_test::construct_random_image<PixelType>(sln::PixelLength{size.first},
+                                                                 sln::PixelLength{size.second}, rng);
+    test_transpose_flipped<false, false>(img);
+    test_transpose_flipped<true, false>(img);
+    test_transpose_flipped<false, true>(img);
+    test_transpose_flipped<true, true>(img);
+  }
+}
+
+TEST_CASE("Image transformations / tiled transpose", "[img]")
+{
+  std::mt19937 rng(200);
+  test_transpose_tiled<sln::Pixel_8u1>(rng);
+  test_transpose_tiled<sln::Pixel_8u2>(rng);
+  test_transpose_tiled<sln::Pixel_8u3>(rng);
+  test_transpose_tiled<sln::Pixel_8u4>(rng);
+  test_transpose_tiled<sln::Pixel_16u1>(rng);
+  test_transpose_tiled<sln::Pixel_32f1>(rng);
+  test_transpose_tiled<sln::Pixel_32f3>(rng);
+  test_transpose_tiled<sln::Pixel_64f1>(rng);
+}
+
 TEST_CASE("Image transformation expressions", "[img]")
 {
   sln::ImageY_8u img({3_px, 2_px});
@@ -0,0 +1,203 @@
+// This file is part of the `Selene` library.
+// Copyright 2017-2019 Michael Hofmann (https://github.com/kmhofmann).
+// Distributed under MIT license. See accompanying LICENSE file in the top-level directory.
+
+#include <catch2/catch.hpp>
+
+#include <selene/img_ops/Warp.hpp>
+
+#include <selene/img/pixel/PixelTypeAliases.hpp>
+
+#include <selene/img/typed/ImageTypeAliases.hpp>
+
+#include <selene/img_ops/Algorithms.hpp>
+#include <selene/img_ops/View.hpp>
+
+#include <cmath>
+#include <cstdint>
+#include <random>
+
+#include <test/selene/img/typed/_Utils.hpp>
+
+using namespace sln::literals;
+
+namespace {
+
+// Reference implementation, evaluating the full transformation per pixel in double precision.
+template <sln::ImageInterpolationMode interpolation_mode, sln::BorderAccessMode access_mode, typename PixelType>
+auto warp_reference(const sln::Image<PixelType>& img,
+                    const sln::PerspectiveTransform& m,
+                    sln::PixelLength width,
+                    sln::PixelLength height)
+{
+  using Element = typename sln::PixelTraits<PixelType>::Element;
+  constexpr auto nr_channels = sln::PixelTraits<PixelType>::nr_channels;
+
+  const auto access = [&img](std::int64_t x, std::int64_t y) {
+    return PixelType{sln::ImageBorderAccessor<access_mode>::access(
+        img, sln::PixelIndex{static_cast<std::int32_t>(x)}, sln::PixelIndex{static_cast<std::int32_t>(y)})};
+  };
+
+  sln::Image<PixelType> img_dst({width, height});
+  for (auto y = 0_idx; y < img_dst.height(); ++y)
+  {
+    for (auto x = 0_idx; x < img_dst.width(); ++x)
+    {
+      const auto dx = static_cast<double>(x);
+      const auto dy = static_cast<double>(y);
+      const auto w = m[6] * dx + m[7] * dy + m[8];
+      const auto xs = (m[0] * dx + m[1] * dy + m[2]) / w;
+      const auto ys = (m[3] * dx + m[4] * dy + m[5]) / w;
+
+      if constexpr (interpolation_mode == sln::ImageInterpolationMode::NearestNeighbor)
+      {
+        img_dst(x, y) = access(std::llround(std::ceil(xs - 0.5)), std::llround(std::ceil(ys - 0.5)));
+      }
+      else
+      {
+        const auto x0 = std::floor(xs);
+        const auto y0 = std::floor(ys);
+        const auto rx = xs - x0;
+        const auto ry = ys - y0;
+        const auto ix = std::llround(x0);
+        const auto iy = std::llround(y0);
+        const auto a = access(ix, iy);
+        const auto b = access(ix + 1, iy);
+        const auto c = access(ix, iy + 1);
+        const auto d = access(ix + 1, iy + 1);
+        for (std::size_t i = 0; i < nr_channels; ++i)
+        {
+          const auto va = double(a[i]);
+          const auto vb = double(b[i]);
+          const auto vc = double(c[i]);
+          const auto vd = double(d[i]);
+          const auto value = va + (vb - va) * rx + (vc - va) * ry + (va - vb - vc + vd) * rx * ry;
+          img_dst(x, y)[i] = std::is_integral_v<Element> ? static_cast<Element>(std::floor(value + 0.5))
+                                                          : static_cast<Element>(value);
+        }
+      }
+    }
+  }
+  return img_dst;
+}
+
+sln::PerspectiveTransform to_perspective(const sln::AffineTransform& m)
+{
+  return {{m[0], m[1], m[2], m[3], m[4], m[5], 0.0, 0.0, 1.0}};
+}
+
+sln::AffineTransform rotation(double angle, double scale, double cx, double cy, double tx, double ty)
+{
+  const auto c = scale * std::cos(angle);
+  const auto s = scale * std::sin(angle);
+  return {{c, -s, cx - c * cx + s * cy + tx, s, c, cy - s * cx - c * cy + ty}};
+}
+
+template <sln::ImageInterpolationMode interpolation_mode, sln::BorderAccessMode access_mode, typename PixelType>
+void check_warps(const sln::Image<PixelType>& img, double tolerance)
+{
+  constexpr auto is_nn = interpolation_mode == sln::ImageInterpolationMode::NearestNeighbor;
+  const auto w = img.width();
+  const auto h = img.height();
+  const auto cx = 0.5 * (static_cast<double>(w) - 1.0);
+  const auto cy = 0.5 * (static_cast<double>(h) - 1.0);
+
+  for (const auto& m : {rotation(0.0, 1.0, cx, cy, 0.0, 0.0), rotation(0.0, 1.0, cx, cy, -3.0, 2.0),
+                        rotation(0.3, 1.0, cx, cy, 1.25, -0.75), rotation(-0.1, 0.8123, cx, cy, 0.31, 0.57),
+                        rotation(2.5, 1.7, cx, cy, -4.4, 3.1), rotation(0.05, 1.0, cx, cy, 1000.0, 0.0)})
+  {
+    for (int nr_threads : {1, 3})
+    {
+      const auto img_affine = sln::warp_affine<interpolation_mode, access_mode>(img, m, w + 3, h - 1, nr_threads);
+      const auto img_ref = warp_reference<interpolation_mode, access_mode>(img, to_perspective(m), w + 3, h - 1);
+      REQUIRE(sln_test::images_nearly_equal(img_affine, img_ref, is_nn ? 0.0 : tolerance));
+    }
+  }
+
+  for (const auto& m :
+       {sln::PerspectiveTransform{{1.0, 0.0, 0.0, 0.0, 1.0, 0.0, 0.0, 0.0, 1.0}},
+        sln::PerspectiveTransform{{0.9137, 0.1021, 2.0313, -0.0489, 1.1047, -1.4713, 0.00213, -0.00097, 1.0}},
+        sln::PerspectiveTransform{{1.0, 0.2, -3.0, 0.0, 0.7, 4.0, 0.0, 0.01, 0.9}},
+        // The horizon (w = 0) runs through the target image.
+        sln::PerspectiveTransform{{1.01, 0.013, 0.2, 0.007, 0.99, 0.3, 0.0, -0.0937, 1.0}}})
+  {
+    for (int nr_threads : {1, 3})
+    {
+      const auto img_persp = sln::warp_perspective<interpolation_mode, access_mode>(img, m, w, h, nr_threads);
+      const auto img_ref = warp_reference<interpolation_mode, access_mode>(img, m, w, h);
+      REQUIRE(sln_test::images_nearly_equal(img_persp, img_ref, is_nn ? 0.0 : tolerance));
+    }
+  }
+}
+
+template <typename PixelType, typename RNG>
+void check_all_modes(sln::PixelLength width, sln::PixelLength height, double tolerance, RNG& rng)
+{
+  const auto img = sln_test::construct_random_image<PixelType>(width, height, rng);
+  check_warps<sln::ImageInterpolationMode::NearestNeighbor, sln::BorderAccessMode::Replicated>(img, tolerance);
+  check_warps<sln::ImageInterpolationMode::NearestNeighbor, sln::BorderAccessMode::ZeroPadding>(img, tolerance);
+  check_warps<sln::ImageInterpolationMode::Bilinear, sln::BorderAccessMode::Replicated>(img, tolerance);
+  check_warps<sln::ImageInterpolationMode::Bilinear, sln::BorderAccessMode::ZeroPadding>(img, tolerance);
+}
+
+}  // namespace _
+
+TEST_CASE("Affine and perspective warps", "[img]")
+{
+  std::mt19937 rng(42);
+
+  for (const auto& [w, h] : sln_test::reference_test_sizes())
+  {
+    check_all_modes<sln::Pixel_8u1>(w, h, 1.0, rng);
+    check_all_modes<sln::Pixel_8u3>(w, h, 1.0, rng);
+    check_all_modes<sln::Pixel_16u1>(w, h, 1.0, rng);
+    check_all_modes<sln::Pixel_32f2>(w, h, 1e-5, rng);
+  }
+
+  // Images large enough to be split into several row bands give the same results for any number of threads
+  for (const auto& [w, h] : sln_test::parallel_test_sizes())
+  {
+    const auto img_large = sln_test::construct_random_image<sln::Pixel_8u1>(w, h, rng);
+    const auto cx = 0.5 * (static_cast<double>(w) - 1.0);
+    const auto cy = 0.5 * (static_cast<double>(h) - 1.0);
+    const auto m_affine = rotation(0.3, 1.1, cx, cy, 1.25, -0.75);
+    const auto img_affine_1 = sln::warp_affine(img_large, m_affine, w, h, 1);
+    REQUIRE(sln::equal(sln::warp_affine(img_large, m_affine, w, h, 3), img_affine_1));
+
+    for (const auto& m :
+         {sln::PerspectiveTransform{{0.9137, 0.1021, 2.0313, -0.0489, 1.1047, -1.4713, 0.00013, -0.00007, 1.0}},
+          // The horizon (w = 0) runs through the target image.
+          sln::PerspectiveTransform{{1.01, 0.013, 0.2, 0.007, 0.99, 0.3, 0.0, -0.0037, 1.0}}})
+    {
+      const auto img_persp_1 = sln::warp_perspective(img_large, m, w, h, 1);
+      const auto img_ref = warp_reference<sln::ImageInterpolationMode::Bilinear, sln::BorderAccessMode::Replicated>(
+          img_large, m, w, h);
+      REQUIRE(sln_test::images_nearly_equal(img_persp_1, img_ref, 1.0));
+      REQUIRE(sln::equal(sln::warp_perspective(img_large, m, w, h, 3), img_persp_1));
+    }
+  }
+
+  const auto img = sln_test::construct_random_image<sln::Pixel_8u3>(80_px, 60_px, rng);
+
+  // Identity and integer translations reproduce the source pixels exactly.
+  const auto img_identity = sln::warp_affine(img, {{1.0, 0.0, 0.0, 0.0, 1.0, 0.0}}, img.width(), img.height());
+  REQUIRE(sln::equal(img_identity, img));
+
+  const auto region = sln::BoundingBox(20_idx, 15_idx, 40_px, 30_px);
+  const auto img_translated = sln::warp_affine(img, {{1.0, 0.0, 20.0, 0.0, 1.0, 15.0}}, 40_px, 30_px);
+  REQUIRE(sln::equal(img_translated, sln::view(img, region)));
+
+  const auto img_scaled_identity = sln::warp_perspective(
+      img, {{2.0, 0.0, 0.0, 0.0, 2.0, 0.0, 0.0, 0.0, 2.0}}, img.width(), img.height());
+  REQUIRE(sln::equal(img_scaled_identity, img));
+
+  // Unchecked access on a view into a larger image gives the same result as accessing the larger image directly.
+  const auto m_view = rotation(0.2, 1.1, 20.0, 15.0, 0.5, -0.5);
+  const auto m_full = sln::AffineTransform{{m_view[0], m_view[1], m_view[2] + 20.0, m_view[3], m_view[4],
+                                            m_view[5] + 15.0}};
+  const auto img_view_warped = sln::warp_affine<sln::ImageInterpolationMode::Bilinear,
+                                                sln::BorderAccessMode::Unchecked>(sln::view(img, region), m_view, 40_px,
+                                                                                  30_px);
+  const auto img_full_warped = sln::warp_affine(img, m_full, 40_px, 30_px);
+  REQUIRE(sln_test::images_nearly_equal(img_view_warped, img_full_warped, 1.0));
+}